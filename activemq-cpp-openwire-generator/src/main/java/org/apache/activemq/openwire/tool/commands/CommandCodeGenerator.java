@@ -243,6 +243,16 @@ public abstract class CommandCodeGenerator {
         }
     }
 
+    /**
+     * Byte array properties for which this returns true are held in a
+     * util::ByteSequence, copies of the command then share the bytes rather than
+     * copying them.  The usual vector accessors are kept and a pair of accessors for
+     * the ByteSequence itself is added.
+     */
+    protected boolean isSharedBytesProperty(JProperty property) {
+        return false;
+    }
+
     protected String decapitalize(String text) {
         if (text == null) {
             return null;
@@ -211,7 +211,9 @@ public class CommandHeaderGenerator extends CommandCodeGenerator {
             String type = toCppType(property.getType());
             String name = decapitalize(property.getSimpleName());
 
-            if (!property.getType().isPrimitiveType() && !property.getType().getSimpleName().equals("ByteSequence") &&
+            if (isSharedBytesProperty(property)) {
+                type = "activemq::util::ByteSequence";
+            } else if (!property.getType().isPrimitiveType() && !property.getType().getSimpleName().equals("ByteSequence") &&
                 !property.getType().getSimpleName().equals("String") && !type.startsWith("std::vector")) {
 
                 type = "Pointer<" + type + ">";
@@ -267,6 +269,19 @@ public class CommandHeaderGenerator extends CommandCodeGenerator {
 
             out.println("        virtual void " + property.getSetter().getSimpleName() + "(" + constness + type + " " + parameterName + ");");
             out.println("");
+
+            if (isSharedBytesProperty(property)) {
+                out.println("        /**");
+                out.println("         * @return the bytes of the " + parameterName + " without copying them.");
+                out.println("         */");
+                out.println("        virtual const activemq::util::ByteSequence& " + property.getGetter().getSimpleName() + "Bytes() const;");
+                out.println("");
+                out.println("        /**");
+                out.println("         * Sets the " + parameterName + " to share the given bytes, a slice is copied.");
+                out.println("         */");
+                out.println("        virtual void " + property.getSetter().getSimpleName() + "Bytes(const activemq::util::ByteSequence& " + parameterName + ");");
+                out.println("");
+            }
         }
     }
 }
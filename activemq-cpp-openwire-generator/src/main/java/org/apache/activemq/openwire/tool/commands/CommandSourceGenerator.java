@@ -17,7 +17,9 @@
 package org.apache.activemq.openwire.tool.commands;
 
 import java.io.PrintWriter;
+import java.util.ArrayList;
 import java.util.Iterator;
+import java.util.List;
 import java.util.Set;
 
 import org.codehaus.jam.JProperty;
@@ -183,7 +185,7 @@ public class CommandSourceGenerator extends CommandCodeGenerator {
         if (isHashable()) {
             out.println("////////////////////////////////////////////////////////////////////////////////");
             out.println("int " + getClassName() + "::getHashCode() const {");
-            out.println("    return decaf::util::HashCode<std::string>()(this->toString());");
+            generateHashCodeBody(out);
             out.println("}");
             out.println("");
         }
@@ -198,6 +200,55 @@ public class CommandSourceGenerator extends CommandCodeGenerator {
         generateAdditionalMethods(out);
     }
 
+    protected void generateHashCodeBody( PrintWriter out ) {
+        if (isHashedByValue()) {
+            // Ids made up only of strings and primitives are hashed field by field,
+            // formatting the id with toString is too costly for per message lookups.
+            out.println("    int hash = 1;");
+            for (JProperty property : getProperties()) {
+                String type = toCppType(property.getType());
+                String getter = property.getGetter().getSimpleName();
+                if (isComparable() && type.equals("std::string")) {
+                    // compareTo ignores the case of strings, the hash has to as well.  The
+                    // characters are lowered one at a time, copying the string would cost
+                    // an allocation per lookup.
+                    String name = decapitalize(property.getSimpleName());
+                    out.println("    const std::string& " + name + "String = this->" + getter + "();");
+                    out.println("    int " + name + "Hash = 0;");
+                    out.println("    for (std::string::const_iterator iter = " + name + "String.begin(); " +
+                                "iter != " + name + "String.end(); ++iter) {");
+                    out.println("        " + name + "Hash = 31 * " + name + "Hash + decaf::lang::Character::toLowerCase(*iter);");
+                    out.println("    }");
+                    out.println("    hash = 31 * hash + " + name + "Hash;");
+                } else {
+                    out.println("    hash = 31 * hash + decaf::util::HashCode<" + type + ">()(this->" + getter + "());");
+                }
+            }
+            out.println("    return hash;");
+        } else {
+            out.println("    return decaf::util::HashCode<std::string>()(this->toString());");
+        }
+    }
+
+    /**
+     * @return true if every property is a string or a primitive so that the hash code
+     *         can be computed directly from the property values.
+     */
+    protected boolean isHashedByValue() {
+        if (getProperties().isEmpty()) {
+            return false;
+        }
+
+        for (JProperty property : getProperties()) {
+            String type = toCppType(property.getType());
+            if (!property.getType().isPrimitiveType() && !type.equals("std::string")) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
     protected void populateIncludeFilesSet() {
         Set<String> includes = getIncludeFiles();
         includes.add("<activemq/commands/"+getClassName()+".h>");
@@ -210,6 +261,9 @@ public class CommandSourceGenerator extends CommandCodeGenerator {
         if( isComparable() ) {
             includes.add("<decaf/internal/util/StringUtils.h>");
         }
+        if( isHashable() && isComparable() && isHashedByValue() ) {
+            includes.add("<decaf/lang/Character.h>");
+        }
     }
 
     protected void populateBaseClassesSet() {
@@ -275,6 +329,10 @@ public class CommandSourceGenerator extends CommandCodeGenerator {
         for( JProperty property : getProperties() ) {
             String getter = property.getGetter().getSimpleName();
             String setter = property.getSetter().getSimpleName();
+            if( isSharedBytesProperty(property) ) {
+                getter += "Bytes";
+                setter += "Bytes";
+            }
             out.println("    this->"+setter+"(srcPtr->"+getter+"());");
         }
     }
@@ -381,7 +439,11 @@ public class CommandSourceGenerator extends CommandCodeGenerator {
             String parameterName = decapitalize(propertyName);
             String getter = property.getGetter().getSimpleName();
 
-            if( property.getType().getSimpleName().equals("ByteSequence") ) {
+            if( isSharedBytesProperty(property) ) {
+                out.println("    if (!this->"+getter+"Bytes().equals(valuePtr->"+getter+"Bytes())) {");
+                out.println("        return false;" );
+                out.println("    }" );
+            } else if( property.getType().getSimpleName().equals("ByteSequence") ) {
                 out.println("    for (size_t i" + parameterName + " = 0; i" + parameterName + " < this->"+getter+"().size(); ++i" + parameterName + ") {");
                 out.println("        if (this->"+getter+"()[i" + parameterName+"] != valuePtr->"+getter+"()[i"+parameterName+"]) {" );
                 out.println("            return false;" );
@@ -446,6 +508,11 @@ public class CommandSourceGenerator extends CommandCodeGenerator {
                 constNess = "const ";
             }
 
+            if( isSharedBytesProperty(property) ) {
+                generateSharedBytesAccessors(out, property);
+                continue;
+            }
+
             if( property.getType().isPrimitiveType() ) {
                 out.println("////////////////////////////////////////////////////////////////////////////////");
                 out.println(type+" "+getClassName()+"::"+getter+"() const {");
@@ -467,13 +534,71 @@ public class CommandSourceGenerator extends CommandCodeGenerator {
             out.println("////////////////////////////////////////////////////////////////////////////////");
             out.println("void " + getClassName() + "::" + setter+"(" + constNess + type+ " " + parameterName +") {");
             out.println("    this->"+parameterName+" = "+parameterName+";");
+            generateSetterBody(out, property);
             out.println("}");
             out.println("");
         }
     }
 
+    protected void generateSharedBytesAccessors( PrintWriter out, JProperty property ) {
+
+        String parameterName = decapitalize(property.getSimpleName());
+        String getter = property.getGetter().getSimpleName();
+        String setter = property.getSetter().getSimpleName();
+
+        out.println("////////////////////////////////////////////////////////////////////////////////");
+        out.println("const std::vector<unsigned char>& "+getClassName()+"::"+getter+"() const {");
+        out.println("    return "+parameterName+".getArray();");
+        out.println("}");
+        out.println("");
+        out.println("////////////////////////////////////////////////////////////////////////////////");
+        out.println("std::vector<unsigned char>& "+getClassName()+"::"+getter+"() {");
+        out.println("    // The bytes may be changed through the result, copies must not see that.");
+        out.println("    return "+parameterName+".detach();");
+        out.println("}");
+        out.println("");
+        out.println("////////////////////////////////////////////////////////////////////////////////");
+        out.println("void " + getClassName() + "::" + setter+"(const std::vector<unsigned char>& " + parameterName +") {");
+        out.println("    this->"+parameterName+" = activemq::util::ByteSequence("+parameterName+");");
+        generateSetterBody(out, property);
+        out.println("}");
+        out.println("");
+        out.println("////////////////////////////////////////////////////////////////////////////////");
+        out.println("const activemq::util::ByteSequence& "+getClassName()+"::"+getter+"Bytes() const {");
+        out.println("    return "+parameterName+";");
+        out.println("}");
+        out.println("");
+        out.println("////////////////////////////////////////////////////////////////////////////////");
+        out.println("void " + getClassName() + "::" + setter+"Bytes(const activemq::util::ByteSequence& " + parameterName +") {");
+        out.println("    // Only a whole sequence can back the vector returned by "+getter+".");
+        out.println("    this->"+parameterName+" = "+parameterName+".trim();");
+        generateSetterBody(out, property);
+        out.println("}");
+        out.println("");
+    }
+
+    /**
+     * Hook for classes that cache state derived from their properties, called after
+     * the property has been assigned in the generated setter.
+     */
+    protected void generateSetterBody( PrintWriter out, JProperty property ) {}
+
     protected void generateCompareToBody( PrintWriter out ) {
+        // The numeric properties are compared first, they are the ones most likely
+        // to differ between ids and are far cheaper to check than the strings.
+        List<JProperty> properties = new ArrayList<JProperty>();
+        for( JProperty property : getProperties() ) {
+            if( property.getType().isPrimitiveType() ) {
+                properties.add(property);
+            }
+        }
         for( JProperty property : getProperties() ) {
+            if( !property.getType().isPrimitiveType() ) {
+                properties.add(property);
+            }
+        }
+
+        for( JProperty property : properties ) {
 
             String type = toCppType(property.getType());
             String propertyName = property.getSimpleName();
@@ -19,6 +19,8 @@ package org.apache.activemq.openwire.tool.commands;
 import java.io.PrintWriter;
 import java.util.Set;
 
+import org.codehaus.jam.JProperty;
+
 public class MessageHeaderGenerator extends CommandHeaderGenerator {
 
     protected void populateIncludeFilesSet() {
@@ -26,10 +28,16 @@ public class MessageHeaderGenerator extends CommandHeaderGenerator {
         super.populateIncludeFilesSet();
 
         Set<String> includes = getIncludeFiles();
+        includes.add("<activemq/util/ByteSequence.h>");
+        includes.add("<activemq/util/CompressionContextPool.h>");
         includes.add("<activemq/util/PrimitiveMap.h>");
         includes.add("<activemq/core/ActiveMQAckHandler.h>");
     }
 
+    protected boolean isSharedBytesProperty( JProperty property ) {
+        return property.getSimpleName().equals("Content");
+    }
+
     protected void generateNamespaceWrapper( PrintWriter out ) {
         out.println("namespace activemq{");
         out.println("namespace core{");
@@ -51,8 +59,17 @@ public class MessageHeaderGenerator extends CommandHeaderGenerator {
         out.println("        Pointer<core::ActiveMQAckHandler> ackHandler;");
         out.println("");
         out.println("        // Message properties, these are Marshaled and Unmarshaled from the Message");
-        out.println("        // Command's marshaledProperties vector.");
-        out.println("        activemq::util::PrimitiveMap properties;");
+        out.println("        // Command's marshaledProperties vector.  Received properties are only decoded");
+        out.println("        // into the map the first time the map is accessed.");
+        out.println("        mutable activemq::util::PrimitiveMap properties;");
+        out.println("");
+        out.println("        // Indicates that the properties are held only in marshalledProperties and");
+        out.println("        // have not yet been decoded into the properties map.");
+        out.println("        mutable bool lazyProperties;");
+        out.println("");
+        out.println("        // Indicates that marshalledProperties still hold the encoding of the current");
+        out.println("        // properties, lets an unchanged message be marshaled without encoding them again.");
+        out.println("        bool marshalledPropertiesCurrent;");
         out.println("");
         out.println("        // Indicates if the Message Properties are Read Only");
         out.println("        bool readOnlyProperties;");
@@ -60,12 +77,45 @@ public class MessageHeaderGenerator extends CommandHeaderGenerator {
         out.println("        // Indicates if the Message Body are Read Only");
         out.println("        bool readOnlyBody;");
         out.println("");
+        out.println("        // Size in bytes of the frame this Message was last marshaled into, zero");
+        out.println("        // until the Message has been written by a WireFormat that records it.");
+        out.println("        unsigned int marshalledSize;");
+        out.println("");
+        out.println("        // Contexts used to decompress the body, held by the Message so that a compressed");
+        out.println("        // body can still be read once the Connection it arrived on is gone.");
+        out.println("        Pointer<util::CompressionContextPool> compressionPool;");
+        out.println("");
+        out.println("    private:");
+        out.println("");
+        out.println("        void unmarshalProperties() const;");
+        out.println("");
         out.println("    protected:");
         out.println("");
         out.println("        core::ActiveMQConnection* connection;");
         out.println("");
         out.println("        static const unsigned int DEFAULT_MESSAGE_SIZE = 1024;");
         out.println("");
+        out.println("        /**");
+        out.println("         * Returns true if the Connection this Message was created from has compression");
+        out.println("         * enabled and a body of the given size reaches its compression threshold.");
+        out.println("         *");
+        out.println("         * @param bodySize");
+        out.println("         *      The size in bytes of the body that would be compressed.");
+        out.println("         */");
+        out.println("        bool isCompressionWanted(int bodySize) const;");
+        out.println("");
+        out.println("        /**");
+        out.println("         * Compresses the given bytes at the Connection's compression level using its pooled");
+        out.println("         * contexts, the Message keeps a reference to the pool for reading the body back.");
+        out.println("         * Only valid while isCompressionWanted would return true.");
+        out.println("         */");
+        out.println("        void deflateBody(const unsigned char* data, int length, std::vector<unsigned char>& out);");
+        out.println("");
+        out.println("        /**");
+        out.println("         * Decompresses bytes that were compressed by deflateBody, appending them to out.");
+        out.println("         */");
+        out.println("        void inflateBody(const unsigned char* data, int length, std::vector<unsigned char>& out) const;");
+        out.println("");
     }
 
     protected void generateAdditonalMembers( PrintWriter out ) {
@@ -152,6 +202,27 @@ public class MessageHeaderGenerator extends CommandHeaderGenerator {
         out.println("        virtual unsigned int getSize() const;");
         out.println("");
         out.println("        /**");
+        out.println("         * Returns the number of bytes the Message occupied on the wire the last time");
+        out.println("         * it was marshaled, the value is not reset by later changes to the Message.");
+        out.println("         *");
+        out.println("         * @return the marshaled size in bytes or zero if it has not been recorded.");
+        out.println("         */");
+        out.println("        unsigned int getMarshalledSize() const {");
+        out.println("            return this->marshalledSize;");
+        out.println("        }");
+        out.println("");
+        out.println("        /**");
+        out.println("         * Records the number of bytes this Message was marshaled into, called by the");
+        out.println("         * WireFormat once the frame has been written.");
+        out.println("         *");
+        out.println("         * @param size");
+        out.println("         *      The size in bytes of the marshaled frame.");
+        out.println("         */");
+        out.println("        void setMarshalledSize(unsigned int size) {");
+        out.println("            this->marshalledSize = size;");
+        out.println("        }");
+        out.println("");
+        out.println("        /**");
         out.println("         * Returns if this message has expired, meaning that its");
         out.println("         * Expiration time has elapsed.");
         out.println("         * @returns true if message is expired.");
@@ -164,15 +235,50 @@ public class MessageHeaderGenerator extends CommandHeaderGenerator {
         out.println("        virtual void onSend() {}");
         out.println("");
         out.println("        /**");
+        out.println("         * Returns true if compress() will compress the body of this Message, which is only");
+        out.println("         * known once onSend has stored the body.");
+        out.println("         *");
+        out.println("         * @return true if the body is to be compressed before the Message is sent.");
+        out.println("         */");
+        out.println("        virtual bool isCompressionRequired() const {");
+        out.println("            return false;");
+        out.println("        }");
+        out.println("");
+        out.println("        /**");
+        out.println("         * Compresses the stored body if the Connection wants it compressed, called after");
+        out.println("         * onSend on the path that sends the Message.  Message types that compress their");
+        out.println("         * body as it is written do nothing here.");
+        out.println("         */");
+        out.println("        virtual void compress() {}");
+        out.println("");
+        out.println("        /**");
+        out.println("         * Sets the pool of compression contexts used to read the body if it is compressed.");
+        out.println("         *");
+        out.println("         * @param pool");
+        out.println("         *      The pool of the Connection the Message arrived on.");
+        out.println("         */");
+        out.println("        void setCompressionContextPool(const Pointer<util::CompressionContextPool>& pool) {");
+        out.println("            this->compressionPool = pool;");
+        out.println("        }");
+        out.println("");
+        out.println("        /**");
         out.println("         * Gets a reference to the Message's Properties object, allows the derived");
         out.println("         * classes to get and set their own specific properties.");
         out.println("         *");
+        out.println("         * Properties of a received message are decoded on the first call.  Taking a");
+        out.println("         * modifiable reference marks the properties as changed so they are encoded");
+        out.println("         * again when the message is next marshaled, read only access should go through");
+        out.println("         * the const overload so that an unchanged message keeps its original encoding.");
+        out.println("         *");
         out.println("         * @return a reference to the Primitive Map that holds message properties.");
         out.println("         */");
         out.println("        util::PrimitiveMap& getMessageProperties() {");
+        out.println("            this->unmarshalProperties();");
+        out.println("            this->marshalledPropertiesCurrent = false;");
         out.println("            return this->properties;");
         out.println("        }");
         out.println("        const util::PrimitiveMap& getMessageProperties() const {");
+        out.println("            this->unmarshalProperties();");
         out.println("            return this->properties;");
         out.println("        }");
         out.println("");
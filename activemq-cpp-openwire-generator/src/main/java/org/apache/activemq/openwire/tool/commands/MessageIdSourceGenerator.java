@@ -19,6 +19,8 @@ package org.apache.activemq.openwire.tool.commands;
 import java.io.PrintWriter;
 import java.util.Set;
 
+import org.codehaus.jam.JProperty;
+
 public class MessageIdSourceGenerator extends CommandSourceGenerator {
 
     protected void generateAdditionalConstructors( PrintWriter out ) {
@@ -77,13 +79,29 @@ public class MessageIdSourceGenerator extends CommandSourceGenerator {
         out.println("    }");
         out.println("");
         out.println("    this->producerId.reset(new ProducerId(messageKey));");
-        out.println("    this->key = messageKey;");
+        out.println("    this->key = \"\";");
         out.println("}");
         out.println("");
 
         super.generateAdditionalMethods(out);
     }
 
+    protected void generateSetterBody( PrintWriter out, JProperty property ) {
+        // The string form is rendered on first use and must follow the id.
+        out.println("    this->key = \"\";");
+    }
+
+    protected void generateHashCodeBody( PrintWriter out ) {
+        out.println("    if (!this->textView.empty()) {");
+        out.println("        return decaf::util::HashCode<std::string>()(this->textView);");
+        out.println("    }");
+        out.println("");
+        out.println("    // Hashed from the numeric parts so that lookups never render the string form.");
+        out.println("    int hash = this->producerId != NULL ? this->producerId->getHashCode() : 0;");
+        out.println("    hash = 31 * hash + decaf::util::HashCode<long long>()(this->producerSequenceId);");
+        out.println("    return hash;");
+    }
+
     protected void populateIncludeFilesSet() {
 
         super.populateIncludeFilesSet();
@@ -19,6 +19,8 @@ package org.apache.activemq.openwire.tool.commands;
 import java.io.PrintWriter;
 import java.util.Set;
 
+import org.codehaus.jam.JProperty;
+
 public class MessageSourceGenerator extends CommandSourceGenerator {
 
     protected void populateIncludeFilesSet() {
@@ -31,14 +33,22 @@ public class MessageSourceGenerator extends CommandSourceGenerator {
         includes.add("<decaf/lang/System.h>");
     }
 
+    protected boolean isSharedBytesProperty( JProperty property ) {
+        return property.getSimpleName().equals("Content");
+    }
+
     protected String generateInitializerList() {
         StringBuilder result = new StringBuilder();
 
         result.append(super.generateInitializerList());
         result.append(", ackHandler(NULL)");
         result.append(", properties()");
+        result.append(", lazyProperties(false)");
+        result.append(", marshalledPropertiesCurrent(false)");
         result.append(", readOnlyProperties(false)");
         result.append(", readOnlyBody(false)");
+        result.append(", marshalledSize(0)");
+        result.append(", compressionPool()");
         result.append(", connection(NULL)");
 
         return result.toString();
@@ -48,10 +58,13 @@ public class MessageSourceGenerator extends CommandSourceGenerator {
         super.generateCopyDataStructureBody(out);
 
         out.println("    this->properties.copy(srcPtr->properties);");
+        out.println("    this->lazyProperties = srcPtr->lazyProperties;");
+        out.println("    this->marshalledPropertiesCurrent = srcPtr->marshalledPropertiesCurrent;");
         out.println("    this->setAckHandler(srcPtr->getAckHandler());");
         out.println("    this->setReadOnlyBody(srcPtr->isReadOnlyBody());");
         out.println("    this->setReadOnlyProperties(srcPtr->isReadOnlyProperties());");
         out.println("    this->setConnection(srcPtr->getConnection());");
+        out.println("    this->compressionPool = srcPtr->compressionPool;");
     }
 
     protected void generateToStringBody( PrintWriter out ) {
@@ -65,7 +78,7 @@ public class MessageSourceGenerator extends CommandSourceGenerator {
         out.println("        return false;");
         out.println("    }");
         out.println("");
-        out.println("    if (!properties.equals(valuePtr->properties)) {");
+        out.println("    if (!getMessageProperties().equals(valuePtr->getMessageProperties())) {");
         out.println("        return false;");
         out.println("    }");
         out.println("");
@@ -109,14 +122,45 @@ public class MessageSourceGenerator extends CommandSourceGenerator {
         out.println("}");
         out.println("");
         out.println("////////////////////////////////////////////////////////////////////////////////");
+        out.println("bool Message::isCompressionWanted(int bodySize) const {");
+        out.println("    return this->connection != NULL && this->connection->isUseCompression() &&");
+        out.println("           bodySize > 0 && bodySize >= this->connection->getCompressionThreshold();");
+        out.println("}");
+        out.println("");
+        out.println("////////////////////////////////////////////////////////////////////////////////");
+        out.println("void Message::deflateBody(const unsigned char* data, int length, std::vector<unsigned char>& out) {");
+        out.println("    this->compressionPool = this->connection->getCompressionContextPool();");
+        out.println("    this->compressionPool->deflate(data, length, this->connection->getCompressionLevel(), out);");
+        out.println("}");
+        out.println("");
+        out.println("////////////////////////////////////////////////////////////////////////////////");
+        out.println("void Message::inflateBody(const unsigned char* data, int length, std::vector<unsigned char>& out) const {");
+        out.println("");
+        out.println("    if (this->compressionPool != NULL) {");
+        out.println("        this->compressionPool->inflate(data, length, out);");
+        out.println("    } else {");
+        out.println("        // Not one of ours, nothing worth keeping a context around for.");
+        out.println("        util::CompressionContextPool pool(0);");
+        out.println("        pool.inflate(data, length, out);");
+        out.println("    }");
+        out.println("}");
+        out.println("");
+        out.println("////////////////////////////////////////////////////////////////////////////////");
         out.println("void Message::beforeMarshal(wireformat::WireFormat* wireFormat AMQCPP_UNUSED) {");
         out.println("");
         out.println("    try {");
+        out.println("        // Properties that are unchanged since they were received or last marshaled");
+        out.println("        // are sent as they are, a forwarded message never needs them decoded.");
+        out.println("        if (marshalledPropertiesCurrent) {");
+        out.println("            return;");
+        out.println("        }");
+        out.println("");
         out.println("        marshalledProperties.clear();");
         out.println("        if (!properties.isEmpty()) {");
         out.println("            wireformat::openwire::marshal::PrimitiveTypesMarshaller::marshal(");
         out.println("                &properties, marshalledProperties );");
         out.println("        }");
+        out.println("        marshalledPropertiesCurrent = true;");
         out.println("    }");
         out.println("    AMQ_CATCH_RETHROW(decaf::io::IOException)");
         out.println("    AMQ_CATCH_EXCEPTION_CONVERT(decaf::lang::Exception, decaf::io::IOException)");
@@ -127,8 +171,27 @@ public class MessageSourceGenerator extends CommandSourceGenerator {
         out.println("void Message::afterUnmarshal(wireformat::WireFormat* wireFormat AMQCPP_UNUSED) {");
         out.println("");
         out.println("    try {");
+        out.println("        // Decoding is deferred until the properties are first accessed.");
+        out.println("        properties.clear();");
+        out.println("        lazyProperties = !marshalledProperties.empty();");
+        out.println("        marshalledPropertiesCurrent = true;");
+        out.println("    }");
+        out.println("    AMQ_CATCH_RETHROW(decaf::io::IOException)");
+        out.println("    AMQ_CATCH_EXCEPTION_CONVERT(decaf::lang::Exception, decaf::io::IOException)");
+        out.println("    AMQ_CATCHALL_THROW(decaf::io::IOException)");
+        out.println("}");
+        out.println("");
+        out.println("////////////////////////////////////////////////////////////////////////////////");
+        out.println("void Message::unmarshalProperties() const {");
+        out.println("");
+        out.println("    if (!lazyProperties) {");
+        out.println("        return;");
+        out.println("    }");
+        out.println("");
+        out.println("    try {");
         out.println("        wireformat::openwire::marshal::PrimitiveTypesMarshaller::unmarshal(");
         out.println("            &properties, marshalledProperties);");
+        out.println("        lazyProperties = false;");
         out.println("    }");
         out.println("    AMQ_CATCH_RETHROW(decaf::io::IOException)");
         out.println("    AMQ_CATCH_EXCEPTION_CONVERT(decaf::lang::Exception, decaf::io::IOException)");
@@ -43,6 +43,22 @@ public class AmqCppMarshallingClassesGenerator extends AmqCppMarshallingHeadersG
         return className;
     }
 
+    /**
+     * Message content is held in a ByteSequence so that it can be shared with the
+     * message's copies, see MessageHeaderGenerator.  It is unmarshaled straight into
+     * one and marshaled through its read only view so a shared body is never copied.
+     */
+    protected boolean isSharedBytesProperty( JProperty property ) {
+        return jclass.getSimpleName().equals("Message") && property.getSimpleName().equals("Content");
+    }
+
+    protected String getGetterExpression( JProperty property ) {
+        if( isSharedBytesProperty(property) ) {
+            return "info->" + property.getGetter().getSimpleName() + "Bytes().getArray()";
+        }
+        return "info->" + property.getGetter().getSimpleName() + "()";
+    }
+
     /**
      * Checks if the tightMarshal1 method needs an casted version of its
      * dataStructure argument and then returns true or false to indicate this
@@ -177,6 +193,9 @@ public class AmqCppMarshallingClassesGenerator extends AmqCppMarshallingHeadersG
             if( size != null ) {
                 out.println(indent + "info->" + setter + "(tightUnmarshalConstByteArray(dataIn, bs, "+ size.asInt() +"));");
             }
+            else if( isSharedBytesProperty(property) ) {
+                out.println(indent + "info->" + setter + "Bytes(tightUnmarshalByteSequence(dataIn, bs));");
+            }
             else {
                 out.println(indent + "info->" + setter + "(tightUnmarshalByteArray(dataIn, bs));");
             }
@@ -233,7 +252,7 @@ public class AmqCppMarshallingClassesGenerator extends AmqCppMarshallingHeadersG
             JAnnotationValue size = annotation.getValue("size");
             JClass propertyType = property.getType();
             String type = propertyType.getSimpleName();
-            String getter = "info->" + property.getGetter().getSimpleName() + "()";
+            String getter = getGetterExpression(property);
             String indent = "        ";
 
             if( version.asInt() > 1 ) {
@@ -310,7 +329,7 @@ public class AmqCppMarshallingClassesGenerator extends AmqCppMarshallingHeadersG
             JAnnotationValue size = annotation.getValue("size");
             JClass propertyType = property.getType();
             String type = propertyType.getSimpleName();
-            String getter = "info->" + property.getGetter().getSimpleName() + "()";
+            String getter = getGetterExpression(property);
             String indent = "        ";
             count++;
 
@@ -438,6 +457,9 @@ public class AmqCppMarshallingClassesGenerator extends AmqCppMarshallingHeadersG
             if (size != null) {
                 out.println(indent + "info->" + setter + "(looseUnmarshalConstByteArray(dataIn, " + size.asInt() + "));");
             }
+            else if (isSharedBytesProperty(property)) {
+                out.println(indent + "info->" + setter + "Bytes(looseUnmarshalByteSequence(dataIn));");
+            }
             else {
                 out.println(indent + "info->" + setter + "(looseUnmarshalByteArray(dataIn));");
             }
@@ -496,7 +518,7 @@ public class AmqCppMarshallingClassesGenerator extends AmqCppMarshallingHeadersG
             JAnnotationValue size = annotation.getValue("size");
             JClass propertyType = property.getType();
             String type = propertyType.getSimpleName();
-            String getter = "info->" + property.getGetter().getSimpleName() + "()";
+            String getter = getGetterExpression(property);
             String indent = "        ";
 
             if( version.asInt() > 1 ) {
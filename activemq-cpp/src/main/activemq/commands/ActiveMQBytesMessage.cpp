@@ -18,14 +18,10 @@
 
 #include <activemq/util/CMSExceptionSupport.h>
 
-#include <decaf/io/FilterOutputStream.h>
 #include <decaf/io/ByteArrayInputStream.h>
 #include <decaf/io/EOFException.h>
 #include <decaf/io/IOException.h>
 
-#include <decaf/util/zip/DeflaterOutputStream.h>
-#include <decaf/util/zip/InflaterInputStream.h>
-
 using namespace std;
 using namespace activemq;
 using namespace activemq::util;
@@ -35,45 +31,13 @@ using namespace decaf::io;
 using namespace decaf::lang;
 using namespace decaf::lang::exceptions;
 using namespace decaf::util;
-using namespace decaf::util::zip;
 
 ////////////////////////////////////////////////////////////////////////////////
 const unsigned char ActiveMQBytesMessage::ID_ACTIVEMQBYTESMESSAGE = 24;
 
-////////////////////////////////////////////////////////////////////////////////
-namespace {
-
-    class ByteCounterOutputStream : public FilterOutputStream {
-    private:
-
-        int* length;
-
-    private:
-
-        ByteCounterOutputStream( const ByteCounterOutputStream& );
-        ByteCounterOutputStream operator= ( const ByteCounterOutputStream& );
-
-    public:
-
-        ByteCounterOutputStream( int* length, OutputStream* stream, bool own = false )
-            : FilterOutputStream( stream, own ), length( length ) {
-        }
-
-        virtual ~ByteCounterOutputStream() {}
-
-    protected:
-
-        virtual void doWriteByte( unsigned char value ) {
-            (*length)++;
-            FilterOutputStream::doWriteByte( value );
-        }
-
-    };
-}
-
 ////////////////////////////////////////////////////////////////////////////////
 ActiveMQBytesMessage::ActiveMQBytesMessage() :
-    ActiveMQMessageTemplate<cms::BytesMessage>(), bytesOut(NULL), dataIn(), dataOut(), length(0) {
+    ActiveMQMessageTemplate<cms::BytesMessage>(), bytesOut(NULL), dataIn(), dataOut(), length(0), readContent() {
 
     this->clearBody();
 }
@@ -187,6 +151,7 @@ void ActiveMQBytesMessage::clearBody() {
     this->dataOut.reset(NULL);
     this->bytesOut = NULL;
     this->dataIn.reset(NULL);
+    this->readContent = ByteSequence();
     this->length = 0;
 }
 
@@ -196,6 +161,40 @@ void ActiveMQBytesMessage::onSend() {
     ActiveMQMessageTemplate<cms::BytesMessage>::onSend();
 }
 
+////////////////////////////////////////////////////////////////////////////////
+bool ActiveMQBytesMessage::isCompressionRequired() const {
+    return !this->compressed && isCompressionWanted(this->getContentBytes().getLength());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQBytesMessage::compress() {
+
+    try {
+
+        if (!isCompressionRequired()) {
+            return;
+        }
+
+        ByteSequence content = this->getContentBytes();
+        int size = content.getLength();
+
+        std::vector<unsigned char> bytes;
+        bytes.reserve(size / 2 + 4);
+
+        // Start with the length of the body before compression.
+        bytes.push_back((unsigned char) ((size >> 24) & 0xFF));
+        bytes.push_back((unsigned char) ((size >> 16) & 0xFF));
+        bytes.push_back((unsigned char) ((size >> 8) & 0xFF));
+        bytes.push_back((unsigned char) (size & 0xFF));
+
+        deflateBody(content.getData(), size, bytes);
+
+        this->setContentBytes(ByteSequence::adopt(bytes));
+        this->compressed = true;
+    }
+    AMQ_CATCH_ALL_THROW_CMSEXCEPTION()
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 void ActiveMQBytesMessage::reset() {
 
@@ -204,6 +203,7 @@ void ActiveMQBytesMessage::reset() {
         this->bytesOut = NULL;
         this->dataIn.reset(NULL);
         this->dataOut.reset(NULL);
+        this->readContent = ByteSequence();
         this->length = 0;
         this->setReadOnlyBody(true);
     }
@@ -593,28 +593,14 @@ void ActiveMQBytesMessage::storeContent() {
 
             this->dataOut->close();
 
-            if (!this->compressed) {
+            std::pair<unsigned char*, int> array = this->bytesOut->toByteArray();
+            std::vector<unsigned char> bytes(array.first, array.first + array.second);
+            delete[] array.first;
 
-                std::pair<unsigned char*, int> array = this->bytesOut->toByteArray();
-                this->setContent(std::vector<unsigned char>(array.first, array.first + array.second));
-                delete[] array.first;
-
-            } else {
-
-                ByteArrayOutputStream buffer;
-                DataOutputStream doBuffer(&buffer);
-
-                // Start by writing the length of the written data before compression.
-                doBuffer.writeInt((int) this->length);
-
-                // Now write the Compressed bytes.
-                this->bytesOut->writeTo(&doBuffer);
-
-                // Now store the annotated content.
-                std::pair<unsigned char*, int> array = buffer.toByteArray();
-                this->setContent(std::vector<unsigned char>(array.first, array.first + array.second));
-                delete[] array.first;
-            }
+            // The message and all of its copies share this one array from here on, the
+            // send path compresses it afterwards if the Connection wants it compressed.
+            this->setContentBytes(ByteSequence::adopt(bytes));
+            this->compressed = false;
 
             this->dataOut.reset(NULL);
             this->bytesOut = NULL;
@@ -630,22 +616,37 @@ void ActiveMQBytesMessage::initializeReading() const {
     try {
 
         if (this->dataIn.get() == NULL) {
-            InputStream* is = new ByteArrayInputStream(this->getContent());
+
+            // The stream reads from the content's storage, holding a reference to it
+            // keeps the bytes valid even if the content is replaced while reading.
+            this->readContent = this->getContentBytes();
 
             if (this->isCompressed()) {
 
+                if (this->readContent.getLength() < 4) {
+                    throw CMSExceptionSupport::create(
+                        EOFException(__FILE__, __LINE__, "Compressed body is missing its length"));
+                }
+
+                const unsigned char* data = this->readContent.getData();
+                int size = ((data[0] & 0xFF) << 24) | ((data[1] & 0xFF) << 16) |
+                           ((data[2] & 0xFF) << 8) | (data[3] & 0xFF);
+
+                std::vector<unsigned char> inflated;
+                inflated.reserve(size > 0 ? size : 0);
+
                 try {
-                    DataInputStream dis(is);
-                    this->length = dis.readInt();
+                    inflateBody(data + 4, this->readContent.getLength() - 4, inflated);
                 } catch (IOException& ex) {
                     throw CMSExceptionSupport::create(ex);
                 }
 
-                is = new InflaterInputStream(is, true);
-
-            } else {
-                this->length = (int) this->getContent().size();
+                // Read from the inflated copy, the content itself stays compressed.
+                this->readContent = ByteSequence::adopt(inflated);
             }
+
+            this->length = this->readContent.getLength();
+            InputStream* is = new ByteArrayInputStream(this->readContent.getArray());
             this->dataIn.reset(new DataInputStream(is, true));
         }
     }
@@ -660,19 +661,7 @@ void ActiveMQBytesMessage::initializeWriting() {
         if (this->dataOut.get() == NULL) {
             this->length = 0;
             this->bytesOut = new ByteArrayOutputStream();
-
-            OutputStream* os = this->bytesOut;
-
-            if (this->connection != NULL && this->connection->isUseCompression()) {
-                this->compressed = true;
-
-                Deflater* deflator = new Deflater(this->connection->getCompressionLevel());
-
-                os = new DeflaterOutputStream(os, deflator, true, true);
-                os = new ByteCounterOutputStream(&length, os, true);
-            }
-
-            this->dataOut.reset(new DataOutputStream(os, true));
+            this->dataOut.reset(new DataOutputStream(this->bytesOut, true));
         }
     }
     AMQ_CATCH_ALL_THROW_CMSEXCEPTION()
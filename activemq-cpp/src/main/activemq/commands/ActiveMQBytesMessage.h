@@ -51,10 +51,15 @@ namespace commands {
         std::auto_ptr<decaf::io::DataOutputStream> dataOut;
 
         /**
-         * Tracks the actual length of the Message when compressed.
+         * The length of the body being read, before compression.
          */
         mutable int length;
 
+        /**
+         * The content being read, keeps its bytes alive while dataIn reads them.
+         */
+        mutable util::ByteSequence readContent;
+
     public:
 
         const static unsigned char ID_ACTIVEMQBYTESMESSAGE;
@@ -88,6 +93,10 @@ namespace commands {
 
         virtual void onSend();
 
+        virtual bool isCompressionRequired() const;
+
+        virtual void compress();
+
     public:   // CMS BytesMessage
 
         virtual void setBodyBytes(const unsigned char* buffer, int numBytes);
@@ -20,8 +20,6 @@
 #include <decaf/io/ByteArrayOutputStream.h>
 #include <decaf/io/DataOutputStream.h>
 #include <decaf/io/DataInputStream.h>
-#include <decaf/util/zip/DeflaterOutputStream.h>
-#include <decaf/util/zip/InflaterInputStream.h>
 
 #include <activemq/util/MarshallingSupport.h>
 #include <activemq/util/CMSExceptionSupport.h>
@@ -37,7 +35,6 @@ using namespace activemq::wireformat::openwire;
 using namespace decaf::io;
 using namespace decaf::lang;
 using namespace decaf::util;
-using namespace decaf::util::zip;
 
 ////////////////////////////////////////////////////////////////////////////////
 const unsigned char ActiveMQTextMessage::ID_ACTIVEMQTEXTMESSAGE = 28;
@@ -129,24 +126,26 @@ void ActiveMQTextMessage::beforeMarshal(wireformat::WireFormat* wireFormat) {
 
     ActiveMQMessageTemplate<cms::TextMessage>::beforeMarshal(wireFormat);
 
-    if (this->text.get() != NULL) {
+    // Normally already stored and compressed by the send path, this covers a message
+    // that is marshaled without having been sent.
+    storeContent();
+}
 
-        ByteArrayOutputStream* bytesOut = new ByteArrayOutputStream;
-        OutputStream* os = bytesOut;
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQTextMessage::onSend() {
+    ActiveMQMessageTemplate<cms::TextMessage>::onSend();
+    storeContent();
+}
 
-        if (this->connection != NULL && this->connection->isUseCompression()) {
-            this->compressed = true;
-            Deflater* deflator = new Deflater(this->connection->getCompressionLevel());
-            os = new DeflaterOutputStream(os, deflator, true, true);
-        }
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQTextMessage::storeContent() {
 
-        DataOutputStream dataOut(os, true);
+    if (this->text.get() != NULL) {
 
-        if (this->text.get() == NULL) {
-            dataOut.writeInt(-1);
-        } else {
-            MarshallingSupport::writeString32(dataOut, *(this->text));
-        }
+        ByteArrayOutputStream* bytesOut = new ByteArrayOutputStream;
+        DataOutputStream dataOut(bytesOut, true);
+
+        MarshallingSupport::writeString32(dataOut, *(this->text));
 
         dataOut.close();
 
@@ -156,10 +155,33 @@ void ActiveMQTextMessage::beforeMarshal(wireformat::WireFormat* wireFormat) {
             delete[] array.first;
         }
 
+        this->compressed = false;
         this->text.reset(NULL);
     }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+bool ActiveMQTextMessage::isCompressionRequired() const {
+    return !this->compressed && isCompressionWanted((int) this->getContent().size());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQTextMessage::compress() {
+
+    if (!isCompressionRequired()) {
+        return;
+    }
+
+    const std::vector<unsigned char>& content = this->getContent();
+    std::vector<unsigned char> deflated;
+    deflated.reserve(content.size() / 2);
+
+    deflateBody(&content[0], (int) content.size(), deflated);
+
+    this->setContent(deflated);
+    this->compressed = true;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 unsigned int ActiveMQTextMessage::getSize() const {
 
@@ -184,23 +206,40 @@ std::string ActiveMQTextMessage::getText() const {
             return *(this->text.get());
         } else {
 
-            if (this->getContent().size() <= 4) {
-                return "";
-            }
+            const std::vector<unsigned char>& content = this->getContent();
 
             try {
 
-                InputStream* is = new ByteArrayInputStream(getContent());
-
                 if (isCompressed()) {
-                    is = new InflaterInputStream(is, true);
-                }
 
-                DataInputStream dataIn(is, true);
+                    // A compressed body can still be empty, there is nothing to inflate then.
+                    if (content.empty()) {
+                        return "";
+                    }
+
+                    std::vector<unsigned char> inflated;
+                    inflated.reserve(content.size() * 2);
+
+                    inflateBody(&content[0], (int) content.size(), inflated);
 
-                this->text.reset(new std::string(MarshallingSupport::readString32(dataIn)));
+                    if (inflated.size() <= 4) {
+                        return "";
+                    }
 
-                dataIn.close();
+                    DataInputStream dataIn(new ByteArrayInputStream(inflated), true);
+                    this->text.reset(new std::string(MarshallingSupport::readString32(dataIn)));
+                    dataIn.close();
+
+                } else {
+
+                    if (content.size() <= 4) {
+                        return "";
+                    }
+
+                    DataInputStream dataIn(new ByteArrayInputStream(content), true);
+                    this->text.reset(new std::string(MarshallingSupport::readString32(dataIn)));
+                    dataIn.close();
+                }
 
             } catch (IOException& ioe) {
                 throw CMSExceptionSupport::create(ioe);
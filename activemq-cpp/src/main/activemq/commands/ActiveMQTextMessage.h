@@ -40,6 +40,12 @@ namespace commands {
         ActiveMQTextMessage(const ActiveMQTextMessage&);
         ActiveMQTextMessage& operator=(const ActiveMQTextMessage&);
 
+        /**
+         * Writes the text to the content uncompressed, compress() then compresses it in
+         * place if the Connection wants it compressed.
+         */
+        void storeContent();
+
     public:
 
         ActiveMQTextMessage();
@@ -60,6 +66,12 @@ namespace commands {
 
         virtual void beforeMarshal(wireformat::WireFormat* wireFormat);
 
+        virtual void onSend();
+
+        virtual bool isCompressionRequired() const;
+
+        virtual void compress();
+
         virtual unsigned int getSize() const;
 
     public: // CMS Message
@@ -19,6 +19,7 @@
 #include <activemq/exceptions/ActiveMQException.h>
 #include <activemq/state/CommandVisitor.h>
 #include <decaf/internal/util/StringUtils.h>
+#include <decaf/lang/Character.h>
 #include <decaf/lang/exceptions/NullPointerException.h>
 #include <decaf/util/HashCode.h>
 
@@ -175,6 +176,13 @@ BrokerId& BrokerId::operator= (const BrokerId& other) {
 
 ////////////////////////////////////////////////////////////////////////////////
 int BrokerId::getHashCode() const {
-    return decaf::util::HashCode<std::string>()(this->toString());
+    int hash = 1;
+    const std::string& valueString = this->getValue();
+    int valueHash = 0;
+    for (std::string::const_iterator iter = valueString.begin(); iter != valueString.end(); ++iter) {
+        valueHash = 31 * valueHash + decaf::lang::Character::toLowerCase(*iter);
+    }
+    hash = 31 * hash + valueHash;
+    return hash;
 }
 
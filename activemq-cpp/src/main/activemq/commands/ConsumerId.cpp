@@ -19,6 +19,7 @@
 #include <activemq/exceptions/ActiveMQException.h>
 #include <activemq/state/CommandVisitor.h>
 #include <decaf/internal/util/StringUtils.h>
+#include <decaf/lang/Character.h>
 #include <decaf/lang/exceptions/NullPointerException.h>
 #include <decaf/util/HashCode.h>
 #include <sstream>
@@ -188,11 +189,6 @@ int ConsumerId::compareTo(const ConsumerId& value) const {
         return 0;
     }
 
-    int connectionIdComp = StringUtils::compareIgnoreCase(this->connectionId.c_str(), value.connectionId.c_str());
-    if (connectionIdComp != 0) {
-        return connectionIdComp;
-    }
-
     if (this->sessionId > value.sessionId) {
         return 1;
     } else if(this->sessionId < value.sessionId) {
@@ -205,6 +201,11 @@ int ConsumerId::compareTo(const ConsumerId& value) const {
         return -1;
     }
 
+    int connectionIdComp = StringUtils::compareIgnoreCase(this->connectionId.c_str(), value.connectionId.c_str());
+    if (connectionIdComp != 0) {
+        return connectionIdComp;
+    }
+
     return 0;
 }
 
@@ -231,7 +232,16 @@ ConsumerId& ConsumerId::operator= (const ConsumerId& other) {
 
 ////////////////////////////////////////////////////////////////////////////////
 int ConsumerId::getHashCode() const {
-    return decaf::util::HashCode<std::string>()(this->toString());
+    int hash = 1;
+    const std::string& connectionIdString = this->getConnectionId();
+    int connectionIdHash = 0;
+    for (std::string::const_iterator iter = connectionIdString.begin(); iter != connectionIdString.end(); ++iter) {
+        connectionIdHash = 31 * connectionIdHash + decaf::lang::Character::toLowerCase(*iter);
+    }
+    hash = 31 * hash + connectionIdHash;
+    hash = 31 * hash + decaf::util::HashCode<long long>()(this->getSessionId());
+    hash = 31 * hash + decaf::util::HashCode<long long>()(this->getValue());
+    return hash;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
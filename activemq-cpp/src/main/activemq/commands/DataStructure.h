@@ -20,11 +20,18 @@
 
 #include <activemq/util/Config.h>
 #include <activemq/wireformat/MarshalAware.h>
+#include <decaf/util/concurrent/atomic/AtomicRefCounted.h>
 
 namespace activemq{
 namespace commands{
 
-    class AMQCPP_API DataStructure : public wireformat::MarshalAware {
+    /**
+     * Root of the OpenWire command types.  DataStructures carry their own reference
+     * count so that wrapping a newly created or unmarshaled command in a Pointer does
+     * not cost a second allocation for the counter.
+     */
+    class AMQCPP_API DataStructure : public wireformat::MarshalAware,
+                                     public decaf::util::concurrent::atomic::AtomicRefCounted {
     public:
 
         virtual ~DataStructure() {}
@@ -48,7 +48,7 @@ Message::Message() :
       groupID(""), groupSequence(0), correlationId(""), persistent(false), expiration(0), priority(0), replyTo(NULL), timestamp(0), 
       type(""), content(), marshalledProperties(), dataStructure(NULL), targetConsumerId(NULL), compressed(false), redeliveryCounter(0), 
       brokerPath(), arrival(0), userID(""), recievedByDFBridge(false), droppable(false), cluster(), brokerInTime(0), brokerOutTime(0), 
-      jMSXGroupFirstForConsumer(false), ackHandler(NULL), properties(), readOnlyProperties(false), readOnlyBody(false), connection(NULL) {
+      jMSXGroupFirstForConsumer(false), ackHandler(NULL), properties(), lazyProperties(false), marshalledPropertiesCurrent(false), readOnlyProperties(false), readOnlyBody(false), marshalledSize(0), compressionPool(), connection(NULL) {
 
 }
 
@@ -100,7 +100,7 @@ void Message::copyDataStructure(const DataStructure* src) {
     this->setReplyTo(srcPtr->getReplyTo());
     this->setTimestamp(srcPtr->getTimestamp());
     this->setType(srcPtr->getType());
-    this->setContent(srcPtr->getContent());
+    this->setContentBytes(srcPtr->getContentBytes());
     this->setMarshalledProperties(srcPtr->getMarshalledProperties());
     this->setDataStructure(srcPtr->getDataStructure());
     this->setTargetConsumerId(srcPtr->getTargetConsumerId());
@@ -116,10 +116,13 @@ void Message::copyDataStructure(const DataStructure* src) {
     this->setBrokerOutTime(srcPtr->getBrokerOutTime());
     this->setJMSXGroupFirstForConsumer(srcPtr->isJMSXGroupFirstForConsumer());
     this->properties.copy(srcPtr->properties);
+    this->lazyProperties = srcPtr->lazyProperties;
+    this->marshalledPropertiesCurrent = srcPtr->marshalledPropertiesCurrent;
     this->setAckHandler(srcPtr->getAckHandler());
     this->setReadOnlyBody(srcPtr->isReadOnlyBody());
     this->setReadOnlyProperties(srcPtr->isReadOnlyProperties());
     this->setConnection(srcPtr->getConnection());
+    this->compressionPool = srcPtr->compressionPool;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -367,10 +370,8 @@ bool Message::equals(const DataStructure* value) const {
     if (this->getType() != valuePtr->getType()) {
         return false;
     }
-    for (size_t icontent = 0; icontent < this->getContent().size(); ++icontent) {
-        if (this->getContent()[icontent] != valuePtr->getContent()[icontent]) {
-            return false;
-        }
+    if (!this->getContentBytes().equals(valuePtr->getContentBytes())) {
+        return false;
     }
     for (size_t imarshalledProperties = 0; imarshalledProperties < this->getMarshalledProperties().size(); ++imarshalledProperties) {
         if (this->getMarshalledProperties()[imarshalledProperties] != valuePtr->getMarshalledProperties()[imarshalledProperties]) {
@@ -440,7 +441,7 @@ bool Message::equals(const DataStructure* value) const {
         return false;
     }
 
-    if (!properties.equals(valuePtr->properties)) {
+    if (!getMessageProperties().equals(valuePtr->getMessageProperties())) {
         return false;
     }
 
@@ -660,17 +661,29 @@ void Message::setType(const std::string& type) {
 
 ////////////////////////////////////////////////////////////////////////////////
 const std::vector<unsigned char>& Message::getContent() const {
-    return content;
+    return content.getArray();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 std::vector<unsigned char>& Message::getContent() {
-    return content;
+    // The bytes may be changed through the result, copies must not see that.
+    return content.detach();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 void Message::setContent(const std::vector<unsigned char>& content) {
-    this->content = content;
+    this->content = activemq::util::ByteSequence(content);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+const activemq::util::ByteSequence& Message::getContentBytes() const {
+    return content;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Message::setContentBytes(const activemq::util::ByteSequence& content) {
+    // Only a whole sequence can back the vector returned by getContent.
+    this->content = content.trim();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -869,15 +882,46 @@ unsigned int Message::getSize() const {
     return size;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+bool Message::isCompressionWanted(int bodySize) const {
+    return this->connection != NULL && this->connection->isUseCompression() &&
+           bodySize > 0 && bodySize >= this->connection->getCompressionThreshold();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Message::deflateBody(const unsigned char* data, int length, std::vector<unsigned char>& out) {
+    this->compressionPool = this->connection->getCompressionContextPool();
+    this->compressionPool->deflate(data, length, this->connection->getCompressionLevel(), out);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Message::inflateBody(const unsigned char* data, int length, std::vector<unsigned char>& out) const {
+
+    if (this->compressionPool != NULL) {
+        this->compressionPool->inflate(data, length, out);
+    } else {
+        // Not one of ours, nothing worth keeping a context around for.
+        util::CompressionContextPool pool(0);
+        pool.inflate(data, length, out);
+    }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 void Message::beforeMarshal(wireformat::WireFormat* wireFormat AMQCPP_UNUSED) {
 
     try {
+        // Properties that are unchanged since they were received or last marshaled
+        // are sent as they are, a forwarded message never needs them decoded.
+        if (marshalledPropertiesCurrent) {
+            return;
+        }
+
         marshalledProperties.clear();
         if (!properties.isEmpty()) {
             wireformat::openwire::marshal::PrimitiveTypesMarshaller::marshal(
                 &properties, marshalledProperties );
         }
+        marshalledPropertiesCurrent = true;
     }
     AMQ_CATCH_RETHROW(decaf::io::IOException)
     AMQ_CATCH_EXCEPTION_CONVERT(decaf::lang::Exception, decaf::io::IOException)
@@ -887,9 +931,28 @@ void Message::beforeMarshal(wireformat::WireFormat* wireFormat AMQCPP_UNUSED) {
 ////////////////////////////////////////////////////////////////////////////////
 void Message::afterUnmarshal(wireformat::WireFormat* wireFormat AMQCPP_UNUSED) {
 
+    try {
+        // Decoding is deferred until the properties are first accessed.
+        properties.clear();
+        lazyProperties = !marshalledProperties.empty();
+        marshalledPropertiesCurrent = true;
+    }
+    AMQ_CATCH_RETHROW(decaf::io::IOException)
+    AMQ_CATCH_EXCEPTION_CONVERT(decaf::lang::Exception, decaf::io::IOException)
+    AMQ_CATCHALL_THROW(decaf::io::IOException)
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void Message::unmarshalProperties() const {
+
+    if (!lazyProperties) {
+        return;
+    }
+
     try {
         wireformat::openwire::marshal::PrimitiveTypesMarshaller::unmarshal(
             &properties, marshalledProperties);
+        lazyProperties = false;
     }
     AMQ_CATCH_RETHROW(decaf::io::IOException)
     AMQ_CATCH_EXCEPTION_CONVERT(decaf::lang::Exception, decaf::io::IOException)
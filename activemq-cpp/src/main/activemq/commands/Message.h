@@ -32,6 +32,8 @@
 #include <activemq/commands/ProducerId.h>
 #include <activemq/commands/TransactionId.h>
 #include <activemq/core/ActiveMQAckHandler.h>
+#include <activemq/util/ByteSequence.h>
+#include <activemq/util/CompressionContextPool.h>
 #include <activemq/util/Config.h>
 #include <activemq/util/PrimitiveMap.h>
 #include <decaf/lang/Pointer.h>
@@ -74,7 +76,7 @@ namespace commands{
         Pointer<ActiveMQDestination> replyTo;
         long long timestamp;
         std::string type;
-        std::vector<unsigned char> content;
+        activemq::util::ByteSequence content;
         std::vector<unsigned char> marshalledProperties;
         Pointer<DataStructure> dataStructure;
         Pointer<ConsumerId> targetConsumerId;
@@ -101,8 +103,17 @@ namespace commands{
         Pointer<core::ActiveMQAckHandler> ackHandler;
 
         // Message properties, these are Marshaled and Unmarshaled from the Message
-        // Command's marshaledProperties vector.
-        activemq::util::PrimitiveMap properties;
+        // Command's marshaledProperties vector.  Received properties are only decoded
+        // into the map the first time the map is accessed.
+        mutable activemq::util::PrimitiveMap properties;
+
+        // Indicates that the properties are held only in marshalledProperties and
+        // have not yet been decoded into the properties map.
+        mutable bool lazyProperties;
+
+        // Indicates that marshalledProperties still hold the encoding of the current
+        // properties, lets an unchanged message be marshaled without encoding them again.
+        bool marshalledPropertiesCurrent;
 
         // Indicates if the Message Properties are Read Only
         bool readOnlyProperties;
@@ -110,12 +121,45 @@ namespace commands{
         // Indicates if the Message Body are Read Only
         bool readOnlyBody;
 
+        // Size in bytes of the frame this Message was last marshaled into, zero
+        // until the Message has been written by a WireFormat that records it.
+        unsigned int marshalledSize;
+
+        // Contexts used to decompress the body, held by the Message so that a compressed
+        // body can still be read once the Connection it arrived on is gone.
+        Pointer<util::CompressionContextPool> compressionPool;
+
+    private:
+
+        void unmarshalProperties() const;
+
     protected:
 
         core::ActiveMQConnection* connection;
 
         static const unsigned int DEFAULT_MESSAGE_SIZE = 1024;
 
+        /**
+         * Returns true if the Connection this Message was created from has compression
+         * enabled and a body of the given size reaches its compression threshold.
+         *
+         * @param bodySize
+         *      The size in bytes of the body that would be compressed.
+         */
+        bool isCompressionWanted(int bodySize) const;
+
+        /**
+         * Compresses the given bytes at the Connection's compression level using its pooled
+         * contexts, the Message keeps a reference to the pool for reading the body back.
+         * Only valid while isCompressionWanted would return true.
+         */
+        void deflateBody(const unsigned char* data, int length, std::vector<unsigned char>& out);
+
+        /**
+         * Decompresses bytes that were compressed by deflateBody, appending them to out.
+         */
+        void inflateBody(const unsigned char* data, int length, std::vector<unsigned char>& out) const;
+
     private:
 
         Message(const Message&);
@@ -215,6 +259,27 @@ namespace commands{
          */
         virtual unsigned int getSize() const;
 
+        /**
+         * Returns the number of bytes the Message occupied on the wire the last time
+         * it was marshaled, the value is not reset by later changes to the Message.
+         *
+         * @return the marshaled size in bytes or zero if it has not been recorded.
+         */
+        unsigned int getMarshalledSize() const {
+            return this->marshalledSize;
+        }
+
+        /**
+         * Records the number of bytes this Message was marshaled into, called by the
+         * WireFormat once the frame has been written.
+         *
+         * @param size
+         *      The size in bytes of the marshaled frame.
+         */
+        void setMarshalledSize(unsigned int size) {
+            this->marshalledSize = size;
+        }
+
         /**
          * Returns if this message has expired, meaning that its
          * Expiration time has elapsed.
@@ -227,16 +292,51 @@ namespace commands{
          */
         virtual void onSend() {}
 
+        /**
+         * Returns true if compress() will compress the body of this Message, which is only
+         * known once onSend has stored the body.
+         *
+         * @return true if the body is to be compressed before the Message is sent.
+         */
+        virtual bool isCompressionRequired() const {
+            return false;
+        }
+
+        /**
+         * Compresses the stored body if the Connection wants it compressed, called after
+         * onSend on the path that sends the Message.  Message types that compress their
+         * body as it is written do nothing here.
+         */
+        virtual void compress() {}
+
+        /**
+         * Sets the pool of compression contexts used to read the body if it is compressed.
+         *
+         * @param pool
+         *      The pool of the Connection the Message arrived on.
+         */
+        void setCompressionContextPool(const Pointer<util::CompressionContextPool>& pool) {
+            this->compressionPool = pool;
+        }
+
         /**
          * Gets a reference to the Message's Properties object, allows the derived
          * classes to get and set their own specific properties.
          *
+         * Properties of a received message are decoded on the first call.  Taking a
+         * modifiable reference marks the properties as changed so they are encoded
+         * again when the message is next marshaled, read only access should go through
+         * the const overload so that an unchanged message keeps its original encoding.
+         *
          * @return a reference to the Primitive Map that holds message properties.
          */
         util::PrimitiveMap& getMessageProperties() {
+            this->unmarshalProperties();
+            this->marshalledPropertiesCurrent = false;
             return this->properties;
         }
         const util::PrimitiveMap& getMessageProperties() const {
+            this->unmarshalProperties();
             return this->properties;
         }
 
@@ -331,6 +431,16 @@ namespace commands{
         virtual std::vector<unsigned char>& getContent();
         virtual void setContent(const std::vector<unsigned char>& content);
 
+        /**
+         * @return the bytes of the content without copying them.
+         */
+        virtual const activemq::util::ByteSequence& getContentBytes() const;
+
+        /**
+         * Sets the content to share the given bytes, a slice is copied.
+         */
+        virtual void setContentBytes(const activemq::util::ByteSequence& content);
+
         virtual const std::vector<unsigned char>& getMarshalledProperties() const;
         virtual std::vector<unsigned char>& getMarshalledProperties();
         virtual void setMarshalledProperties(const std::vector<unsigned char>& marshalledProperties);
@@ -197,6 +197,7 @@ std::string& MessageId::getTextView() {
 ////////////////////////////////////////////////////////////////////////////////
 void MessageId::setTextView(const std::string& textView) {
     this->textView = textView;
+    this->key = "";
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -212,6 +213,7 @@ decaf::lang::Pointer<ProducerId>& MessageId::getProducerId() {
 ////////////////////////////////////////////////////////////////////////////////
 void MessageId::setProducerId(const decaf::lang::Pointer<ProducerId>& producerId) {
     this->producerId = producerId;
+    this->key = "";
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -222,6 +224,7 @@ long long MessageId::getProducerSequenceId() const {
 ////////////////////////////////////////////////////////////////////////////////
 void MessageId::setProducerSequenceId(long long producerSequenceId) {
     this->producerSequenceId = producerSequenceId;
+    this->key = "";
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -232,6 +235,7 @@ long long MessageId::getBrokerSequenceId() const {
 ////////////////////////////////////////////////////////////////////////////////
 void MessageId::setBrokerSequenceId(long long brokerSequenceId) {
     this->brokerSequenceId = brokerSequenceId;
+    this->key = "";
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -241,16 +245,6 @@ int MessageId::compareTo(const MessageId& value) const {
         return 0;
     }
 
-    int textViewComp = StringUtils::compareIgnoreCase(this->textView.c_str(), value.textView.c_str());
-    if (textViewComp != 0) {
-        return textViewComp;
-    }
-
-    int producerIdComp = this->producerId->compareTo(*(value.producerId));
-    if (producerIdComp != 0) {
-        return producerIdComp;
-    }
-
     if (this->producerSequenceId > value.producerSequenceId) {
         return 1;
     } else if(this->producerSequenceId < value.producerSequenceId) {
@@ -263,6 +257,16 @@ int MessageId::compareTo(const MessageId& value) const {
         return -1;
     }
 
+    int textViewComp = StringUtils::compareIgnoreCase(this->textView.c_str(), value.textView.c_str());
+    if (textViewComp != 0) {
+        return textViewComp;
+    }
+
+    int producerIdComp = this->producerId->compareTo(*(value.producerId));
+    if (producerIdComp != 0) {
+        return producerIdComp;
+    }
+
     return 0;
 }
 
@@ -289,7 +293,14 @@ MessageId& MessageId::operator= (const MessageId& other) {
 
 ////////////////////////////////////////////////////////////////////////////////
 int MessageId::getHashCode() const {
-    return decaf::util::HashCode<std::string>()(this->toString());
+    if (!this->textView.empty()) {
+        return decaf::util::HashCode<std::string>()(this->textView);
+    }
+
+    // Hashed from the numeric parts so that lookups never render the string form.
+    int hash = this->producerId != NULL ? this->producerId->getHashCode() : 0;
+    hash = 31 * hash + decaf::util::HashCode<long long>()(this->producerSequenceId);
+    return hash;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -306,6 +317,6 @@ void MessageId::setValue(const std::string& key) {
     }
 
     this->producerId.reset(new ProducerId(messageKey));
-    this->key = messageKey;
+    this->key = "";
 }
 
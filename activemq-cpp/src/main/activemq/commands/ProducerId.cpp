@@ -19,6 +19,7 @@
 #include <activemq/exceptions/ActiveMQException.h>
 #include <activemq/state/CommandVisitor.h>
 #include <decaf/internal/util/StringUtils.h>
+#include <decaf/lang/Character.h>
 #include <decaf/lang/Long.h>
 #include <decaf/lang/exceptions/NullPointerException.h>
 #include <decaf/util/HashCode.h>
@@ -204,11 +205,6 @@ int ProducerId::compareTo(const ProducerId& value) const {
         return 0;
     }
 
-    int connectionIdComp = StringUtils::compareIgnoreCase(this->connectionId.c_str(), value.connectionId.c_str());
-    if (connectionIdComp != 0) {
-        return connectionIdComp;
-    }
-
     if (this->value > value.value) {
         return 1;
     } else if(this->value < value.value) {
@@ -221,6 +217,11 @@ int ProducerId::compareTo(const ProducerId& value) const {
         return -1;
     }
 
+    int connectionIdComp = StringUtils::compareIgnoreCase(this->connectionId.c_str(), value.connectionId.c_str());
+    if (connectionIdComp != 0) {
+        return connectionIdComp;
+    }
+
     return 0;
 }
 
@@ -247,7 +248,16 @@ ProducerId& ProducerId::operator= (const ProducerId& other) {
 
 ////////////////////////////////////////////////////////////////////////////////
 int ProducerId::getHashCode() const {
-    return decaf::util::HashCode<std::string>()(this->toString());
+    int hash = 1;
+    const std::string& connectionIdString = this->getConnectionId();
+    int connectionIdHash = 0;
+    for (std::string::const_iterator iter = connectionIdString.begin(); iter != connectionIdString.end(); ++iter) {
+        connectionIdHash = 31 * connectionIdHash + decaf::lang::Character::toLowerCase(*iter);
+    }
+    hash = 31 * hash + connectionIdHash;
+    hash = 31 * hash + decaf::util::HashCode<long long>()(this->getValue());
+    hash = 31 * hash + decaf::util::HashCode<long long>()(this->getSessionId());
+    return hash;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -22,6 +22,7 @@
 #include <activemq/exceptions/ActiveMQException.h>
 #include <activemq/state/CommandVisitor.h>
 #include <decaf/internal/util/StringUtils.h>
+#include <decaf/lang/Character.h>
 #include <decaf/lang/exceptions/NullPointerException.h>
 #include <decaf/util/HashCode.h>
 #include <sstream>
@@ -190,17 +191,17 @@ int SessionId::compareTo(const SessionId& value) const {
         return 0;
     }
 
-    int connectionIdComp = StringUtils::compareIgnoreCase(this->connectionId.c_str(), value.connectionId.c_str());
-    if (connectionIdComp != 0) {
-        return connectionIdComp;
-    }
-
     if (this->value > value.value) {
         return 1;
     } else if(this->value < value.value) {
         return -1;
     }
 
+    int connectionIdComp = StringUtils::compareIgnoreCase(this->connectionId.c_str(), value.connectionId.c_str());
+    if (connectionIdComp != 0) {
+        return connectionIdComp;
+    }
+
     return 0;
 }
 
@@ -227,7 +228,15 @@ SessionId& SessionId::operator= (const SessionId& other) {
 
 ////////////////////////////////////////////////////////////////////////////////
 int SessionId::getHashCode() const {
-    return decaf::util::HashCode<std::string>()(this->toString());
+    int hash = 1;
+    const std::string& connectionIdString = this->getConnectionId();
+    int connectionIdHash = 0;
+    for (std::string::const_iterator iter = connectionIdString.begin(); iter != connectionIdString.end(); ++iter) {
+        connectionIdHash = 31 * connectionIdHash + decaf::lang::Character::toLowerCase(*iter);
+    }
+    hash = 31 * hash + connectionIdHash;
+    hash = 31 * hash + decaf::util::HashCode<long long>()(this->getValue());
+    return hash;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
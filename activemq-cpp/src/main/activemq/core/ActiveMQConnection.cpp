@@ -43,12 +43,15 @@
 #include <decaf/lang/Math.h>
 #include <decaf/lang/Boolean.h>
 #include <decaf/lang/Integer.h>
+#include <decaf/lang/Thread.h>
 #include <decaf/util/Iterator.h>
 #include <decaf/util/Set.h>
 #include <decaf/util/Collection.h>
 #include <decaf/util/LinkedList.h>
 #include <decaf/util/UUID.h>
+#include <decaf/util/NoSuchElementException.h>
 #include <decaf/util/concurrent/Mutex.h>
+#include <decaf/util/concurrent/ConcurrentHashMap.h>
 #include <decaf/util/concurrent/TimeUnit.h>
 #include <decaf/util/concurrent/CountDownLatch.h>
 #include <decaf/util/concurrent/ThreadPoolExecutor.h>
@@ -131,9 +134,7 @@ namespace core {
 
     public:
 
-        typedef decaf::util::StlMap< Pointer<commands::ConsumerId>,
-                                     Dispatcher*,
-                                     commands::ConsumerId::COMPARATOR > DispatcherMap;
+        typedef decaf::util::concurrent::ConcurrentHashMap< commands::ConsumerId, Dispatcher* > DispatcherMap;
 
         typedef decaf::util::StlMap< Pointer<commands::ProducerId>,
                                      Pointer<ActiveMQProducerKernel>,
@@ -184,6 +185,7 @@ namespace core {
         bool nonBlockingRedelivery;
         bool alwaysSessionAsync;
         int compressionLevel;
+        int compressionThreshold;
         unsigned int sendTimeout;
         unsigned int connectResponseTimeout;
         unsigned int closeTimeout;
@@ -194,6 +196,12 @@ namespace core {
         long long optimizedAckScheduledAckInterval;
         long long consumerFailoverRedeliveryWaitPeriod;
         bool consumerExpiryCheckEnabled;
+        bool useRingDispatchChannel;
+        bool copyMessageOnSend;
+        bool useDedicatedTaskRunner;
+        bool optimizeDispatch;
+        bool pipelineCreation;
+        bool backgroundCompression;
 
         std::auto_ptr<PrefetchPolicy> defaultPrefetchPolicy;
         std::auto_ptr<RedeliveryPolicy> defaultRedeliveryPolicy;
@@ -208,10 +216,17 @@ namespace core {
         Pointer<AtomicInteger> protocolVersion;
         Pointer<CountDownLatch> brokerInfoReceived;
         Pointer<AdvisoryConsumer> advisoryConsumer;
+        Pointer<util::CompressionContextPool> compressionPool;
 
         Pointer<Exception> firstFailureError;
 
         DispatcherMap dispatchers;
+
+        // Held for reading while a MessageDispatch is handed to its dispatcher, which
+        // lets dispatches on several threads run at once.  removeDispatcher takes it for
+        // writing to wait out the dispatches that may have found the removed dispatcher.
+        decaf::util::concurrent::locks::ReentrantReadWriteLock dispatchLock;
+
         ProducerMap activeProducers;
 
         decaf::util::concurrent::locks::ReentrantReadWriteLock sessionsLock;
@@ -255,6 +270,7 @@ namespace core {
                              nonBlockingRedelivery(false),
                              alwaysSessionAsync(true),
                              compressionLevel(-1),
+                             compressionThreshold(0),
                              sendTimeout(0),
                              connectResponseTimeout(0),
                              closeTimeout(15000),
@@ -265,6 +281,12 @@ namespace core {
                              optimizedAckScheduledAckInterval(0),
                              consumerFailoverRedeliveryWaitPeriod(0),
                              consumerExpiryCheckEnabled(true),
+                             useRingDispatchChannel(false),
+                             copyMessageOnSend(true),
+                             useDedicatedTaskRunner(true),
+                             optimizeDispatch(false),
+                             pipelineCreation(false),
+                             backgroundCompression(false),
                              defaultPrefetchPolicy(NULL),
                              defaultRedeliveryPolicy(NULL),
                              exceptionListener(NULL),
@@ -275,8 +297,10 @@ namespace core {
                              transportInterruptionProcessingComplete(),
                              brokerInfoReceived(),
                              advisoryConsumer(),
+                             compressionPool(new util::CompressionContextPool()),
                              firstFailureError(),
                              dispatchers(),
+                             dispatchLock(),
                              activeProducers(),
                              sessionsLock(),
                              activeSessions(),
@@ -524,9 +548,7 @@ ActiveMQConnection::~ActiveMQConnection() {
 void ActiveMQConnection::addDispatcher(const decaf::lang::Pointer<ConsumerId>& consumer, Dispatcher* dispatcher) {
 
     try {
-        synchronized(&this->config->dispatchers) {
-            this->config->dispatchers.put(consumer, dispatcher);
-        }
+        this->config->dispatchers.put(*consumer, dispatcher);
     }
     AMQ_CATCH_ALL_THROW_CMSEXCEPTION()
 }
@@ -535,8 +557,18 @@ void ActiveMQConnection::addDispatcher(const decaf::lang::Pointer<ConsumerId>& c
 void ActiveMQConnection::removeDispatcher(const decaf::lang::Pointer<ConsumerId>& consumer) {
 
     try {
-        synchronized(&this->config->dispatchers) {
-            this->config->dispatchers.remove(consumer);
+        Dispatcher* dispatcher = NULL;
+        try {
+            dispatcher = this->config->dispatchers.remove(*consumer);
+        } catch (NoSuchElementException& ex) {
+        }
+
+        // A dispatch that found the consumer before it was removed above might still
+        // be running, wait for it to finish unless the consumer is being removed from
+        // within a dispatch, whose read lock could never be upgraded.
+        if (dispatcher != NULL && this->config->dispatchLock.getReadHoldCount() == 0) {
+            this->config->dispatchLock.writeLock().lock();
+            this->config->dispatchLock.writeLock().unlock();
         }
     }
     AMQ_CATCH_ALL_THROW_CMSEXCEPTION()
@@ -1057,15 +1089,14 @@ void ActiveMQConnection::onCommand(const Pointer<Command> command) {
             // Check first to see if we are recovering.
             waitForTransportInterruptionProcessingToComplete();
 
-            // Look up the dispatcher.
-            Dispatcher* dispatcher = NULL;
-            synchronized(&this->config->dispatchers) {
+            this->config->dispatchLock.readLock().lock();
 
-                dispatcher = this->config->dispatchers.get(dispatch->getConsumerId());
+            try {
 
                 // If we have no registered dispatcher, the consumer was probably
                 // just closed.
-                if (dispatcher != NULL) {
+                Dispatcher* dispatcher = NULL;
+                if (this->config->dispatchers.get(*dispatch->getConsumerId(), dispatcher) && dispatcher != NULL) {
 
                     Pointer<commands::Message> message = dispatch->getMessage();
 
@@ -1075,12 +1106,22 @@ void ActiveMQConnection::onCommand(const Pointer<Command> command) {
                         message->setReadOnlyProperties(true);
                         message->setRedeliveryCounter(dispatch->getRedeliveryCounter());
                         message->setConnection(this);
+
+                        if (message->isCompressed()) {
+                            message->setCompressionContextPool(this->config->compressionPool);
+                        }
                     }
 
                     dispatcher->dispatch(dispatch);
                 }
+
+            } catch (...) {
+                this->config->dispatchLock.readLock().unlock();
+                throw;
             }
 
+            this->config->dispatchLock.readLock().unlock();
+
         } else if (command->isProducerAck()) {
 
             ProducerAck* producerAck = dynamic_cast<ProducerAck*>(command.get());
@@ -1318,6 +1359,22 @@ void ActiveMQConnection::asyncRequest(Pointer<Command> command, cms::AsyncCallba
     AMQ_CATCHALL_THROW(ActiveMQException)
 }
 
+////////////////////////////////////////////////////////////////////////////////
+Pointer<FutureResponse> ActiveMQConnection::asyncRequest(Pointer<Command> command, Pointer<ResponseCallback> onComplete) {
+
+    try {
+
+        checkClosedOrFailed();
+
+        return this->config->transport->asyncRequest(command, onComplete);
+    }
+    AMQ_CATCH_RETHROW(ActiveMQException)
+    AMQ_CATCH_EXCEPTION_CONVERT(IOException, ActiveMQException)
+    AMQ_CATCH_EXCEPTION_CONVERT(decaf::lang::exceptions::UnsupportedOperationException, ActiveMQException)
+    AMQ_CATCH_EXCEPTION_CONVERT(Exception, ActiveMQException)
+    AMQ_CATCHALL_THROW(ActiveMQException)
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 void ActiveMQConnection::checkClosed() const {
     if (this->isClosed()) {
@@ -1580,6 +1637,31 @@ void ActiveMQConnection::setCompressionLevel(int value) {
     this->config->compressionLevel = Math::min(value, 9);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+int ActiveMQConnection::getCompressionThreshold() const {
+    return this->config->compressionThreshold;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConnection::setCompressionThreshold(int value) {
+    this->config->compressionThreshold = Math::max(value, 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool ActiveMQConnection::isBackgroundCompression() const {
+    return this->config->backgroundCompression;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConnection::setBackgroundCompression(bool value) {
+    this->config->backgroundCompression = value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Pointer<activemq::util::CompressionContextPool> ActiveMQConnection::getCompressionContextPool() const {
+    return this->config->compressionPool;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 unsigned int ActiveMQConnection::getSendTimeout() const {
     return this->config->sendTimeout;
@@ -1973,3 +2055,53 @@ bool ActiveMQConnection::isConsumerExpiryCheckEnabled() {
 void ActiveMQConnection::setConsumerExpiryCheckEnabled(bool consumerExpiryCheckEnabled) {
     this->config->consumerExpiryCheckEnabled = consumerExpiryCheckEnabled;
 }
+
+////////////////////////////////////////////////////////////////////////////////
+bool ActiveMQConnection::isUseRingDispatchChannel() const {
+    return this->config->useRingDispatchChannel;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConnection::setUseRingDispatchChannel(bool value) {
+    this->config->useRingDispatchChannel = value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool ActiveMQConnection::isUseDedicatedTaskRunner() const {
+    return this->config->useDedicatedTaskRunner;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConnection::setUseDedicatedTaskRunner(bool value) {
+    this->config->useDedicatedTaskRunner = value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool ActiveMQConnection::isOptimizeDispatch() const {
+    return this->config->optimizeDispatch;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConnection::setOptimizeDispatch(bool value) {
+    this->config->optimizeDispatch = value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool ActiveMQConnection::isPipelineCreation() const {
+    return this->config->pipelineCreation;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConnection::setPipelineCreation(bool value) {
+    this->config->pipelineCreation = value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool ActiveMQConnection::isCopyMessageOnSend() const {
+    return this->config->copyMessageOnSend;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConnection::setCopyMessageOnSend(bool value) {
+    this->config->copyMessageOnSend = value;
+}
@@ -91,6 +91,7 @@ namespace core{
         bool nonBlockingRedelivery;
         bool alwaysSessionAsync;
         int compressionLevel;
+        int compressionThreshold;
         unsigned int sendTimeout;
         unsigned int connectResponseTimeout;
         unsigned int closeTimeout;
@@ -101,6 +102,12 @@ namespace core{
         long long optimizedAckScheduledAckInterval;
         long long consumerFailoverRedeliveryWaitPeriod;
         bool consumerExpiryCheckEnabled;
+        bool useRingDispatchChannel;
+        bool copyMessageOnSend;
+        bool useDedicatedTaskRunner;
+        bool optimizeDispatch;
+        bool pipelineCreation;
+        bool backgroundCompression;
 
         cms::ExceptionListener* defaultListener;
         cms::MessageTransformer* defaultTransformer;
@@ -128,6 +135,7 @@ namespace core{
                             nonBlockingRedelivery(false),
                             alwaysSessionAsync(true),
                             compressionLevel(-1),
+                            compressionThreshold(0),
                             sendTimeout(0),
                             connectResponseTimeout(0),
                             closeTimeout(15000),
@@ -138,6 +146,12 @@ namespace core{
                             optimizedAckScheduledAckInterval(0),
                             consumerFailoverRedeliveryWaitPeriod(0),
                             consumerExpiryCheckEnabled(true),
+                            useRingDispatchChannel(false),
+                            copyMessageOnSend(true),
+                            useDedicatedTaskRunner(true),
+                            optimizeDispatch(false),
+                            pipelineCreation(false),
+                            backgroundCompression(false),
                             defaultListener(NULL),
                             defaultTransformer(NULL),
                             defaultPrefetchPolicy(new DefaultPrefetchPolicy()),
@@ -176,6 +190,10 @@ namespace core{
                     core::ActiveMQConstants::CONNECTION_USECOMPRESSION), Boolean::toString(useCompression)));
             this->compressionLevel = Integer::parseInt(
                 properties->getProperty("connection.compressionLevel", Integer::toString(compressionLevel)));
+            this->compressionThreshold = Integer::parseInt(
+                properties->getProperty("connection.compressionThreshold", Integer::toString(compressionThreshold)));
+            this->backgroundCompression = Boolean::parseBoolean(
+                properties->getProperty("connection.backgroundCompression", Boolean::toString(backgroundCompression)));
             this->messagePrioritySupported = Boolean::parseBoolean(
                 properties->getProperty("connection.messagePrioritySupported", Boolean::toString(messagePrioritySupported)));
             this->checkForDuplicates = Boolean::parseBoolean(
@@ -229,6 +247,16 @@ namespace core{
                 properties->getProperty("connection.alwaysSessionAsync", Boolean::toString(alwaysSessionAsync)));
             this->consumerExpiryCheckEnabled = Boolean::parseBoolean(
                 properties->getProperty("connection.consumerExpiryCheckEnabled", Boolean::toString(consumerExpiryCheckEnabled)));
+            this->useRingDispatchChannel = Boolean::parseBoolean(
+                properties->getProperty("connection.useRingDispatchChannel", Boolean::toString(useRingDispatchChannel)));
+            this->copyMessageOnSend = Boolean::parseBoolean(
+                properties->getProperty("connection.copyMessageOnSend", Boolean::toString(copyMessageOnSend)));
+            this->useDedicatedTaskRunner = Boolean::parseBoolean(
+                properties->getProperty("connection.useDedicatedTaskRunner", Boolean::toString(useDedicatedTaskRunner)));
+            this->optimizeDispatch = Boolean::parseBoolean(
+                properties->getProperty("connection.optimizeDispatch", Boolean::toString(optimizeDispatch)));
+            this->pipelineCreation = Boolean::parseBoolean(
+                properties->getProperty("connection.pipelineCreation", Boolean::toString(pipelineCreation)));
 
             this->defaultPrefetchPolicy->configure(*properties);
             this->defaultRedeliveryPolicy->configure(*properties);
@@ -405,6 +433,8 @@ void ActiveMQConnectionFactory::configureConnection(ActiveMQConnection* connecti
     connection->setUseAsyncSend(this->settings->useAsyncSend);
     connection->setUseCompression(this->settings->useCompression);
     connection->setCompressionLevel(this->settings->compressionLevel);
+    connection->setCompressionThreshold(this->settings->compressionThreshold);
+    connection->setBackgroundCompression(this->settings->backgroundCompression);
     connection->setSendTimeout(this->settings->sendTimeout);
     connection->setConnectResponseTimeout(this->settings->connectResponseTimeout);
     connection->setCloseTimeout(this->settings->closeTimeout);
@@ -427,6 +457,11 @@ void ActiveMQConnectionFactory::configureConnection(ActiveMQConnection* connecti
     connection->setConsumerFailoverRedeliveryWaitPeriod(this->settings->consumerFailoverRedeliveryWaitPeriod);
     connection->setAlwaysSessionAsync(this->settings->alwaysSessionAsync);
     connection->setConsumerExpiryCheckEnabled(this->settings->consumerExpiryCheckEnabled);
+    connection->setUseRingDispatchChannel(this->settings->useRingDispatchChannel);
+    connection->setCopyMessageOnSend(this->settings->copyMessageOnSend);
+    connection->setUseDedicatedTaskRunner(this->settings->useDedicatedTaskRunner);
+    connection->setOptimizeDispatch(this->settings->optimizeDispatch);
+    connection->setPipelineCreation(this->settings->pipelineCreation);
 
     if (this->settings->defaultListener) {
         connection->setExceptionListener(this->settings->defaultListener);
@@ -589,6 +624,26 @@ void ActiveMQConnectionFactory::setCompressionLevel(int value) {
     this->settings->compressionLevel = Math::min(value, 9);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+int ActiveMQConnectionFactory::getCompressionThreshold() const {
+    return this->settings->compressionThreshold;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConnectionFactory::setCompressionThreshold(int value) {
+    this->settings->compressionThreshold = Math::max(value, 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool ActiveMQConnectionFactory::isBackgroundCompression() const {
+    return this->settings->backgroundCompression;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConnectionFactory::setBackgroundCompression(bool value) {
+    this->settings->backgroundCompression = value;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 unsigned int ActiveMQConnectionFactory::getSendTimeout() const {
     return this->settings->sendTimeout;
@@ -778,3 +833,53 @@ bool ActiveMQConnectionFactory::isConsumerExpiryCheckEnabled() {
 void ActiveMQConnectionFactory::setConsumerExpiryCheckEnabled(bool consumerExpiryCheckEnabled) {
     this->settings->consumerExpiryCheckEnabled = consumerExpiryCheckEnabled;
 }
+
+////////////////////////////////////////////////////////////////////////////////
+bool ActiveMQConnectionFactory::isUseRingDispatchChannel() const {
+    return this->settings->useRingDispatchChannel;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConnectionFactory::setUseRingDispatchChannel(bool value) {
+    this->settings->useRingDispatchChannel = value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool ActiveMQConnectionFactory::isUseDedicatedTaskRunner() const {
+    return this->settings->useDedicatedTaskRunner;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConnectionFactory::setUseDedicatedTaskRunner(bool value) {
+    this->settings->useDedicatedTaskRunner = value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool ActiveMQConnectionFactory::isOptimizeDispatch() const {
+    return this->settings->optimizeDispatch;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConnectionFactory::setOptimizeDispatch(bool value) {
+    this->settings->optimizeDispatch = value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool ActiveMQConnectionFactory::isPipelineCreation() const {
+    return this->settings->pipelineCreation;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConnectionFactory::setPipelineCreation(bool value) {
+    this->settings->pipelineCreation = value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool ActiveMQConnectionFactory::isCopyMessageOnSend() const {
+    return this->settings->copyMessageOnSend;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConnectionFactory::setCopyMessageOnSend(bool value) {
+    this->settings->copyMessageOnSend = value;
+}
@@ -367,6 +367,40 @@ namespace core {
          */
         int getCompressionLevel() const;
 
+        /**
+         * Gets the size a Message body has to reach before it is compressed.
+         *
+         * @return the compression threshold in bytes.
+         */
+        int getCompressionThreshold() const;
+
+        /**
+         * Sets the size in bytes that a BytesMessage or TextMessage body has to reach before
+         * it is compressed when Message body compression is enabled, smaller bodies are sent
+         * as they are.  The default of zero compresses every body.
+         *
+         * @param value
+         *      The smallest body size in bytes that is compressed.
+         */
+        void setCompressionThreshold(int value);
+
+        /**
+         * @return true if asynchronous sends of compressed Messages are compressed and
+         *         sent in the background.
+         */
+        bool isBackgroundCompression() const;
+
+        /**
+         * Sets whether the asynchronous sends of Messages that are to be compressed hand the
+         * compression and the send to the shared thread pool rather than doing them on the
+         * sending thread, each Session's messages still reach the broker in the order they
+         * were sent.  This option is disabled by default.
+         *
+         * @param value
+         *      True if compressed asynchronous sends should be done in the background.
+         */
+        void setBackgroundCompression(bool value);
+
         /**
          * Gets the assigned send timeout for this Connector
          * @return the send timeout configured in the connection uri
@@ -686,6 +720,100 @@ namespace core {
          */
         void setConsumerExpiryCheckEnabled(bool consumerExpiryCheckEnabled);
 
+        /**
+         * @return true if sessions and consumers hand messages off through a
+         *         RingMessageDispatchChannel.
+         */
+        bool isUseRingDispatchChannel() const;
+
+        /**
+         * When enabled the session and consumer dispatch channels are lock free rings
+         * sized to the consumer prefetch instead of monitor guarded lists, letting the
+         * transport thread queue a message without contending with the thread that
+         * delivers it.  Has no effect when message priority support is enabled.  This
+         * option is disabled by default.
+         *
+         * @param value
+         *      True if the ring dispatch channel should be used.
+         */
+        void setUseRingDispatchChannel(bool value);
+
+        /**
+         * @return true if each session delivers messages to its listeners from a thread
+         *         of its own.
+         */
+        bool isUseDedicatedTaskRunner() const;
+
+        /**
+         * Sets whether each session that delivers messages asynchronously gets a thread
+         * of its own, or shares the process wide WorkStealingThreadPool whose thread
+         * count follows the number of processors.  The messages of a session are still
+         * delivered one at a time and in order on the shared pool.  This option is
+         * enabled by default.
+         *
+         * @param value
+         *      False if sessions should deliver messages from the shared pool.
+         */
+        void setUseDedicatedTaskRunner(bool value);
+
+        /**
+         * @return true if listeners of auto and dups ok acknowledge sessions are called
+         *         on the optimized dispatch path.
+         */
+        bool isOptimizeDispatch() const;
+
+        /**
+         * Sets whether consumers of AUTO_ACKNOWLEDGE and DUPS_OK_ACKNOWLEDGE sessions
+         * that have a MessageListener hand each message straight to the listener.  On
+         * this path the listener's copy of the message shares the received body bytes, no
+         * delivered list is kept and the messages consumed while the session has more
+         * dispatches queued are acknowledged together with a single ack.  Consumers of
+         * other sessions, and those with a MessageTransformer, are not affected.  This
+         * option is disabled by default.
+         *
+         * @param value
+         *      True if listeners should be called on the optimized dispatch path.
+         */
+        void setOptimizeDispatch(bool value);
+
+        /**
+         * @return true if consumers and producers are created without waiting for the
+         *         broker to respond.
+         */
+        bool isPipelineCreation() const;
+
+        /**
+         * Sets whether the ConsumerInfo and ProducerInfo commands that create consumers and
+         * producers are sent without waiting for the broker's response.  Creating many
+         * resources then takes about one round trip instead of one for each.  Each resource
+         * waits for its response the first time it is used, and if the broker refused to
+         * create it that use and every later one throws the broker's error.  This option
+         * is disabled by default.
+         *
+         * @param value
+         *      True if resource creation should not wait for the broker's response.
+         */
+        void setPipelineCreation(bool value);
+
+        /**
+         * @return true if producers copy each message before sending it.
+         */
+        bool isCopyMessageOnSend() const;
+
+        /**
+         * Sets whether producers copy each message before sending it, which lets the
+         * caller reuse or delete the message once send returns.  When disabled the
+         * producer marshals the ActiveMQ message it is given without copying it and
+         * takes ownership of it whether or not the send succeeds, so the caller must
+         * give up any reference it holds.  Producers can override this setting with
+         * the producer.copyMessageOnSend destination option.  This option is enabled
+         * by default.
+         *
+         * @param value
+         *      False if producers should send messages without copying them.
+         */
+        void setCopyMessageOnSend(bool value);
+
     public:
 
         /**
@@ -90,6 +90,28 @@ namespace core {
 
     public:
 
+        /**
+         * Receives up to maxMessages messages in a single call.  The call waits up to the
+         * given time for the first message, a timeout of zero waits indefinitely as
+         * receive(int) does, and then takes whatever further messages the Consumer has
+         * already been sent without waiting for more.  Taking the messages as a batch
+         * locks the Consumer's dispatch channel once for the whole batch, and in the
+         * AUTO_ACKNOWLEDGE mode the batch is acknowledged with a single ack.
+         *
+         * The caller owns the returned messages and must delete them.
+         *
+         * @param maxMessages
+         *      The maximum number of messages to return, must be greater than zero.
+         * @param millisecs
+         *      The time in milliseconds to wait for the first message.
+         *
+         * @return the received messages in delivery order, empty if no message arrived
+         *         in time or the Consumer was closed.
+         *
+         * @throws CMSException if an error occurs while receiving.
+         */
+        std::vector<cms::Message*> receiveBatch(int maxMessages, int millisecs);
+
         /**
          * Get the Consumer information for this consumer
          * @return Reference to a Consumer Info Object
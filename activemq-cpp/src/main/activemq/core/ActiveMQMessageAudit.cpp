@@ -60,17 +60,23 @@ namespace core {
 
         LRUCache<std::string, Pointer<BitSet> > map;
 
+        // Ids that arrive as a MessageId are tracked by the numeric ProducerId itself
+        // so that auditing a message never renders its id as a string.
+        LRUCache<ProducerId, Pointer<BitSet> > producers;
+
         MessageAuditImpl() : auditDepth(2048),
                              maximumNumberOfProducersToTrack(64),
                              mutex(),
-                             map() {
+                             map(),
+                             producers() {
         }
 
         MessageAuditImpl(int auditDepth, int maximumNumberOfProducersToTrack) :
             auditDepth(auditDepth),
             maximumNumberOfProducersToTrack(maximumNumberOfProducersToTrack),
             mutex(),
-            map() {
+            map(),
+            producers() {
         }
 
         void adjustMaxProducersToTrack(int value) {
@@ -83,8 +89,14 @@ namespace core {
                 newMap.putAll(this->map);
                 this->map.clear();
                 this->map.putAll(newMap);
+
+                LRUCache<ProducerId, Pointer<BitSet> > newProducers(0, value, 0.75f, true);
+                newProducers.putAll(this->producers);
+                this->producers.clear();
+                this->producers.putAll(newProducers);
             }
             this->map.setMaxCacheSize(value);
+            this->producers.setMaxCacheSize(value);
             this->maximumNumberOfProducersToTrack = value;
         }
     };
@@ -168,30 +180,27 @@ bool ActiveMQMessageAudit::isDuplicate(decaf::lang::Pointer<MessageId> msgId) co
     if (msgId != NULL) {
         Pointer<ProducerId> pid = msgId->getProducerId();
         if (pid != NULL) {
-            std::string seed = pid->toString();
-            if (!seed.empty()) {
 
-                synchronized(&this->impl->mutex) {
+            synchronized(&this->impl->mutex) {
 
-                    Pointer<BitSet> bits;
-                    try {
-                        bits = this->impl->map.get(seed);
-                    } catch (NoSuchElementException& ex) {
-                        bits.reset(new BitSet(this->impl->auditDepth));
-                        this->impl->map.put(seed, bits);
-                    }
+                Pointer<BitSet> bits;
+                try {
+                    bits = this->impl->producers.get(*pid);
+                } catch (NoSuchElementException& ex) {
+                    bits.reset(new BitSet(this->impl->auditDepth));
+                    this->impl->producers.put(*pid, bits);
+                }
 
-                    long long index = msgId->getProducerSequenceId();
-                    if (index >= 0) {
-                        int scaledIndex = (int) index;
-                        if (index > Integer::MAX_VALUE) {
-                            scaledIndex = (int)(index - Integer::MAX_VALUE);
-                        }
+                long long index = msgId->getProducerSequenceId();
+                if (index >= 0) {
+                    int scaledIndex = (int) index;
+                    if (index > Integer::MAX_VALUE) {
+                        scaledIndex = (int)(index - Integer::MAX_VALUE);
+                    }
 
-                        answer = bits->get(scaledIndex);
-                        if (!answer) {
-                            bits->set(scaledIndex, true);
-                        }
+                    answer = bits->get(scaledIndex);
+                    if (!answer) {
+                        bits->set(scaledIndex, true);
                     }
                 }
             }
@@ -233,27 +242,24 @@ void ActiveMQMessageAudit::rollback(decaf::lang::Pointer<commands::MessageId> ms
     if (msgId != NULL) {
         Pointer<ProducerId> pid = msgId->getProducerId();
         if (pid != NULL) {
-            std::string seed = pid->toString();
-            if (!seed.empty()) {
-
-                synchronized(&this->impl->mutex) {
 
-                    Pointer<BitSet> bits;
-                    try {
-                        bits = this->impl->map.get(seed);
-                    } catch (NoSuchElementException& ex) {
-                    }
+            synchronized(&this->impl->mutex) {
 
-                    if (bits != NULL) {
-                        long long index = msgId->getProducerSequenceId();
-                        if (index >= 0) {
-                            int scaledIndex = (int) index;
-                            if (index > Integer::MAX_VALUE) {
-                                scaledIndex = (int)(index - Integer::MAX_VALUE);
-                            }
+                Pointer<BitSet> bits;
+                try {
+                    bits = this->impl->producers.get(*pid);
+                } catch (NoSuchElementException& ex) {
+                }
 
-                            bits->set(scaledIndex, false);
+                if (bits != NULL) {
+                    long long index = msgId->getProducerSequenceId();
+                    if (index >= 0) {
+                        int scaledIndex = (int) index;
+                        if (index > Integer::MAX_VALUE) {
+                            scaledIndex = (int)(index - Integer::MAX_VALUE);
                         }
+
+                        bits->set(scaledIndex, false);
                     }
                 }
             }
@@ -302,27 +308,24 @@ bool ActiveMQMessageAudit::isInOrder(decaf::lang::Pointer<commands::MessageId> m
     if (msgId != NULL) {
         Pointer<ProducerId> pid = msgId->getProducerId();
         if (pid != NULL) {
-            std::string seed = pid->toString();
-            if (!seed.empty()) {
 
-                synchronized(&this->impl->mutex) {
+            synchronized(&this->impl->mutex) {
 
-                    Pointer<BitSet> bits;
-                    try {
-                        bits = this->impl->map.get(seed);
-                    } catch (NoSuchElementException& ex) {
-                        bits.reset(new BitSet(this->impl->auditDepth));
-                        this->impl->map.put(seed, bits);
-                    }
+                Pointer<BitSet> bits;
+                try {
+                    bits = this->impl->producers.get(*pid);
+                } catch (NoSuchElementException& ex) {
+                    bits.reset(new BitSet(this->impl->auditDepth));
+                    this->impl->producers.put(*pid, bits);
+                }
 
-                    long long index = msgId->getProducerSequenceId();
-                    if (index >= 0) {
-                        int scaledIndex = (int) index;
-                        if (index > Integer::MAX_VALUE) {
-                            scaledIndex = (int)(index - Integer::MAX_VALUE);
-                        }
-                        answer = ((bits->length() - 1) == scaledIndex);
+                long long index = msgId->getProducerSequenceId();
+                if (index >= 0) {
+                    int scaledIndex = (int) index;
+                    if (index > Integer::MAX_VALUE) {
+                        scaledIndex = (int)(index - Integer::MAX_VALUE);
                     }
+                    answer = ((bits->length() - 1) == scaledIndex);
                 }
             }
         }
@@ -334,20 +337,17 @@ bool ActiveMQMessageAudit::isInOrder(decaf::lang::Pointer<commands::MessageId> m
 long long ActiveMQMessageAudit::getLastSeqId(decaf::lang::Pointer<commands::ProducerId> id) const {
     long result = -1;
     if (id != NULL) {
-        std::string seed = id->toString();
-        if (!seed.empty()) {
 
-            synchronized(&this->impl->mutex) {
+        synchronized(&this->impl->mutex) {
 
-                Pointer<BitSet> bits;
-                try {
-                    bits = this->impl->map.get(seed);
-                } catch (NoSuchElementException& ex) {
-                }
+            Pointer<BitSet> bits;
+            try {
+                bits = this->impl->producers.get(*id);
+            } catch (NoSuchElementException& ex) {
+            }
 
-                if (bits != NULL) {
-                    result = bits->length() - 1;
-                }
+            if (bits != NULL) {
+                result = bits->length() - 1;
             }
         }
     }
@@ -357,4 +357,5 @@ long long ActiveMQMessageAudit::getLastSeqId(decaf::lang::Pointer<commands::Prod
 ////////////////////////////////////////////////////////////////////////////////
 void ActiveMQMessageAudit::clear() {
     this->impl->map.clear();
+    this->impl->producers.clear();
 }
@@ -80,6 +80,22 @@ void ActiveMQSession::rollback() {
     AMQ_CATCH_ALL_THROW_CMSEXCEPTION()
 }
 
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQSession::commit(cms::AsyncCallback* onComplete) {
+    try {
+        this->kernel->commit(onComplete);
+    }
+    AMQ_CATCH_ALL_THROW_CMSEXCEPTION()
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQSession::rollback(cms::AsyncCallback* onComplete) {
+    try {
+        this->kernel->rollback(onComplete);
+    }
+    AMQ_CATCH_ALL_THROW_CMSEXCEPTION()
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 void ActiveMQSession::recover() {
     try {
@@ -83,6 +83,41 @@ namespace core {
 
         virtual void recover();
 
+        /**
+         * Commits the current transaction without waiting for the broker to respond, the
+         * session can begin its next transaction while the commit is in flight.  Once the
+         * broker responds the transaction's consumers and producers are notified of the
+         * outcome and then the callback is, from the connection's executor thread.
+         *
+         * If the commit fails the consumers redeliver the messages from the failed
+         * transaction, those delivered since in the session's current transaction are
+         * not affected.
+         *
+         * @param onComplete
+         *      The callback notified when the commit completes, if NULL the commit is
+         *      done synchronously.
+         *
+         * @throws CMSException if the session is closed or not transacted or the
+         *         commit could not be sent.
+         */
+        virtual void commit(cms::AsyncCallback* onComplete);
+
+        /**
+         * Rolls back the current transaction without waiting for the broker to respond, the
+         * session can begin its next transaction while the rollback is in flight.  Once the
+         * broker responds the transaction's consumers redeliver their messages and then the
+         * callback is notified, from the connection's executor thread.  Messages delivered
+         * since in the session's current transaction are not affected.
+         *
+         * @param onComplete
+         *      The callback notified when the rollback completes, if NULL the rollback is
+         *      done synchronously.
+         *
+         * @throws CMSException if the session is closed or not transacted or the
+         *         rollback could not be sent.
+         */
+        virtual void rollback(cms::AsyncCallback* onComplete);
+
         virtual cms::MessageConsumer* createConsumer(const cms::Destination* destination);
 
         virtual cms::MessageConsumer* createConsumer(const cms::Destination* destination,
@@ -22,9 +22,11 @@
 #include <activemq/core/kernels/ActiveMQSessionKernel.h>
 #include <activemq/core/ActiveMQSession.h>
 #include <activemq/core/FifoMessageDispatchChannel.h>
+#include <activemq/core/RingMessageDispatchChannel.h>
 #include <activemq/core/SimplePriorityMessageDispatchChannel.h>
 #include <activemq/commands/ConsumerInfo.h>
 #include <activemq/threads/DedicatedTaskRunner.h>
+#include <activemq/threads/PooledTaskRunner.h>
 
 using namespace std;
 using namespace activemq;
@@ -42,6 +44,8 @@ ActiveMQSessionExecutor::ActiveMQSessionExecutor(ActiveMQSessionKernel* session)
 
     if (this->session->getConnection()->isMessagePrioritySupported()) {
         this->messageQueue.reset(new SimplePriorityMessageDispatchChannel());
+    } else if (this->session->getConnection()->isUseRingDispatchChannel()) {
+        this->messageQueue.reset(new RingMessageDispatchChannel());
     } else {
         this->messageQueue.reset(new FifoMessageDispatchChannel());
     }
@@ -110,7 +114,11 @@ void ActiveMQSessionExecutor::wakeup() {
             if (!messageQueue->isRunning()) {
                 return;
             }
-            this->taskRunner.reset(new DedicatedTaskRunner(this));
+            if (this->session->getConnection()->isUseDedicatedTaskRunner()) {
+                this->taskRunner.reset(new DedicatedTaskRunner(this));
+            } else {
+                this->taskRunner.reset(new PooledTaskRunner(this));
+            }
             this->taskRunner->start();
         }
 
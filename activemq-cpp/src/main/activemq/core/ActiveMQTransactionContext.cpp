@@ -27,14 +27,20 @@
 #include <activemq/commands/Response.h>
 #include <activemq/commands/IntegerResponse.h>
 #include <activemq/commands/DataArrayResponse.h>
+#include <activemq/commands/ExceptionResponse.h>
 #include <activemq/commands/LocalTransactionId.h>
 #include <activemq/commands/XATransactionId.h>
 #include <activemq/util/CMSExceptionSupport.h>
+#include <activemq/exceptions/BrokerException.h>
+#include <activemq/transport/ResponseCallback.h>
 #include <decaf/lang/exceptions/NullPointerException.h>
 #include <decaf/lang/Integer.h>
 #include <decaf/lang/Long.h>
+#include <decaf/lang/Runnable.h>
 #include <decaf/util/Iterator.h>
 #include <decaf/util/concurrent/ConcurrentStlMap.h>
+#include <decaf/util/concurrent/ExecutorService.h>
+#include <decaf/util/concurrent/atomic/AtomicBoolean.h>
 
 using namespace std;
 using namespace cms;
@@ -44,11 +50,13 @@ using namespace activemq::core::kernels;
 using namespace activemq::commands;
 using namespace activemq::exceptions;
 using namespace activemq::util;
+using namespace activemq::transport;
 using namespace decaf;
 using namespace decaf::lang;
 using namespace decaf::lang::exceptions;
 using namespace decaf::util;
 using namespace decaf::util::concurrent;
+using namespace decaf::util::concurrent::atomic;
 
 ////////////////////////////////////////////////////////////////////////////////
 namespace activemq{
@@ -101,6 +109,174 @@ namespace {
         }
     };
 
+    void notifyAfterCommit(decaf::util::StlSet< Pointer<Synchronization> >& syncs) {
+
+        std::auto_ptr<decaf::util::Iterator< Pointer<Synchronization> > > iter(syncs.iterator());
+
+        while (iter->hasNext()) {
+            iter->next()->afterCommit();
+        }
+    }
+
+    void notifyAfterRollback(decaf::util::StlSet< Pointer<Synchronization> >& syncs) {
+
+        std::auto_ptr<decaf::util::Iterator< Pointer<Synchronization> > > iter(syncs.iterator());
+
+        while (iter->hasNext()) {
+            iter->next()->afterRollback();
+        }
+    }
+
+    /**
+     * Completes a transaction that was committed or rolled back asynchronously, it owns
+     * the Synchronizations that were registered with the transaction so the context is
+     * free to begin the next one while the request is in flight.
+     */
+    class TransactionOutcome {
+    private:
+
+        decaf::util::StlSet< Pointer<Synchronization> > synchronizations;
+        cms::AsyncCallback* callback;
+        bool commit;
+        AtomicBoolean completed;
+
+    private:
+
+        TransactionOutcome(const TransactionOutcome&);
+        TransactionOutcome& operator=(const TransactionOutcome&);
+
+    public:
+
+        TransactionOutcome(decaf::util::StlSet< Pointer<Synchronization> >& synchronizations,
+                           cms::AsyncCallback* callback, bool commit) :
+            synchronizations(synchronizations), callback(callback), commit(commit), completed() {
+        }
+
+        virtual ~TransactionOutcome() {
+        }
+
+        /**
+         * Rolls back the transaction's Synchronizations when the request could not be sent,
+         * the callback is not notified as the caller gets the error instead.
+         */
+        void abort() {
+            if (this->completed.compareAndSet(false, true)) {
+                Finally finalizer(&this->synchronizations);
+                notifyAfterRollback(this->synchronizations);
+            }
+        }
+
+        void complete(Pointer<commands::Response> response) {
+
+            if (!this->completed.compareAndSet(false, true)) {
+                return;
+            }
+
+            Finally finalizer(&this->synchronizations);
+
+            commands::ExceptionResponse* exceptionResponse =
+                dynamic_cast<commands::ExceptionResponse*>(response.get());
+
+            if (exceptionResponse != NULL) {
+
+                try {
+                    notifyAfterRollback(this->synchronizations);
+                } catch (...) {
+                }
+
+                Exception ex = exceptionResponse->getException()->createExceptionObject();
+                const cms::CMSException* cmsError = dynamic_cast<const cms::CMSException*>(ex.getCause());
+                if (cmsError != NULL) {
+                    this->callback->onException(*cmsError);
+                } else {
+                    BrokerException error = BrokerException(__FILE__, __LINE__, exceptionResponse->getException()->getMessage().c_str());
+                    this->callback->onException(error.convertToCMSException());
+                }
+
+                return;
+            }
+
+            try {
+                if (this->commit) {
+                    notifyAfterCommit(this->synchronizations);
+                } else {
+                    notifyAfterRollback(this->synchronizations);
+                }
+            } catch (cms::CMSException& ex) {
+                this->callback->onException(ex);
+                return;
+            } catch (Exception& ex) {
+                this->callback->onException(CMSExceptionSupport::create(ex));
+                return;
+            }
+
+            this->callback->onSuccess();
+        }
+    };
+
+    class CompleteTransactionTask : public Runnable {
+    private:
+
+        Pointer<TransactionOutcome> outcome;
+        Pointer<commands::Response> response;
+
+    private:
+
+        CompleteTransactionTask(const CompleteTransactionTask&);
+        CompleteTransactionTask& operator=(const CompleteTransactionTask&);
+
+    public:
+
+        CompleteTransactionTask(Pointer<TransactionOutcome> outcome, Pointer<commands::Response> response) :
+            Runnable(), outcome(outcome), response(response) {
+        }
+
+        virtual ~CompleteTransactionTask() {}
+
+        virtual void run() {
+            this->outcome->complete(this->response);
+        }
+    };
+
+    /**
+     * Receives the broker's response on the transport's thread and hands the outcome to
+     * the connection's executor.  The Synchronizations redeliver and acknowledge messages,
+     * which may need a response of their own that the transport's thread would then
+     * never read.
+     */
+    class TransactionCompletion : public ResponseCallback {
+    private:
+
+        Pointer<TransactionOutcome> outcome;
+        ExecutorService* executor;
+
+    private:
+
+        TransactionCompletion(const TransactionCompletion&);
+        TransactionCompletion& operator=(const TransactionCompletion&);
+
+    public:
+
+        TransactionCompletion(Pointer<TransactionOutcome> outcome, ExecutorService* executor) :
+            ResponseCallback(), outcome(outcome), executor(executor) {
+        }
+
+        virtual ~TransactionCompletion() {
+        }
+
+        virtual void onComplete(Pointer<commands::Response> response) {
+
+            try {
+                this->executor->execute(new CompleteTransactionTask(this->outcome, response));
+                return;
+            } catch (Exception&) {
+            }
+
+            // The connection is closing and its executor no longer takes tasks.
+            this->outcome->complete(response);
+        }
+    };
+
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -257,6 +433,88 @@ void ActiveMQTransactionContext::rollback() {
     AMQ_CATCHALL_THROW(ActiveMQException)
 }
 
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQTransactionContext::commit(cms::AsyncCallback* onComplete) {
+
+    try{
+
+        if (onComplete == NULL) {
+            this->commit();
+            return;
+        }
+
+        if (isInXATransaction()) {
+            throw cms::TransactionInProgressException("Cannot Commit a local transaction while an XA Transaction is in progress.");
+        }
+
+        try {
+            this->beforeEnd();
+        } catch (cms::CMSException& ex) {
+            rollback();
+            throw;
+        }
+
+        if (isInTransaction()) {
+            Pointer<TransactionInfo> info(new TransactionInfo());
+            info->setConnectionId(this->connection->getConnectionInfo().getConnectionId());
+            info->setTransactionId(this->context->transactionId);
+            info->setType(ActiveMQConstants::TRANSACTION_STATE_COMMITONEPHASE);
+
+            // Clearing the id ends this transaction, the next one can begin right away.
+            this->context->transactionId.reset(NULL);
+
+            this->endAsync(info, onComplete, true);
+        } else {
+            onComplete->onSuccess();
+        }
+    }
+    AMQ_CATCH_RETHROW(cms::CMSException)
+    AMQ_CATCH_RETHROW(ActiveMQException)
+    AMQ_CATCH_EXCEPTION_CONVERT(Exception, ActiveMQException)
+    AMQ_CATCHALL_THROW(ActiveMQException)
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQTransactionContext::rollback(cms::AsyncCallback* onComplete) {
+
+    try{
+
+        if (onComplete == NULL) {
+            this->rollback();
+            return;
+        }
+
+        if (isInXATransaction()) {
+            throw cms::TransactionInProgressException("Cannot Rollback a local transaction while an XA Transaction is in progress.");
+        }
+
+        try {
+            this->beforeEnd();
+        } catch (cms::TransactionRolledBackException& ex) {
+            // Ignore, can occur on failover if the last command was commit.
+        }
+
+        if (isInTransaction()) {
+
+            Pointer<TransactionInfo> info(new TransactionInfo());
+            info->setConnectionId(this->connection->getConnectionInfo().getConnectionId());
+            info->setTransactionId(this->context->transactionId);
+            info->setType(ActiveMQConstants::TRANSACTION_STATE_ROLLBACK);
+
+            // Clearing the id ends this transaction, the next one can begin right away.
+            this->context->transactionId.reset(NULL);
+
+            this->endAsync(info, onComplete, false);
+        } else {
+            onComplete->onSuccess();
+        }
+    }
+    AMQ_CATCH_RETHROW(cms::CMSException)
+    AMQ_CATCH_RETHROW(ActiveMQException)
+    AMQ_CATCH_EXCEPTION_CONVERT(Exception, ActiveMQException)
+    AMQ_CATCHALL_THROW(ActiveMQException)
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 void ActiveMQTransactionContext::beforeEnd() {
 
@@ -279,13 +537,7 @@ void ActiveMQTransactionContext::afterCommit() {
     synchronized(&this->synchronizations) {
 
         Finally finalizer(&this->synchronizations);
-
-        std::auto_ptr<decaf::util::Iterator<Pointer<Synchronization> > > iter(
-            this->synchronizations.iterator());
-
-        while (iter->hasNext()) {
-            iter->next()->afterCommit();
-        }
+        notifyAfterCommit(this->synchronizations);
     }
 }
 
@@ -295,14 +547,29 @@ void ActiveMQTransactionContext::afterRollback() {
     // Notify each registered Synchronization that we rolled back this Transaction.
     synchronized(&this->synchronizations) {
 
-        Finally finalizer( &this->synchronizations );
+        Finally finalizer(&this->synchronizations);
+        notifyAfterRollback(this->synchronizations);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQTransactionContext::endAsync(Pointer<TransactionInfo> info, cms::AsyncCallback* onComplete, bool commit) {
 
-        std::auto_ptr<decaf::util::Iterator< Pointer<Synchronization> > > iter(
-            this->synchronizations.iterator() );
+    // The completion takes over this transaction's Synchronizations, those registered
+    // from here on belong to the next transaction.
+    Pointer<TransactionOutcome> outcome;
+    synchronized(&this->synchronizations) {
+        outcome.reset(new TransactionOutcome(this->synchronizations, onComplete, commit));
+        this->synchronizations.clear();
+    }
 
-        while( iter->hasNext() ) {
-            iter->next()->afterRollback();
-        }
+    Pointer<ResponseCallback> completion(new TransactionCompletion(outcome, this->connection->getExecutor()));
+
+    try {
+        this->connection->asyncRequest(info.dynamicCast<Command>(), completion);
+    } catch (Exception& ex) {
+        outcome->abort();
+        throw;
     }
 }
 
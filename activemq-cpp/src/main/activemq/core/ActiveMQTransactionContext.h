@@ -19,6 +19,7 @@
 
 #include <memory>
 
+#include <cms/AsyncCallback.h>
 #include <cms/Message.h>
 #include <cms/XAResource.h>
 #include <cms/CMSException.h>
@@ -27,6 +28,7 @@
 #include <activemq/util/Config.h>
 #include <activemq/exceptions/ActiveMQException.h>
 #include <activemq/commands/LocalTransactionId.h>
+#include <activemq/commands/TransactionInfo.h>
 #include <activemq/core/Synchronization.h>
 #include <activemq/util/LongSequenceGenerator.h>
 
@@ -121,6 +123,40 @@ namespace kernels {
          */
         virtual void rollback();
 
+        /**
+         * Commits the current Transaction without waiting for the broker to respond.  The
+         * transaction is ended before this method returns so the session can begin its
+         * next transaction while the commit is in flight, the registered Synchronizations
+         * are notified of the outcome once the broker responds and then the callback is.
+         * Both run on the connection's executor thread and never on the transport's, so
+         * they are free to send requests of their own.
+         *
+         * If the broker fails the commit the transaction's Synchronizations are rolled back,
+         * consumers redeliver only the messages they had delivered in it.
+         *
+         * @param onComplete
+         *      The callback notified when the commit completes, if NULL the commit is
+         *      done synchronously.
+         *
+         * @throw ActiveMQException if the commit could not be sent.
+         */
+        virtual void commit(cms::AsyncCallback* onComplete);
+
+        /**
+         * Rolls back the current Transaction without waiting for the broker to respond.  The
+         * transaction is ended before this method returns so the session can begin its
+         * next transaction while the rollback is in flight, the registered Synchronizations
+         * are notified once the broker responds and then the callback is, both on the
+         * connection's executor thread.
+         *
+         * @param onComplete
+         *      The callback notified when the rollback completes, if NULL the rollback is
+         *      done synchronously.
+         *
+         * @throw ActiveMQException if the rollback could not be sent.
+         */
+        virtual void rollback(cms::AsyncCallback* onComplete);
+
         /**
          * Get the Transaction Id object for the current
          * Transaction, returns NULL if no transaction is running
@@ -187,6 +223,8 @@ namespace kernels {
         void afterCommit();
         void afterRollback();
 
+        void endAsync(Pointer<commands::TransactionInfo> info, cms::AsyncCallback* onComplete, bool commit);
+
     };
 
 }}
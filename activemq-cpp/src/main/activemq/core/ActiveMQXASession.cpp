@@ -62,6 +62,16 @@ void ActiveMQXASession::rollback() {
     throw cms::TransactionInProgressException("Cannot rollback inside an XASession");
 }
 
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQXASession::commit(cms::AsyncCallback* onComplete AMQCPP_UNUSED) {
+    throw cms::TransactionInProgressException("Cannot commit inside an XASession");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQXASession::rollback(cms::AsyncCallback* onComplete AMQCPP_UNUSED) {
+    throw cms::TransactionInProgressException("Cannot rollback inside an XASession");
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 cms::XAResource* ActiveMQXASession::getXAResource() const {
     return this->xaKernel->getXAResource();
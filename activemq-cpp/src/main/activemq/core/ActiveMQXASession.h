@@ -57,6 +57,10 @@ namespace core {
 
         virtual void rollback();
 
+        virtual void commit(cms::AsyncCallback* onComplete);
+
+        virtual void rollback(cms::AsyncCallback* onComplete);
+
     public:  // XASession overrides
 
         virtual cms::XAResource* getXAResource() const;
@@ -0,0 +1,140 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "BackgroundCompressor.h"
+
+#include <activemq/core/ActiveMQConnection.h>
+#include <activemq/exceptions/ActiveMQException.h>
+#include <activemq/threads/PooledTaskRunner.h>
+
+using namespace activemq;
+using namespace activemq::core;
+using namespace activemq::commands;
+using namespace activemq::exceptions;
+using namespace activemq::threads;
+using namespace activemq::util;
+using namespace decaf::lang;
+using namespace decaf::lang::exceptions;
+using namespace decaf::util::concurrent;
+
+////////////////////////////////////////////////////////////////////////////////
+BackgroundCompressor::BackgroundCompressor(ActiveMQConnection* connection) :
+    connection(connection), queue(), queueMutex(), sendMutex(), pending(0), taskRunner() {
+
+    if (connection == NULL) {
+        throw NullPointerException(__FILE__, __LINE__, "Connection cannot be NULL");
+    }
+
+    this->taskRunner.reset(new PooledTaskRunner(this));
+    this->taskRunner->start();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+BackgroundCompressor::~BackgroundCompressor() {
+    try {
+        this->taskRunner->shutdown();
+    }
+    AMQ_CATCHALL_NOTHROW()
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void BackgroundCompressor::send(const Pointer<Message>& message, MemoryUsage* producerWindow) {
+
+    synchronized(&this->queueMutex) {
+        this->queue.addLast(Pointer<PendingSend>(new PendingSend(message, producerWindow)));
+        this->pending.incrementAndGet();
+    }
+
+    this->taskRunner->wakeup();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void BackgroundCompressor::drain() {
+
+    try {
+        // Each call waits for a send in progress on the pool, so the last one has
+        // gone out too once the queue is found empty.
+        while (sendNext()) {
+        }
+    }
+    AMQ_CATCH_RETHROW(ActiveMQException)
+    AMQ_CATCH_EXCEPTION_CONVERT(Exception, ActiveMQException)
+    AMQ_CATCHALL_THROW(ActiveMQException)
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void BackgroundCompressor::close() {
+
+    try {
+        this->taskRunner->shutdown();
+        drain();
+    }
+    AMQ_CATCH_RETHROW(ActiveMQException)
+    AMQ_CATCH_EXCEPTION_CONVERT(Exception, ActiveMQException)
+    AMQ_CATCHALL_THROW(ActiveMQException)
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool BackgroundCompressor::iterate() {
+
+    try {
+        sendNext();
+    } catch (Exception& ex) {
+        this->connection->onAsyncException(ex);
+    }
+
+    synchronized(&this->queueMutex) {
+        return !this->queue.isEmpty();
+    }
+
+    return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool BackgroundCompressor::sendNext() {
+
+    // Held across the send so that a Message taken from the queue is on the wire before
+    // the next one is taken, whichever thread sends it.
+    synchronized(&this->sendMutex) {
+
+        Pointer<PendingSend> next;
+
+        synchronized(&this->queueMutex) {
+            if (this->queue.isEmpty()) {
+                return false;
+            }
+
+            next = this->queue.removeFirst();
+        }
+
+        try {
+            next->message->compress();
+            this->connection->oneway(next->message);
+
+            if (next->producerWindow != NULL) {
+                next->producerWindow->enqueueUsage(next->message->getSize());
+            }
+        } catch (...) {
+            this->pending.decrementAndGet();
+            throw;
+        }
+
+        this->pending.decrementAndGet();
+    }
+
+    return true;
+}
@@ -0,0 +1,129 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_CORE_BACKGROUNDCOMPRESSOR_H_
+#define _ACTIVEMQ_CORE_BACKGROUNDCOMPRESSOR_H_
+
+#include <activemq/util/Config.h>
+#include <activemq/commands/Message.h>
+#include <activemq/threads/Task.h>
+#include <activemq/threads/TaskRunner.h>
+#include <activemq/util/MemoryUsage.h>
+
+#include <decaf/lang/Pointer.h>
+#include <decaf/util/LinkedList.h>
+#include <decaf/util/concurrent/Mutex.h>
+#include <decaf/util/concurrent/atomic/AtomicInteger.h>
+
+namespace activemq {
+namespace core {
+
+    using decaf::lang::Pointer;
+
+    class ActiveMQConnection;
+
+    /**
+     * Compresses and sends the asynchronous sends of a Session on the shared thread pool so
+     * that the thread calling send does not wait for the compression.  Messages are sent in
+     * the order they were handed over, and once a Message has been handed over the Session
+     * must hand over the ones that follow it until isPending returns false so that none of
+     * them overtakes it.
+     *
+     * Errors from sends done on the pool are reported to the Connection's exception listener.
+     *
+     * @since 3.10.0
+     */
+    class AMQCPP_API BackgroundCompressor : public threads::Task {
+    private:
+
+        struct PendingSend {
+            Pointer<commands::Message> message;
+            util::MemoryUsage* producerWindow;
+
+            PendingSend(const Pointer<commands::Message>& message, util::MemoryUsage* producerWindow) :
+                message(message), producerWindow(producerWindow) {
+            }
+        };
+
+        ActiveMQConnection* connection;
+        decaf::util::LinkedList< Pointer<PendingSend> > queue;
+        decaf::util::concurrent::Mutex queueMutex;
+        decaf::util::concurrent::Mutex sendMutex;
+        decaf::util::concurrent::atomic::AtomicInteger pending;
+        Pointer<threads::TaskRunner> taskRunner;
+
+    private:
+
+        BackgroundCompressor(const BackgroundCompressor&);
+        BackgroundCompressor& operator=(const BackgroundCompressor&);
+
+    public:
+
+        /**
+         * Creates a compressor that sends on the given Connection.
+         *
+         * @param connection
+         *      The Connection the Messages are sent on, it must outlive this object.
+         */
+        BackgroundCompressor(ActiveMQConnection* connection);
+
+        virtual ~BackgroundCompressor();
+
+        /**
+         * Queues the Message to be compressed and sent on the shared thread pool.
+         *
+         * @param message
+         *      The Message to send, onSend must already have been called on it.
+         * @param producerWindow
+         *      The producer's window that the Message's size is added to once it has been
+         *      sent, or NULL.  The producer must call drain before it goes away.
+         */
+        void send(const Pointer<commands::Message>& message, util::MemoryUsage* producerWindow);
+
+        /**
+         * @return true if there are Messages that were handed over and are not sent yet.
+         */
+        bool isPending() const {
+            return this->pending.get() > 0;
+        }
+
+        /**
+         * Compresses and sends the queued Messages on the calling thread and waits for one
+         * that the pool is sending, once this returns every Message handed over before the
+         * call has been sent.
+         *
+         * @throws ActiveMQException if sending one of the Messages fails, the Messages after
+         *         it stay queued.
+         */
+        void drain();
+
+        /**
+         * Sends whatever is still queued and stops using the thread pool.
+         */
+        void close();
+
+        virtual bool iterate();
+
+    private:
+
+        bool sendNext();
+
+    };
+
+}}
+
+#endif /* _ACTIVEMQ_CORE_BACKGROUNDCOMPRESSOR_H_ */
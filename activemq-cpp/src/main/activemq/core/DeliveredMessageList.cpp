@@ -0,0 +1,264 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "DeliveredMessageList.h"
+
+#include <activemq/commands/Message.h>
+#include <activemq/commands/MessageId.h>
+#include <activemq/exceptions/ExceptionDefines.h>
+
+#include <decaf/lang/exceptions/IllegalStateException.h>
+#include <decaf/lang/exceptions/UnsupportedOperationException.h>
+#include <decaf/util/NoSuchElementException.h>
+
+using namespace activemq;
+using namespace activemq::core;
+using namespace activemq::commands;
+using namespace decaf;
+using namespace decaf::lang;
+using namespace decaf::lang::exceptions;
+using namespace decaf::util;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace activemq {
+namespace core {
+
+    class DeliveredMessageList::DeliveredMessageListIterator : public Iterator< Pointer<MessageDispatch> > {
+    private:
+
+        DeliveredMessageList* list;
+        DeliveredMessageList::ListNode* current;
+        DeliveredMessageList::ListNode* lastReturned;
+        bool readOnly;
+
+    private:
+
+        DeliveredMessageListIterator(const DeliveredMessageListIterator&);
+        DeliveredMessageListIterator& operator=(const DeliveredMessageListIterator&);
+
+    public:
+
+        DeliveredMessageListIterator(DeliveredMessageList* list, bool readOnly) :
+            Iterator< Pointer<MessageDispatch> >(), list(list), current(&list->head), lastReturned(NULL), readOnly(readOnly) {
+        }
+
+        virtual ~DeliveredMessageListIterator() {}
+
+        virtual Pointer<MessageDispatch> next() {
+
+            if (this->current->next == &this->list->tail) {
+                throw NoSuchElementException(
+                    __FILE__, __LINE__, "No more elements to return from next()");
+            }
+
+            this->current = this->current->next;
+            this->lastReturned = this->current;
+
+            return this->current->value;
+        }
+
+        virtual bool hasNext() const {
+            return this->current->next != &this->list->tail;
+        }
+
+        virtual void remove() {
+
+            if (this->readOnly) {
+                throw UnsupportedOperationException(
+                    __FILE__, __LINE__, "Cannot remove from a const DeliveredMessageList Iterator.");
+            }
+
+            if (this->lastReturned == NULL) {
+                throw IllegalStateException(
+                    __FILE__, __LINE__, "Invalid State to call remove, must call next first.");
+            }
+
+            this->current = this->lastReturned->prev;
+            this->list->index.remove(this->lastReturned->value);
+            this->list->unlink(this->lastReturned);
+            this->lastReturned = NULL;
+        }
+    };
+
+}}
+
+////////////////////////////////////////////////////////////////////////////////
+int DeliveredMessageList::DispatchHashCode::operator()(const Pointer<MessageDispatch>& dispatch) const {
+
+    if (dispatch == NULL || dispatch->getMessage() == NULL) {
+        return 0;
+    }
+
+    const Pointer<MessageId>& id = dispatch->getMessage()->getMessageId();
+    if (id == NULL) {
+        return 0;
+    }
+
+    int hash = decaf::util::HashCode<long long>()(id->getProducerSequenceId());
+    hash = 31 * hash + decaf::util::HashCode<long long>()(id->getBrokerSequenceId());
+    return hash;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+DeliveredMessageList::DeliveredMessageList() :
+    AbstractCollection< Pointer<MessageDispatch> >(), listSize(0), head(), tail(), index() {
+
+    this->head.next = &this->tail;
+    this->tail.prev = &this->head;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+DeliveredMessageList::~DeliveredMessageList() {
+    try {
+        this->clear();
+    }
+    AMQ_CATCHALL_NOTHROW()
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void DeliveredMessageList::addFirst(const Pointer<MessageDispatch>& dispatch) {
+    // A dispatch that is already held is moved so the index maps it to a single node.
+    this->remove(dispatch);
+    this->linkBefore(this->head.next, dispatch);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void DeliveredMessageList::addLast(const Pointer<MessageDispatch>& dispatch) {
+    this->remove(dispatch);
+    this->linkBefore(&this->tail, dispatch);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool DeliveredMessageList::add(const Pointer<MessageDispatch>& dispatch) {
+    this->addLast(dispatch);
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Pointer<MessageDispatch> DeliveredMessageList::getFirst() const {
+
+    if (this->listSize == 0) {
+        throw NoSuchElementException(__FILE__, __LINE__, "The list is Empty");
+    }
+
+    return this->head.next->value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Pointer<MessageDispatch> DeliveredMessageList::getLast() const {
+
+    if (this->listSize == 0) {
+        throw NoSuchElementException(__FILE__, __LINE__, "The list is Empty");
+    }
+
+    return this->tail.prev->value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Pointer<MessageDispatch> DeliveredMessageList::removeFirst() {
+
+    if (this->listSize == 0) {
+        throw NoSuchElementException(__FILE__, __LINE__, "The list is Empty");
+    }
+
+    ListNode* node = this->head.next;
+    Pointer<MessageDispatch> result = node->value;
+    this->index.remove(result);
+    this->unlink(node);
+
+    return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Pointer<MessageDispatch> DeliveredMessageList::removeLast() {
+
+    if (this->listSize == 0) {
+        throw NoSuchElementException(__FILE__, __LINE__, "The list is Empty");
+    }
+
+    ListNode* node = this->tail.prev;
+    Pointer<MessageDispatch> result = node->value;
+    this->index.remove(result);
+    this->unlink(node);
+
+    return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool DeliveredMessageList::contains(const Pointer<MessageDispatch>& dispatch) const {
+    return this->index.containsKey(dispatch);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool DeliveredMessageList::remove(const Pointer<MessageDispatch>& dispatch) {
+
+    if (!this->index.containsKey(dispatch)) {
+        return false;
+    }
+
+    this->unlink(this->index.remove(dispatch));
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void DeliveredMessageList::clear() {
+
+    ListNode* node = this->head.next;
+    while (node != &this->tail) {
+        ListNode* next = node->next;
+        delete node;
+        node = next;
+    }
+
+    this->head.next = &this->tail;
+    this->tail.prev = &this->head;
+    this->listSize = 0;
+    this->index.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Iterator< Pointer<MessageDispatch> >* DeliveredMessageList::iterator() {
+    return new DeliveredMessageListIterator(this, false);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Iterator< Pointer<MessageDispatch> >* DeliveredMessageList::iterator() const {
+    return new DeliveredMessageListIterator(const_cast<DeliveredMessageList*>(this), true);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void DeliveredMessageList::linkBefore(ListNode* successor, const Pointer<MessageDispatch>& dispatch) {
+
+    ListNode* node = new ListNode(dispatch);
+    node->prev = successor->prev;
+    node->next = successor;
+    successor->prev->next = node;
+    successor->prev = node;
+
+    this->index.put(dispatch, node);
+    this->listSize++;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void DeliveredMessageList::unlink(ListNode* node) {
+
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    delete node;
+
+    this->listSize--;
+}
@@ -0,0 +1,180 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_CORE_DELIVEREDMESSAGELIST_H_
+#define _ACTIVEMQ_CORE_DELIVEREDMESSAGELIST_H_
+
+#include <activemq/util/Config.h>
+#include <activemq/commands/MessageDispatch.h>
+
+#include <decaf/lang/Pointer.h>
+#include <decaf/util/AbstractCollection.h>
+#include <decaf/util/HashCode.h>
+#include <decaf/util/HashMap.h>
+
+namespace activemq {
+namespace core {
+
+    using decaf::lang::Pointer;
+    using activemq::commands::MessageDispatch;
+
+    /**
+     * Ordered list of the MessageDispatch instances a consumer has delivered but not
+     * yet acknowledged.  The list keeps delivery order like a LinkedList but also
+     * indexes each entry by the MessageId of its Message so that contains and remove,
+     * which individual acknowledgement calls for every message, run in constant time
+     * instead of walking the list.
+     *
+     * Entries are matched by identity of the MessageDispatch as they were in the plain
+     * LinkedList, the MessageId only selects the hash bucket.  The MessageId of a
+     * dispatch must therefore not change while it is held in the list.
+     *
+     * This class is not thread safe, callers synchronize on the list itself.
+     *
+     * @since 3.10.0
+     */
+    class AMQCPP_API DeliveredMessageList : public decaf::util::AbstractCollection< Pointer<MessageDispatch> > {
+    private:
+
+        class ListNode {
+        public:
+
+            Pointer<MessageDispatch> value;
+            ListNode* prev;
+            ListNode* next;
+
+        private:
+
+            ListNode(const ListNode&);
+            ListNode& operator=(const ListNode&);
+
+        public:
+
+            ListNode() : value(), prev(NULL), next(NULL) {}
+
+            ListNode(const Pointer<MessageDispatch>& value) : value(value), prev(NULL), next(NULL) {}
+
+        };
+
+        /**
+         * Hashes a dispatch from the sequence ids of its MessageId, equality of the
+         * keys remains the identity of the MessageDispatch.
+         */
+        struct DispatchHashCode : decaf::util::HashCodeUnaryBase< Pointer<MessageDispatch> > {
+            int operator()(const Pointer<MessageDispatch>& dispatch) const;
+        };
+
+        class DeliveredMessageListIterator;
+        friend class DeliveredMessageListIterator;
+
+    private:
+
+        int listSize;
+        ListNode head;
+        ListNode tail;
+
+        decaf::util::HashMap< Pointer<MessageDispatch>, ListNode*, DispatchHashCode > index;
+
+    private:
+
+        DeliveredMessageList(const DeliveredMessageList&);
+        DeliveredMessageList& operator=(const DeliveredMessageList&);
+
+    public:
+
+        DeliveredMessageList();
+
+        virtual ~DeliveredMessageList();
+
+        /**
+         * Inserts the dispatch at the front of the list, the front holds the most
+         * recently delivered message.
+         *
+         * @param dispatch
+         *      The MessageDispatch to add.
+         */
+        void addFirst(const Pointer<MessageDispatch>& dispatch);
+
+        /**
+         * Inserts the dispatch at the end of the list.
+         *
+         * @param dispatch
+         *      The MessageDispatch to add.
+         */
+        void addLast(const Pointer<MessageDispatch>& dispatch);
+
+        /**
+         * @return the first dispatch in the list.
+         *
+         * @throws NoSuchElementException if the list is empty.
+         */
+        Pointer<MessageDispatch> getFirst() const;
+
+        /**
+         * @return the last dispatch in the list.
+         *
+         * @throws NoSuchElementException if the list is empty.
+         */
+        Pointer<MessageDispatch> getLast() const;
+
+        /**
+         * Removes and returns the first dispatch in the list.
+         *
+         * @throws NoSuchElementException if the list is empty.
+         */
+        Pointer<MessageDispatch> removeFirst();
+
+        /**
+         * Removes and returns the last dispatch in the list.
+         *
+         * @throws NoSuchElementException if the list is empty.
+         */
+        Pointer<MessageDispatch> removeLast();
+
+    public:
+
+        virtual bool add(const Pointer<MessageDispatch>& dispatch);
+
+        virtual bool contains(const Pointer<MessageDispatch>& dispatch) const;
+
+        virtual bool remove(const Pointer<MessageDispatch>& dispatch);
+
+        virtual void clear();
+
+        virtual bool isEmpty() const {
+            return this->listSize == 0;
+        }
+
+        virtual int size() const {
+            return this->listSize;
+        }
+
+        virtual decaf::util::Iterator< Pointer<MessageDispatch> >* iterator();
+
+        virtual decaf::util::Iterator< Pointer<MessageDispatch> >* iterator() const;
+
+    private:
+
+        void linkBefore(ListNode* successor, const Pointer<MessageDispatch>& dispatch);
+
+        void unlink(ListNode* node);
+
+    };
+
+}}
+
+#endif /* _ACTIVEMQ_CORE_DELIVEREDMESSAGELIST_H_ */
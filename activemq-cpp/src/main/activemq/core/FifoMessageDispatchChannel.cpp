@@ -96,6 +96,34 @@ Pointer<MessageDispatch> FifoMessageDispatchChannel::dequeueNoWait() {
     return Pointer<MessageDispatch>();
 }
 
+////////////////////////////////////////////////////////////////////////////////
+std::vector<Pointer<MessageDispatch> > FifoMessageDispatchChannel::dequeueBatch(int maxMessages, long long timeout) {
+
+    std::vector<Pointer<MessageDispatch> > result;
+
+    synchronized(&channel) {
+        // Wait until the channel is ready to deliver messages.
+        while (timeout != 0 && !closed && (channel.isEmpty() || !running)) {
+            if (timeout == -1) {
+                channel.wait();
+            } else {
+                channel.wait(timeout);
+                break;
+            }
+        }
+
+        if (closed || !running) {
+            return result;
+        }
+
+        while ((int) result.size() < maxMessages && !channel.isEmpty()) {
+            result.push_back(channel.pop());
+        }
+    }
+
+    return result;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 Pointer<MessageDispatch> FifoMessageDispatchChannel::peek() const {
     synchronized(&channel) {
@@ -86,6 +86,22 @@ namespace core {
          */
         virtual Pointer<MessageDispatch> dequeueNoWait() = 0;
 
+        /**
+         * Used to get up to maxMessages enqueued messages in one call.  The call waits for
+         * the first message the same way dequeue does for the given timeout, and then takes
+         * every further message that is already queued, up to the given maximum, without
+         * releasing the Channel's lock in between.
+         *
+         * @param maxMessages
+         *      The maximum number of messages to return.
+         * @param timeout
+         *      The time to wait for the first message, as for dequeue.
+         *
+         * @return the dequeued messages in delivery order, empty if we timeout or if the
+         *         consumer is closed.
+         */
+        virtual std::vector<Pointer<MessageDispatch> > dequeueBatch(int maxMessages, long long timeout) = 0;
+
         /**
          * Peek in the Queue and return the first message in the Channel without removing
          * it from the channel.
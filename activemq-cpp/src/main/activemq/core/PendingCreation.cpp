@@ -0,0 +1,84 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "PendingCreation.h"
+
+#include <activemq/commands/ExceptionResponse.h>
+
+using namespace activemq;
+using namespace activemq::core;
+using namespace activemq::commands;
+using namespace activemq::exceptions;
+using namespace activemq::transport;
+using namespace decaf::lang;
+using namespace decaf::util::concurrent;
+
+////////////////////////////////////////////////////////////////////////////////
+PendingCreation::PendingCreation() : future(), error(), pending(false), mutex() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+PendingCreation::~PendingCreation() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void PendingCreation::setFuture(const Pointer<FutureResponse>& future) {
+
+    synchronized(&this->mutex) {
+        this->future = future;
+        this->pending.set(future != NULL);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool PendingCreation::await() {
+
+    if (!this->pending.get()) {
+        return false;
+    }
+
+    synchronized(&this->mutex) {
+
+        if (this->future == NULL) {
+            return false;
+        }
+
+        Pointer<Response> response = this->future->getResponse();
+        this->future.reset(NULL);
+
+        // The error is recorded before the pending flag clears so that threads which
+        // skip the lock on seeing the flag cleared also see the error.
+        ExceptionResponse* exceptionResponse = dynamic_cast<ExceptionResponse*>(response.get());
+        if (exceptionResponse != NULL) {
+            this->error.reset(new ActiveMQException(exceptionResponse->getException()->createExceptionObject()));
+            this->pending.set(false);
+            return true;
+        }
+
+        this->pending.set(false);
+    }
+
+    return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void PendingCreation::checkCreated() const {
+
+    if (this->error != NULL) {
+        throw *this->error;
+    }
+}
@@ -0,0 +1,98 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_CORE_PENDINGCREATION_H_
+#define _ACTIVEMQ_CORE_PENDINGCREATION_H_
+
+#include <activemq/util/Config.h>
+#include <activemq/exceptions/ActiveMQException.h>
+#include <activemq/transport/FutureResponse.h>
+
+#include <decaf/lang/Pointer.h>
+#include <decaf/util/concurrent/Mutex.h>
+#include <decaf/util/concurrent/atomic/AtomicBoolean.h>
+
+namespace activemq {
+namespace core {
+
+    using decaf::lang::Pointer;
+
+    /**
+     * Tracks the broker's response to the Info command that created a consumer or
+     * producer when the connection pipelines resource creation.  The Info command is
+     * sent without waiting so many resources can be created in one round trip, the
+     * resource then waits here on its first use and reports a refused creation from
+     * that point on.
+     *
+     * @since 3.10.0
+     */
+    class AMQCPP_API PendingCreation {
+    private:
+
+        Pointer<transport::FutureResponse> future;
+        Pointer<exceptions::ActiveMQException> error;
+        decaf::util::concurrent::atomic::AtomicBoolean pending;
+        decaf::util::concurrent::Mutex mutex;
+
+    private:
+
+        PendingCreation(const PendingCreation&);
+        PendingCreation& operator=(const PendingCreation&);
+
+    public:
+
+        PendingCreation();
+
+        virtual ~PendingCreation();
+
+        /**
+         * Sets the future response of the Info command that was sent to create the resource.
+         *
+         * @param future
+         *      The FutureResponse returned from the transport's asyncRequest.
+         */
+        void setFuture(const Pointer<transport::FutureResponse>& future);
+
+        /**
+         * @return true if the broker's response to the creation request is still awaited.
+         */
+        bool isPending() const {
+            return this->pending.get();
+        }
+
+        /**
+         * Waits for the broker's response to the creation request if it is still awaited,
+         * returns immediately otherwise.
+         *
+         * @return true if this call received a response refusing the creation, the caller
+         *         is then responsible for disposing of the resource.
+         */
+        bool await();
+
+        /**
+         * Throws the broker's error if it refused to create the resource, does nothing if
+         * the resource was created or its response is still awaited.
+         *
+         * @throws ActiveMQException holding the error the broker responded with.
+         */
+        void checkCreated() const;
+
+    };
+
+}}
+
+#endif /* _ACTIVEMQ_CORE_PENDINGCREATION_H_ */
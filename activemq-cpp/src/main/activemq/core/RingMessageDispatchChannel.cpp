@@ -0,0 +1,390 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "RingMessageDispatchChannel.h"
+
+#include <decaf/internal/util/concurrent/Atomics.h>
+#include <decaf/lang/exceptions/InterruptedException.h>
+
+using namespace std;
+using namespace activemq;
+using namespace activemq::core;
+using namespace activemq::commands;
+using namespace decaf;
+using namespace decaf::lang;
+using namespace decaf::lang::exceptions;
+using namespace decaf::util;
+using namespace decaf::util::concurrent;
+using namespace decaf::internal::util::concurrent;
+
+////////////////////////////////////////////////////////////////////////////////
+const int RingMessageDispatchChannel::DEFAULT_CAPACITY = 1000;
+const int RingMessageDispatchChannel::MAX_CAPACITY = 4096;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    const int MIN_CAPACITY = 16;
+
+    // Slot sequences and positions are free running counters, they are compared
+    // through their unsigned difference so that wrapping around is harmless.
+
+    inline int advance(int value, int delta) {
+        return (int) ((unsigned int) value + (unsigned int) delta);
+    }
+
+    inline int distance(int value, int from) {
+        return (int) ((unsigned int) value - (unsigned int) from);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+RingMessageDispatchChannel::RingMessageDispatchChannel() :
+    closed(false), running(false), capacity(0), mask(0), slots(), tail(0), head(0),
+    pending(), waiters(), front(), overflow(), mutex() {
+
+    this->initialize(DEFAULT_CAPACITY);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+RingMessageDispatchChannel::RingMessageDispatchChannel(int capacity) :
+    closed(false), running(false), capacity(0), mask(0), slots(), tail(0), head(0),
+    pending(), waiters(), front(), overflow(), mutex() {
+
+    this->initialize(capacity);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+RingMessageDispatchChannel::~RingMessageDispatchChannel() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void RingMessageDispatchChannel::initialize(int capacity) {
+
+    if (capacity > MAX_CAPACITY) {
+        capacity = MAX_CAPACITY;
+    }
+
+    int size = MIN_CAPACITY;
+    while (size < capacity) {
+        size <<= 1;
+    }
+
+    this->capacity = size;
+    this->mask = size - 1;
+    this->slots = ArrayPointer<Slot>(size);
+
+    for (int i = 0; i < size; ++i) {
+        this->slots.get()[i].sequence = i;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void RingMessageDispatchChannel::enqueue(const Pointer<MessageDispatch>& message) {
+
+    if (this->pending.get() == 0 && this->offer(message)) {
+        this->signalWaiters();
+        return;
+    }
+
+    synchronized(&mutex) {
+        // Once anything has overflowed every later message queues behind it
+        // until the consumer has drained the overflow.
+        if (!this->overflow.isEmpty() || !this->offer(message)) {
+            this->overflow.addLast(message);
+            this->pending.incrementAndGet();
+        }
+        mutex.notify();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void RingMessageDispatchChannel::enqueueFirst(const Pointer<MessageDispatch>& message) {
+    synchronized(&mutex) {
+        this->front.addFirst(message);
+        this->pending.incrementAndGet();
+        mutex.notify();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool RingMessageDispatchChannel::isEmpty() const {
+    return this->size() == 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Pointer<MessageDispatch> RingMessageDispatchChannel::dequeue(long long timeout) {
+
+    synchronized(&mutex) {
+        this->awaitMessages(timeout);
+
+        if (closed || !running) {
+            return Pointer<MessageDispatch>();
+        }
+
+        return this->take();
+    }
+
+    return Pointer<MessageDispatch>();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::vector<Pointer<MessageDispatch> > RingMessageDispatchChannel::dequeueBatch(int maxMessages, long long timeout) {
+
+    std::vector<Pointer<MessageDispatch> > result;
+
+    synchronized(&mutex) {
+        this->awaitMessages(timeout);
+
+        if (closed || !running) {
+            return result;
+        }
+
+        while ((int) result.size() < maxMessages) {
+            Pointer<MessageDispatch> message = this->take();
+            if (message == NULL) {
+                break;
+            }
+            result.push_back(message);
+        }
+    }
+
+    return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Pointer<MessageDispatch> RingMessageDispatchChannel::dequeueNoWait() {
+    synchronized(&mutex) {
+        if (closed || !running) {
+            return Pointer<MessageDispatch>();
+        }
+        return this->take();
+    }
+
+    return Pointer<MessageDispatch>();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Pointer<MessageDispatch> RingMessageDispatchChannel::peek() const {
+    synchronized(&mutex) {
+        if (closed || !running) {
+            return Pointer<MessageDispatch>();
+        }
+
+        if (!this->front.isEmpty()) {
+            return this->front.getFirst();
+        }
+
+        Slot& slot = this->slots.get()[this->head & this->mask];
+        int published = advance(this->head, 1);
+
+        // The exchange orders the read of the value after the producer's publish.
+        if (Atomics::compareAndSet32(&slot.sequence, published, published)) {
+            return slot.value;
+        }
+
+        if (!this->overflow.isEmpty()) {
+            return this->overflow.getFirst();
+        }
+    }
+
+    return Pointer<MessageDispatch>();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void RingMessageDispatchChannel::start() {
+    synchronized(&mutex) {
+        if (!closed) {
+            running = true;
+            mutex.notifyAll();
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void RingMessageDispatchChannel::stop() {
+    synchronized(&mutex) {
+        running = false;
+        mutex.notifyAll();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void RingMessageDispatchChannel::close() {
+    synchronized(&mutex) {
+        if (!closed) {
+            running = false;
+            closed = true;
+        }
+        mutex.notifyAll();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void RingMessageDispatchChannel::clear() {
+    synchronized(&mutex) {
+        Pointer<MessageDispatch> discarded;
+        while (this->poll(discarded)) {
+        }
+
+        this->pending.addAndGet(-(this->front.size() + this->overflow.size()));
+        this->front.clear();
+        this->overflow.clear();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int RingMessageDispatchChannel::size() const {
+    return distance(this->tail, this->head) + this->pending.get();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::vector<Pointer<MessageDispatch> > RingMessageDispatchChannel::removeAll() {
+    std::vector<Pointer<MessageDispatch> > result;
+
+    synchronized(&mutex) {
+        result = this->front.toArray();
+
+        Pointer<MessageDispatch> message;
+        while (this->poll(message)) {
+            result.push_back(message);
+        }
+
+        std::vector<Pointer<MessageDispatch> > overflowed = this->overflow.toArray();
+        result.insert(result.end(), overflowed.begin(), overflowed.end());
+
+        this->pending.addAndGet(-(this->front.size() + this->overflow.size()));
+        this->front.clear();
+        this->overflow.clear();
+    }
+
+    return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool RingMessageDispatchChannel::offer(const Pointer<MessageDispatch>& message) {
+
+    int position = this->tail;
+
+    while (true) {
+        Slot& slot = this->slots.get()[position & this->mask];
+        int difference = distance(slot.sequence, position);
+
+        if (difference == 0) {
+            if (Atomics::compareAndSet32(&this->tail, position, advance(position, 1))) {
+                slot.value = message;
+                Atomics::getAndSet(&slot.sequence, advance(position, 1));
+                return true;
+            }
+        } else if (difference < 0) {
+            // The consumer has not yet freed this slot, the ring is full.
+            return false;
+        }
+
+        position = this->tail;
+    }
+
+    return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool RingMessageDispatchChannel::poll(Pointer<MessageDispatch>& result) {
+
+    Slot& slot = this->slots.get()[this->head & this->mask];
+    int published = advance(this->head, 1);
+
+    // Fails while the slot is empty or its producer has claimed it but not yet
+    // stored the message, as a full barrier it also orders the read of the value.
+    if (!Atomics::compareAndSet32(&slot.sequence, published, published)) {
+        return false;
+    }
+
+    result = slot.value;
+    slot.value.reset(NULL);
+
+    Atomics::getAndSet(&slot.sequence, advance(this->head, this->capacity));
+    this->head = published;
+
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Pointer<MessageDispatch> RingMessageDispatchChannel::take() {
+
+    if (!this->front.isEmpty()) {
+        this->pending.decrementAndGet();
+        return this->front.pop();
+    }
+
+    Pointer<MessageDispatch> result;
+    if (this->poll(result)) {
+        return result;
+    }
+
+    if (!this->overflow.isEmpty()) {
+        this->pending.decrementAndGet();
+        return this->overflow.pop();
+    }
+
+    return Pointer<MessageDispatch>();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void RingMessageDispatchChannel::awaitMessages(long long timeout) {
+
+    // Wait until the channel is ready to deliver messages.
+    while (timeout != 0 && !closed && (!running || !this->hasMessages())) {
+
+        // Register before checking again so that a producer which published
+        // without seeing a waiter is caught by the second check.
+        this->waiters.incrementAndGet();
+        if (running && !closed && this->hasMessages()) {
+            this->waiters.decrementAndGet();
+            break;
+        }
+
+        try {
+            if (timeout == -1) {
+                mutex.wait();
+            } else {
+                mutex.wait(timeout);
+                this->waiters.decrementAndGet();
+                break;
+            }
+        } catch (InterruptedException& ex) {
+            this->waiters.decrementAndGet();
+            throw;
+        }
+
+        this->waiters.decrementAndGet();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool RingMessageDispatchChannel::hasMessages() const {
+    return this->pending.get() > 0 ||
+           this->slots.get()[this->head & this->mask].sequence == advance(this->head, 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void RingMessageDispatchChannel::signalWaiters() {
+    if (this->waiters.get() > 0) {
+        synchronized(&mutex) {
+            mutex.notify();
+        }
+    }
+}
@@ -0,0 +1,214 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_CORE_RINGMESSAGEDISPATCHCHANNEL_H_
+#define _ACTIVEMQ_CORE_RINGMESSAGEDISPATCHCHANNEL_H_
+
+#include <activemq/util/Config.h>
+#include <activemq/core/MessageDispatchChannel.h>
+
+#include <decaf/lang/ArrayPointer.h>
+#include <decaf/lang/Pointer.h>
+#include <decaf/util/LinkedList.h>
+#include <decaf/util/concurrent/Mutex.h>
+#include <decaf/util/concurrent/atomic/AtomicInteger.h>
+
+namespace activemq {
+namespace core {
+
+    /**
+     * A FIFO MessageDispatchChannel that hands messages from producers to the consumer
+     * through a bounded ring of slots instead of a locked list.  Producers claim a slot
+     * with a single compare and set and never take the channel monitor while the ring
+     * has room, so the transport thread can enqueue without blocking on the consumer.
+     * The consumer side is serialized by the channel monitor, which producers only
+     * touch to wake a consumer that has parked on an empty channel.
+     *
+     * Messages that do not fit in the ring, and those returned to the front of the
+     * channel with enqueueFirst, are held in lists guarded by the monitor and are
+     * delivered in the same order the other channels would deliver them.
+     *
+     * @since 3.10.0
+     */
+    class AMQCPP_API RingMessageDispatchChannel : public MessageDispatchChannel {
+    public:
+
+        /**
+         * Ring capacity used when none is given, matches the default queue prefetch.
+         */
+        static const int DEFAULT_CAPACITY;
+
+        /**
+         * Upper bound on the ring capacity, larger prefetch windows spill the excess
+         * into the overflow list.
+         */
+        static const int MAX_CAPACITY;
+
+    private:
+
+        struct Slot {
+            volatile int sequence;
+            Pointer<MessageDispatch> value;
+
+            Slot() : sequence(0), value() {}
+        };
+
+        volatile bool closed;
+        volatile bool running;
+
+        int capacity;
+        int mask;
+        decaf::lang::ArrayPointer<Slot> slots;
+
+        // Next slot a producer claims, advanced by compare and set.
+        volatile int tail;
+
+        // Next slot the consumer reads, only advanced with the monitor held.
+        volatile int head;
+
+        // Count of the messages held in the front and overflow lists, lets both sides
+        // skip the monitor while those lists are empty.
+        decaf::util::concurrent::atomic::AtomicInteger pending;
+
+        // Number of consumers parked waiting for a message.
+        decaf::util::concurrent::atomic::AtomicInteger waiters;
+
+        decaf::util::LinkedList< Pointer<MessageDispatch> > front;
+        decaf::util::LinkedList< Pointer<MessageDispatch> > overflow;
+
+        mutable decaf::util::concurrent::Mutex mutex;
+
+    private:
+
+        RingMessageDispatchChannel(const RingMessageDispatchChannel&);
+        RingMessageDispatchChannel& operator=(const RingMessageDispatchChannel&);
+
+    public:
+
+        RingMessageDispatchChannel();
+
+        /**
+         * Creates a channel whose ring holds at least the given number of messages,
+         * normally the prefetch size of the consumer it serves.
+         *
+         * @param capacity
+         *      The number of messages the ring should hold before overflowing.
+         */
+        RingMessageDispatchChannel(int capacity);
+
+        virtual ~RingMessageDispatchChannel();
+
+        /**
+         * @return the number of slots in the ring.
+         */
+        int getCapacity() const {
+            return this->capacity;
+        }
+
+        virtual void enqueue(const Pointer<MessageDispatch>& message);
+
+        virtual void enqueueFirst(const Pointer<MessageDispatch>& message);
+
+        virtual bool isEmpty() const;
+
+        virtual bool isClosed() const {
+            return this->closed;
+        }
+
+        virtual bool isRunning() const {
+            return this->running;
+        }
+
+        virtual Pointer<MessageDispatch> dequeue(long long timeout);
+
+        virtual Pointer<MessageDispatch> dequeueNoWait();
+
+        virtual std::vector<Pointer<MessageDispatch> > dequeueBatch(int maxMessages, long long timeout);
+
+        virtual Pointer<MessageDispatch> peek() const;
+
+        virtual void start();
+
+        virtual void stop();
+
+        virtual void close();
+
+        virtual void clear();
+
+        virtual int size() const;
+
+        virtual std::vector<Pointer<MessageDispatch> > removeAll();
+
+    public:
+
+        virtual void lock() {
+            mutex.lock();
+        }
+
+        virtual bool tryLock() {
+            return mutex.tryLock();
+        }
+
+        virtual void unlock() {
+            mutex.unlock();
+        }
+
+        virtual void wait() {
+            mutex.wait();
+        }
+
+        virtual void wait(long long millisecs) {
+            mutex.wait(millisecs);
+        }
+
+        virtual void wait(long long millisecs, int nanos) {
+            mutex.wait(millisecs, nanos);
+        }
+
+        virtual void notify() {
+            mutex.notify();
+        }
+
+        virtual void notifyAll() {
+            mutex.notifyAll();
+        }
+
+    private:
+
+        void initialize(int capacity);
+
+        bool offer(const Pointer<MessageDispatch>& message);
+
+        // Called with the monitor held.
+        bool poll(Pointer<MessageDispatch>& result);
+
+        // Called with the monitor held.
+        Pointer<MessageDispatch> take();
+
+        // Called with the monitor held.
+        void awaitMessages(long long timeout);
+
+        // Called with the monitor held.
+        bool hasMessages() const;
+
+        void signalWaiters();
+
+    };
+
+}}
+
+#endif /* _ACTIVEMQ_CORE_RINGMESSAGEDISPATCHCHANNEL_H_ */
@@ -102,6 +102,34 @@ Pointer<MessageDispatch> SimplePriorityMessageDispatchChannel::dequeueNoWait() {
     return Pointer<MessageDispatch>();
 }
 
+////////////////////////////////////////////////////////////////////////////////
+std::vector<Pointer<MessageDispatch> > SimplePriorityMessageDispatchChannel::dequeueBatch(int maxMessages, long long timeout) {
+
+    std::vector<Pointer<MessageDispatch> > result;
+
+    synchronized(&mutex) {
+        // Wait until the channel is ready to deliver messages.
+        while (timeout != 0 && !closed && (isEmpty() || !running)) {
+            if (timeout == -1) {
+                mutex.wait();
+            } else {
+                mutex.wait((unsigned long) timeout);
+                break;
+            }
+        }
+
+        if (closed || !running) {
+            return result;
+        }
+
+        while ((int) result.size() < maxMessages && !isEmpty()) {
+            result.push_back(removeFirst());
+        }
+    }
+
+    return result;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 Pointer<MessageDispatch> SimplePriorityMessageDispatchChannel::peek() const {
     synchronized(&mutex) {
@@ -72,6 +72,8 @@ namespace core {
 
         virtual Pointer<MessageDispatch> dequeueNoWait();
 
+        virtual std::vector<Pointer<MessageDispatch> > dequeueBatch(int maxMessages, long long timeout);
+
         virtual Pointer<MessageDispatch> peek() const;
 
         virtual void start();
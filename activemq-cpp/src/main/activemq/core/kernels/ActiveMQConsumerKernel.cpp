@@ -25,6 +25,7 @@
 #include <decaf/lang/Boolean.h>
 #include <decaf/lang/Integer.h>
 #include <decaf/lang/Long.h>
+#include <decaf/util/ArrayList.h>
 #include <decaf/util/HashMap.h>
 #include <decaf/util/Collections.h>
 #include <decaf/util/concurrent/ExecutorService.h>
@@ -45,7 +46,10 @@
 #include <activemq/core/ActiveMQConstants.h>
 #include <activemq/core/ActiveMQTransactionContext.h>
 #include <activemq/core/ActiveMQAckHandler.h>
+#include <activemq/core/DeliveredMessageList.h>
+#include <activemq/core/PendingCreation.h>
 #include <activemq/core/FifoMessageDispatchChannel.h>
+#include <activemq/core/RingMessageDispatchChannel.h>
 #include <activemq/core/SimplePriorityMessageDispatchChannel.h>
 #include <activemq/core/RedeliveryPolicy.h>
 #include <activemq/core/kernels/ActiveMQSessionKernel.h>
@@ -101,9 +105,17 @@ namespace kernels {
         AtomicBoolean started;
         AtomicBoolean closeSyncRegistered;
         Pointer<MessageDispatchChannel> unconsumedMessages;
-        decaf::util::LinkedList< decaf::lang::Pointer<commands::MessageDispatch> > deliveredMessages;
+        DeliveredMessageList deliveredMessages;
         long long lastDeliveredSequenceId;
         Pointer<commands::MessageAck> pendingAck;
+        // Range of the messages consumed on the optimized dispatch path that have not
+        // been acked yet, guarded by the deliveredMessages lock.
+        Pointer<MessageId> dispatchedAckFirst;
+        Pointer<MessageDispatch> dispatchedAckLast;
+        int dispatchedAckCount;
+        Pointer<ActiveMQAckHandler> noOpAckHandler;
+        bool optimizeDispatch;
+        PendingCreation creation;
         int deliveredCounter;
         int additionalWindowSize;
         volatile bool synchronizationRegistered;
@@ -142,6 +154,12 @@ namespace kernels {
                                          deliveredMessages(),
                                          lastDeliveredSequenceId(-1),
                                          pendingAck(),
+                                         dispatchedAckFirst(),
+                                         dispatchedAckLast(),
+                                         dispatchedAckCount(0),
+                                         noOpAckHandler(),
+                                         optimizeDispatch(false),
+                                         creation(),
                                          deliveredCounter(0),
                                          additionalWindowSize(0),
                                          synchronizationRegistered(false),
@@ -217,12 +235,30 @@ namespace kernels {
                                 pendingAck.reset(NULL);
                             }
                         }
+                        // The broker redelivers the messages consumed on the optimized
+                        // path that were not acked before the interruption.
+                        dispatchedAckFirst.reset(NULL);
+                        dispatchedAckLast.reset(NULL);
+                        dispatchedAckCount = 0;
                         isClearDeliveredList = false;
                     }
                 }
             }
         }
 
+        // called with deliveredMessages locked
+        Pointer<MessageAck> takeDispatchedAck() {
+            Pointer<MessageAck> ack;
+            if (dispatchedAckCount > 0) {
+                ack.reset(new MessageAck(dispatchedAckLast, ActiveMQConstants::ACK_TYPE_CONSUMED, dispatchedAckCount));
+                ack->setFirstMessageId(dispatchedAckFirst);
+                dispatchedAckFirst.reset(NULL);
+                dispatchedAckLast.reset(NULL);
+                dispatchedAckCount = 0;
+            }
+            return ack;
+        }
+
         void clearPreviouslyDelivered() {
             if (previouslyDeliveredMessages != NULL) {
                 previouslyDeliveredMessages->clear();
@@ -232,7 +268,11 @@ namespace kernels {
 
         // called with deliveredMessages locked
         void removeFromDeliveredMessages(Pointer<MessageId> key) {
-            Pointer< Iterator< Pointer<MessageDispatch> > > iter(this->deliveredMessages.iterator());
+            removeFromDeliveredMessages(this->deliveredMessages, key);
+        }
+
+        void removeFromDeliveredMessages(DeliveredMessageList& delivered, Pointer<MessageId> key) {
+            Pointer< Iterator< Pointer<MessageDispatch> > > iter(delivered.iterator());
             while (iter->hasNext()) {
                 Pointer<MessageDispatch> candidate = iter->next();
                 if (key->equals(candidate->getMessage()->getMessageId().get())) {
@@ -245,14 +285,14 @@ namespace kernels {
 
         // called with unconsumedMessages && deliveredMessages locked remove any message
         // not re-delivered as they can't be replayed to this consumer on rollback
-        void rollbackPreviouslyDeliveredAndNotRedelivered() {
+        void rollbackPreviouslyDeliveredAndNotRedelivered(DeliveredMessageList& delivered) {
             if (previouslyDeliveredMessages != NULL) {
                 Set<MapEntry<Pointer<MessageId>, bool> >& entries = previouslyDeliveredMessages->entrySet();
                 Pointer<Iterator<MapEntry<Pointer<MessageId>, bool> > > iter(entries.iterator());
                 while (iter->hasNext()) {
                     MapEntry<Pointer<MessageId>, bool> entry = iter->next();
                     if (!entry.getValue()) {
-                        removeFromDeliveredMessages(entry.getKey());
+                        removeFromDeliveredMessages(delivered, entry.getKey());
                     }
                 }
 
@@ -392,6 +432,11 @@ namespace {
      * Class used to deal with consumers in an active transaction.  This
      * class calls back into the consumer when the transaction is Committed or
      * Rolled Back to process that event.
+     *
+     * When the transaction ends the messages delivered in it are moved out of the
+     * consumer and into this Synchronization, a commit that completes asynchronously
+     * then only settles its own messages and not those delivered in the transaction
+     * the session has started since.
      */
     class TransactionSynhcronization : public Synchronization {
     private:
@@ -399,6 +444,10 @@ namespace {
         Pointer<ActiveMQConsumerKernel> consumer;
         ActiveMQConsumerKernelConfig* impl;
 
+        // Messages delivered in the ended transaction, newest first.
+        DeliveredMessageList ended;
+        bool transactionEnded;
+
     private:
 
         TransactionSynhcronization(const TransactionSynhcronization&);
@@ -407,7 +456,7 @@ namespace {
     public:
 
         TransactionSynhcronization(Pointer<ActiveMQConsumerKernel> consumer, ActiveMQConsumerKernelConfig* impl) :
-            Synchronization(), consumer(consumer), impl(impl) {
+            Synchronization(), consumer(consumer), impl(impl), ended(), transactionEnded(false) {
 
             if (consumer == NULL) {
                 throw NullPointerException(__FILE__, __LINE__, "Synchronization Created with NULL Consumer.");
@@ -426,18 +475,41 @@ namespace {
             } else {
                 consumer->acknowledge();
             }
+
+            synchronized(&impl->deliveredMessages) {
+                ended.addAll(impl->deliveredMessages);
+                impl->deliveredMessages.clear();
+            }
+
+            // From here on the consumer can join the session's next transaction.
+            transactionEnded = true;
             consumer->setSynchronizationRegistered(false);
         }
 
         virtual void afterCommit() {
-            consumer->commit();
-            consumer->setSynchronizationRegistered(false);
+            if (transactionEnded) {
+                synchronized(&impl->deliveredMessages) {
+                    impl->clearPreviouslyDelivered();
+                }
+                impl->redeliveryDelay = 0;
+                ended.clear();
+            } else {
+                consumer->commit();
+                consumer->setSynchronizationRegistered(false);
+            }
             consumer.reset(NULL);
         }
 
         virtual void afterRollback() {
-            consumer->rollback();
-            consumer->setSynchronizationRegistered(false);
+            if (transactionEnded) {
+                // The session may already be delivering in its next transaction, only the
+                // ended transaction's messages are redelivered.
+                consumer->rollbackEnded(ended);
+                ended.clear();
+            } else {
+                consumer->setSynchronizationRegistered(false);
+                consumer->rollback();
+            }
             consumer.reset(NULL);
         }
     };
@@ -682,10 +754,11 @@ namespace {
 
     public:
 
-        NonBlockingRedeliveryTask(ActiveMQSessionKernel* session, Pointer<ActiveMQConsumerKernel> consumer, ActiveMQConsumerKernelConfig* impl) :
+        NonBlockingRedeliveryTask(ActiveMQSessionKernel* session, Pointer<ActiveMQConsumerKernel> consumer,
+                                  ActiveMQConsumerKernelConfig* impl, const DeliveredMessageList& delivered) :
             Runnable(), session(session), consumer(consumer), impl(impl), redeliveries() {
 
-            this->redeliveries.copy(impl->deliveredMessages);
+            this->redeliveries.copy(delivered);
             Collections::reverse(this->redeliveries);
         }
         virtual ~NonBlockingRedeliveryTask() {}
@@ -779,9 +852,13 @@ ActiveMQConsumerKernel::ActiveMQConsumerKernel(ActiveMQSessionKernel* session,
     this->internal->info = consumerInfo;
     this->internal->redeliveryPolicy.reset(this->session->getConnection()->getRedeliveryPolicy()->clone());
     this->internal->scheduler = this->session->getScheduler();
+    this->internal->noOpAckHandler.reset(new NoOpAckHandler());
+    this->internal->optimizeDispatch = this->session->getConnection()->isOptimizeDispatch();
 
     if (this->session->getConnection()->isMessagePrioritySupported()) {
         this->internal->unconsumedMessages.reset(new SimplePriorityMessageDispatchChannel());
+    } else if (this->session->getConnection()->isUseRingDispatchChannel()) {
+        this->internal->unconsumedMessages.reset(new RingMessageDispatchChannel(consumerInfo->getPrefetchSize()));
     } else {
         this->internal->unconsumedMessages.reset(new FifoMessageDispatchChannel());
     }
@@ -860,6 +937,12 @@ bool ActiveMQConsumerKernel::isClosed() const {
 void ActiveMQConsumerKernel::close() {
 
     try {
+
+        // A consumer the broker refused to create only needs to be disposed of locally.
+        if (this->internal->creation.await()) {
+            dispose();
+        }
+
         if (!this->isClosed()) {
 
             if (!this->internal->deliveredMessages.isEmpty() &&
@@ -912,6 +995,7 @@ void ActiveMQConsumerKernel::dispose() {
         if (!this->isClosed()) {
 
             if (!session->isTransacted()) {
+                sendDispatchedAck();
                 deliverAcks();
                 if (isAutoAcknowledgeBatch()) {
                     acknowledge();
@@ -1067,11 +1151,93 @@ decaf::lang::Pointer<MessageDispatch> ActiveMQConsumerKernel::dequeue(long long
     AMQ_CATCH_ALL_THROW_CMSEXCEPTION()
 }
 
+////////////////////////////////////////////////////////////////////////////////
+std::vector< Pointer<MessageDispatch> > ActiveMQConsumerKernel::dequeueBatch(int maxMessages, long long timeout) {
+
+    try {
+
+        // Calculate the deadline
+        long long deadline = 0;
+        if (timeout > 0) {
+            deadline = System::currentTimeMillis() + timeout;
+        }
+
+        std::vector< Pointer<MessageDispatch> > result;
+
+        // Loop until the time is up or we get at least one non-expired message
+        while (true) {
+            std::vector< Pointer<MessageDispatch> > dispatches =
+                this->internal->unconsumedMessages->dequeueBatch(maxMessages, timeout);
+
+            if (dispatches.empty()) {
+                if (timeout > 0 && !this->internal->unconsumedMessages->isClosed()) {
+                    timeout = Math::max(deadline - System::currentTimeMillis(), 0LL);
+                    if (timeout > 0) {
+                        continue;
+                    }
+                }
+
+                if (this->internal->failureError != NULL) {
+                    throw CMSExceptionSupport::create(*this->internal->failureError);
+                }
+
+                return result;
+            }
+
+            bool discarded = false;
+            for (std::size_t i = 0; i < dispatches.size(); ++i) {
+                const Pointer<MessageDispatch>& dispatch = dispatches[i];
+
+                if (dispatch->getMessage() == NULL) {
+                    // End of a browse, when messages precede it the marker is put back
+                    // so the next call reports the end.
+                    std::size_t first = result.empty() ? i + 1 : i;
+                    for (std::size_t j = dispatches.size(); j > first; --j) {
+                        this->internal->unconsumedMessages->enqueueFirst(dispatches[j - 1]);
+                    }
+                    return result;
+                } else if (internal->consumeExpiredMessage(dispatch)) {
+                    beforeMessageIsConsumed(dispatch);
+                    afterMessageIsConsumed(dispatch, true);
+                    discarded = true;
+                } else if (internal->redeliveryExceeded(dispatch)) {
+                    internal->posionAck(dispatch,
+                                        "dispatch to " + getConsumerId()->toString() +
+                                        " exceeds RedeliveryPolicy limit: " +
+                                        Integer::toString(internal->redeliveryPolicy->getMaximumRedeliveries()));
+                    discarded = true;
+                } else {
+                    result.push_back(dispatch);
+                }
+            }
+
+            if (!result.empty()) {
+                return result;
+            }
+
+            if (discarded) {
+                if (timeout > 0) {
+                    timeout = Math::max(deadline - System::currentTimeMillis(), 0LL);
+                }
+
+                sendPullRequest(timeout);
+            }
+        }
+
+        return result;
+    } catch (InterruptedException& ex) {
+        Thread::currentThread()->interrupt();
+        throw CMSExceptionSupport::create(ex);
+    }
+    AMQ_CATCH_ALL_THROW_CMSEXCEPTION()
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 cms::Message* ActiveMQConsumerKernel::receive() {
 
     try {
 
+        this->awaitCreation();
         this->checkClosed();
         this->checkMessageListener();
 
@@ -1099,6 +1265,7 @@ cms::Message* ActiveMQConsumerKernel::receive(int timeout) {
 
     try {
 
+        this->awaitCreation();
         this->checkClosed();
         this->checkMessageListener();
         if (timeout == 0) {
@@ -1135,6 +1302,7 @@ cms::Message* ActiveMQConsumerKernel::receiveNoWait() {
 
     try {
 
+        this->awaitCreation();
         this->checkClosed();
         this->checkMessageListener();
 
@@ -1163,11 +1331,66 @@ cms::Message* ActiveMQConsumerKernel::receiveNoWait() {
     AMQ_CATCH_ALL_THROW_CMSEXCEPTION()
 }
 
+////////////////////////////////////////////////////////////////////////////////
+std::vector<cms::Message*> ActiveMQConsumerKernel::receiveBatch(int maxMessages, int millisecs) {
+
+    std::vector<cms::Message*> result;
+
+    try {
+
+        this->awaitCreation();
+        this->checkClosed();
+        this->checkMessageListener();
+
+        if (maxMessages <= 0) {
+            throw IllegalArgumentException(
+                __FILE__, __LINE__, "Batch size must be greater than zero: %d", maxMessages);
+        }
+
+        // A zero prefetch consumer pulls one message at a time from the broker.
+        if (internal->info->getPrefetchSize() == 0) {
+            cms::Message* message = this->receive(millisecs);
+            if (message != NULL) {
+                result.push_back(message);
+            }
+            return result;
+        }
+
+        // Send a request for a new message if needed
+        this->sendPullRequest(millisecs);
+
+        std::vector< Pointer<MessageDispatch> > dispatches = dequeueBatch(maxMessages, millisecs == 0 ? -1 : millisecs);
+        if (dispatches.empty()) {
+            return result;
+        }
+
+        beforeMessagesAreConsumed(dispatches);
+        afterMessagesAreConsumed(dispatches);
+
+        // Need to clone the messages because the user is responsible for freeing
+        // its copy of each message, createCMSMessage will do this for us.
+        std::vector< Pointer<cms::Message> > messages;
+        std::vector< Pointer<MessageDispatch> >::const_iterator iter = dispatches.begin();
+        for (; iter != dispatches.end(); ++iter) {
+            messages.push_back(createCMSMessage(*iter));
+        }
+
+        result.reserve(messages.size());
+        for (std::size_t i = 0; i < messages.size(); ++i) {
+            result.push_back(messages[i].release());
+        }
+
+        return result;
+    }
+    AMQ_CATCH_ALL_THROW_CMSEXCEPTION()
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 void ActiveMQConsumerKernel::setMessageListener(cms::MessageListener* listener) {
 
     try {
 
+        this->awaitCreation();
         this->checkClosed();
 
         if (this->consumerInfo->getPrefetchSize() == 0 && listener != NULL) {
@@ -1196,6 +1419,8 @@ void ActiveMQConsumerKernel::setMessageListener(cms::MessageListener* listener)
             synchronized(&(this->internal->listenerMutex)) {
                 this->internal->listener = NULL;
             }
+
+            sendDispatchedAck();
         }
     }
     AMQ_CATCH_ALL_THROW_CMSEXCEPTION()
@@ -1222,6 +1447,50 @@ void ActiveMQConsumerKernel::beforeMessageIsConsumed(Pointer<MessageDispatch> di
     }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConsumerKernel::beforeMessagesAreConsumed(const std::vector< Pointer<MessageDispatch> >& dispatches) {
+
+    this->internal->lastDeliveredSequenceId =
+        dispatches.back()->getMessage()->getMessageId()->getBrokerSequenceId();
+
+    if (!isAutoAcknowledgeBatch()) {
+
+        synchronized(&this->internal->deliveredMessages) {
+            std::vector< Pointer<MessageDispatch> >::const_iterator iter = dispatches.begin();
+            for (; iter != dispatches.end(); ++iter) {
+                this->internal->deliveredMessages.addFirst(*iter);
+            }
+        }
+
+        if (this->session->isTransacted()) {
+            std::vector< Pointer<MessageDispatch> >::const_iterator iter = dispatches.begin();
+            for (; iter != dispatches.end(); ++iter) {
+                if (this->internal->transactedIndividualAck) {
+                    immediateIndividualTransactedAck(*iter);
+                } else {
+                    ackLater(*iter, ActiveMQConstants::ACK_TYPE_DELIVERED);
+                }
+            }
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConsumerKernel::afterMessagesAreConsumed(const std::vector< Pointer<MessageDispatch> >& dispatches) {
+
+    // Without ack optimization the first call acks everything in the delivered list,
+    // so acking the last message covers the whole batch with one range ack.
+    if (isAutoAcknowledgeEach() && !this->internal->optimizeAcknowledge) {
+        afterMessageIsConsumed(dispatches.back(), false);
+        return;
+    }
+
+    std::vector< Pointer<MessageDispatch> >::const_iterator iter = dispatches.begin();
+    for (; iter != dispatches.end(); ++iter) {
+        afterMessageIsConsumed(*iter, false);
+    }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 void ActiveMQConsumerKernel::immediateIndividualTransactedAck(Pointer<MessageDispatch> dispatch) {
     // acks accumulate on the broker pending transaction completion to indicate delivery status
@@ -1488,17 +1757,28 @@ void ActiveMQConsumerKernel::commit() {
 
 ////////////////////////////////////////////////////////////////////////////////
 void ActiveMQConsumerKernel::rollback() {
+    rollback(this->internal->deliveredMessages, false);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConsumerKernel::rollbackEnded(DeliveredMessageList& ended) {
+    rollback(ended, true);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConsumerKernel::rollback(DeliveredMessageList& delivered, bool ended) {
 
     clearDeliveredList();
     synchronized(this->internal->unconsumedMessages.get()) {
-        if (this->internal->optimizeAcknowledge) {
+        // Acks held back by optimizeAcknowledge belong to the current transaction.
+        if (this->internal->optimizeAcknowledge && !ended) {
             // remove messages read but not acknowledged at the broker yet through optimizeAcknowledge
             if (!this->consumerInfo->isBrowser()) {
                 synchronized(&this->internal->deliveredMessages) {
-                    for (int i = 0; (i < this->internal->deliveredMessages.size()) &&
+                    for (int i = 0; (i < delivered.size()) &&
                                     (i < this->internal->ackCounter); i++) {
                         // ensure we don't filter this as a duplicate
-                        Pointer<MessageDispatch> md = this->internal->deliveredMessages.removeLast();
+                        Pointer<MessageDispatch> md = delivered.removeLast();
                         session->getConnection()->rollbackDuplicate(this, md->getMessage());
                     }
                 }
@@ -1506,13 +1786,13 @@ void ActiveMQConsumerKernel::rollback() {
         }
 
         synchronized(&this->internal->deliveredMessages) {
-            this->internal->rollbackPreviouslyDeliveredAndNotRedelivered();
-            if (this->internal->deliveredMessages.isEmpty()) {
+            this->internal->rollbackPreviouslyDeliveredAndNotRedelivered(delivered);
+            if (delivered.isEmpty()) {
                 return;
             }
 
             // Only increase the redelivery delay after the first redelivery..
-            Pointer<MessageDispatch> lastMsg = this->internal->deliveredMessages.getFirst();
+            Pointer<MessageDispatch> lastMsg = delivered.getFirst();
             const int currentRedeliveryCount = lastMsg->getMessage()->getRedeliveryCounter();
             if (currentRedeliveryCount > 0) {
                 this->internal->redeliveryDelay = this->internal->redeliveryPolicy->getNextRedeliveryDelay(internal->redeliveryDelay);
@@ -1520,9 +1800,9 @@ void ActiveMQConsumerKernel::rollback() {
                 this->internal->redeliveryDelay = this->internal->redeliveryPolicy->getInitialRedeliveryDelay();
             }
 
-            Pointer<MessageId> firstMsgId = this->internal->deliveredMessages.getLast()->getMessage()->getMessageId();
+            Pointer<MessageId> firstMsgId = delivered.getLast()->getMessage()->getMessageId();
 
-            Pointer<Iterator<Pointer<MessageDispatch> > > iter(internal->deliveredMessages.iterator());
+            Pointer<Iterator<Pointer<MessageDispatch> > > iter(delivered.iterator());
             while (iter->hasNext()) {
                 Pointer<Message> message = iter->next()->getMessage();
                 message->setRedeliveryCounter(message->getRedeliveryCounter() + 1);
@@ -1536,7 +1816,7 @@ void ActiveMQConsumerKernel::rollback() {
                 // We need to NACK the messages so that they get sent to the DLQ.
                 // Acknowledge the last message.
                 Pointer<MessageAck> ack(new MessageAck(lastMsg, ActiveMQConstants::ACK_TYPE_POISON,
-                                        this->internal->deliveredMessages.size()));
+                                        delivered.size()));
                 ack->setFirstMessageId(firstMsgId);
 
                 std::string message = "Exceeded RedeliveryPolicy max redelivery limit: " +
@@ -1550,18 +1830,18 @@ void ActiveMQConsumerKernel::rollback() {
                 session->sendAck(ack, true);
                 // Adjust the window size.
                 this->internal->additionalWindowSize = Math::max(0,
-                    this->internal->additionalWindowSize - (int) this->internal->deliveredMessages.size());
+                    this->internal->additionalWindowSize - (int) delivered.size());
                 this->internal->redeliveryDelay = 0;
 
-                this->internal->deliveredCounter -= (int) internal->deliveredMessages.size();
-                this->internal->deliveredMessages.clear();
+                this->internal->deliveredCounter -= (int) delivered.size();
+                delivered.clear();
 
             } else {
 
                 // only redelivery_ack after first delivery
                 if (currentRedeliveryCount > 0) {
                     Pointer<MessageAck> ack(new MessageAck(lastMsg, ActiveMQConstants::ACK_TYPE_REDELIVERED,
-                                            this->internal->deliveredMessages.size()));
+                                            delivered.size()));
                     ack->setFirstMessageId(firstMsgId);
                     session->sendAck(ack);
                 }
@@ -1573,10 +1853,10 @@ void ActiveMQConsumerKernel::rollback() {
                             this->session->lookupConsumerKernel(this->consumerInfo->getConsumerId());
 
                         NonBlockingRedeliveryTask* redeliveryTask =
-                            new NonBlockingRedeliveryTask(session, self, this->internal);
+                            new NonBlockingRedeliveryTask(session, self, this->internal, delivered);
 
-                        this->internal->deliveredCounter -= (int) internal->deliveredMessages.size();
-                        this->internal->deliveredMessages.clear();
+                        this->internal->deliveredCounter -= (int) delivered.size();
+                        delivered.clear();
 
                         this->session->getScheduler()->executeAfterDelay(
                             redeliveryTask, this->internal->redeliveryDelay);
@@ -1586,13 +1866,13 @@ void ActiveMQConsumerKernel::rollback() {
                     this->internal->unconsumedMessages->stop();
 
                     std::auto_ptr<Iterator<Pointer<MessageDispatch> > > iter(
-                        this->internal->deliveredMessages.iterator());
+                        delivered.iterator());
                     while (iter->hasNext()) {
                         this->internal->unconsumedMessages->enqueueFirst(iter->next());
                     }
 
-                    this->internal->deliveredCounter -= (int) internal->deliveredMessages.size();
-                    this->internal->deliveredMessages.clear();
+                    this->internal->deliveredCounter -= (int) delivered.size();
+                    delivered.clear();
 
                     if (internal->redeliveryDelay > 0 && !this->internal->unconsumedMessages->isClosed()) {
                         Pointer<ActiveMQConsumerKernel> self =
@@ -1636,22 +1916,26 @@ void ActiveMQConsumerKernel::dispatch(const Pointer<MessageDispatch>& dispatch)
                                                     Integer::toString(internal->redeliveryPolicy->getMaximumRedeliveries()));
                                 return;
                             }
-                            Pointer<cms::Message> message = createCMSMessage(dispatch);
-                            beforeMessageIsConsumed(dispatch);
-                            try {
-                                bool expired = isConsumerExpiryCheckEnabled() && dispatch->getMessage()->isExpired();
-                                if (!expired) {
-                                    this->internal->listener->onMessage(message.get());
-                                }
-                                afterMessageIsConsumed(dispatch, expired);
-                            } catch (RuntimeException& e) {
-                                dispatch->setRollbackCause(e);
-                                if (isAutoAcknowledgeBatch() || isAutoAcknowledgeEach() || session->isIndividualAcknowledge()) {
-                                    // Schedule redelivery and possible DLQ processing
-                                    rollback();
-                                } else {
-                                    // Transacted or Client ack: Deliver the next message.
-                                    afterMessageIsConsumed(dispatch, false);
+                            if (isOptimizedDispatch()) {
+                                dispatchToListener(dispatch);
+                            } else {
+                                Pointer<cms::Message> message = createCMSMessage(dispatch);
+                                beforeMessageIsConsumed(dispatch);
+                                try {
+                                    bool expired = isConsumerExpiryCheckEnabled() && dispatch->getMessage()->isExpired();
+                                    if (!expired) {
+                                        this->internal->listener->onMessage(message.get());
+                                    }
+                                    afterMessageIsConsumed(dispatch, expired);
+                                } catch (RuntimeException& e) {
+                                    dispatch->setRollbackCause(e);
+                                    if (isAutoAcknowledgeBatch() || isAutoAcknowledgeEach() || session->isIndividualAcknowledge()) {
+                                        // Schedule redelivery and possible DLQ processing
+                                        rollback();
+                                    } else {
+                                        // Transacted or Client ack: Deliver the next message.
+                                        afterMessageIsConsumed(dispatch, false);
+                                    }
                                 }
                             }
                         } else {
@@ -1695,6 +1979,88 @@ void ActiveMQConsumerKernel::dispatch(const Pointer<MessageDispatch>& dispatch)
     AMQ_CATCHALL_THROW(ActiveMQException)
 }
 
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConsumerKernel::dispatchToListener(const Pointer<MessageDispatch>& dispatch) {
+
+    const Pointer<Message>& message = dispatch->getMessage();
+    this->internal->lastDeliveredSequenceId = message->getMessageId()->getBrokerSequenceId();
+
+    if (isConsumerExpiryCheckEnabled() && message->isExpired()) {
+        acknowledge(dispatch, ActiveMQConstants::ACK_TYPE_EXPIRED);
+        return;
+    }
+
+    // The listener gets a copy so that a message it changes, say with clearBody, is
+    // redelivered as it was received.  The copy shares the body bytes of the original.
+    Pointer<Message> copy = message->copy();
+    copy->setAckHandler(this->internal->noOpAckHandler);
+
+    try {
+        this->internal->listener->onMessage(dynamic_cast<cms::Message*>(copy.get()));
+    } catch (RuntimeException& e) {
+        dispatch->setRollbackCause(e);
+        if (isAutoAcknowledgeEach()) {
+            // Ack the messages consumed before this one, then schedule its redelivery
+            // the same way the regular path does.
+            sendDispatchedAck();
+
+            synchronized(&this->internal->deliveredMessages) {
+                this->internal->deliveredMessages.addFirst(dispatch);
+            }
+            rollback();
+            return;
+        }
+    }
+
+    if (this->internal->unconsumedMessages->isClosed()) {
+        return;
+    }
+
+    // Acks are held back while the session has further dispatches queued, and for dups
+    // ok topic consumers until half of the prefetch window has been consumed.
+    bool idle = isAutoAcknowledgeEach() && !this->session->hasUnconsumedMessages();
+    int batchSize = Math::max(1, this->consumerInfo->getPrefetchSize() / 2);
+
+    Pointer<MessageAck> ack;
+    synchronized(&this->internal->deliveredMessages) {
+        if (this->internal->dispatchedAckCount == 0) {
+            this->internal->dispatchedAckFirst = message->getMessageId();
+        }
+        this->internal->dispatchedAckLast = dispatch;
+        this->internal->dispatchedAckCount++;
+
+        if (idle || this->internal->dispatchedAckCount >= batchSize) {
+            ack = this->internal->takeDispatchedAck();
+        }
+    }
+
+    if (ack != NULL) {
+        this->session->sendAck(ack);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConsumerKernel::sendDispatchedAck() {
+
+    Pointer<MessageAck> ack;
+    synchronized(&this->internal->deliveredMessages) {
+        ack = this->internal->takeDispatchedAck();
+    }
+
+    if (ack != NULL) {
+        this->session->sendAck(ack);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool ActiveMQConsumerKernel::isOptimizedDispatch() const {
+    return this->internal->optimizeDispatch &&
+           this->internal->transformer == NULL &&
+           !this->consumerInfo->isBrowser() &&
+           !this->session->isTransacted() &&
+           (this->session->isAutoAcknowledge() || this->session->isDupsOkAcknowledge());
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 Pointer<cms::Message> ActiveMQConsumerKernel::createCMSMessage(Pointer<MessageDispatch> dispatch) {
 
@@ -1735,8 +2101,7 @@ Pointer<cms::Message> ActiveMQConsumerKernel::createCMSMessage(Pointer<MessageDi
             Pointer<ActiveMQAckHandler> ackHandler(new IndividualAckHandler(this, dispatch));
             message->setAckHandler(ackHandler);
         } else {
-            Pointer<ActiveMQAckHandler> ackHandler(new NoOpAckHandler());
-            message->setAckHandler(ackHandler);
+            message->setAckHandler(this->internal->noOpAckHandler);
         }
 
         return message.dynamicCast<cms::Message>();
@@ -1773,6 +2138,24 @@ void ActiveMQConsumerKernel::sendPullRequest(long long timeout) {
     AMQ_CATCHALL_THROW(ActiveMQException)
 }
 
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConsumerKernel::setCreationResponse(const Pointer<transport::FutureResponse>& response) {
+    this->internal->creation.setFuture(response);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQConsumerKernel::awaitCreation() {
+
+    if (this->internal->creation.await()) {
+        try {
+            dispose();
+        } catch (Exception& ex) {
+        }
+    }
+
+    this->internal->creation.checkCreated();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 void ActiveMQConsumerKernel::checkClosed() const {
     if (this->isClosed()) {
@@ -28,9 +28,11 @@
 #include <activemq/commands/ConsumerInfo.h>
 #include <activemq/commands/MessageAck.h>
 #include <activemq/commands/MessageDispatch.h>
+#include <activemq/core/DeliveredMessageList.h>
 #include <activemq/core/Dispatcher.h>
 #include <activemq/core/RedeliveryPolicy.h>
 #include <activemq/core/MessageDispatchChannel.h>
+#include <activemq/transport/FutureResponse.h>
 
 #include <decaf/util/concurrent/atomic/AtomicBoolean.h>
 #include <decaf/lang/Pointer.h>
@@ -121,6 +123,28 @@ namespace kernels {
 
     public:  // ActiveMQConsumerKernel Methods
 
+        /**
+         * Receives up to maxMessages messages in a single call.  The call waits up to the
+         * given time for the first message, a timeout of zero waits indefinitely as
+         * receive(int) does, and then takes whatever further messages are already
+         * waiting in the Consumer without waiting for more.  The messages are taken from
+         * the Consumer's dispatch channel under one lock, and in the auto acknowledge
+         * mode the whole batch is acknowledged with a single range ack.
+         *
+         * The caller owns the returned messages and must delete them.
+         *
+         * @param maxMessages
+         *      The maximum number of messages to return, must be greater than zero.
+         * @param millisecs
+         *      The time in milliseconds to wait for the first message.
+         *
+         * @return the received messages in delivery order, empty if no message arrived
+         *         in time or the Consumer was closed.
+         *
+         * @throws CMSException if an error occurs while receiving.
+         */
+        std::vector<cms::Message*> receiveBatch(int maxMessages, int millisecs);
+
         /**
          * Method called to acknowledge all messages that have been received so far.
          *
@@ -156,6 +180,18 @@ namespace kernels {
          */
         void rollback();
 
+        /**
+         * Rolls back the messages of a transaction that ended before its rollback
+         * completed, the messages delivered since in the session's next transaction
+         * are left alone.
+         *
+         * @param ended
+         *      The messages delivered in the ended transaction, newest first.
+         *
+         * @throw ActiveMQException if an error occurs while performing the operation.
+         */
+        void rollbackEnded(DeliveredMessageList& ended);
+
         /**
          * Performs the actual close operation on this consumer
          *
@@ -199,6 +235,24 @@ namespace kernels {
          */
         void setSynchronizationRegistered(bool value);
 
+        /**
+         * Sets the FutureResponse of the ConsumerInfo that created this consumer when it was
+         * sent without waiting for the broker's response.
+         *
+         * @param response
+         *      The FutureResponse that receives the broker's response to the ConsumerInfo.
+         */
+        void setCreationResponse(const Pointer<transport::FutureResponse>& response);
+
+        /**
+         * Waits for the broker to respond to the ConsumerInfo if this consumer was created
+         * without waiting.  A consumer the broker refused to create is disposed of and the
+         * broker's error is thrown, now and on every later call.
+         *
+         * @throws ActiveMQException if the broker refused to create this consumer.
+         */
+        void awaitCreation();
+
         /**
          * Deliver any pending messages to the registered MessageListener if there
          * is one, return true if not all dispatched, or false if no listener or all
@@ -397,6 +451,18 @@ namespace kernels {
          */
         Pointer<MessageDispatch> dequeue(long long timeout);
 
+        /**
+         * Used by receiveBatch to take up to maxMessages messages in one pass, waiting for
+         * the first one the same way dequeue does.  Expired messages and messages that have
+         * exceeded the redelivery limit are acknowledged and left out of the result.
+         *
+         * @param maxMessages - The maximum number of messages to return.
+         * @param timeout - The time to wait for the first message, as for dequeue.
+         *
+         * @return the messages received within the allotted time, may be empty.
+         */
+        std::vector< Pointer<MessageDispatch> > dequeueBatch(int maxMessages, long long timeout);
+
         /**
          * Pre-consume processing
          * @param dispatch - the message being consumed.
@@ -410,6 +476,28 @@ namespace kernels {
          */
         void afterMessageIsConsumed(Pointer<commands::MessageDispatch> dispatch, bool messageExpired);
 
+        /**
+         * Pre-consume processing for a batch of messages, records them as delivered
+         * with a single lock of the delivered list.
+         * @param dispatches - the messages being consumed, in delivery order.
+         */
+        void beforeMessagesAreConsumed(const std::vector< Pointer<commands::MessageDispatch> >& dispatches);
+
+        /**
+         * Post-consume processing for a batch of messages, in the auto acknowledge mode
+         * the whole batch is covered by one ack.
+         * @param dispatches - the consumed messages, in delivery order.
+         */
+        void afterMessagesAreConsumed(const std::vector< Pointer<commands::MessageDispatch> >& dispatches);
+
+        /**
+         * Delivers the message to the listener on the optimized dispatch path, the message
+         * is not copied or added to the delivered list and its ack is coalesced with those
+         * of the messages around it.
+         * @param dispatch - the message being delivered.
+         */
+        void dispatchToListener(const Pointer<commands::MessageDispatch>& dispatch);
+
     private:
 
         Pointer<cms::Message> createCMSMessage(Pointer<commands::MessageDispatch> dispatch);
@@ -432,10 +520,16 @@ namespace kernels {
 
         bool isAutoAcknowledgeBatch() const;
 
+        bool isOptimizedDispatch() const;
+
+        void sendDispatchedAck();
+
         void registerSync();
 
         void clearDeliveredList();
 
+        void rollback(DeliveredMessageList& delivered, bool ended);
+
     };
 
 }}}
@@ -20,6 +20,7 @@
 #include <cms/Message.h>
 #include <activemq/core/kernels/ActiveMQSessionKernel.h>
 #include <activemq/core/ActiveMQConnection.h>
+#include <activemq/commands/Message.h>
 #include <activemq/commands/RemoveInfo.h>
 #include <activemq/util/CMSExceptionSupport.h>
 #include <activemq/util/ActiveMQProperties.h>
@@ -57,7 +58,9 @@ ActiveMQProducerKernel::ActiveMQProducerKernel(ActiveMQSessionKernel* session,
                                                                         memoryUsage(),
                                                                         destination(),
                                                                         messageSequence(),
-                                                                        transformer() {
+                                                                        transformer(),
+                                                                        copyMessageOnSend(true),
+                                                                        creation() {
 
     if (session == NULL || producerId == NULL) {
         throw ActiveMQException(
@@ -70,6 +73,7 @@ ActiveMQProducerKernel::ActiveMQProducerKernel(ActiveMQSessionKernel* session,
     this->producerInfo->setProducerId(producerId);
     this->producerInfo->setDestination(destination);
     this->producerInfo->setWindowSize(session->getConnection()->getProducerWindowSize());
+    this->copyMessageOnSend = session->getConnection()->isCopyMessageOnSend();
 
     // Get any options specified in the destination and apply them to the
     // ProducerInfo object.
@@ -77,6 +81,8 @@ ActiveMQProducerKernel::ActiveMQProducerKernel(ActiveMQSessionKernel* session,
         const ActiveMQProperties& options = destination->getOptions();
         this->producerInfo->setDispatchAsync(
             Boolean::parseBoolean(options.getProperty("producer.dispatchAsync", "false")));
+        this->copyMessageOnSend = Boolean::parseBoolean(
+            options.getProperty("producer.copyMessageOnSend", Boolean::toString(this->copyMessageOnSend)));
 
         this->destination = destination.dynamicCast<cms::Destination>();
     }
@@ -101,6 +107,11 @@ void ActiveMQProducerKernel::close() {
 
     try {
 
+        // A producer the broker refused to create only needs to be disposed of locally.
+        if (this->creation.await()) {
+            dispose();
+        }
+
         if (!this->isClosed()) {
 
             dispose();
@@ -138,7 +149,6 @@ void ActiveMQProducerKernel::dispose() {
 void ActiveMQProducerKernel::send(cms::Message* message) {
 
     try {
-        this->checkClosed();
         this->send(this->destination.get(), message, defaultDeliveryMode, defaultPriority, defaultTimeToLive, NULL);
     }
     AMQ_CATCH_ALL_THROW_CMSEXCEPTION()
@@ -148,7 +158,6 @@ void ActiveMQProducerKernel::send(cms::Message* message) {
 void ActiveMQProducerKernel::send(cms::Message* message, cms::AsyncCallback* callback) {
 
     try {
-        this->checkClosed();
         this->send(this->destination.get(), message, defaultDeliveryMode, defaultPriority, defaultTimeToLive, callback);
     }
     AMQ_CATCH_ALL_THROW_CMSEXCEPTION()
@@ -158,7 +167,6 @@ void ActiveMQProducerKernel::send(cms::Message* message, cms::AsyncCallback* cal
 void ActiveMQProducerKernel::send(cms::Message* message, int deliveryMode, int priority, long long timeToLive) {
 
     try {
-        this->checkClosed();
         this->send(this->destination.get(), message, deliveryMode, priority, timeToLive, NULL);
     }
     AMQ_CATCH_ALL_THROW_CMSEXCEPTION()
@@ -168,7 +176,6 @@ void ActiveMQProducerKernel::send(cms::Message* message, int deliveryMode, int p
 void ActiveMQProducerKernel::send(cms::Message* message, int deliveryMode, int priority, long long timeToLive, cms::AsyncCallback* callback) {
 
     try {
-        this->checkClosed();
         this->send(this->destination.get(), message, deliveryMode, priority, timeToLive, callback);
     }
     AMQ_CATCH_ALL_THROW_CMSEXCEPTION()
@@ -178,7 +185,6 @@ void ActiveMQProducerKernel::send(cms::Message* message, int deliveryMode, int p
 void ActiveMQProducerKernel::send(const cms::Destination* destination, cms::Message* message) {
 
     try {
-        this->checkClosed();
         this->send(destination, message, defaultDeliveryMode, defaultPriority, defaultTimeToLive, NULL);
     }
     AMQ_CATCH_ALL_THROW_CMSEXCEPTION()
@@ -188,7 +194,6 @@ void ActiveMQProducerKernel::send(const cms::Destination* destination, cms::Mess
 void ActiveMQProducerKernel::send(const cms::Destination* destination, cms::Message* message, cms::AsyncCallback* callback) {
 
     try {
-        this->checkClosed();
         this->send(destination, message, defaultDeliveryMode, defaultPriority, defaultTimeToLive, callback);
     }
     AMQ_CATCH_ALL_THROW_CMSEXCEPTION()
@@ -199,7 +204,6 @@ void ActiveMQProducerKernel::send(const cms::Destination* destination, cms::Mess
                                   int deliveryMode, int priority, long long timeToLive) {
 
     try {
-        this->checkClosed();
         this->send(destination, message, deliveryMode, priority, timeToLive, NULL);
     }
     AMQ_CATCH_ALL_THROW_CMSEXCEPTION()
@@ -209,8 +213,16 @@ void ActiveMQProducerKernel::send(const cms::Destination* destination, cms::Mess
 void ActiveMQProducerKernel::send(const cms::Destination* destination, cms::Message* message,
                                   int deliveryMode, int priority, long long timeToLive, cms::AsyncCallback* onComplete) {
 
+    // When messages are not copied on send the producer owns each message it is
+    // handed from here on, even if the send fails.
+    Pointer<commands::Message> ownedMessage;
+    if (!this->copyMessageOnSend) {
+        ownedMessage.reset(dynamic_cast<commands::Message*>(message));
+    }
+
     try {
 
+        this->awaitCreation();
         this->checkClosed();
 
         if (destination == NULL) {
@@ -252,8 +264,14 @@ void ActiveMQProducerKernel::send(const cms::Destination* destination, cms::Mess
             if (this->transformer->producerTransform(this->session, this, message, &outbound)) {
                 // scopedMessage ensures that when we are responsible for the lifetime of the
                 // transformed message, the message remains valid until the send operation either
-                // succeeds or throws an exception.
-                scopedMessage.reset(outbound);
+                // succeeds or throws an exception.  A message that is sent without a copy must
+                // share the count the session takes on it, so it is held by its command type.
+                commands::Message* command = dynamic_cast<commands::Message*>(outbound);
+                if (command != NULL && !this->copyMessageOnSend) {
+                    ownedMessage.reset(command);
+                } else {
+                    scopedMessage.reset(outbound);
+                }
             }
             if (outbound == NULL) {
                 throw NullPointerException(__FILE__, __LINE__, "MessageTransformer set transformed message to NULL");
@@ -288,6 +306,24 @@ void ActiveMQProducerKernel::onProducerAck(const commands::ProducerAck& ack) {
     AMQ_CATCHALL_THROW(ActiveMQException)
 }
 
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQProducerKernel::setCreationResponse(const Pointer<transport::FutureResponse>& response) {
+    this->creation.setFuture(response);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQProducerKernel::awaitCreation() {
+
+    if (this->creation.await()) {
+        try {
+            dispose();
+        } catch (Exception& ex) {
+        }
+    }
+
+    this->creation.checkCreated();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 void ActiveMQProducerKernel::checkClosed() const {
     if (closed) {
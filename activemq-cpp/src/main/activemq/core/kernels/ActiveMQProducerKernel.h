@@ -30,6 +30,8 @@
 #include <activemq/commands/ProducerInfo.h>
 #include <activemq/commands/ProducerAck.h>
 #include <activemq/exceptions/ActiveMQException.h>
+#include <activemq/core/PendingCreation.h>
+#include <activemq/transport/FutureResponse.h>
 
 #include <memory>
 
@@ -83,6 +85,12 @@ namespace kernels {
         // Used to tranform Message before sending them to the CMS bus.
         cms::MessageTransformer* transformer;
 
+        // Should sent messages be copied, if not the producer takes ownership of them.
+        bool copyMessageOnSend;
+
+        // Response to the ProducerInfo when it was sent without waiting for the broker.
+        PendingCreation creation;
+
     private:
 
         ActiveMQProducerKernel(const ActiveMQProducerKernel&);
@@ -250,6 +258,30 @@ namespace kernels {
             return this->sendTimeout;
         }
 
+        /**
+         * @return true if messages are copied before they are sent, when false the
+         *         producer takes ownership of the messages passed to send.
+         */
+        bool isCopyMessageOnSend() const {
+            return this->copyMessageOnSend;
+        }
+
+        /**
+         * Sets whether messages are copied before they are sent.  The copy lets the
+         * caller reuse or delete the message once send returns.  When disabled the
+         * ActiveMQ message given to send is marshaled as is and the producer takes
+         * ownership of it whether or not the send succeeds, the caller must give up
+         * any reference it holds and must not touch the message again.  Messages from
+         * another provider are still converted into a new message and remain owned by
+         * the caller.
+         *
+         * @param value
+         *      True if messages should be copied before they are sent.
+         */
+        void setCopyMessageOnSend(bool value) {
+            this->copyMessageOnSend = value;
+        }
+
         /**
          * @return true if this Producer has been closed.
          */
@@ -289,6 +321,24 @@ namespace kernels {
          */
         void dispose();
 
+        /**
+         * Sets the FutureResponse of the ProducerInfo that created this producer when it was
+         * sent without waiting for the broker's response.
+         *
+         * @param response
+         *      The FutureResponse that receives the broker's response to the ProducerInfo.
+         */
+        void setCreationResponse(const Pointer<transport::FutureResponse>& response);
+
+        /**
+         * Waits for the broker to respond to the ProducerInfo if this producer was created
+         * without waiting.  A producer the broker refused to create is disposed of and the
+         * broker's error is thrown, now and on every later call.
+         *
+         * @throws ActiveMQException if the broker refused to create this producer.
+         */
+        void awaitCreation();
+
         /**
          * @return the next sequence number for a Message sent from this Producer.
          */
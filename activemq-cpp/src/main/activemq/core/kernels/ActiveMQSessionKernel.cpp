@@ -25,6 +25,7 @@
 #include <activemq/core/ActiveMQProducer.h>
 #include <activemq/core/ActiveMQQueueBrowser.h>
 #include <activemq/core/ActiveMQSessionExecutor.h>
+#include <activemq/core/BackgroundCompressor.h>
 #include <activemq/core/PrefetchPolicy.h>
 #include <activemq/util/ActiveMQProperties.h>
 #include <activemq/util/ActiveMQMessageTransformation.h>
@@ -54,12 +55,14 @@
 #include <decaf/lang/Long.h>
 #include <decaf/lang/Math.h>
 #include <decaf/util/Queue.h>
+#include <decaf/util/HashMap.h>
 #include <decaf/util/LinkedList.h>
 #include <decaf/util/concurrent/Mutex.h>
 #include <decaf/util/concurrent/atomic/AtomicBoolean.h>
 #include <decaf/util/concurrent/locks/ReentrantReadWriteLock.h>
 #include <decaf/lang/exceptions/InvalidStateException.h>
 #include <decaf/lang/exceptions/NullPointerException.h>
+#include <decaf/util/NoSuchElementException.h>
 
 using namespace std;
 using namespace activemq;
@@ -95,9 +98,13 @@ namespace kernels{
         decaf::util::LinkedList< Pointer<ActiveMQProducerKernel> > producers;
         decaf::util::concurrent::locks::ReentrantReadWriteLock consumerLock;
         decaf::util::LinkedList< Pointer<ActiveMQConsumerKernel> > consumers;
+        // Index of the consumers list by ConsumerId value, guarded by consumerLock.
+        decaf::util::HashMap< commands::ConsumerId, Pointer<ActiveMQConsumerKernel> > consumersById;
         Pointer<Scheduler> scheduler;
         Pointer<CloseSynhcronization> closeSync;
         Mutex sendMutex;
+        // Created on the first send handed to the pool, guarded by sendMutex.
+        Pointer<BackgroundCompressor> compressor;
         cms::MessageTransformer* transformer;
         int hashCode;
         bool sessionAsyncDispatch;
@@ -105,8 +112,8 @@ namespace kernels{
     public:
 
         SessionConfig() : synchronizationRegistered(false),
-                          producerLock(), producers(), consumerLock(), consumers(),
-                          scheduler(), closeSync(), sendMutex(), transformer(NULL),
+                          producerLock(), producers(), consumerLock(), consumers(), consumersById(),
+                          scheduler(), closeSync(), sendMutex(), compressor(), transformer(NULL),
                           hashCode(), sessionAsyncDispatch(true) {}
         ~SessionConfig() {}
     };
@@ -356,6 +363,17 @@ void ActiveMQSessionKernel::dispose() {
 
         Finalizer final(this, this->connection);
 
+        // Send what is waiting to be compressed in the background before the producers go.
+        synchronized(&this->config->sendMutex) {
+            if (this->config->compressor != NULL) {
+                try {
+                    this->config->compressor->close();
+                } catch (Exception& ex) {
+                    this->connection->onAsyncException(ex);
+                }
+            }
+        }
+
         // Stop the dispatch executor.
         stop();
 
@@ -378,6 +396,7 @@ void ActiveMQSessionKernel::dispose() {
                 }
             }
             this->config->consumers.clear();
+            this->config->consumersById.clear();
             this->config->consumerLock.writeLock().unlock();
         } catch (Exception& ex) {
             this->config->consumerLock.writeLock().unlock();
@@ -453,6 +472,42 @@ void ActiveMQSessionKernel::rollback() {
     AMQ_CATCH_ALL_THROW_CMSEXCEPTION()
 }
 
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQSessionKernel::commit(cms::AsyncCallback* onComplete) {
+
+    try {
+
+        this->checkClosed();
+
+        if (!this->isTransacted()) {
+            throw ActiveMQException(
+                __FILE__, __LINE__, "ActiveMQSessionKernel::commit - This Session is not Transacted");
+        }
+
+        // Commit the Transaction, the next one can start before the broker responds.
+        this->transaction->commit(onComplete);
+    }
+    AMQ_CATCH_ALL_THROW_CMSEXCEPTION()
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQSessionKernel::rollback(cms::AsyncCallback* onComplete) {
+
+    try {
+
+        this->checkClosed();
+
+        if (!this->isTransacted()) {
+            throw ActiveMQException(
+                __FILE__, __LINE__, "ActiveMQSessionKernel::rollback - This Session is not Transacted");
+        }
+
+        // Roll back the Transaction, the next one can start before the broker responds.
+        this->transaction->rollback(onComplete);
+    }
+    AMQ_CATCH_ALL_THROW_CMSEXCEPTION()
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 void ActiveMQSessionKernel::recover() {
 
@@ -592,7 +647,7 @@ cms::MessageConsumer* ActiveMQSessionKernel::createConsumer(const cms::Destinati
 
         try{
             this->addConsumer(consumer);
-            this->connection->syncRequest(consumer->getConsumerInfo());
+            consumer->setCreationResponse(this->requestCreation(consumer->getConsumerInfo()));
         } catch (Exception& ex) {
             this->removeConsumer(consumer);
             throw;
@@ -636,7 +691,7 @@ cms::MessageConsumer* ActiveMQSessionKernel::createDurableConsumer(const cms::To
 
         try {
             this->addConsumer(consumer);
-            this->connection->syncRequest(consumer->getConsumerInfo());
+            consumer->setCreationResponse(this->requestCreation(consumer->getConsumerInfo()));
         } catch (Exception& ex) {
             this->removeConsumer(consumer);
             throw;
@@ -686,7 +741,7 @@ cms::MessageProducer* ActiveMQSessionKernel::createProducer(const cms::Destinati
 
         try {
             this->addProducer(producer);
-            this->connection->syncRequest(producer->getProducerInfo());
+            producer->setCreationResponse(this->requestCreation(producer->getProducerInfo()));
         } catch (Exception& ex) {
             this->removeProducer(producer);
             throw;
@@ -961,23 +1016,36 @@ void ActiveMQSessionKernel::send(kernels::ActiveMQProducerKernel* producer, Poin
             id->setProducerSequenceId(sequenceId);
 
             // NOTE:
-            // Now we copy the message before sending, this allows the user to reuse the
-            // message object without interfering with the copy that's being sent.  We
-            // could make this step optional to increase performance but for now we won't.
-            // To not do this implies that the user must never reuse the message object, or
-            // know that the configuration of Transports doesn't involve the message hanging
-            // around beyond the point that send returns.  When the transform step results in
-            // a new Message object being created we can just use that new instance, but when
-            // the original cms::Message pointer was already a commands::Message then we need
-            // to clone it.
+            // Unless the producer has been told otherwise we copy the message before sending,
+            // this allows the user to reuse the message object without interfering with the
+            // copy that's being sent.  When the transform step results in a new Message object
+            // being created we can just use that new instance.  When the original cms::Message
+            // pointer was already a commands::Message we clone it, or if the producer doesn't
+            // copy on send it has taken ownership of the message and we share that, the count
+            // kept in the message lets the transports and the state tracker hold on to it
+            // after send returns.
             if (ActiveMQMessageTransformation::transformMessage(message, connection, &transformed)) {
                 amqMessage.reset(transformed);
+
+                // Sets the Message ID on the original message per spec, a foreign
+                // message only takes the string form.
+                message->setCMSMessageID(id->toString());
             } else {
-                amqMessage.reset(transformed->cloneDataStructure());
+                if (!producer->isCopyMessageOnSend()) {
+                    amqMessage.reset(transformed);
+                } else {
+                    amqMessage.reset(transformed->cloneDataStructure());
+
+                    // The original is one of ours so it takes a MessageId directly rather
+                    // than formatting one to a string and parsing it back.  It gets its own
+                    // instance, the sent copy's id caches its string form and may be read
+                    // from the transport and compression threads while the caller uses the
+                    // original.
+                    transformed->setMessageId(Pointer<commands::MessageId>(
+                        new commands::MessageId(producerId, sequenceId)));
+                }
             }
 
-            // Sets the Message ID on the original message per spec.
-            message->setCMSMessageID(id->toString());
             message->setCMSDestination(destination.dynamicCast<cms::Destination>().get());
 
             amqMessage->setMessageId(id);
@@ -991,17 +1059,47 @@ void ActiveMQSessionKernel::send(kernels::ActiveMQProducerKernel* producer, Poin
             amqMessage->onSend();
             amqMessage->setProducerId(producerId);
 
+            Pointer<BackgroundCompressor> compressor = this->config->compressor;
+
             if (onComplete == NULL && sendTimeout <= 0 && !amqMessage->isResponseRequired() && !this->connection->isAlwaysSyncSend() &&
                 (!amqMessage->isPersistent() || this->connection->isUseAsyncSend() || amqMessage->getTransactionId() != NULL)) {
 
-                // No Response Required, send is asynchronous.
-                this->connection->oneway(amqMessage);
+                // Transacted sends stay on this thread so they are all out before the commit,
+                // the others go to the pool if compressing them is worth doing in the
+                // background, or when an earlier one is still there so they stay in order.
+                if (txId == NULL && ((compressor != NULL && compressor->isPending()) ||
+                    (this->connection->isBackgroundCompression() && amqMessage->isCompressionRequired()))) {
 
-                if (producerWindow != NULL) {
-                    producerWindow->enqueueUsage(amqMessage->getSize());
+                    if (compressor == NULL) {
+                        compressor.reset(new BackgroundCompressor(this->connection));
+                        this->config->compressor = compressor;
+                    }
+
+                    compressor->send(amqMessage, producerWindow);
+
+                } else {
+
+                    if (compressor != NULL) {
+                        compressor->drain();
+                    }
+
+                    // No Response Required, send is asynchronous.
+                    amqMessage->compress();
+                    this->connection->oneway(amqMessage);
+
+                    if (producerWindow != NULL) {
+                        producerWindow->enqueueUsage(amqMessage->getSize());
+                    }
                 }
 
             } else {
+
+                if (compressor != NULL) {
+                    compressor->drain();
+                }
+
+                amqMessage->compress();
+
                 if (sendTimeout > 0 && onComplete == NULL) {
                     this->connection->syncRequest(amqMessage, (unsigned int)sendTimeout);
                 } else {
@@ -1130,6 +1228,16 @@ bool ActiveMQSessionKernel::isStarted() const {
     return this->executor->isRunning();
 }
 
+////////////////////////////////////////////////////////////////////////////////
+bool ActiveMQSessionKernel::hasUnconsumedMessages() const {
+
+    if (this->executor.get() == NULL) {
+        return false;
+    }
+
+    return this->executor->hasUncomsumedMessages();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 void ActiveMQSessionKernel::createTemporaryDestination(commands::ActiveMQTempDestination* tempDestination) {
 
@@ -1230,6 +1338,17 @@ Pointer<Response> ActiveMQSessionKernel::syncRequest(Pointer<Command> command, u
     AMQ_CATCHALL_THROW(ActiveMQException)
 }
 
+////////////////////////////////////////////////////////////////////////////////
+Pointer<transport::FutureResponse> ActiveMQSessionKernel::requestCreation(Pointer<Command> info) {
+
+    if (this->connection->isPipelineCreation()) {
+        return this->connection->asyncRequest(info, Pointer<transport::ResponseCallback>());
+    }
+
+    this->connection->syncRequest(info);
+    return Pointer<transport::FutureResponse>();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 void ActiveMQSessionKernel::checkClosed() const {
     if (this->closed.get()) {
@@ -1247,6 +1366,7 @@ void ActiveMQSessionKernel::addConsumer(Pointer<ActiveMQConsumerKernel> consumer
         this->config->consumerLock.writeLock().lock();
         try {
             this->config->consumers.add(consumer);
+            this->config->consumersById.put(*consumer->getConsumerId(), consumer);
             this->config->consumerLock.writeLock().unlock();
         } catch (Exception& ex) {
             this->config->consumerLock.writeLock().unlock();
@@ -1268,7 +1388,9 @@ void ActiveMQSessionKernel::removeConsumer(Pointer<ActiveMQConsumerKernel> consu
         this->connection->removeDispatcher(consumer->getConsumerId());
         this->config->consumerLock.writeLock().lock();
         try {
-            this->config->consumers.remove(consumer);
+            if (this->config->consumers.remove(consumer)) {
+                this->config->consumersById.remove(*consumer->getConsumerId());
+            }
             this->connection->removeAuditedDispatcher(consumer.get());
             this->config->consumerLock.writeLock().unlock();
         } catch (Exception& ex) {
@@ -1307,6 +1429,13 @@ void ActiveMQSessionKernel::addProducer(Pointer<ActiveMQProducerKernel> producer
 void ActiveMQSessionKernel::removeProducer(Pointer<ActiveMQProducerKernel> producer) {
 
     try {
+        // Messages still waiting to be sent in the background refer to the producer's window.
+        synchronized(&this->config->sendMutex) {
+            if (this->config->compressor != NULL) {
+                this->config->compressor->drain();
+            }
+        }
+
         this->connection->removeProducer(producer->getProducerId());
         this->config->producerLock.writeLock().lock();
         try {
@@ -1350,24 +1479,20 @@ Pointer<ActiveMQProducerKernel> ActiveMQSessionKernel::lookupProducerKernel(Poin
 ////////////////////////////////////////////////////////////////////////////////
 Pointer<ActiveMQConsumerKernel> ActiveMQSessionKernel::lookupConsumerKernel(Pointer<ConsumerId> id) {
 
+    Pointer<ActiveMQConsumerKernel> consumer;
+
     this->config->consumerLock.readLock().lock();
     try {
-        Pointer<Iterator< Pointer<ActiveMQConsumerKernel> > > iter(this->config->consumers.iterator());
-
-        while (iter->hasNext()) {
-            Pointer<ActiveMQConsumerKernel> consumer = iter->next();
-            if (consumer->getConsumerId()->equals(*id)) {
-                this->config->consumerLock.readLock().unlock();
-                return consumer;
-            }
-        }
+        consumer = this->config->consumersById.get(*id);
+        this->config->consumerLock.readLock().unlock();
+    } catch (NoSuchElementException& ex) {
         this->config->consumerLock.readLock().unlock();
     } catch (Exception& ex) {
         this->config->consumerLock.readLock().unlock();
         throw;
     }
 
-    return Pointer<ActiveMQConsumerKernel>();
+    return consumer;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -160,6 +160,14 @@ namespace kernels {
          */
         bool isStarted() const;
 
+        /**
+         * Indicates whether the session has message dispatches queued that its executor
+         * has not yet handed to their consumers.
+         *
+         * @return true if further dispatches are waiting to be delivered.
+         */
+        bool hasUnconsumedMessages() const;
+
         virtual bool isAutoAcknowledge() const {
             return this->ackMode == cms::Session::AUTO_ACKNOWLEDGE;
         }
@@ -199,6 +207,41 @@ namespace kernels {
 
         virtual void recover();
 
+        /**
+         * Commits the current transaction without waiting for the broker to respond, the
+         * session can begin its next transaction while the commit is in flight.  Once the
+         * broker responds the transaction's consumers and producers are notified of the
+         * outcome and then the callback is, from the connection's executor thread.
+         *
+         * If the commit fails the consumers redeliver the messages from the failed
+         * transaction, those delivered since in the session's current transaction are
+         * not affected.
+         *
+         * @param onComplete
+         *      The callback notified when the commit completes, if NULL the commit is
+         *      done synchronously.
+         *
+         * @throws CMSException if the session is closed or not transacted or the
+         *         commit could not be sent.
+         */
+        virtual void commit(cms::AsyncCallback* onComplete);
+
+        /**
+         * Rolls back the current transaction without waiting for the broker to respond, the
+         * session can begin its next transaction while the rollback is in flight.  Once the
+         * broker responds the transaction's consumers redeliver their messages and then the
+         * callback is notified, from the connection's executor thread.  Messages delivered
+         * since in the session's current transaction are not affected.
+         *
+         * @param onComplete
+         *      The callback notified when the rollback completes, if NULL the rollback is
+         *      done synchronously.
+         *
+         * @throws CMSException if the session is closed or not transacted or the
+         *         rollback could not be sent.
+         */
+        virtual void rollback(cms::AsyncCallback* onComplete);
+
         virtual cms::MessageConsumer* createConsumer(const cms::Destination* destination);
 
         virtual cms::MessageConsumer* createConsumer(const cms::Destination* destination,
@@ -607,6 +650,12 @@ namespace kernels {
        // Checks for the closed state and throws if so.
        void checkClosed() const;
 
+       // Sends the Info command that creates a consumer or producer at the Broker.  When
+       // the connection pipelines creation the command is sent without waiting and its
+       // FutureResponse is returned, otherwise NULL is returned once the Broker responds.
+       // @param info - The ConsumerInfo or ProducerInfo to send.
+       Pointer<transport::FutureResponse> requestCreation(Pointer<commands::Command> info);
+
        // Send the Destination Creation Request to the Broker, alerting it
        // that we've created a new Temporary Destination.
        // @param tempDestination - The new Temporary Destination
@@ -64,6 +64,16 @@ void ActiveMQXASessionKernel::rollback() {
     throw cms::TransactionInProgressException("Cannot rollback inside an XASession");
 }
 
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQXASessionKernel::commit(cms::AsyncCallback* onComplete AMQCPP_UNUSED) {
+    throw cms::TransactionInProgressException("Cannot commit inside an XASession");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQXASessionKernel::rollback(cms::AsyncCallback* onComplete AMQCPP_UNUSED) {
+    throw cms::TransactionInProgressException("Cannot rollback inside an XASession");
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 cms::XAResource* ActiveMQXASessionKernel::getXAResource() const {
     return this->transaction.get();
@@ -50,6 +50,10 @@ namespace kernels {
 
         virtual void rollback();
 
+        virtual void commit(cms::AsyncCallback* onComplete);
+
+        virtual void rollback(cms::AsyncCallback* onComplete);
+
     public:  // XASession overrides
 
         virtual cms::XAResource* getXAResource() const;
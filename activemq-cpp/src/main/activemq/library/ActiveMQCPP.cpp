@@ -20,6 +20,9 @@
 #include <decaf/lang/Runtime.h>
 #include <activemq/wireformat/WireFormatRegistry.h>
 #include <activemq/transport/TransportRegistry.h>
+#include <activemq/threads/WorkStealingThreadPool.h>
+#include <activemq/transport/IOReactor.h>
+#include <activemq/transport/inactivity/InactivityMonitorService.h>
 #include <activemq/transport/discovery/DiscoveryAgentRegistry.h>
 
 #include <activemq/util/IdGenerator.h>
@@ -38,12 +41,14 @@
 using namespace activemq;
 using namespace activemq::library;
 using namespace activemq::util;
+using namespace activemq::threads;
 using namespace activemq::transport;
 using namespace activemq::transport::tcp;
 using namespace activemq::transport::mock;
 using namespace activemq::transport::failover;
 using namespace activemq::transport::discovery;
 using namespace activemq::transport::discovery::http;
+using namespace activemq::transport::inactivity;
 using namespace activemq::wireformat;
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -70,6 +75,15 @@ void ActiveMQCPP::initializeLibrary(int argc, char** argv) {
 
     // Start the IdGenerator Kernel
     IdGenerator::initialize();
+
+    // Create the shared service that runs the inactivity checks of all connections.
+    InactivityMonitorService::initialize();
+
+    // Create the shared reactor that reads the sockets of transports using it.
+    IOReactor::initialize();
+
+    // Create the shared pool that runs the sessions not using a thread of their own.
+    WorkStealingThreadPool::initialize();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -80,6 +94,15 @@ void ActiveMQCPP::initializeLibrary() {
 ////////////////////////////////////////////////////////////////////////////////
 void ActiveMQCPP::shutdownLibrary() {
 
+    // Stop the shared session dispatch threads.
+    WorkStealingThreadPool::shutdown();
+
+    // Stop the shared reactor threads.
+    IOReactor::shutdown();
+
+    // Stop the shared inactivity check threads.
+    InactivityMonitorService::shutdown();
+
     // Shutdown the IdGenerator Kernel
     IdGenerator::shutdown();
 
@@ -87,12 +87,14 @@ void ConnectionState::checkShutdown() const {
 ////////////////////////////////////////////////////////////////////////////////
 void ConnectionState::removeTempDestination(Pointer<ActiveMQDestination> destination) {
 
-    std::auto_ptr<decaf::util::Iterator<Pointer<DestinationInfo> > > iter(tempDestinations.iterator());
-
-    while (iter->hasNext()) {
-        Pointer<DestinationInfo> di = iter->next();
-        if (di->getDestination()->equals(destination.get())) {
-            iter->remove();
+    synchronized(&tempDestinations) {
+        std::auto_ptr<decaf::util::Iterator<Pointer<DestinationInfo> > > iter(tempDestinations.iterator());
+
+        while (iter->hasNext()) {
+            Pointer<DestinationInfo> di = iter->next();
+            if (di->getDestination()->equals(destination.get())) {
+                iter->remove();
+            }
         }
     }
 }
@@ -34,6 +34,7 @@
 #include <decaf/util/StlMap.h>
 #include <decaf/util/concurrent/atomic/AtomicBoolean.h>
 #include <decaf/util/concurrent/ConcurrentStlMap.h>
+#include <decaf/util/concurrent/Concurrent.h>
 #include <decaf/util/LinkedList.h>
 #include <decaf/lang/Pointer.h>
 
@@ -84,7 +85,9 @@ namespace state {
 
         void addTempDestination(Pointer<DestinationInfo> info) {
             checkShutdown();
-            tempDestinations.add(info);
+            synchronized(&tempDestinations) {
+                tempDestinations.add(info);
+            }
         }
 
         void removeTempDestination(Pointer<ActiveMQDestination> destination);
@@ -21,8 +21,8 @@
 #include <decaf/util/HashCode.h>
 #include <decaf/util/LinkedHashMap.h>
 #include <decaf/util/MapEntry.h>
-#include <decaf/util/NoSuchElementException.h>
 #include <decaf/util/concurrent/ConcurrentStlMap.h>
+#include <decaf/util/concurrent/Concurrent.h>
 
 #include <activemq/commands/ConsumerControl.h>
 #include <activemq/commands/ExceptionResponse.h>
@@ -46,7 +46,32 @@ namespace activemq {
 namespace state {
 
 
-    class MessageCache : public LinkedHashMap<Pointer<MessageId>, Pointer<Command> > {
+    /**
+     * A cached Message along with the number of bytes it has been counted as against
+     * the cache limit, the count is kept so that eviction takes back exactly what was
+     * added even if the Message is marshaled to a different size when replayed.
+     */
+    struct CachedMessage {
+
+        Pointer<Command> message;
+        int size;
+
+        CachedMessage() : message(), size(0) {
+        }
+
+        CachedMessage(Pointer<Command> message) : message(message), size(0) {
+        }
+
+        bool operator==(const CachedMessage& other) const {
+            return this->message == other.message;
+        }
+
+        bool operator!=(const CachedMessage& other) const {
+            return this->message != other.message;
+        }
+    };
+
+    class MessageCache : public LinkedHashMap<Pointer<MessageId>, CachedMessage> {
     protected:
 
         ConnectionStateTracker* parent;
@@ -58,16 +83,34 @@ namespace state {
     public:
 
         MessageCache(ConnectionStateTracker* parent) :
-            LinkedHashMap<Pointer<MessageId>, Pointer<Command> >(), parent(parent), currentCacheSize(0) {
+            LinkedHashMap<Pointer<MessageId>, CachedMessage>(), parent(parent), currentCacheSize(0) {
         }
 
         virtual ~MessageCache() {}
 
-        virtual bool removeEldestEntry(const MapEntry<Pointer<MessageId>, Pointer<Command> >& eldest) {
+        void cache(Pointer<MessageId> id, Pointer<Command> message) {
+            CachedMessage replaced;
+            if (this->put(id, CachedMessage(message), replaced)) {
+                currentCacheSize -= replaced.size;
+            }
+        }
+
+        /**
+         * Counts a sent Message against the cache limit, a Message that has already
+         * been pushed out of the cache by the time its send completes isn't counted.
+         */
+        void account(Pointer<MessageId> id, int size) {
+            if (this->containsKey(id)) {
+                CachedMessage& entry = this->get(id);
+                currentCacheSize += size - entry.size;
+                entry.size = size;
+            }
+        }
+
+        virtual bool removeEldestEntry(const MapEntry<Pointer<MessageId>, CachedMessage>& eldest) {
             bool result = currentCacheSize > parent->getMaxMessageCacheSize();
             if (result) {
-                Pointer<Message> message = eldest.getValue().dynamicCast<Message>();
-                currentCacheSize -= message->getSize();
+                currentCacheSize -= eldest.getValue().size;
             }
             return result;
         }
@@ -208,7 +251,16 @@ void ConnectionStateTracker::trackBack(Pointer<Command> command) {
             if (trackMessages && command->isMessage()) {
                 Pointer<Message> message = command.dynamicCast<Message>();
                 if (message->getTransactionId() == NULL) {
-                    this->impl->messageCache.currentCacheSize += message->getSize();
+                    // Prefer what the message actually took on the wire, the estimate
+                    // is only used with a WireFormat that doesn't record it.
+                    int size = (int) message->getMarshalledSize();
+                    if (size == 0) {
+                        size = (int) message->getSize();
+                    }
+
+                    synchronized(&this->impl->messageCache) {
+                        this->impl->messageCache.account(message->getMessageId(), size);
+                    }
                 }
             }
         }
@@ -245,14 +297,20 @@ void ConnectionStateTracker::restore(Pointer<transport::Transport> transport) {
         }
 
         // Now we flush messages
-        Pointer<Iterator<Pointer<Command> > > messages(this->impl->messageCache.values().iterator());
-        while (messages->hasNext()) {
-            transport->oneway(messages->next());
+        std::vector<CachedMessage> messages;
+        synchronized(&this->impl->messageCache) {
+            messages = this->impl->messageCache.values().toArray();
+        }
+        for (std::size_t i = 0; i < messages.size(); ++i) {
+            transport->oneway(messages[i].message);
         }
 
-        Pointer<Iterator<Pointer<Command> > > messagePullIter(this->impl->messagePullCache.values().iterator());
-        while (messagePullIter->hasNext()) {
-            transport->oneway(messagePullIter->next());
+        std::vector<Pointer<Command> > messagePulls;
+        synchronized(&this->impl->messagePullCache) {
+            messagePulls = this->impl->messagePullCache.values().toArray();
+        }
+        for (std::size_t i = 0; i < messagePulls.size(); ++i) {
+            transport->oneway(messagePulls[i]);
         }
     }
     AMQ_CATCH_RETHROW(IOException)
@@ -350,24 +408,38 @@ void ConnectionStateTracker::doRestoreConsumers(Pointer<transport::Transport> tr
         // Restore the session's consumers but possibly in pull only (prefetch 0 state) till recovery complete
         Pointer<ConnectionState> connectionState =
             this->impl->connectionStates.get(sessionState->getInfo()->getSessionId()->getParentId());
-        bool connectionInterruptionProcessingComplete = connectionState->isConnectionInterruptProcessingComplete();
+
+        // Whether consumers start in pull mode is the same for the whole session, work
+        // it out once instead of querying the WireFormat for every consumer.
+        bool pullUntilRecovered = false;
+        if (!connectionState->isConnectionInterruptProcessingComplete()) {
+            Pointer<wireformat::WireFormat> wireFormat = transport->getWireFormat();
+            pullUntilRecovered = wireFormat != NULL && wireFormat->getVersion() > 5;
+        }
+
+        StlMap<Pointer<ConsumerId>, Pointer<ConsumerInfo>, ConsumerId::COMPARATOR> recovering;
 
         Pointer<Iterator<Pointer<ConsumerState> > > state(sessionState->getConsumerStates().iterator());
         while (state->hasNext()) {
 
             Pointer<ConsumerInfo> infoToSend = state->next()->getInfo();
-            Pointer<wireformat::WireFormat> wireFormat = transport->getWireFormat();
 
-            if (!connectionInterruptionProcessingComplete && infoToSend->getPrefetchSize() > 0 && wireFormat->getVersion() > 5) {
+            if (pullUntilRecovered && infoToSend->getPrefetchSize() > 0) {
 
                 Pointer<ConsumerInfo> oldInfoToSend = infoToSend;
                 infoToSend.reset(oldInfoToSend->cloneDataStructure());
-                connectionState->getRecoveringPullConsumers().put(infoToSend->getConsumerId(), oldInfoToSend);
+                recovering.put(infoToSend->getConsumerId(), oldInfoToSend);
                 infoToSend->setPrefetchSize(0);
             }
 
             transport->oneway(infoToSend);
         }
+
+        if (!recovering.isEmpty()) {
+            synchronized(&connectionState->getRecoveringPullConsumers()) {
+                connectionState->getRecoveringPullConsumers().putAll(recovering);
+            }
+        }
     }
     AMQ_CATCH_RETHROW(IOException)
     AMQ_CATCH_EXCEPTION_CONVERT(Exception, IOException)
@@ -535,9 +607,15 @@ Pointer<Command> ConnectionStateTracker::processRemoveConsumer(ConsumerId* id) {
                             ss->removeConsumer(consumerId);
                         }
                     }
-                    try {
-                        cs->getRecoveringPullConsumers().remove(consumerId);
-                    } catch (NoSuchElementException e) {}
+                    if (cs != NULL) {
+                        synchronized(&cs->getRecoveringPullConsumers()) {
+                            // Almost every removal is of a consumer that isn't recovering,
+                            // check first rather than paying for the exception.
+                            if (cs->getRecoveringPullConsumers().containsKey(consumerId)) {
+                                cs->getRecoveringPullConsumers().remove(consumerId);
+                            }
+                        }
+                    }
                 }
             }
         }
@@ -649,8 +727,10 @@ Pointer<Command> ConnectionStateTracker::processMessage(Message* message) {
                 }
                 return this->impl->TRACKED_RESPONSE_MARKER;
             } else if (trackMessages) {
-                this->impl->messageCache.put(
-                    message->getMessageId(), Pointer<Message>(message->cloneDataStructure()));
+                Pointer<Message> copy(message->cloneDataStructure());
+                synchronized(&this->impl->messageCache) {
+                    this->impl->messageCache.cache(message->getMessageId(), copy);
+                }
             }
         }
 
@@ -829,7 +909,10 @@ Pointer<Command> ConnectionStateTracker::processMessagePull(MessagePull* pull) {
 
         if (pull != NULL && pull->getDestination() != NULL && pull->getConsumerId() != NULL) {
             std::string id = pull->getDestination()->toString() + "::" + pull->getConsumerId()->toString();
-            this->impl->messagePullCache.put(id, Pointer<Command>(pull->cloneDataStructure()));
+            Pointer<Command> copy(pull->cloneDataStructure());
+            synchronized(&this->impl->messagePullCache) {
+                this->impl->messagePullCache.put(id, copy);
+            }
         }
 
         return Pointer<Command>();
@@ -848,17 +931,20 @@ void ConnectionStateTracker::connectionInterruptProcessingComplete(transport::Tr
 
         connectionState->setConnectionInterruptProcessingComplete(true);
 
-        StlMap<Pointer<ConsumerId>, Pointer<ConsumerInfo>, ConsumerId::COMPARATOR> stalledConsumers = connectionState->getRecoveringPullConsumers();
+        StlMap<Pointer<ConsumerId>, Pointer<ConsumerInfo>, ConsumerId::COMPARATOR> stalledConsumers;
+        synchronized(&connectionState->getRecoveringPullConsumers()) {
+            stalledConsumers.copy(connectionState->getRecoveringPullConsumers());
+        }
 
-        Pointer<Iterator<Pointer<ConsumerId> > > key(stalledConsumers.keySet().iterator());
-        while (key->hasNext()) {
+        Pointer<Iterator<MapEntry<Pointer<ConsumerId>, Pointer<ConsumerInfo> > > > entry(stalledConsumers.entrySet().iterator());
+        while (entry->hasNext()) {
             Pointer<ConsumerControl> control(new ConsumerControl());
 
-            Pointer<ConsumerId> theKey = key->next();
+            MapEntry<Pointer<ConsumerId>, Pointer<ConsumerInfo> > stalled = entry->next();
 
-            control->setConsumerId(theKey);
-            control->setPrefetch(stalledConsumers.get(theKey)->getPrefetchSize());
-            control->setDestination(stalledConsumers.get(theKey)->getDestination());
+            control->setConsumerId(stalled.getKey());
+            control->setPrefetch(stalled.getValue()->getPrefetchSize());
+            control->setDestination(stalled.getValue()->getDestination());
 
             try {
                 transport->oneway(control);
@@ -47,6 +47,9 @@ namespace threads {
 
         decaf::lang::Pointer<decaf::lang::Thread> thread;
 
+        // The task the runner thread is iterating, guarded by the tasks lock.
+        CompositeTask* current;
+
         bool threadTerminated;
         bool pending;
         bool shutdown;
@@ -56,6 +59,7 @@ namespace threads {
         CompositeTaskRunnerImpl() : tasks(),
                                     mutex(),
                                     thread(),
+                                    current(NULL),
                                     threadTerminated(false),
                                     pending(false),
                                     shutdown(false) {
@@ -207,6 +211,13 @@ void CompositeTaskRunner::removeTask(CompositeTask* task) {
     if (task != NULL) {
         synchronized(&impl->tasks) {
             impl->tasks.remove(task);
+
+            // Once removed the task must not be run again, so wait for an iterate that
+            // is in progress unless the task is removing itself from the runner thread.
+            while (impl->current == task && Thread::currentThread() != impl->thread.get()) {
+                impl->tasks.wait();
+            }
+
             wakeup();
         }
     }
@@ -215,23 +226,39 @@ void CompositeTaskRunner::removeTask(CompositeTask* task) {
 ////////////////////////////////////////////////////////////////////////////////
 bool CompositeTaskRunner::iterate() {
 
+    CompositeTask* task = NULL;
+
+    // The next pending task is picked under the lock but run outside of it, a task
+    // that blocks must not stop tasks from being added or removed.
     synchronized(&impl->tasks) {
 
         for (int i = 0; i < impl->tasks.size(); ++i) {
-            CompositeTask* task = impl->tasks.pop();
-
-            if (task->isPending()) {
-                task->iterate();
-                impl->tasks.addLast(task);
+            CompositeTask* candidate = impl->tasks.pop();
+            impl->tasks.addLast(candidate);
 
-                // Always return true, so that we check again for any of
-                // the other tasks that might now be pending.
-                return true;
-            } else {
-                impl->tasks.addLast(task);
+            if (candidate->isPending()) {
+                task = candidate;
+                impl->current = task;
+                break;
             }
         }
     }
 
-    return false;
+    if (task == NULL) {
+        return false;
+    }
+
+    try {
+        task->iterate();
+    }
+    AMQ_CATCHALL_NOTHROW()
+
+    synchronized(&impl->tasks) {
+        impl->current = NULL;
+        impl->tasks.notifyAll();
+    }
+
+    // Always return true, so that we check again for any of
+    // the other tasks that might now be pending.
+    return true;
 }
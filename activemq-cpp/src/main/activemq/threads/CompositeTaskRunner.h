@@ -68,7 +68,8 @@ namespace threads {
         void addTask(CompositeTask* task);
 
         /**
-         * Removes a CompositeTask that was added previously
+         * Removes a CompositeTask that was added previously, if the runner thread is
+         * iterating the task this waits for it to finish.
          * @param task - Pointer to a CompositeTask instance.
          */
         void removeTask(CompositeTask* task);
@@ -0,0 +1,475 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "HashedWheelTimer.h"
+
+#include <activemq/exceptions/ActiveMQException.h>
+
+#include <decaf/lang/System.h>
+#include <decaf/lang/Thread.h>
+#include <decaf/util/concurrent/Mutex.h>
+#include <decaf/lang/exceptions/NullPointerException.h>
+#include <decaf/lang/exceptions/IllegalArgumentException.h>
+#include <decaf/lang/exceptions/IllegalStateException.h>
+
+#include <list>
+#include <map>
+#include <vector>
+
+using namespace std;
+using namespace activemq;
+using namespace activemq::threads;
+using namespace activemq::exceptions;
+using namespace decaf;
+using namespace decaf::lang;
+using namespace decaf::lang::exceptions;
+using namespace decaf::util::concurrent;
+
+////////////////////////////////////////////////////////////////////////////////
+const long long HashedWheelTimer::DEFAULT_TICK_DURATION = 100;
+const int HashedWheelTimer::DEFAULT_TICKS_PER_WHEEL = 512;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace activemq {
+namespace threads {
+
+    class HashedWheelTimerImpl : public decaf::lang::Runnable {
+    private:
+
+        HashedWheelTimerImpl(const HashedWheelTimerImpl&);
+        HashedWheelTimerImpl& operator=(const HashedWheelTimerImpl&);
+
+    public:
+
+        struct Entry {
+            Pointer<Runnable> task;
+            long long nextRunTime;
+            long long period;
+            long long deadline;
+            std::list<Entry*>::iterator position;
+            bool inBucket;
+            bool cancelled;
+
+            Entry(const Pointer<Runnable>& task, long long nextRunTime, long long period) :
+                task(task), nextRunTime(nextRunTime), period(period), deadline(0),
+                position(), inBucket(false), cancelled(false) {
+            }
+        };
+
+        typedef std::list<Entry*> Bucket;
+        typedef std::map<const Runnable*, Entry*> EntryMap;
+
+        std::string name;
+        long long tickDuration;
+        int mask;
+        std::vector<Bucket> wheel;
+        EntryMap entries;
+
+        mutable Mutex mutex;
+        Pointer<Thread> thread;
+        bool shutdown;
+
+        long long startTime;
+        long long lastTick;
+
+        // The task the timer thread is running right now, cancel waits on it.
+        const Runnable* executing;
+
+        long long wakeups;
+        long long executions;
+
+    public:
+
+        HashedWheelTimerImpl(const std::string& name, long long tickDuration, int ticksPerWheel) :
+            name(name), tickDuration(tickDuration), mask(0), wheel(), entries(), mutex(), thread(),
+            shutdown(false), startTime(System::nanoTime()), lastTick(0), executing(NULL),
+            wakeups(0), executions(0) {
+
+            int size = 1;
+            while (size < ticksPerWheel) {
+                size <<= 1;
+            }
+
+            this->mask = size - 1;
+            this->wheel.resize(size);
+        }
+
+        virtual ~HashedWheelTimerImpl() {
+            for (EntryMap::iterator iter = entries.begin(); iter != entries.end(); ++iter) {
+                delete iter->second;
+            }
+        }
+
+        /**
+         * Milliseconds since the timer was created, immune to wall clock changes.
+         */
+        long long now() const {
+            return (System::nanoTime() - startTime) / 1000000;
+        }
+
+        /**
+         * Places the entry in the bucket of the first tick at or after its next run
+         * time, never in the bucket of a tick that has already been processed.
+         */
+        void insert(Entry* entry) {
+            long long tick = (entry->nextRunTime + tickDuration - 1) / tickDuration;
+            entry->deadline = tick > lastTick ? tick : lastTick + 1;
+
+            Bucket& bucket = wheel[(int) (entry->deadline & mask)];
+            entry->position = bucket.insert(bucket.end(), entry);
+            entry->inBucket = true;
+        }
+
+        void unlink(Entry* entry) {
+            if (entry->inBucket) {
+                wheel[(int) (entry->deadline & mask)].erase(entry->position);
+                entry->inBucket = false;
+            }
+        }
+
+        /**
+         * Removes the entry for the task from the map, an entry that is still in a bucket
+         * is destroyed here, otherwise the timer thread owns it and will destroy it once
+         * it sees the cancelled flag.
+         */
+        bool remove(const Runnable* task) {
+
+            EntryMap::iterator iter = entries.find(task);
+            if (iter == entries.end()) {
+                return false;
+            }
+
+            Entry* entry = iter->second;
+            entries.erase(iter);
+
+            entry->cancelled = true;
+            if (entry->inBucket) {
+                unlink(entry);
+                delete entry;
+            }
+
+            return true;
+        }
+
+        void expire(Bucket& bucket, long long tick, std::vector<Entry*>& expired) {
+            Bucket::iterator iter = bucket.begin();
+            while (iter != bucket.end()) {
+                Entry* entry = *iter;
+                if (entry->deadline <= tick) {
+                    iter = bucket.erase(iter);
+                    entry->inBucket = false;
+                    expired.push_back(entry);
+                } else {
+                    ++iter;
+                }
+            }
+        }
+
+        /**
+         * Collects every entry whose deadline falls in the ticks since the last pass.
+         */
+        void expire(long long tick, std::vector<Entry*>& expired) {
+
+            if (tick - lastTick >= (long long) wheel.size()) {
+                for (std::size_t i = 0; i < wheel.size(); ++i) {
+                    expire(wheel[i], tick, expired);
+                }
+            } else {
+                for (long long next = lastTick + 1; next <= tick; ++next) {
+                    expire(wheel[(int) (next & mask)], tick, expired);
+                }
+            }
+
+            lastTick = tick;
+        }
+
+        /**
+         * Time to wait until the next tick whose bucket is not empty, or -1 if there
+         * are no tasks to wait for.
+         */
+        long long nextWaitTime(long long tick) const {
+
+            if (entries.empty()) {
+                return -1;
+            }
+
+            long long target = tick + (long long) wheel.size();
+            for (long long next = tick + 1; next < tick + (long long) wheel.size(); ++next) {
+                if (!wheel[(int) (next & mask)].empty()) {
+                    target = next;
+                    break;
+                }
+            }
+
+            long long waitTime = target * tickDuration - now();
+            return waitTime > 0 ? waitTime : 1;
+        }
+
+        /**
+         * Runs one expired entry and then either reschedules or destroys it.
+         */
+        void execute(Entry* entry) {
+
+            Pointer<Runnable> task;
+
+            synchronized(&mutex) {
+                if (entry->cancelled) {
+                    delete entry;
+                    return;
+                }
+
+                task = entry->task;
+                executing = task.get();
+            }
+
+            try {
+                task->run();
+            } catch (...) {
+            }
+
+            synchronized(&mutex) {
+                executing = NULL;
+                executions++;
+
+                if (!entry->cancelled && entry->period > 0) {
+                    long long current = now();
+                    entry->nextRunTime += entry->period;
+                    if (entry->nextRunTime <= current) {
+                        entry->nextRunTime += ((current - entry->nextRunTime) / entry->period + 1) * entry->period;
+                    }
+                    insert(entry);
+                } else {
+                    if (!entry->cancelled) {
+                        entries.erase(task.get());
+                    }
+                    delete entry;
+                }
+
+                mutex.notifyAll();
+            }
+        }
+
+        virtual void run() {
+
+            try {
+
+                std::vector<Entry*> expired;
+
+                while (true) {
+
+                    synchronized(&mutex) {
+
+                        while (expired.empty()) {
+
+                            if (shutdown) {
+                                return;
+                            }
+
+                            long long tick = now() / tickDuration;
+                            if (tick > lastTick) {
+                                expire(tick, expired);
+                                if (!expired.empty()) {
+                                    break;
+                                }
+                            }
+
+                            long long waitTime = nextWaitTime(tick);
+                            if (waitTime < 0) {
+                                mutex.wait();
+                            } else {
+                                mutex.wait(waitTime);
+                            }
+
+                            wakeups++;
+                        }
+                    }
+
+                    for (std::size_t i = 0; i < expired.size(); ++i) {
+                        execute(expired[i]);
+                    }
+
+                    expired.clear();
+                }
+            }
+            AMQ_CATCHALL_NOTHROW()
+        }
+    };
+
+}}
+
+////////////////////////////////////////////////////////////////////////////////
+HashedWheelTimer::HashedWheelTimer(const std::string& name) :
+    impl(new HashedWheelTimerImpl(name, DEFAULT_TICK_DURATION, DEFAULT_TICKS_PER_WHEEL)) {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+HashedWheelTimer::HashedWheelTimer(const std::string& name, long long tickDuration, int ticksPerWheel) : impl(NULL) {
+
+    if (tickDuration <= 0) {
+        throw IllegalArgumentException(__FILE__, __LINE__, "Tick duration must be positive: %lld", tickDuration);
+    }
+
+    if (ticksPerWheel <= 0 || ticksPerWheel > (1 << 30)) {
+        throw IllegalArgumentException(__FILE__, __LINE__, "Invalid number of ticks per wheel: %d", ticksPerWheel);
+    }
+
+    this->impl = new HashedWheelTimerImpl(name, tickDuration, ticksPerWheel);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+HashedWheelTimer::~HashedWheelTimer() {
+    try {
+        shutdown();
+    }
+    AMQ_CATCHALL_NOTHROW()
+
+    try {
+        delete this->impl;
+    }
+    AMQ_CATCHALL_NOTHROW()
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void HashedWheelTimer::schedule(const Pointer<Runnable>& task, long long delay, long long period) {
+
+    if (task == NULL) {
+        throw NullPointerException(__FILE__, __LINE__, "Task passed was null");
+    }
+
+    if (delay < 0 || period < 0) {
+        throw IllegalArgumentException(__FILE__, __LINE__, "Delay and period must not be negative");
+    }
+
+    synchronized(&impl->mutex) {
+
+        if (impl->shutdown) {
+            throw IllegalStateException(__FILE__, __LINE__, "Timer has been shut down");
+        }
+
+        impl->remove(task.get());
+
+        HashedWheelTimerImpl::Entry* entry = new HashedWheelTimerImpl::Entry(task, impl->now() + delay, period);
+        impl->entries[task.get()] = entry;
+        impl->insert(entry);
+
+        if (impl->thread == NULL) {
+            impl->thread.reset(new Thread(impl, impl->name));
+            impl->thread->start();
+        }
+
+        impl->mutex.notifyAll();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool HashedWheelTimer::cancel(const Runnable* task) {
+
+    bool result = false;
+
+    synchronized(&impl->mutex) {
+
+        result = impl->remove(task);
+
+        if (Thread::currentThread() != impl->thread.get()) {
+            while (impl->executing == task && task != NULL) {
+                impl->mutex.wait();
+            }
+        }
+    }
+
+    return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void HashedWheelTimer::shutdown() {
+
+    Pointer<Thread> thread;
+
+    synchronized(&impl->mutex) {
+
+        if (impl->shutdown) {
+            return;
+        }
+
+        impl->shutdown = true;
+
+        while (!impl->entries.empty()) {
+            impl->remove(impl->entries.begin()->first);
+        }
+
+        thread = impl->thread;
+        impl->mutex.notifyAll();
+    }
+
+    if (thread != NULL && Thread::currentThread() != thread.get()) {
+        thread->join();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long long HashedWheelTimer::getTickDuration() const {
+    return this->impl->tickDuration;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int HashedWheelTimer::getTicksPerWheel() const {
+    return (int) this->impl->wheel.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int HashedWheelTimer::getTaskCount() const {
+
+    int result = 0;
+    synchronized(&impl->mutex) {
+        result = (int) impl->entries.size();
+    }
+
+    return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long long HashedWheelTimer::getWakeupCount() const {
+
+    long long result = 0;
+    synchronized(&impl->mutex) {
+        result = impl->wakeups;
+    }
+
+    return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long long HashedWheelTimer::getExecutionCount() const {
+
+    long long result = 0;
+    synchronized(&impl->mutex) {
+        result = impl->executions;
+    }
+
+    return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool HashedWheelTimer::isThreadAlive() const {
+
+    bool result = false;
+    synchronized(&impl->mutex) {
+        result = impl->thread != NULL && impl->thread->isAlive();
+    }
+
+    return result;
+}
@@ -0,0 +1,170 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_THREADS_HASHEDWHEELTIMER_H_
+#define _ACTIVEMQ_THREADS_HASHEDWHEELTIMER_H_
+
+#include <activemq/util/Config.h>
+
+#include <decaf/lang/Runnable.h>
+#include <decaf/lang/Pointer.h>
+
+#include <string>
+
+namespace activemq {
+namespace threads {
+
+    class HashedWheelTimerImpl;
+
+    /**
+     * A timer that runs any number of coarse grained periodic tasks from a single
+     * thread.  Tasks are hashed into the buckets of a wheel by the tick on which they
+     * next expire, each wakeup of the timer thread only looks at the bucket of the
+     * current tick and the thread sleeps straight through runs of empty buckets, so
+     * the cost of the timer does not grow with the number of scheduled tasks and an
+     * idle timer does not wake up at all.
+     *
+     * Tasks are run on the timer thread and should not block, work that can block
+     * should be handed off to another thread.  Expiry times are rounded up to the
+     * next tick, a periodic task that falls behind skips the runs it missed instead
+     * of running them back to back.
+     *
+     * The thread is created when the first task is scheduled.
+     *
+     * @since 3.10.0
+     */
+    class AMQCPP_API HashedWheelTimer {
+    public:
+
+        /**
+         * The default tick duration in milliseconds.
+         */
+        static const long long DEFAULT_TICK_DURATION;
+
+        /**
+         * The default number of buckets in the wheel.
+         */
+        static const int DEFAULT_TICKS_PER_WHEEL;
+
+    private:
+
+        HashedWheelTimerImpl* impl;
+
+    private:
+
+        HashedWheelTimer(const HashedWheelTimer&);
+        HashedWheelTimer& operator=(const HashedWheelTimer&);
+
+    public:
+
+        /**
+         * Creates a new timer using the default tick duration and wheel size.
+         *
+         * @param name
+         *      The name given to the timer thread.
+         */
+        HashedWheelTimer(const std::string& name);
+
+        /**
+         * Creates a new timer.
+         *
+         * @param name
+         *      The name given to the timer thread.
+         * @param tickDuration
+         *      The resolution of the timer in milliseconds.
+         * @param ticksPerWheel
+         *      The number of buckets in the wheel, rounded up to a power of two.
+         *
+         * @throws IllegalArgumentException if either value is not positive.
+         */
+        HashedWheelTimer(const std::string& name, long long tickDuration, int ticksPerWheel);
+
+        virtual ~HashedWheelTimer();
+
+        /**
+         * Schedules the given task to run after the given delay and then, if the period
+         * is greater than zero, repeatedly at that fixed rate until it is canceled.  A
+         * task can only be scheduled once at a time, scheduling it again replaces the
+         * earlier schedule.
+         *
+         * @param task
+         *      The task to run, the timer holds a reference to it until it is canceled
+         *      or, for a one shot task, until it has run.
+         * @param delay
+         *      The time in milliseconds before the first run.
+         * @param period
+         *      The time in milliseconds between runs, zero for a one shot task.
+         *
+         * @throws NullPointerException if the task is NULL.
+         * @throws IllegalArgumentException if the delay or period is negative.
+         * @throws IllegalStateException if the timer has been shut down.
+         */
+        void schedule(const decaf::lang::Pointer<decaf::lang::Runnable>& task, long long delay, long long period);
+
+        /**
+         * Cancels the given task.  If the task is running on the timer thread this call
+         * waits for it to finish unless it is made from the timer thread itself, once it
+         * returns the task will not be run again.
+         *
+         * @param task
+         *      The task to cancel.
+         *
+         * @return true if the task was scheduled.
+         */
+        bool cancel(const decaf::lang::Runnable* task);
+
+        /**
+         * Cancels all tasks and stops the timer thread, waiting for it to terminate
+         * unless called from the timer thread.  The timer cannot be used afterwards.
+         */
+        void shutdown();
+
+        /**
+         * @return the resolution of the timer in milliseconds.
+         */
+        long long getTickDuration() const;
+
+        /**
+         * @return the number of buckets in the wheel.
+         */
+        int getTicksPerWheel() const;
+
+        /**
+         * @return the number of tasks currently scheduled.
+         */
+        int getTaskCount() const;
+
+        /**
+         * @return the number of times the timer thread has woken up to expire tasks.
+         */
+        long long getWakeupCount() const;
+
+        /**
+         * @return the number of task runs performed so far.
+         */
+        long long getExecutionCount() const;
+
+        /**
+         * @return true if the timer thread has been started and has not yet terminated.
+         */
+        bool isThreadAlive() const;
+
+    };
+
+}}
+
+#endif /* _ACTIVEMQ_THREADS_HASHEDWHEELTIMER_H_ */
@@ -0,0 +1,263 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "PooledTaskRunner.h"
+
+#include <activemq/exceptions/ActiveMQException.h>
+
+#include <decaf/lang/System.h>
+#include <decaf/lang/Thread.h>
+#include <decaf/lang/exceptions/NullPointerException.h>
+#include <decaf/util/concurrent/Mutex.h>
+
+using namespace activemq;
+using namespace activemq::threads;
+using namespace activemq::exceptions;
+using namespace decaf;
+using namespace decaf::lang;
+using namespace decaf::lang::exceptions;
+using namespace decaf::util::concurrent;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace activemq {
+namespace threads {
+
+    /**
+     * The part of the runner the pool queues, it is reference counted so that a runner
+     * deleted by its own Task during an iteration stays valid until the iteration ends.
+     */
+    class PooledTaskRunnerState : public Task {
+    private:
+
+        PooledTaskRunnerState(const PooledTaskRunnerState&);
+        PooledTaskRunnerState& operator=(const PooledTaskRunnerState&);
+
+    public:
+
+        Mutex mutex;
+        Task* task;
+        WorkStealingThreadPool* pool;
+        Thread* running;
+        bool started;
+        bool pending;
+        bool scheduled;
+        bool shutDown;
+
+        PooledTaskRunnerState(Task* task, WorkStealingThreadPool* pool) :
+            Task(), mutex(), task(task), pool(pool), running(NULL), started(false), pending(false), scheduled(false), shutDown(false) {
+        }
+
+        virtual ~PooledTaskRunnerState() {}
+
+        /**
+         * Marks the Task as needing another iteration and returns true if the caller
+         * must queue it because it is neither queued nor running.
+         */
+        bool markPending() {
+
+            synchronized(&mutex) {
+
+                if (shutDown) {
+                    return false;
+                }
+
+                pending = true;
+
+                if (started && !scheduled) {
+                    scheduled = true;
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        /**
+         * Called when the pool could not take the Task.
+         */
+        void unschedule() {
+            synchronized(&mutex) {
+                scheduled = false;
+                mutex.notifyAll();
+            }
+        }
+
+        virtual bool iterate() {
+
+            synchronized(&mutex) {
+
+                // Also the last call from a pool that is dropping this Task, a shutdown
+                // waiting for the Task to leave the pool must be released.
+                if (shutDown || pool->isShutdown()) {
+                    scheduled = false;
+                    mutex.notifyAll();
+                    return false;
+                }
+
+                pending = false;
+                running = Thread::currentThread();
+            }
+
+            bool more = false;
+            try {
+                more = task->iterate();
+            }
+            AMQ_CATCHALL_NOTHROW()
+
+            synchronized(&mutex) {
+
+                running = NULL;
+
+                // Stays scheduled and is queued again by the pool.
+                if (!shutDown && (more || pending)) {
+                    return true;
+                }
+
+                scheduled = false;
+                mutex.notifyAll();
+            }
+
+            return false;
+        }
+    };
+
+}}
+
+////////////////////////////////////////////////////////////////////////////////
+PooledTaskRunner::PooledTaskRunner(Task* task) : pool(NULL), state() {
+
+    if (task == NULL) {
+        throw NullPointerException(__FILE__, __LINE__, "Task passed was null");
+    }
+
+    this->pool = &WorkStealingThreadPool::getInstance();
+    this->state.reset(new PooledTaskRunnerState(task, this->pool));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+PooledTaskRunner::PooledTaskRunner(Task* task, WorkStealingThreadPool* pool) : pool(pool), state() {
+
+    if (task == NULL) {
+        throw NullPointerException(__FILE__, __LINE__, "Task passed was null");
+    }
+
+    if (pool == NULL) {
+        throw NullPointerException(__FILE__, __LINE__, "WorkStealingThreadPool passed was null");
+    }
+
+    this->state.reset(new PooledTaskRunnerState(task, this->pool));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+PooledTaskRunner::~PooledTaskRunner() {
+    try {
+        this->shutdown();
+    }
+    AMQ_CATCHALL_NOTHROW()
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void PooledTaskRunner::start() {
+
+    bool first = false;
+
+    synchronized(&this->state->mutex) {
+        if (!this->state->shutDown && !this->state->started) {
+            this->state->started = true;
+            first = true;
+        }
+    }
+
+    // Runs the task once on start like the other runners do.
+    if (first) {
+        this->wakeup();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool PooledTaskRunner::isStarted() const {
+
+    bool result = false;
+
+    synchronized(&this->state->mutex) {
+        result = this->state->started;
+    }
+
+    return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void PooledTaskRunner::shutdown(long long timeout) {
+
+    synchronized(&this->state->mutex) {
+
+        this->state->shutDown = true;
+
+        // No need to wait if called from the iteration that is running the task.
+        if (this->state->running == Thread::currentThread()) {
+            return;
+        }
+
+        long long deadline = System::currentTimeMillis() + timeout;
+        while (this->state->scheduled) {
+
+            long long remaining = deadline - System::currentTimeMillis();
+            if (remaining <= 0) {
+                break;
+            }
+
+            this->state->mutex.wait(remaining);
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void PooledTaskRunner::shutdown() {
+
+    synchronized(&this->state->mutex) {
+
+        this->state->shutDown = true;
+
+        // No need to wait if called from the iteration that is running the task.
+        if (this->state->running == Thread::currentThread()) {
+            return;
+        }
+
+        while (this->state->scheduled) {
+            this->state->mutex.wait();
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void PooledTaskRunner::wakeup() {
+
+    if (this->state->markPending()) {
+        this->schedule();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void PooledTaskRunner::schedule() {
+
+    try {
+        this->pool->execute(this->state);
+    } catch (...) {
+        this->state->unschedule();
+        throw;
+    }
+}
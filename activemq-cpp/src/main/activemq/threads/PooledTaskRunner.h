@@ -0,0 +1,100 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_THREADS_POOLEDTASKRUNNER_H_
+#define _ACTIVEMQ_THREADS_POOLEDTASKRUNNER_H_
+
+#include <activemq/util/Config.h>
+#include <activemq/threads/TaskRunner.h>
+#include <activemq/threads/Task.h>
+#include <activemq/threads/WorkStealingThreadPool.h>
+
+#include <decaf/lang/Pointer.h>
+
+namespace activemq {
+namespace threads {
+
+    class PooledTaskRunnerState;
+
+    /**
+     * A TaskRunner that runs its Task on the workers of a WorkStealingThreadPool instead
+     * of a thread of its own.  The Task is only ever run by one worker at a time, and
+     * runs one iteration per turn on a worker so that the other Tasks of the pool get
+     * their turns in between, a wakeup that arrives during an iteration makes sure the
+     * Task is run again afterwards.
+     *
+     * Shutting down waits for an iteration in progress to finish, unless it is called
+     * from within that iteration.
+     *
+     * @since 3.10.0
+     */
+    class AMQCPP_API PooledTaskRunner : public TaskRunner {
+    private:
+
+        WorkStealingThreadPool* pool;
+        decaf::lang::Pointer<PooledTaskRunnerState> state;
+
+    private:
+
+        PooledTaskRunner(const PooledTaskRunner&);
+        PooledTaskRunner& operator=(const PooledTaskRunner&);
+
+    public:
+
+        /**
+         * Creates a runner for the Task on the process wide WorkStealingThreadPool.
+         *
+         * @param task
+         *      The Task to run, the caller keeps ownership.
+         *
+         * @throws NullPointerException if the task is NULL.
+         */
+        PooledTaskRunner(Task* task);
+
+        /**
+         * Creates a runner for the Task on the given pool.
+         *
+         * @param task
+         *      The Task to run, the caller keeps ownership.
+         * @param pool
+         *      The pool whose workers run the Task, it must outlive this runner.
+         *
+         * @throws NullPointerException if the task or the pool is NULL.
+         */
+        PooledTaskRunner(Task* task, WorkStealingThreadPool* pool);
+
+        virtual ~PooledTaskRunner();
+
+        virtual void start();
+
+        virtual bool isStarted() const;
+
+        virtual void shutdown(long long timeout);
+
+        virtual void shutdown();
+
+        virtual void wakeup();
+
+    private:
+
+        void schedule();
+
+    };
+
+}}
+
+#endif /* _ACTIVEMQ_THREADS_POOLEDTASKRUNNER_H_ */
@@ -0,0 +1,387 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "WorkStealingThreadPool.h"
+
+#include <activemq/exceptions/ActiveMQException.h>
+
+#include <decaf/lang/Integer.h>
+#include <decaf/lang/Runnable.h>
+#include <decaf/lang/System.h>
+#include <decaf/lang/Thread.h>
+#include <decaf/lang/exceptions/IllegalArgumentException.h>
+#include <decaf/lang/exceptions/IllegalStateException.h>
+#include <decaf/lang/exceptions/NullPointerException.h>
+#include <decaf/util/concurrent/Mutex.h>
+#include <decaf/util/concurrent/atomic/AtomicInteger.h>
+
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+using namespace activemq;
+using namespace activemq::threads;
+using namespace decaf;
+using namespace decaf::lang;
+using namespace decaf::lang::exceptions;
+using namespace decaf::util::concurrent;
+using namespace decaf::util::concurrent::atomic;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    WorkStealingThreadPool* theOnlyInstance = NULL;
+
+    class WorkQueue {
+    private:
+
+        WorkQueue(const WorkQueue&);
+        WorkQueue& operator=(const WorkQueue&);
+
+    public:
+
+        Mutex mutex;
+        std::deque< Pointer<Task> > tasks;
+
+        WorkQueue() : mutex(), tasks() {}
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+namespace activemq {
+namespace threads {
+
+    class WorkStealingThreadPoolImpl {
+    private:
+
+        WorkStealingThreadPoolImpl(const WorkStealingThreadPoolImpl&);
+        WorkStealingThreadPoolImpl& operator=(const WorkStealingThreadPoolImpl&);
+
+    public:
+
+        class Worker : public Runnable {
+        private:
+
+            WorkStealingThreadPoolImpl* pool;
+            int index;
+
+        private:
+
+            Worker(const Worker&);
+            Worker& operator=(const Worker&);
+
+        public:
+
+            Worker(WorkStealingThreadPoolImpl* pool, int index) : Runnable(), pool(pool), index(index) {}
+
+            virtual ~Worker() {}
+
+            virtual void run() {
+                pool->work(index);
+            }
+        };
+
+    public:
+
+        int size;
+        std::vector<WorkQueue*> queues;
+        std::vector<Worker*> workers;
+        std::vector<Thread*> threads;
+
+        // Guards starting and stopping the workers and the idle count, idle workers
+        // wait on it for something to be queued.
+        Mutex mutex;
+        int idle;
+        bool started;
+        volatile bool shutDown;
+
+        // The number of Tasks in all the queues.
+        AtomicInteger queued;
+        AtomicInteger next;
+
+        WorkStealingThreadPoolImpl(int size) :
+            size(size), queues(), workers(), threads(), mutex(), idle(0), started(false), shutDown(false), queued(), next() {
+
+            for (int i = 0; i < size; ++i) {
+                queues.push_back(new WorkQueue());
+            }
+        }
+
+        ~WorkStealingThreadPoolImpl() {
+            for (int i = 0; i < size; ++i) {
+                delete queues[i];
+            }
+        }
+
+        void start() {
+
+            for (int i = 0; i < size; ++i) {
+                workers.push_back(new Worker(this, i));
+                threads.push_back(new Thread(workers[i],
+                    std::string("ActiveMQ Work Stealing Worker: ") + Integer::toString(i + 1)));
+                threads[i]->start();
+            }
+
+            started = true;
+        }
+
+        void stop() {
+
+            synchronized(&mutex) {
+                shutDown = true;
+                mutex.notifyAll();
+            }
+
+            for (std::size_t i = 0; i < threads.size(); ++i) {
+                threads[i]->join();
+                delete threads[i];
+                delete workers[i];
+            }
+
+            threads.clear();
+            workers.clear();
+
+            for (int i = 0; i < size; ++i) {
+                std::deque< Pointer<Task> > dropped;
+                synchronized(&queues[i]->mutex) {
+                    dropped.swap(queues[i]->tasks);
+                }
+
+                for (std::size_t j = 0; j < dropped.size(); ++j) {
+                    drop(dropped[j]);
+                }
+            }
+        }
+
+        /**
+         * A Task the pool will not run again gets one last iteration on the calling
+         * thread, from which it can see that the pool has shut down and release anyone
+         * waiting for it, as PooledTaskRunner does.
+         */
+        void drop(const Pointer<Task>& task) {
+            try {
+                task->iterate();
+            }
+            AMQ_CATCHALL_NOTHROW()
+        }
+
+        /**
+         * Returns the index of the worker running on the calling thread, or -1, must
+         * be called with the mutex held as the workers are started under it.
+         */
+        int currentWorker() const {
+
+            Thread* current = Thread::currentThread();
+            for (std::size_t i = 0; i < threads.size(); ++i) {
+                if (threads[i] == current) {
+                    return (int) i;
+                }
+            }
+
+            return -1;
+        }
+
+        /**
+         * Queues the Task, a Task queued by a worker stays on that worker so that what
+         * a busy worker produces is only moved to another worker when one is idle.
+         */
+        bool push(const Pointer<Task>& task) {
+
+            synchronized(&mutex) {
+
+                if (shutDown) {
+                    return false;
+                }
+
+                if (!started) {
+                    start();
+                }
+
+                int index = currentWorker();
+                if (index == -1) {
+                    index = (int) ((unsigned int) next.getAndIncrement() % (unsigned int) size);
+                }
+
+                synchronized(&queues[index]->mutex) {
+                    queues[index]->tasks.push_back(task);
+                }
+
+                queued.incrementAndGet();
+
+                if (idle > 0) {
+                    mutex.notify();
+                }
+            }
+
+            return true;
+        }
+
+        /**
+         * Takes the next Task from the front of the worker's own queue, or failing that
+         * from the back of another worker's queue.
+         */
+        Pointer<Task> take(int index) {
+
+            Pointer<Task> task;
+
+            synchronized(&queues[index]->mutex) {
+                if (!queues[index]->tasks.empty()) {
+                    task = queues[index]->tasks.front();
+                    queues[index]->tasks.pop_front();
+                }
+            }
+
+            for (int i = 1; i < size && task == NULL; ++i) {
+
+                WorkQueue* victim = queues[(index + i) % size];
+
+                synchronized(&victim->mutex) {
+                    if (!victim->tasks.empty()) {
+                        task = victim->tasks.back();
+                        victim->tasks.pop_back();
+                    }
+                }
+            }
+
+            if (task != NULL) {
+                queued.decrementAndGet();
+            }
+
+            return task;
+        }
+
+        void work(int index) {
+
+            while (!shutDown) {
+
+                Pointer<Task> task = take(index);
+
+                if (task != NULL) {
+
+                    bool again = false;
+                    try {
+                        again = task->iterate();
+                    }
+                    AMQ_CATCHALL_NOTHROW()
+
+                    if (again && !push(task)) {
+                        drop(task);
+                    }
+
+                    continue;
+                }
+
+                synchronized(&mutex) {
+                    // A Task queued before the idle count went up has already been
+                    // counted, so the check and the wait cannot miss it.
+                    idle++;
+                    while (queued.get() == 0 && !shutDown) {
+                        mutex.wait();
+                    }
+                    idle--;
+                }
+            }
+        }
+    };
+
+}}
+
+////////////////////////////////////////////////////////////////////////////////
+WorkStealingThreadPool::WorkStealingThreadPool(int threads) : impl(NULL) {
+
+    if (threads < 1) {
+        throw IllegalArgumentException(__FILE__, __LINE__, "Thread count must be at least one: %d", threads);
+    }
+
+    this->impl = new WorkStealingThreadPoolImpl(threads);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+WorkStealingThreadPool::~WorkStealingThreadPool() {
+    try {
+        this->impl->stop();
+    }
+    AMQ_CATCHALL_NOTHROW()
+
+    try {
+        delete this->impl;
+    }
+    AMQ_CATCHALL_NOTHROW()
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void WorkStealingThreadPool::execute(const Pointer<Task>& task) {
+
+    if (task == NULL) {
+        throw NullPointerException(__FILE__, __LINE__, "Task passed was null");
+    }
+
+    if (!this->impl->push(task)) {
+        throw IllegalStateException(__FILE__, __LINE__, "The WorkStealingThreadPool has been shut down");
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int WorkStealingThreadPool::getThreadCount() const {
+    return this->impl->size;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool WorkStealingThreadPool::isShutdown() const {
+
+    bool result = false;
+
+    synchronized(&this->impl->mutex) {
+        result = this->impl->shutDown;
+    }
+
+    return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool WorkStealingThreadPool::isStarted() const {
+
+    bool result = false;
+
+    synchronized(&this->impl->mutex) {
+        result = this->impl->started;
+    }
+
+    return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+WorkStealingThreadPool& WorkStealingThreadPool::getInstance() {
+
+    if (theOnlyInstance == NULL) {
+        throw IllegalStateException(__FILE__, __LINE__,
+            "The WorkStealingThreadPool is not available, the library has not been initialized.");
+    }
+
+    return *theOnlyInstance;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void WorkStealingThreadPool::initialize() {
+    theOnlyInstance = new WorkStealingThreadPool(std::max(1, System::availableProcessors()));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void WorkStealingThreadPool::shutdown() {
+    delete theOnlyInstance;
+    theOnlyInstance = NULL;
+}
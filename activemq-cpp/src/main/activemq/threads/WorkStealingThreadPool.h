@@ -0,0 +1,128 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_THREADS_WORKSTEALINGTHREADPOOL_H_
+#define _ACTIVEMQ_THREADS_WORKSTEALINGTHREADPOOL_H_
+
+#include <activemq/util/Config.h>
+#include <activemq/threads/Task.h>
+
+#include <decaf/lang/Pointer.h>
+
+namespace activemq {
+namespace library {
+    class ActiveMQCPP;
+}
+namespace threads {
+
+    class WorkStealingThreadPoolImpl;
+
+    /**
+     * A fixed set of worker threads that run Tasks one iteration at a time.  Each worker
+     * has its own queue, a Task queued from a worker stays on that worker's queue and a
+     * worker that runs out of Tasks takes one from the back of another worker's queue
+     * before it goes idle.
+     *
+     * A Task whose iterate method returns true is queued again behind the Tasks already
+     * waiting, so many busy Tasks share the workers fairly.  A Task is never queued
+     * twice by the pool itself, callers that queue a Task must make sure it is not run
+     * by two workers at once, as PooledTaskRunner does.
+     *
+     * The worker threads are started when the first Task is queued.
+     *
+     * @since 3.10.0
+     */
+    class AMQCPP_API WorkStealingThreadPool {
+    private:
+
+        WorkStealingThreadPoolImpl* impl;
+
+    private:
+
+        WorkStealingThreadPool(const WorkStealingThreadPool&);
+        WorkStealingThreadPool& operator=(const WorkStealingThreadPool&);
+
+    public:
+
+        /**
+         * Creates a pool with the given number of workers.
+         *
+         * @param threads
+         *      The number of worker threads, at least one.
+         *
+         * @throws IllegalArgumentException if threads is less than one.
+         */
+        WorkStealingThreadPool(int threads);
+
+        /**
+         * Stops the workers once the iterations in progress are done.  Tasks still queued,
+         * and those wanting to run again when their iteration ends, are not run by the
+         * pool again, each gets one last iterate call on the stopping thread in which
+         * isShutdown returns true.
+         */
+        virtual ~WorkStealingThreadPool();
+
+        /**
+         * Queues the Task to have its iterate method called by one of the workers.
+         *
+         * @param task
+         *      The Task to run, the pool holds a reference to it while it is queued.
+         *
+         * @throws IllegalStateException if the pool has been shut down.
+         */
+        void execute(const decaf::lang::Pointer<Task>& task);
+
+        /**
+         * @return the number of worker threads in this pool.
+         */
+        int getThreadCount() const;
+
+        /**
+         * @return true if the worker threads have been started.
+         */
+        bool isStarted() const;
+
+        /**
+         * @return true once the pool has begun shutting down and accepts no more Tasks.
+         */
+        bool isShutdown() const;
+
+    public:
+
+        /**
+         * Gets the pool shared by all the connections of the process, it has one worker
+         * per available processor and is only valid between the library initialize and
+         * shutdown calls.
+         *
+         * @return the process wide WorkStealingThreadPool.
+         *
+         * @throws IllegalStateException if the library has not been initialized.
+         */
+        static WorkStealingThreadPool& getInstance();
+
+    private:
+
+        static void initialize();
+        static void shutdown();
+
+        friend class activemq::library::ActiveMQCPP;
+
+    };
+
+}}
+
+#endif /* _ACTIVEMQ_THREADS_WORKSTEALINGTHREADPOOL_H_ */
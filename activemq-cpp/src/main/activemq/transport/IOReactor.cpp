@@ -0,0 +1,348 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "IOReactor.h"
+
+#include <activemq/exceptions/ActiveMQException.h>
+
+#include <decaf/internal/net/SocketPoller.h>
+#include <decaf/lang/Integer.h>
+#include <decaf/lang/Pointer.h>
+#include <decaf/lang/Runnable.h>
+#include <decaf/lang/System.h>
+#include <decaf/lang/Thread.h>
+#include <decaf/lang/exceptions/IllegalStateException.h>
+#include <decaf/util/StlMap.h>
+#include <decaf/util/concurrent/Mutex.h>
+
+#include <algorithm>
+#include <vector>
+
+using namespace activemq;
+using namespace activemq::transport;
+using namespace decaf;
+using namespace decaf::internal::net;
+using namespace decaf::io;
+using namespace decaf::lang;
+using namespace decaf::lang::exceptions;
+using namespace decaf::net;
+using namespace decaf::util;
+using namespace decaf::util::concurrent;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    IOReactor* theOnlyInstance;
+
+    const int MAX_LOOPS = 4;
+    const int INITIAL_LOOP_CAPACITY = 1024;
+
+    // Bounds of the wait after a failed poll, doubled for each failure in a row.
+    const long long MIN_POLL_RETRY_DELAY = 10;
+    const long long MAX_POLL_RETRY_DELAY = 1000;
+
+    class EventLoop : public Runnable {
+    private:
+
+        SocketPoller poller;
+        Pointer<Thread> thread;
+        std::string name;
+
+        // Guards the handler map and the handler being notified.
+        Mutex mutex;
+        StlMap<IOReactor::Handler*, Socket*> handlers;
+        IOReactor::Handler* current;
+        volatile bool closed;
+
+    private:
+
+        EventLoop(const EventLoop&);
+        EventLoop& operator=(const EventLoop&);
+
+    public:
+
+        EventLoop(const std::string& name) :
+            Runnable(), poller(INITIAL_LOOP_CAPACITY), thread(), name(name), mutex(), handlers(), current(NULL), closed(false) {
+        }
+
+        virtual ~EventLoop() {}
+
+        void add(Socket* socket, IOReactor::Handler* handler) {
+
+            synchronized(&mutex) {
+
+                if (closed) {
+                    throw IllegalStateException(__FILE__, __LINE__, "The IOReactor has been shut down");
+                }
+
+                // Mapped first so that a notification arriving right away finds it.
+                handlers.put(handler, socket);
+                try {
+                    poller.add(socket, handler);
+                } catch (...) {
+                    handlers.remove(handler);
+                    throw;
+                }
+
+                if (thread == NULL) {
+                    thread.reset(new Thread(this, name));
+                    thread->start();
+                }
+            }
+        }
+
+        bool remove(IOReactor::Handler* handler) {
+
+            bool removed = false;
+
+            synchronized(&mutex) {
+
+                if (handlers.containsKey(handler)) {
+                    poller.remove(handlers.remove(handler));
+                    removed = true;
+                }
+
+                // A handler that removes itself while being notified must not wait.
+                while (current == handler && Thread::currentThread() != thread.get()) {
+                    mutex.wait();
+                }
+            }
+
+            return removed;
+        }
+
+        int size() const {
+            return poller.size();
+        }
+
+        bool isStarted() const {
+            return thread != NULL;
+        }
+
+        void shutdown() {
+
+            synchronized(&mutex) {
+                closed = true;
+                mutex.notifyAll();
+            }
+
+            poller.wakeup();
+
+            if (thread != NULL) {
+                thread->join();
+            }
+        }
+
+        virtual void run() {
+
+            std::vector<void*> ready;
+            long long retryDelay = 0;
+
+            while (!closed) {
+
+                try {
+                    poller.poll(ready, -1);
+                    retryDelay = 0;
+                } catch (Exception& ex) {
+                    // A failed poll leaves the set as it was.  The cause rarely clears at
+                    // once, so back off rather than spin, shutdown still wakes the wait.
+                    retryDelay = std::min(std::max(retryDelay * 2, MIN_POLL_RETRY_DELAY), MAX_POLL_RETRY_DELAY);
+                    synchronized(&mutex) {
+                        if (!closed) {
+                            mutex.wait(retryDelay);
+                        }
+                    }
+                    continue;
+                }
+
+                for (std::size_t i = 0; i < ready.size() && !closed; ++i) {
+                    notify(static_cast<IOReactor::Handler*>(ready[i]));
+                }
+            }
+        }
+
+    private:
+
+        void notify(IOReactor::Handler* handler) {
+
+            bool registered = false;
+
+            synchronized(&mutex) {
+                // Removed since the poll returned.
+                registered = handlers.containsKey(handler);
+                if (registered) {
+                    current = handler;
+                }
+            }
+
+            if (!registered) {
+                return;
+            }
+
+            bool keep = false;
+            try {
+                keep = handler->onReadable();
+            } catch (...) {
+            }
+
+            synchronized(&mutex) {
+
+                current = NULL;
+
+                if (!keep && handlers.containsKey(handler)) {
+                    poller.remove(handlers.remove(handler));
+                }
+
+                mutex.notifyAll();
+            }
+        }
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+namespace activemq {
+namespace transport {
+
+    class IOReactorImpl {
+    private:
+
+        IOReactorImpl(const IOReactorImpl&);
+        IOReactorImpl& operator=(const IOReactorImpl&);
+
+    public:
+
+        std::vector<EventLoop*> loops;
+
+        IOReactorImpl() : loops() {
+
+            int count = std::max(1, std::min(System::availableProcessors(), MAX_LOOPS));
+            for (int i = 0; i < count; ++i) {
+                loops.push_back(new EventLoop(std::string("IOReactor Event Loop: ") + Integer::toString(i + 1)));
+            }
+        }
+
+        ~IOReactorImpl() {
+            for (std::size_t i = 0; i < loops.size(); ++i) {
+                delete loops[i];
+            }
+        }
+    };
+
+}}
+
+////////////////////////////////////////////////////////////////////////////////
+IOReactor::Handler::~Handler() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+IOReactor::IOReactor() : impl(new IOReactorImpl) {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+IOReactor::~IOReactor() {
+    try {
+        for (std::size_t i = 0; i < this->impl->loops.size(); ++i) {
+            this->impl->loops[i]->shutdown();
+        }
+    }
+    AMQ_CATCHALL_NOTHROW()
+
+    try {
+        delete this->impl;
+    }
+    AMQ_CATCHALL_NOTHROW()
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void IOReactor::add(Socket* socket, Handler* handler) {
+
+    try {
+
+        EventLoop* target = this->impl->loops[0];
+        for (std::size_t i = 1; i < this->impl->loops.size(); ++i) {
+            if (this->impl->loops[i]->size() < target->size()) {
+                target = this->impl->loops[i];
+            }
+        }
+
+        target->add(socket, handler);
+    }
+    AMQ_CATCH_RETHROW(IOException)
+    AMQ_CATCH_EXCEPTION_CONVERT(Exception, IOException)
+    AMQ_CATCHALL_THROW(IOException)
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool IOReactor::remove(Handler* handler) {
+
+    bool removed = false;
+
+    // Every loop is asked, one that is notifying the handler is waited on even when
+    // the handler has already asked to be removed.
+    for (std::size_t i = 0; i < this->impl->loops.size(); ++i) {
+        if (this->impl->loops[i]->remove(handler)) {
+            removed = true;
+        }
+    }
+
+    return removed;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int IOReactor::getLoopCount() const {
+    return (int) this->impl->loops.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int IOReactor::getThreadCount() const {
+
+    int count = 0;
+    for (std::size_t i = 0; i < this->impl->loops.size(); ++i) {
+        if (this->impl->loops[i]->isStarted()) {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int IOReactor::getSocketCount() const {
+
+    int count = 0;
+    for (std::size_t i = 0; i < this->impl->loops.size(); ++i) {
+        count += this->impl->loops[i]->size();
+    }
+
+    return count;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+IOReactor& IOReactor::getInstance() {
+    return *theOnlyInstance;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void IOReactor::initialize() {
+    theOnlyInstance = new IOReactor();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void IOReactor::shutdown() {
+    delete theOnlyInstance;
+    theOnlyInstance = NULL;
+}
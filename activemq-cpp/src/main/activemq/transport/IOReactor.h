@@ -0,0 +1,143 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_TRANSPORT_IOREACTOR_H_
+#define _ACTIVEMQ_TRANSPORT_IOREACTOR_H_
+
+#include <activemq/util/Config.h>
+
+#include <decaf/net/Socket.h>
+
+namespace activemq {
+namespace library {
+    class ActiveMQCPP;
+}
+namespace transport {
+
+    class IOReactorImpl;
+
+    /**
+     * Process wide service that reads from the sockets of every transport created with
+     * the transport.useReactor option.  The sockets are spread over a small, fixed
+     * number of event loops, each a thread waiting on a SocketPoller, so a process
+     * holding thousands of mostly idle connections needs a handful of reader threads
+     * instead of one per connection.
+     *
+     * A handler is notified on its loop's thread and shares that thread with the other
+     * sockets of the loop, it must read only what the socket already has and must not
+     * block waiting for more.
+     *
+     * @since 3.10.0
+     */
+    class AMQCPP_API IOReactor {
+    public:
+
+        /**
+         * Receives the notifications for one registered socket.
+         */
+        class AMQCPP_API Handler {
+        public:
+
+            virtual ~Handler();
+
+            /**
+             * Called on a loop thread when the socket has data to read or its connection
+             * has been closed.
+             *
+             * @return true to keep watching the socket, false to have it removed.
+             */
+            virtual bool onReadable() = 0;
+
+        };
+
+    private:
+
+        IOReactorImpl* impl;
+
+    private:
+
+        IOReactor();
+        IOReactor(const IOReactor&);
+        IOReactor& operator=(const IOReactor&);
+
+    public:
+
+        virtual ~IOReactor();
+
+        /**
+         * Starts watching a connected socket on the event loop with the fewest sockets,
+         * the loop's thread is started when its first socket is added.
+         *
+         * @param socket
+         *      The socket to watch, the caller keeps ownership and must remove the
+         *      handler before closing it.
+         * @param handler
+         *      The handler to notify, a handler can watch only one socket.
+         *
+         * @throws IOException if the socket cannot be watched.
+         */
+        void add(decaf::net::Socket* socket, Handler* handler);
+
+        /**
+         * Stops watching the socket of the given handler.  When the handler is being
+         * notified on another thread this waits for it to return, so the handler is not
+         * called again once this returns.
+         *
+         * @param handler
+         *      The handler to remove.
+         *
+         * @return true if the handler was registered.
+         */
+        bool remove(Handler* handler);
+
+        /**
+         * @return the number of event loops sockets are spread over.
+         */
+        int getLoopCount() const;
+
+        /**
+         * @return the number of event loop threads that have been started.
+         */
+        int getThreadCount() const;
+
+        /**
+         * @return the number of sockets being watched.
+         */
+        int getSocketCount() const;
+
+    public:
+
+        /**
+         * Gets the single instance of the reactor, only valid between the library
+         * initialize and shutdown calls.
+         *
+         * @return the process wide IOReactor.
+         */
+        static IOReactor& getInstance();
+
+    private:
+
+        static void initialize();
+        static void shutdown();
+
+        friend class activemq::library::ActiveMQCPP;
+
+    };
+
+}}
+
+#endif /* _ACTIVEMQ_TRANSPORT_IOREACTOR_H_ */
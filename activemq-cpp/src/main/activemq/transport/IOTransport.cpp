@@ -17,13 +17,23 @@
 
 #include "IOTransport.h"
 
+#include <decaf/io/ByteArrayInputStream.h>
+#include <decaf/io/EOFException.h>
 #include <decaf/util/concurrent/Concurrent.h>
+#include <decaf/util/concurrent/Mutex.h>
 #include <decaf/util/concurrent/atomic/AtomicBoolean.h>
+#include <decaf/util/concurrent/atomic/AtomicInteger.h>
+#include <decaf/lang/System.h>
+#include <decaf/lang/Thread.h>
 #include <decaf/lang/exceptions/UnsupportedOperationException.h>
+#include <decaf/net/ssl/SSLSocket.h>
 #include <activemq/wireformat/WireFormat.h>
 #include <activemq/exceptions/ActiveMQException.h>
 #include <activemq/util/Config.h>
+#include <algorithm>
+#include <deque>
 #include <typeinfo>
+#include <vector>
 
 using namespace activemq;
 using namespace activemq::transport;
@@ -34,12 +44,24 @@ using namespace decaf;
 using namespace decaf::io;
 using namespace decaf::lang;
 using namespace decaf::lang::exceptions;
+using namespace decaf::net;
 using namespace decaf::util::concurrent;
 using namespace decaf::util::concurrent::atomic;
 
 ////////////////////////////////////////////////////////////////////////////////
 LOGDECAF_INITIALIZE( logger, IOTransport, "activemq.transport.IOTransport")
 
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    const int INITIAL_READ_BUFFER_SIZE = 8 * 1024;
+
+    // How long the dispatch thread of a reactor read transport waits for more commands
+    // before it exits, a transport that receives nothing holds no thread.
+    const long long DISPATCH_IDLE_TIME = 1000;
+}
+
+////////////////////////////////////////////////////////////////////////////////
 namespace activemq {
 namespace transport {
 
@@ -49,6 +71,27 @@ namespace transport {
         IOTransportImpl(const IOTransportImpl&);
         IOTransportImpl& operator= (const IOTransportImpl&);
 
+        class Dispatcher : public Runnable {
+        private:
+
+            IOTransportImpl* impl;
+
+        private:
+
+            Dispatcher(const Dispatcher&);
+            Dispatcher& operator= (const Dispatcher&);
+
+        public:
+
+            Dispatcher(IOTransportImpl* impl) : Runnable(), impl(impl) {}
+
+            virtual ~Dispatcher() {}
+
+            virtual void run() {
+                this->impl->runDispatch();
+            }
+        };
+
     public:
 
         Pointer<wireformat::WireFormat> wireFormat;
@@ -59,11 +102,365 @@ namespace transport {
         AtomicBoolean closed;
         AtomicBoolean started;
 
-        IOTransportImpl() : wireFormat(), listener(NULL), inputStream(NULL), outputStream(NULL), thread(), closed(false) {
+        // Group commit state, the counters and sizes are guarded by the output stream.
+        bool writeBatchingEnabled;
+        int writeBatchMaxSize;
+        long long writeBatchMaxDelay;
+        Mutex flushLock;
+        Mutex appendMonitor;
+        AtomicInteger appending;
+        AtomicBoolean flushWaiting;
+        long long writesQueued;
+        long long writesFlushed;
+        long long flushedSize;
+
+        // Reactor state, the read buffer is only touched from the reactor callback.
+        bool useReactor;
+        Socket* socket;
+        AtomicBoolean registered;
+        std::vector<unsigned char> readBuffer;
+        int readOffset;
+        int readLimit;
+        ByteArrayInputStream frameIn;
+        DataInputStream frameData;
+
+        // Dispatch state, guarded by the dispatch monitor.  Commands read on a reactor
+        // loop are delivered from a thread of this transport, the listeners may block.
+        Mutex dispatchMonitor;
+        std::deque< Pointer<Command> > dispatchQueue;
+        Pointer<ActiveMQException> dispatchError;
+        Pointer<decaf::lang::Thread> dispatchThread;
+        Pointer<Runnable> dispatcher;
+        bool dispatching;
+
+        IOTransportImpl() : wireFormat(), listener(NULL), inputStream(NULL), outputStream(NULL), thread(), closed(false),
+                            writeBatchingEnabled(false), writeBatchMaxSize(64 * 1024), writeBatchMaxDelay(100),
+                            flushLock(), appendMonitor(), appending(), flushWaiting(false), writesQueued(0), writesFlushed(0), flushedSize(0),
+                            useReactor(false), socket(NULL), registered(false), readBuffer(), readOffset(0), readLimit(0),
+                            frameIn(), frameData(&frameIn), dispatchMonitor(), dispatchQueue(), dispatchError(),
+                            dispatchThread(), dispatcher(), dispatching(false) {
+
+            this->dispatcher.reset(new Dispatcher(this));
         }
 
         IOTransportImpl(const Pointer<WireFormat> wireFormat) :
-            wireFormat(wireFormat), listener(NULL), inputStream(NULL), outputStream(NULL), thread(), closed(false) {
+            wireFormat(wireFormat), listener(NULL), inputStream(NULL), outputStream(NULL), thread(), closed(false),
+            writeBatchingEnabled(false), writeBatchMaxSize(64 * 1024), writeBatchMaxDelay(100),
+            flushLock(), appendMonitor(), appending(), flushWaiting(false), writesQueued(0), writesFlushed(0), flushedSize(0),
+            useReactor(false), socket(NULL), registered(false), readBuffer(), readOffset(0), readLimit(0),
+            frameIn(), frameData(&frameIn), dispatchMonitor(), dispatchQueue(), dispatchError(),
+            dispatchThread(), dispatcher(), dispatching(false) {
+
+            this->dispatcher.reset(new Dispatcher(this));
+        }
+
+        /**
+         * Reads everything the input stream can return without blocking into the read
+         * buffer.  The stream is drained and not just read once, bytes left in a buffered
+         * stream would not wake the reactor again.
+         */
+        void readAvailable() {
+
+            int count = this->inputStream->available();
+
+            // Readable with nothing available means the peer closed the connection, the
+            // read returns -1 straight away.  SSL sockets are never on the reactor, a
+            // partly arrived record would make this read block the whole loop.
+            if (count == 0) {
+                count = std::max((int) this->readBuffer.size() - this->readLimit, INITIAL_READ_BUFFER_SIZE);
+            }
+
+            while (count > 0) {
+
+                if ((int) this->readBuffer.size() < this->readLimit + count) {
+                    this->readBuffer.resize(std::max(this->readLimit + count, (int) this->readBuffer.size() * 2));
+                }
+
+                int read = this->inputStream->read(
+                    &this->readBuffer[0], (int) this->readBuffer.size(), this->readLimit, count);
+                if (read == -1) {
+                    throw EOFException(__FILE__, __LINE__, "IOTransport - the connection was closed by the peer");
+                }
+
+                this->readLimit += read;
+                count = this->inputStream->available();
+            }
+        }
+
+        /**
+         * Unmarshals the next whole frame in the read buffer, returns NULL when the rest
+         * of the buffer does not hold a whole frame.
+         */
+        Pointer<Command> nextFrame(const Transport* transport) {
+
+            int remaining = this->readLimit - this->readOffset;
+            if (remaining == 0) {
+                return Pointer<Command>();
+            }
+
+            int length = this->wireFormat->getFrameLength(&this->readBuffer[this->readOffset], remaining);
+            if (length < 0) {
+                throw IOException(__FILE__, __LINE__, "IOTransport - the wire format frames can no longer be measured");
+            }
+
+            if (length == 0 || length > remaining) {
+                return Pointer<Command>();
+            }
+
+            this->frameIn.setByteArray(&this->readBuffer[0], this->readLimit, this->readOffset, length);
+            this->readOffset += length;
+
+            return this->wireFormat->unmarshal(transport, &this->frameData);
+        }
+
+        /**
+         * Moves the start of a partly received frame to the front of the read buffer.
+         */
+        void compact() {
+
+            int remaining = this->readLimit - this->readOffset;
+            if (remaining > 0 && this->readOffset > 0) {
+                std::copy(this->readBuffer.begin() + this->readOffset,
+                          this->readBuffer.begin() + this->readLimit, this->readBuffer.begin());
+            }
+
+            this->readOffset = 0;
+            this->readLimit = remaining;
+        }
+
+        /**
+         * Notifies the command listener, unless the transport has been closed while the
+         * command was waiting to be delivered.
+         */
+        void deliver(const Pointer<Command> command) {
+
+            try {
+
+                // If we have been closed then we don't deliver any messages that
+                // might have sneaked in while we where closing.
+                if (this->listener == NULL || this->closed.get()) {
+                    return;
+                }
+
+                this->listener->onCommand(command);
+            }
+            AMQ_CATCHALL_NOTHROW()
+        }
+
+        /**
+         * Notifies the exception listener, unless the transport is stopped or closed.
+         */
+        void deliver(decaf::lang::Exception& ex) {
+
+            if (this->listener != NULL && this->started.get() && !this->closed.get()) {
+                try {
+                    this->listener->onException(ex);
+                } catch (...) {
+                }
+            }
+        }
+
+        /**
+         * Queues a command read on a reactor loop for the dispatch thread, which is
+         * started here when it has exited or was never started.
+         */
+        void dispatch(const Pointer<Command> command) {
+            synchronized(&this->dispatchMonitor) {
+                this->dispatchQueue.push_back(command);
+                this->wakeDispatcher();
+            }
+        }
+
+        /**
+         * Hands the error that ended the reads to the dispatch thread, it is delivered
+         * after the commands read before it.
+         */
+        void dispatch(decaf::lang::Exception& ex) {
+            synchronized(&this->dispatchMonitor) {
+                this->dispatchError.reset(new ActiveMQException(ex));
+                this->wakeDispatcher();
+            }
+        }
+
+        /**
+         * Must be called with the dispatch monitor held.
+         */
+        void wakeDispatcher() {
+
+            if (this->dispatching) {
+                this->dispatchMonitor.notifyAll();
+                return;
+            }
+
+            // The previous thread no longer takes the monitor once it has given up
+            // dispatching, it is only returning from run.
+            if (this->dispatchThread != NULL) {
+                this->dispatchThread->join();
+            }
+
+            this->dispatchThread.reset(new Thread(this->dispatcher.get(), "IOTransport dispatch Thread"));
+            this->dispatchThread->start();
+            this->dispatching = true;
+        }
+
+        /**
+         * Runs on the dispatch thread, delivers what was queued until the transport is
+         * closed or nothing has been queued for the idle time.
+         */
+        void runDispatch() {
+
+            while (true) {
+
+                Pointer<Command> command;
+                Pointer<ActiveMQException> error;
+
+                synchronized(&this->dispatchMonitor) {
+
+                    long long deadline = System::currentTimeMillis() + DISPATCH_IDLE_TIME;
+                    while (this->dispatchQueue.empty() && this->dispatchError == NULL && !this->closed.get()) {
+                        long long remaining = deadline - System::currentTimeMillis();
+                        if (remaining <= 0) {
+                            break;
+                        }
+                        this->dispatchMonitor.wait(remaining);
+                    }
+
+                    if (this->closed.get()) {
+                        this->dispatchQueue.clear();
+                    }
+
+                    if (!this->dispatchQueue.empty()) {
+                        command = this->dispatchQueue.front();
+                        this->dispatchQueue.pop_front();
+                    } else if (this->dispatchError != NULL && !this->closed.get()) {
+                        error.swap(this->dispatchError);
+                    } else {
+                        this->dispatching = false;
+                        return;
+                    }
+                }
+
+                if (command != NULL) {
+                    this->deliver(command);
+                } else {
+                    this->deliver(*error);
+                }
+            }
+        }
+
+        /**
+         * Wakes the dispatch thread so it sees that the transport is closed and waits for
+         * it to exit, unless called from a listener on that thread.
+         */
+        void stopDispatch() {
+
+            Pointer<Thread> thread;
+            synchronized(&this->dispatchMonitor) {
+                this->dispatchMonitor.notifyAll();
+                thread = this->dispatchThread;
+            }
+
+            if (thread != NULL && thread.get() != Thread::currentThread()) {
+                thread->join();
+            }
+        }
+
+        /**
+         * Flushes everything written so far, must be called with the output stream locked.
+         */
+        void flushBatch() {
+            this->outputStream->flush();
+            this->writesFlushed = this->writesQueued;
+            this->flushedSize = this->outputStream->size();
+        }
+
+        /**
+         * Appends the command to the pending batch and returns its ticket, the batch is
+         * flushed here if it has grown past the maximum size.
+         */
+        long long append(const Pointer<Command> command, const Transport* transport) {
+
+            long long ticket = 0;
+
+            this->appending.incrementAndGet();
+            try {
+                synchronized(this->outputStream) {
+                    this->wireFormat->marshal(command, transport, this->outputStream);
+                    ticket = ++this->writesQueued;
+
+                    if (this->outputStream->size() - this->flushedSize >= this->writeBatchMaxSize) {
+                        this->flushBatch();
+                    }
+                }
+            } catch (...) {
+                this->appended();
+                throw;
+            }
+            this->appended();
+
+            return ticket;
+        }
+
+        /**
+         * Called once a sender is done marshaling, wakes the flushing sender when it is
+         * waiting on the last sender still appending.  The monitor is only taken when
+         * someone waits on it so senders without contention never lock it.
+         */
+        void appended() {
+            if (this->appending.decrementAndGet() == 0 && this->flushWaiting.get()) {
+                synchronized(&this->appendMonitor) {
+                    this->appendMonitor.notifyAll();
+                }
+            }
+        }
+
+        /**
+         * Waits until no sender is marshaling or the batch delay has passed, must be
+         * called with the flush lock held so there is only ever one waiter.
+         */
+        void awaitAppending() {
+
+            synchronized(&this->appendMonitor) {
+                this->flushWaiting.set(true);
+
+                long long deadline = System::nanoTime() + this->writeBatchMaxDelay * 1000;
+                long long remaining = this->writeBatchMaxDelay * 1000;
+                while (this->appending.get() > 0 && remaining > 0) {
+                    this->appendMonitor.wait(remaining / 1000000, (int) (remaining % 1000000));
+                    remaining = deadline - System::nanoTime();
+                }
+
+                this->flushWaiting.set(false);
+            }
+        }
+
+        /**
+         * Makes sure the write with the given ticket has been flushed.  Only one sender
+         * flushes at a time, the others wait their turn and usually find that their
+         * command went out in the batch of the sender ahead of them.
+         */
+        void commit(long long ticket) {
+
+            synchronized(&this->flushLock) {
+
+                synchronized(this->outputStream) {
+                    if (this->writesFlushed >= ticket) {
+                        return;
+                    }
+                }
+
+                // Senders that are still marshaling get a short window to join this batch,
+                // with no one else sending there is nothing to wait for.
+                if (this->writeBatchMaxDelay > 0 && this->appending.get() > 0) {
+                    this->awaitAppending();
+                }
+
+                synchronized(this->outputStream) {
+                    if (this->writesFlushed < ticket) {
+                        this->flushBatch();
+                    }
+                }
+            }
         }
     };
 
@@ -93,28 +490,24 @@ IOTransport::~IOTransport() {
 ////////////////////////////////////////////////////////////////////////////////
 void IOTransport::fire(decaf::lang::Exception& ex) {
 
-    if (this->impl->listener != NULL && this->impl->started.get() && !this->impl->closed.get()) {
-        try {
-            this->impl->listener->onException(ex);
-        } catch (...) {
-        }
+    // On a reactor loop the error goes after the commands still waiting for delivery.
+    if (this->impl->registered.get()) {
+        this->impl->dispatch(ex);
+    } else {
+        this->impl->deliver(ex);
     }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 void IOTransport::fire(const Pointer<Command> command) {
 
-    try {
-
-        // If we have been closed then we don't deliver any messages that
-        // might have sneaked in while we where closing.
-        if (this->impl->listener == NULL || this->impl->closed.get()) {
-            return;
-        }
-
-        this->impl->listener->onCommand(command);
+    // The listeners can block, waiting out a failover or running a MessageListener,
+    // which must not hold up the other sockets of the reactor loop.
+    if (this->impl->registered.get()) {
+        this->impl->dispatch(command);
+    } else {
+        this->impl->deliver(command);
     }
-    AMQ_CATCHALL_NOTHROW()
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -126,8 +519,8 @@ void IOTransport::oneway(const Pointer<Command> command) {
             throw IOException(__FILE__, __LINE__, "IOTransport::oneway() - transport is closed!");
         }
 
-        // Make sure the thread has been started.
-        if (impl->thread == NULL) {
+        // Make sure the thread has been started or the reactor is reading for us.
+        if (impl->thread == NULL && !impl->registered.get()) {
             throw IOException(__FILE__, __LINE__, "IOTransport::oneway() - transport is not started");
         }
 
@@ -141,6 +534,11 @@ void IOTransport::oneway(const Pointer<Command> command) {
             throw IOException(__FILE__, __LINE__, "IOTransport::oneway() - invalid output stream");
         }
 
+        if (impl->writeBatchingEnabled) {
+            this->impl->commit(this->impl->append(command, this));
+            return;
+        }
+
         synchronized(impl->outputStream) {
             // Write the command to the output stream.
             this->impl->wireFormat->marshal(command, this, this->impl->outputStream);
@@ -169,6 +567,21 @@ void IOTransport::start() {
                         "IO streams and wireFormat instances must be set before calling start");
             }
 
+            // The reactor needs to know where each frame ends before reading it, for the
+            // negotiated format too, and must never block in a read, which an SSL socket
+            // can do while a record is partly received.  Anything else gets a thread.
+            if (impl->useReactor && impl->socket != NULL && impl->wireFormat->hasFrameLength() &&
+                dynamic_cast<decaf::net::ssl::SSLSocket*>(impl->socket) == NULL) {
+                impl->registered.set(true);
+                try {
+                    IOReactor::getInstance().add(impl->socket, this);
+                } catch (...) {
+                    impl->registered.set(false);
+                    throw;
+                }
+                return;
+            }
+
             // Start the polling thread.
             impl->thread.reset(new Thread(this, "IOTransport reader Thread"));
             impl->thread->start();
@@ -184,6 +597,11 @@ void IOTransport::stop() {
 
     try {
         this->impl->started.set(false);
+
+        // The socket may be closed once this returns, it has to leave the reactor first.
+        if (this->impl->registered.get()) {
+            IOReactor::getInstance().remove(this);
+        }
     }
     AMQ_CATCH_RETHROW(IOException)
     AMQ_CATCH_EXCEPTION_CONVERT(Exception, IOException)
@@ -218,6 +636,13 @@ void IOTransport::close() {
 
             Finalizer finalize(impl->thread);
 
+            // Stop the reactor calling back before the streams go away, this waits for a
+            // callback in progress on another thread.
+            if (impl->registered.get()) {
+                IOReactor::getInstance().remove(this);
+                impl->stopDispatch();
+            }
+
             // No need to fire anymore async events now.
             this->impl->listener = NULL;
 
@@ -287,6 +712,48 @@ void IOTransport::run() {
     }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+bool IOTransport::onReadable() {
+
+    try {
+
+        // Stopped the same way as the polling thread, which exits on its next read.
+        if (!this->impl->started.get() || this->impl->closed.get()) {
+            return false;
+        }
+
+        this->impl->readAvailable();
+
+        while (!this->impl->closed.get()) {
+
+            Pointer<Command> command = this->impl->nextFrame(this);
+            if (command == NULL) {
+                break;
+            }
+
+            fire(command);
+        }
+
+        this->impl->compact();
+
+        return !this->impl->closed.get();
+
+    } catch (exceptions::ActiveMQException& ex) {
+        ex.setMark(__FILE__, __LINE__);
+        fire(ex);
+    } catch (decaf::lang::Exception& ex) {
+        exceptions::ActiveMQException exl(ex);
+        exl.setMark(__FILE__, __LINE__);
+        fire(exl);
+    } catch (...) {
+        exceptions::ActiveMQException ex(__FILE__, __LINE__, "IOTransport::onReadable - caught unknown exception");
+        LOGDECAF_WARN(logger, ex.getStackTraceString());
+        fire(ex);
+    }
+
+    return false;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 Pointer<FutureResponse> IOTransport::asyncRequest(const Pointer<Command> command AMQCPP_UNUSED,
                                                   const Pointer<ResponseCallback> responseCallback AMQCPP_UNUSED) {
@@ -316,6 +783,51 @@ void IOTransport::setOutputStream(decaf::io::DataOutputStream* os) {
     this->impl->outputStream = os;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+bool IOTransport::isWriteBatchingEnabled() const {
+    return this->impl->writeBatchingEnabled;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void IOTransport::setWriteBatchingEnabled(bool value) {
+    this->impl->writeBatchingEnabled = value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int IOTransport::getWriteBatchMaxSize() const {
+    return this->impl->writeBatchMaxSize;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void IOTransport::setWriteBatchMaxSize(int value) {
+    this->impl->writeBatchMaxSize = value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long long IOTransport::getWriteBatchMaxDelay() const {
+    return this->impl->writeBatchMaxDelay;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void IOTransport::setWriteBatchMaxDelay(long long value) {
+    this->impl->writeBatchMaxDelay = value;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void IOTransport::setSocket(Socket* socket) {
+    this->impl->socket = socket;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool IOTransport::isUseReactor() const {
+    return this->impl->useReactor;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void IOTransport::setUseReactor(bool value) {
+    this->impl->useReactor = value;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 Pointer<wireformat::WireFormat> IOTransport::getWireFormat() const {
     return this->impl->wireFormat;
@@ -23,12 +23,14 @@
 #include <activemq/transport/TransportListener.h>
 #include <activemq/commands/Command.h>
 #include <activemq/commands/Response.h>
+#include <activemq/transport/IOReactor.h>
 #include <activemq/wireformat/WireFormat.h>
 
 #include <decaf/lang/Runnable.h>
 #include <decaf/lang/Thread.h>
 #include <decaf/io/DataInputStream.h>
 #include <decaf/io/DataOutputStream.h>
+#include <decaf/net/Socket.h>
 #include <decaf/util/logging/LoggerDefines.h>
 
 namespace activemq {
@@ -54,9 +56,18 @@ namespace transport {
      * The close method will close the associated
      * streams.  Close can be called explicitly by the user, but is also called in the
      * destructor.  Once this object has been closed, it cannot be restarted.
+     *
+     * When the reactor is enabled and the socket behind the input stream has been set,
+     * no thread of its own is started, the socket is instead watched by the shared
+     * IOReactor and the commands are read on one of its threads.  Only wire formats
+     * whose frames start with their length can be read this way, others fall back to
+     * the polling thread.  The commands read are delivered in order from a dispatch
+     * thread of the transport, so a listener that blocks does not stall the other
+     * sockets of the reactor, the thread exits again when nothing arrives for a while.
      */
     class AMQCPP_API IOTransport : public Transport,
-                                   public decaf::lang::Runnable {
+                                   public decaf::lang::Runnable,
+                                   public IOReactor::Handler {
 
         LOGDECAF_DECLARE(logger)
 
@@ -121,6 +132,76 @@ namespace transport {
          */
         virtual void setOutputStream(decaf::io::DataOutputStream* os);
 
+        /**
+         * @return true if concurrent calls to oneway share output stream flushes.
+         */
+        bool isWriteBatchingEnabled() const;
+
+        /**
+         * Enables group commit of writes.  When enabled a sender that finds other
+         * senders still marshaling their commands lets them add to the pending batch
+         * before flushing, and a sender whose command was already flushed along with
+         * someone else's batch returns without flushing at all.  A lone sender still
+         * flushes right away.
+         *
+         * @param value
+         *      True to batch flushes of concurrently sent commands.
+         */
+        void setWriteBatchingEnabled(bool value);
+
+        /**
+         * @return the number of unflushed bytes at which a batch is flushed immediately.
+         */
+        int getWriteBatchMaxSize() const;
+
+        /**
+         * Sets the number of unflushed bytes at which a batch is written out right
+         * away without waiting for other senders, only used when write batching is on.
+         *
+         * @param value
+         *      The maximum size in bytes of a batch of writes.
+         */
+        void setWriteBatchMaxSize(int value);
+
+        /**
+         * @return the longest time in microseconds a flush waits for other senders.
+         */
+        long long getWriteBatchMaxDelay() const;
+
+        /**
+         * Sets the longest time in microseconds that the sender about to flush will wait
+         * for other senders that are still marshaling, only used when write batching is
+         * on.  Zero means flush straight away with whatever has been written so far.
+         *
+         * @param value
+         *      The maximum delay in microseconds added to a flush.
+         */
+        void setWriteBatchMaxDelay(long long value);
+
+        /**
+         * Sets the socket the input stream reads from, the reactor needs it to know
+         * when there is something to read.
+         *
+         * @param socket
+         *      The connected socket, owned by the caller.
+         */
+        void setSocket(decaf::net::Socket* socket);
+
+        /**
+         * @return true if the shared IOReactor reads the commands instead of a thread.
+         */
+        bool isUseReactor() const;
+
+        /**
+         * Sets whether the commands are read by the shared IOReactor instead of a thread
+         * dedicated to this transport, must be set before the transport is started.  SSL
+         * sockets and wire formats whose frames cannot be measured still use a thread.
+         *
+         * @param value
+         *      True to read from the shared IOReactor.
+         */
+        void setUseReactor(bool value);
+
     public:  // Transport methods
 
         virtual void oneway(const Pointer<Command> command);
@@ -204,6 +285,17 @@ namespace transport {
 
         virtual void run();
 
+    public:  // IOReactor::Handler methods
+
+        /**
+         * Reads what the socket has without blocking for more and queues each whole
+         * command received for the dispatch thread, a partly received command is kept
+         * for the next call.
+         *
+         * {@inheritDoc}
+         */
+        virtual bool onReadable();
+
     };
 
 }}
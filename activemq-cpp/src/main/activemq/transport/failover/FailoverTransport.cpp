@@ -34,6 +34,7 @@
 #include <decaf/util/StlMap.h>
 #include <decaf/util/concurrent/TimeUnit.h>
 #include <decaf/util/concurrent/Mutex.h>
+#include <decaf/util/concurrent/locks/ReentrantReadWriteLock.h>
 #include <decaf/lang/System.h>
 #include <decaf/lang/Integer.h>
 
@@ -50,6 +51,7 @@ using namespace decaf::io;
 using namespace decaf::net;
 using namespace decaf::util;
 using namespace decaf::util::concurrent;
+using namespace decaf::util::concurrent::locks;
 using namespace decaf::lang;
 using namespace decaf::lang::exceptions;
 
@@ -103,6 +105,10 @@ namespace failover {
         mutable Mutex sleepMutex;
         mutable Mutex listenerMutex;
 
+        // Senders hold the read lock while they use the connected transport, it is only
+        // replaced while holding the write lock and the reconnect mutex.
+        ReentrantReadWriteLock transportLock;
+
         StlMap<int, Pointer<Command> > requestMap;
 
         Pointer<URIPool> uris;
@@ -150,6 +156,7 @@ namespace failover {
             reconnectMutex(),
             sleepMutex(),
             listenerMutex(),
+            transportLock(),
             requestMap(),
             uris(new URIPool()),
             priorityUris(new URIPool()),
@@ -254,9 +261,33 @@ namespace failover {
             return connectedTransport != NULL && !doRebalance && !backups->isPriorityBackupAvailable();
         }
 
+        /**
+         * Swaps the given transport with the connected one once no sender is still
+         * using it.  This must be called with the reconnect mutex locked.
+         */
+        void swapConnectedTransport(Pointer<Transport>& transport) {
+            transportLock.writeLock().lock();
+            transport.swap(this->connectedTransport);
+            transportLock.writeLock().unlock();
+        }
+
+        /**
+         * Holds a request in the request map so that it can be replayed on reconnect
+         * if the state tracker is not keeping it.
+         */
+        void trackRequest(const Pointer<Command>& command, const Pointer<Tracked>& tracked) {
+            synchronized(&requestMap) {
+                if (tracked != NULL && tracked->isWaitingForResponse()) {
+                    requestMap.put(command->getCommandId(), tracked);
+                } else if (tracked == NULL && command->isResponseRequired()) {
+                    requestMap.put(command->getCommandId(), command);
+                }
+            }
+        }
+
         void disconnect() {
             Pointer<Transport> transport;
-            transport.swap(this->connectedTransport);
+            swapConnectedTransport(transport);
 
             if (transport != NULL) {
 
@@ -399,6 +430,15 @@ void FailoverTransport::oneway(const Pointer<Command> command) {
 
     Pointer<Exception> error;
 
+    // Once connected commands are sent without touching the reconnect mutex, it is
+    // only needed while the transport is gone or after a send has failed.
+    if (command != NULL && this->onewayConnected(command, error)) {
+        if (!this->impl->closed && error != NULL) {
+            throw IOException(*error);
+        }
+        return;
+    }
+
     try {
 
         synchronized(&this->impl->reconnectMutex) {
@@ -447,13 +487,20 @@ void FailoverTransport::oneway(const Pointer<Command> command) {
                     while (transport == NULL && !this->impl->closed &&
                            this->impl->connectionFailure == NULL && this->impl->willReconnect()) {
 
-                        long long end = System::currentTimeMillis();
-                        if (command->isMessage() && this->impl->timeout > 0 && (end - start > this->impl->timeout)) {
-                            timedout = true;
-                            break;
+                        // The reconnect task notifies once it has connected, closed or
+                        // given up so there is no need to poll for the transport.
+                        if (command->isMessage() && this->impl->timeout > 0) {
+                            long long remaining = this->impl->timeout - (System::currentTimeMillis() - start);
+                            if (remaining < 0) {
+                                timedout = true;
+                                break;
+                            }
+
+                            this->impl->reconnectMutex.wait(remaining > 0 ? remaining : 1);
+                        } else {
+                            this->impl->reconnectMutex.wait();
                         }
 
-                        this->impl->reconnectMutex.wait(100);
                         transport = this->impl->connectedTransport;
                     }
 
@@ -482,13 +529,7 @@ void FailoverTransport::oneway(const Pointer<Command> command) {
                     Pointer<Tracked> tracked;
                     try {
                         tracked = stateTracker.track(command);
-                        synchronized(&this->impl->requestMap) {
-                            if (tracked != NULL && tracked->isWaitingForResponse()) {
-                                this->impl->requestMap.put(command->getCommandId(), tracked);
-                            } else if (tracked == NULL && command->isResponseRequired()) {
-                                this->impl->requestMap.put(command->getCommandId(), command);
-                            }
-                        }
+                        this->impl->trackRequest(command, tracked);
                     } catch (Exception& ex) {
                         ex.setMark(__FILE__, __LINE__);
                         error.reset(ex.clone());
@@ -544,6 +585,79 @@ void FailoverTransport::oneway(const Pointer<Command> command) {
     }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+bool FailoverTransport::onewayConnected(const Pointer<Command>& command, Pointer<Exception>& error) {
+
+    Pointer<Tracked> tracked;
+    bool tracking = true;
+
+    this->impl->transportLock.readLock().lock();
+    try {
+
+        Pointer<Transport> transport = this->impl->connectedTransport;
+        if (transport == NULL || this->impl->closed) {
+            this->impl->transportLock.readLock().unlock();
+            return false;
+        }
+
+        // If it was a request and it was not being tracked by the state tracker,
+        // then hold it in the requestMap so that we can replay it later.
+        tracked = stateTracker.track(command);
+        this->impl->trackRequest(command, tracked);
+        tracking = false;
+
+        transport->oneway(command);
+        stateTracker.trackBack(command);
+        if (command->isShutdownInfo()) {
+            this->impl->shutdown = true;
+        }
+
+        this->impl->transportLock.readLock().unlock();
+        return true;
+
+    } catch (InterruptedException& ex) {
+        this->impl->transportLock.readLock().unlock();
+        Thread::currentThread()->interrupt();
+        throw InterruptedIOException(__FILE__, __LINE__, "FailoverTransport oneway() interrupted");
+    } catch (IOException& e) {
+        this->impl->transportLock.readLock().unlock();
+        e.setMark(__FILE__, __LINE__);
+
+        if (tracking) {
+            error.reset(e.clone());
+            return true;
+        }
+
+        // The failure is handled only after the read lock is released since
+        // swapping out the failed transport needs the write lock.
+        if (tracked == NULL && this->impl->canReconnect()) {
+
+            // The command is retried on the reconnect path, take it out of the
+            // request map so that it is not sent 2 times on recovery
+            if (command->isResponseRequired()) {
+                synchronized(&this->impl->requestMap) {
+                    this->impl->requestMap.remove(command->getCommandId());
+                }
+            }
+
+            handleTransportFailure(e);
+            return false;
+        }
+
+        // Trigger the reconnect since we can't count on inactivity or
+        // other socket events to trip the failover condition.
+        handleTransportFailure(e);
+        return true;
+    } catch (Exception& ex) {
+        this->impl->transportLock.readLock().unlock();
+        if (tracking) {
+            ex.setMark(__FILE__, __LINE__);
+            error.reset(ex.clone());
+        }
+        return true;
+    }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 Pointer<FutureResponse> FailoverTransport::asyncRequest(const Pointer<Command> command AMQCPP_UNUSED,
                                                         const Pointer<ResponseCallback> responseCallback AMQCPP_UNUSED) {
@@ -584,7 +698,15 @@ void FailoverTransport::start() {
             stateTracker.setTrackTransactionProducers(this->isTrackTransactionProducers());
 
             if (this->impl->connectedTransport != NULL) {
-                stateTracker.restore(this->impl->connectedTransport);
+                // Nothing may be sent on the transport while its state is replayed.
+                this->impl->transportLock.writeLock().lock();
+                try {
+                    stateTracker.restore(this->impl->connectedTransport);
+                    this->impl->transportLock.writeLock().unlock();
+                } catch (Exception& ex) {
+                    this->impl->transportLock.writeLock().unlock();
+                    throw;
+                }
             } else {
                 reconnect(false);
             }
@@ -629,9 +751,7 @@ void FailoverTransport::close() {
             this->impl->backups->setEnabled(false);
             this->impl->requestMap.clear();
 
-            if (this->impl->connectedTransport != NULL) {
-                transportToStop.swap(this->impl->connectedTransport);
-            }
+            this->impl->swapConnectedTransport(transportToStop);
 
             this->impl->reconnectMutex.notifyAll();
         }
@@ -719,7 +839,7 @@ void FailoverTransport::handleTransportFailure(const decaf::lang::Exception& err
         }
 
         Pointer<Transport> transport;
-        this->impl->connectedTransport.swap(transport);
+        this->impl->swapConnectedTransport(transport);
 
         if (transport != NULL) {
 
@@ -961,7 +1081,8 @@ bool FailoverTransport::iterate() {
 
                         this->impl->reconnectDelay = this->impl->initialReconnectDelay;
                         this->impl->connectedTransportURI.reset(new URI(uri));
-                        this->impl->connectedTransport = transport;
+                        Pointer<Transport> connected = transport;
+                        this->impl->swapConnectedTransport(connected);
                         this->impl->reconnectMutex.notifyAll();
                         this->impl->connectFailures = 0;
                         this->impl->connected = true;
@@ -1142,7 +1263,10 @@ void FailoverTransport::processResponse(const Pointer<Response> response) {
 Pointer<wireformat::WireFormat> FailoverTransport::getWireFormat() const {
 
     Pointer<wireformat::WireFormat> result;
+
+    this->impl->transportLock.readLock().lock();
     Pointer<Transport> transport = this->impl->connectedTransport;
+    this->impl->transportLock.readLock().unlock();
 
     if (transport != NULL) {
         result = transport->getWireFormat();
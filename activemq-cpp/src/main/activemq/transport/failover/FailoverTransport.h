@@ -282,6 +282,21 @@ namespace failover {
          */
         Pointer<Transport> createTransport(const decaf::net::URI& location) const;
 
+        /**
+         * Sends the command on the connected transport holding only the shared side of
+         * the transport lock, so that threads sending at the same time do not wait on
+         * each other or on the reconnect mutex.
+         *
+         * @param command
+         *      The Command to track and send.
+         * @param error
+         *      Set when the command could not be tracked, the caller throws it.
+         *
+         * @return false if there is no connected transport or the send failed and
+         *         should be retried on the reconnect path, true otherwise.
+         */
+        bool onewayConnected(const Pointer<Command>& command, Pointer<decaf::lang::Exception>& error);
+
         void processNewTransports(bool rebalance, std::string newTransports);
 
         void processResponse(const Pointer<Response> response);
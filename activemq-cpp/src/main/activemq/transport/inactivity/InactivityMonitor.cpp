@@ -19,13 +19,12 @@
 
 #include "ReadChecker.h"
 #include "WriteChecker.h"
+#include "InactivityMonitorService.h"
 
 #include <activemq/threads/CompositeTask.h>
-#include <activemq/threads/CompositeTaskRunner.h>
 #include <activemq/commands/WireFormatInfo.h>
 #include <activemq/commands/KeepAliveInfo.h>
 
-#include <decaf/util/Timer.h>
 #include <decaf/util/concurrent/atomic/AtomicBoolean.h>
 #include <decaf/util/concurrent/atomic/AtomicInteger.h>
 #include <decaf/lang/Math.h>
@@ -54,6 +53,25 @@ namespace activemq {
 namespace transport {
 namespace inactivity {
 
+    // Shared by a monitor and the keep alive writes it hands to the service's writer
+    // pool, a write that runs after its monitor stopped finds no parent and does nothing.
+    class KeepAliveState {
+    private:
+
+        KeepAliveState(const KeepAliveState&);
+        KeepAliveState operator=(const KeepAliveState&);
+
+    public:
+
+        Mutex mutex;
+        InactivityMonitor* parent;
+        Thread* writer;
+        bool queued;
+
+        KeepAliveState(InactivityMonitor* parent) : mutex(), parent(parent), writer(NULL), queued(false) {
+        }
+    };
+
     class InactivityMonitorData {
     private:
 
@@ -72,13 +90,9 @@ namespace inactivity {
         Pointer<ReadChecker> readCheckerTask;
         Pointer<WriteChecker> writeCheckerTask;
 
-        Timer readCheckTimer;
-        Timer writeCheckTimer;
-
-        Pointer<CompositeTaskRunner> asyncTasks;
-
         Pointer<AsyncSignalReadErrorkTask> asyncReadTask;
         Pointer<AsyncWriteTask> asyncWriteTask;
+        Pointer<KeepAliveState> keepAliveState;
 
         AtomicBoolean monitorStarted;
 
@@ -104,11 +118,9 @@ namespace inactivity {
             remoteWireFormatInfo(),
             readCheckerTask(),
             writeCheckerTask(),
-            readCheckTimer("InactivityMonitor Read Check Timer"),
-            writeCheckTimer("InactivityMonitor Write Check Timer"),
-            asyncTasks(),
             asyncReadTask(),
             asyncWriteTask(),
+            keepAliveState(),
             monitorStarted(),
             commandSent(),
             commandReceived(true),
@@ -163,6 +175,51 @@ namespace inactivity {
         }
     };
 
+    // Sends one KeepAliveInfo on a writer pool thread, a socket that stops draining
+    // blocks only this write and never the shared task runner.
+    class KeepAliveWrite : public Runnable {
+    private:
+
+        Pointer<KeepAliveState> state;
+
+    private:
+
+        KeepAliveWrite(const KeepAliveWrite&);
+        KeepAliveWrite operator=(const KeepAliveWrite&);
+
+    public:
+
+        KeepAliveWrite(const Pointer<KeepAliveState> state) : Runnable(), state(state) {}
+
+        virtual void run() {
+
+            InactivityMonitor* parent = NULL;
+
+            synchronized(&state->mutex) {
+                state->queued = false;
+                if (state->parent == NULL) {
+                    return;
+                }
+                parent = state->parent;
+                state->writer = Thread::currentThread();
+            }
+
+            try {
+                Pointer<KeepAliveInfo> info(new KeepAliveInfo());
+                info->setResponseRequired(parent->isKeepAliveResponseRequired());
+                parent->oneway(info);
+            } catch (IOException& e) {
+                parent->onException(e);
+            } catch (...) {
+            }
+
+            synchronized(&state->mutex) {
+                state->writer = NULL;
+                state->mutex.notifyAll();
+            }
+        }
+    };
+
     // Task that fires when the TaskRunner is signaled by the WriteCheck Timer Task.
     class AsyncWriteTask : public CompositeTask {
     private:
@@ -190,12 +247,21 @@ namespace inactivity {
         virtual bool iterate() {
 
             if (this->write.compareAndSet(true, false) && this->parent->members->monitorStarted.get()) {
-                try {
-                    Pointer<KeepAliveInfo> info(new KeepAliveInfo());
-                    info->setResponseRequired(this->parent->members->keepAliveResponseRequired);
-                    this->parent->oneway(info);
-                } catch (IOException& e) {
-                    this->parent->onException(e);
+
+                Pointer<KeepAliveState> state = this->parent->members->keepAliveState;
+
+                // One keep alive per monitor at a time, if the last one has not gone
+                // out yet the connection is not idle on our side anyway.
+                bool dispatch = false;
+                synchronized(&state->mutex) {
+                    if (state->parent != NULL && !state->queued && state->writer == NULL) {
+                        state->queued = true;
+                        dispatch = true;
+                    }
+                }
+
+                if (dispatch) {
+                    InactivityMonitorService::getInstance().execute(new KeepAliveWrite(state));
                 }
             }
 
@@ -221,6 +287,15 @@ InactivityMonitor::InactivityMonitor(const Pointer<Transport> next, const decaf:
 InactivityMonitor::~InactivityMonitor() {
     try {
         this->stopMonitorThreads();
+
+        Pointer<KeepAliveState> keepAliveState = this->members->keepAliveState;
+        if (keepAliveState != NULL) {
+            synchronized(&keepAliveState->mutex) {
+                while (keepAliveState->writer != NULL && keepAliveState->writer != Thread::currentThread()) {
+                    keepAliveState->mutex.wait();
+                }
+            }
+        }
     }
     AMQ_CATCHALL_NOTHROW()
 
@@ -397,7 +472,7 @@ void InactivityMonitor::readCheck() {
     if (!this->members->commandReceived.get()) {
         // Set the failed state on our async Read Failure Task and wakeup its runner.
         this->members->asyncReadTask->setFailed(true);
-        this->members->asyncTasks->wakeup();
+        InactivityMonitorService::getInstance().wakeup();
     }
 
     this->members->commandReceived.set(false);
@@ -413,7 +488,7 @@ void InactivityMonitor::writeCheck() {
     if (!this->members->commandSent.get()) {
 
         this->members->asyncWriteTask->setWrite(true);
-        this->members->asyncTasks->wakeup();
+        InactivityMonitorService::getInstance().wakeup();
     }
 
     this->members->commandSent.set(false);
@@ -436,14 +511,6 @@ void InactivityMonitor::startMonitorThreads() {
 
     synchronized( &this->members->monitor ) {
 
-        this->members->asyncTasks.reset(new CompositeTaskRunner());
-        this->members->asyncReadTask.reset(new AsyncSignalReadErrorkTask(this, this->getRemoteAddress()));
-        this->members->asyncWriteTask.reset(new AsyncWriteTask(this));
-
-        this->members->asyncTasks->addTask(this->members->asyncReadTask.get());
-        this->members->asyncTasks->addTask(this->members->asyncWriteTask.get());
-        this->members->asyncTasks->start();
-
         this->members->readCheckTime = Math::min(this->members->localWireFormatInfo->getMaxInactivityDuration(),
                 this->members->remoteWireFormatInfo->getMaxInactivityDuration());
 
@@ -452,13 +519,24 @@ void InactivityMonitor::startMonitorThreads() {
 
         if (this->members->readCheckTime > 0) {
 
+            // The checks and the work they trigger run on the threads of the process
+            // wide service, a monitor only registers its tasks there.
+            InactivityMonitorService& service = InactivityMonitorService::getInstance();
+
+            this->members->asyncReadTask.reset(new AsyncSignalReadErrorkTask(this, this->getRemoteAddress()));
+            this->members->asyncWriteTask.reset(new AsyncWriteTask(this));
+            this->members->keepAliveState.reset(new KeepAliveState(this));
+
+            service.addTask(this->members->asyncReadTask.get());
+            service.addTask(this->members->asyncWriteTask.get());
+
             this->members->monitorStarted.set(true);
             this->members->writeCheckerTask.reset(new WriteChecker(this));
             this->members->readCheckerTask.reset(new ReadChecker(this));
             this->members->writeCheckTime = this->members->readCheckTime > 3 ? this->members->readCheckTime / 3 : this->members->readCheckTime;
 
-            this->members->writeCheckTimer.scheduleAtFixedRate(this->members->writeCheckerTask, this->members->initialDelayTime, this->members->writeCheckTime);
-            this->members->readCheckTimer.scheduleAtFixedRate(this->members->readCheckerTask, this->members->initialDelayTime, this->members->readCheckTime);
+            service.getTimer().schedule(this->members->writeCheckerTask, this->members->initialDelayTime, this->members->writeCheckTime);
+            service.getTimer().schedule(this->members->readCheckerTask, this->members->initialDelayTime, this->members->readCheckTime);
         }
     }
 }
@@ -468,17 +546,38 @@ void InactivityMonitor::stopMonitorThreads() {
 
     if (this->members->monitorStarted.compareAndSet(true, false)) {
 
+        Pointer<ReadChecker> readChecker;
+        Pointer<WriteChecker> writeChecker;
+        Pointer<AsyncSignalReadErrorkTask> asyncReadTask;
+        Pointer<AsyncWriteTask> asyncWriteTask;
+        Pointer<KeepAliveState> keepAliveState;
+
         synchronized(&this->members->monitor) {
+            readChecker = this->members->readCheckerTask;
+            writeChecker = this->members->writeCheckerTask;
+            asyncReadTask = this->members->asyncReadTask;
+            asyncWriteTask = this->members->asyncWriteTask;
+            keepAliveState = this->members->keepAliveState;
+        }
+
+        // The waits below must not hold the monitor, a check or task being waited
+        // on may itself need it to finish.
+        InactivityMonitorService& service = InactivityMonitorService::getInstance();
 
-            this->members->readCheckerTask->cancel();
-            this->members->writeCheckerTask->cancel();
+        // Once these return neither the checks nor the async tasks are running
+        // for this monitor, unless this is one of them stopping its own monitor.
+        service.getTimer().cancel(readChecker.get());
+        service.getTimer().cancel(writeChecker.get());
 
-            this->members->readCheckTimer.purge();
-            this->members->readCheckTimer.cancel();
-            this->members->writeCheckTimer.purge();
-            this->members->writeCheckTimer.cancel();
+        service.removeTask(asyncReadTask.get());
+        service.removeTask(asyncWriteTask.get());
 
-            this->members->asyncTasks->shutdown();
+        // A keep alive already being written is left to finish, it may be stuck on
+        // the socket until the next transport closes, the destructor waits for it.
+        if (keepAliveState != NULL) {
+            synchronized(&keepAliveState->mutex) {
+                keepAliveState->parent = NULL;
+            }
         }
     }
 }
@@ -0,0 +1,161 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "InactivityMonitorService.h"
+
+#include <activemq/threads/CompositeTaskRunner.h>
+#include <activemq/exceptions/ActiveMQException.h>
+
+#include <decaf/lang/Math.h>
+#include <decaf/lang/System.h>
+#include <decaf/lang/exceptions/IllegalStateException.h>
+#include <decaf/util/concurrent/ThreadPoolExecutor.h>
+#include <decaf/util/concurrent/LinkedBlockingQueue.h>
+#include <decaf/util/concurrent/TimeUnit.h>
+#include <decaf/util/concurrent/atomic/AtomicBoolean.h>
+
+using namespace activemq;
+using namespace activemq::threads;
+using namespace activemq::transport;
+using namespace activemq::transport::inactivity;
+using namespace decaf;
+using namespace decaf::lang;
+using namespace decaf::lang::exceptions;
+using namespace decaf::util::concurrent;
+using namespace decaf::util::concurrent::atomic;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+    InactivityMonitorService* theOnlyInstance = NULL;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+namespace activemq {
+namespace transport {
+namespace inactivity {
+
+    class InactivityMonitorServiceImpl {
+    private:
+
+        InactivityMonitorServiceImpl(const InactivityMonitorServiceImpl&);
+        InactivityMonitorServiceImpl& operator=(const InactivityMonitorServiceImpl&);
+
+    public:
+
+        HashedWheelTimer timer;
+        CompositeTaskRunner asyncTasks;
+        AtomicBoolean asyncTasksStarted;
+        ThreadPoolExecutor writers;
+
+        // Writer threads are only created while there are keep alives to send and
+        // time out once the process goes quiet.
+        InactivityMonitorServiceImpl() : timer("InactivityMonitor Check Timer"), asyncTasks(), asyncTasksStarted(),
+                                         writers(Math::max(2, System::availableProcessors()),
+                                                 Math::max(2, System::availableProcessors()),
+                                                 30, TimeUnit::SECONDS, new LinkedBlockingQueue<Runnable*>()) {
+            this->writers.allowCoreThreadTimeout(true);
+        }
+    };
+
+}}}
+
+////////////////////////////////////////////////////////////////////////////////
+InactivityMonitorService::InactivityMonitorService() : impl(new InactivityMonitorServiceImpl) {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+InactivityMonitorService::~InactivityMonitorService() {
+    try {
+        this->impl->timer.shutdown();
+        this->impl->asyncTasks.shutdown();
+        this->impl->writers.shutdown();
+        this->impl->writers.awaitTermination(5, TimeUnit::SECONDS);
+    }
+    AMQ_CATCHALL_NOTHROW()
+
+    try {
+        delete this->impl;
+    }
+    AMQ_CATCHALL_NOTHROW()
+}
+
+////////////////////////////////////////////////////////////////////////////////
+HashedWheelTimer& InactivityMonitorService::getTimer() {
+    return this->impl->timer;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void InactivityMonitorService::addTask(CompositeTask* task) {
+    this->impl->asyncTasks.addTask(task);
+
+    if (this->impl->asyncTasksStarted.compareAndSet(false, true)) {
+        this->impl->asyncTasks.start();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void InactivityMonitorService::removeTask(CompositeTask* task) {
+    this->impl->asyncTasks.removeTask(task);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void InactivityMonitorService::wakeup() {
+    this->impl->asyncTasks.wakeup();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void InactivityMonitorService::execute(Runnable* write) {
+    this->impl->writers.execute(write);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int InactivityMonitorService::getThreadCount() const {
+
+    int count = this->impl->writers.getPoolSize();
+
+    if (this->impl->timer.isThreadAlive()) {
+        count++;
+    }
+
+    if (this->impl->asyncTasks.isStarted()) {
+        count++;
+    }
+
+    return count;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+InactivityMonitorService& InactivityMonitorService::getInstance() {
+
+    if (theOnlyInstance == NULL) {
+        throw IllegalStateException(__FILE__, __LINE__,
+            "The InactivityMonitorService is not available, the library has not been initialized.");
+    }
+
+    return *theOnlyInstance;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void InactivityMonitorService::initialize() {
+    theOnlyInstance = new InactivityMonitorService();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void InactivityMonitorService::shutdown() {
+    delete theOnlyInstance;
+    theOnlyInstance = NULL;
+}
@@ -0,0 +1,125 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_TRANSPORT_INACTIVITY_INACTIVITYMONITORSERVICE_H_
+#define _ACTIVEMQ_TRANSPORT_INACTIVITY_INACTIVITYMONITORSERVICE_H_
+
+#include <activemq/util/Config.h>
+
+#include <activemq/threads/HashedWheelTimer.h>
+#include <activemq/threads/CompositeTask.h>
+
+#include <decaf/lang/Runnable.h>
+
+namespace activemq {
+namespace library {
+    class ActiveMQCPP;
+}
+namespace transport {
+namespace inactivity {
+
+    class InactivityMonitorServiceImpl;
+
+    /**
+     * Process wide service shared by all InactivityMonitor instances.  The read and
+     * write checks of every monitor are scheduled on one HashedWheelTimer and the
+     * read failure notifications they trigger are run by one task runner.  Keep alive
+     * writes go to a small pool of writer threads so that a connection whose socket
+     * stops draining can never hold up the checks of the others.
+     *
+     * @since 3.10.0
+     */
+    class AMQCPP_API InactivityMonitorService {
+    private:
+
+        InactivityMonitorServiceImpl* impl;
+
+    private:
+
+        InactivityMonitorService();
+        InactivityMonitorService(const InactivityMonitorService&);
+        InactivityMonitorService& operator=(const InactivityMonitorService&);
+
+    public:
+
+        virtual ~InactivityMonitorService();
+
+        /**
+         * @return the timer that runs the read and write checks of all monitors.
+         */
+        activemq::threads::HashedWheelTimer& getTimer();
+
+        /**
+         * Adds a task to the shared task runner, the runner thread is started when the
+         * first task is added.
+         *
+         * @param task
+         *      The task to add, the caller keeps ownership.
+         */
+        void addTask(activemq::threads::CompositeTask* task);
+
+        /**
+         * Removes a task from the shared task runner, if the task is being run by
+         * another thread this waits for it to finish.
+         *
+         * @param task
+         *      The task to remove.
+         */
+        void removeTask(activemq::threads::CompositeTask* task);
+
+        /**
+         * Signals the shared task runner that one of its tasks has work pending.
+         */
+        void wakeup();
+
+        /**
+         * Hands a keep alive write to the writer pool, the call never blocks.
+         *
+         * @param write
+         *      The write to run, the service takes ownership.
+         */
+        void execute(decaf::lang::Runnable* write);
+
+        /**
+         * @return the number of threads the service is currently running.
+         */
+        int getThreadCount() const;
+
+    public:
+
+        /**
+         * Gets the single instance of the service, only valid between the library
+         * initialize and shutdown calls.
+         *
+         * @return the process wide InactivityMonitorService.
+         *
+         * @throws IllegalStateException if the library has not been initialized.
+         */
+        static InactivityMonitorService& getInstance();
+
+    private:
+
+        static void initialize();
+        static void shutdown();
+
+        friend class activemq::library::ActiveMQCPP;
+
+    };
+
+}}}
+
+#endif /* _ACTIVEMQ_TRANSPORT_INACTIVITY_INACTIVITYMONITORSERVICE_H_ */
@@ -19,6 +19,8 @@
 
 #include <activemq/transport/mock/MockTransport.h>
 
+#include <decaf/lang/System.h>
+
 using namespace activemq;
 using namespace activemq::transport;
 using namespace activemq::transport::mock;
@@ -30,7 +32,7 @@ using namespace decaf::lang::exceptions;
 
 ////////////////////////////////////////////////////////////////////////////////
 InternalCommandListener::InternalCommandListener() :
-    transport(NULL), responseBuilder(), done(false), startedLatch(1), inboundQueue() {
+    transport(NULL), responseBuilder(), done(false), startedLatch(1), inboundQueue(), dueTimes(), responseDelay(0) {
 
     this->start();
     startedLatch.await();
@@ -46,6 +48,7 @@ InternalCommandListener::~InternalCommandListener() {
         this->join();
 
         inboundQueue.clear();
+        dueTimes.clear();
     }
     AMQ_CATCHALL_NOTHROW()
 }
@@ -55,8 +58,14 @@ void InternalCommandListener::onCommand(const Pointer<Command> command) {
     synchronized(&inboundQueue) {
         // Create a response now before the caller has a
         // chance to destroy the command.
+        int queued = inboundQueue.size();
         responseBuilder->buildIncomingCommands(command, inboundQueue);
 
+        long long dueTime = System::currentTimeMillis() + responseDelay;
+        for (int i = queued; i < inboundQueue.size(); ++i) {
+            dueTimes.addLast(dueTime);
+        }
+
         // Wake up the thread, messages are dispatched from there.
         inboundQueue.notifyAll();
     }
@@ -80,10 +89,17 @@ void InternalCommandListener::run() {
                     continue;
                 }
 
-                // If we created a response then send it.
-                while (!inboundQueue.isEmpty()) {
+                // If we created a response then send it once it is due.
+                while (!inboundQueue.isEmpty() && !done) {
+
+                    long long delay = dueTimes.getFirst() - System::currentTimeMillis();
+                    if (delay > 0) {
+                        inboundQueue.wait(delay);
+                        continue;
+                    }
 
                     Pointer<Command> command = inboundQueue.pop();
+                    dueTimes.pop();
 
                     if (command->isMessage() && transport->isFailOnReceiveMessage()) {
                         transport->setNumReceivedMessages(transport->getNumReceivedMessages() + 1);
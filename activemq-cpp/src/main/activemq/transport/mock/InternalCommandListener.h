@@ -51,6 +51,8 @@ namespace mock {
         bool done;
         decaf::util::concurrent::CountDownLatch startedLatch;
         decaf::util::LinkedList<Pointer<Command> > inboundQueue;
+        decaf::util::LinkedList<long long> dueTimes;
+        long long responseDelay;
 
     private:
 
@@ -71,6 +73,19 @@ namespace mock {
             this->responseBuilder = responseBuilder;
         }
 
+        /**
+         * Sets the time in milliseconds that the Commands built in answer to each
+         * outgoing Command are held before they are sent back, simulating the round
+         * trip to a remote Broker.  Defaults to zero.
+         */
+        void setResponseDelay(long long responseDelay) {
+            this->responseDelay = responseDelay;
+        }
+
+        long long getResponseDelay() const {
+            return this->responseDelay;
+        }
+
         virtual void onCommand(const Pointer<Command> command);
 
         void run();
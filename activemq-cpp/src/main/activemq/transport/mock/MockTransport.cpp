@@ -51,7 +51,10 @@ MockTransport::MockTransport(const Pointer<WireFormat> wireFormat,
     numSentKeepAlives(0),
     failOnStart(false),
     failOnStop(false),
-    failOnClose(false) {
+    failOnClose(false),
+    holdAsyncResponses(false),
+    heldResponses(),
+    heldResponsesLock() {
 
     this->instance = this;
 
@@ -125,6 +128,13 @@ Pointer<FutureResponse> MockTransport::asyncRequest(const Pointer<Command> comma
             Pointer<FutureResponse> future(new FutureResponse(responseCallback));
             Pointer<Response> response(responseBuilder->buildResponse(command));
 
+            if (this->holdAsyncResponses) {
+                synchronized(&heldResponsesLock) {
+                    heldResponses.push_back(std::make_pair(future, response));
+                }
+                return future;
+            }
+
             future->setResponse(response);
 
             return future;
@@ -205,3 +215,19 @@ void MockTransport::close() {
         throw IOException(__FILE__, __LINE__, "Failed to Close MockTransport.");
     }
 }
+
+////////////////////////////////////////////////////////////////////////////////
+int MockTransport::releaseAsyncResponses() {
+
+    std::vector< std::pair< Pointer<FutureResponse>, Pointer<Response> > > released;
+
+    synchronized(&heldResponsesLock) {
+        released.swap(heldResponses);
+    }
+
+    for (std::size_t i = 0; i < released.size(); ++i) {
+        released[i].first->setResponse(released[i].second);
+    }
+
+    return (int) released.size();
+}
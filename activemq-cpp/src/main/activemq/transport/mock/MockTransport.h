@@ -32,11 +32,14 @@
 #include <decaf/util/concurrent/Concurrent.h>
 #include <decaf/util/concurrent/atomic/AtomicInteger.h>
 #include <decaf/util/concurrent/CountDownLatch.h>
+#include <decaf/util/concurrent/Mutex.h>
 
 #include <cms/Message.h>
 
 #include <map>
 #include <set>
+#include <utility>
+#include <vector>
 
 namespace activemq{
 namespace transport{
@@ -85,6 +88,11 @@ namespace mock{
         bool failOnStop;
         bool failOnClose;
 
+        // Responses to asyncRequest held back until the test releases them.
+        bool holdAsyncResponses;
+        std::vector< std::pair< Pointer<FutureResponse>, Pointer<Response> > > heldResponses;
+        decaf::util::concurrent::Mutex heldResponsesLock;
+
     private:
 
         MockTransport(const MockTransport&);
@@ -312,6 +320,45 @@ namespace mock{
             this->failOnClose = value;
         }
 
+        long long getResponseDelay() const {
+            return this->internalListener.getResponseDelay();
+        }
+
+        /**
+         * Sets the time in milliseconds that responses to sent Commands are held before
+         * they arrive, simulating the round trip time to a remote Broker.
+         *
+         * @param value
+         *      The simulated round trip time in milliseconds.
+         */
+        void setResponseDelay(long long value) {
+            this->internalListener.setResponseDelay(value);
+        }
+
+        bool isHoldAsyncResponses() const {
+            return this->holdAsyncResponses;
+        }
+
+        /**
+         * Sets whether the responses to asyncRequest are held back instead of being
+         * completed before the call returns, so that a test can act while a request
+         * is in flight.
+         *
+         * @param value
+         *      True to hold the responses until releaseAsyncResponses is called.
+         */
+        void setHoldAsyncResponses(bool value) {
+            this->holdAsyncResponses = value;
+        }
+
+        /**
+         * Completes the held asyncRequest responses, in the order they were requested,
+         * on the calling thread.
+         *
+         * @return the number of responses released.
+         */
+        int releaseAsyncResponses();
+
         virtual bool isReconnectSupported() const {
             return false;
         }
@@ -26,6 +26,7 @@
 
 #include <decaf/lang/Boolean.h>
 #include <decaf/lang/Integer.h>
+#include <decaf/lang/Long.h>
 #include <decaf/io/IOException.h>
 
 using namespace activemq;
@@ -123,6 +124,8 @@ Pointer<Transport> MockTransportFactory::doCreateComposite(const decaf::net::URI
         transport->setNumSentKeepAlivesBeforeFail(
             Integer::parseInt(properties.getProperty("numSentKeepAlivesBeforeFail", "0")));
         transport->setName(properties.getProperty("name", ""));
+        transport->setResponseDelay(
+            Long::parseLong(properties.getProperty("responseDelay", "0")));
 
         return transport;
     }
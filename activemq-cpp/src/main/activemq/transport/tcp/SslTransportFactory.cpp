@@ -50,7 +50,7 @@ Pointer<Transport> SslTransportFactory::doCreateComposite(const decaf::net::URI&
 
     try {
 
-        Pointer<Transport> transport(new IOTransport(wireFormat));
+        Pointer<Transport> transport(createIOTransport(wireFormat, properties));
 
         transport.reset(new SslTransport(transport, location));
 
@@ -27,6 +27,7 @@
 #include <decaf/util/Properties.h>
 #include <decaf/lang/Integer.h>
 #include <decaf/lang/Boolean.h>
+#include <decaf/lang/Long.h>
 
 using namespace activemq;
 using namespace activemq::util;
@@ -87,7 +88,7 @@ Pointer<Transport> TcpTransportFactory::doCreateComposite(const decaf::net::URI&
 
     try {
 
-        Pointer<Transport> transport(new IOTransport(wireFormat));
+        Pointer<Transport> transport(createIOTransport(wireFormat, properties));
 
         transport.reset(new TcpTransport(transport, location));
 
@@ -142,3 +143,27 @@ void TcpTransportFactory::doConfigureTransport(Pointer<Transport> transport,
     AMQ_CATCH_EXCEPTION_CONVERT(Exception, ActiveMQException)
     AMQ_CATCHALL_THROW(ActiveMQException)
 }
+
+////////////////////////////////////////////////////////////////////////////////
+Pointer<Transport> TcpTransportFactory::createIOTransport(const Pointer<wireformat::WireFormat> wireFormat,
+                                                          const decaf::util::Properties& properties) {
+
+    try {
+
+        Pointer<IOTransport> transport(new IOTransport(wireFormat));
+
+        transport->setWriteBatchingEnabled(
+            Boolean::parseBoolean(properties.getProperty("transport.writeBatchingEnabled", "false")));
+        transport->setWriteBatchMaxSize(
+            Integer::parseInt(properties.getProperty("transport.writeBatchMaxSize", "65536")));
+        transport->setWriteBatchMaxDelay(
+            Long::parseLong(properties.getProperty("transport.writeBatchMaxDelay", "100")));
+        transport->setUseReactor(
+            Boolean::parseBoolean(properties.getProperty("transport.useReactor", "false")));
+
+        return transport;
+    }
+    AMQ_CATCH_RETHROW(ActiveMQException)
+    AMQ_CATCH_EXCEPTION_CONVERT(Exception, ActiveMQException)
+    AMQ_CATCHALL_THROW(ActiveMQException)
+}
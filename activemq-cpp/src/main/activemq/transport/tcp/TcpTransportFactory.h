@@ -47,6 +47,20 @@ namespace tcp {
 
         virtual void doConfigureTransport(Pointer<Transport>, const decaf::util::Properties& properties);
 
+        /**
+         * Creates the IOTransport at the bottom of the transport chain and applies the
+         * write batching options found in the properties to it.
+         *
+         * @param wireFormat
+         *      The WireFormat the new IOTransport will use.
+         * @param properties
+         *      The URI query properties used to configure the IOTransport.
+         *
+         * @return the newly created IOTransport.
+         */
+        virtual Pointer<Transport> createIOTransport(const Pointer<wireformat::WireFormat> wireFormat,
+                                                     const decaf::util::Properties& properties);
+
     };
 
 }}}
@@ -43,6 +43,8 @@
 
 #include <decaf/lang/exceptions/NullPointerException.h>
 
+#include <algorithm>
+
 using namespace activemq;
 using namespace activemq::util;
 using namespace activemq::core;
@@ -116,9 +118,13 @@ bool ActiveMQMessageTransformation::transformMessage(cms::Message* message, Acti
             ActiveMQBytesMessage* msg = new ActiveMQBytesMessage();
             msg->setConnection(connection);
             try {
-                for (;;) {
-                    // Reads a byte from the message stream until the stream is empty
-                    msg->writeByte(bytesMsg->readByte());
+                // Copies the body a block at a time, the length is only a hint for
+                // sizing the block so reading continues until the stream is empty.
+                int blockSize = std::max(1, std::min(bytesMsg->getBodyLength(), 64 * 1024));
+                std::vector<unsigned char> block(blockSize);
+                int count = 0;
+                while ((count = bytesMsg->readBytes(&block[0], blockSize)) > 0) {
+                    msg->writeBytes(&block[0], 0, count);
                 }
             } catch (cms::MessageEOFException& e) {
                 // if an end of message stream as expected
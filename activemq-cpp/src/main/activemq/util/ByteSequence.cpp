@@ -0,0 +1,235 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ByteSequence.h"
+
+#include <decaf/lang/exceptions/IndexOutOfBoundsException.h>
+#include <decaf/lang/exceptions/NullPointerException.h>
+
+#include <string.h>
+
+using namespace std;
+using namespace activemq;
+using namespace activemq::util;
+using namespace decaf;
+using namespace decaf::lang;
+using namespace decaf::lang::exceptions;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    const std::vector<unsigned char> EMPTY_ARRAY;
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+ByteSequence::ByteSequence() : storage(), offset(0), length(0), sliced(false) {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+ByteSequence::ByteSequence(const unsigned char* bytes, int length) : storage(), offset(0), length(0), sliced(false) {
+
+    if (length < 0) {
+        throw IndexOutOfBoundsException(__FILE__, __LINE__, "Length given was negative");
+    }
+
+    if (length == 0) {
+        return;
+    }
+
+    if (bytes == NULL) {
+        throw NullPointerException(__FILE__, __LINE__, "Bytes given were NULL");
+    }
+
+    this->storage.reset(new Storage());
+    this->storage->bytes.assign(bytes, bytes + length);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+ByteSequence::ByteSequence(const std::vector<unsigned char>& bytes) : storage(), offset(0), length(0), sliced(false) {
+
+    if (!bytes.empty()) {
+        this->storage.reset(new Storage());
+        this->storage->bytes = bytes;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+ByteSequence::~ByteSequence() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+ByteSequence ByteSequence::adopt(std::vector<unsigned char>& bytes) {
+
+    ByteSequence result;
+
+    if (!bytes.empty()) {
+        result.storage.reset(new Storage());
+        result.storage->bytes.swap(bytes);
+    }
+
+    return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int ByteSequence::getLength() const {
+
+    if (this->sliced) {
+        return this->length;
+    }
+
+    return this->storage == NULL ? 0 : (int) this->storage->bytes.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+const unsigned char* ByteSequence::getData() const {
+
+    if (this->getLength() == 0) {
+        return NULL;
+    }
+
+    return &this->storage->bytes[this->offset];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+const std::vector<unsigned char>& ByteSequence::getArray() const {
+
+    if (this->storage == NULL) {
+        return EMPTY_ARRAY;
+    }
+
+    return this->storage->bytes;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+unsigned char ByteSequence::get(int index) const {
+
+    int size = this->getLength();
+
+    if (index < 0 || index >= size) {
+        throw IndexOutOfBoundsException(__FILE__, __LINE__, "Index %d is outside of a sequence of %d bytes", index, size);
+    }
+
+    return this->storage->bytes[this->offset + index];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+ByteSequence ByteSequence::slice(int offset) const {
+
+    int size = this->getLength();
+
+    if (offset < 0 || offset > size) {
+        throw IndexOutOfBoundsException(__FILE__, __LINE__, "Offset %d is outside of a sequence of %d bytes", offset, size);
+    }
+
+    return this->slice(offset, size - offset);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+ByteSequence ByteSequence::slice(int offset, int length) const {
+
+    int size = this->getLength();
+
+    if (offset < 0 || length < 0 || offset > size - length) {
+        throw IndexOutOfBoundsException(__FILE__, __LINE__, "Range %d, %d is outside of a sequence of %d bytes",
+                                        offset, length, size);
+    }
+
+    if (offset == 0 && length == size) {
+        return *this;
+    }
+
+    ByteSequence result;
+
+    // An empty slice keeps no reference so that it never holds the storage alive.
+    if (length > 0) {
+        result.storage = this->storage;
+        result.offset = this->offset + offset;
+        result.length = length;
+        result.sliced = true;
+    }
+
+    return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+ByteSequence ByteSequence::trim() const {
+
+    if (!this->sliced) {
+        return *this;
+    }
+
+    return ByteSequence(this->getData(), this->length);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool ByteSequence::isSharedWith(const ByteSequence& other) const {
+    return this->storage != NULL && this->storage == other.storage;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::vector<unsigned char> ByteSequence::toVector() const {
+
+    int size = this->getLength();
+
+    if (size == 0) {
+        return std::vector<unsigned char>();
+    }
+
+    const unsigned char* data = this->getData();
+    return std::vector<unsigned char>(data, data + size);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::vector<unsigned char>& ByteSequence::detach() {
+
+    // The count is only read while this sequence holds a reference, another thread
+    // can only add one by copying a sequence it already has.
+    if (this->storage == NULL || this->storage->getReferenceCount() > 1 || this->sliced) {
+
+        Pointer<Storage> copy(new Storage());
+
+        int size = this->getLength();
+        if (size > 0) {
+            const unsigned char* data = this->getData();
+            copy->bytes.assign(data, data + size);
+        }
+
+        this->storage = copy;
+        this->offset = 0;
+        this->length = 0;
+        this->sliced = false;
+    }
+
+    return this->storage->bytes;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool ByteSequence::equals(const ByteSequence& other) const {
+
+    int size = this->getLength();
+
+    if (size != other.getLength()) {
+        return false;
+    }
+
+    if (size == 0 || (this->storage == other.storage && this->offset == other.offset)) {
+        return true;
+    }
+
+    return ::memcmp(this->getData(), other.getData(), (size_t) size) == 0;
+}
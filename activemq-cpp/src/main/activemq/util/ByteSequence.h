@@ -0,0 +1,227 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_UTIL_BYTESEQUENCE_H_
+#define _ACTIVEMQ_UTIL_BYTESEQUENCE_H_
+
+#include <activemq/util/Config.h>
+
+#include <decaf/lang/Pointer.h>
+#include <decaf/util/concurrent/atomic/AtomicRefCounted.h>
+
+#include <vector>
+
+namespace activemq {
+namespace util {
+
+    /**
+     * An immutable sequence of bytes whose storage is shared by every copy and slice
+     * taken from it.  Copying a ByteSequence, or slicing a range out of one, only adds
+     * a reference to the storage, so a message body can be handed from the wire format
+     * to a message, its clones and the readers of its body without copying the bytes.
+     * The storage is freed when the last sequence referring to it is destroyed.
+     *
+     * The bytes are never changed once a sequence holds them.  The one exception is
+     * detach, which first gives the sequence its own copy whenever the storage is seen
+     * by any other sequence, so the change can never be observed through another copy.
+     *
+     * @since 3.10.0
+     */
+    class AMQCPP_API ByteSequence {
+    private:
+
+        class Storage : public decaf::util::concurrent::atomic::AtomicRefCounted {
+        public:
+
+            std::vector<unsigned char> bytes;
+
+            Storage() : AtomicRefCounted(), bytes() {}
+        };
+
+        decaf::lang::Pointer<Storage> storage;
+
+        // A slice views offset and length of the storage, any other sequence spans
+        // the whole of its storage and takes its length from it.
+        int offset;
+        int length;
+        bool sliced;
+
+    public:
+
+        /**
+         * Creates an empty sequence.
+         */
+        ByteSequence();
+
+        /**
+         * Creates a sequence holding a copy of the given bytes.
+         *
+         * @param bytes
+         *      The bytes to copy.
+         * @param length
+         *      The number of bytes to copy.
+         *
+         * @throw IndexOutOfBoundsException if the length is negative.
+         * @throw NullPointerException if the bytes are NULL and the length is not zero.
+         */
+        ByteSequence(const unsigned char* bytes, int length);
+
+        /**
+         * Creates a sequence holding a copy of the given bytes.
+         *
+         * @param bytes
+         *      The bytes to copy.
+         */
+        explicit ByteSequence(const std::vector<unsigned char>& bytes);
+
+        virtual ~ByteSequence();
+
+        /**
+         * Creates a sequence that takes the contents of the given vector without copying
+         * them, the vector is left empty.
+         *
+         * @param bytes
+         *      The vector whose contents become the storage of the new sequence.
+         *
+         * @return a sequence holding the bytes that were in the vector.
+         */
+        static ByteSequence adopt(std::vector<unsigned char>& bytes);
+
+        /**
+         * @return a pointer to the first byte of this sequence or NULL when it is empty.
+         */
+        const unsigned char* getData() const;
+
+        /**
+         * @return the number of bytes in this sequence.
+         */
+        int getLength() const;
+
+        /**
+         * @return true if the sequence holds no bytes.
+         */
+        bool isEmpty() const {
+            return this->getLength() == 0;
+        }
+
+        /**
+         * @return the index in the backing array of the first byte of this sequence.
+         */
+        int getOffset() const {
+            return this->offset;
+        }
+
+        /**
+         * Returns the array that holds the bytes of this sequence.  The array spans
+         * exactly this sequence only when isWhole is true, for a slice the bytes start
+         * at getOffset.
+         *
+         * @return the backing array, an empty one if this sequence is empty.
+         */
+        const std::vector<unsigned char>& getArray() const;
+
+        /**
+         * @return true if this sequence spans the whole of its backing array.
+         */
+        bool isWhole() const {
+            return !this->sliced;
+        }
+
+        /**
+         * @param index
+         *      The index of the byte to return.
+         *
+         * @return the byte at the given index in this sequence.
+         *
+         * @throw IndexOutOfBoundsException if the index is outside of this sequence.
+         */
+        unsigned char get(int index) const;
+
+        /**
+         * Returns a sequence that shares this one's storage and holds the bytes from the
+         * given offset to the end of this sequence.
+         *
+         * @param offset
+         *      The index in this sequence of the first byte of the slice.
+         *
+         * @return the new slice.
+         *
+         * @throw IndexOutOfBoundsException if the offset is outside of this sequence.
+         */
+        ByteSequence slice(int offset) const;
+
+        /**
+         * Returns a sequence that shares this one's storage and holds the given range
+         * of its bytes.
+         *
+         * @param offset
+         *      The index in this sequence of the first byte of the slice.
+         * @param length
+         *      The number of bytes in the slice.
+         *
+         * @return the new slice.
+         *
+         * @throw IndexOutOfBoundsException if the range is outside of this sequence.
+         */
+        ByteSequence slice(int offset, int length) const;
+
+        /**
+         * @return a sequence holding these bytes whose backing array spans only them,
+         *         this sequence when it is already whole and otherwise a copy.
+         */
+        ByteSequence trim() const;
+
+        /**
+         * @param other
+         *      The sequence to compare storage with.
+         *
+         * @return true if both sequences refer to the same storage.
+         */
+        bool isSharedWith(const ByteSequence& other) const;
+
+        /**
+         * @return a new vector holding a copy of the bytes in this sequence.
+         */
+        std::vector<unsigned char> toVector() const;
+
+        /**
+         * Gives modifiable access to the bytes of this sequence.  The sequence is first
+         * given its own whole copy of the bytes when it is a slice or its storage is
+         * shared with another sequence, so no other sequence ever sees the change.
+         *
+         * @return the array holding this sequence's bytes, it must not be used to change
+         *         them once this sequence has been copied or sliced.
+         */
+        std::vector<unsigned char>& detach();
+
+        /**
+         * @param other
+         *      The sequence to compare to.
+         *
+         * @return true if both sequences hold the same bytes.
+         */
+        bool equals(const ByteSequence& other) const;
+
+        bool operator==(const ByteSequence& other) const {
+            return this->equals(other);
+        }
+
+    };
+
+}}
+
+#endif /* _ACTIVEMQ_UTIL_BYTESEQUENCE_H_ */
@@ -0,0 +1,209 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "CompressionContextPool.h"
+
+#include <activemq/exceptions/ActiveMQException.h>
+#include <decaf/lang/Math.h>
+#include <decaf/lang/exceptions/NullPointerException.h>
+#include <decaf/util/concurrent/Concurrent.h>
+#include <decaf/util/zip/DataFormatException.h>
+
+using namespace activemq;
+using namespace activemq::util;
+using namespace decaf::lang;
+using namespace decaf::lang::exceptions;
+using namespace decaf::util;
+using namespace decaf::util::concurrent;
+using namespace decaf::util::zip;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    // Room to start with when the output size isn't known, grown by doubling.
+    const int MIN_OUTPUT_SIZE = 256;
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+const int CompressionContextPool::DEFAULT_MAX_IDLE = 4;
+
+////////////////////////////////////////////////////////////////////////////////
+CompressionContextPool::CompressionContextPool() : deflaters(), inflaters(), maxIdle(DEFAULT_MAX_IDLE), mutex() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+CompressionContextPool::CompressionContextPool(int maxIdle) : deflaters(), inflaters(), maxIdle(maxIdle), mutex() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+CompressionContextPool::~CompressionContextPool() {
+    try {
+        for (std::size_t i = 0; i < this->deflaters.size(); ++i) {
+            delete this->deflaters[i];
+        }
+        for (std::size_t i = 0; i < this->inflaters.size(); ++i) {
+            delete this->inflaters[i];
+        }
+    }
+    AMQ_CATCHALL_NOTHROW()
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CompressionContextPool::deflate(const unsigned char* data, int length, int level, std::vector<unsigned char>& out) {
+
+    if (data == NULL) {
+        throw NullPointerException(__FILE__, __LINE__, "Data to compress cannot be NULL.");
+    }
+
+    Deflater* deflater = this->takeDeflater(level);
+
+    try {
+
+        deflater->setInput(data, length, 0, length);
+        deflater->finish();
+
+        std::size_t count = out.size();
+        out.resize(count + Math::max(length / 2, MIN_OUTPUT_SIZE));
+
+        while (!deflater->finished()) {
+            if (count == out.size()) {
+                out.resize(out.size() * 2);
+            }
+            count += deflater->deflate(&out[0], (int) out.size(), (int) count, (int) (out.size() - count));
+        }
+
+        out.resize(count);
+
+    } catch (...) {
+        // Whatever state it was left in, it isn't worth keeping.
+        delete deflater;
+        throw;
+    }
+
+    this->giveBack(deflater);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CompressionContextPool::inflate(const unsigned char* data, int length, std::vector<unsigned char>& out) {
+
+    if (data == NULL) {
+        throw NullPointerException(__FILE__, __LINE__, "Data to decompress cannot be NULL.");
+    }
+
+    Inflater* inflater = this->takeInflater();
+
+    try {
+
+        inflater->setInput(data, length, 0, length);
+
+        std::size_t count = out.size();
+        out.resize(Math::max((int) out.capacity(), (int) count + MIN_OUTPUT_SIZE));
+
+        while (!inflater->finished()) {
+
+            if (count == out.size()) {
+                out.resize(out.size() * 2);
+            }
+
+            int inflated = inflater->inflate(&out[0], (int) out.size(), (int) count, (int) (out.size() - count));
+            if (inflated == 0 && (inflater->needsInput() || inflater->needsDictionary())) {
+                throw DataFormatException(__FILE__, __LINE__, "Compressed data ended before the end of the stream.");
+            }
+
+            count += inflated;
+        }
+
+        out.resize(count);
+
+    } catch (...) {
+        delete inflater;
+        throw;
+    }
+
+    this->giveBack(inflater);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Deflater* CompressionContextPool::takeDeflater(int level) {
+
+    Deflater* deflater = NULL;
+
+    synchronized(&this->mutex) {
+        if (!this->deflaters.empty()) {
+            deflater = this->deflaters.back();
+            this->deflaters.pop_back();
+        }
+    }
+
+    if (deflater == NULL) {
+        return new Deflater(level);
+    }
+
+    try {
+        deflater->setLevel(level);
+    } catch (...) {
+        this->giveBack(deflater);
+        throw;
+    }
+
+    return deflater;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CompressionContextPool::giveBack(Deflater* deflater) {
+
+    deflater->reset();
+
+    synchronized(&this->mutex) {
+        if ((int) this->deflaters.size() < this->maxIdle) {
+            this->deflaters.push_back(deflater);
+            return;
+        }
+    }
+
+    delete deflater;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Inflater* CompressionContextPool::takeInflater() {
+
+    synchronized(&this->mutex) {
+        if (!this->inflaters.empty()) {
+            Inflater* inflater = this->inflaters.back();
+            this->inflaters.pop_back();
+            return inflater;
+        }
+    }
+
+    return new Inflater();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CompressionContextPool::giveBack(Inflater* inflater) {
+
+    inflater->reset();
+
+    synchronized(&this->mutex) {
+        if ((int) this->inflaters.size() < this->maxIdle) {
+            this->inflaters.push_back(inflater);
+            return;
+        }
+    }
+
+    delete inflater;
+}
@@ -0,0 +1,135 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_UTIL_COMPRESSIONCONTEXTPOOL_H_
+#define _ACTIVEMQ_UTIL_COMPRESSIONCONTEXTPOOL_H_
+
+#include <activemq/util/Config.h>
+#include <decaf/util/concurrent/Mutex.h>
+#include <decaf/util/zip/Deflater.h>
+#include <decaf/util/zip/Inflater.h>
+
+#include <vector>
+
+namespace activemq {
+namespace util {
+
+    /**
+     * Keeps the zlib contexts used to compress and decompress message bodies so that
+     * they are reset and used again rather than set up for every message, a Deflater
+     * carries a few hundred KB of state.  Only a few idle contexts of each kind are
+     * kept, any more than that are destroyed when they are given back.
+     *
+     * The data produced and accepted is a plain zlib stream, the same as written and
+     * read by DeflaterOutputStream and InflaterInputStream.
+     *
+     * This class is thread safe.
+     *
+     * @since 3.10.0
+     */
+    class AMQCPP_API CompressionContextPool {
+    private:
+
+        std::vector<decaf::util::zip::Deflater*> deflaters;
+        std::vector<decaf::util::zip::Inflater*> inflaters;
+
+        int maxIdle;
+
+        decaf::util::concurrent::Mutex mutex;
+
+    public:
+
+        static const int DEFAULT_MAX_IDLE;
+
+    private:
+
+        CompressionContextPool(const CompressionContextPool&);
+        CompressionContextPool& operator=(const CompressionContextPool&);
+
+    public:
+
+        /**
+         * Creates a pool that keeps up to DEFAULT_MAX_IDLE idle contexts of each kind.
+         */
+        CompressionContextPool();
+
+        /**
+         * Creates a pool that keeps up to the given number of idle contexts of each kind.
+         *
+         * @param maxIdle
+         *      The number of idle Deflaters and of idle Inflaters to keep.
+         */
+        CompressionContextPool(int maxIdle);
+
+        virtual ~CompressionContextPool();
+
+        /**
+         * Compresses the given bytes and appends the result to the output vector.
+         *
+         * @param data
+         *      The bytes to compress.
+         * @param length
+         *      The number of bytes to compress.
+         * @param level
+         *      The compression level, -1 for the zlib default or [0..9].
+         * @param out
+         *      The vector that the compressed bytes are appended to.
+         *
+         * @throws NullPointerException if the data is NULL.
+         * @throws IllegalArgumentException if the level is not valid.
+         */
+        void deflate(const unsigned char* data, int length, int level, std::vector<unsigned char>& out);
+
+        /**
+         * Decompresses the given zlib stream and appends the result to the output vector,
+         * reserving room in the vector up front avoids growing it when the size of the
+         * decompressed data is known.
+         *
+         * @param data
+         *      The compressed bytes.
+         * @param length
+         *      The number of compressed bytes.
+         * @param out
+         *      The vector that the decompressed bytes are appended to.
+         *
+         * @throws NullPointerException if the data is NULL.
+         * @throws DataFormatException if the data is not a complete zlib stream.
+         */
+        void inflate(const unsigned char* data, int length, std::vector<unsigned char>& out);
+
+        /**
+         * @return the number of idle contexts of each kind this pool keeps.
+         */
+        int getMaxIdle() const {
+            return this->maxIdle;
+        }
+
+    private:
+
+        decaf::util::zip::Deflater* takeDeflater(int level);
+
+        void giveBack(decaf::util::zip::Deflater* deflater);
+
+        decaf::util::zip::Inflater* takeInflater();
+
+        void giveBack(decaf::util::zip::Inflater* inflater);
+
+    };
+
+}}
+
+#endif /* _ACTIVEMQ_UTIL_COMPRESSIONCONTEXTPOOL_H_ */
@@ -22,3 +22,13 @@ using namespace activemq::wireformat;
 
 ////////////////////////////////////////////////////////////////////////////////
 WireFormat::~WireFormat() {}
+
+////////////////////////////////////////////////////////////////////////////////
+int WireFormat::getFrameLength(const unsigned char* buffer AMQCPP_UNUSED, int length AMQCPP_UNUSED) const {
+    return -1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool WireFormat::hasFrameLength() const {
+    return false;
+}
@@ -79,6 +79,34 @@ namespace wireformat {
         virtual Pointer<commands::Command> unmarshal(const activemq::transport::Transport* transport,
                                                      decaf::io::DataInputStream* in) = 0;
 
+        /**
+         * Reads the length of the frame that starts at the beginning of the bytes received
+         * so far, so that a transport which reads whatever the socket has can collect a
+         * whole frame before calling unmarshal.  Wire formats whose frames do not start
+         * with their length keep the default, which returns -1.
+         *
+         * @param buffer
+         *      The bytes received so far, starting with the first byte of a frame.
+         * @param length
+         *      The number of bytes in the buffer.
+         *
+         * @return the length of the whole frame, which can be larger than the bytes given,
+         *         0 if more bytes are needed to tell, or -1 if the frames of this wire
+         *         format cannot be measured.
+         *
+         * @throws IOException if the frame length read is invalid.
+         */
+        virtual int getFrameLength(const unsigned char* buffer, int length) const;
+
+        /**
+         * Tells a transport before it starts reading whether getFrameLength will be able
+         * to measure every frame, including those read after the wire format has been
+         * negotiated.  The default returns false.
+         *
+         * @return true if all frames this wire format reads start with their length.
+         */
+        virtual bool hasFrameLength() const;
+
         /**
          * Set the Version
          *
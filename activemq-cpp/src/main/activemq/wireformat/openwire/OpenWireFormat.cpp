@@ -22,12 +22,17 @@
 #include <decaf/lang/Long.h>
 #include <decaf/util/UUID.h>
 #include <decaf/lang/Math.h>
-#include <decaf/io/ByteArrayOutputStream.h>
+#include <decaf/lang/System.h>
+#include <decaf/io/OutputStream.h>
+#include <decaf/io/DataOutputStream.h>
+#include <decaf/lang/exceptions/NullPointerException.h>
+#include <decaf/lang/exceptions/IndexOutOfBoundsException.h>
 #include <activemq/wireformat/openwire/OpenWireFormatNegotiator.h>
 #include <activemq/wireformat/openwire/utils/BooleanStream.h>
 #include <activemq/wireformat/MarshalAware.h>
 #include <activemq/commands/WireFormatInfo.h>
 #include <activemq/commands/DataStructure.h>
+#include <activemq/commands/Message.h>
 #include <activemq/wireformat/openwire/marshal/DataStreamMarshaller.h>
 #include <activemq/wireformat/openwire/marshal/generated/MarshallerFactory.h>
 #include <activemq/exceptions/ActiveMQException.h>
@@ -52,11 +57,121 @@ const unsigned char OpenWireFormat::NULL_TYPE = 0;
 const int OpenWireFormat::DEFAULT_VERSION = 1;
 const int OpenWireFormat::MAX_SUPPORTED_VERSION = 11;
 
+////////////////////////////////////////////////////////////////////////////////
+namespace activemq {
+namespace wireformat {
+namespace openwire {
+
+    /**
+     * Growable byte buffer that a size prefixed loose encoded frame is built in.  Room
+     * for the size is reserved up front and filled in once the frame is complete so
+     * that the frame goes to the transport in one write without any extra copies.
+     */
+    class OpenWireFormat::LooseMarshalBuffer : public decaf::io::OutputStream {
+    private:
+
+        // Frames larger than this don't get to keep their buffer around after the write.
+        static const int MAX_RETAINED_CAPACITY = 64 * 1024;
+        static const int INITIAL_CAPACITY = 1024;
+        static const int SIZE_PREFIX_LENGTH = 4;
+
+        std::vector<unsigned char> buffer;
+        int count;
+        DataOutputStream dataOut;
+
+    private:
+
+        LooseMarshalBuffer(const LooseMarshalBuffer&);
+        LooseMarshalBuffer& operator=(const LooseMarshalBuffer&);
+
+    public:
+
+        LooseMarshalBuffer() : OutputStream(), buffer(INITIAL_CAPACITY), count(SIZE_PREFIX_LENGTH), dataOut(this, false) {
+        }
+
+        virtual ~LooseMarshalBuffer() {
+        }
+
+        /**
+         * Discards anything left from a previous frame and returns the stream that
+         * the next frame's content should be written to.
+         */
+        DataOutputStream* begin() {
+            this->count = SIZE_PREFIX_LENGTH;
+            return &this->dataOut;
+        }
+
+        /**
+         * Fills in the size prefix and writes the finished frame to the given stream.
+         *
+         * @return the size of the frame not counting the size prefix.
+         */
+        int writeTo(DataOutputStream* out) {
+
+            int size = this->count - SIZE_PREFIX_LENGTH;
+
+            this->buffer[0] = (unsigned char) ((size & 0xFF000000) >> 24);
+            this->buffer[1] = (unsigned char) ((size & 0x00FF0000) >> 16);
+            this->buffer[2] = (unsigned char) ((size & 0x0000FF00) >> 8);
+            this->buffer[3] = (unsigned char) ((size & 0x000000FF) >> 0);
+
+            out->write(&this->buffer[0], this->count);
+
+            this->count = SIZE_PREFIX_LENGTH;
+            if (this->buffer.size() > (std::size_t) MAX_RETAINED_CAPACITY) {
+                std::vector<unsigned char>(INITIAL_CAPACITY).swap(this->buffer);
+            }
+
+            return size;
+        }
+
+    protected:
+
+        virtual void doWriteByte(unsigned char value) {
+            ensureCapacity(1);
+            this->buffer[this->count++] = value;
+        }
+
+        virtual void doWriteArrayBounded(const unsigned char* source, int size, int offset, int length) {
+
+            if (length == 0) {
+                return;
+            }
+
+            if (source == NULL) {
+                throw NullPointerException(__FILE__, __LINE__, "passed buffer is null");
+            }
+
+            if (offset < 0 || length < 0 || offset > size || length > size - offset) {
+                throw IndexOutOfBoundsException(__FILE__, __LINE__,
+                    "offset %d and length %d are out of bounds for size %d.", offset, length, size);
+            }
+
+            ensureCapacity(length);
+            System::arraycopy(source, offset, &this->buffer[0], this->count, length);
+            this->count += length;
+        }
+
+    private:
+
+        void ensureCapacity(int needed) {
+            std::size_t required = (std::size_t) this->count + (std::size_t) needed;
+            if (required > this->buffer.size()) {
+                this->buffer.resize(Math::max((int) required, (int) this->buffer.size() * 2));
+            }
+        }
+
+    };
+
+}}}
+
 ////////////////////////////////////////////////////////////////////////////////
 OpenWireFormat::OpenWireFormat(const decaf::util::Properties& properties) :
     properties(properties), preferedWireFormatInfo(), dataMarshallers(256),
-    id(UUID::randomUUID().toString()), receiving(), version(0), stackTraceEnabled(true),
-    tcpNoDelayEnabled(true), cacheEnabled(true), cacheSize(1024), tightEncodingEnabled(false),
+    id(UUID::randomUUID().toString()), receiving(), marshalCache(1024),
+    looseBuffer(new LooseMarshalBuffer()), planBooleanStream(), planCacheIndices(), planPosition(0),
+    planObjects(), planObjectPosition(0), planActive(false), version(0), stackTraceEnabled(true),
+    tcpNoDelayEnabled(true), cacheEnabled(false), cacheSize(1024), tightEncodingEnabled(false),
     sizePrefixDisabled(false), maxInactivityDuration(30000), maxInactivityDurationInitialDelay(10000) {
 
     // initialize the universal marshalers, don't need to reset them again
@@ -74,6 +189,11 @@ OpenWireFormat::~OpenWireFormat() {
         this->destroyMarshalers();
     }
     AMQ_CATCHALL_NOTHROW()
+
+    try {
+        delete this->looseBuffer;
+    }
+    AMQ_CATCHALL_NOTHROW()
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -159,17 +279,33 @@ void OpenWireFormat::marshal(const Pointer<commands::Command> command, const act
             }
 
             if (tightEncodingEnabled) {
-                BooleanStream bs;
-                size += dsm->tightMarshal1(this, dataStructure, &bs);
-                size += bs.marshalledSize();
 
-                if (!sizePrefixDisabled) {
-                    dataOut->writeInt(size);
+                // The first pass fills in the plan, the second only writes it out.
+                BooleanStream* bs = &this->planBooleanStream;
+                bs->reset();
+                this->planCacheIndices.clear();
+                this->planPosition = 0;
+                this->planObjects.clear();
+                this->planObjectPosition = 0;
+                this->planActive = true;
+
+                try {
+                    size += dsm->tightMarshal1(this, dataStructure, bs);
+                    size += bs->marshalledSize();
+
+                    if (!sizePrefixDisabled) {
+                        dataOut->writeInt(size);
+                    }
+
+                    dataOut->writeByte(type);
+                    bs->marshal(dataOut);
+                    dsm->tightMarshal2(this, dataStructure, dataOut, bs);
+                } catch (...) {
+                    this->planActive = false;
+                    throw;
                 }
 
-                dataOut->writeByte(type);
-                bs.marshal(dataOut);
-                dsm->tightMarshal2(this, dataStructure, dataOut, &bs);
+                this->planActive = false;
 
             } else {
 
@@ -178,30 +314,20 @@ void OpenWireFormat::marshal(const Pointer<commands::Command> command, const act
                     dsm->looseMarshal(this, dataStructure, dataOut);
                 } else {
 
-                    ByteArrayOutputStream* baos = new ByteArrayOutputStream();
-                    std::auto_ptr<DataOutputStream> looseOut(new DataOutputStream(baos, true));
-
+                    // Build the frame in the scratch buffer so the size can be filled
+                    // in ahead of the content, then hand it to the transport whole.
+                    DataOutputStream* looseOut = this->looseBuffer->begin();
                     looseOut->writeByte(type);
-                    dsm->looseMarshal(this, dataStructure, looseOut.get());
-                    looseOut->close();
-
-                    // Now the data goes to the transport from out byte buffer.
-                    dataOut->writeInt((int) baos->size());
-
-                    if (baos->size() > 0) {
-                        std::pair<unsigned char*, int> array = baos->toByteArray();
-
-                        try {
-                            dataOut->write(array.first, array.second);
-                        } catch (Exception& ex) {
-                            delete[] array.first;
-                            throw;
-                        }
-
-                        delete[] array.first;
-                    }
+                    dsm->looseMarshal(this, dataStructure, looseOut);
+                    size = this->looseBuffer->writeTo(dataOut);
                 }
             }
+
+            // Messages remember what they cost on the wire, the failover message
+            // cache accounts for them by this rather than by an estimate.
+            if (command->isMessage() && (tightEncodingEnabled || !sizePrefixDisabled)) {
+                static_cast<commands::Message*>(command.get())->setMarshalledSize((unsigned int) size);
+            }
         } else {
             dataOut->writeInt(size);
             dataOut->writeByte(NULL_TYPE);
@@ -247,6 +373,38 @@ Pointer<commands::Command> OpenWireFormat::unmarshal(const activemq::transport::
     AMQ_CATCHALL_THROW(IOException)
 }
 
+////////////////////////////////////////////////////////////////////////////////
+int OpenWireFormat::getFrameLength(const unsigned char* buffer, int length) const {
+
+    if (sizePrefixDisabled) {
+        return -1;
+    }
+
+    if (length < 4) {
+        return 0;
+    }
+
+    // The size is a big endian int that does not count its own four bytes.
+    int size = (int) (((unsigned int) buffer[0] << 24) | ((unsigned int) buffer[1] << 16) |
+                      ((unsigned int) buffer[2] << 8) | (unsigned int) buffer[3]);
+
+    if (size < 0 || size > Integer::MAX_VALUE - 4) {
+        throw IOException(__FILE__, __LINE__, "Invalid frame size: %d", size);
+    }
+
+    return size + 4;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool OpenWireFormat::hasFrameLength() const {
+
+    if (sizePrefixDisabled) {
+        return false;
+    }
+
+    return preferedWireFormatInfo == NULL || !preferedWireFormatInfo->isSizePrefixDisabled();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 commands::DataStructure* OpenWireFormat::doUnmarshal(DataInputStream* dis) {
 
@@ -318,11 +476,23 @@ int OpenWireFormat::tightMarshalNestedObject1(commands::DataStructure* object, u
             return 0;
         }
 
+        // Claim this object's place in the plan before any of its fields add theirs.
+        std::size_t planned = this->planObjects.size();
+        if (this->planActive) {
+            this->planObjects.push_back(PlannedObject());
+        }
+
         if (object->isMarshalAware()) {
 
             std::vector<unsigned char> sequence = object->getMarshaledForm(this);
             bs->writeBoolean(!sequence.empty());
             if (!sequence.empty()) {
+                if (this->planActive) {
+                    this->planObjects[planned].type = object->getDataStructureType();
+                    this->planObjects[planned].marshaledForm.swap(sequence);
+                    return (int) (1 + this->planObjects[planned].marshaledForm.size());
+                }
+
                 return (int) (1 + sequence.size());
             }
         }
@@ -338,6 +508,11 @@ int OpenWireFormat::tightMarshalNestedObject1(commands::DataStructure* object, u
             throw IOException(__FILE__, __LINE__, (string("OpenWireFormat::marshal - Unknown data type: ") + Integer::toString(type)).c_str());
         }
 
+        if (this->planActive) {
+            this->planObjects[planned].type = type;
+            this->planObjects[planned].marshaller = dsm;
+        }
+
         return 1 + dsm->tightMarshal1(this, object, bs);
     }
     AMQ_CATCH_RETHROW(IOException)
@@ -355,6 +530,23 @@ void OpenWireFormat::tightMarshalNestedObject2(DataStructure* o, DataOutputStrea
             return;
         }
 
+        // Inside of marshal the first pass already resolved the type, marshaller and
+        // marshaled form, only the flags it left in the boolean stream are read back.
+        if (this->planActive && this->planObjectPosition < this->planObjects.size()) {
+
+            const PlannedObject& planned = this->planObjects[this->planObjectPosition++];
+
+            ds->writeByte(planned.type);
+
+            if (o->isMarshalAware() && bs->readBoolean()) {
+                ds->write(&planned.marshaledForm[0], (int) planned.marshaledForm.size());
+            } else {
+                planned.marshaller->tightMarshal2(this, o, ds, bs);
+            }
+
+            return;
+        }
+
         unsigned char type = o->getDataStructureType();
 
         ds->writeByte(type);
@@ -477,6 +669,48 @@ void OpenWireFormat::looseMarshalNestedObject(commands::DataStructure* o, decaf:
     AMQ_CATCHALL_THROW(IOException)
 }
 
+////////////////////////////////////////////////////////////////////////////////
+short OpenWireFormat::getMarshalCacheIndex(const commands::DataStructure* object) {
+    return this->marshalCache.getMarshalCacheIndex(object);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+short OpenWireFormat::peekMarshalCacheIndex(const commands::DataStructure* object) const {
+    return this->marshalCache.peekMarshalCacheIndex(object);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+short OpenWireFormat::addToMarshalCache(const commands::DataStructure* object) {
+    return this->marshalCache.addToMarshalCache(object);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void OpenWireFormat::setInUnmarshalCache(short index, const Pointer<commands::DataStructure>& object) {
+    this->marshalCache.setInUnmarshalCache(index, object);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Pointer<commands::DataStructure> OpenWireFormat::getFromUnmarshalCache(short index) {
+    return this->marshalCache.getFromUnmarshalCache(index);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void OpenWireFormat::addPlannedCacheIndex(short index) {
+    if (this->planActive) {
+        this->planCacheIndices.push_back(index);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+short OpenWireFormat::nextPlannedCacheIndex(const commands::DataStructure* object) {
+
+    if (this->planActive && this->planPosition < this->planCacheIndices.size()) {
+        return this->planCacheIndices[this->planPosition++];
+    }
+
+    return this->marshalCache.peekMarshalCacheIndex(object);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 void OpenWireFormat::renegotiateWireFormat(const WireFormatInfo& info) {
 
@@ -494,4 +728,7 @@ void OpenWireFormat::renegotiateWireFormat(const WireFormatInfo& info) {
     this->cacheSize = min(info.getCacheSize(), preferedWireFormatInfo->getCacheSize());
     this->maxInactivityDuration = min(info.getMaxInactivityDuration(), preferedWireFormatInfo->getMaxInactivityDuration());
     this->maxInactivityDurationInitialDelay = min(info.getMaxInactivityDurationInitalDelay(), preferedWireFormatInfo->getMaxInactivityDurationInitalDelay());
+
+    // Both ends start over with empty caches once the format is agreed on.
+    this->marshalCache.setCacheSize(this->cacheSize);
 }
@@ -23,6 +23,7 @@
 #include <activemq/commands/DataStructure.h>
 #include <activemq/wireformat/WireFormat.h>
 #include <activemq/wireformat/openwire/utils/BooleanStream.h>
+#include <activemq/wireformat/openwire/utils/MarshalCache.h>
 #include <decaf/lang/Pointer.h>
 #include <decaf/util/Properties.h>
 #include <decaf/util/concurrent/atomic/AtomicBoolean.h>
@@ -54,6 +55,18 @@ namespace marshal {
 
     private:
 
+        class LooseMarshalBuffer;
+
+        // What the first tight marshal pass settled on for one nested object, the
+        // second pass replays these in the same depth first order.
+        struct PlannedObject {
+            unsigned char type;
+            marshal::DataStreamMarshaller* marshaller;
+            std::vector<unsigned char> marshaledForm;
+
+            PlannedObject() : type(0), marshaller(NULL), marshaledForm() {}
+        };
+
         // Configuration parameters
         decaf::util::Properties properties;
 
@@ -69,6 +82,23 @@ namespace marshal {
         // Indicates when we are in the doUnmarshal call
         decaf::util::concurrent::atomic::AtomicBoolean receiving;
 
+        // Per connection marshal and unmarshal cache, used when cacheEnabled is set.
+        utils::MarshalCache marshalCache;
+
+        // Scratch buffer that size prefixed loose encoded frames are built in, reused
+        // between calls to marshal which the owning transport serializes.
+        LooseMarshalBuffer* looseBuffer;
+
+        // The marshal plan for tight encoding, the boolean stream, the cache indices and
+        // the marshaller resolved for each nested object in the first pass are kept so
+        // the second pass only has to write them out.  Reused between calls to marshal.
+        utils::BooleanStream planBooleanStream;
+        std::vector<short> planCacheIndices;
+        std::size_t planPosition;
+        std::vector<PlannedObject> planObjects;
+        std::size_t planObjectPosition;
+        bool planActive;
+
         // WireFormat Data
         int version;
         bool stackTraceEnabled;
@@ -80,6 +110,11 @@ namespace marshal {
         long long maxInactivityDuration;
         long long maxInactivityDurationInitialDelay;
 
+    private:
+
+        OpenWireFormat(const OpenWireFormat&);
+        OpenWireFormat& operator=(const OpenWireFormat&);
+
     public:
 
         /**
@@ -119,6 +154,22 @@ namespace marshal {
          */
         virtual Pointer<commands::Command> unmarshal(const activemq::transport::Transport* transport, decaf::io::DataInputStream* in);
 
+        /**
+         * Frames start with their size unless the size prefix is disabled, in which case
+         * the length cannot be measured and -1 is returned.
+         *
+         * {@inheritDoc}
+         */
+        virtual int getFrameLength(const unsigned char* buffer, int length) const;
+
+        /**
+         * Negotiation only disables the size prefix when the preferred WireFormatInfo
+         * asks for it, so that is checked along with the current setting.
+         *
+         * {@inheritDoc}
+         */
+        virtual bool hasFrameLength() const;
+
     public:
 
         /**
@@ -173,6 +224,96 @@ namespace marshal {
          */
         void looseMarshalNestedObject(commands::DataStructure* o, decaf::io::DataOutputStream* dataOut);
 
+        /**
+         * Gets the cache index that was assigned to an object equal to the one given when
+         * it was last marshaled, a successful lookup counts as a cache hit.
+         *
+         * @param object
+         *      The DataStructure that is about to be marshaled.
+         *
+         * @return the cache index or -1 if the object is not in the marshal cache.
+         */
+        short getMarshalCacheIndex(const commands::DataStructure* object);
+
+        /**
+         * Gets the cache index of the given object without updating the cache statistics
+         * or its eviction order.
+         *
+         * @param object
+         *      The DataStructure that is being marshaled.
+         *
+         * @return the cache index or -1 if the object is not in the marshal cache.
+         */
+        short peekMarshalCacheIndex(const commands::DataStructure* object) const;
+
+        /**
+         * Adds the given object to the marshal cache, evicting the least recently used
+         * entry when the cache is full.
+         *
+         * @param object
+         *      The DataStructure that is about to be marshaled in full.
+         *
+         * @return the index the remote end should store the object at, or -1.
+         */
+        short addToMarshalCache(const commands::DataStructure* object);
+
+        /**
+         * Stores an unmarshaled object at the cache index assigned by the remote end.
+         *
+         * @param index
+         *      The cache index read from the wire.
+         * @param object
+         *      The DataStructure that was unmarshaled in full.
+         *
+         * @throws IOException if the index is not valid.
+         */
+        void setInUnmarshalCache(short index, const Pointer<commands::DataStructure>& object);
+
+        /**
+         * Gets the object the remote end previously stored at the given index, it is
+         * shared with the cache rather than copied.
+         *
+         * @param index
+         *      The cache index read from the wire.
+         *
+         * @return the cached DataStructure, or NULL.
+         *
+         * @throws IOException if the index is not valid.
+         */
+        Pointer<commands::DataStructure> getFromUnmarshalCache(short index);
+
+        /**
+         * Records the cache index that the first tight marshal pass settled on for a
+         * cached field, the second pass then reads it back in the same order with
+         * nextPlannedCacheIndex.  Does nothing outside of a call to marshal.
+         *
+         * @param index
+         *      The cache index that will be written for the field.
+         */
+        void addPlannedCacheIndex(short index);
+
+        /**
+         * Gets the cache index to write for a cached field in the second tight marshal
+         * pass.  Inside a call to marshal this is the index recorded in the first pass,
+         * otherwise the marshal cache is consulted.
+         *
+         * @param object
+         *      The DataStructure that is being marshaled.
+         *
+         * @return the cache index or -1 if the object is not in the marshal cache.
+         */
+        short nextPlannedCacheIndex(const commands::DataStructure* object);
+
+        /**
+         * Gets the marshal cache used by this wire format, mainly so that its hit and
+         * miss counters can be inspected.
+         *
+         * @return a reference to this wire format's MarshalCache.
+         */
+        const utils::MarshalCache& getMarshalCache() const {
+            return this->marshalCache;
+        }
+
         /**
          * Called to re-negotiate the settings for the WireFormatInfo, these
          * determine how the client and broker communicate.
@@ -286,11 +427,12 @@ namespace marshal {
         }
 
         /**
-         * Sets the current Cache size.
+         * Sets the current Cache size, any currently cached entries are discarded.
          * @param value - the value to send as the broker's cache size.
          */
         void setCacheSize(int value) {
             this->cacheSize = value;
+            this->marshalCache.setCacheSize(value);
         }
 
         /**
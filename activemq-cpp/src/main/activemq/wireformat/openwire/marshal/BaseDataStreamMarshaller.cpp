@@ -48,6 +48,21 @@ utils::HexTable BaseDataStreamMarshaller::hexTable;
 ////////////////////////////////////////////////////////////////////////////////
 commands::DataStructure* BaseDataStreamMarshaller::tightUnmarshalCachedObject(OpenWireFormat* wireFormat, decaf::io::DataInputStream* dataIn,utils::BooleanStream* bs) {
     try {
+
+        if (wireFormat->isCacheEnabled()) {
+
+            if (bs->readBoolean()) {
+                short index = dataIn->readShort();
+                Pointer<DataStructure> data(wireFormat->tightUnmarshalNestedObject(dataIn, bs));
+                wireFormat->setInUnmarshalCache(index, data);
+                return data.release();
+            } else {
+                // The caller's Pointer shares the count held in the cached object.
+                short index = dataIn->readShort();
+                return wireFormat->getFromUnmarshalCache(index).release();
+            }
+        }
+
         return wireFormat->tightUnmarshalNestedObject(dataIn, bs);
     }
     AMQ_CATCH_RETHROW(IOException)
@@ -58,6 +73,23 @@ commands::DataStructure* BaseDataStreamMarshaller::tightUnmarshalCachedObject(Op
 ////////////////////////////////////////////////////////////////////////////////
 int BaseDataStreamMarshaller::tightMarshalCachedObject1(OpenWireFormat* wireFormat, commands::DataStructure* data, utils::BooleanStream* bs) {
     try {
+
+        if (wireFormat->isCacheEnabled()) {
+
+            short index = wireFormat->getMarshalCacheIndex(data);
+            bs->writeBoolean(index == -1);
+
+            if (index == -1) {
+                // Record the index before walking the object so the planned indices
+                // are in the order the second pass will ask for them.
+                wireFormat->addPlannedCacheIndex(wireFormat->addToMarshalCache(data));
+                return 2 + wireFormat->tightMarshalNestedObject1(data, bs);
+            }
+
+            wireFormat->addPlannedCacheIndex(index);
+            return 2;
+        }
+
         return wireFormat->tightMarshalNestedObject1(data, bs);
     }
     AMQ_CATCH_RETHROW(IOException)
@@ -68,6 +100,22 @@ int BaseDataStreamMarshaller::tightMarshalCachedObject1(OpenWireFormat* wireForm
 ////////////////////////////////////////////////////////////////////////////////
 void BaseDataStreamMarshaller::tightMarshalCachedObject2(OpenWireFormat* wireFormat, commands::DataStructure* data, decaf::io::DataOutputStream* dataOut,utils::BooleanStream* bs) {
     try {
+
+        if (wireFormat->isCacheEnabled()) {
+
+            // The index was assigned during the first pass.
+            short index = wireFormat->nextPlannedCacheIndex(data);
+
+            if (bs->readBoolean()) {
+                dataOut->writeShort(index);
+                wireFormat->tightMarshalNestedObject2(data, dataOut, bs);
+            } else {
+                dataOut->writeShort(index);
+            }
+
+            return;
+        }
+
         wireFormat->tightMarshalNestedObject2(data, dataOut, bs);
     }
     AMQ_CATCH_RETHROW(IOException)
@@ -78,6 +126,23 @@ void BaseDataStreamMarshaller::tightMarshalCachedObject2(OpenWireFormat* wireFor
 ////////////////////////////////////////////////////////////////////////////////
 void BaseDataStreamMarshaller::looseMarshalCachedObject(OpenWireFormat* wireFormat, commands::DataStructure* data, decaf::io::DataOutputStream* dataOut) {
     try {
+
+        if (wireFormat->isCacheEnabled()) {
+
+            short index = wireFormat->getMarshalCacheIndex(data);
+            dataOut->writeBoolean(index == -1);
+
+            if (index == -1) {
+                index = wireFormat->addToMarshalCache(data);
+                dataOut->writeShort(index);
+                wireFormat->looseMarshalNestedObject(data, dataOut);
+            } else {
+                dataOut->writeShort(index);
+            }
+
+            return;
+        }
+
         wireFormat->looseMarshalNestedObject(data, dataOut);
     }
     AMQ_CATCH_RETHROW(IOException)
@@ -88,6 +153,21 @@ void BaseDataStreamMarshaller::looseMarshalCachedObject(OpenWireFormat* wireForm
 ////////////////////////////////////////////////////////////////////////////////
 commands::DataStructure* BaseDataStreamMarshaller::looseUnmarshalCachedObject(OpenWireFormat* wireFormat, decaf::io::DataInputStream* dataIn) {
     try {
+
+        if (wireFormat->isCacheEnabled()) {
+
+            if (dataIn->readBoolean()) {
+                short index = dataIn->readShort();
+                Pointer<DataStructure> data(wireFormat->looseUnmarshalNestedObject(dataIn));
+                wireFormat->setInUnmarshalCache(index, data);
+                return data.release();
+            } else {
+                // The caller's Pointer shares the count held in the cached object.
+                short index = dataIn->readShort();
+                return wireFormat->getFromUnmarshalCache(index).release();
+            }
+        }
+
         return wireFormat->looseUnmarshalNestedObject(dataIn);
     }
     AMQ_CATCH_RETHROW(IOException)
@@ -612,6 +692,48 @@ std::vector<unsigned char> BaseDataStreamMarshaller::looseUnmarshalByteArray(dec
     AMQ_CATCHALL_THROW(IOException)
 }
 
+////////////////////////////////////////////////////////////////////////////////
+util::ByteSequence BaseDataStreamMarshaller::tightUnmarshalByteSequence(decaf::io::DataInputStream* dataIn, utils::BooleanStream* bs) {
+
+    try {
+
+        std::vector<unsigned char> data;
+        if (bs->readBoolean()) {
+            int size = dataIn->readInt();
+            if (size > 0) {
+                data.resize(size);
+                dataIn->readFully(&data[0], (int) data.size());
+            }
+        }
+
+        return util::ByteSequence::adopt(data);
+    }
+    AMQ_CATCH_RETHROW(IOException)
+    AMQ_CATCH_EXCEPTION_CONVERT(Exception, IOException)
+    AMQ_CATCHALL_THROW(IOException)
+}
+
+////////////////////////////////////////////////////////////////////////////////
+util::ByteSequence BaseDataStreamMarshaller::looseUnmarshalByteSequence(decaf::io::DataInputStream* dataIn) {
+
+    try {
+
+        std::vector<unsigned char> data;
+        if (dataIn->readBoolean()) {
+            int size = dataIn->readInt();
+            if (size > 0) {
+                data.resize(size);
+                dataIn->readFully(&data[0], (int) data.size());
+            }
+        }
+
+        return util::ByteSequence::adopt(data);
+    }
+    AMQ_CATCH_RETHROW(IOException)
+    AMQ_CATCH_EXCEPTION_CONVERT(Exception, IOException)
+    AMQ_CATCHALL_THROW(IOException)
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 std::vector<unsigned char> BaseDataStreamMarshaller::tightUnmarshalConstByteArray(decaf::io::DataInputStream* dataIn, utils::BooleanStream* bs AMQCPP_UNUSED,int size) {
 
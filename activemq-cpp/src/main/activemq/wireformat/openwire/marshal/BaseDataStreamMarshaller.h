@@ -23,6 +23,7 @@
 #include <activemq/commands/MessageId.h>
 #include <activemq/commands/ProducerId.h>
 #include <activemq/commands/TransactionId.h>
+#include <activemq/util/ByteSequence.h>
 #include <activemq/util/Config.h>
 
 namespace activemq{
@@ -350,6 +351,25 @@ namespace marshal{
          */
         virtual std::vector<unsigned char> looseUnmarshalByteArray(decaf::io::DataInputStream* dataIn);
 
+        /**
+         * Tight Unmarshal an array of char into a ByteSequence that holds the bytes
+         * read without copying them again.
+         * @param dataIn - the DataInputStream to Un-Marshal from
+         * @param bs - boolean stream to unmarshal from.
+         * @return the unmarshaled bytes.
+         * @throws IOException if an error occurs.
+         */
+        virtual util::ByteSequence tightUnmarshalByteSequence(decaf::io::DataInputStream* dataIn, utils::BooleanStream* bs);
+
+        /**
+         * Loose Unmarshal an array of char into a ByteSequence that holds the bytes
+         * read without copying them again.
+         * @param dataIn - the DataInputStream to Un-Marshal from
+         * @return the unmarshaled bytes.
+         * @throws IOException if an error occurs.
+         */
+        virtual util::ByteSequence looseUnmarshalByteSequence(decaf::io::DataInputStream* dataIn);
+
         /**
          * Tight Unmarshal a fixed size array from that data input stream
          * and return an stl vector of char as the resultant.
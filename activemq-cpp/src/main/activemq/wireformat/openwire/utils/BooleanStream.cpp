@@ -19,6 +19,8 @@
 
 #include <activemq/exceptions/ActiveMQException.h>
 
+#include <algorithm>
+
 using namespace std;
 using namespace activemq;
 using namespace activemq::exceptions;
@@ -171,6 +173,15 @@ void BooleanStream::clear() {
     bytePos = 0;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+void BooleanStream::reset() {
+
+    // Only the bytes that were in use can hold set bits.
+    std::fill( data.begin(), data.begin() + std::min( (size_t)arrayLimit, data.size() ), 0 );
+    arrayLimit = 0;
+    clear();
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 int BooleanStream::marshalledSize() {
 
@@ -113,6 +113,12 @@ namespace utils{
          */
         void clear();
 
+        /**
+         * Empties the stream so that it can be written again, the bits written
+         * previously are zeroed and the buffer is kept for reuse.
+         */
+        void reset();
+
         /**
          * Calc the size that data is marshalled to
          * @return int size of marshalled data.
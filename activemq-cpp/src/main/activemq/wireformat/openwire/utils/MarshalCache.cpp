@@ -0,0 +1,421 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MarshalCache.h"
+
+#include <activemq/exceptions/ActiveMQException.h>
+#include <activemq/commands/ActiveMQDestination.h>
+#include <activemq/commands/ActiveMQQueue.h>
+#include <activemq/commands/ActiveMQTempQueue.h>
+#include <activemq/commands/ActiveMQTempTopic.h>
+#include <activemq/commands/ActiveMQTopic.h>
+#include <activemq/commands/BrokerId.h>
+#include <activemq/commands/ConnectionId.h>
+#include <activemq/commands/ConsumerId.h>
+#include <activemq/commands/LocalTransactionId.h>
+#include <activemq/commands/ProducerId.h>
+#include <activemq/commands/SessionId.h>
+#include <activemq/commands/XATransactionId.h>
+#include <decaf/lang/Pointer.h>
+#include <decaf/lang/Short.h>
+#include <decaf/util/HashMap.h>
+#include <decaf/util/HashCode.h>
+#include <decaf/io/IOException.h>
+
+#include <vector>
+
+using namespace std;
+using namespace activemq;
+using namespace activemq::commands;
+using namespace activemq::exceptions;
+using namespace activemq::wireformat;
+using namespace activemq::wireformat::openwire;
+using namespace activemq::wireformat::openwire::utils;
+using namespace decaf::io;
+using namespace decaf::lang;
+using namespace decaf::util;
+
+////////////////////////////////////////////////////////////////////////////////
+const int MarshalCache::MAX_CACHE_SIZE = Short::MAX_VALUE / 2;
+const int MarshalCache::MIN_CACHE_SIZE = 16;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    /**
+     * Gets the hash code of one of the cacheable types from its own getHashCode, the
+     * DataStructure interface has none so the type is switched on here.  Anything
+     * else falls back to hashing its string form.
+     */
+    int hashCodeOf(const DataStructure* object) {
+
+        switch (object->getDataStructureType()) {
+            case ProducerId::ID_PRODUCERID:
+                return static_cast<const ProducerId*>(object)->getHashCode();
+            case ConsumerId::ID_CONSUMERID:
+                return static_cast<const ConsumerId*>(object)->getHashCode();
+            case SessionId::ID_SESSIONID:
+                return static_cast<const SessionId*>(object)->getHashCode();
+            case ConnectionId::ID_CONNECTIONID:
+                return static_cast<const ConnectionId*>(object)->getHashCode();
+            case BrokerId::ID_BROKERID:
+                return static_cast<const BrokerId*>(object)->getHashCode();
+            case LocalTransactionId::ID_LOCALTRANSACTIONID:
+                return static_cast<const LocalTransactionId*>(object)->getHashCode();
+            case XATransactionId::ID_XATRANSACTIONID:
+                return static_cast<const XATransactionId*>(object)->getHashCode();
+            case ActiveMQQueue::ID_ACTIVEMQQUEUE:
+            case ActiveMQTopic::ID_ACTIVEMQTOPIC:
+            case ActiveMQTempQueue::ID_ACTIVEMQTEMPQUEUE:
+            case ActiveMQTempTopic::ID_ACTIVEMQTEMPTOPIC:
+                return static_cast<const ActiveMQDestination*>(object)->getHashCode();
+            default:
+                return HashCode<std::string>()(object->toString());
+        }
+    }
+
+    /**
+     * Wraps a DataStructure pointer so that it can be used as a key in a HashMap,
+     * equality is by value and the hash is computed once up front.
+     */
+    class CacheKey {
+    private:
+
+        const DataStructure* object;
+        int hash;
+
+    public:
+
+        CacheKey() : object(NULL), hash(0) {
+        }
+
+        CacheKey(const DataStructure* object) : object(object), hash(0) {
+            if (object != NULL) {
+                hash = (int) object->getDataStructureType() * 31 + hashCodeOf(object);
+            }
+        }
+
+        CacheKey(const DataStructure* object, int hash) : object(object), hash(hash) {
+        }
+
+        int getHashCode() const {
+            return this->hash;
+        }
+
+        bool operator==(const CacheKey& other) const {
+            if (this->object == other.object) {
+                return true;
+            }
+
+            if (this->object == NULL || other.object == NULL || this->hash != other.hash) {
+                return false;
+            }
+
+            return this->object->getDataStructureType() == other.object->getDataStructureType() &&
+                   this->object->equals(other.object);
+        }
+    };
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+namespace activemq {
+namespace wireformat {
+namespace openwire {
+namespace utils {
+
+    class MarshalCacheImpl {
+    private:
+
+        MarshalCacheImpl(const MarshalCacheImpl&);
+        MarshalCacheImpl& operator=(const MarshalCacheImpl&);
+
+    public:
+
+        int cacheSize;
+
+        // Marshal side, index to object and object to index.
+        std::vector< Pointer<DataStructure> > marshalTable;
+        std::vector<CacheKey> marshalKeys;
+        HashMap<CacheKey, short> marshalIndex;
+
+        // LRU ordering of the used marshal slots, head is most recently used.
+        std::vector<int> lruPrev;
+        std::vector<int> lruNext;
+        int lruHead;
+        int lruTail;
+        int used;
+
+        // Unmarshal side, grows as the remote assigns indices.
+        std::vector< Pointer<DataStructure> > unmarshalTable;
+
+        long long marshalHits;
+        long long marshalMisses;
+        long long marshalEvictions;
+        long long unmarshalHits;
+        long long unmarshalMisses;
+
+    public:
+
+        MarshalCacheImpl() : cacheSize(0), marshalTable(), marshalKeys(), marshalIndex(),
+                             lruPrev(), lruNext(), lruHead(-1), lruTail(-1), used(0),
+                             unmarshalTable(), marshalHits(0), marshalMisses(0),
+                             marshalEvictions(0), unmarshalHits(0), unmarshalMisses(0) {
+        }
+
+        void reset(int size) {
+            this->cacheSize = size;
+            this->marshalIndex.clear();
+            this->marshalTable.clear();
+            this->marshalTable.resize(size);
+            this->marshalKeys.clear();
+            this->marshalKeys.resize(size);
+            this->lruPrev.assign(size, -1);
+            this->lruNext.assign(size, -1);
+            this->lruHead = -1;
+            this->lruTail = -1;
+            this->used = 0;
+            this->unmarshalTable.clear();
+        }
+
+        void unlink(int index) {
+            int prev = lruPrev[index];
+            int next = lruNext[index];
+
+            if (prev != -1) {
+                lruNext[prev] = next;
+            } else {
+                lruHead = next;
+            }
+
+            if (next != -1) {
+                lruPrev[next] = prev;
+            } else {
+                lruTail = prev;
+            }
+
+            lruPrev[index] = -1;
+            lruNext[index] = -1;
+        }
+
+        void pushFront(int index) {
+            lruPrev[index] = -1;
+            lruNext[index] = lruHead;
+
+            if (lruHead != -1) {
+                lruPrev[lruHead] = index;
+            }
+
+            lruHead = index;
+
+            if (lruTail == -1) {
+                lruTail = index;
+            }
+        }
+
+        void touch(int index) {
+            if (lruHead != index) {
+                unlink(index);
+                pushFront(index);
+            }
+        }
+
+        void checkUnmarshalIndex(short index) const {
+            if (index < 0 || index >= MarshalCache::MAX_CACHE_SIZE) {
+                throw IOException(__FILE__, __LINE__,
+                    "MarshalCache - Invalid cache index received: %d", (int) index);
+            }
+        }
+    };
+
+}}}}
+
+////////////////////////////////////////////////////////////////////////////////
+MarshalCache::MarshalCache(int cacheSize) : impl(new MarshalCacheImpl) {
+    this->setCacheSize(cacheSize);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+MarshalCache::~MarshalCache() {
+    try {
+        delete this->impl;
+    }
+    AMQ_CATCHALL_NOTHROW()
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int MarshalCache::getCacheSize() const {
+    return this->impl->cacheSize;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MarshalCache::setCacheSize(int cacheSize) {
+
+    if (cacheSize < MIN_CACHE_SIZE) {
+        cacheSize = MIN_CACHE_SIZE;
+    } else if (cacheSize > MAX_CACHE_SIZE) {
+        cacheSize = MAX_CACHE_SIZE;
+    }
+
+    this->impl->reset(cacheSize);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MarshalCache::clear() {
+    this->impl->reset(this->impl->cacheSize);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+short MarshalCache::getMarshalCacheIndex(const DataStructure* object) {
+
+    if (object == NULL) {
+        return -1;
+    }
+
+    CacheKey key(object);
+
+    if (!this->impl->marshalIndex.containsKey(key)) {
+        this->impl->marshalMisses++;
+        return -1;
+    }
+
+    short index = this->impl->marshalIndex.get(key);
+    this->impl->touch(index);
+    this->impl->marshalHits++;
+
+    return index;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+short MarshalCache::peekMarshalCacheIndex(const DataStructure* object) const {
+
+    if (object == NULL) {
+        return -1;
+    }
+
+    CacheKey key(object);
+
+    if (!this->impl->marshalIndex.containsKey(key)) {
+        return -1;
+    }
+
+    return this->impl->marshalIndex.get(key);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+short MarshalCache::addToMarshalCache(const DataStructure* object) {
+
+    if (object == NULL) {
+        return -1;
+    }
+
+    int index = 0;
+
+    if (this->impl->used < this->impl->cacheSize) {
+        index = this->impl->used++;
+    } else {
+        index = this->impl->lruTail;
+        this->impl->unlink(index);
+        this->impl->marshalIndex.remove(this->impl->marshalKeys[index]);
+        this->impl->marshalEvictions++;
+    }
+
+    CacheKey key(object);
+
+    // An object held by a Pointer counts its references in itself, so the table can
+    // hold one more of them.  Anything else may not outlive this call.
+    if (object->getReferenceCount() > 0) {
+        this->impl->marshalTable[index].reset(const_cast<DataStructure*>(object));
+    } else {
+        this->impl->marshalTable[index].reset(object->cloneDataStructure());
+    }
+
+    this->impl->marshalKeys[index] = CacheKey(this->impl->marshalTable[index].get(), key.getHashCode());
+    this->impl->marshalIndex.put(this->impl->marshalKeys[index], (short) index);
+    this->impl->pushFront(index);
+
+    return (short) index;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MarshalCache::setInUnmarshalCache(short index, const Pointer<DataStructure>& object) {
+
+    this->impl->unmarshalMisses++;
+
+    // The sender had no room for it, nothing to store.
+    if (index == -1) {
+        return;
+    }
+
+    this->impl->checkUnmarshalIndex(index);
+
+    if ((int) this->impl->unmarshalTable.size() <= index) {
+        this->impl->unmarshalTable.resize(index + 1);
+    }
+
+    this->impl->unmarshalTable[index] = object;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+Pointer<DataStructure> MarshalCache::getFromUnmarshalCache(short index) {
+
+    this->impl->checkUnmarshalIndex(index);
+    this->impl->unmarshalHits++;
+
+    if ((int) this->impl->unmarshalTable.size() <= index) {
+        return Pointer<DataStructure>();
+    }
+
+    return this->impl->unmarshalTable[index];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long long MarshalCache::getMarshalHits() const {
+    return this->impl->marshalHits;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long long MarshalCache::getMarshalMisses() const {
+    return this->impl->marshalMisses;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long long MarshalCache::getMarshalEvictions() const {
+    return this->impl->marshalEvictions;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long long MarshalCache::getUnmarshalHits() const {
+    return this->impl->unmarshalHits;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long long MarshalCache::getUnmarshalMisses() const {
+    return this->impl->unmarshalMisses;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+double MarshalCache::getMarshalHitRatio() const {
+
+    long long total = this->impl->marshalHits + this->impl->marshalMisses;
+
+    if (total == 0) {
+        return 0.0;
+    }
+
+    return (double) this->impl->marshalHits / (double) total;
+}
@@ -0,0 +1,204 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_WIREFORMAT_OPENWIRE_UTILS_MARSHALCACHE_H_
+#define _ACTIVEMQ_WIREFORMAT_OPENWIRE_UTILS_MARSHALCACHE_H_
+
+#include <activemq/util/Config.h>
+#include <activemq/commands/DataStructure.h>
+#include <decaf/lang/Pointer.h>
+
+namespace activemq {
+namespace wireformat {
+namespace openwire {
+namespace utils {
+
+    class MarshalCacheImpl;
+
+    /**
+     * Holds the per connection state of the OpenWire marshal cache.  When caching is
+     * negotiated the cacheable fields of a command (ProducerId, ConsumerId, destinations
+     * and so on) are sent in full only the first time, along with a cache index, after
+     * which only the index is written.
+     *
+     * The marshal side keeps a table of index to object along with a hashed object to
+     * index map, entries are evicted in least recently used order once the table fills
+     * and the freed index is handed to the next object, the remote end simply overwrites
+     * whatever it held at that index.  The unmarshal side is a plain index to object
+     * table filled in from what the remote end sends.
+     *
+     * The two halves share no state so the marshal side may be used from the writer
+     * thread while the unmarshal side is used by the reader thread, each half on its
+     * own must be used by only one thread at a time.
+     *
+     * Cached objects are shared with the commands that carry them instead of copied,
+     * they are ids and destinations that are never changed once they have been sent
+     * or received.
+     *
+     * @since 3.10.0
+     */
+    class AMQCPP_API MarshalCache {
+    public:
+
+        /**
+         * The largest index the broker will accept, leaves room for the -1 value that
+         * means the object was not cached.
+         */
+        static const int MAX_CACHE_SIZE;
+
+        /**
+         * Lower bound on the marshal table size, a single command can carry several
+         * cached fields and they must all stay in the table between the two tight
+         * marshal passes.
+         */
+        static const int MIN_CACHE_SIZE;
+
+    private:
+
+        MarshalCacheImpl* impl;
+
+    private:
+
+        MarshalCache(const MarshalCache&);
+        MarshalCache& operator=(const MarshalCache&);
+
+    public:
+
+        /**
+         * Creates a new cache whose marshal table holds at most cacheSize entries.
+         *
+         * @param cacheSize
+         *      The number of entries the marshal table can hold.
+         */
+        MarshalCache(int cacheSize);
+
+        virtual ~MarshalCache();
+
+        /**
+         * @return the number of entries the marshal table can hold.
+         */
+        int getCacheSize() const;
+
+        /**
+         * Sets the size of the marshal table, the value is clamped to the range
+         * [MIN_CACHE_SIZE, MAX_CACHE_SIZE].  Both tables are cleared.
+         *
+         * @param cacheSize
+         *      The number of entries the marshal table can hold.
+         */
+        void setCacheSize(int cacheSize);
+
+        /**
+         * Clears the marshal and unmarshal tables, the counters are not reset.
+         */
+        void clear();
+
+        /**
+         * Looks up the cache index of the given object, a successful lookup marks
+         * the entry as most recently used and is counted as a hit.
+         *
+         * @param object
+         *      The object to look up, can be NULL.
+         *
+         * @return the cache index or -1 if the object is not cached.
+         */
+        short getMarshalCacheIndex(const commands::DataStructure* object);
+
+        /**
+         * Looks up the cache index of the given object without touching the LRU order
+         * or the counters, used by the second pass of tight marshaling to fetch the
+         * index assigned in the first pass.
+         *
+         * @param object
+         *      The object to look up, can be NULL.
+         *
+         * @return the cache index or -1 if the object is not cached.
+         */
+        short peekMarshalCacheIndex(const commands::DataStructure* object) const;
+
+        /**
+         * Assigns a cache index to the given object, evicting the least recently
+         * used entry if the table is full.  An object already held by a Pointer is
+         * stored as another reference to it, any other object is copied.
+         *
+         * @param object
+         *      The object to add, NULL objects are never cached.
+         *
+         * @return the assigned index or -1 if the object was not cached.
+         */
+        short addToMarshalCache(const commands::DataStructure* object);
+
+        /**
+         * Stores the given object at the index the remote end assigned.
+         *
+         * @param index
+         *      The index read from the wire, -1 means the sender did not cache it.
+         * @param object
+         *      The unmarshaled object, can be NULL.
+         *
+         * @throws IOException if the index is out of range.
+         */
+        void setInUnmarshalCache(short index, const decaf::lang::Pointer<commands::DataStructure>& object);
+
+        /**
+         * Gets the object held at the given index, it is shared with the cache and
+         * every command it was handed to before.
+         *
+         * @param index
+         *      The index read from the wire.
+         *
+         * @return the cached object, or NULL.
+         *
+         * @throws IOException if the index is out of range.
+         */
+        decaf::lang::Pointer<commands::DataStructure> getFromUnmarshalCache(short index);
+
+        /**
+         * @return the number of marshal lookups that found a cached index.
+         */
+        long long getMarshalHits() const;
+
+        /**
+         * @return the number of marshal lookups that had to send the full object.
+         */
+        long long getMarshalMisses() const;
+
+        /**
+         * @return the number of marshal entries evicted to make room for new ones.
+         */
+        long long getMarshalEvictions() const;
+
+        /**
+         * @return the number of unmarshaled fields that were read by index only.
+         */
+        long long getUnmarshalHits() const;
+
+        /**
+         * @return the number of unmarshaled fields that carried the full object.
+         */
+        long long getUnmarshalMisses() const;
+
+        /**
+         * @return the fraction of marshal lookups that were hits, zero if there were none.
+         */
+        double getMarshalHitRatio() const;
+
+    };
+
+}}}}
+
+#endif /* _ACTIVEMQ_WIREFORMAT_OPENWIRE_UTILS_MARSHALCACHE_H_ */
@@ -34,21 +34,15 @@ using namespace decaf::lang;
 using namespace decaf::lang::exceptions;
 
 ////////////////////////////////////////////////////////////////////////////////
-MessagePropertyInterceptor::MessagePropertyInterceptor(commands::Message* message, PrimitiveMap* properties) :
-    message(message), properties(properties) {
+MessagePropertyInterceptor::MessagePropertyInterceptor(commands::Message* message) : message(message) {
 
     if (message == NULL) {
         throw NullPointerException(__FILE__, __LINE__, "Message passed was NULL");
     }
-
-    if (properties == NULL) {
-        throw NullPointerException(__FILE__, __LINE__, "PrimitiveMap passed was NULL");
-    }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-MessagePropertyInterceptor::MessagePropertyInterceptor(const MessagePropertyInterceptor&) :
-    message(NULL), properties(NULL) {
+MessagePropertyInterceptor::MessagePropertyInterceptor(const MessagePropertyInterceptor&) : message(NULL) {
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -69,7 +63,7 @@ bool MessagePropertyInterceptor::getBooleanProperty(const std::string& name) con
         return message->isJMSXGroupFirstForConsumer();
     }
 
-    return this->properties->getBool(name);
+    return this->readProperties().getBool(name);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -80,7 +74,7 @@ unsigned char MessagePropertyInterceptor::getByteProperty(const std::string& nam
         throw ActiveMQException(__FILE__, __LINE__, "Cannot Convert Reserved Property to this Type.");
     }
 
-    return this->properties->getByte(name);
+    return this->readProperties().getByte(name);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -91,7 +85,7 @@ double MessagePropertyInterceptor::getDoubleProperty(const std::string& name) co
         throw ActiveMQException(__FILE__, __LINE__, "Cannot Convert Reserved Property to this Type.");
     }
 
-    return this->properties->getDouble(name);
+    return this->readProperties().getDouble(name);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -103,7 +97,7 @@ float MessagePropertyInterceptor::getFloatProperty(const std::string& name) cons
         throw ActiveMQException(__FILE__, __LINE__, "Cannot Convert Reserved Property to this Type.");
     }
 
-    return this->properties->getFloat(name);
+    return this->readProperties().getFloat(name);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -117,7 +111,7 @@ int MessagePropertyInterceptor::getIntProperty(const std::string& name) const {
         return this->message->getGroupSequence();
     }
 
-    return this->properties->getInt(name);
+    return this->readProperties().getInt(name);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -131,7 +125,7 @@ long long MessagePropertyInterceptor::getLongProperty(const std::string& name) c
         return (long long) this->message->getGroupSequence();
     }
 
-    return this->properties->getLong(name);
+    return this->readProperties().getLong(name);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -143,7 +137,7 @@ short MessagePropertyInterceptor::getShortProperty(const std::string& name) cons
         throw ActiveMQException(__FILE__, __LINE__, "Cannot Convert Reserved Property to this Type.");
     }
 
-    return this->properties->getShort(name);
+    return this->readProperties().getShort(name);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -159,7 +153,7 @@ std::string MessagePropertyInterceptor::getStringProperty(const std::string& nam
         return Boolean::toString(message->isJMSXGroupFirstForConsumer());
     }
 
-    return this->properties->getString(name);
+    return this->readProperties().getString(name);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -171,7 +165,7 @@ void MessagePropertyInterceptor::setBooleanProperty(const std::string& name, boo
         return message->setJMSXGroupFirstForConsumer(value);
     }
 
-    this->properties->setBool(name, value);
+    this->writeProperties().setBool(name, value);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -181,7 +175,7 @@ void MessagePropertyInterceptor::setByteProperty(const std::string& name, unsign
         throw ActiveMQException(__FILE__, __LINE__, "Cannot Convert Reserved Property to this Type.");
     }
 
-    this->properties->setByte(name, value);
+    this->writeProperties().setByte(name, value);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -191,7 +185,7 @@ void MessagePropertyInterceptor::setDoubleProperty(const std::string& name, doub
         throw ActiveMQException(__FILE__, __LINE__, "Cannot Convert Reserved Property to this Type.");
     }
 
-    this->properties->setDouble(name, value);
+    this->writeProperties().setDouble(name, value);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -203,7 +197,7 @@ void MessagePropertyInterceptor::setFloatProperty(const std::string& name, float
         throw ActiveMQException(__FILE__, __LINE__, "Cannot Convert Reserved Property to this Type.");
     }
 
-    this->properties->setFloat(name, value);
+    this->writeProperties().setFloat(name, value);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -217,7 +211,7 @@ void MessagePropertyInterceptor::setIntProperty(const std::string& name, int val
         this->message->setGroupSequence(value);
     }
 
-    this->properties->setInt(name, value);
+    this->writeProperties().setInt(name, value);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -226,7 +220,7 @@ void MessagePropertyInterceptor::setLongProperty(const std::string& name, long l
         throw ActiveMQException(__FILE__, __LINE__, "Cannot Convert Reserved Property to this Type.");
     }
 
-    this->properties->setLong(name, value);
+    this->writeProperties().setLong(name, value);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -240,7 +234,7 @@ void MessagePropertyInterceptor::setShortProperty(const std::string& name, short
         this->message->setGroupSequence((int) value);
     }
 
-    this->properties->setShort(name, value);
+    this->writeProperties().setShort(name, value);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -256,5 +250,18 @@ void MessagePropertyInterceptor::setStringProperty(const std::string& name, cons
         this->message->setJMSXGroupFirstForConsumer(Boolean::parseBoolean(value));
     }
 
-    this->properties->setString(name, value);
+    this->writeProperties().setString(name, value);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+const PrimitiveMap& MessagePropertyInterceptor::readProperties() const {
+    // Reads go through the const accessor so a received message keeps its
+    // original property encoding for re-marshaling.
+    const commands::Message* source = this->message;
+    return source->getMessageProperties();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+PrimitiveMap& MessagePropertyInterceptor::writeProperties() {
+    return this->message->getMessageProperties();
 }
@@ -48,7 +48,6 @@ namespace utils {
     private:
 
         commands::Message* message;
-        util::PrimitiveMap* properties;
 
     private:
 
@@ -59,14 +58,15 @@ namespace utils {
 
         /**
          * Constructor, accepts the Message that will be used to store JMS reserved
-         * property values, and the PrimitiveMap to get and set the rest to.
+         * property values, the rest are stored in the Message's properties map.  The
+         * map is always reached through the Message so that properties the Message
+         * has not yet decoded are decoded on first use.
          *
-         * @param message - The Message to store reserved property data in
-         * @param properties - The PrimitiveMap to store the rest of the properties in.
+         * @param message - The Message to store property data in
          *
-         * @throws NullPointerException if either param is NULL
+         * @throws NullPointerException if message is NULL
          */
-        MessagePropertyInterceptor( commands::Message* message, util::PrimitiveMap* properties );
+        MessagePropertyInterceptor( commands::Message* message );
 
         virtual ~MessagePropertyInterceptor();
 
@@ -182,6 +182,12 @@ namespace utils {
          */
         virtual void setStringProperty( const std::string& name, const std::string& value );
 
+    private:
+
+        const util::PrimitiveMap& readProperties() const;
+
+        util::PrimitiveMap& writeProperties();
+
     };
 
 }}}}
@@ -0,0 +1,248 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "StompFrameDecoder.h"
+
+#include <activemq/wireformat/stomp/StompCommandConstants.h>
+#include <activemq/exceptions/ExceptionDefines.h>
+
+#include <decaf/io/EOFException.h>
+#include <decaf/io/IOException.h>
+#include <decaf/lang/Character.h>
+#include <decaf/lang/Integer.h>
+#include <decaf/lang/exceptions/IllegalArgumentException.h>
+
+#include <algorithm>
+#include <string.h>
+
+using namespace std;
+using namespace activemq;
+using namespace activemq::wireformat;
+using namespace activemq::wireformat::stomp;
+using namespace decaf;
+using namespace decaf::io;
+using namespace decaf::lang;
+using namespace decaf::lang::exceptions;
+using namespace decaf::util;
+
+////////////////////////////////////////////////////////////////////////////////
+const int StompFrameDecoder::DEFAULT_BUFFER_SIZE = 8192;
+
+////////////////////////////////////////////////////////////////////////////////
+StompFrameDecoder::StompFrameDecoder() : buffer(DEFAULT_BUFFER_SIZE), position(0), limit(0), source(NULL) {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+StompFrameDecoder::StompFrameDecoder(int bufferSize) : buffer(), position(0), limit(0), source(NULL) {
+
+    if (bufferSize <= 0) {
+        throw IllegalArgumentException(__FILE__, __LINE__, "Buffer size must be greater than zero");
+    }
+
+    this->buffer.resize((std::size_t) bufferSize);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+StompFrameDecoder::~StompFrameDecoder() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void StompFrameDecoder::reset() {
+    this->position = 0;
+    this->limit = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void StompFrameDecoder::decode(DataInputStream* in, StompFrame& frame) {
+
+    if (in == NULL) {
+        throw decaf::io::IOException(__FILE__, __LINE__, "DataInputStream passed is NULL");
+    }
+
+    try {
+
+        if (in != this->source) {
+            this->reset();
+            this->source = in;
+        }
+
+        // Skip the blank lines ahead of the command, these are heart beats or the
+        // newline that follows the null terminating the previous frame.
+        while (true) {
+
+            std::size_t length = this->findLine(in);
+            const char* line = reinterpret_cast<const char*>(&this->buffer[this->position]);
+
+            std::size_t offset = 0;
+            while (offset < length && Character::isWhitespace(line[offset])) {
+                offset++;
+            }
+
+            this->position += length + 1;
+
+            if (offset < length) {
+                frame.setCommand(std::string(line + offset, length - offset));
+                break;
+            }
+        }
+
+        // Headers run up to the first empty line, the first value given for a key
+        // is the one that is kept.
+        Properties& properties = frame.getProperties();
+
+        while (true) {
+
+            std::size_t length = this->findLine(in);
+            const char* line = reinterpret_cast<const char*>(&this->buffer[this->position]);
+
+            this->position += length + 1;
+
+            if (length == 0) {
+                break;
+            }
+
+            const char* separator = static_cast<const char*>(::memchr(line, ':', length));
+            if (separator != NULL) {
+                std::string key(line, separator);
+                if (!properties.hasProperty(key)) {
+                    properties.setProperty(key, std::string(separator + 1, line + length));
+                }
+            }
+        }
+
+        std::vector<unsigned char>& body = frame.getBody();
+        body.clear();
+
+        std::size_t contentLength = 0;
+        if (frame.hasProperty(StompCommandConstants::HEADER_CONTENTLENGTH)) {
+            contentLength = (unsigned int) Integer::parseInt(
+                frame.getProperty(StompCommandConstants::HEADER_CONTENTLENGTH));
+        }
+
+        if (contentLength != 0) {
+
+            body.resize(contentLength);
+
+            // Take what has already been buffered, anything beyond that is read
+            // straight into the body rather than passing through the buffer.
+            std::size_t buffered = std::min(contentLength, this->limit - this->position);
+            if (buffered > 0) {
+                ::memcpy(&body[0], &this->buffer[this->position], buffered);
+                this->position += buffered;
+            }
+
+            if (buffered < contentLength) {
+                in->readFully(&body[buffered], (int) (contentLength - buffered));
+            }
+
+            if (this->position == this->limit) {
+                this->fill(in);
+            }
+
+            if (this->buffer[this->position++] != '\0') {
+                throw decaf::io::IOException(__FILE__, __LINE__, "StompFrameDecoder::decode - "
+                        "Read Content Length, and no trailing null");
+            }
+
+        } else {
+
+            // Without a length the body runs up to and includes the first null.
+            std::size_t terminator = this->findNull(in);
+            body.assign(this->buffer.begin() + this->position, this->buffer.begin() + terminator + 1);
+            this->position = terminator + 1;
+        }
+    }
+    AMQ_CATCH_RETHROW(decaf::io::IOException)
+    AMQ_CATCH_EXCEPTION_CONVERT(decaf::lang::Exception, decaf::io::IOException)
+    AMQ_CATCHALL_THROW(decaf::io::IOException)
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::size_t StompFrameDecoder::findLine(DataInputStream* in) {
+
+    // Only the bytes that arrived since the last search are scanned again.
+    std::size_t scanned = 0;
+
+    while (true) {
+
+        std::size_t available = this->limit - this->position;
+
+        if (scanned < available) {
+            const unsigned char* start = &this->buffer[this->position];
+            const void* found = ::memchr(start + scanned, '\n', available - scanned);
+
+            if (found != NULL) {
+                return (std::size_t) (static_cast<const unsigned char*>(found) - start);
+            }
+
+            scanned = available;
+        }
+
+        this->fill(in);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+std::size_t StompFrameDecoder::findNull(DataInputStream* in) {
+
+    std::size_t scanned = 0;
+
+    while (true) {
+
+        std::size_t available = this->limit - this->position;
+
+        if (scanned < available) {
+            const unsigned char* start = &this->buffer[this->position];
+            const void* found = ::memchr(start + scanned, '\0', available - scanned);
+
+            if (found != NULL) {
+                return this->position + (std::size_t) (static_cast<const unsigned char*>(found) - start);
+            }
+
+            scanned = available;
+        }
+
+        this->fill(in);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void StompFrameDecoder::fill(DataInputStream* in) {
+
+    if (this->position > 0) {
+        std::size_t remaining = this->limit - this->position;
+        if (remaining > 0) {
+            ::memmove(&this->buffer[0], &this->buffer[this->position], remaining);
+        }
+
+        this->position = 0;
+        this->limit = remaining;
+    }
+
+    if (this->limit == this->buffer.size()) {
+        this->buffer.resize(this->buffer.size() * 2);
+    }
+
+    int count = in->read(&this->buffer[0], (int) this->buffer.size(),
+                         (int) this->limit, (int) (this->buffer.size() - this->limit));
+
+    if (count < 0) {
+        throw EOFException(__FILE__, __LINE__, "StompFrameDecoder::fill - Reached EOF");
+    }
+
+    this->limit += (std::size_t) count;
+}
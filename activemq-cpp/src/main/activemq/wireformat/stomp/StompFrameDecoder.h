@@ -0,0 +1,133 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_WIREFORMAT_STOMP_STOMPFRAMEDECODER_H_
+#define _ACTIVEMQ_WIREFORMAT_STOMP_STOMPFRAMEDECODER_H_
+
+#include <activemq/util/Config.h>
+#include <activemq/wireformat/stomp/StompFrame.h>
+
+#include <decaf/io/DataInputStream.h>
+
+#include <vector>
+
+namespace activemq {
+namespace wireformat {
+namespace stomp {
+
+    /**
+     * Reads Stomp Frames from a stream through a receive buffer instead of a byte at
+     * a time.  The buffer is refilled with one bulk read whenever it runs dry and the
+     * line, header separator and frame terminator are located with memchr, so each
+     * header key and value is copied into its string exactly once.  A body whose size
+     * is given by the content-length header is copied straight from the buffer, or
+     * read directly into the frame when it is larger than the buffer.
+     *
+     * Bytes read past the end of one frame are kept for the next call to decode, so a
+     * decoder must always be used with the same stream.  When it is handed a different
+     * stream any bytes left over from the previous one are discarded.
+     *
+     * For any well formed input the Frames produced are identical to those read by
+     * StompFrame::fromStream.
+     *
+     * @since 3.10.0
+     */
+    class AMQCPP_API StompFrameDecoder {
+    public:
+
+        /**
+         * Size of the receive buffer used when none is given.
+         */
+        static const int DEFAULT_BUFFER_SIZE;
+
+    private:
+
+        std::vector<unsigned char> buffer;
+
+        // Offset of the first byte not yet decoded.
+        std::size_t position;
+
+        // Offset one past the last byte read from the stream.
+        std::size_t limit;
+
+        const decaf::io::DataInputStream* source;
+
+    private:
+
+        StompFrameDecoder(const StompFrameDecoder&);
+        StompFrameDecoder& operator=(const StompFrameDecoder&);
+
+    public:
+
+        StompFrameDecoder();
+
+        /**
+         * Creates a decoder whose receive buffer starts out at the given size, the
+         * buffer grows when a single line or unbounded body does not fit in it.
+         *
+         * @param bufferSize
+         *      The initial size of the receive buffer.
+         *
+         * @throw IllegalArgumentException if the size is less than one.
+         */
+        StompFrameDecoder(int bufferSize);
+
+        virtual ~StompFrameDecoder();
+
+        /**
+         * Reads the next Frame from the stream into the given Frame, blocking until
+         * the whole Frame has been received.
+         *
+         * @param in
+         *      The stream to read the Frame from.
+         * @param frame
+         *      The Frame that receives the command, headers and body read.
+         *
+         * @throw IOException if an error occurs while reading the Frame.
+         */
+        void decode(decaf::io::DataInputStream* in, StompFrame& frame);
+
+        /**
+         * @return the number of bytes read from the stream that have not yet been decoded.
+         */
+        std::size_t getBufferedSize() const {
+            return this->limit - this->position;
+        }
+
+        /**
+         * Discards any bytes that were read but not yet decoded.
+         */
+        void reset();
+
+    private:
+
+        // Returns the length of the next line, not counting its '\n', with the line
+        // starting at position.  The terminator is not consumed.
+        std::size_t findLine(decaf::io::DataInputStream* in);
+
+        // Returns the offset of the next '\0' at or after position.
+        std::size_t findNull(decaf::io::DataInputStream* in);
+
+        // Reads more bytes from the stream, moving the undecoded bytes to the start of
+        // the buffer first and growing the buffer when it is already full.
+        void fill(decaf::io::DataInputStream* in);
+
+    };
+
+}}}
+
+#endif /* _ACTIVEMQ_WIREFORMAT_STOMP_STOMPFRAMEDECODER_H_ */
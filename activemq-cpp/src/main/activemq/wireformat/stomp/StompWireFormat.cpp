@@ -18,6 +18,7 @@
 #include "StompWireFormat.h"
 
 #include <activemq/wireformat/stomp/StompFrame.h>
+#include <activemq/wireformat/stomp/StompFrameDecoder.h>
 #include <activemq/wireformat/stomp/StompHelper.h>
 #include <activemq/wireformat/stomp/StompCommandConstants.h>
 #include <activemq/core/ActiveMQConstants.h>
@@ -83,13 +84,17 @@ namespace stomp {
         // Prefix used to address Temporary Queues (default is /temp-queue/
         std::string tempQueuePrefix;
 
+        // Buffers the input stream and holds any bytes read past the current frame.
+        StompFrameDecoder decoder;
+
     public:
 
         StompWireformatProperties() : connectResponseId(-1),
                                       topicPrefix("/topic/"),
                                       queuePrefix("/queue/"),
                                       tempTopicPrefix("/temp-topic/"),
-                                      tempQueuePrefix("/temp-queue/") {
+                                      tempQueuePrefix("/temp-queue/"),
+                                      decoder() {
 
         }
 
@@ -188,8 +193,8 @@ Pointer<Command> StompWireFormat::unmarshal(const activemq::transport::Transport
         // Create a new Frame for reading to.
         frame.reset(new StompFrame());
 
-        // Read the command header.
-        frame->fromStream(in);
+        // Read the command, headers and body.
+        this->properties->decoder.decode(in, *frame);
 
         // Return the Command.
         const std::string commandId = frame->getCommand();
@@ -259,7 +264,7 @@ Pointer<Command> StompWireFormat::unmarshalMessage(const Pointer<StompFrame> fra
         Pointer<ActiveMQBytesMessage> message(new ActiveMQBytesMessage());
         frame->removeProperty(StompCommandConstants::HEADER_CONTENTLENGTH);
         helper->convertProperties(frame, message);
-        message->setContent(frame->getBody());
+        message->setContentBytes(activemq::util::ByteSequence::adopt(frame->getBody()));
         messageDispatch->setMessage(message);
         messageDispatch->setDestination(message->getDestination());
 
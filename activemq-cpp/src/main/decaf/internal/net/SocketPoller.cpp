@@ -0,0 +1,213 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "SocketPoller.h"
+
+#include <decaf/internal/AprPool.h>
+#include <decaf/internal/net/SocketFileDescriptor.h>
+#include <decaf/net/SocketError.h>
+#include <decaf/util/StlMap.h>
+#include <decaf/util/concurrent/Mutex.h>
+
+#include <apr_poll.h>
+#include <apr_portable.h>
+
+using namespace decaf;
+using namespace decaf::internal;
+using namespace decaf::internal::net;
+using namespace decaf::io;
+using namespace decaf::lang;
+using namespace decaf::net;
+using namespace decaf::util;
+using namespace decaf::util::concurrent;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace decaf {
+namespace internal {
+namespace net {
+
+    /**
+     * The APR view of a registered Socket, it has its own pool so the memory is
+     * returned when the Socket is removed.
+     */
+    class SocketRegistration {
+    private:
+
+        SocketRegistration(const SocketRegistration&);
+        SocketRegistration& operator=(const SocketRegistration&);
+
+    public:
+
+        AprPool pool;
+        apr_pollfd_t descriptor;
+
+        SocketRegistration() : pool(), descriptor() {
+        }
+    };
+
+    class SocketPollerImpl {
+    private:
+
+        SocketPollerImpl(const SocketPollerImpl&);
+        SocketPollerImpl& operator=(const SocketPollerImpl&);
+
+    public:
+
+        AprPool pool;
+        apr_pollset_t* pollset;
+        StlMap<const Socket*, SocketRegistration*> registrations;
+        Mutex mutex;
+
+        SocketPollerImpl() : pool(), pollset(NULL), registrations(), mutex() {
+        }
+    };
+
+}}}
+
+////////////////////////////////////////////////////////////////////////////////
+SocketPoller::SocketPoller(int capacity) : impl(new SocketPollerImpl) {
+
+    // Ask for epoll, APR uses the best method the platform has when it is missing.
+    apr_status_t result = apr_pollset_create_ex(&this->impl->pollset, (apr_uint32_t) capacity,
+        this->impl->pool.getAprPool(), APR_POLLSET_THREADSAFE | APR_POLLSET_WAKEABLE, APR_POLLSET_EPOLL);
+
+    if (result != APR_SUCCESS) {
+        delete this->impl;
+        throw IOException(__FILE__, __LINE__,
+            "Could not create the poll set - %s", SocketError::getErrorString().c_str());
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+SocketPoller::~SocketPoller() {
+    try {
+
+        apr_pollset_destroy(this->impl->pollset);
+
+        std::vector<SocketRegistration*> registrations = this->impl->registrations.values().toArray();
+        for (std::size_t i = 0; i < registrations.size(); ++i) {
+            delete registrations[i];
+        }
+
+        delete this->impl;
+    }
+    DECAF_CATCHALL_NOTHROW()
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void SocketPoller::add(const Socket* socket, void* attachment) {
+
+    if (socket == NULL) {
+        throw IOException(__FILE__, __LINE__, "Socket passed was NULL");
+    }
+
+    const SocketFileDescriptor* fd = dynamic_cast<const SocketFileDescriptor*>(socket->getFileDescriptor());
+    if (fd == NULL || !socket->isConnected()) {
+        throw IOException(__FILE__, __LINE__, "Only a connected Socket can be polled");
+    }
+
+    synchronized(&this->impl->mutex) {
+
+        if (this->impl->registrations.containsKey(socket)) {
+            throw IOException(__FILE__, __LINE__, "The Socket is already registered");
+        }
+
+        SocketRegistration* registration = new SocketRegistration();
+
+        // The APR socket made here only wraps the descriptor, it does not close it.
+        apr_os_sock_t osSocket = (apr_os_sock_t) fd->getValue();
+        apr_socket_t* aprSocket = NULL;
+        apr_os_sock_put(&aprSocket, &osSocket, registration->pool.getAprPool());
+
+        registration->descriptor.p = registration->pool.getAprPool();
+        registration->descriptor.desc_type = APR_POLL_SOCKET;
+        registration->descriptor.reqevents = APR_POLLIN;
+        registration->descriptor.rtnevents = 0;
+        registration->descriptor.desc.s = aprSocket;
+        registration->descriptor.client_data = attachment;
+
+        if (apr_pollset_add(this->impl->pollset, &registration->descriptor) != APR_SUCCESS) {
+            delete registration;
+            throw IOException(__FILE__, __LINE__,
+                "Could not add the Socket to the poll set - %s", SocketError::getErrorString().c_str());
+        }
+
+        this->impl->registrations.put(socket, registration);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+bool SocketPoller::remove(const Socket* socket) {
+
+    SocketRegistration* registration = NULL;
+
+    synchronized(&this->impl->mutex) {
+
+        if (!this->impl->registrations.containsKey(socket)) {
+            return false;
+        }
+
+        registration = this->impl->registrations.remove(socket);
+        apr_pollset_remove(this->impl->pollset, &registration->descriptor);
+    }
+
+    delete registration;
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int SocketPoller::poll(std::vector<void*>& ready, long long timeout) {
+
+    ready.clear();
+
+    apr_int32_t count = 0;
+    const apr_pollfd_t* descriptors = NULL;
+
+    apr_status_t result = apr_pollset_poll(this->impl->pollset,
+        timeout < 0 ? -1 : (apr_interval_time_t) timeout * 1000, &count, &descriptors);
+
+    // Being woken up, interrupted or timing out is not an error, there is just
+    // nothing to return.
+    if (APR_STATUS_IS_EINTR(result) || APR_STATUS_IS_TIMEUP(result)) {
+        return 0;
+    }
+
+    if (result != APR_SUCCESS) {
+        throw IOException(__FILE__, __LINE__,
+            "Poll failed - %s", SocketError::getErrorString().c_str());
+    }
+
+    for (apr_int32_t i = 0; i < count; ++i) {
+        ready.push_back(descriptors[i].client_data);
+    }
+
+    return (int) ready.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void SocketPoller::wakeup() {
+    apr_pollset_wakeup(this->impl->pollset);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int SocketPoller::size() const {
+    synchronized(&this->impl->mutex) {
+        return this->impl->registrations.size();
+    }
+
+    return 0;
+}
@@ -0,0 +1,126 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _DECAF_INTERNAL_NET_SOCKETPOLLER_H_
+#define _DECAF_INTERNAL_NET_SOCKETPOLLER_H_
+
+#include <decaf/util/Config.h>
+
+#include <decaf/io/IOException.h>
+#include <decaf/net/Socket.h>
+
+#include <vector>
+
+namespace decaf {
+namespace internal {
+namespace net {
+
+    class SocketPollerImpl;
+
+    /**
+     * Waits for any of a set of connected Sockets to have data to read.  Each Socket is
+     * registered with an attachment that poll hands back once the Socket is readable or
+     * its connection has been closed, so one thread can serve the reads of many Sockets
+     * without blocking on any one of them.
+     *
+     * The set is an APR pollset, which is backed by epoll on Linux and by kqueue or
+     * poll elsewhere.  Sockets can be added and removed while another thread is in
+     * poll, the Sockets themselves are left in blocking mode so writes to them are
+     * unaffected.
+     *
+     * @since 3.10.0
+     */
+    class DECAF_API SocketPoller {
+    private:
+
+        SocketPollerImpl* impl;
+
+    private:
+
+        SocketPoller(const SocketPoller&);
+        SocketPoller& operator=(const SocketPoller&);
+
+    public:
+
+        /**
+         * Creates a poller.
+         *
+         * @param capacity
+         *      The number of Sockets the poller is sized for, on most platforms the
+         *      set grows past it as needed.
+         *
+         * @throws IOException if the OS level poll set could not be created.
+         */
+        SocketPoller(int capacity);
+
+        virtual ~SocketPoller();
+
+        /**
+         * Starts watching the Socket for data to read.
+         *
+         * @param socket
+         *      The connected Socket to watch, the caller keeps ownership and must remove
+         *      it before closing it.
+         * @param attachment
+         *      The value poll returns when the Socket is readable.
+         *
+         * @throws IOException if the Socket is not connected or is already registered.
+         */
+        void add(const decaf::net::Socket* socket, void* attachment);
+
+        /**
+         * Stops watching the Socket, poll calls made after this returns do not return
+         * its attachment.
+         *
+         * @param socket
+         *      The Socket to stop watching.
+         *
+         * @return true if the Socket was registered.
+         */
+        bool remove(const decaf::net::Socket* socket);
+
+        /**
+         * Waits until at least one of the registered Sockets is readable, the timeout
+         * expires or wakeup is called.
+         *
+         * @param ready
+         *      Receives the attachments of the readable Sockets, it is cleared first.
+         * @param timeout
+         *      The time to wait in milliseconds, or -1 to wait until woken.
+         *
+         * @return the number of attachments returned.
+         *
+         * @throws IOException if the poll fails.
+         */
+        int poll(std::vector<void*>& ready, long long timeout);
+
+        /**
+         * Makes a thread blocked in poll return, or the next call to poll return at once
+         * if no thread is waiting.
+         */
+        void wakeup();
+
+        /**
+         * @return the number of Sockets registered.
+         */
+        int size() const;
+
+    };
+
+}}}
+
+#endif /* _DECAF_INTERNAL_NET_SOCKETPOLLER_H_ */
@@ -42,6 +42,11 @@ namespace lang {
      * which provide a means of using invasive reference counting if desired using
      * a custom implementation of <code>ReferenceCounter</code>.
      * <p>
+     * With the default AtomicRefCounter a Pointer to a class derived from AtomicRefCounted
+     * keeps its count in the pointee, other types have a counter allocated when the first
+     * Pointer takes ownership, which requires the type to be complete at that point.  A
+     * custom counter must be constructible from the pointer it is given ownership of.
+     * <p>
      * The Decaf smart pointer provide comparison operators for comparing Pointer
      * instances in the same manner as normal pointer, except that it does not provide
      * an overload of operators ( <, <=, >, >= ).  To allow use of a Pointer in a STL
@@ -85,7 +90,7 @@ namespace lang {
          * @param value -
          *      The instance of the type we are containing here.
          */
-        explicit Pointer(const PointerType value) : REFCOUNTER(), value(value), onDelete(onDeleteFunc) {}
+        explicit Pointer(const PointerType value) : REFCOUNTER(value), value(value), onDelete(onDeleteFunc) {}
 
         /**
          * Copy constructor. Copies the value contained in the pointer to the new
@@ -174,6 +179,10 @@ namespace lang {
         T* release() {
             T* temp = this->value;
             this->value = NULL;
+
+            // Give up our reference so that a count held in the pointee does not
+            // outlive the ownership handed back to the caller.
+            Pointer().swap(*this);
             return temp;
         }
 
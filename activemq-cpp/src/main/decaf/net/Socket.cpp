@@ -366,6 +366,16 @@ OutputStream* Socket::getOutputStream() {
     DECAF_CATCHALL_THROW( IOException )
 }
 
+////////////////////////////////////////////////////////////////////////////////
+const FileDescriptor* Socket::getFileDescriptor() const {
+
+    if( !this->created ) {
+        return NULL;
+    }
+
+    return this->impl->getFileDescriptor();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 void Socket::shutdownInput() {
 
@@ -23,6 +23,7 @@
 #include <decaf/io/InputStream.h>
 #include <decaf/io/OutputStream.h>
 #include <decaf/io/Closeable.h>
+#include <decaf/io/FileDescriptor.h>
 #include <decaf/util/Config.h>
 
 #include <decaf/lang/exceptions/NullPointerException.h>
@@ -293,6 +294,14 @@ namespace net{
          */
         virtual decaf::io::OutputStream* getOutputStream();
 
+        /**
+         * Gets the FileDescriptor of the OS level socket, the object is owned by this Socket
+         * and remains valid until the Socket is destroyed.
+         *
+         * @return the FileDescriptor of this Socket or NULL if no OS socket has been created.
+         */
+        const decaf::io::FileDescriptor* getFileDescriptor() const;
+
         /**
          * Gets the on the remote host this Socket is connected to.
          *
@@ -20,15 +20,809 @@
 
 #include <decaf/util/Config.h>
 
+#include <decaf/util/concurrent/ConcurrentMap.h>
+#include <decaf/util/concurrent/Mutex.h>
+#include <decaf/util/concurrent/Concurrent.h>
+#include <decaf/util/HashMap.h>
+#include <decaf/util/HashCode.h>
+#include <decaf/util/AbstractSet.h>
+#include <decaf/util/AbstractCollection.h>
+#include <decaf/util/Iterator.h>
+#include <decaf/util/MapEntry.h>
+#include <decaf/util/NoSuchElementException.h>
+#include <decaf/lang/Pointer.h>
+#include <decaf/lang/exceptions/IllegalArgumentException.h>
+#include <decaf/lang/exceptions/IllegalStateException.h>
+#include <decaf/lang/exceptions/UnsupportedOperationException.h>
+
+#include <vector>
+
 namespace decaf {
 namespace util {
 namespace concurrent {
 
-    class ConcurrentHashMap {
+    /**
+     * A hash table with adjustable expected concurrency for retrievals and updates.
+     *
+     * The table is split into a fixed number of segments, each a HashMap guarded by its
+     * own lock, and a key is always handled by the segment selected from the high bits
+     * of its spread hash code.  Retrievals take the lock of their segment like updates
+     * do, but operations on keys that fall in different segments never contend with
+     * each other, so threads that read or update different keys can proceed in parallel
+     * where a map behind a single mutex would serialize them.
+     *
+     * Operations that span the whole table, such as size, containsValue and clear, visit
+     * the segments one at a time and so are not atomic with respect to concurrent
+     * updates.  The key, value and entry views iterate over a snapshot taken when the
+     * iterator is created, they never throw ConcurrentModificationException and removing
+     * through a non-const iterator removes the key from the map.
+     *
+     * As with the other decaf maps the get methods return a reference into the map, the
+     * reference is only safe to use as long as no other thread can remove the key.  The
+     * get method that copies the value out instead is safe against removals and does
+     * not throw when the key is absent.
+     *
+     * The lock, wait and notify methods of the Synchronizable interface operate on a
+     * monitor separate from the segment locks, holding it does not block the map's
+     * own operations.
+     *
+     * @since 1.0
+     */
+    template<typename K, typename V, typename HASHCODE = HashCode<K> >
+    class ConcurrentHashMap : public ConcurrentMap<K, V> {
     public:
 
-        ConcurrentHashMap() {}
-        virtual ~ConcurrentHashMap() {}
+        /**
+         * The number of segments used when no concurrency level is given.
+         */
+        static const int DEFAULT_CONCURRENCY_LEVEL = 16;
+
+        /**
+         * The initial capacity of the table when none is given.
+         */
+        static const int DEFAULT_INITIAL_CAPACITY = 16;
+
+        /**
+         * The upper bound on the number of segments.
+         */
+        static const int MAX_SEGMENTS = 1 << 16;
+
+    private:
+
+        class Segment {
+        private:
+
+            Segment(const Segment&);
+            Segment& operator= (const Segment&);
+
+        public:
+
+            mutable Mutex lock;
+            HashMap<K, V, HASHCODE> table;
+
+            Segment() : lock(), table() {
+            }
+        };
+
+    private:
+
+        // Iterates over a snapshot of the map's entries, subclasses pick out the key, the
+        // value or the whole entry.
+        class SnapshotIterator {
+        private:
+
+            SnapshotIterator(const SnapshotIterator&);
+            SnapshotIterator& operator= (const SnapshotIterator&);
+
+        protected:
+
+            ConcurrentHashMap* associatedMap;
+            std::vector< MapEntry<K, V> > entries;
+            int position;
+            bool canRemove;
+
+        public:
+
+            SnapshotIterator(const ConcurrentHashMap* parent, bool writable) :
+                associatedMap(writable ? const_cast<ConcurrentHashMap*>(parent) : NULL),
+                entries(), position(0), canRemove(false) {
+
+                parent->snapshot(entries);
+            }
+
+            virtual ~SnapshotIterator() {}
+
+            bool checkHasNext() const {
+                return position < (int) entries.size();
+            }
+
+            const MapEntry<K, V>& makeNext() {
+                if (!checkHasNext()) {
+                    throw NoSuchElementException(__FILE__, __LINE__, "No next element");
+                }
+
+                canRemove = true;
+                return entries[position++];
+            }
+
+            void doRemove() {
+                if (associatedMap == NULL) {
+                    throw lang::exceptions::UnsupportedOperationException(
+                        __FILE__, __LINE__, "Cannot write to a const Iterator.");
+                }
+
+                if (!canRemove) {
+                    throw lang::exceptions::IllegalStateException(
+                        __FILE__, __LINE__, "Invalid State to remove");
+                }
+
+                canRemove = false;
+                associatedMap->removeIfPresent(entries[position - 1].getKey());
+            }
+        };
+
+        class EntryIterator : public Iterator< MapEntry<K, V> >, public SnapshotIterator {
+        private:
+
+            EntryIterator(const EntryIterator&);
+            EntryIterator& operator= (const EntryIterator&);
+
+        public:
+
+            EntryIterator(const ConcurrentHashMap* parent, bool writable) : SnapshotIterator(parent, writable) {
+            }
+
+            virtual ~EntryIterator() {}
+
+            virtual bool hasNext() const {
+                return this->checkHasNext();
+            }
+
+            virtual MapEntry<K, V> next() {
+                return this->makeNext();
+            }
+
+            virtual void remove() {
+                this->doRemove();
+            }
+        };
+
+        class KeyIterator : public Iterator<K>, public SnapshotIterator {
+        private:
+
+            KeyIterator(const KeyIterator&);
+            KeyIterator& operator= (const KeyIterator&);
+
+        public:
+
+            KeyIterator(const ConcurrentHashMap* parent, bool writable) : SnapshotIterator(parent, writable) {
+            }
+
+            virtual ~KeyIterator() {}
+
+            virtual bool hasNext() const {
+                return this->checkHasNext();
+            }
+
+            virtual K next() {
+                return this->makeNext().getKey();
+            }
+
+            virtual void remove() {
+                this->doRemove();
+            }
+        };
+
+        class ValueIterator : public Iterator<V>, public SnapshotIterator {
+        private:
+
+            ValueIterator(const ValueIterator&);
+            ValueIterator& operator= (const ValueIterator&);
+
+        public:
+
+            ValueIterator(const ConcurrentHashMap* parent, bool writable) : SnapshotIterator(parent, writable) {
+            }
+
+            virtual ~ValueIterator() {}
+
+            virtual bool hasNext() const {
+                return this->checkHasNext();
+            }
+
+            virtual V next() {
+                return this->makeNext().getValue();
+            }
+
+            virtual void remove() {
+                this->doRemove();
+            }
+        };
+
+    private:
+
+        class EntrySet : public AbstractSet< MapEntry<K, V> > {
+        private:
+
+            ConcurrentHashMap* associatedMap;
+
+        private:
+
+            EntrySet(const EntrySet&);
+            EntrySet& operator= (const EntrySet&);
+
+        public:
+
+            EntrySet(ConcurrentHashMap* parent) : AbstractSet< MapEntry<K, V> >(), associatedMap(parent) {
+            }
+
+            virtual ~EntrySet() {}
+
+            virtual int size() const {
+                return associatedMap->size();
+            }
+
+            virtual void clear() {
+                associatedMap->clear();
+            }
+
+            virtual bool remove(const MapEntry<K, V>& entry) {
+                return associatedMap->remove(entry.getKey(), entry.getValue());
+            }
+
+            virtual bool contains(const MapEntry<K, V>& entry) const {
+                return associatedMap->containsEntry(entry.getKey(), entry.getValue());
+            }
+
+            virtual Iterator< MapEntry<K, V> >* iterator() {
+                return new EntryIterator(associatedMap, true);
+            }
+
+            virtual Iterator< MapEntry<K, V> >* iterator() const {
+                return new EntryIterator(associatedMap, false);
+            }
+        };
+
+        class KeySet : public AbstractSet<K> {
+        private:
+
+            ConcurrentHashMap* associatedMap;
+
+        private:
+
+            KeySet(const KeySet&);
+            KeySet& operator= (const KeySet&);
+
+        public:
+
+            KeySet(ConcurrentHashMap* parent) : AbstractSet<K>(), associatedMap(parent) {
+            }
+
+            virtual ~KeySet() {}
+
+            virtual bool contains(const K& key) const {
+                return associatedMap->containsKey(key);
+            }
+
+            virtual int size() const {
+                return associatedMap->size();
+            }
+
+            virtual void clear() {
+                associatedMap->clear();
+            }
+
+            virtual bool remove(const K& key) {
+                return associatedMap->removeIfPresent(key);
+            }
+
+            virtual Iterator<K>* iterator() {
+                return new KeyIterator(associatedMap, true);
+            }
+
+            virtual Iterator<K>* iterator() const {
+                return new KeyIterator(associatedMap, false);
+            }
+        };
+
+        class ValueCollection : public AbstractCollection<V> {
+        private:
+
+            ConcurrentHashMap* associatedMap;
+
+        private:
+
+            ValueCollection(const ValueCollection&);
+            ValueCollection& operator= (const ValueCollection&);
+
+        public:
+
+            ValueCollection(ConcurrentHashMap* parent) : AbstractCollection<V>(), associatedMap(parent) {
+            }
+
+            virtual ~ValueCollection() {}
+
+            virtual bool contains(const V& value) const {
+                return associatedMap->containsValue(value);
+            }
+
+            virtual int size() const {
+                return associatedMap->size();
+            }
+
+            virtual void clear() {
+                associatedMap->clear();
+            }
+
+            virtual Iterator<V>* iterator() {
+                return new ValueIterator(associatedMap, true);
+            }
+
+            virtual Iterator<V>* iterator() const {
+                return new ValueIterator(associatedMap, false);
+            }
+        };
+
+    private:
+
+        Segment* segments;
+        int segmentCount;
+        int segmentShift;
+        int segmentMask;
+
+        mutable Mutex mutex;
+
+        HASHCODE hashFunc;
+
+        EntrySet entrySetView;
+        KeySet keySetView;
+        ValueCollection valuesView;
+
+    private:
+
+        ConcurrentHashMap(const ConcurrentHashMap&);
+        ConcurrentHashMap& operator= (const ConcurrentHashMap&);
+
+    public:
+
+        /**
+         * Creates a new, empty map with the default initial capacity and concurrency level.
+         */
+        ConcurrentHashMap() : ConcurrentMap<K, V>(), segments(NULL), segmentCount(0), segmentShift(0),
+                              segmentMask(0), mutex(), hashFunc(), entrySetView(this), keySetView(this),
+                              valuesView(this) {
+            this->initialize(DEFAULT_INITIAL_CAPACITY, DEFAULT_CONCURRENCY_LEVEL);
+        }
+
+        /**
+         * Creates a new, empty map with the given initial capacity and the default
+         * concurrency level.
+         *
+         * @param initialCapacity
+         *      The number of elements the table can hold before it needs to grow.
+         *
+         * @throws IllegalArgumentException if the initial capacity is negative.
+         */
+        ConcurrentHashMap(int initialCapacity) :
+            ConcurrentMap<K, V>(), segments(NULL), segmentCount(0), segmentShift(0), segmentMask(0),
+            mutex(), hashFunc(), entrySetView(this), keySetView(this), valuesView(this) {
+            this->initialize(initialCapacity, DEFAULT_CONCURRENCY_LEVEL);
+        }
+
+        /**
+         * Creates a new, empty map with the given initial capacity and concurrency level.
+         *
+         * @param initialCapacity
+         *      The number of elements the table can hold before it needs to grow.
+         * @param concurrencyLevel
+         *      The estimated number of concurrently updating threads, the table is split
+         *      into this many segments rounded up to a power of two.
+         *
+         * @throws IllegalArgumentException if the initial capacity is negative or the
+         *         concurrency level is not positive.
+         */
+        ConcurrentHashMap(int initialCapacity, int concurrencyLevel) :
+            ConcurrentMap<K, V>(), segments(NULL), segmentCount(0), segmentShift(0), segmentMask(0),
+            mutex(), hashFunc(), entrySetView(this), keySetView(this), valuesView(this) {
+            this->initialize(initialCapacity, concurrencyLevel);
+        }
+
+        /**
+         * Creates a new map with the same mappings as the given map.
+         *
+         * @param source
+         *      The map whose mappings are copied into this one.
+         */
+        ConcurrentHashMap(const Map<K, V>& source) :
+            ConcurrentMap<K, V>(), segments(NULL), segmentCount(0), segmentShift(0), segmentMask(0),
+            mutex(), hashFunc(), entrySetView(this), keySetView(this), valuesView(this) {
+            this->initialize(source.size() > DEFAULT_INITIAL_CAPACITY ? source.size() : DEFAULT_INITIAL_CAPACITY,
+                             DEFAULT_CONCURRENCY_LEVEL);
+            this->putAll(source);
+        }
+
+        virtual ~ConcurrentHashMap() {
+            delete [] this->segments;
+        }
+
+        /**
+         * @return the number of segments the table is split into.
+         */
+        int getSegmentCount() const {
+            return this->segmentCount;
+        }
+
+    public:
+
+        virtual bool equals(const Map<K, V>& source) const {
+
+            if (this == &source) {
+                return true;
+            }
+
+            std::vector< MapEntry<K, V> > entries;
+            this->snapshot(entries);
+
+            if ((int) entries.size() != source.size()) {
+                return false;
+            }
+
+            typename std::vector< MapEntry<K, V> >::const_iterator iter = entries.begin();
+            for (; iter != entries.end(); ++iter) {
+                if (!source.containsKey(iter->getKey()) || !(iter->getValue() == source.get(iter->getKey()))) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        virtual void copy(const Map<K, V>& source) {
+            if (this == &source) {
+                return;
+            }
+
+            this->clear();
+            this->putAll(source);
+        }
+
+        virtual void clear() {
+            for (int i = 0; i < segmentCount; ++i) {
+                synchronized(&segments[i].lock) {
+                    segments[i].table.clear();
+                }
+            }
+        }
+
+        virtual bool containsKey(const K& key) const {
+            const Segment& segment = segmentFor(key);
+            synchronized(&segment.lock) {
+                return segment.table.containsKey(key);
+            }
+
+            return false;
+        }
+
+        virtual bool containsValue(const V& value) const {
+            for (int i = 0; i < segmentCount; ++i) {
+                synchronized(&segments[i].lock) {
+                    if (segments[i].table.containsValue(value)) {
+                        return true;
+                    }
+                }
+            }
+
+            return false;
+        }
+
+        virtual bool isEmpty() const {
+            for (int i = 0; i < segmentCount; ++i) {
+                synchronized(&segments[i].lock) {
+                    if (!segments[i].table.isEmpty()) {
+                        return false;
+                    }
+                }
+            }
+
+            return true;
+        }
+
+        virtual int size() const {
+            int result = 0;
+            for (int i = 0; i < segmentCount; ++i) {
+                synchronized(&segments[i].lock) {
+                    result += segments[i].table.size();
+                }
+            }
+
+            return result;
+        }
+
+        virtual V& get(const K& key) {
+            Segment& segment = segmentFor(key);
+            synchronized(&segment.lock) {
+                return segment.table.get(key);
+            }
+
+            throw NoSuchElementException(__FILE__, __LINE__, "The specified key is not present in the Map");
+        }
+
+        virtual const V& get(const K& key) const {
+            const Segment& segment = segmentFor(key);
+            synchronized(&segment.lock) {
+                return segment.table.get(key);
+            }
+
+            throw NoSuchElementException(__FILE__, __LINE__, "The specified key is not present in the Map");
+        }
+
+        /**
+         * Copies the value mapped to the given key, if there is one.
+         *
+         * @param key
+         *      The key to look up.
+         * @param value
+         *      Receives a copy of the mapped value when the key is present.
+         *
+         * @return true if the key was present.
+         */
+        bool get(const K& key, V& value) const {
+            const Segment& segment = segmentFor(key);
+            synchronized(&segment.lock) {
+                if (!segment.table.containsKey(key)) {
+                    return false;
+                }
+
+                value = segment.table.get(key);
+                return true;
+            }
+
+            return false;
+        }
+
+        virtual bool put(const K& key, const V& value) {
+            Segment& segment = segmentFor(key);
+            synchronized(&segment.lock) {
+                return segment.table.put(key, value);
+            }
+
+            return false;
+        }
+
+        virtual bool put(const K& key, const V& value, V& oldValue) {
+            Segment& segment = segmentFor(key);
+            synchronized(&segment.lock) {
+                return segment.table.put(key, value, oldValue);
+            }
+
+            return false;
+        }
+
+        virtual void putAll(const Map<K, V>& other) {
+            if (this == &other) {
+                return;
+            }
+
+            decaf::lang::Pointer< Iterator< MapEntry<K, V> > > iter(other.entrySet().iterator());
+            while (iter->hasNext()) {
+                MapEntry<K, V> entry = iter->next();
+                this->put(entry.getKey(), entry.getValue());
+            }
+        }
+
+        virtual V remove(const K& key) {
+            Segment& segment = segmentFor(key);
+            synchronized(&segment.lock) {
+                return segment.table.remove(key);
+            }
+
+            throw NoSuchElementException(__FILE__, __LINE__, "Specified key not present in the Map.");
+        }
+
+        virtual Set< MapEntry<K, V> >& entrySet() {
+            return this->entrySetView;
+        }
+
+        virtual const Set< MapEntry<K, V> >& entrySet() const {
+            return this->entrySetView;
+        }
+
+        virtual Set<K>& keySet() {
+            return this->keySetView;
+        }
+
+        virtual const Set<K>& keySet() const {
+            return this->keySetView;
+        }
+
+        virtual Collection<V>& values() {
+            return this->valuesView;
+        }
+
+        virtual const Collection<V>& values() const {
+            return this->valuesView;
+        }
+
+    public:
+
+        virtual bool putIfAbsent(const K& key, const V& value) {
+            Segment& segment = segmentFor(key);
+            synchronized(&segment.lock) {
+                if (!segment.table.containsKey(key)) {
+                    segment.table.put(key, value);
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        virtual bool remove(const K& key, const V& value) {
+            Segment& segment = segmentFor(key);
+            synchronized(&segment.lock) {
+                if (segment.table.containsKey(key) && segment.table.get(key) == value) {
+                    segment.table.remove(key);
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        virtual bool replace(const K& key, const V& oldValue, const V& newValue) {
+            Segment& segment = segmentFor(key);
+            synchronized(&segment.lock) {
+                if (segment.table.containsKey(key) && segment.table.get(key) == oldValue) {
+                    segment.table.put(key, newValue);
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        virtual V replace(const K& key, const V& value) {
+            Segment& segment = segmentFor(key);
+            synchronized(&segment.lock) {
+                if (segment.table.containsKey(key)) {
+                    V result = segment.table.get(key);
+                    segment.table.put(key, value);
+                    return result;
+                }
+            }
+
+            throw NoSuchElementException(__FILE__, __LINE__, "Value to Replace was not in the Map.");
+        }
+
+        using ConcurrentMap<K, V>::remove;
+
+    public:
+
+        virtual void lock() {
+            mutex.lock();
+        }
+
+        virtual bool tryLock() {
+            return mutex.tryLock();
+        }
+
+        virtual void unlock() {
+            mutex.unlock();
+        }
+
+        virtual void wait() {
+            mutex.wait();
+        }
+
+        virtual void wait(long long millisecs) {
+            mutex.wait(millisecs);
+        }
+
+        virtual void wait(long long millisecs, int nanos) {
+            mutex.wait(millisecs, nanos);
+        }
+
+        virtual void notify() {
+            mutex.notify();
+        }
+
+        virtual void notifyAll() {
+            mutex.notifyAll();
+        }
+
+    private:
+
+        void initialize(int initialCapacity, int concurrencyLevel) {
+
+            if (initialCapacity < 0) {
+                throw decaf::lang::exceptions::IllegalArgumentException(
+                    __FILE__, __LINE__, "Initial capacity cannot be negative: %d", initialCapacity);
+            }
+
+            if (concurrencyLevel <= 0) {
+                throw decaf::lang::exceptions::IllegalArgumentException(
+                    __FILE__, __LINE__, "Concurrency level must be positive: %d", concurrencyLevel);
+            }
+
+            if (concurrencyLevel > MAX_SEGMENTS) {
+                concurrencyLevel = MAX_SEGMENTS;
+            }
+
+            int shift = 0;
+            int count = 1;
+            while (count < concurrencyLevel) {
+                ++shift;
+                count <<= 1;
+            }
+
+            this->segmentShift = 32 - shift;
+            this->segmentMask = count - 1;
+            this->segmentCount = count;
+            this->segments = new Segment[count];
+        }
+
+        /**
+         * Spreads the bits of the key's hash code so that keys whose hash codes differ
+         * only in the low bits still land in different segments.
+         */
+        static unsigned int spread(int hashCode) {
+            unsigned int h = (unsigned int) hashCode;
+            h ^= h >> 16;
+            h *= 0x85ebca6bU;
+            h ^= h >> 13;
+            h *= 0xc2b2ae35U;
+            h ^= h >> 16;
+            return h;
+        }
+
+        int segmentIndex(const K& key) const {
+            if (segmentMask == 0) {
+                return 0;
+            }
+
+            return (int) ((spread(hashFunc(key)) >> segmentShift) & (unsigned int) segmentMask);
+        }
+
+        Segment& segmentFor(const K& key) {
+            return segments[segmentIndex(key)];
+        }
+
+        const Segment& segmentFor(const K& key) const {
+            return segments[segmentIndex(key)];
+        }
+
+        bool removeIfPresent(const K& key) {
+            Segment& segment = segmentFor(key);
+            synchronized(&segment.lock) {
+                if (segment.table.containsKey(key)) {
+                    segment.table.remove(key);
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        bool containsEntry(const K& key, const V& value) const {
+            const Segment& segment = segmentFor(key);
+            synchronized(&segment.lock) {
+                return segment.table.containsKey(key) && segment.table.get(key) == value;
+            }
+
+            return false;
+        }
+
+        void snapshot(std::vector< MapEntry<K, V> >& entries) const {
+            for (int i = 0; i < segmentCount; ++i) {
+                synchronized(&segments[i].lock) {
+                    HashMap<K, V, HASHCODE>& table = segments[i].table;
+                    decaf::lang::Pointer< Iterator< MapEntry<K, V> > > iter(table.entrySet().iterator());
+                    while (iter->hasNext()) {
+                        entries.push_back(iter->next());
+                    }
+                }
+            }
+        }
 
     };
 
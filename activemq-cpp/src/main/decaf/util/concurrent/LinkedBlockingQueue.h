@@ -43,6 +43,10 @@ namespace concurrent {
      * that can be enqueued at any one time.  Elements are inserted and removed in FIFO order.
      * The internal structure of the queue is based on a linked nodes which provides for better
      * performance over their array based versions but the performance is less predictable.
+     * Producers and consumers lock separate ends of the queue so that they do not contend with
+     * each other, and a node costs one allocation with no reference counting.  Nodes that are
+     * removed while an Iterator of the queue is alive are kept until the last Iterator is
+     * destroyed so that the Iterators remain weakly consistent.
      *
      * The capacity bound of this class default to Integer::MAX_VALUE.
      *
@@ -62,7 +66,10 @@ namespace concurrent {
 
         public:
 
-            Pointer< QueueNode<E> > next;
+            QueueNode<U>* next;
+
+            // Links the nodes kept for live Iterators after they left the queue.
+            QueueNode<U>* nextRetired;
 
         private:
 
@@ -71,15 +78,8 @@ namespace concurrent {
 
         public:
 
-            QueueNode() : value(), unlinked(false), dequeued(false), next() {}
-            QueueNode(const U& value) : value(value), unlinked(false), dequeued(false), next() {}
-
-            void set(Pointer< QueueNode<U> > next, const U& value) {
-                this->next = next;
-                this->value = value;
-                this->unlinked = false;
-                this->dequeued = false;
-            }
+            QueueNode() : value(), unlinked(false), dequeued(false), next(NULL), nextRetired(NULL) {}
+            QueueNode(const U& value) : value(value), unlinked(false), dequeued(false), next(NULL), nextRetired(NULL) {}
 
             E get() const {
                 return this->value;
@@ -148,8 +148,14 @@ namespace concurrent {
         /** Wait queue for waiting puts */
         Pointer<locks::Condition> notFull; // putLock.newCondition();
 
-        Pointer< QueueNode<E> > head;
-        Pointer< QueueNode<E> > tail;
+        QueueNode<E>* head;
+        QueueNode<E>* tail;
+
+        /** Number of live Iterators, changed holding both locks */
+        mutable int iterators;
+
+        /** Nodes removed while Iterators were alive, guarded by takeLock */
+        mutable QueueNode<E>* retired;
 
     public:
 
@@ -157,7 +163,7 @@ namespace concurrent {
          * Create a new instance with a Capacity of Integer::MAX_VALUE
          */
         LinkedBlockingQueue() : BlockingQueue<E>(), capacity(lang::Integer::MAX_VALUE), count(),
-                                takeLock(), notEmpty(), putLock(), notFull(), head(new QueueNode<E>()), tail() {
+                                takeLock(), notEmpty(), putLock(), notFull(), head(new QueueNode<E>()), tail(), iterators(0), retired(NULL) {
 
             this->tail = this->head;
             this->notEmpty.reset(this->takeLock.newCondition());
@@ -173,8 +179,9 @@ namespace concurrent {
          * @throws IllegalArgumentException if the specified capacity is not greater than zero.
          */
         LinkedBlockingQueue(int capacity) : BlockingQueue<E>(), capacity(capacity), count(),
-                                            takeLock(), notEmpty(), putLock(), notFull(), head(new QueueNode<E>()), tail() {
+                                            takeLock(), notEmpty(), putLock(), notFull(), head(new QueueNode<E>()), tail(), iterators(0), retired(NULL) {
             if(capacity <= 0) {
+                delete this->head;
                 throw decaf::lang::exceptions::IllegalArgumentException(
                     __FILE__, __LINE__, "Capacity value must be greater than zero.");
             }
@@ -197,7 +204,7 @@ namespace concurrent {
         LinkedBlockingQueue(const Collection<E>& collection) : BlockingQueue<E>(),
                                                                capacity(lang::Integer::MAX_VALUE), count(),
                                                                takeLock(), notEmpty(), putLock(), notFull(),
-                                                               head(new QueueNode<E>()), tail() {
+                                                               head(new QueueNode<E>()), tail(), iterators(0), retired(NULL) {
 
             this->tail = this->head;
             this->notEmpty.reset(this->takeLock.newCondition());
@@ -239,7 +246,7 @@ namespace concurrent {
         LinkedBlockingQueue(const LinkedBlockingQueue& queue) : BlockingQueue<E>(),
                                                                 capacity(lang::Integer::MAX_VALUE), count(),
                                                                 takeLock(), notEmpty(), putLock(), notFull(),
-                                                                head(new QueueNode<E>()), tail() {
+                                                                head(new QueueNode<E>()), tail(), iterators(0), retired(NULL) {
 
             this->tail = this->head;
             this->notEmpty.reset(this->takeLock.newCondition());
@@ -271,6 +278,8 @@ namespace concurrent {
         virtual ~LinkedBlockingQueue() {
             try{
                 this->purgeList();
+                delete this->head;
+                this->freeRetired();
             } catch(...) {}
         }
 
@@ -300,7 +309,6 @@ namespace concurrent {
 
             this->purgeList();
             this->tail = this->head;
-            this->count.set(0);
 
             if(this->count.getAndSet(0) == this->capacity) {
                 this->notFull->signal();
@@ -539,7 +547,7 @@ namespace concurrent {
 
             this->takeLock.lock();
             try {
-                Pointer< QueueNode<E> > front = this->head->next;
+                QueueNode<E>* front = this->head->next;
                 if(front == NULL) {
                     return false;
                 } else {
@@ -561,7 +569,7 @@ namespace concurrent {
 
             TotalLock lock(this);
 
-            for(Pointer< QueueNode<E> > predicessor = this->head, p = predicessor->next; p != NULL;
+            for(QueueNode<E>* predicessor = this->head, *p = predicessor->next; p != NULL;
                 predicessor = p, p = p->next) {
 
                 if(value == p->get()) {
@@ -581,7 +589,7 @@ namespace concurrent {
             std::vector<E> array;
             array.reserve(size);
 
-            for(Pointer< QueueNode<E> > p = this->head->next; p != NULL; p = p->next) {
+            for(QueueNode<E>* p = this->head->next; p != NULL; p = p->next) {
                 array.push_back(p->get());
             }
 
@@ -616,14 +624,18 @@ namespace concurrent {
                 // after this are not drained and since we hold the lock nothing can
                 // get taken so state should remain consistent.
                 result = decaf::lang::Math::min(maxElements, this->count.get());
-                Pointer< QueueNode<E> > node = this->head;
                 int i = 0;
                 try {
 
+                    // The head moves past each element once the sink has accepted it, so
+                    // an element the sink refuses stays in this Queue.
                     while(i < result) {
-                        Pointer< QueueNode<E> > p = node->next;
-                        sink.add( p->getAndDequeue() );
-                        node = p;
+                        QueueNode<E>* node = this->head;
+                        QueueNode<E>* p = node->next;
+                        sink.add( p->get() );
+                        p->getAndDequeue();
+                        this->head = p;
+                        this->release(node);
                         ++i;
                     }
 
@@ -633,7 +645,6 @@ namespace concurrent {
                 }
 
                 if (i > 0) {
-                    this->head = node;
                     signalNotFull = (this->count.getAndAdd(-i) == this->capacity);
                 }
 
@@ -660,8 +671,8 @@ namespace concurrent {
         class LinkedIterator : public Iterator<E> {
         private:
 
-            Pointer< QueueNode<E> > current;
-            Pointer< QueueNode<E> > last;
+            QueueNode<E>* current;
+            QueueNode<E>* last;
             E currentElement;
             LinkedBlockingQueue<E>* parent;
 
@@ -672,16 +683,23 @@ namespace concurrent {
 
         public:
 
-            LinkedIterator(LinkedBlockingQueue<E>* parent) : current(), last(),
+            LinkedIterator(LinkedBlockingQueue<E>* parent) : current(NULL), last(NULL),
                                                              currentElement(), parent(parent) {
                 TotalLock lock(parent);
 
+                parent->iterators++;
                 this->current = parent->head->next;
                 if(this->current != NULL) {
                     this->currentElement = current->get();
                 }
             }
 
+            virtual ~LinkedIterator() {
+                try {
+                    this->parent->releaseIterator();
+                } catch(...) {}
+            }
+
             virtual bool hasNext() const {
                 return this->current != NULL;
             }
@@ -712,10 +730,10 @@ namespace concurrent {
 
                 TotalLock lock(this->parent);
 
-                Pointer< QueueNode<E> > node;
-                node.swap(this->last);
+                QueueNode<E>* node = this->last;
+                this->last = NULL;
 
-                for(Pointer< QueueNode<E> > trail = this->parent->head, p = trail->next; p != NULL;
+                for(QueueNode<E>* trail = this->parent->head, *p = trail->next; p != NULL;
                     trail = p, p = p->next) {
 
                     if(p == node) {
@@ -727,7 +745,7 @@ namespace concurrent {
 
         private:
 
-            Pointer< QueueNode<E> > nextNode(Pointer< QueueNode<E> >& p) {
+            QueueNode<E>* nextNode(QueueNode<E>* p) {
 
                 // Handle the case of a dequeued Node, the new head of Queue
                 // will be parent->head->next() even if the Queue is empty.
@@ -735,7 +753,7 @@ namespace concurrent {
                     return this->parent->head->next;
                 }
 
-                Pointer< QueueNode<E> > s = p->next;
+                QueueNode<E>* s = p->next;
 
                 // Handle Nodes that have been removed from the interior of the
                 // Queue, these are tagged but still retain their next() value
@@ -754,8 +772,8 @@ namespace concurrent {
         class ConstLinkedIterator : public Iterator<E> {
         private:
 
-            Pointer< QueueNode<E> > current;
-            Pointer< QueueNode<E> > last;
+            QueueNode<E>* current;
+            QueueNode<E>* last;
             E currentElement;
             const LinkedBlockingQueue<E>* parent;
 
@@ -766,17 +784,24 @@ namespace concurrent {
 
         public:
 
-            ConstLinkedIterator(const LinkedBlockingQueue<E>* parent) : current(), last(),
+            ConstLinkedIterator(const LinkedBlockingQueue<E>* parent) : current(NULL), last(NULL),
                                                                         currentElement(),
                                                                         parent(parent) {
                 TotalLock lock(parent);
 
+                parent->iterators++;
                 this->current = parent->head->next;
                 if(this->current != NULL) {
                     this->currentElement = current->get();
                 }
             }
 
+            virtual ~ConstLinkedIterator() {
+                try {
+                    this->parent->releaseIterator();
+                } catch(...) {}
+            }
+
             virtual bool hasNext() const {
                 return this->current != NULL;
             }
@@ -805,7 +830,7 @@ namespace concurrent {
 
         private:
 
-            Pointer< QueueNode<E> > nextNode(Pointer< QueueNode<E> >& p) {
+            QueueNode<E>* nextNode(QueueNode<E>* p) {
 
                 // Handle the case of a dequeued Node, the new head of Queue
                 // will be parent->head->next() even if the Queue is empty.
@@ -813,7 +838,7 @@ namespace concurrent {
                     return this->parent->head->next;
                 }
 
-                Pointer< QueueNode<E> > s = p->next;
+                QueueNode<E>* s = p->next;
 
                 // Handle Nodes that have been removed from the interior of the
                 // Queue, these are tagged but still retain their next() value
@@ -841,7 +866,8 @@ namespace concurrent {
 
     private:
 
-        void unlink(Pointer< QueueNode<E> >& p, Pointer< QueueNode<E> >& predicessor) {
+        // Must be called with both locks locked.
+        void unlink(QueueNode<E>* p, QueueNode<E>* predicessor) {
 
             // In order to prevent Iterators from losing their ability to provide
             // weakly consistent iteration the next value of p is left intact but
@@ -854,6 +880,8 @@ namespace concurrent {
                 this->tail = predicessor;
             }
 
+            this->release(p);
+
             if(this->count.getAndDecrement() == capacity) {
                 this->signalNotFull();
             }
@@ -882,29 +910,59 @@ namespace concurrent {
         }
 
         // Must be called with the putLock locked.
-        void enqueue(E value) {
-            Pointer< QueueNode<E> > newTail( new QueueNode<E>(value) );
+        void enqueue(const E& value) {
+            QueueNode<E>* newTail = new QueueNode<E>(value);
             this->tail->next = newTail;
             this->tail = newTail;
         }
 
         // Must be called with the takeLock locked.
         E dequeue() {
-            Pointer< QueueNode<E> > temp = this->head;
-            Pointer< QueueNode<E> > newHead = temp->next;
+            QueueNode<E>* oldHead = this->head;
+            QueueNode<E>* newHead = oldHead->next;
             this->head = newHead;
 
-            return newHead->getAndDequeue();
+            E result = newHead->getAndDequeue();
+            this->release(oldHead);
+
+            return result;
+        }
+
+        // Must be called with the takeLock locked, a node that has left the queue is
+        // kept while any Iterator is alive since the Iterator may still be on it.
+        void release(QueueNode<E>* node) const {
+            if (this->iterators == 0) {
+                delete node;
+            } else {
+                node->nextRetired = this->retired;
+                this->retired = node;
+            }
+        }
+
+        void releaseIterator() const {
+            TotalLock lock(this);
+
+            if (--this->iterators == 0) {
+                this->freeRetired();
+            }
+        }
+
+        void freeRetired() const {
+            while (this->retired != NULL) {
+                QueueNode<E>* node = this->retired;
+                this->retired = node->nextRetired;
+                delete node;
+            }
         }
 
         void purgeList() {
-            Pointer< QueueNode<E> > current = this->head->next;
-            Pointer< QueueNode<E> > temp;
+            QueueNode<E>* current = this->head->next;
+            this->head->next = NULL;
             while(current != NULL) {
-                temp = current;
-                current = current->next;
-                temp->next.reset(NULL);
-                temp.reset(NULL);
+                QueueNode<E>* next = current->next;
+                current->unlink();
+                this->release(current);
+                current = next;
             }
         }
     };
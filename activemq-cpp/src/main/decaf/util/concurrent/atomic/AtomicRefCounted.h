@@ -0,0 +1,76 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _DECAF_UTIL_CONCURRENT_ATOMIC_ATOMICREFCOUNTED_H_
+#define _DECAF_UTIL_CONCURRENT_ATOMIC_ATOMICREFCOUNTED_H_
+
+#include <decaf/util/Config.h>
+
+namespace decaf {
+namespace util {
+namespace concurrent {
+namespace atomic {
+
+    class AtomicRefCounter;
+
+    /**
+     * Base class for objects that carry their own reference count.  When a Pointer
+     * using the default AtomicRefCounter takes ownership of an instance of a class
+     * derived from this one it counts references in the object itself rather than
+     * allocating a separate counter, so creating the object and its Pointer costs a
+     * single allocation.
+     *
+     * The count is owned by the Pointer instances that refer to the object, copying
+     * or assigning the object does not copy it.  An object that is not held by any
+     * Pointer has a count of zero and is managed like any other object.
+     *
+     * @since 3.10.0
+     */
+    class DECAF_API AtomicRefCounted {
+    private:
+
+        mutable volatile int references;
+
+        friend class AtomicRefCounter;
+
+    protected:
+
+        AtomicRefCounted() : references(0) {}
+
+        AtomicRefCounted(const AtomicRefCounted&) : references(0) {}
+
+        AtomicRefCounted& operator=(const AtomicRefCounted&) {
+            return *this;
+        }
+
+        ~AtomicRefCounted() {}
+
+    public:
+
+        /**
+         * @return the number of Pointer instances that currently refer to this object,
+         *         the value is only a snapshot when other threads share the object.
+         */
+        int getReferenceCount() const {
+            return this->references;
+        }
+
+    };
+
+}}}}
+
+#endif /* _DECAF_UTIL_CONCURRENT_ATOMIC_ATOMICREFCOUNTED_H_ */
@@ -16,3 +16,21 @@
  */
 
 #include "AtomicRefCounter.h"
+
+#include <decaf/internal/util/concurrent/Atomics.h>
+
+using namespace decaf;
+using namespace decaf::util;
+using namespace decaf::util::concurrent;
+using namespace decaf::util::concurrent::atomic;
+using namespace decaf::internal::util::concurrent;
+
+////////////////////////////////////////////////////////////////////////////////
+void AtomicRefCounter::increment(volatile int* counter) {
+    Atomics::incrementAndGet(counter);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+int AtomicRefCounter::decrement(volatile int* counter) {
+    return Atomics::decrementAndGet(counter);
+}
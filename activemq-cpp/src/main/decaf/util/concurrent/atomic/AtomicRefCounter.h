@@ -18,7 +18,8 @@
 #ifndef _DECAF_UTIL_CONCURRENT_ATOMIC_ATOMICREFCOUNTER_H_
 #define _DECAF_UTIL_CONCURRENT_ATOMIC_ATOMICREFCOUNTER_H_
 
-#include <decaf/util/concurrent/atomic/AtomicInteger.h>
+#include <decaf/util/Config.h>
+#include <decaf/util/concurrent/atomic/AtomicRefCounted.h>
 #include <algorithm>
 
 namespace decaf{
@@ -26,10 +27,19 @@ namespace util{
 namespace concurrent{
 namespace atomic{
 
-    class AtomicRefCounter {
+    /**
+     * The default reference counter used by Pointer.  Objects derived from
+     * AtomicRefCounted are counted in place, any other object gets a counter that
+     * is allocated when the first Pointer takes ownership of it.  A Pointer that
+     * holds NULL has no counter at all.
+     */
+    class DECAF_API AtomicRefCounter {
     private:
 
-        decaf::util::concurrent::atomic::AtomicInteger* counter;
+        volatile int* counter;
+
+        // True when the counter lives inside the pointee and must not be deleted.
+        bool embedded;
 
     private:
 
@@ -37,10 +47,32 @@ namespace atomic{
 
     public:
 
-        AtomicRefCounter() :
-            counter( new decaf::util::concurrent::atomic::AtomicInteger( 1 ) ) {}
-        AtomicRefCounter( const AtomicRefCounter& other ) : counter( other.counter ) {
-            this->counter->incrementAndGet();
+        AtomicRefCounter() : counter( NULL ), embedded( false ) {}
+
+        /**
+         * Adds a reference to the count held by the given object when its type derives
+         * from AtomicRefCounted, otherwise creates the first reference to it with a newly
+         * allocated counter.  Nothing is counted for NULL.  The type must be complete,
+         * a forward declared one would not be known to derive from AtomicRefCounted.
+         *
+         * @param pointee
+         *      The object whose references are counted.
+         */
+        template<typename T>
+        explicit AtomicRefCounter( const T* pointee ) : counter( NULL ), embedded( false ) {
+
+            if( pointee != NULL ) {
+                this->embedded = IsRefCounted<T>::value;
+                this->counter = counterOf( pointee, Selector<IsRefCounted<T>::value>() );
+            }
+        }
+
+        AtomicRefCounter( const AtomicRefCounter& other ) :
+            counter( other.counter ), embedded( other.embedded ) {
+
+            if( this->counter != NULL ) {
+                increment( this->counter );
+            }
         }
 
         virtual ~AtomicRefCounter() {}
@@ -56,6 +88,7 @@ namespace atomic{
          */
         void swap( AtomicRefCounter& other ) {
             std::swap( this->counter, other.counter );
+            std::swap( this->embedded, other.embedded );
         }
 
         /**
@@ -66,12 +99,55 @@ namespace atomic{
          * @return true if the count is now zero.
          */
         bool release() {
-            if( this->counter->decrementAndGet() == 0 ) {
-                delete this->counter;
+            if( this->counter == NULL ) {
+                return false;
+            }
+
+            if( decrement( this->counter ) == 0 ) {
+                if( !this->embedded ) {
+                    delete const_cast<int*>( this->counter );
+                }
+                this->counter = NULL;
                 return true;
             }
             return false;
         }
+
+    private:
+
+        template<bool>
+        struct Selector {};
+
+        /**
+         * Tells whether T derives from AtomicRefCounted, fails to compile unless T is
+         * a complete type.
+         */
+        template<typename T>
+        struct IsRefCounted {
+            typedef char Yes;
+            typedef struct { char value[2]; } No;
+
+            typedef char TypeMustBeComplete[ sizeof( T ) > 0 ? 1 : -1 ];
+
+            static Yes test( const AtomicRefCounted* );
+            static No test( ... );
+
+            static const bool value = sizeof( test( static_cast<const T*>( NULL ) ) ) == sizeof( Yes );
+        };
+
+        static volatile int* counterOf( const AtomicRefCounted* pointee, Selector<true> ) {
+            increment( &pointee->references );
+            return &pointee->references;
+        }
+
+        static volatile int* counterOf( const void* pointee DECAF_UNUSED, Selector<false> ) {
+            return new int( 1 );
+        }
+
+        static void increment( volatile int* counter );
+
+        static int decrement( volatile int* counter );
+
     };
 
 }}}}
@@ -0,0 +1,147 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "BytesMessageBenchmark.h"
+
+#include <activemq/commands/ActiveMQQueue.h>
+#include <activemq/commands/MessageId.h>
+#include <activemq/commands/ProducerId.h>
+#include <activemq/transport/mock/MockTransport.h>
+#include <decaf/io/ByteArrayInputStream.h>
+#include <decaf/io/ByteArrayOutputStream.h>
+#include <decaf/io/DataInputStream.h>
+#include <decaf/io/DataOutputStream.h>
+#include <decaf/lang/System.h>
+#include <decaf/util/Properties.h>
+
+#include <iostream>
+
+using namespace std;
+using namespace activemq;
+using namespace activemq::commands;
+using namespace activemq::transport;
+using namespace activemq::transport::mock;
+using namespace activemq::wireformat;
+using namespace activemq::wireformat::openwire;
+using namespace decaf::io;
+using namespace decaf::lang;
+using namespace decaf::util;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    const int BODY_SIZES[] = { 1024 * 1024, 4 * 1024 * 1024, 10 * 1024 * 1024 };
+    const int NUM_BODY_SIZES = 3;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+BytesMessageBenchmark::BytesMessageBenchmark() :
+    wireFormat(), transport(), messages(), elapsedTimes(NUM_BODY_SIZES, 0), runs(0) {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+BytesMessageBenchmark::~BytesMessageBenchmark() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void BytesMessageBenchmark::setUp() {
+
+    Properties properties;
+    wireFormat.reset(new OpenWireFormat(properties));
+    wireFormat->setTightEncodingEnabled(true);
+    transport.reset(new MockTransport(wireFormat, Pointer<ResponseBuilder>()));
+
+    Pointer<ProducerId> producerId(new ProducerId());
+    producerId->setConnectionId("ID:benchmark-host-12345-1234567890123-1:1");
+    producerId->setSessionId(1);
+    producerId->setValue(1);
+
+    Pointer<ActiveMQDestination> destination(new ActiveMQQueue("BENCHMARK.QUEUE"));
+
+    messages.clear();
+    for (int i = 0; i < NUM_BODY_SIZES; ++i) {
+
+        Pointer<MessageId> messageId(new MessageId());
+        messageId->setProducerId(producerId);
+        messageId->setProducerSequenceId(i + 1);
+
+        Pointer<ActiveMQBytesMessage> message(new ActiveMQBytesMessage());
+        message->setProducerId(producerId);
+        message->setMessageId(messageId);
+        message->setDestination(destination);
+
+        std::vector<unsigned char> body(BODY_SIZES[i]);
+        for (int j = 0; j < BODY_SIZES[i]; ++j) {
+            body[j] = (unsigned char) j;
+        }
+        message->writeBytes(body);
+        message->reset();
+
+        messages.push_back(message);
+    }
+
+    elapsedTimes.assign(NUM_BODY_SIZES, 0);
+    runs = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void BytesMessageBenchmark::tearDown() {
+
+    for (int i = 0; i < NUM_BODY_SIZES && runs > 0; ++i) {
+        std::cout << "BytesMessage round trip of " << (BODY_SIZES[i] / (1024 * 1024))
+                  << " MB: " << (elapsedTimes[i] / runs) << " ms" << std::endl;
+    }
+
+    messages.clear();
+    transport.reset(NULL);
+    wireFormat.reset(NULL);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void BytesMessageBenchmark::roundTrip(const Pointer<ActiveMQBytesMessage>& message) {
+
+    // The producer marshals a copy of the message it was handed.
+    ByteArrayOutputStream buffer;
+    DataOutputStream dataOut(&buffer);
+    Pointer<Command> sent(message->cloneDataStructure());
+    wireFormat->marshal(sent, transport.get(), &dataOut);
+
+    std::pair<unsigned char*, int> bytes = buffer.toByteArray();
+    ByteArrayInputStream receiveBuffer(bytes.first, bytes.second, true);
+    DataInputStream dataIn(&receiveBuffer);
+
+    // The consumer dispatches a copy of the received message and reads its body.
+    Pointer<Command> received = wireFormat->unmarshal(transport.get(), &dataIn);
+    Pointer<ActiveMQBytesMessage> dispatched(
+        dynamic_cast<ActiveMQBytesMessage*>(received.get())->cloneDataStructure());
+
+    dispatched->setReadOnlyBody(true);
+    std::vector<unsigned char> body(dispatched->getBodyLength());
+    dispatched->readBytes(body);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void BytesMessageBenchmark::run() {
+
+    for (int i = 0; i < NUM_BODY_SIZES; ++i) {
+        long long start = System::currentTimeMillis();
+        roundTrip(messages[i]);
+        elapsedTimes[i] += System::currentTimeMillis() - start;
+    }
+
+    runs++;
+}
@@ -0,0 +1,71 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_COMMANDS_BYTESMESSAGEBENCHMARK_H_
+#define _ACTIVEMQ_COMMANDS_BYTESMESSAGEBENCHMARK_H_
+
+#include <benchmark/BenchmarkBase.h>
+
+#include <activemq/commands/ActiveMQBytesMessage.h>
+#include <activemq/transport/Transport.h>
+#include <activemq/wireformat/openwire/OpenWireFormat.h>
+
+#include <vector>
+
+namespace activemq {
+namespace commands {
+
+    /**
+     * Round trips ActiveMQBytesMessages with 1, 4 and 10 MB bodies through an
+     * OpenWireFormat over a MockTransport: the producer's copy is marshaled, the
+     * bytes are unmarshaled on the receiving side, the consumer's copy is taken and
+     * its body read back.  Reports the time for one round trip at each size, which
+     * is dominated by how many times the body is copied along the way.
+     */
+    class BytesMessageBenchmark :
+        public benchmark::BenchmarkBase<activemq::commands::BytesMessageBenchmark, ActiveMQBytesMessage, 5> {
+    private:
+
+        Pointer<wireformat::openwire::OpenWireFormat> wireFormat;
+        Pointer<transport::Transport> transport;
+        std::vector< Pointer<ActiveMQBytesMessage> > messages;
+        std::vector<long long> elapsedTimes;
+        int runs;
+
+    private:
+
+        BytesMessageBenchmark(const BytesMessageBenchmark&);
+        BytesMessageBenchmark& operator=(const BytesMessageBenchmark&);
+
+    public:
+
+        BytesMessageBenchmark();
+        virtual ~BytesMessageBenchmark();
+
+        void setUp();
+        void tearDown();
+        void run();
+
+    private:
+
+        void roundTrip(const Pointer<ActiveMQBytesMessage>& message);
+
+    };
+
+}}
+
+#endif /* _ACTIVEMQ_COMMANDS_BYTESMESSAGEBENCHMARK_H_ */
@@ -0,0 +1,187 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ConsumerDispatchBenchmark.h"
+
+#include <activemq/core/ActiveMQConnectionFactory.h>
+#include <activemq/commands/ActiveMQTextMessage.h>
+#include <activemq/commands/ActiveMQTopic.h>
+#include <activemq/commands/ConsumerId.h>
+#include <activemq/commands/MessageDispatch.h>
+#include <activemq/commands/MessageId.h>
+#include <activemq/commands/ProducerId.h>
+#include <activemq/core/ActiveMQConsumer.h>
+#include <activemq/transport/mock/MockTransport.h>
+
+#include <cms/MessageListener.h>
+#include <cms/Session.h>
+
+#include <decaf/lang/System.h>
+#include <decaf/util/concurrent/CountDownLatch.h>
+#include <decaf/util/concurrent/TimeUnit.h>
+
+#include <iostream>
+#include <memory>
+#include <typeinfo>
+
+using namespace std;
+using namespace activemq;
+using namespace activemq::core;
+using namespace activemq::commands;
+using namespace activemq::transport::mock;
+using namespace decaf::lang;
+using namespace decaf::util::concurrent;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    const int CONSUMER_COUNTS[] = { 1, 10, 100, 1000 };
+    const int NUM_CONSUMER_COUNTS = 4;
+    const int MESSAGES = 20000;
+
+    class CountingListener : public cms::MessageListener {
+    private:
+
+        CountDownLatch* done;
+
+    private:
+
+        CountingListener(const CountingListener&);
+        CountingListener& operator=(const CountingListener&);
+
+    public:
+
+        CountingListener(CountDownLatch* done) : cms::MessageListener(), done(done) {
+        }
+
+        virtual ~CountingListener() {}
+
+        virtual void onMessage(const cms::Message* message) {
+            done->countDown();
+        }
+    };
+
+    Pointer<MessageDispatch> createDispatch(const ActiveMQTopic& topic, const ConsumerId& id, long long sequence) {
+
+        Pointer<ProducerId> producerId(new ProducerId());
+        producerId->setConnectionId(id.getConnectionId());
+        producerId->setSessionId(id.getSessionId());
+        producerId->setValue(1);
+
+        Pointer<MessageId> messageId(new MessageId());
+        messageId->setProducerId(producerId);
+        messageId->setProducerSequenceId(sequence);
+
+        Pointer<ActiveMQTextMessage> message(new ActiveMQTextMessage());
+        message->setText("ConsumerDispatchBenchmark");
+        message->setCMSDestination(&topic);
+        message->setMessageId(messageId);
+
+        Pointer<MessageDispatch> dispatch(new MessageDispatch());
+        dispatch->setMessage(message);
+        dispatch->setDestination(Pointer<ActiveMQDestination>(topic.cloneDataStructure()));
+        dispatch->setConsumerId(Pointer<ConsumerId>(id.cloneDataStructure()));
+
+        return dispatch;
+    }
+
+    /**
+     * Dispatches MESSAGES messages round robin to the given number of consumers of one
+     * session and returns the time taken until every listener has been called.
+     */
+    long long dispatchTo(ActiveMQConnection* connection, MockTransport* transport, int numConsumers) {
+
+        std::auto_ptr<cms::Session> session(connection->createSession(cms::Session::DUPS_OK_ACKNOWLEDGE));
+        ActiveMQTopic topic("ConsumerDispatchBenchmark");
+
+        CountDownLatch done(MESSAGES);
+        CountingListener listener(&done);
+
+        std::vector<ActiveMQConsumer*> consumers;
+        for (int i = 0; i < numConsumers; ++i) {
+            ActiveMQConsumer* consumer = dynamic_cast<ActiveMQConsumer*>(session->createConsumer(&topic));
+            consumer->setMessageListener(&listener);
+            consumers.push_back(consumer);
+        }
+
+        std::vector< Pointer<MessageDispatch> > dispatches;
+        for (int i = 0; i < MESSAGES; ++i) {
+            dispatches.push_back(createDispatch(topic, *consumers[i % numConsumers]->getConsumerId(), i + 1));
+        }
+
+        long long start = System::currentTimeMillis();
+
+        for (int i = 0; i < MESSAGES; ++i) {
+            transport->fireCommand(dispatches[i]);
+        }
+
+        done.await(60, TimeUnit::SECONDS);
+
+        long long elapsed = System::currentTimeMillis() - start;
+
+        session->close();
+        for (std::size_t i = 0; i < consumers.size(); ++i) {
+            delete consumers[i];
+        }
+
+        return elapsed;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+ConsumerDispatchBenchmark::ConsumerDispatchBenchmark() : elapsedTimes(NUM_CONSUMER_COUNTS, 0), runs(0) {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+ConsumerDispatchBenchmark::~ConsumerDispatchBenchmark() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ConsumerDispatchBenchmark::setUp() {
+    elapsedTimes.assign(NUM_CONSUMER_COUNTS, 0);
+    runs = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ConsumerDispatchBenchmark::tearDown() {
+
+    for (int i = 0; i < NUM_CONSUMER_COUNTS; ++i) {
+        long long elapsed = elapsedTimes[i] > 0 ? elapsedTimes[i] : 1;
+        std::cout << "Dispatch to " << CONSUMER_COUNTS[i] << " consumers: "
+                  << ((long long) MESSAGES * runs / elapsed) << " msgs/ms" << std::endl;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ConsumerDispatchBenchmark::run() {
+
+    ActiveMQConnectionFactory factory("mock://127.0.0.1:12345?wireFormat=openwire");
+    std::auto_ptr<ActiveMQConnection> connection(
+        dynamic_cast<ActiveMQConnection*>(factory.createConnection()));
+
+    MockTransport* transport = dynamic_cast<MockTransport*>(
+        connection->getTransport().narrow(typeid(MockTransport)));
+
+    connection->start();
+
+    for (int i = 0; i < NUM_CONSUMER_COUNTS; ++i) {
+        elapsedTimes[i] += dispatchTo(connection.get(), transport, CONSUMER_COUNTS[i]);
+    }
+
+    connection->close();
+    runs++;
+}
@@ -0,0 +1,61 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_CORE_CONSUMERDISPATCHBENCHMARK_H_
+#define _ACTIVEMQ_CORE_CONSUMERDISPATCHBENCHMARK_H_
+
+#include <benchmark/BenchmarkBase.h>
+
+#include <activemq/core/ActiveMQConnection.h>
+
+#include <vector>
+
+namespace activemq {
+namespace core {
+
+    /**
+     * Injects MessageDispatch commands through a MockTransport into a session with
+     * 1, 10, 100 and 1000 consumers, spreading the messages over all of them, and
+     * reports the dispatch rate for each consumer count.  The rate should stay flat
+     * as consumers are added since the session finds the target consumer by id.
+     */
+    class ConsumerDispatchBenchmark :
+        public benchmark::BenchmarkBase<activemq::core::ConsumerDispatchBenchmark, ActiveMQConnection, 2> {
+    private:
+
+        std::vector<long long> elapsedTimes;
+        int runs;
+
+    private:
+
+        ConsumerDispatchBenchmark(const ConsumerDispatchBenchmark&);
+        ConsumerDispatchBenchmark& operator=(const ConsumerDispatchBenchmark&);
+
+    public:
+
+        ConsumerDispatchBenchmark();
+        virtual ~ConsumerDispatchBenchmark();
+
+        void setUp();
+        void tearDown();
+        void run();
+
+    };
+
+}}
+
+#endif /* _ACTIVEMQ_CORE_CONSUMERDISPATCHBENCHMARK_H_ */
@@ -0,0 +1,141 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "DeliveredMessageListBenchmark.h"
+
+#include <activemq/commands/ActiveMQMessage.h>
+#include <activemq/commands/MessageDispatch.h>
+#include <activemq/commands/MessageId.h>
+
+#include <decaf/lang/Pointer.h>
+#include <decaf/lang/System.h>
+#include <decaf/util/LinkedList.h>
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+using namespace activemq;
+using namespace activemq::core;
+using namespace activemq::commands;
+using namespace decaf::lang;
+using namespace decaf::util;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    const int PREFETCH = 1000;
+    const int WINDOWS = 20;
+
+    std::vector< Pointer<MessageDispatch> > createWindow() {
+
+        std::vector< Pointer<MessageDispatch> > window;
+        for (int i = 0; i < PREFETCH; ++i) {
+            Pointer<MessageId> id(new MessageId());
+            id->setProducerSequenceId(i + 1);
+            id->setBrokerSequenceId(i + 1);
+
+            Pointer<ActiveMQMessage> message(new ActiveMQMessage());
+            message->setMessageId(id);
+
+            Pointer<MessageDispatch> dispatch(new MessageDispatch());
+            dispatch->setMessage(message);
+            window.push_back(dispatch);
+        }
+
+        return window;
+    }
+
+    // Fixed seed so every run and both lists see the same ack order.
+    std::vector<int> createAckOrder() {
+
+        std::vector<int> order;
+        for (int i = 0; i < PREFETCH; ++i) {
+            order.push_back(i);
+        }
+
+        unsigned int next = 17;
+        for (int i = PREFETCH - 1; i > 0; --i) {
+            next = next * 1103515245 + 12345;
+            int j = (int) ((next >> 8) % (unsigned int) (i + 1));
+            std::swap(order[i], order[j]);
+        }
+
+        return order;
+    }
+
+    template<typename LIST>
+    long long ackWindows(LIST& list, const std::vector< Pointer<MessageDispatch> >& window,
+                         const std::vector<int>& order) {
+
+        long long start = System::currentTimeMillis();
+
+        for (int w = 0; w < WINDOWS; ++w) {
+            for (int i = 0; i < PREFETCH; ++i) {
+                list.addFirst(window[i]);
+            }
+
+            for (int i = 0; i < PREFETCH; ++i) {
+                const Pointer<MessageDispatch>& dispatch = window[order[i]];
+                if (list.contains(dispatch)) {
+                    list.remove(dispatch);
+                }
+            }
+        }
+
+        return System::currentTimeMillis() - start;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+DeliveredMessageListBenchmark::DeliveredMessageListBenchmark() : indexedTime(0), linkedTime(0), acks(0) {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+DeliveredMessageListBenchmark::~DeliveredMessageListBenchmark() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void DeliveredMessageListBenchmark::setUp() {
+    indexedTime = 0;
+    linkedTime = 0;
+    acks = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void DeliveredMessageListBenchmark::tearDown() {
+
+    std::cout << "Random order individual acks of a " << PREFETCH << " message window: "
+              << "DeliveredMessageList = " << (acks / (indexedTime > 0 ? indexedTime : 1)) << " acks/ms, "
+              << "LinkedList = " << (acks / (linkedTime > 0 ? linkedTime : 1)) << " acks/ms"
+              << std::endl;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void DeliveredMessageListBenchmark::run() {
+
+    std::vector< Pointer<MessageDispatch> > window = createWindow();
+    std::vector<int> order = createAckOrder();
+
+    DeliveredMessageList indexed;
+    indexedTime += ackWindows(indexed, window, order);
+
+    LinkedList< Pointer<MessageDispatch> > linked;
+    linkedTime += ackWindows(linked, window, order);
+
+    acks += (long long) WINDOWS * PREFETCH;
+}
@@ -0,0 +1,56 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_CORE_DELIVEREDMESSAGELISTBENCHMARK_H_
+#define _ACTIVEMQ_CORE_DELIVEREDMESSAGELISTBENCHMARK_H_
+
+#include <benchmark/BenchmarkBase.h>
+
+#include <activemq/core/DeliveredMessageList.h>
+
+namespace activemq {
+namespace core {
+
+    /**
+     * Delivers a full prefetch window of 1000 messages and then acknowledges them
+     * individually in random order, checking contains before each remove the way the
+     * consumer does in INDIVIDUAL_ACKNOWLEDGE mode.  The same sequence is run against
+     * a DeliveredMessageList and against the LinkedList the consumer used before, and
+     * the acks per millisecond of each are reported.
+     */
+    class DeliveredMessageListBenchmark :
+        public benchmark::BenchmarkBase<activemq::core::DeliveredMessageListBenchmark, DeliveredMessageList, 5> {
+    private:
+
+        long long indexedTime;
+        long long linkedTime;
+        long long acks;
+
+    public:
+
+        DeliveredMessageListBenchmark();
+        virtual ~DeliveredMessageListBenchmark();
+
+        void setUp();
+        void tearDown();
+        void run();
+
+    };
+
+}}
+
+#endif /* _ACTIVEMQ_CORE_DELIVEREDMESSAGELISTBENCHMARK_H_ */
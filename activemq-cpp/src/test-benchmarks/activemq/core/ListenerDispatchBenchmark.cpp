@@ -0,0 +1,179 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ListenerDispatchBenchmark.h"
+
+#include <benchmark/AllocationCounter.h>
+
+#include <activemq/core/ActiveMQConnectionFactory.h>
+#include <activemq/commands/ActiveMQTextMessage.h>
+#include <activemq/commands/ActiveMQTopic.h>
+#include <activemq/commands/ConsumerId.h>
+#include <activemq/commands/MessageDispatch.h>
+#include <activemq/commands/MessageId.h>
+#include <activemq/commands/ProducerId.h>
+#include <activemq/core/ActiveMQConsumer.h>
+#include <activemq/transport/mock/MockTransport.h>
+
+#include <cms/MessageListener.h>
+#include <cms/Session.h>
+
+#include <decaf/lang/Boolean.h>
+#include <decaf/lang/System.h>
+
+#include <iostream>
+#include <memory>
+#include <typeinfo>
+#include <vector>
+
+using namespace std;
+using namespace activemq;
+using namespace activemq::core;
+using namespace activemq::commands;
+using namespace activemq::transport::mock;
+using namespace decaf::lang;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    const int WARMUP_MESSAGES = 100;
+    const int MESSAGES = 5000;
+
+    class NullListener : public cms::MessageListener {
+    public:
+
+        virtual ~NullListener() {}
+
+        virtual void onMessage(const cms::Message* message AMQCPP_UNUSED) {
+        }
+    };
+
+    Pointer<MessageDispatch> createDispatch(const ActiveMQTopic& topic, const ConsumerId& id, long long sequence) {
+
+        Pointer<ProducerId> producerId(new ProducerId());
+        producerId->setConnectionId(id.getConnectionId());
+        producerId->setSessionId(id.getSessionId());
+        producerId->setValue(1);
+
+        Pointer<MessageId> messageId(new MessageId());
+        messageId->setProducerId(producerId);
+        messageId->setProducerSequenceId(sequence);
+
+        Pointer<ActiveMQTextMessage> message(new ActiveMQTextMessage());
+        message->setText("ListenerDispatchBenchmark");
+        message->setCMSDestination(&topic);
+        message->setMessageId(messageId);
+
+        Pointer<MessageDispatch> dispatch(new MessageDispatch());
+        dispatch->setMessage(message);
+        dispatch->setDestination(Pointer<ActiveMQDestination>(topic.cloneDataStructure()));
+        dispatch->setConsumerId(Pointer<ConsumerId>(id.cloneDataStructure()));
+
+        return dispatch;
+    }
+
+    /**
+     * Dispatches MESSAGES messages to one listener and returns the allocations made
+     * while doing so, the time taken is added to elapsed.
+     */
+    long long dispatchTo(bool optimizeDispatch, long long& elapsed) {
+
+        ActiveMQConnectionFactory factory(
+            std::string("mock://127.0.0.1:12345?wireFormat=openwire&connection.alwaysSessionAsync=false"
+                        "&connection.optimizeDispatch=") + Boolean::toString(optimizeDispatch));
+
+        std::auto_ptr<ActiveMQConnection> connection(
+            dynamic_cast<ActiveMQConnection*>(factory.createConnection()));
+
+        MockTransport* transport = dynamic_cast<MockTransport*>(
+            connection->getTransport().narrow(typeid(MockTransport)));
+
+        connection->start();
+
+        std::auto_ptr<cms::Session> session(connection->createSession(cms::Session::DUPS_OK_ACKNOWLEDGE));
+        ActiveMQTopic topic("ListenerDispatchBenchmark");
+
+        NullListener listener;
+        std::auto_ptr<ActiveMQConsumer> consumer(
+            dynamic_cast<ActiveMQConsumer*>(session->createConsumer(&topic)));
+        consumer->setMessageListener(&listener);
+
+        std::vector< Pointer<MessageDispatch> > dispatches;
+        for (int i = 0; i < WARMUP_MESSAGES + MESSAGES; ++i) {
+            dispatches.push_back(createDispatch(topic, *consumer->getConsumerId(), i + 1));
+        }
+
+        for (int i = 0; i < WARMUP_MESSAGES; ++i) {
+            transport->fireCommand(dispatches[i]);
+        }
+
+        long long start = System::nanoTime();
+        benchmark::AllocationCounter::start();
+
+        for (int i = WARMUP_MESSAGES; i < WARMUP_MESSAGES + MESSAGES; ++i) {
+            transport->fireCommand(dispatches[i]);
+        }
+
+        long long allocations = benchmark::AllocationCounter::stop();
+        elapsed += System::nanoTime() - start;
+
+        consumer->close();
+        session->close();
+        connection->close();
+
+        return allocations;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+ListenerDispatchBenchmark::ListenerDispatchBenchmark() :
+    regularAllocations(0), optimizedAllocations(0), regularTime(0), optimizedTime(0), messageCount(0) {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+ListenerDispatchBenchmark::~ListenerDispatchBenchmark() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ListenerDispatchBenchmark::setUp() {
+    regularAllocations = 0;
+    optimizedAllocations = 0;
+    regularTime = 0;
+    optimizedTime = 0;
+    messageCount = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ListenerDispatchBenchmark::tearDown() {
+
+    long long messages = messageCount > 0 ? messageCount : 1;
+
+    std::cout << "Regular listener dispatch: "
+              << ((double) regularAllocations / messages) << " allocations/msg, "
+              << (regularTime / messages) << " ns/msg" << std::endl;
+    std::cout << "Optimized listener dispatch: "
+              << ((double) optimizedAllocations / messages) << " allocations/msg, "
+              << (optimizedTime / messages) << " ns/msg" << std::endl;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ListenerDispatchBenchmark::run() {
+
+    regularAllocations += dispatchTo(false, regularTime);
+    optimizedAllocations += dispatchTo(true, optimizedTime);
+    messageCount += MESSAGES;
+}
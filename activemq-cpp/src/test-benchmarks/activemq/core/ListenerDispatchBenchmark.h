@@ -0,0 +1,63 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_CORE_LISTENERDISPATCHBENCHMARK_H_
+#define _ACTIVEMQ_CORE_LISTENERDISPATCHBENCHMARK_H_
+
+#include <benchmark/BenchmarkBase.h>
+
+#include <activemq/core/ActiveMQConnection.h>
+
+namespace activemq {
+namespace core {
+
+    /**
+     * Dispatches messages to a MessageListener of a DUPS_OK_ACKNOWLEDGE topic consumer
+     * on the regular path and on the one enabled by the optimizeDispatch option, and
+     * reports the heap allocations made per message and the dispatch rate of each.
+     * The session dispatches on the injecting thread so that the allocations can be
+     * counted, the dispatch commands are created before counting starts.
+     */
+    class ListenerDispatchBenchmark :
+        public benchmark::BenchmarkBase<activemq::core::ListenerDispatchBenchmark, ActiveMQConnection, 10> {
+    private:
+
+        long long regularAllocations;
+        long long optimizedAllocations;
+        long long regularTime;
+        long long optimizedTime;
+        long long messageCount;
+
+    private:
+
+        ListenerDispatchBenchmark(const ListenerDispatchBenchmark&);
+        ListenerDispatchBenchmark& operator=(const ListenerDispatchBenchmark&);
+
+    public:
+
+        ListenerDispatchBenchmark();
+        virtual ~ListenerDispatchBenchmark();
+
+        void setUp();
+        void tearDown();
+        void run();
+
+    };
+
+}}
+
+#endif /* _ACTIVEMQ_CORE_LISTENERDISPATCHBENCHMARK_H_ */
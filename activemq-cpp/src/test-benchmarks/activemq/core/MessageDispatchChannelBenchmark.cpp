@@ -0,0 +1,132 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MessageDispatchChannelBenchmark.h"
+
+#include <activemq/commands/MessageDispatch.h>
+#include <activemq/core/FifoMessageDispatchChannel.h>
+#include <activemq/core/SimplePriorityMessageDispatchChannel.h>
+
+#include <decaf/lang/Pointer.h>
+#include <decaf/lang/System.h>
+#include <decaf/lang/Thread.h>
+
+#include <iostream>
+#include <vector>
+
+using namespace activemq;
+using namespace activemq::core;
+using namespace activemq::commands;
+using namespace decaf::lang;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    const int PREFETCH = 1000;
+    const int MESSAGES = 200000;
+
+    class ChannelProducer : public Thread {
+    private:
+
+        MessageDispatchChannel* channel;
+        const std::vector< Pointer<MessageDispatch> >* dispatches;
+
+    private:
+
+        ChannelProducer(const ChannelProducer&);
+        ChannelProducer& operator=(const ChannelProducer&);
+
+    public:
+
+        ChannelProducer(MessageDispatchChannel* channel, const std::vector< Pointer<MessageDispatch> >* dispatches) :
+            Thread(), channel(channel), dispatches(dispatches) {
+        }
+
+        virtual ~ChannelProducer() {}
+
+        virtual void run() {
+            for (int i = 0; i < MESSAGES; ++i) {
+                channel->enqueue((*dispatches)[i % PREFETCH]);
+            }
+        }
+    };
+
+    long long transfer(MessageDispatchChannel& channel, const std::vector< Pointer<MessageDispatch> >& dispatches) {
+
+        channel.start();
+
+        long long start = System::currentTimeMillis();
+
+        ChannelProducer producer(&channel, &dispatches);
+        producer.start();
+
+        for (int i = 0; i < MESSAGES; ++i) {
+            channel.dequeue(-1);
+        }
+
+        producer.join();
+
+        return System::currentTimeMillis() - start;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+MessageDispatchChannelBenchmark::MessageDispatchChannelBenchmark() :
+    fifoTime(0), priorityTime(0), ringTime(0), messages(0) {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+MessageDispatchChannelBenchmark::~MessageDispatchChannelBenchmark() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MessageDispatchChannelBenchmark::setUp() {
+    fifoTime = 0;
+    priorityTime = 0;
+    ringTime = 0;
+    messages = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MessageDispatchChannelBenchmark::tearDown() {
+
+    std::cout << "Producer to consumer hand off of " << MESSAGES << " messages: "
+              << "Fifo = " << (messages / (fifoTime > 0 ? fifoTime : 1)) << " msgs/ms, "
+              << "SimplePriority = " << (messages / (priorityTime > 0 ? priorityTime : 1)) << " msgs/ms, "
+              << "Ring = " << (messages / (ringTime > 0 ? ringTime : 1)) << " msgs/ms"
+              << std::endl;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MessageDispatchChannelBenchmark::run() {
+
+    std::vector< Pointer<MessageDispatch> > dispatches;
+    for (int i = 0; i < PREFETCH; ++i) {
+        dispatches.push_back(Pointer<MessageDispatch>(new MessageDispatch()));
+    }
+
+    FifoMessageDispatchChannel fifo;
+    fifoTime += transfer(fifo, dispatches);
+
+    SimplePriorityMessageDispatchChannel priority;
+    priorityTime += transfer(priority, dispatches);
+
+    RingMessageDispatchChannel ring(PREFETCH);
+    ringTime += transfer(ring, dispatches);
+
+    messages += MESSAGES;
+}
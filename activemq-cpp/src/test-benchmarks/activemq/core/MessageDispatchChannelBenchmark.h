@@ -0,0 +1,56 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_CORE_MESSAGEDISPATCHCHANNELBENCHMARK_H_
+#define _ACTIVEMQ_CORE_MESSAGEDISPATCHCHANNELBENCHMARK_H_
+
+#include <benchmark/BenchmarkBase.h>
+
+#include <activemq/core/RingMessageDispatchChannel.h>
+
+namespace activemq {
+namespace core {
+
+    /**
+     * Hands messages from a producer thread to a consumer blocked in dequeue, the way
+     * the transport thread feeds a consumer's dispatch channel.  The same transfer
+     * is run through the Fifo, SimplePriority and Ring channels and the messages per
+     * millisecond of each are reported.
+     */
+    class MessageDispatchChannelBenchmark :
+        public benchmark::BenchmarkBase<activemq::core::MessageDispatchChannelBenchmark, RingMessageDispatchChannel, 5> {
+    private:
+
+        long long fifoTime;
+        long long priorityTime;
+        long long ringTime;
+        long long messages;
+
+    public:
+
+        MessageDispatchChannelBenchmark();
+        virtual ~MessageDispatchChannelBenchmark();
+
+        void setUp();
+        void tearDown();
+        void run();
+
+    };
+
+}}
+
+#endif /* _ACTIVEMQ_CORE_MESSAGEDISPATCHCHANNELBENCHMARK_H_ */
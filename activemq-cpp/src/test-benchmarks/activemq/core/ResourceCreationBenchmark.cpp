@@ -0,0 +1,125 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ResourceCreationBenchmark.h"
+
+#include <activemq/core/ActiveMQConnectionFactory.h>
+#include <activemq/commands/ActiveMQTopic.h>
+
+#include <cms/MessageConsumer.h>
+#include <cms/Session.h>
+
+#include <decaf/lang/Boolean.h>
+#include <decaf/lang/Long.h>
+#include <decaf/lang/System.h>
+
+#include <iostream>
+#include <memory>
+#include <vector>
+
+using namespace std;
+using namespace activemq;
+using namespace activemq::core;
+using namespace activemq::commands;
+using namespace decaf::lang;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    const int CONSUMERS = 1000;
+    const long long ROUND_TRIP_MILLIS = 1;
+
+    /**
+     * Creates CONSUMERS consumers and returns the nanoseconds taken until each of them
+     * has been confirmed by the broker.
+     */
+    long long createConsumers(bool pipelineCreation) {
+
+        ActiveMQConnectionFactory factory(
+            std::string("mock://127.0.0.1:12345?wireFormat=openwire&responseDelay=") +
+            Long::toString(ROUND_TRIP_MILLIS) +
+            "&connection.pipelineCreation=" + Boolean::toString(pipelineCreation));
+
+        std::auto_ptr<cms::Connection> connection(factory.createConnection());
+        connection->start();
+
+        std::auto_ptr<cms::Session> session(connection->createSession(cms::Session::AUTO_ACKNOWLEDGE));
+        ActiveMQTopic topic("ResourceCreationBenchmark");
+
+        std::vector<cms::MessageConsumer*> consumers;
+        consumers.reserve(CONSUMERS);
+
+        long long start = System::nanoTime();
+
+        for (int i = 0; i < CONSUMERS; ++i) {
+            consumers.push_back(session->createConsumer(&topic));
+        }
+
+        // The first use of a consumer waits for its creation to be confirmed.
+        for (int i = 0; i < CONSUMERS; ++i) {
+            delete consumers[i]->receiveNoWait();
+        }
+
+        long long elapsed = System::nanoTime() - start;
+
+        for (int i = 0; i < CONSUMERS; ++i) {
+            consumers[i]->close();
+            delete consumers[i];
+        }
+
+        session->close();
+        connection->close();
+
+        return elapsed;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+ResourceCreationBenchmark::ResourceCreationBenchmark() : synchronousTime(0), pipelinedTime(0), runs(0) {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+ResourceCreationBenchmark::~ResourceCreationBenchmark() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ResourceCreationBenchmark::setUp() {
+    synchronousTime = 0;
+    pipelinedTime = 0;
+    runs = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ResourceCreationBenchmark::tearDown() {
+
+    int count = runs > 0 ? runs : 1;
+
+    std::cout << "Synchronous creation of " << CONSUMERS << " consumers at "
+              << ROUND_TRIP_MILLIS << " ms RTT: "
+              << (synchronousTime / count / 1000000) << " ms" << std::endl;
+    std::cout << "Pipelined creation of " << CONSUMERS << " consumers at "
+              << ROUND_TRIP_MILLIS << " ms RTT: "
+              << (pipelinedTime / count / 1000000) << " ms" << std::endl;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ResourceCreationBenchmark::run() {
+
+    synchronousTime += createConsumers(false);
+    pipelinedTime += createConsumers(true);
+    runs++;
+}
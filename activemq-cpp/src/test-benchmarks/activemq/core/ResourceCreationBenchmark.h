@@ -0,0 +1,60 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_CORE_RESOURCECREATIONBENCHMARK_H_
+#define _ACTIVEMQ_CORE_RESOURCECREATIONBENCHMARK_H_
+
+#include <benchmark/BenchmarkBase.h>
+
+#include <activemq/core/ActiveMQConnection.h>
+
+namespace activemq {
+namespace core {
+
+    /**
+     * Creates 1,000 consumers over a MockTransport whose responses arrive after a
+     * simulated round trip, once waiting for each ConsumerInfo response in turn and
+     * once with the pipelineCreation option so the ConsumerInfo commands go out back
+     * to back.  Reports the time taken until every consumer is usable in each mode.
+     */
+    class ResourceCreationBenchmark :
+        public benchmark::BenchmarkBase<activemq::core::ResourceCreationBenchmark, ActiveMQConnection, 3> {
+    private:
+
+        long long synchronousTime;
+        long long pipelinedTime;
+        int runs;
+
+    private:
+
+        ResourceCreationBenchmark(const ResourceCreationBenchmark&);
+        ResourceCreationBenchmark& operator=(const ResourceCreationBenchmark&);
+
+    public:
+
+        ResourceCreationBenchmark();
+        virtual ~ResourceCreationBenchmark();
+
+        void setUp();
+        void tearDown();
+        void run();
+
+    };
+
+}}
+
+#endif /* _ACTIVEMQ_CORE_RESOURCECREATIONBENCHMARK_H_ */
@@ -0,0 +1,143 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "HashedWheelTimerBenchmark.h"
+
+#include <decaf/lang/System.h>
+#include <decaf/lang/Thread.h>
+#include <decaf/util/Timer.h>
+#include <decaf/util/TimerTask.h>
+#include <decaf/util/concurrent/atomic/AtomicInteger.h>
+
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace activemq;
+using namespace activemq::threads;
+using namespace decaf::lang;
+using namespace decaf::util;
+using namespace decaf::util::concurrent::atomic;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    const int CONNECTIONS = 100;
+    const long long READ_CHECK_TIME = 300;
+    const long long WRITE_CHECK_TIME = 100;
+    const long long RUN_TIME = 1000;
+
+    // Stands in for a Read or Write checker, each run is one wakeup of the thread
+    // that a per check Timer would need.
+    class CheckTask : public TimerTask {
+    private:
+
+        AtomicInteger* runs;
+
+    private:
+
+        CheckTask(const CheckTask&);
+        CheckTask& operator=(const CheckTask&);
+
+    public:
+
+        CheckTask(AtomicInteger* runs) : TimerTask(), runs(runs) {
+        }
+
+        virtual ~CheckTask() {}
+
+        virtual void run() {
+            runs->incrementAndGet();
+        }
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+HashedWheelTimerBenchmark::HashedWheelTimerBenchmark() : wheelWakeups(0), timerWakeups(0), elapsedTime(0) {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+HashedWheelTimerBenchmark::~HashedWheelTimerBenchmark() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void HashedWheelTimerBenchmark::setUp() {
+    wheelWakeups = 0;
+    timerWakeups = 0;
+    elapsedTime = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void HashedWheelTimerBenchmark::tearDown() {
+
+    if (elapsedTime > 0) {
+        std::cout << "Keep alive checks for " << CONNECTIONS << " connections: "
+                  << "timer wheel = 1 thread, " << (wheelWakeups * 1000 / elapsedTime) << " wakeups/s, "
+                  << "Timer per check = " << (CONNECTIONS * 2) << " threads, "
+                  << (timerWakeups * 1000 / elapsedTime) << " wakeups/s" << std::endl;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void HashedWheelTimerBenchmark::run() {
+
+    AtomicInteger runs;
+    std::vector< Pointer<TimerTask> > tasks;
+
+    for (int i = 0; i < CONNECTIONS * 2; ++i) {
+        tasks.push_back(Pointer<TimerTask>(new CheckTask(&runs)));
+    }
+
+    {
+        HashedWheelTimer wheel("HashedWheelTimerBenchmark");
+
+        for (int i = 0; i < CONNECTIONS; ++i) {
+            wheel.schedule(tasks[i * 2], 0, WRITE_CHECK_TIME);
+            wheel.schedule(tasks[i * 2 + 1], 0, READ_CHECK_TIME);
+        }
+
+        Thread::sleep(RUN_TIME);
+        wheelWakeups += wheel.getWakeupCount();
+        wheel.shutdown();
+    }
+
+    runs.set(0);
+
+    {
+        std::vector< Pointer<Timer> > timers;
+
+        for (int i = 0; i < CONNECTIONS; ++i) {
+            Pointer<Timer> writeTimer(new Timer("Write Check Timer"));
+            Pointer<Timer> readTimer(new Timer("Read Check Timer"));
+
+            writeTimer->scheduleAtFixedRate(Pointer<TimerTask>(new CheckTask(&runs)), 0, WRITE_CHECK_TIME);
+            readTimer->scheduleAtFixedRate(Pointer<TimerTask>(new CheckTask(&runs)), 0, READ_CHECK_TIME);
+
+            timers.push_back(writeTimer);
+            timers.push_back(readTimer);
+        }
+
+        Thread::sleep(RUN_TIME);
+        timerWakeups += runs.get();
+
+        for (std::size_t i = 0; i < timers.size(); ++i) {
+            timers[i]->cancel();
+        }
+    }
+
+    elapsedTime += RUN_TIME;
+}
@@ -0,0 +1,60 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_THREADS_HASHEDWHEELTIMERBENCHMARK_H_
+#define _ACTIVEMQ_THREADS_HASHEDWHEELTIMERBENCHMARK_H_
+
+#include <benchmark/BenchmarkBase.h>
+
+#include <activemq/threads/HashedWheelTimer.h>
+
+namespace activemq {
+namespace threads {
+
+    /**
+     * Runs the read and write checks of a number of simulated connections, with the
+     * periods the InactivityMonitor would use, once on a shared HashedWheelTimer and
+     * once with a decaf Timer per check as the monitor used to, and reports the
+     * number of threads and timer thread wakeups per second each approach needs.
+     */
+    class HashedWheelTimerBenchmark :
+        public benchmark::BenchmarkBase<activemq::threads::HashedWheelTimerBenchmark, HashedWheelTimer, 2> {
+    private:
+
+        long long wheelWakeups;
+        long long timerWakeups;
+        long long elapsedTime;
+
+    private:
+
+        HashedWheelTimerBenchmark(const HashedWheelTimerBenchmark&);
+        HashedWheelTimerBenchmark& operator=(const HashedWheelTimerBenchmark&);
+
+    public:
+
+        HashedWheelTimerBenchmark();
+        virtual ~HashedWheelTimerBenchmark();
+
+        void setUp();
+        void tearDown();
+        void run();
+
+    };
+
+}}
+
+#endif /* _ACTIVEMQ_THREADS_HASHEDWHEELTIMERBENCHMARK_H_ */
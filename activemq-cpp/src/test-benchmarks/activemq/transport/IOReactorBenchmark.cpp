@@ -0,0 +1,263 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "IOReactorBenchmark.h"
+
+#include <activemq/commands/ConnectionInfo.h>
+#include <activemq/transport/DefaultTransportListener.h>
+#include <activemq/transport/tcp/TcpTransportFactory.h>
+
+#include <decaf/internal/net/SocketPoller.h>
+#include <decaf/io/InputStream.h>
+#include <decaf/io/OutputStream.h>
+#include <decaf/lang/Integer.h>
+#include <decaf/lang/Runnable.h>
+#include <decaf/lang/System.h>
+#include <decaf/lang/Thread.h>
+#include <decaf/net/ServerSocket.h>
+#include <decaf/net/Socket.h>
+#include <decaf/net/URI.h>
+#include <decaf/util/concurrent/CountDownLatch.h>
+
+#include <iostream>
+#include <memory>
+
+using namespace std;
+using namespace activemq;
+using namespace activemq::commands;
+using namespace activemq::transport;
+using namespace activemq::transport::tcp;
+using namespace decaf::internal::net;
+using namespace decaf::io;
+using namespace decaf::lang;
+using namespace decaf::net;
+using namespace decaf::util::concurrent;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    const int CONNECTION_COUNTS[] = { 50, 200, 400 };
+    const int NUM_CONNECTION_COUNTS = 3;
+    const int ROUNDS = 100;
+
+    /**
+     * Accepts the given number of connections and writes back whatever it reads
+     * from them, serving all of them from one polling thread.
+     */
+    class EchoServer : public Runnable {
+    private:
+
+        ServerSocket server;
+        SocketPoller poller;
+        std::vector<Socket*> sockets;
+        int connections;
+        volatile bool done;
+        Thread thread;
+
+    private:
+
+        EchoServer(const EchoServer&);
+        EchoServer& operator=(const EchoServer&);
+
+    public:
+
+        EchoServer(int connections) :
+            Runnable(), server(0, connections), poller(connections), sockets(), connections(connections), done(false), thread(this) {
+        }
+
+        virtual ~EchoServer() {
+            for (std::size_t i = 0; i < sockets.size(); ++i) {
+                delete sockets[i];
+            }
+        }
+
+        int getLocalPort() const {
+            return server.getLocalPort();
+        }
+
+        void start() {
+            thread.start();
+        }
+
+        void stop() {
+            done = true;
+            poller.wakeup();
+            thread.join();
+
+            for (std::size_t i = 0; i < sockets.size(); ++i) {
+                try {
+                    sockets[i]->close();
+                } catch (...) {
+                }
+            }
+            server.close();
+        }
+
+        virtual void run() {
+
+            try {
+                for (int i = 0; i < connections; ++i) {
+                    sockets.push_back(server.accept());
+                    poller.add(sockets.back(), sockets.back());
+                }
+
+                std::vector<unsigned char> buffer(64 * 1024);
+                std::vector<void*> ready;
+
+                while (!done) {
+                    poller.poll(ready, -1);
+
+                    for (std::size_t i = 0; i < ready.size(); ++i) {
+                        Socket* socket = static_cast<Socket*>(ready[i]);
+                        InputStream* in = socket->getInputStream();
+
+                        int count = std::min(std::max(in->available(), 1), (int) buffer.size());
+                        int read = in->read(&buffer[0], (int) buffer.size(), 0, count);
+                        if (read == -1) {
+                            poller.remove(socket);
+                            continue;
+                        }
+
+                        socket->getOutputStream()->write(&buffer[0], (int) buffer.size(), 0, read);
+                    }
+                }
+            } catch (decaf::lang::Exception& ex) {
+                std::cout << "Echo server failed: " << ex.getMessage() << std::endl;
+            }
+        }
+    };
+
+    class EchoListener : public DefaultTransportListener {
+    private:
+
+        CountDownLatch* volatile latch;
+
+    private:
+
+        EchoListener(const EchoListener&);
+        EchoListener& operator=(const EchoListener&);
+
+    public:
+
+        EchoListener() : DefaultTransportListener(), latch(NULL) {}
+
+        virtual ~EchoListener() {}
+
+        void setLatch(CountDownLatch* latch) {
+            this->latch = latch;
+        }
+
+        virtual void onCommand(const Pointer<Command> command) {
+            // The echoed WireFormatInfo completes the negotiation and is not counted.
+            if (command->isConnectionInfo() && latch != NULL) {
+                latch->countDown();
+            }
+        }
+    };
+
+    /**
+     * Connects the given number of transports to a new echo server, then times the
+     * rounds of one command sent on each transport and echoed back to it.
+     */
+    long long echoRounds(int connections, bool useReactor) {
+
+        EchoServer server(connections);
+        server.start();
+
+        URI uri("tcp://127.0.0.1:" + Integer::toString(server.getLocalPort()) +
+                "?transport.useInactivityMonitor=false&transport.useReactor=" + (useReactor ? "true" : "false"));
+
+        TcpTransportFactory factory;
+        std::vector< Pointer<Transport> > transports;
+        std::vector<EchoListener*> listeners;
+
+        for (int i = 0; i < connections; ++i) {
+            listeners.push_back(new EchoListener());
+            transports.push_back(factory.createComposite(uri));
+            transports.back()->setTransportListener(listeners.back());
+            transports.back()->start();
+        }
+
+        Pointer<ConnectionInfo> info(new ConnectionInfo());
+        info->setClientId("IOReactorBenchmark");
+
+        long long start = System::currentTimeMillis();
+
+        for (int round = 0; round < ROUNDS; ++round) {
+
+            CountDownLatch echoed(connections);
+            for (int i = 0; i < connections; ++i) {
+                listeners[i]->setLatch(&echoed);
+                transports[i]->oneway(info);
+            }
+
+            echoed.await();
+        }
+
+        long long elapsed = System::currentTimeMillis() - start;
+
+        for (int i = 0; i < connections; ++i) {
+            transports[i]->close();
+            delete listeners[i];
+        }
+
+        server.stop();
+
+        return elapsed;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+IOReactorBenchmark::IOReactorBenchmark() :
+    threadedTimes(NUM_CONNECTION_COUNTS, 0), reactorTimes(NUM_CONNECTION_COUNTS, 0), reactorThreads(NUM_CONNECTION_COUNTS, 0), runs(0) {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+IOReactorBenchmark::~IOReactorBenchmark() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void IOReactorBenchmark::setUp() {
+    threadedTimes.assign(NUM_CONNECTION_COUNTS, 0);
+    reactorTimes.assign(NUM_CONNECTION_COUNTS, 0);
+    reactorThreads.assign(NUM_CONNECTION_COUNTS, 0);
+    runs = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void IOReactorBenchmark::tearDown() {
+
+    for (int i = 0; i < NUM_CONNECTION_COUNTS; ++i) {
+        std::cout << "Echo round over " << CONNECTION_COUNTS[i] << " connections, "
+                  << "reader threads: " << ((double) threadedTimes[i] / (runs * ROUNDS)) << " ms with "
+                  << CONNECTION_COUNTS[i] << " threads, "
+                  << "reactor: " << ((double) reactorTimes[i] / (runs * ROUNDS)) << " ms with "
+                  << reactorThreads[i] << " threads" << std::endl;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void IOReactorBenchmark::run() {
+
+    for (int i = 0; i < NUM_CONNECTION_COUNTS; ++i) {
+        threadedTimes[i] += echoRounds(CONNECTION_COUNTS[i], false);
+        reactorTimes[i] += echoRounds(CONNECTION_COUNTS[i], true);
+        reactorThreads[i] = IOReactor::getInstance().getThreadCount();
+    }
+
+    runs++;
+}
@@ -0,0 +1,64 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_TRANSPORT_IOREACTORBENCHMARK_H_
+#define _ACTIVEMQ_TRANSPORT_IOREACTORBENCHMARK_H_
+
+#include <benchmark/BenchmarkBase.h>
+
+#include <activemq/transport/IOReactor.h>
+
+#include <vector>
+
+namespace activemq {
+namespace transport {
+
+    /**
+     * Opens 50, 200 and 400 TCP transports to a loopback echo server that stands in for
+     * the broker, once with a reader thread per transport and once with the shared
+     * IOReactor, then sends a command on every transport and waits for all the echoes
+     * for a number of rounds.  Reports the time for one round at each connection count
+     * along with the number of threads reading the sockets.
+     */
+    class IOReactorBenchmark :
+        public benchmark::BenchmarkBase<activemq::transport::IOReactorBenchmark, IOReactor, 2> {
+    private:
+
+        std::vector<long long> threadedTimes;
+        std::vector<long long> reactorTimes;
+        std::vector<int> reactorThreads;
+        int runs;
+
+    private:
+
+        IOReactorBenchmark(const IOReactorBenchmark&);
+        IOReactorBenchmark& operator=(const IOReactorBenchmark&);
+
+    public:
+
+        IOReactorBenchmark();
+        virtual ~IOReactorBenchmark();
+
+        void setUp();
+        void tearDown();
+        void run();
+
+    };
+
+}}
+
+#endif /* _ACTIVEMQ_TRANSPORT_IOREACTORBENCHMARK_H_ */
@@ -0,0 +1,171 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "FailoverTransportBenchmark.h"
+
+#include <activemq/core/ActiveMQConnection.h>
+#include <activemq/core/ActiveMQConnectionFactory.h>
+
+#include <cms/DeliveryMode.h>
+#include <cms/MessageProducer.h>
+#include <cms/Session.h>
+#include <cms/TextMessage.h>
+#include <cms/Topic.h>
+
+#include <decaf/lang/Runnable.h>
+#include <decaf/lang/System.h>
+#include <decaf/lang/Thread.h>
+#include <decaf/util/concurrent/CountDownLatch.h>
+
+#include <iostream>
+#include <memory>
+
+using namespace std;
+using namespace activemq;
+using namespace activemq::core;
+using namespace activemq::transport;
+using namespace activemq::transport::failover;
+using namespace decaf::lang;
+using namespace decaf::util::concurrent;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    const int PRODUCER_COUNTS[] = { 1, 4, 16 };
+    const int NUM_PRODUCER_COUNTS = 3;
+    const int MESSAGES = 48000;
+
+    class ProducerTask : public Runnable {
+    private:
+
+        cms::Connection* connection;
+        CountDownLatch* ready;
+        CountDownLatch* go;
+        int messages;
+
+    private:
+
+        ProducerTask(const ProducerTask&);
+        ProducerTask& operator=(const ProducerTask&);
+
+    public:
+
+        ProducerTask(cms::Connection* connection, CountDownLatch* ready, CountDownLatch* go, int messages) :
+            Runnable(), connection(connection), ready(ready), go(go), messages(messages) {
+        }
+
+        virtual ~ProducerTask() {}
+
+        virtual void run() {
+
+            std::auto_ptr<cms::Session> session(connection->createSession(cms::Session::AUTO_ACKNOWLEDGE));
+            std::auto_ptr<cms::Topic> topic(session->createTopic("FailoverTransportBenchmark"));
+            std::auto_ptr<cms::MessageProducer> producer(session->createProducer(topic.get()));
+            producer->setDeliveryMode(cms::DeliveryMode::NON_PERSISTENT);
+
+            std::auto_ptr<cms::TextMessage> message(session->createTextMessage("FailoverTransportBenchmark"));
+
+            ready->countDown();
+            go->await();
+
+            for (int i = 0; i < messages; ++i) {
+                producer->send(message.get());
+            }
+
+            producer->close();
+            session->close();
+        }
+    };
+
+    /**
+     * Sends MESSAGES messages split evenly over the given number of producer threads
+     * and returns the time taken until every thread has finished sending.
+     */
+    long long sendFrom(cms::Connection* connection, int numProducers) {
+
+        CountDownLatch ready(numProducers);
+        CountDownLatch go(1);
+
+        std::vector<ProducerTask*> tasks;
+        std::vector<Thread*> threads;
+        for (int i = 0; i < numProducers; ++i) {
+            tasks.push_back(new ProducerTask(connection, &ready, &go, MESSAGES / numProducers));
+            threads.push_back(new Thread(tasks.back()));
+            threads.back()->start();
+        }
+
+        ready.await();
+
+        long long start = System::currentTimeMillis();
+        go.countDown();
+
+        for (int i = 0; i < numProducers; ++i) {
+            threads[i]->join();
+        }
+
+        long long elapsed = System::currentTimeMillis() - start;
+
+        for (int i = 0; i < numProducers; ++i) {
+            delete threads[i];
+            delete tasks[i];
+        }
+
+        return elapsed;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+FailoverTransportBenchmark::FailoverTransportBenchmark() : elapsedTimes(NUM_PRODUCER_COUNTS, 0), runs(0) {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+FailoverTransportBenchmark::~FailoverTransportBenchmark() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void FailoverTransportBenchmark::setUp() {
+    elapsedTimes.assign(NUM_PRODUCER_COUNTS, 0);
+    runs = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void FailoverTransportBenchmark::tearDown() {
+
+    for (int i = 0; i < NUM_PRODUCER_COUNTS; ++i) {
+        long long elapsed = elapsedTimes[i] > 0 ? elapsedTimes[i] : 1;
+        std::cout << "Failover send from " << PRODUCER_COUNTS[i] << " producers: "
+                  << ((long long) MESSAGES * runs / elapsed) << " msgs/ms" << std::endl;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void FailoverTransportBenchmark::run() {
+
+    ActiveMQConnectionFactory factory(
+        "failover://(mock://localhost:61616?wireFormat=openwire)?randomize=false");
+    factory.setUseAsyncSend(true);
+
+    std::auto_ptr<cms::Connection> connection(factory.createConnection());
+    connection->start();
+
+    for (int i = 0; i < NUM_PRODUCER_COUNTS; ++i) {
+        elapsedTimes[i] += sendFrom(connection.get(), PRODUCER_COUNTS[i]);
+    }
+
+    connection->close();
+    runs++;
+}
@@ -0,0 +1,63 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_TRANSPORT_FAILOVER_FAILOVERTRANSPORTBENCHMARK_H_
+#define _ACTIVEMQ_TRANSPORT_FAILOVER_FAILOVERTRANSPORTBENCHMARK_H_
+
+#include <benchmark/BenchmarkBase.h>
+
+#include <activemq/transport/failover/FailoverTransport.h>
+
+#include <vector>
+
+namespace activemq {
+namespace transport {
+namespace failover {
+
+    /**
+     * Sends non-persistent messages from 1, 4 and 16 producer threads, each with its
+     * own session, over a MockTransport wrapped in a FailoverTransport and reports
+     * the aggregate send rate for each thread count.  While connected the producers
+     * should not serialize on the failover transport, so the rate should not fall as
+     * threads are added.
+     */
+    class FailoverTransportBenchmark :
+        public benchmark::BenchmarkBase<activemq::transport::failover::FailoverTransportBenchmark, FailoverTransport, 2> {
+    private:
+
+        std::vector<long long> elapsedTimes;
+        int runs;
+
+    private:
+
+        FailoverTransportBenchmark(const FailoverTransportBenchmark&);
+        FailoverTransportBenchmark& operator=(const FailoverTransportBenchmark&);
+
+    public:
+
+        FailoverTransportBenchmark();
+        virtual ~FailoverTransportBenchmark();
+
+        void setUp();
+        void tearDown();
+        void run();
+
+    };
+
+}}}
+
+#endif /* _ACTIVEMQ_TRANSPORT_FAILOVER_FAILOVERTRANSPORTBENCHMARK_H_ */
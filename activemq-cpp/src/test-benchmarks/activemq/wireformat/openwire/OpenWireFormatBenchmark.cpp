@@ -0,0 +1,213 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "OpenWireFormatBenchmark.h"
+
+#include <activemq/commands/ActiveMQQueue.h>
+#include <activemq/commands/ConsumerId.h>
+#include <activemq/commands/MessageId.h>
+#include <activemq/commands/ProducerId.h>
+#include <activemq/core/ActiveMQConstants.h>
+#include <activemq/transport/mock/MockTransport.h>
+#include <activemq/wireformat/openwire/utils/BooleanStream.h>
+#include <decaf/lang/System.h>
+#include <decaf/util/Properties.h>
+
+#include <benchmark/AllocationCounter.h>
+
+#include <iostream>
+
+using namespace std;
+using namespace activemq;
+using namespace activemq::commands;
+using namespace activemq::core;
+using namespace activemq::transport;
+using namespace activemq::transport::mock;
+using namespace activemq::wireformat;
+using namespace activemq::wireformat::openwire;
+using namespace activemq::wireformat::openwire::marshal;
+using namespace activemq::wireformat::openwire::utils;
+using namespace decaf::io;
+using namespace decaf::lang;
+using namespace decaf::util;
+
+////////////////////////////////////////////////////////////////////////////////
+OpenWireFormatBenchmark::OpenWireFormatBenchmark() :
+    wireFormat(), receiveFormat(), transport(), textMessage(), messageAck(),
+    textMessageMarshaller(), messageAckMarshaller(), buffer(), dataOut(&buffer),
+    received(), receiveBuffer(), dataIn(&receiveBuffer), plannedTime(0), twoPassTime(0), messageCount(0),
+    sendAllocations(0), receiveAllocations(0), allocationSamples(0) {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+OpenWireFormatBenchmark::~OpenWireFormatBenchmark() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void OpenWireFormatBenchmark::setUp() {
+
+    Properties properties;
+    wireFormat.reset(new OpenWireFormat(properties));
+    wireFormat->setTightEncodingEnabled(true);
+    wireFormat->setCacheEnabled(true);
+    transport.reset(new MockTransport(wireFormat, Pointer<ResponseBuilder>()));
+
+    Pointer<ProducerId> producerId(new ProducerId());
+    producerId->setConnectionId("ID:benchmark-host-12345-1234567890123-1:1");
+    producerId->setSessionId(1);
+    producerId->setValue(1);
+
+    Pointer<MessageId> messageId(new MessageId());
+    messageId->setProducerId(producerId);
+    messageId->setProducerSequenceId(42);
+
+    Pointer<ActiveMQDestination> destination(new ActiveMQQueue("BENCHMARK.QUEUE"));
+
+    textMessage.reset(new ActiveMQTextMessage());
+    textMessage->setProducerId(producerId);
+    textMessage->setMessageId(messageId);
+    textMessage->setDestination(destination);
+    textMessage->setCorrelationId("correlation-id");
+    textMessage->setTimestamp(System::currentTimeMillis());
+    textMessage->setText(std::string(256, 'a'));
+    textMessage->setStringProperty("region", "north");
+    textMessage->setIntProperty("sequence", 42);
+
+    Pointer<ConsumerId> consumerId(new ConsumerId());
+    consumerId->setConnectionId("ID:benchmark-host-12345-1234567890123-1:1");
+    consumerId->setSessionId(1);
+    consumerId->setValue(1);
+
+    messageAck.reset(new MessageAck());
+    messageAck->setAckType(ActiveMQConstants::ACK_TYPE_CONSUMED);
+    messageAck->setConsumerId(consumerId);
+    messageAck->setDestination(destination);
+    messageAck->setFirstMessageId(messageId);
+    messageAck->setLastMessageId(messageId);
+    messageAck->setMessageCount(1);
+
+    // The receiving side has no cache shared with the sender, so the bytes it reads
+    // are produced by a second wire format with the cache turned off.
+    receiveFormat.reset(new OpenWireFormat(properties));
+    receiveFormat->setTightEncodingEnabled(true);
+    receiveFormat->setCacheEnabled(false);
+
+    buffer.reset();
+    receiveFormat->marshal(textMessage, transport.get(), &dataOut);
+    std::pair<unsigned char*, int> bytes = buffer.toByteArray();
+    received.assign(bytes.first, bytes.first + bytes.second);
+    delete [] bytes.first;
+    receiveBuffer.setByteArray(received);
+
+    plannedTime = 0;
+    twoPassTime = 0;
+    messageCount = 0;
+    sendAllocations = 0;
+    receiveAllocations = 0;
+    allocationSamples = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void OpenWireFormatBenchmark::tearDown() {
+
+    if (messageCount > 0) {
+        std::cout << "OpenWireFormat tight marshal per message: planned = "
+                  << (plannedTime / messageCount) << " ns, two pass = "
+                  << (twoPassTime / messageCount) << " ns" << std::endl;
+    }
+
+    if (allocationSamples > 0) {
+        std::cout << "OpenWireFormat allocations per text message: sent = "
+                  << (sendAllocations / allocationSamples) << ", received = "
+                  << (receiveAllocations / allocationSamples) << std::endl;
+    }
+
+    transport.reset(NULL);
+    wireFormat.reset(NULL);
+    receiveFormat.reset(NULL);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void OpenWireFormatBenchmark::marshalTwoPass(DataStreamMarshaller* dsm, DataStructure* object) {
+
+    // The tight branch of marshal as it was before the plan was kept.  Called from
+    // outside of marshal the wire format has no plan active, so the nested objects
+    // go back to the marshal cache and the marshaller table in the second pass.
+    int size = 1;
+    BooleanStream bs;
+    size += dsm->tightMarshal1(wireFormat.get(), object, &bs);
+    size += bs.marshalledSize();
+
+    dataOut.writeInt(size);
+    dataOut.writeByte(object->getDataStructureType());
+    bs.marshal(&dataOut);
+    dsm->tightMarshal2(wireFormat.get(), object, &dataOut, &bs);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void OpenWireFormatBenchmark::sendCopy() {
+
+    // A producer sends a copy of the message it was handed.
+    buffer.reset();
+    Pointer<Command> copy(textMessage->cloneDataStructure());
+    wireFormat->marshal(copy, transport.get(), &dataOut);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void OpenWireFormatBenchmark::receive() {
+
+    receiveBuffer.reset();
+    Pointer<Command> command = receiveFormat->unmarshal(transport.get(), &dataIn);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void OpenWireFormatBenchmark::run() {
+
+    int numRuns = 1000;
+
+    long long start = System::nanoTime();
+    for (int i = 0; i < numRuns; ++i) {
+        buffer.reset();
+        wireFormat->marshal(textMessage, transport.get(), &dataOut);
+        wireFormat->marshal(messageAck, transport.get(), &dataOut);
+    }
+    plannedTime += System::nanoTime() - start;
+
+    start = System::nanoTime();
+    for (int i = 0; i < numRuns; ++i) {
+        buffer.reset();
+        marshalTwoPass(&textMessageMarshaller, textMessage.get());
+        marshalTwoPass(&messageAckMarshaller, messageAck.get());
+    }
+    twoPassTime += System::nanoTime() - start;
+
+    messageCount += numRuns * 2;
+
+    // Warm up the wire format caches before counting what one message costs.
+    sendCopy();
+    receive();
+
+    benchmark::AllocationCounter::start();
+    sendCopy();
+    sendAllocations += benchmark::AllocationCounter::stop();
+
+    benchmark::AllocationCounter::start();
+    receive();
+    receiveAllocations += benchmark::AllocationCounter::stop();
+
+    allocationSamples++;
+}
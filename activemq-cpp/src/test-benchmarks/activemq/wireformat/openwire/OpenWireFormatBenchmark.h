@@ -0,0 +1,102 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_WIREFORMAT_OPENWIRE_OPENWIREFORMATBENCHMARK_H_
+#define _ACTIVEMQ_WIREFORMAT_OPENWIRE_OPENWIREFORMATBENCHMARK_H_
+
+#include <benchmark/BenchmarkBase.h>
+
+#include <activemq/wireformat/openwire/OpenWireFormat.h>
+#include <activemq/wireformat/openwire/marshal/generated/ActiveMQTextMessageMarshaller.h>
+#include <activemq/wireformat/openwire/marshal/generated/MessageAckMarshaller.h>
+#include <activemq/transport/Transport.h>
+#include <activemq/commands/ActiveMQTextMessage.h>
+#include <activemq/commands/MessageAck.h>
+#include <decaf/io/ByteArrayInputStream.h>
+#include <decaf/io/ByteArrayOutputStream.h>
+#include <decaf/io/DataInputStream.h>
+#include <decaf/io/DataOutputStream.h>
+
+#include <vector>
+
+namespace activemq {
+namespace wireformat {
+namespace openwire {
+
+    /**
+     * Measures the per message cost of tight marshaling an ActiveMQTextMessage and a
+     * MessageAck through OpenWireFormat::marshal, which reuses its marshal plan, against
+     * the body marshal had before the plan: a fresh BooleanStream per command and a
+     * second pass that resolves every nested marshaller and cache index again.
+     * It also reports the heap allocations made to send a copy of the text message and
+     * to unmarshal one on the receiving side.
+     */
+    class OpenWireFormatBenchmark :
+        public benchmark::BenchmarkBase<activemq::wireformat::openwire::OpenWireFormatBenchmark, OpenWireFormat> {
+    private:
+
+        Pointer<OpenWireFormat> wireFormat;
+        Pointer<OpenWireFormat> receiveFormat;
+        Pointer<transport::Transport> transport;
+        Pointer<commands::ActiveMQTextMessage> textMessage;
+        Pointer<commands::MessageAck> messageAck;
+
+        marshal::generated::ActiveMQTextMessageMarshaller textMessageMarshaller;
+        marshal::generated::MessageAckMarshaller messageAckMarshaller;
+
+        decaf::io::ByteArrayOutputStream buffer;
+        decaf::io::DataOutputStream dataOut;
+
+        std::vector<unsigned char> received;
+        decaf::io::ByteArrayInputStream receiveBuffer;
+        decaf::io::DataInputStream dataIn;
+
+        long long plannedTime;
+        long long twoPassTime;
+        long long messageCount;
+
+        long long sendAllocations;
+        long long receiveAllocations;
+        long long allocationSamples;
+
+    private:
+
+        OpenWireFormatBenchmark(const OpenWireFormatBenchmark&);
+        OpenWireFormatBenchmark& operator=(const OpenWireFormatBenchmark&);
+
+    public:
+
+        OpenWireFormatBenchmark();
+        virtual ~OpenWireFormatBenchmark();
+
+        void setUp();
+        void tearDown();
+        void run();
+
+    private:
+
+        void marshalTwoPass(marshal::DataStreamMarshaller* dsm, commands::DataStructure* object);
+
+        void sendCopy();
+
+        void receive();
+
+    };
+
+}}}
+
+#endif /* _ACTIVEMQ_WIREFORMAT_OPENWIRE_OPENWIREFORMATBENCHMARK_H_ */
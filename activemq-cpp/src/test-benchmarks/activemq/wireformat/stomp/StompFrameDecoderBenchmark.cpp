@@ -0,0 +1,119 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "StompFrameDecoderBenchmark.h"
+
+#include <activemq/wireformat/stomp/StompFrame.h>
+#include <decaf/io/BufferedInputStream.h>
+#include <decaf/io/ByteArrayInputStream.h>
+#include <decaf/io/DataInputStream.h>
+#include <decaf/lang/Integer.h>
+#include <decaf/lang/System.h>
+
+#include <iostream>
+
+using namespace std;
+using namespace activemq;
+using namespace activemq::wireformat;
+using namespace activemq::wireformat::stomp;
+using namespace decaf::io;
+using namespace decaf::lang;
+
+////////////////////////////////////////////////////////////////////////////////
+StompFrameDecoderBenchmark::StompFrameDecoderBenchmark() :
+    frames(), frameCount(0), decoderTime(0), fromStreamTime(0), framesRead(0) {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+StompFrameDecoderBenchmark::~StompFrameDecoderBenchmark() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void StompFrameDecoderBenchmark::setUp() {
+
+    std::string body(256, 'a');
+    std::string data;
+
+    frameCount = 1000;
+
+    // Alternate between frames sized by content-length and null terminated frames.
+    for (int i = 0; i < frameCount; ++i) {
+        data.append("MESSAGE\n");
+        data.append("destination:/queue/BENCHMARK.QUEUE\n");
+        data.append("message-id:ID:benchmark-host-12345-1234567890123-1:1:1:1:");
+        data.append(Integer::toString(i));
+        data.append("\nsubscription:ID:benchmark-host-12345-1234567890123-1:1:1:1\n");
+        data.append("timestamp:1234567890123\nexpires:0\npriority:4\npersistent:true\n");
+        if (i % 2 == 0) {
+            data.append("content-length:256\n");
+        }
+        data.append("\n");
+        data.append(body);
+        data.append(1, '\0');
+        data.append("\n");
+    }
+
+    frames.assign(data.begin(), data.end());
+
+    decoderTime = 0;
+    fromStreamTime = 0;
+    framesRead = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void StompFrameDecoderBenchmark::tearDown() {
+
+    if (framesRead > 0) {
+        std::cout << "Stomp frame read per frame: decoder = "
+                  << (decoderTime / framesRead) << " ns, fromStream = "
+                  << (fromStreamTime / framesRead) << " ns" << std::endl;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void StompFrameDecoderBenchmark::run() {
+
+    // Both readers sit on the same buffered stream the IOTransport reads from.
+    {
+        ByteArrayInputStream bytes(frames);
+        BufferedInputStream buffered(&bytes);
+        DataInputStream in(&buffered);
+        StompFrameDecoder decoder;
+
+        long long start = System::nanoTime();
+        for (int i = 0; i < frameCount; ++i) {
+            StompFrame frame;
+            decoder.decode(&in, frame);
+        }
+        decoderTime += System::nanoTime() - start;
+    }
+
+    {
+        ByteArrayInputStream bytes(frames);
+        BufferedInputStream buffered(&bytes);
+        DataInputStream in(&buffered);
+
+        long long start = System::nanoTime();
+        for (int i = 0; i < frameCount; ++i) {
+            StompFrame frame;
+            frame.fromStream(&in);
+        }
+        fromStreamTime += System::nanoTime() - start;
+    }
+
+    framesRead += frameCount;
+}
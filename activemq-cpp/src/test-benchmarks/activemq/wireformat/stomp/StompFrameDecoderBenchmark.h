@@ -0,0 +1,60 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_WIREFORMAT_STOMP_STOMPFRAMEDECODERBENCHMARK_H_
+#define _ACTIVEMQ_WIREFORMAT_STOMP_STOMPFRAMEDECODERBENCHMARK_H_
+
+#include <benchmark/BenchmarkBase.h>
+
+#include <activemq/wireformat/stomp/StompFrameDecoder.h>
+
+#include <vector>
+
+namespace activemq {
+namespace wireformat {
+namespace stomp {
+
+    /**
+     * Measures the per frame cost of reading a run of MESSAGE frames with the
+     * StompFrameDecoder against reading the same bytes with StompFrame::fromStream,
+     * which pulls each byte through a virtual readByte call.
+     */
+    class StompFrameDecoderBenchmark :
+        public benchmark::BenchmarkBase<activemq::wireformat::stomp::StompFrameDecoderBenchmark, StompFrameDecoder> {
+    private:
+
+        std::vector<unsigned char> frames;
+        int frameCount;
+
+        long long decoderTime;
+        long long fromStreamTime;
+        long long framesRead;
+
+    public:
+
+        StompFrameDecoderBenchmark();
+        virtual ~StompFrameDecoderBenchmark();
+
+        void setUp();
+        void tearDown();
+        void run();
+
+    };
+
+}}}
+
+#endif /* _ACTIVEMQ_WIREFORMAT_STOMP_STOMPFRAMEDECODERBENCHMARK_H_ */
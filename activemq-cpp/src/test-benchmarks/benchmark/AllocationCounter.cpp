@@ -0,0 +1,85 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "AllocationCounter.h"
+
+#include <cstdlib>
+#include <new>
+
+using namespace benchmark;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    volatile bool counting = false;
+    volatile long long allocations = 0;
+
+    void* allocate(std::size_t size) {
+        AllocationCounter::allocated();
+
+        void* result = std::malloc(size != 0 ? size : 1);
+        if (result == NULL) {
+            throw std::bad_alloc();
+        }
+        return result;
+    }
+}
+
+#if __cplusplus >= 201103L
+#define BENCHMARK_THROWS_BAD_ALLOC
+#else
+#define BENCHMARK_THROWS_BAD_ALLOC throw(std::bad_alloc)
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+void* operator new(std::size_t size) BENCHMARK_THROWS_BAD_ALLOC {
+    return allocate(size);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void* operator new[](std::size_t size) BENCHMARK_THROWS_BAD_ALLOC {
+    return allocate(size);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void operator delete(void* pointer) throw() {
+    std::free(pointer);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void operator delete[](void* pointer) throw() {
+    std::free(pointer);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void AllocationCounter::start() {
+    allocations = 0;
+    counting = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+long long AllocationCounter::stop() {
+    counting = false;
+    return allocations;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void AllocationCounter::allocated() {
+    if (counting) {
+        allocations = allocations + 1;
+    }
+}
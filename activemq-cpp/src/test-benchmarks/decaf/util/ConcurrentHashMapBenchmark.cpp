@@ -0,0 +1,205 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ConcurrentHashMapBenchmark.h"
+
+#include <decaf/lang/Runnable.h>
+#include <decaf/lang/System.h>
+#include <decaf/lang/Thread.h>
+#include <decaf/lang/Pointer.h>
+#include <decaf/util/HashMap.h>
+
+#include <iostream>
+#include <vector>
+
+using namespace decaf;
+using namespace decaf::util;
+using namespace decaf::util::concurrent;
+using namespace decaf::lang;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    const int THREADS = 8;
+    const int KEYS = 1000;
+    const int OPERATIONS_PER_THREAD = 200000;
+
+    /**
+     * Adapts the map under test to the few calls the worker makes, the locked
+     * variant takes the map's monitor around each one.
+     */
+    class MapAccess {
+    public:
+
+        virtual ~MapAccess() {}
+
+        virtual bool containsKey(int key) = 0;
+        virtual void put(int key, int value) = 0;
+        virtual void remove(int key) = 0;
+    };
+
+    class StripedAccess : public MapAccess {
+    public:
+
+        ConcurrentHashMap<int, int> map;
+
+        StripedAccess() : map() {}
+
+        virtual bool containsKey(int key) {
+            return map.containsKey(key);
+        }
+
+        virtual void put(int key, int value) {
+            map.put(key, value);
+        }
+
+        virtual void remove(int key) {
+            map.remove(key, key);
+        }
+    };
+
+    class LockedAccess : public MapAccess {
+    public:
+
+        HashMap<int, int> map;
+
+        LockedAccess() : map() {}
+
+        virtual bool containsKey(int key) {
+            bool result = false;
+            synchronized(&map) {
+                result = map.containsKey(key);
+            }
+            return result;
+        }
+
+        virtual void put(int key, int value) {
+            synchronized(&map) {
+                map.put(key, value);
+            }
+        }
+
+        virtual void remove(int key) {
+            synchronized(&map) {
+                if (map.containsKey(key)) {
+                    map.remove(key);
+                }
+            }
+        }
+    };
+
+    // Nine lookups for every update, roughly the ratio of message dispatches to
+    // consumer creation and close a busy connection sees.
+    class Worker : public Runnable {
+    private:
+
+        MapAccess* access;
+        int seed;
+
+    private:
+
+        Worker(const Worker&);
+        Worker& operator=(const Worker&);
+
+    public:
+
+        Worker(MapAccess* access, int seed) : Runnable(), access(access), seed(seed) {}
+
+        virtual ~Worker() {}
+
+        virtual void run() {
+            unsigned int next = (unsigned int) seed;
+            for (int i = 0; i < OPERATIONS_PER_THREAD; ++i) {
+                next = next * 1103515245 + 12345;
+                int key = (int) ((next >> 8) % KEYS);
+
+                if (i % 10 == 9) {
+                    if ((next & 1) != 0) {
+                        access->put(key, key);
+                    } else {
+                        access->remove(key);
+                    }
+                } else {
+                    access->containsKey(key);
+                }
+            }
+        }
+    };
+
+    long long runWorkers(MapAccess* access) {
+
+        for (int i = 0; i < KEYS; i += 2) {
+            access->put(i, i);
+        }
+
+        std::vector< Pointer<Worker> > workers;
+        std::vector< Pointer<Thread> > threads;
+
+        for (int i = 0; i < THREADS; ++i) {
+            workers.push_back(Pointer<Worker>(new Worker(access, i + 1)));
+            threads.push_back(Pointer<Thread>(new Thread(workers[i].get())));
+        }
+
+        long long start = System::currentTimeMillis();
+
+        for (int i = 0; i < THREADS; ++i) {
+            threads[i]->start();
+        }
+
+        for (int i = 0; i < THREADS; ++i) {
+            threads[i]->join();
+        }
+
+        return System::currentTimeMillis() - start;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+ConcurrentHashMapBenchmark::ConcurrentHashMapBenchmark() : stripedTime(0), lockedTime(0), operations(0) {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+ConcurrentHashMapBenchmark::~ConcurrentHashMapBenchmark() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ConcurrentHashMapBenchmark::setUp() {
+    stripedTime = 0;
+    lockedTime = 0;
+    operations = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ConcurrentHashMapBenchmark::tearDown() {
+
+    std::cout << THREADS << " threads, " << operations << " operations each map: "
+              << "ConcurrentHashMap = " << (operations / (stripedTime > 0 ? stripedTime : 1)) << " ops/ms, "
+              << "synchronized HashMap = " << (operations / (lockedTime > 0 ? lockedTime : 1)) << " ops/ms"
+              << std::endl;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ConcurrentHashMapBenchmark::run() {
+
+    StripedAccess striped;
+    stripedTime += runWorkers(&striped);
+
+    LockedAccess locked;
+    lockedTime += runWorkers(&locked);
+
+    operations += (long long) THREADS * OPERATIONS_PER_THREAD;
+}
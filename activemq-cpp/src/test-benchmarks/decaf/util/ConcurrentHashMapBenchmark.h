@@ -0,0 +1,55 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _DECAF_UTIL_CONCURRENTHASHMAPBENCHMARK_H_
+#define _DECAF_UTIL_CONCURRENTHASHMAPBENCHMARK_H_
+
+#include <benchmark/BenchmarkBase.h>
+#include <decaf/util/concurrent/ConcurrentHashMap.h>
+
+namespace decaf {
+namespace util {
+
+    /**
+     * Has several threads run a read mostly mix of lookups and updates against a
+     * shared map, once on a ConcurrentHashMap and once on a HashMap guarded by its
+     * own monitor the way ActiveMQConnection used to guard its dispatcher map, and
+     * reports the operations per millisecond of each.
+     */
+    class ConcurrentHashMapBenchmark :
+        public benchmark::BenchmarkBase<decaf::util::ConcurrentHashMapBenchmark,
+                                        decaf::util::concurrent::ConcurrentHashMap<int, int>, 3> {
+    private:
+
+        long long stripedTime;
+        long long lockedTime;
+        long long operations;
+
+    public:
+
+        ConcurrentHashMapBenchmark();
+        virtual ~ConcurrentHashMapBenchmark();
+
+        void setUp();
+        void tearDown();
+        void run();
+
+    };
+
+}}
+
+#endif /* _DECAF_UTIL_CONCURRENTHASHMAPBENCHMARK_H_ */
@@ -18,14 +18,128 @@
 #include "QueueBenchmark.h"
 
 #include <decaf/lang/Integer.h>
+#include <decaf/lang/Pointer.h>
+#include <decaf/lang/Runnable.h>
+#include <decaf/lang/System.h>
+#include <decaf/lang/Thread.h>
+
+#include <iostream>
+#include <vector>
 
 using namespace std;
 using namespace decaf;
 using namespace decaf::util;
+using namespace decaf::util::concurrent;
 using namespace decaf::lang;
 
 ////////////////////////////////////////////////////////////////////////////////
-QueueBenchmark::QueueBenchmark() : stringQ(), intQ() {
+namespace {
+
+    const int PRODUCERS = 4;
+    const int CONSUMERS = 4;
+    const int TRANSFERS_PER_PRODUCER = 10000;
+
+    class Producer : public Runnable {
+    private:
+
+        LinkedBlockingQueue<int>* queue;
+
+    private:
+
+        Producer(const Producer&);
+        Producer& operator=(const Producer&);
+
+    public:
+
+        Producer(LinkedBlockingQueue<int>* queue) : Runnable(), queue(queue) {}
+
+        virtual ~Producer() {}
+
+        virtual void run() {
+            for (int i = 0; i < TRANSFERS_PER_PRODUCER; ++i) {
+                queue->put(i);
+            }
+        }
+    };
+
+    class Consumer : public Runnable {
+    private:
+
+        LinkedBlockingQueue<int>* queue;
+        int count;
+
+    private:
+
+        Consumer(const Consumer&);
+        Consumer& operator=(const Consumer&);
+
+    public:
+
+        Consumer(LinkedBlockingQueue<int>* queue, int count) : Runnable(), queue(queue), count(count) {}
+
+        virtual ~Consumer() {}
+
+        virtual void run() {
+            for (int i = 0; i < count; ++i) {
+                queue->take();
+            }
+        }
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+QueueBenchmark::QueueBenchmark() : stringQ(), intQ(), blockingQ(), blockingTime(0), blockingTransfers(0) {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void QueueBenchmark::setUp() {
+    blockingTime = 0;
+    blockingTransfers = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void QueueBenchmark::tearDown() {
+
+    std::cout << PRODUCERS << " producers, " << CONSUMERS << " consumers, "
+              << blockingTransfers << " transfers: LinkedBlockingQueue = "
+              << (blockingTransfers / (blockingTime > 0 ? blockingTime : 1)) << " transfers/ms"
+              << std::endl;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void QueueBenchmark::runBlockingQueue() {
+
+    const int total = PRODUCERS * TRANSFERS_PER_PRODUCER;
+
+    std::vector< Pointer<Runnable> > tasks;
+    std::vector< Pointer<Thread> > threads;
+
+    for (int i = 0; i < PRODUCERS; ++i) {
+        tasks.push_back(Pointer<Runnable>(new Producer(&blockingQ)));
+    }
+
+    // The first consumer takes what does not divide evenly.
+    for (int i = 0; i < CONSUMERS; ++i) {
+        int count = total / CONSUMERS + (i == 0 ? total % CONSUMERS : 0);
+        tasks.push_back(Pointer<Runnable>(new Consumer(&blockingQ, count)));
+    }
+
+    for (std::size_t i = 0; i < tasks.size(); ++i) {
+        threads.push_back(Pointer<Thread>(new Thread(tasks[i].get())));
+    }
+
+    long long start = System::currentTimeMillis();
+
+    for (std::size_t i = 0; i < threads.size(); ++i) {
+        threads[i]->start();
+    }
+
+    for (std::size_t i = 0; i < threads.size(); ++i) {
+        threads[i]->join();
+    }
+
+    blockingTime += System::currentTimeMillis() - start;
+    blockingTransfers += total;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -76,4 +190,5 @@ void QueueBenchmark::run(){
         intQ.pop();
     }
 
+    runBlockingQueue();
 }
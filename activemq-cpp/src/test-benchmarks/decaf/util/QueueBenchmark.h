@@ -20,6 +20,7 @@
 
 #include <benchmark/BenchmarkBase.h>
 #include <decaf/util/StlQueue.h>
+#include <decaf/util/concurrent/LinkedBlockingQueue.h>
 
 namespace decaf{
 namespace util{
@@ -33,12 +34,25 @@ namespace util{
         StlQueue<std::string> stringQ;
         StlQueue<int> intQ;
 
+        // Several producers and consumers passing values through one LinkedBlockingQueue,
+        // the way the executors share their work queue.
+        decaf::util::concurrent::LinkedBlockingQueue<int> blockingQ;
+        long long blockingTime;
+        long long blockingTransfers;
+
     public:
 
         QueueBenchmark();
         virtual ~QueueBenchmark() {}
 
+        void setUp();
+        void tearDown();
+
         virtual void run();
+
+    private:
+
+        void runBlockingQueue();
     };
 
 }}
@@ -17,6 +17,28 @@
 
 #include <activemq/util/PrimitiveMapBenchmark.h>
 CPPUNIT_TEST_SUITE_REGISTRATION( activemq::util::PrimitiveMapBenchmark );
+#include <activemq/wireformat/openwire/OpenWireFormatBenchmark.h>
+CPPUNIT_TEST_SUITE_REGISTRATION( activemq::wireformat::openwire::OpenWireFormatBenchmark );
+#include <activemq/wireformat/stomp/StompFrameDecoderBenchmark.h>
+CPPUNIT_TEST_SUITE_REGISTRATION( activemq::wireformat::stomp::StompFrameDecoderBenchmark );
+#include <activemq/threads/HashedWheelTimerBenchmark.h>
+CPPUNIT_TEST_SUITE_REGISTRATION( activemq::threads::HashedWheelTimerBenchmark );
+#include <activemq/commands/BytesMessageBenchmark.h>
+CPPUNIT_TEST_SUITE_REGISTRATION( activemq::commands::BytesMessageBenchmark );
+#include <activemq/core/ConsumerDispatchBenchmark.h>
+CPPUNIT_TEST_SUITE_REGISTRATION( activemq::core::ConsumerDispatchBenchmark );
+#include <activemq/core/DeliveredMessageListBenchmark.h>
+CPPUNIT_TEST_SUITE_REGISTRATION( activemq::core::DeliveredMessageListBenchmark );
+#include <activemq/core/ListenerDispatchBenchmark.h>
+CPPUNIT_TEST_SUITE_REGISTRATION( activemq::core::ListenerDispatchBenchmark );
+#include <activemq/core/MessageDispatchChannelBenchmark.h>
+CPPUNIT_TEST_SUITE_REGISTRATION( activemq::core::MessageDispatchChannelBenchmark );
+#include <activemq/core/ResourceCreationBenchmark.h>
+CPPUNIT_TEST_SUITE_REGISTRATION( activemq::core::ResourceCreationBenchmark );
+#include <activemq/transport/IOReactorBenchmark.h>
+CPPUNIT_TEST_SUITE_REGISTRATION( activemq::transport::IOReactorBenchmark );
+#include <activemq/transport/failover/FailoverTransportBenchmark.h>
+CPPUNIT_TEST_SUITE_REGISTRATION( activemq::transport::failover::FailoverTransportBenchmark );
 
 #include <decaf/lang/BooleanBenchmark.h>
 CPPUNIT_TEST_SUITE_REGISTRATION( decaf::lang::BooleanBenchmark );
@@ -33,6 +55,8 @@ CPPUNIT_TEST_SUITE_REGISTRATION( decaf::util::SetBenchmark );
 CPPUNIT_TEST_SUITE_REGISTRATION( decaf::util::StlMapBenchmark );
 #include <decaf/util/HashMapBenchmark.h>
 CPPUNIT_TEST_SUITE_REGISTRATION( decaf::util::HashMapBenchmark );
+#include <decaf/util/ConcurrentHashMapBenchmark.h>
+CPPUNIT_TEST_SUITE_REGISTRATION( decaf::util::ConcurrentHashMapBenchmark );
 #include <decaf/util/StlListBenchmark.h>
 CPPUNIT_TEST_SUITE_REGISTRATION( decaf::util::StlListBenchmark );
 #include <decaf/util/LinkedListBenchmark.h>
@@ -459,3 +459,26 @@ void ActiveMQBytesMessageTest::testWriteOnlyBody() {
     } catch( MessageNotReadableException& e ) {
     }
 }
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQBytesMessageTest::testCloneSharesContent() {
+
+    ActiveMQBytesMessage message;
+    std::vector<unsigned char> body(1024, 0x42);
+    message.writeBytes(body);
+    message.reset();
+
+    std::auto_ptr<ActiveMQBytesMessage> copy(message.cloneDataStructure());
+    CPPUNIT_ASSERT(copy->getContentBytes().isSharedWith(message.getContentBytes()));
+
+    std::vector<unsigned char> result(body.size());
+    CPPUNIT_ASSERT_EQUAL(1024, copy->readBytes(result));
+    CPPUNIT_ASSERT(result == body);
+
+    // Writable access to the content of the copy leaves the original untouched.
+    copy->getContent()[0] = 0x01;
+    CPPUNIT_ASSERT(!copy->getContentBytes().isSharedWith(message.getContentBytes()));
+    CPPUNIT_ASSERT_EQUAL((unsigned char) 0x42, message.getContentBytes().get(0));
+    CPPUNIT_ASSERT_EQUAL(1024, message.readBytes(result));
+    CPPUNIT_ASSERT(result == body);
+}
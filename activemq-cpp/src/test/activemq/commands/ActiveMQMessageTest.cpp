@@ -818,3 +818,71 @@ void ActiveMQMessageTest::testIsExpired() {
     msg.setCMSExpiration( System::currentTimeMillis() + 10000 );
     CPPUNIT_ASSERT( !msg.isExpired() );
 }
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQMessageTest::testLazyPropertyUnmarshal() {
+
+    ActiveMQMessage sent;
+    sent.setStringProperty( "string", "value" );
+    sent.setIntProperty( "int", 42 );
+    sent.beforeMarshal( NULL );
+
+    CPPUNIT_ASSERT( !sent.getMarshalledProperties().empty() );
+
+    ActiveMQMessage received;
+    received.setMarshalledProperties( sent.getMarshalledProperties() );
+    received.afterUnmarshal( NULL );
+
+    CPPUNIT_ASSERT( received.propertyExists( "string" ) );
+    CPPUNIT_ASSERT_EQUAL( std::string( "value" ), received.getStringProperty( "string" ) );
+    CPPUNIT_ASSERT_EQUAL( 42, received.getIntProperty( "int" ) );
+    CPPUNIT_ASSERT_EQUAL( (std::size_t) 2, received.getPropertyNames().size() );
+
+    // A copy taken before the properties are decoded must still see them.
+    ActiveMQMessage other;
+    other.setMarshalledProperties( sent.getMarshalledProperties() );
+    other.afterUnmarshal( NULL );
+    Pointer<commands::Message> copy( other.cloneDataStructure() );
+    CPPUNIT_ASSERT_EQUAL( 42, copy.dynamicCast<ActiveMQMessage>()->getIntProperty( "int" ) );
+    CPPUNIT_ASSERT( copy->equals( &received ) );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQMessageTest::testUnchangedPropertiesNotRemarshaled() {
+
+    ActiveMQMessage sent;
+    sent.setStringProperty( "string", "value" );
+    sent.beforeMarshal( NULL );
+
+    // Mark the received bytes so a fresh encoding can be told apart from them.
+    std::vector<unsigned char> original = sent.getMarshalledProperties();
+    std::vector<unsigned char> marked = original;
+    marked.push_back( 0 );
+
+    ActiveMQMessage forwarded;
+    forwarded.setMarshalledProperties( marked );
+    forwarded.afterUnmarshal( NULL );
+    forwarded.beforeMarshal( NULL );
+    CPPUNIT_ASSERT( forwarded.getMarshalledProperties() == marked );
+
+    ActiveMQMessage read;
+    read.setMarshalledProperties( original );
+    read.afterUnmarshal( NULL );
+    CPPUNIT_ASSERT_EQUAL( std::string( "value" ), read.getStringProperty( "string" ) );
+    read.beforeMarshal( NULL );
+    CPPUNIT_ASSERT( read.getMarshalledProperties() == original );
+
+    ActiveMQMessage changed;
+    changed.setMarshalledProperties( original );
+    changed.afterUnmarshal( NULL );
+    changed.setReadOnlyProperties( false );
+    changed.setIntProperty( "int", 7 );
+    changed.beforeMarshal( NULL );
+    CPPUNIT_ASSERT( changed.getMarshalledProperties() != original );
+
+    ActiveMQMessage check;
+    check.setMarshalledProperties( changed.getMarshalledProperties() );
+    check.afterUnmarshal( NULL );
+    CPPUNIT_ASSERT_EQUAL( std::string( "value" ), check.getStringProperty( "string" ) );
+    CPPUNIT_ASSERT_EQUAL( 7, check.getIntProperty( "int" ) );
+}
@@ -18,6 +18,7 @@
 #include "ActiveMQTextMessageTest.h"
 
 #include <activemq/commands/ActiveMQTextMessage.h>
+#include <activemq/util/CompressionContextPool.h>
 
 using namespace cms;
 using namespace std;
@@ -126,3 +127,27 @@ void ActiveMQTextMessageTest::testWriteOnlyBody() {
     } catch( MessageNotWriteableException& mnwe ) {
     }
 }
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQTextMessageTest::testCompressedBody() {
+
+    ActiveMQTextMessage original;
+    original.setText( "This is some compressed Text" );
+    original.onSend();
+
+    const std::vector<unsigned char>& content = original.getContent();
+    std::vector<unsigned char> deflated;
+    CompressionContextPool pool;
+    pool.deflate( &content[0], (int)content.size(), -1, deflated );
+
+    ActiveMQTextMessage compressed;
+    compressed.setContent( deflated );
+    compressed.setCompressed( true );
+    CPPUNIT_ASSERT_EQUAL( std::string( "This is some compressed Text" ), compressed.getText() );
+
+    // A compressed message whose body is empty reads as empty text.
+    ActiveMQTextMessage empty;
+    empty.setCompressed( true );
+    CPPUNIT_ASSERT( empty.getContent().empty() );
+    CPPUNIT_ASSERT_EQUAL( std::string( "" ), empty.getText() );
+}
@@ -0,0 +1,120 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MessageIdTest.h"
+
+#include <activemq/commands/MessageId.h>
+#include <activemq/commands/ProducerId.h>
+#include <decaf/lang/Pointer.h>
+
+using namespace std;
+using namespace activemq;
+using namespace activemq::commands;
+using namespace decaf;
+using namespace decaf::lang;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    Pointer<ProducerId> createProducerId(const std::string& connectionId, long long sessionId, long long value) {
+        Pointer<ProducerId> producerId(new ProducerId());
+        producerId->setConnectionId(connectionId);
+        producerId->setSessionId(sessionId);
+        producerId->setValue(value);
+        return producerId;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MessageIdTest::testToString() {
+
+    MessageId id(createProducerId("ID:host-1234-1", 2, 3), 4);
+    CPPUNIT_ASSERT_EQUAL(std::string("ID:host-1234-1:2:3:4"), id.toString());
+
+    MessageId textId;
+    textId.setTextView("custom");
+    CPPUNIT_ASSERT_EQUAL(std::string("ID:custom"), textId.toString());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MessageIdTest::testToStringFollowsChanges() {
+
+    MessageId id(createProducerId("ID:host-1234-1", 2, 3), 4);
+    CPPUNIT_ASSERT_EQUAL(std::string("ID:host-1234-1:2:3:4"), id.toString());
+
+    id.setProducerSequenceId(5);
+    CPPUNIT_ASSERT_EQUAL(std::string("ID:host-1234-1:2:3:5"), id.toString());
+
+    id.setProducerId(createProducerId("ID:host-1234-1", 2, 6));
+    CPPUNIT_ASSERT_EQUAL(std::string("ID:host-1234-1:2:6:5"), id.toString());
+
+    MessageId copy;
+    copy.copyDataStructure(&id);
+    CPPUNIT_ASSERT_EQUAL(id.toString(), copy.toString());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MessageIdTest::testSetValue() {
+
+    MessageId id("ID:host-1234-1:2:3:4");
+    CPPUNIT_ASSERT_EQUAL((long long)4, id.getProducerSequenceId());
+    CPPUNIT_ASSERT_EQUAL((long long)3, id.getProducerId()->getValue());
+    CPPUNIT_ASSERT_EQUAL((long long)2, id.getProducerId()->getSessionId());
+    CPPUNIT_ASSERT_EQUAL(std::string("ID:host-1234-1"), id.getProducerId()->getConnectionId());
+    CPPUNIT_ASSERT_EQUAL(std::string("ID:host-1234-1:2:3:4"), id.toString());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MessageIdTest::testHashCode() {
+
+    // Separate but equal producer ids, as each unmarshaled message carries.
+    MessageId id1(createProducerId("ID:host-1234-1", 2, 3), 4);
+    MessageId id2(createProducerId("ID:host-1234-1", 2, 3), 4);
+    MessageId id3(createProducerId("ID:host-1234-1", 2, 3), 5);
+
+    CPPUNIT_ASSERT(id1 == id2);
+    CPPUNIT_ASSERT_EQUAL(id1.getHashCode(), id2.getHashCode());
+    CPPUNIT_ASSERT(id1.getHashCode() != id3.getHashCode());
+
+    // The hash does not depend on the string form having been rendered.
+    int hash = id1.getHashCode();
+    id1.toString();
+    CPPUNIT_ASSERT_EQUAL(hash, id1.getHashCode());
+
+    MessageId parsed(id1.toString());
+    CPPUNIT_ASSERT(id1 == parsed);
+    CPPUNIT_ASSERT_EQUAL(id1.getHashCode(), parsed.getHashCode());
+
+    CPPUNIT_ASSERT_EQUAL(id1.getProducerId()->getHashCode(), id2.getProducerId()->getHashCode());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MessageIdTest::testCompareTo() {
+
+    MessageId id1(createProducerId("ID:host-1234-1", 2, 3), 4);
+    MessageId id2(createProducerId("ID:host-1234-1", 2, 3), 4);
+    MessageId id3(createProducerId("ID:host-1234-1", 2, 3), 5);
+    MessageId id4(createProducerId("ID:host-1234-2", 2, 3), 4);
+
+    CPPUNIT_ASSERT_EQUAL(0, id1.compareTo(id2));
+    CPPUNIT_ASSERT(id1.compareTo(id3) < 0);
+    CPPUNIT_ASSERT(id3.compareTo(id1) > 0);
+    CPPUNIT_ASSERT(id1.compareTo(id4) < 0);
+    CPPUNIT_ASSERT(id4.compareTo(id1) > 0);
+    CPPUNIT_ASSERT(id1 < id3);
+    CPPUNIT_ASSERT(!(id1 == id4));
+}
@@ -220,3 +220,47 @@ void ActiveMQMessageAuditTest::testGetLastSeqId() {
     }
 
 }
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQMessageAuditTest::testIsDuplicateDistinctProducerIds() {
+
+    int count = 100;
+    ActiveMQMessageAudit audit;
+
+    // Every unmarshaled message carries its own copy of the ProducerId, the audit
+    // must track them by value.
+    for (int i = 0; i < count; i++) {
+        Pointer<ProducerId> pid(new ProducerId);
+        pid->setConnectionId("test");
+        pid->setSessionId(0);
+        pid->setValue(1);
+
+        Pointer<MessageId> id(new MessageId);
+        id->setProducerId(pid);
+        id->setProducerSequenceId(i);
+        CPPUNIT_ASSERT(!audit.isDuplicate(id));
+    }
+
+    Pointer<ProducerId> pid(new ProducerId);
+    pid->setConnectionId("test");
+    pid->setSessionId(0);
+    pid->setValue(1);
+    CPPUNIT_ASSERT_EQUAL((long long)(count - 1), audit.getLastSeqId(pid));
+
+    for (int i = 0; i < count; i++) {
+        Pointer<MessageId> id(new MessageId);
+        id->setProducerId(pid);
+        id->setProducerSequenceId(i);
+        CPPUNIT_ASSERT(audit.isDuplicate(id));
+    }
+
+    Pointer<ProducerId> other(new ProducerId);
+    other->setConnectionId("test");
+    other->setSessionId(0);
+    other->setValue(2);
+
+    Pointer<MessageId> id(new MessageId);
+    id->setProducerId(other);
+    id->setProducerSequenceId(0);
+    CPPUNIT_ASSERT(!audit.isDuplicate(id));
+}
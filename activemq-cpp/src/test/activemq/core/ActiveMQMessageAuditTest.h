@@ -34,6 +34,7 @@ namespace core {
         CPPUNIT_TEST( testRollbackString );
         CPPUNIT_TEST( testRollbackMessageId );
         CPPUNIT_TEST( testGetLastSeqId );
+        CPPUNIT_TEST( testIsDuplicateDistinctProducerIds );
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -48,6 +49,7 @@ namespace core {
         void testRollbackString();
         void testRollbackMessageId();
         void testGetLastSeqId();
+        void testIsDuplicateDistinctProducerIds();
 
     };
 
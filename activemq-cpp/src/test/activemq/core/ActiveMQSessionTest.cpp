@@ -17,22 +17,36 @@
 
 #include "ActiveMQSessionTest.h"
 
+#include <cms/AsyncCallback.h>
 #include <cms/ExceptionListener.h>
+#include <cms/TextMessage.h>
 #include <activemq/transport/mock/MockTransportFactory.h>
 #include <activemq/transport/TransportRegistry.h>
+#include <activemq/transport/DefaultTransportListener.h>
 #include <activemq/commands/ActiveMQTextMessage.h>
+#include <activemq/commands/BrokerError.h>
 #include <activemq/commands/ConsumerId.h>
+#include <activemq/commands/ExceptionResponse.h>
+#include <activemq/commands/MessageAck.h>
 #include <activemq/commands/MessageDispatch.h>
+#include <activemq/commands/RemoveInfo.h>
 #include <activemq/core/ActiveMQConnectionFactory.h>
 #include <activemq/core/ActiveMQSession.h>
 #include <activemq/core/ActiveMQConsumer.h>
 #include <activemq/core/ActiveMQProducer.h>
+#include <activemq/wireformat/openwire/OpenWireResponseBuilder.h>
 #include <decaf/util/Properties.h>
 #include <decaf/lang/System.h>
 #include <decaf/lang/Pointer.h>
 #include <decaf/lang/Thread.h>
+#include <decaf/lang/exceptions/RuntimeException.h>
 #include <decaf/net/Socket.h>
 #include <decaf/net/ServerSocket.h>
+#include <decaf/util/concurrent/CountDownLatch.h>
+#include <decaf/util/concurrent/atomic/AtomicBoolean.h>
+
+#include <algorithm>
+#include <cctype>
 
 using namespace std;
 using namespace activemq;
@@ -101,6 +115,337 @@ namespace core {
             AMQ_CATCHALL_THROW( activemq::exceptions::ActiveMQException )
         }
     };
+
+    class SentMessageListener : public transport::DefaultTransportListener {
+    public:
+
+        std::vector< Pointer<commands::Message> > messages;
+
+    public:
+
+        SentMessageListener() : messages() {}
+
+        virtual ~SentMessageListener() {}
+
+        virtual void onCommand(const Pointer<commands::Command> command) {
+            if (command->isMessage()) {
+                messages.push_back(command.dynamicCast<commands::Message>());
+            }
+        }
+    };
+
+    class SentAckListener : public transport::DefaultTransportListener {
+    public:
+
+        std::vector< Pointer<commands::MessageAck> > acks;
+        decaf::util::concurrent::Mutex mutex;
+
+    public:
+
+        SentAckListener() : acks(), mutex() {}
+
+        virtual ~SentAckListener() {}
+
+        virtual void onCommand(const Pointer<commands::Command> command) {
+            if (command->isMessageAck()) {
+                synchronized(&mutex) {
+                    acks.push_back(command.dynamicCast<commands::MessageAck>());
+                }
+            }
+        }
+    };
+
+    class ReceivedMessageListener : public cms::MessageListener {
+    public:
+
+        std::vector<const cms::Message*> handedOver;
+        std::vector< Pointer<cms::Message> > received;
+        decaf::util::concurrent::CountDownLatch done;
+
+    public:
+
+        ReceivedMessageListener(int count) : handedOver(), received(), done(count) {}
+
+        virtual ~ReceivedMessageListener() {}
+
+        virtual void onMessage(const cms::Message* message) {
+            handedOver.push_back(message);
+            received.push_back(Pointer<cms::Message>(message->clone()));
+            done.countDown();
+        }
+    };
+
+    /**
+     * Holds the session's dispatch thread in the first message until the gate is
+     * opened so that the messages sent meanwhile queue up behind it.
+     */
+    class GatedMessageListener : public cms::MessageListener {
+    public:
+
+        decaf::util::concurrent::CountDownLatch entered;
+        decaf::util::concurrent::CountDownLatch gate;
+        decaf::util::concurrent::CountDownLatch done;
+
+    public:
+
+        GatedMessageListener(int count) : entered(1), gate(1), done(count) {}
+
+        virtual ~GatedMessageListener() {}
+
+        virtual void onMessage(const cms::Message* message AMQCPP_UNUSED) {
+            if (entered.getCount() > 0) {
+                entered.countDown();
+                gate.await();
+            }
+            done.countDown();
+        }
+    };
+
+    /**
+     * Empties the first message it is given and then fails, the message must still be
+     * redelivered as it was received.
+     */
+    class ClearingThrowingListener : public cms::MessageListener {
+    public:
+
+        int calls;
+        std::string redeliveredText;
+        std::string redeliveredProperty;
+        bool redelivered;
+        decaf::util::concurrent::CountDownLatch done;
+
+    public:
+
+        ClearingThrowingListener() : calls(0), redeliveredText(), redeliveredProperty(), redelivered(false), done(1) {}
+
+        virtual ~ClearingThrowingListener() {}
+
+        virtual void onMessage(const cms::Message* message) {
+            if (calls++ == 0) {
+                cms::Message* writable = const_cast<cms::Message*>(message);
+                writable->clearBody();
+                writable->clearProperties();
+                throw decaf::lang::exceptions::RuntimeException(__FILE__, __LINE__, "Listener failed");
+            }
+
+            redeliveredText = dynamic_cast<const cms::TextMessage*>(message)->getText();
+            redeliveredProperty = message->getStringProperty("key");
+            redelivered = message->getCMSRedelivered();
+            done.countDown();
+        }
+    };
+
+    Pointer<MessageDispatch> createDispatch(const ActiveMQConsumer* consumer, const cms::Destination* destination,
+                                            long long sequenceId, const std::string& text) {
+
+        Pointer<ProducerId> producerId(new ProducerId());
+        producerId->setConnectionId(consumer->getConsumerId()->getConnectionId());
+        producerId->setSessionId(consumer->getConsumerId()->getSessionId());
+        producerId->setValue(1);
+
+        Pointer<MessageId> messageId(new MessageId());
+        messageId->setProducerId(producerId);
+        messageId->setProducerSequenceId(sequenceId);
+
+        Pointer<ActiveMQTextMessage> message(new ActiveMQTextMessage());
+        message->setText(text);
+        message->setCMSDestination(destination);
+        message->setMessageId(messageId);
+
+        Pointer<MessageDispatch> dispatch(new MessageDispatch());
+        dispatch->setMessage(message);
+        dispatch->setConsumerId(Pointer<ConsumerId>(consumer->getConsumerId()->cloneDataStructure()));
+        dispatch->setDestination(message->getDestination());
+
+        return dispatch;
+    }
+
+    std::size_t waitForAcks(SentAckListener& sent, std::size_t count) {
+        for (int i = 0; i < 500; ++i) {
+            synchronized(&sent.mutex) {
+                if (sent.acks.size() >= count) {
+                    return sent.acks.size();
+                }
+            }
+            Thread::sleep(10);
+        }
+        synchronized(&sent.mutex) {
+            return sent.acks.size();
+        }
+        return 0;
+    }
+
+    class CompletionCallback : public cms::AsyncCallback {
+    public:
+
+        int successes;
+        int failures;
+        decaf::util::concurrent::Mutex mutex;
+
+    public:
+
+        CompletionCallback() : successes(0), failures(0), mutex() {}
+
+        virtual ~CompletionCallback() {}
+
+        virtual void onSuccess() {
+            synchronized(&mutex) {
+                successes++;
+                mutex.notifyAll();
+            }
+        }
+
+        virtual void onException(const cms::CMSException& ex AMQCPP_UNUSED) {
+            synchronized(&mutex) {
+                failures++;
+                mutex.notifyAll();
+            }
+        }
+
+        // The outcome is delivered from the connection's executor.
+        void waitForCompletions(int count) {
+            synchronized(&mutex) {
+                long long deadline = System::currentTimeMillis() + 5000;
+                while (successes + failures < count && System::currentTimeMillis() < deadline) {
+                    mutex.wait(100);
+                }
+            }
+        }
+    };
+
+    /**
+     * Records sent messages from any thread, when a gate is given the first message
+     * sent holds its sender until the gate is opened.
+     */
+    class GatedSentMessageListener : public transport::DefaultTransportListener {
+    private:
+
+        decaf::util::concurrent::CountDownLatch* gate;
+
+    public:
+
+        std::vector< Pointer<commands::Message> > messages;
+        decaf::util::concurrent::CountDownLatch entered;
+        decaf::util::concurrent::Mutex mutex;
+
+    private:
+
+        GatedSentMessageListener(const GatedSentMessageListener&);
+        GatedSentMessageListener& operator=(const GatedSentMessageListener&);
+
+    public:
+
+        GatedSentMessageListener(decaf::util::concurrent::CountDownLatch* gate = NULL) :
+            gate(gate), messages(), entered(1), mutex() {}
+
+        virtual ~GatedSentMessageListener() {}
+
+        virtual void onCommand(const Pointer<commands::Command> command) {
+            if (!command->isMessage()) {
+                return;
+            }
+
+            if (gate != NULL && entered.getCount() > 0) {
+                entered.countDown();
+                gate->await();
+            }
+
+            synchronized(&mutex) {
+                messages.push_back(command.dynamicCast<commands::Message>());
+            }
+        }
+
+        std::size_t size() {
+            synchronized(&mutex) {
+                return messages.size();
+            }
+            return 0;
+        }
+    };
+
+    class CloseRunnable : public decaf::lang::Runnable {
+    private:
+
+        cms::Closeable* closeable;
+
+    private:
+
+        CloseRunnable(const CloseRunnable&);
+        CloseRunnable& operator=(const CloseRunnable&);
+
+    public:
+
+        CloseRunnable(cms::Closeable* closeable) : closeable(closeable) {}
+
+        virtual ~CloseRunnable() {}
+
+        virtual void run() {
+            closeable->close();
+        }
+    };
+    class RefusingResponseBuilder : public wireformat::openwire::OpenWireResponseBuilder {
+    public:
+
+        decaf::util::concurrent::atomic::AtomicBoolean refuseConsumers;
+        decaf::util::concurrent::atomic::AtomicBoolean refuseProducers;
+
+    public:
+
+        RefusingResponseBuilder() : refuseConsumers(true), refuseProducers(true) {}
+
+        virtual ~RefusingResponseBuilder() {}
+
+        virtual Pointer<commands::Response> buildResponse(const Pointer<commands::Command> command) {
+
+            if ((command->isConsumerInfo() && refuseConsumers.get()) ||
+                (command->isProducerInfo() && refuseProducers.get())) {
+
+                Pointer<commands::BrokerError> error(new commands::BrokerError());
+                error->setExceptionClass("javax.jms.JMSSecurityException");
+                error->setMessage("User is not authorized to create");
+
+                Pointer<commands::ExceptionResponse> response(new commands::ExceptionResponse());
+                response->setCorrelationId(command->getCommandId());
+                response->setException(error);
+                return response;
+            }
+
+            return OpenWireResponseBuilder::buildResponse(command);
+        }
+    };
+
+    class SentRemoveListener : public transport::DefaultTransportListener {
+    public:
+
+        std::vector< Pointer<commands::DataStructure> > removed;
+        decaf::util::concurrent::Mutex mutex;
+
+    public:
+
+        SentRemoveListener() : removed(), mutex() {}
+
+        virtual ~SentRemoveListener() {}
+
+        virtual void onCommand(const Pointer<commands::Command> command) {
+            if (command->isRemoveInfo()) {
+                synchronized(&mutex) {
+                    removed.push_back(command.dynamicCast<commands::RemoveInfo>()->getObjectId());
+                }
+            }
+        }
+
+        bool wasRemoved(const commands::DataStructure* id) {
+            synchronized(&mutex) {
+                for (std::size_t i = 0; i < removed.size(); ++i) {
+                    if (removed[i]->equals(id)) {
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+    };
+
 }}
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -694,6 +1039,721 @@ void ActiveMQSessionTest::testCreateTempTopicByName() {
     CPPUNIT_ASSERT(topic->getDestinationType() == cms::Destination::TEMPORARY_TOPIC);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQSessionTest::testReceiveBatch() {
+
+    CPPUNIT_ASSERT(connection.get() != NULL);
+
+    // Create an Auto Ack Session
+    std::auto_ptr<cms::Session> session(connection->createSession());
+
+    std::auto_ptr<cms::Topic> topic(session->createTopic("TestTopic1"));
+    std::auto_ptr<ActiveMQConsumer> consumer(
+        dynamic_cast<ActiveMQConsumer*>(session->createConsumer(topic.get())));
+    CPPUNIT_ASSERT(consumer.get() != NULL);
+
+    CPPUNIT_ASSERT(consumer->receiveBatch(10, 5).empty());
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should Throw a CMSException for an empty batch",
+        consumer->receiveBatch(0, 5),
+        cms::CMSException);
+
+    const int MESSAGE_COUNT = 5;
+    for (int i = 0; i < MESSAGE_COUNT; ++i) {
+        std::ostringstream stream;
+        stream << "This is a Test " << i;
+        injectTextMessage(stream.str(), *topic, *(consumer->getConsumerId()));
+    }
+
+    // Wait for the transport to dispatch all of them so the batch size is deterministic.
+    for (int i = 0; i < 100 && consumer->getMessageAvailableCount() < MESSAGE_COUNT; ++i) {
+        Thread::sleep(10);
+    }
+    CPPUNIT_ASSERT_EQUAL(MESSAGE_COUNT, consumer->getMessageAvailableCount());
+
+    std::vector<cms::Message*> first = consumer->receiveBatch(2, 1000);
+    CPPUNIT_ASSERT_EQUAL((std::size_t) 2, first.size());
+
+    std::vector<cms::Message*> rest = consumer->receiveBatch(10, 1000);
+    CPPUNIT_ASSERT_EQUAL((std::size_t) 3, rest.size());
+
+    std::vector<cms::Message*> received(first);
+    received.insert(received.end(), rest.begin(), rest.end());
+
+    for (int i = 0; i < MESSAGE_COUNT; ++i) {
+        std::auto_ptr<cms::Message> message(received[i]);
+        cms::TextMessage* text = dynamic_cast<cms::TextMessage*>(message.get());
+        CPPUNIT_ASSERT(text != NULL);
+
+        std::ostringstream stream;
+        stream << "This is a Test " << i;
+        CPPUNIT_ASSERT_EQUAL(stream.str(), text->getText());
+    }
+
+    CPPUNIT_ASSERT(consumer->receiveBatch(10, 5).empty());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQSessionTest::testSendWithoutCopy() {
+
+    CPPUNIT_ASSERT(connection.get() != NULL);
+    CPPUNIT_ASSERT(connection->isCopyMessageOnSend());
+
+    SentMessageListener sent;
+    dTransport->setOutgoingListener(&sent);
+
+    std::auto_ptr<cms::Session> session(connection->createSession());
+    std::auto_ptr<cms::Topic> topic(session->createTopic("TestTopic1"));
+
+    std::auto_ptr<cms::MessageProducer> copying(session->createProducer(topic.get()));
+    copying->setDeliveryMode(cms::DeliveryMode::NON_PERSISTENT);
+
+    connection->setCopyMessageOnSend(false);
+    std::auto_ptr<cms::MessageProducer> transferring(session->createProducer(topic.get()));
+    transferring->setDeliveryMode(cms::DeliveryMode::NON_PERSISTENT);
+
+    std::auto_ptr<cms::TextMessage> kept(session->createTextMessage("copied"));
+    copying->send(kept.get());
+
+    CPPUNIT_ASSERT_EQUAL((std::size_t) 1, sent.messages.size());
+    CPPUNIT_ASSERT(sent.messages[0].get() != dynamic_cast<commands::Message*>(kept.get()));
+
+    // The kept message has the same id as the copy that was sent but not the same
+    // instance, the sent copy's id is read by other threads.
+    commands::Message* original = dynamic_cast<commands::Message*>(kept.get());
+    CPPUNIT_ASSERT(original->getMessageId() != NULL);
+    CPPUNIT_ASSERT(original->getMessageId().get() != sent.messages[0]->getMessageId().get());
+    CPPUNIT_ASSERT(original->getMessageId()->equals(sent.messages[0]->getMessageId().get()));
+    CPPUNIT_ASSERT_EQUAL(sent.messages[0]->getMessageId()->toString(), kept->getCMSMessageID());
+
+    // The producer owns the message once it is sent and shares it with the transport.
+    cms::TextMessage* handedOff = session->createTextMessage("not copied");
+    transferring->send(handedOff);
+
+    CPPUNIT_ASSERT_EQUAL((std::size_t) 2, sent.messages.size());
+    CPPUNIT_ASSERT(sent.messages[1].get() == dynamic_cast<commands::Message*>(handedOff));
+    CPPUNIT_ASSERT(sent.messages[1]->getMessageId() != NULL);
+    CPPUNIT_ASSERT_EQUAL(std::string("not copied"), handedOff->getText());
+
+    dTransport->setOutgoingListener(NULL);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQSessionTest::testOptimizedDispatch() {
+
+    static const int MSG_COUNT = 10;
+
+    CPPUNIT_ASSERT(connection.get() != NULL);
+    CPPUNIT_ASSERT(!connection->isOptimizeDispatch());
+
+    connection->setOptimizeDispatch(true);
+
+    SentAckListener sent;
+    dTransport->setOutgoingListener(&sent);
+
+    std::auto_ptr<cms::Session> session(connection->createSession(cms::Session::DUPS_OK_ACKNOWLEDGE));
+    std::auto_ptr<cms::Topic> topic(session->createTopic("TestTopic1"));
+    std::auto_ptr<ActiveMQConsumer> consumer(
+        dynamic_cast<ActiveMQConsumer*>(session->createConsumer(topic.get())));
+
+    ReceivedMessageListener listener(MSG_COUNT);
+    consumer->setMessageListener(&listener);
+
+    Pointer<ProducerId> producerId(new ProducerId());
+    producerId->setConnectionId(consumer->getConsumerId()->getConnectionId());
+    producerId->setSessionId(consumer->getConsumerId()->getSessionId());
+    producerId->setValue(1);
+
+    std::vector< Pointer<MessageDispatch> > dispatches;
+    for (int i = 0; i < MSG_COUNT; ++i) {
+        Pointer<MessageId> messageId(new MessageId());
+        messageId->setProducerId(producerId);
+        messageId->setProducerSequenceId(i + 1);
+
+        Pointer<ActiveMQTextMessage> message(new ActiveMQTextMessage());
+        message->setText("optimized");
+        message->setCMSDestination(topic.get());
+        message->setMessageId(messageId);
+
+        Pointer<MessageDispatch> dispatch(new MessageDispatch());
+        dispatch->setMessage(message);
+        dispatch->setConsumerId(Pointer<ConsumerId>(consumer->getConsumerId()->cloneDataStructure()));
+        dispatch->setDestination(message->getDestination());
+        dispatches.push_back(dispatch);
+
+        dTransport->fireCommand(dispatch);
+    }
+
+    CPPUNIT_ASSERT(listener.done.await(5000));
+
+    // The listener is handed copies, the received messages stay as they arrived.
+    for (int i = 0; i < MSG_COUNT; ++i) {
+        CPPUNIT_ASSERT(listener.handedOver[i] != dynamic_cast<cms::Message*>(dispatches[i]->getMessage().get()));
+        const commands::Message* received = dynamic_cast<const commands::Message*>(listener.received[i].get());
+        CPPUNIT_ASSERT(received->getMessageId()->equals(dispatches[i]->getMessage()->getMessageId().get()));
+    }
+
+    // A dups ok topic consumer holds its ack until half the prefetch window is consumed.
+    synchronized(&sent.mutex) {
+        CPPUNIT_ASSERT(sent.acks.empty());
+    }
+
+    consumer->close();
+
+    CPPUNIT_ASSERT_EQUAL((std::size_t) 1, sent.acks.size());
+    CPPUNIT_ASSERT_EQUAL(MSG_COUNT, sent.acks[0]->getMessageCount());
+    CPPUNIT_ASSERT(sent.acks[0]->getFirstMessageId()->equals(dispatches[0]->getMessage()->getMessageId().get()));
+    CPPUNIT_ASSERT(sent.acks[0]->getLastMessageId()->equals(dispatches[MSG_COUNT - 1]->getMessage()->getMessageId().get()));
+
+    dTransport->setOutgoingListener(NULL);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQSessionTest::testOptimizedDispatchCoalescesAcks() {
+
+    static const int MSG_COUNT = 10;
+
+    connection->setOptimizeDispatch(true);
+
+    SentAckListener sent;
+    dTransport->setOutgoingListener(&sent);
+
+    std::auto_ptr<cms::Session> session(connection->createSession(cms::Session::AUTO_ACKNOWLEDGE));
+    std::auto_ptr<cms::Topic> topic(session->createTopic("TestTopic1"));
+    std::auto_ptr<ActiveMQConsumer> consumer(
+        dynamic_cast<ActiveMQConsumer*>(session->createConsumer(topic.get())));
+
+    GatedMessageListener listener(MSG_COUNT);
+    consumer->setMessageListener(&listener);
+
+    std::vector< Pointer<MessageDispatch> > dispatches;
+    for (int i = 0; i < MSG_COUNT; ++i) {
+        dispatches.push_back(createDispatch(consumer.get(), topic.get(), i + 1, "coalesced"));
+    }
+
+    // The rest queue up in the session while the listener holds the first one.
+    dTransport->fireCommand(dispatches[0]);
+    CPPUNIT_ASSERT(listener.entered.await(5000));
+    for (int i = 1; i < MSG_COUNT; ++i) {
+        dTransport->fireCommand(dispatches[i]);
+    }
+
+    listener.gate.countDown();
+    CPPUNIT_ASSERT(listener.done.await(5000));
+
+    // No ack goes out while the session has more queued, the last message finds it
+    // idle and acks the whole range at once.
+    CPPUNIT_ASSERT_EQUAL((std::size_t) 1, waitForAcks(sent, 1));
+    synchronized(&sent.mutex) {
+        CPPUNIT_ASSERT(sent.acks[0]->isStandardAck());
+        CPPUNIT_ASSERT_EQUAL(MSG_COUNT, sent.acks[0]->getMessageCount());
+        CPPUNIT_ASSERT(sent.acks[0]->getFirstMessageId()->equals(dispatches[0]->getMessage()->getMessageId().get()));
+        CPPUNIT_ASSERT(sent.acks[0]->getLastMessageId()->equals(dispatches[MSG_COUNT - 1]->getMessage()->getMessageId().get()));
+    }
+
+    // A lone message is acked straight away once the session is idle.
+    Pointer<MessageDispatch> single = createDispatch(consumer.get(), topic.get(), MSG_COUNT + 1, "single");
+    dTransport->fireCommand(single);
+
+    CPPUNIT_ASSERT_EQUAL((std::size_t) 2, waitForAcks(sent, 2));
+    synchronized(&sent.mutex) {
+        CPPUNIT_ASSERT_EQUAL(1, sent.acks[1]->getMessageCount());
+        CPPUNIT_ASSERT(sent.acks[1]->getFirstMessageId()->equals(single->getMessage()->getMessageId().get()));
+        CPPUNIT_ASSERT(sent.acks[1]->getLastMessageId()->equals(single->getMessage()->getMessageId().get()));
+    }
+
+    consumer->close();
+
+    // Nothing was left pending for close to flush.
+    synchronized(&sent.mutex) {
+        CPPUNIT_ASSERT_EQUAL((std::size_t) 2, sent.acks.size());
+    }
+
+    dTransport->setOutgoingListener(NULL);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQSessionTest::testOptimizedDispatchRedeliversAfterListenerThrows() {
+
+    connection->setOptimizeDispatch(true);
+    connection->getRedeliveryPolicy()->setInitialRedeliveryDelay(0);
+    connection->getRedeliveryPolicy()->setRedeliveryDelay(0);
+
+    std::auto_ptr<cms::Session> session(connection->createSession(cms::Session::AUTO_ACKNOWLEDGE));
+    std::auto_ptr<cms::Topic> topic(session->createTopic("TestTopic1"));
+    std::auto_ptr<ActiveMQConsumer> consumer(
+        dynamic_cast<ActiveMQConsumer*>(session->createConsumer(topic.get())));
+
+    ClearingThrowingListener listener;
+    consumer->setMessageListener(&listener);
+
+    Pointer<MessageDispatch> dispatch = createDispatch(consumer.get(), topic.get(), 1, "redelivered");
+    dispatch->getMessage()->getMessageProperties().setString("key", "value");
+    dTransport->fireCommand(dispatch);
+
+    CPPUNIT_ASSERT(listener.done.await(5000));
+
+    // What the listener did to its copy before it failed does not reach the redelivery.
+    CPPUNIT_ASSERT_EQUAL(2, listener.calls);
+    CPPUNIT_ASSERT(listener.redelivered);
+    CPPUNIT_ASSERT_EQUAL(std::string("redelivered"), listener.redeliveredText);
+    CPPUNIT_ASSERT_EQUAL(std::string("value"), listener.redeliveredProperty);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQSessionTest::testAsyncCommit() {
+
+    MyCMSMessageListener msgListener;
+    CompletionCallback callback;
+
+    CPPUNIT_ASSERT(connection.get() != NULL);
+
+    std::auto_ptr<cms::Session> session(connection->createSession(cms::Session::SESSION_TRANSACTED));
+    ActiveMQSession* amqSession = dynamic_cast<ActiveMQSession*>(session.get());
+    CPPUNIT_ASSERT(amqSession != NULL);
+
+    std::auto_ptr<cms::Topic> topic(session->createTopic("TestTopic1"));
+    std::auto_ptr<ActiveMQConsumer> consumer(
+        dynamic_cast<ActiveMQConsumer*>(session->createConsumer(topic.get())));
+    CPPUNIT_ASSERT(consumer.get() != NULL);
+
+    consumer->setMessageListener(&msgListener);
+
+    const unsigned int msgCount = 10;
+
+    for (unsigned int i = 0; i < msgCount; ++i) {
+        injectTextMessage("First transaction", *topic, *(consumer->getConsumerId()));
+    }
+
+    msgListener.asyncWaitForMessages(msgCount);
+    CPPUNIT_ASSERT_EQUAL((std::size_t) msgCount, msgListener.messages.size());
+
+    amqSession->commit(&callback);
+    callback.waitForCompletions(1);
+    CPPUNIT_ASSERT_EQUAL(1, callback.successes);
+    CPPUNIT_ASSERT_EQUAL(0, callback.failures);
+
+    msgListener.clear();
+
+    for (unsigned int i = 0; i < msgCount; ++i) {
+        injectTextMessage("Second transaction", *topic, *(consumer->getConsumerId()));
+    }
+
+    msgListener.asyncWaitForMessages(msgCount);
+    CPPUNIT_ASSERT_EQUAL((std::size_t) msgCount, msgListener.messages.size());
+
+    msgListener.clear();
+
+    // Only the messages from the second transaction should come back.
+    amqSession->rollback(&callback);
+    callback.waitForCompletions(2);
+    CPPUNIT_ASSERT_EQUAL(2, callback.successes);
+    CPPUNIT_ASSERT_EQUAL(0, callback.failures);
+
+    msgListener.asyncWaitForMessages(msgCount);
+    CPPUNIT_ASSERT_EQUAL((std::size_t) msgCount, msgListener.messages.size());
+
+    msgListener.clear();
+
+    amqSession->commit(&callback);
+    callback.waitForCompletions(3);
+    CPPUNIT_ASSERT_EQUAL(3, callback.successes);
+    CPPUNIT_ASSERT_EQUAL(0, callback.failures);
+
+    Thread::sleep(100);
+    CPPUNIT_ASSERT(msgListener.messages.empty());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQSessionTest::testLateAsyncCompletion() {
+
+    MyCMSMessageListener msgListener;
+    CompletionCallback callback;
+
+    std::auto_ptr<cms::Session> session(connection->createSession(cms::Session::SESSION_TRANSACTED));
+    ActiveMQSession* amqSession = dynamic_cast<ActiveMQSession*>(session.get());
+    CPPUNIT_ASSERT(amqSession != NULL);
+
+    std::auto_ptr<cms::Topic> topic(session->createTopic("TestTopic1"));
+    std::auto_ptr<ActiveMQConsumer> consumer(
+        dynamic_cast<ActiveMQConsumer*>(session->createConsumer(topic.get())));
+    CPPUNIT_ASSERT(consumer.get() != NULL);
+
+    consumer->setMessageListener(&msgListener);
+
+    const unsigned int msgCount = 5;
+
+    for (unsigned int i = 0; i < msgCount; ++i) {
+        injectTextMessage("First", *topic, *(consumer->getConsumerId()));
+    }
+    msgListener.asyncWaitForMessages(msgCount);
+    CPPUNIT_ASSERT_EQUAL((std::size_t) msgCount, msgListener.messages.size());
+    msgListener.clear();
+
+    // The commit response is held while the next transaction delivers.
+    dTransport->setHoldAsyncResponses(true);
+    amqSession->commit(&callback);
+    CPPUNIT_ASSERT_EQUAL(0, callback.successes);
+
+    for (unsigned int i = 0; i < msgCount; ++i) {
+        injectTextMessage("Second", *topic, *(consumer->getConsumerId()));
+    }
+    msgListener.asyncWaitForMessages(msgCount);
+    CPPUNIT_ASSERT_EQUAL((std::size_t) msgCount, msgListener.messages.size());
+    msgListener.clear();
+
+    CPPUNIT_ASSERT_EQUAL(1, dTransport->releaseAsyncResponses());
+    callback.waitForCompletions(1);
+    CPPUNIT_ASSERT_EQUAL(1, callback.successes);
+
+    // Now a late rollback of the second transaction while a third one delivers.
+    amqSession->rollback(&callback);
+
+    for (unsigned int i = 0; i < msgCount; ++i) {
+        injectTextMessage("Third", *topic, *(consumer->getConsumerId()));
+    }
+    msgListener.asyncWaitForMessages(msgCount);
+    CPPUNIT_ASSERT_EQUAL((std::size_t) msgCount, msgListener.messages.size());
+    msgListener.clear();
+
+    CPPUNIT_ASSERT_EQUAL(1, dTransport->releaseAsyncResponses());
+    dTransport->setHoldAsyncResponses(false);
+    callback.waitForCompletions(2);
+    CPPUNIT_ASSERT_EQUAL(2, callback.successes);
+    CPPUNIT_ASSERT_EQUAL(0, callback.failures);
+
+    // Only the second transaction comes back, not the committed first one nor the
+    // third one that is still open.
+    msgListener.asyncWaitForMessages(msgCount);
+    Thread::sleep(100);
+    CPPUNIT_ASSERT_EQUAL((std::size_t) msgCount, msgListener.messages.size());
+    for (std::size_t i = 0; i < msgListener.messages.size(); ++i) {
+        cms::TextMessage* text = dynamic_cast<cms::TextMessage*>(msgListener.messages[i].get());
+        CPPUNIT_ASSERT(text != NULL);
+        CPPUNIT_ASSERT_EQUAL(std::string("Second"), text->getText());
+    }
+
+    msgListener.clear();
+    amqSession->commit();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQSessionTest::testPipelinedCreation() {
+
+    CPPUNIT_ASSERT(connection.get() != NULL);
+
+    connection->setPipelineCreation(true);
+    CPPUNIT_ASSERT(connection->isPipelineCreation());
+
+    std::auto_ptr<cms::Session> session(connection->createSession());
+    std::auto_ptr<cms::Topic> topic(session->createTopic("TestTopic1"));
+
+    const int consumerCount = 20;
+    std::vector< Pointer<ActiveMQConsumer> > consumers;
+
+    for (int i = 0; i < consumerCount; ++i) {
+        consumers.push_back(Pointer<ActiveMQConsumer>(
+            dynamic_cast<ActiveMQConsumer*>(session->createConsumer(topic.get()))));
+    }
+
+    std::auto_ptr<cms::MessageProducer> producer(session->createProducer(topic.get()));
+
+    // First use of each consumer waits for the broker to confirm its creation.
+    for (int i = 0; i < consumerCount; ++i) {
+        CPPUNIT_ASSERT(consumers[i]->receiveNoWait() == NULL);
+    }
+
+    injectTextMessage("Pipelined", *topic, *(consumers[0]->getConsumerId()));
+
+    std::auto_ptr<cms::Message> message(consumers[0]->receive(2000));
+    CPPUNIT_ASSERT(message.get() != NULL);
+
+    std::auto_ptr<cms::TextMessage> text(session->createTextMessage("Pipelined"));
+    CPPUNIT_ASSERT_NO_THROW(producer->send(text.get()));
+
+    for (int i = 0; i < consumerCount; ++i) {
+        consumers[i]->close();
+    }
+    producer->close();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQSessionTest::testPipelinedCreationRefused() {
+
+    connection->setPipelineCreation(true);
+
+    Pointer<RefusingResponseBuilder> builder(new RefusingResponseBuilder());
+    dTransport->setResponseBuilder(builder);
+
+    SentRemoveListener sent;
+    dTransport->setOutgoingListener(&sent);
+
+    std::auto_ptr<cms::Session> session(connection->createSession());
+    std::auto_ptr<cms::Topic> topic(session->createTopic("TestTopic1"));
+
+    // Creation does not wait for the broker, the refusal shows up on first use.
+    std::auto_ptr<ActiveMQConsumer> received(
+        dynamic_cast<ActiveMQConsumer*>(session->createConsumer(topic.get())));
+    std::auto_ptr<ActiveMQConsumer> listened(
+        dynamic_cast<ActiveMQConsumer*>(session->createConsumer(topic.get())));
+    std::auto_ptr<ActiveMQConsumer> closed(
+        dynamic_cast<ActiveMQConsumer*>(session->createConsumer(topic.get())));
+    std::auto_ptr<cms::MessageProducer> producer(session->createProducer(topic.get()));
+
+    try {
+        received->receive(100);
+        CPPUNIT_FAIL("receive should report the refused creation");
+    } catch (cms::CMSException& ex) {
+        CPPUNIT_ASSERT(std::string(ex.getMessage()).find("not authorized") != std::string::npos);
+    }
+
+    // Later calls keep reporting the same error.
+    CPPUNIT_ASSERT_THROW(received->receiveNoWait(), cms::CMSException);
+
+    MyCMSMessageListener listener;
+    CPPUNIT_ASSERT_THROW(listened->setMessageListener(&listener), cms::CMSException);
+    CPPUNIT_ASSERT_THROW(listened->receive(100), cms::CMSException);
+
+    std::auto_ptr<cms::TextMessage> message(session->createTextMessage("Refused"));
+    CPPUNIT_ASSERT_THROW(producer->send(message.get()), cms::CMSException);
+
+    // Closing a refused resource disposes of it without telling the broker.
+    Pointer<ConsumerId> closedId(closed->getConsumerId()->cloneDataStructure());
+    CPPUNIT_ASSERT_NO_THROW(closed->close());
+    CPPUNIT_ASSERT_NO_THROW(received->close());
+    CPPUNIT_ASSERT_NO_THROW(listened->close());
+    CPPUNIT_ASSERT_NO_THROW(producer->close());
+    CPPUNIT_ASSERT(!sent.wasRemoved(closedId.get()));
+
+    // The session itself is unaffected, resources the broker accepts still work.
+    builder->refuseConsumers.set(false);
+    builder->refuseProducers.set(false);
+
+    std::auto_ptr<ActiveMQConsumer> accepted(
+        dynamic_cast<ActiveMQConsumer*>(session->createConsumer(topic.get())));
+    CPPUNIT_ASSERT(accepted->receiveNoWait() == NULL);
+
+    injectTextMessage("Accepted", *topic, *(accepted->getConsumerId()));
+    std::auto_ptr<cms::Message> delivered(accepted->receive(2000));
+    CPPUNIT_ASSERT(delivered.get() != NULL);
+
+    Pointer<ConsumerId> acceptedId(accepted->getConsumerId()->cloneDataStructure());
+    accepted->close();
+    CPPUNIT_ASSERT(sent.wasRemoved(acceptedId.get()));
+
+    dTransport->setOutgoingListener(NULL);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQSessionTest::testCompressionThreshold() {
+
+    connection->setUseCompression(true);
+    connection->setCompressionThreshold(1024);
+
+    SentMessageListener sent;
+    dTransport->setOutgoingListener(&sent);
+
+    std::auto_ptr<cms::Session> session(connection->createSession());
+    std::auto_ptr<cms::Topic> topic(session->createTopic("TestTopic1"));
+    std::auto_ptr<cms::MessageProducer> producer(session->createProducer(topic.get()));
+    producer->setDeliveryMode(cms::DeliveryMode::NON_PERSISTENT);
+
+    const std::string small("below the threshold");
+    const std::string large(4096, 'x');
+
+    std::auto_ptr<cms::TextMessage> message(session->createTextMessage(small));
+    producer->send(message.get());
+    message.reset(session->createTextMessage(large));
+    producer->send(message.get());
+
+    CPPUNIT_ASSERT_EQUAL((std::size_t) 2, sent.messages.size());
+
+    // A body under the threshold goes out as it is.
+    CPPUNIT_ASSERT(!sent.messages[0]->isCompressed());
+    CPPUNIT_ASSERT_EQUAL(small, sent.messages[0].dynamicCast<ActiveMQTextMessage>()->getText());
+
+    CPPUNIT_ASSERT(sent.messages[1]->isCompressed());
+    CPPUNIT_ASSERT(sent.messages[1]->getContent().size() < large.size());
+    CPPUNIT_ASSERT_EQUAL(large, sent.messages[1].dynamicCast<ActiveMQTextMessage>()->getText());
+
+    dTransport->setOutgoingListener(NULL);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQSessionTest::testBackgroundCompressionOrdering() {
+
+    static const int MSG_COUNT = 20;
+
+    connection->setUseCompression(true);
+    connection->setCompressionThreshold(1024);
+    connection->setBackgroundCompression(true);
+
+    GatedSentMessageListener sent;
+    dTransport->setOutgoingListener(&sent);
+
+    std::auto_ptr<cms::Session> session(connection->createSession());
+    std::auto_ptr<cms::Topic> topic(session->createTopic("TestTopic1"));
+    std::auto_ptr<cms::MessageProducer> producer(session->createProducer(topic.get()));
+    producer->setDeliveryMode(cms::DeliveryMode::NON_PERSISTENT);
+
+    // Large bodies are compressed in the background, small ones and persistent ones go
+    // out inline unless an earlier send is still waiting to be compressed.
+    for (int i = 0; i < MSG_COUNT; ++i) {
+        std::string body = (i % 3 == 0) ? std::string("small") : std::string(4096, (char) ('a' + i));
+        std::auto_ptr<cms::TextMessage> message(session->createTextMessage(body));
+        producer->send(message.get(), (i % 5 == 4) ? cms::DeliveryMode::PERSISTENT : cms::DeliveryMode::NON_PERSISTENT,
+                       cms::Message::DEFAULT_MSG_PRIORITY, cms::Message::DEFAULT_TIME_TO_LIVE);
+    }
+
+    // A persistent send is synchronous and so drains the background sends first.
+    std::auto_ptr<cms::TextMessage> last(session->createTextMessage("last"));
+    producer->send(last.get(), cms::DeliveryMode::PERSISTENT,
+                   cms::Message::DEFAULT_MSG_PRIORITY, cms::Message::DEFAULT_TIME_TO_LIVE);
+
+    CPPUNIT_ASSERT_EQUAL((std::size_t) (MSG_COUNT + 1), sent.size());
+
+    for (int i = 0; i < MSG_COUNT + 1; ++i) {
+        CPPUNIT_ASSERT_EQUAL((long long) (i + 1), sent.messages[i]->getMessageId()->getProducerSequenceId());
+    }
+
+    CPPUNIT_ASSERT(sent.messages[1]->isCompressed());
+    CPPUNIT_ASSERT_EQUAL(std::string(4096, 'b'), sent.messages[1].dynamicCast<ActiveMQTextMessage>()->getText());
+
+    dTransport->setOutgoingListener(NULL);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQSessionTest::testBackgroundCompressionDrainedOnProducerClose() {
+
+    static const int MSG_COUNT = 5;
+
+    connection->setUseCompression(true);
+    connection->setBackgroundCompression(true);
+
+    decaf::util::concurrent::CountDownLatch gate(1);
+    GatedSentMessageListener sent(&gate);
+    dTransport->setOutgoingListener(&sent);
+
+    std::auto_ptr<cms::Session> session(connection->createSession());
+    std::auto_ptr<cms::Topic> topic(session->createTopic("TestTopic1"));
+    std::auto_ptr<cms::MessageProducer> producer(session->createProducer(topic.get()));
+    producer->setDeliveryMode(cms::DeliveryMode::NON_PERSISTENT);
+
+    for (int i = 0; i < MSG_COUNT; ++i) {
+        std::auto_ptr<cms::TextMessage> message(session->createTextMessage(std::string(4096, 'x')));
+        producer->send(message.get());
+    }
+
+    // The pool is stuck sending the first one so none of them is out yet.
+    CPPUNIT_ASSERT(sent.entered.await(5000));
+    CPPUNIT_ASSERT_EQUAL((std::size_t) 0, sent.size());
+
+    CloseRunnable closer(producer.get());
+    decaf::lang::Thread closeThread(&closer);
+    closeThread.start();
+
+    gate.countDown();
+    closeThread.join();
+
+    // Closing the producer does not return before its queued messages are sent.
+    CPPUNIT_ASSERT_EQUAL((std::size_t) MSG_COUNT, sent.size());
+    for (int i = 0; i < MSG_COUNT; ++i) {
+        CPPUNIT_ASSERT_EQUAL((long long) (i + 1), sent.messages[i]->getMessageId()->getProducerSequenceId());
+    }
+
+    dTransport->setOutgoingListener(NULL);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQSessionTest::testBackgroundCompressionDrainedOnSessionClose() {
+
+    static const int MSG_COUNT = 5;
+
+    connection->setUseCompression(true);
+    connection->setBackgroundCompression(true);
+
+    decaf::util::concurrent::CountDownLatch gate(1);
+    GatedSentMessageListener sent(&gate);
+    dTransport->setOutgoingListener(&sent);
+
+    std::auto_ptr<cms::Session> session(connection->createSession());
+    std::auto_ptr<cms::Topic> topic(session->createTopic("TestTopic1"));
+    std::auto_ptr<cms::MessageProducer> producer(session->createProducer(topic.get()));
+    producer->setDeliveryMode(cms::DeliveryMode::NON_PERSISTENT);
+
+    for (int i = 0; i < MSG_COUNT; ++i) {
+        std::auto_ptr<cms::TextMessage> message(session->createTextMessage(std::string(4096, 'x')));
+        producer->send(message.get());
+    }
+
+    CPPUNIT_ASSERT(sent.entered.await(5000));
+    CPPUNIT_ASSERT_EQUAL((std::size_t) 0, sent.size());
+
+    CloseRunnable closer(session.get());
+    decaf::lang::Thread closeThread(&closer);
+    closeThread.start();
+
+    gate.countDown();
+    closeThread.join();
+
+    CPPUNIT_ASSERT_EQUAL((std::size_t) MSG_COUNT, sent.size());
+    for (int i = 0; i < MSG_COUNT; ++i) {
+        CPPUNIT_ASSERT_EQUAL((long long) (i + 1), sent.messages[i]->getMessageId()->getProducerSequenceId());
+    }
+
+    dTransport->setOutgoingListener(NULL);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ActiveMQSessionTest::testConsumerLookupById() {
+
+    std::auto_ptr<cms::Session> session(connection->createSession());
+    std::auto_ptr<cms::Topic> topic(session->createTopic("TestTopic1"));
+
+    CPPUNIT_ASSERT_EQUAL(1, connection->getSessions().size());
+    Pointer<kernels::ActiveMQSessionKernel> kernel = connection->getSessions().get(0);
+
+    MyCMSMessageListener listeners[3];
+    std::auto_ptr<ActiveMQConsumer> consumers[3];
+    for (int i = 0; i < 3; ++i) {
+        consumers[i].reset(dynamic_cast<ActiveMQConsumer*>(session->createConsumer(topic.get())));
+        consumers[i]->setMessageListener(&listeners[i]);
+    }
+
+    // Lookups are by value, the id's connection part compares without case.
+    for (int i = 0; i < 3; ++i) {
+        Pointer<ConsumerId> id(consumers[i]->getConsumerId()->cloneDataStructure());
+        CPPUNIT_ASSERT(kernel->lookupConsumerKernel(id) != NULL);
+        CPPUNIT_ASSERT(kernel->lookupConsumerKernel(id)->getConsumerId()->equals(*id));
+
+        std::string upper = id->getConnectionId();
+        std::transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+        id->setConnectionId(upper);
+        CPPUNIT_ASSERT(kernel->lookupConsumerKernel(id) != NULL);
+    }
+
+    injectTextMessage("Before", *topic, *(consumers[1]->getConsumerId()));
+    listeners[1].asyncWaitForMessages(1);
+    CPPUNIT_ASSERT_EQUAL(1, (int) listeners[1].messages.size());
+
+    Pointer<ConsumerId> removed(consumers[1]->getConsumerId()->cloneDataStructure());
+    consumers[1]->close();
+
+    CPPUNIT_ASSERT(kernel->lookupConsumerKernel(removed) == NULL);
+    for (int i = 0; i < 3; i += 2) {
+        Pointer<ConsumerId> id(consumers[i]->getConsumerId()->cloneDataStructure());
+        CPPUNIT_ASSERT(kernel->lookupConsumerKernel(id) != NULL);
+    }
+
+    // Dispatch still finds the consumers that are left.
+    injectTextMessage("After", *topic, *(consumers[2]->getConsumerId()));
+    listeners[2].asyncWaitForMessages(1);
+    CPPUNIT_ASSERT_EQUAL(1, (int) listeners[2].messages.size());
+    CPPUNIT_ASSERT_EQUAL(0, (int) listeners[0].messages.size());
+    CPPUNIT_ASSERT_EQUAL(1, (int) listeners[1].messages.size());
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 void ActiveMQSessionTest::setUp() {
 
@@ -51,6 +51,20 @@ namespace core{
         CPPUNIT_TEST( testCreateManyConsumersAndSetListeners );
         CPPUNIT_TEST( testCreateTempQueueByName );
         CPPUNIT_TEST( testCreateTempTopicByName );
+        CPPUNIT_TEST( testReceiveBatch );
+        CPPUNIT_TEST( testSendWithoutCopy );
+        CPPUNIT_TEST( testOptimizedDispatch );
+        CPPUNIT_TEST( testOptimizedDispatchCoalescesAcks );
+        CPPUNIT_TEST( testOptimizedDispatchRedeliversAfterListenerThrows );
+        CPPUNIT_TEST( testAsyncCommit );
+        CPPUNIT_TEST( testLateAsyncCompletion );
+        CPPUNIT_TEST( testPipelinedCreation );
+        CPPUNIT_TEST( testPipelinedCreationRefused );
+        CPPUNIT_TEST( testCompressionThreshold );
+        CPPUNIT_TEST( testBackgroundCompressionOrdering );
+        CPPUNIT_TEST( testBackgroundCompressionDrainedOnProducerClose );
+        CPPUNIT_TEST( testBackgroundCompressionDrainedOnSessionClose );
+        CPPUNIT_TEST( testConsumerLookupById );
         CPPUNIT_TEST_SUITE_END();
 
     private:
@@ -107,6 +121,20 @@ namespace core{
         void testExpiration();
         void testCreateTempQueueByName();
         void testCreateTempTopicByName();
+        void testReceiveBatch();
+        void testSendWithoutCopy();
+        void testOptimizedDispatch();
+        void testOptimizedDispatchCoalescesAcks();
+        void testOptimizedDispatchRedeliversAfterListenerThrows();
+        void testAsyncCommit();
+        void testLateAsyncCompletion();
+        void testPipelinedCreation();
+        void testPipelinedCreationRefused();
+        void testCompressionThreshold();
+        void testBackgroundCompressionOrdering();
+        void testBackgroundCompressionDrainedOnProducerClose();
+        void testBackgroundCompressionDrainedOnSessionClose();
+        void testConsumerLookupById();
 
     };
 
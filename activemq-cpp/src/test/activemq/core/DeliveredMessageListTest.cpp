@@ -0,0 +1,289 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "DeliveredMessageListTest.h"
+
+#include <activemq/core/DeliveredMessageList.h>
+#include <activemq/commands/ActiveMQMessage.h>
+#include <activemq/commands/MessageDispatch.h>
+#include <activemq/commands/MessageId.h>
+#include <decaf/lang/Pointer.h>
+#include <decaf/util/ArrayList.h>
+#include <decaf/util/NoSuchElementException.h>
+#include <decaf/lang/exceptions/IllegalStateException.h>
+#include <decaf/lang/exceptions/UnsupportedOperationException.h>
+
+#include <memory>
+#include <vector>
+
+using namespace activemq;
+using namespace activemq::core;
+using namespace activemq::commands;
+using namespace decaf;
+using namespace decaf::lang;
+using namespace decaf::util;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    Pointer<MessageDispatch> createDispatch(long long sequenceId) {
+
+        Pointer<MessageId> id(new MessageId());
+        id->setProducerSequenceId(sequenceId);
+        id->setBrokerSequenceId(sequenceId);
+
+        Pointer<ActiveMQMessage> message(new ActiveMQMessage());
+        message->setMessageId(id);
+
+        Pointer<MessageDispatch> dispatch(new MessageDispatch());
+        dispatch->setMessage(message);
+
+        return dispatch;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void DeliveredMessageListTest::testCtor() {
+
+    DeliveredMessageList list;
+    CPPUNIT_ASSERT( list.isEmpty() == true );
+    CPPUNIT_ASSERT( list.size() == 0 );
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw a NoSuchElementException",
+        list.getFirst(),
+        NoSuchElementException );
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw a NoSuchElementException",
+        list.removeLast(),
+        NoSuchElementException );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void DeliveredMessageListTest::testAddFirst() {
+
+    DeliveredMessageList list;
+    Pointer<MessageDispatch> dispatch1 = createDispatch(1);
+    Pointer<MessageDispatch> dispatch2 = createDispatch(2);
+    Pointer<MessageDispatch> dispatch3 = createDispatch(3);
+
+    list.addFirst(dispatch1);
+    list.addFirst(dispatch2);
+    list.addFirst(dispatch3);
+
+    CPPUNIT_ASSERT( list.size() == 3 );
+    CPPUNIT_ASSERT( list.getFirst() == dispatch3 );
+    CPPUNIT_ASSERT( list.getLast() == dispatch1 );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void DeliveredMessageListTest::testAddLast() {
+
+    DeliveredMessageList list;
+    Pointer<MessageDispatch> dispatch1 = createDispatch(1);
+    Pointer<MessageDispatch> dispatch2 = createDispatch(2);
+
+    list.addLast(dispatch1);
+    list.add(dispatch2);
+
+    CPPUNIT_ASSERT( list.size() == 2 );
+    CPPUNIT_ASSERT( list.getFirst() == dispatch1 );
+    CPPUNIT_ASSERT( list.getLast() == dispatch2 );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void DeliveredMessageListTest::testContains() {
+
+    DeliveredMessageList list;
+    Pointer<MessageDispatch> dispatch1 = createDispatch(1);
+    Pointer<MessageDispatch> dispatch2 = createDispatch(2);
+
+    // Same MessageId but another dispatch, entries are matched by identity.
+    Pointer<MessageDispatch> other = createDispatch(1);
+
+    list.addFirst(dispatch1);
+
+    CPPUNIT_ASSERT( list.contains(dispatch1) == true );
+    CPPUNIT_ASSERT( list.contains(dispatch2) == false );
+    CPPUNIT_ASSERT( list.contains(other) == false );
+    CPPUNIT_ASSERT( list.contains(Pointer<MessageDispatch>()) == false );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void DeliveredMessageListTest::testRemove() {
+
+    DeliveredMessageList list;
+    Pointer<MessageDispatch> dispatch1 = createDispatch(1);
+    Pointer<MessageDispatch> dispatch2 = createDispatch(2);
+    Pointer<MessageDispatch> dispatch3 = createDispatch(3);
+
+    list.addFirst(dispatch1);
+    list.addFirst(dispatch2);
+    list.addFirst(dispatch3);
+
+    CPPUNIT_ASSERT( list.remove(dispatch2) == true );
+    CPPUNIT_ASSERT( list.remove(dispatch2) == false );
+    CPPUNIT_ASSERT( list.size() == 2 );
+    CPPUNIT_ASSERT( list.contains(dispatch2) == false );
+    CPPUNIT_ASSERT( list.getFirst() == dispatch3 );
+    CPPUNIT_ASSERT( list.getLast() == dispatch1 );
+
+    CPPUNIT_ASSERT( list.remove(dispatch3) == true );
+    CPPUNIT_ASSERT( list.remove(dispatch1) == true );
+    CPPUNIT_ASSERT( list.isEmpty() == true );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void DeliveredMessageListTest::testRemoveFirstAndLast() {
+
+    DeliveredMessageList list;
+    Pointer<MessageDispatch> dispatch1 = createDispatch(1);
+    Pointer<MessageDispatch> dispatch2 = createDispatch(2);
+    Pointer<MessageDispatch> dispatch3 = createDispatch(3);
+
+    list.addFirst(dispatch1);
+    list.addFirst(dispatch2);
+    list.addFirst(dispatch3);
+
+    CPPUNIT_ASSERT( list.removeLast() == dispatch1 );
+    CPPUNIT_ASSERT( list.contains(dispatch1) == false );
+    CPPUNIT_ASSERT( list.removeFirst() == dispatch3 );
+    CPPUNIT_ASSERT( list.contains(dispatch3) == false );
+    CPPUNIT_ASSERT( list.size() == 1 );
+    CPPUNIT_ASSERT( list.getFirst() == dispatch2 );
+    CPPUNIT_ASSERT( list.getLast() == dispatch2 );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void DeliveredMessageListTest::testReAddMovesEntry() {
+
+    DeliveredMessageList list;
+    Pointer<MessageDispatch> dispatch1 = createDispatch(1);
+    Pointer<MessageDispatch> dispatch2 = createDispatch(2);
+
+    list.addFirst(dispatch1);
+    list.addFirst(dispatch2);
+    list.addFirst(dispatch1);
+
+    CPPUNIT_ASSERT( list.size() == 2 );
+    CPPUNIT_ASSERT( list.getFirst() == dispatch1 );
+    CPPUNIT_ASSERT( list.getLast() == dispatch2 );
+
+    list.addFirst(dispatch1);
+    CPPUNIT_ASSERT( list.size() == 2 );
+    CPPUNIT_ASSERT( list.getFirst() == dispatch1 );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void DeliveredMessageListTest::testIterator() {
+
+    DeliveredMessageList list;
+    for (int i = 0; i < 10; ++i) {
+        list.addLast(createDispatch(i));
+    }
+
+    std::auto_ptr<Iterator< Pointer<MessageDispatch> > > iter(list.iterator());
+
+    long long expected = 0;
+    while (iter->hasNext()) {
+        CPPUNIT_ASSERT_EQUAL(expected++, iter->next()->getMessage()->getMessageId()->getProducerSequenceId());
+    }
+    CPPUNIT_ASSERT_EQUAL(10LL, expected);
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw a NoSuchElementException",
+        iter->next(),
+        NoSuchElementException );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void DeliveredMessageListTest::testIteratorRemove() {
+
+    DeliveredMessageList list;
+    std::vector< Pointer<MessageDispatch> > dispatches;
+    for (int i = 0; i < 10; ++i) {
+        dispatches.push_back(createDispatch(i));
+        list.addLast(dispatches.back());
+    }
+
+    std::auto_ptr<Iterator< Pointer<MessageDispatch> > > iter(list.iterator());
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw an IllegalStateException",
+        iter->remove(),
+        decaf::lang::exceptions::IllegalStateException );
+
+    while (iter->hasNext()) {
+        Pointer<MessageDispatch> dispatch = iter->next();
+        if (dispatch->getMessage()->getMessageId()->getProducerSequenceId() % 2 == 0) {
+            iter->remove();
+        }
+    }
+
+    CPPUNIT_ASSERT_EQUAL(5, list.size());
+    for (int i = 0; i < 10; ++i) {
+        CPPUNIT_ASSERT( list.contains(dispatches[i]) == (i % 2 != 0) );
+    }
+
+    const DeliveredMessageList& constList = list;
+    std::auto_ptr<Iterator< Pointer<MessageDispatch> > > constIter(constList.iterator());
+    constIter->next();
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw an UnsupportedOperationException",
+        constIter->remove(),
+        decaf::lang::exceptions::UnsupportedOperationException );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void DeliveredMessageListTest::testClear() {
+
+    DeliveredMessageList list;
+    Pointer<MessageDispatch> dispatch1 = createDispatch(1);
+    Pointer<MessageDispatch> dispatch2 = createDispatch(2);
+
+    list.addFirst(dispatch1);
+    list.addFirst(dispatch2);
+    list.clear();
+
+    CPPUNIT_ASSERT( list.isEmpty() == true );
+    CPPUNIT_ASSERT( list.contains(dispatch1) == false );
+    CPPUNIT_ASSERT( list.contains(dispatch2) == false );
+
+    list.addFirst(dispatch1);
+    CPPUNIT_ASSERT( list.size() == 1 );
+    CPPUNIT_ASSERT( list.getFirst() == dispatch1 );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void DeliveredMessageListTest::testCopy() {
+
+    DeliveredMessageList list;
+    Pointer<MessageDispatch> dispatch1 = createDispatch(1);
+    Pointer<MessageDispatch> dispatch2 = createDispatch(2);
+
+    list.addFirst(dispatch1);
+    list.addFirst(dispatch2);
+
+    ArrayList< Pointer<MessageDispatch> > copy;
+    copy.copy(list);
+
+    CPPUNIT_ASSERT_EQUAL(2, copy.size());
+    CPPUNIT_ASSERT( copy.get(0) == dispatch2 );
+    CPPUNIT_ASSERT( copy.get(1) == dispatch1 );
+}
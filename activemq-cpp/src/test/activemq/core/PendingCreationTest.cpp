@@ -0,0 +1,143 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "PendingCreationTest.h"
+
+#include <activemq/core/PendingCreation.h>
+#include <activemq/commands/BrokerError.h>
+#include <activemq/commands/ExceptionResponse.h>
+#include <activemq/commands/Response.h>
+#include <activemq/exceptions/ActiveMQException.h>
+#include <activemq/transport/FutureResponse.h>
+#include <decaf/lang/Pointer.h>
+#include <decaf/lang/Runnable.h>
+#include <decaf/lang/Thread.h>
+
+using namespace activemq;
+using namespace activemq::core;
+using namespace activemq::commands;
+using namespace activemq::exceptions;
+using namespace activemq::transport;
+using namespace decaf;
+using namespace decaf::lang;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    Pointer<Response> createErrorResponse(const std::string& message) {
+        Pointer<BrokerError> error(new BrokerError());
+        error->setExceptionClass("javax.jms.JMSSecurityException");
+        error->setMessage(message);
+
+        Pointer<ExceptionResponse> response(new ExceptionResponse());
+        response->setException(error);
+        return response;
+    }
+
+    class DelayedResponder : public Runnable {
+    private:
+
+        Pointer<FutureResponse> future;
+
+    private:
+
+        DelayedResponder(const DelayedResponder&);
+        DelayedResponder& operator=(const DelayedResponder&);
+
+    public:
+
+        DelayedResponder(Pointer<FutureResponse> future) : Runnable(), future(future) {}
+
+        virtual ~DelayedResponder() {}
+
+        virtual void run() {
+            Thread::sleep(100);
+            future->setResponse(Pointer<Response>(new Response()));
+        }
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void PendingCreationTest::testNotPending() {
+
+    PendingCreation creation;
+
+    CPPUNIT_ASSERT(!creation.isPending());
+    CPPUNIT_ASSERT(!creation.await());
+    CPPUNIT_ASSERT_NO_THROW(creation.checkCreated());
+
+    creation.setFuture(Pointer<FutureResponse>());
+    CPPUNIT_ASSERT(!creation.isPending());
+    CPPUNIT_ASSERT(!creation.await());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void PendingCreationTest::testCreated() {
+
+    PendingCreation creation;
+    Pointer<FutureResponse> future(new FutureResponse());
+
+    creation.setFuture(future);
+    CPPUNIT_ASSERT(creation.isPending());
+
+    future->setResponse(Pointer<Response>(new Response()));
+
+    CPPUNIT_ASSERT(!creation.await());
+    CPPUNIT_ASSERT(!creation.isPending());
+    CPPUNIT_ASSERT_NO_THROW(creation.checkCreated());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void PendingCreationTest::testRefused() {
+
+    PendingCreation creation;
+    Pointer<FutureResponse> future(new FutureResponse());
+
+    creation.setFuture(future);
+    future->setResponse(createErrorResponse("Not authorized"));
+
+    CPPUNIT_ASSERT_MESSAGE("First await should report the refusal", creation.await());
+    CPPUNIT_ASSERT(!creation.isPending());
+    CPPUNIT_ASSERT_THROW(creation.checkCreated(), ActiveMQException);
+
+    CPPUNIT_ASSERT_MESSAGE("Refusal is only reported once", !creation.await());
+    CPPUNIT_ASSERT_THROW(creation.checkCreated(), ActiveMQException);
+
+    try {
+        creation.checkCreated();
+    } catch (ActiveMQException& ex) {
+        CPPUNIT_ASSERT(ex.getMessage().find("Not authorized") != std::string::npos);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void PendingCreationTest::testAwaitBlocksForResponse() {
+
+    PendingCreation creation;
+    Pointer<FutureResponse> future(new FutureResponse());
+    creation.setFuture(future);
+
+    DelayedResponder responder(future);
+    Thread thread(&responder);
+    thread.start();
+
+    CPPUNIT_ASSERT(!creation.await());
+    CPPUNIT_ASSERT(!creation.isPending());
+    CPPUNIT_ASSERT(future->getResponse() != NULL);
+
+    thread.join();
+}
@@ -0,0 +1,412 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "RingMessageDispatchChannelTest.h"
+
+#include <activemq/core/RingMessageDispatchChannel.h>
+#include <activemq/commands/MessageDispatch.h>
+#include <decaf/lang/Pointer.h>
+#include <decaf/lang/System.h>
+#include <decaf/lang/Thread.h>
+#include <decaf/util/concurrent/CountDownLatch.h>
+
+#include <vector>
+
+using namespace activemq;
+using namespace activemq::core;
+using namespace activemq::commands;
+using namespace decaf;
+using namespace decaf::lang;
+using namespace decaf::util::concurrent;
+
+////////////////////////////////////////////////////////////////////////////////
+void RingMessageDispatchChannelTest::testCtor() {
+
+    RingMessageDispatchChannel channel;
+    CPPUNIT_ASSERT( channel.isRunning() == false );
+    CPPUNIT_ASSERT( channel.isEmpty() == true );
+    CPPUNIT_ASSERT( channel.size() == 0 );
+    CPPUNIT_ASSERT( channel.isClosed() == false );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void RingMessageDispatchChannelTest::testCapacity() {
+
+    RingMessageDispatchChannel defaultChannel;
+    CPPUNIT_ASSERT( defaultChannel.getCapacity() >= RingMessageDispatchChannel::DEFAULT_CAPACITY );
+
+    RingMessageDispatchChannel small( 1 );
+    CPPUNIT_ASSERT_EQUAL( 16, small.getCapacity() );
+
+    RingMessageDispatchChannel rounded( 100 );
+    CPPUNIT_ASSERT_EQUAL( 128, rounded.getCapacity() );
+
+    RingMessageDispatchChannel large( 1000000 );
+    CPPUNIT_ASSERT_EQUAL( RingMessageDispatchChannel::MAX_CAPACITY, large.getCapacity() );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void RingMessageDispatchChannelTest::testStart() {
+
+    RingMessageDispatchChannel channel;
+    channel.start();
+    CPPUNIT_ASSERT( channel.isRunning() == true );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void RingMessageDispatchChannelTest::testStop() {
+
+    RingMessageDispatchChannel channel;
+    channel.start();
+    CPPUNIT_ASSERT( channel.isRunning() == true );
+    channel.stop();
+    CPPUNIT_ASSERT( channel.isRunning() == false );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void RingMessageDispatchChannelTest::testClose() {
+
+    RingMessageDispatchChannel channel;
+    channel.start();
+    CPPUNIT_ASSERT( channel.isRunning() == true );
+    CPPUNIT_ASSERT( channel.isClosed() == false );
+    channel.close();
+    CPPUNIT_ASSERT( channel.isRunning() == false );
+    CPPUNIT_ASSERT( channel.isClosed() == true );
+    channel.start();
+    CPPUNIT_ASSERT( channel.isRunning() == false );
+    CPPUNIT_ASSERT( channel.isClosed() == true );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void RingMessageDispatchChannelTest::testEnqueue() {
+
+    RingMessageDispatchChannel channel;
+    Pointer<MessageDispatch> dispatch1( new MessageDispatch() );
+    Pointer<MessageDispatch> dispatch2( new MessageDispatch() );
+
+    CPPUNIT_ASSERT( channel.isEmpty() == true );
+    CPPUNIT_ASSERT( channel.size() == 0 );
+
+    channel.enqueue( dispatch1 );
+
+    CPPUNIT_ASSERT( channel.isEmpty() == false );
+    CPPUNIT_ASSERT( channel.size() == 1 );
+
+    channel.enqueue( dispatch2 );
+
+    CPPUNIT_ASSERT( channel.isEmpty() == false );
+    CPPUNIT_ASSERT( channel.size() == 2 );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void RingMessageDispatchChannelTest::testEnqueueFront() {
+
+    RingMessageDispatchChannel channel;
+    Pointer<MessageDispatch> dispatch1( new MessageDispatch() );
+    Pointer<MessageDispatch> dispatch2( new MessageDispatch() );
+
+    channel.start();
+
+    CPPUNIT_ASSERT( channel.isEmpty() == true );
+    CPPUNIT_ASSERT( channel.size() == 0 );
+
+    channel.enqueueFirst( dispatch1 );
+
+    CPPUNIT_ASSERT( channel.isEmpty() == false );
+    CPPUNIT_ASSERT( channel.size() == 1 );
+
+    channel.enqueueFirst( dispatch2 );
+
+    CPPUNIT_ASSERT( channel.isEmpty() == false );
+    CPPUNIT_ASSERT( channel.size() == 2 );
+
+    CPPUNIT_ASSERT( channel.dequeueNoWait() == dispatch2 );
+    CPPUNIT_ASSERT( channel.dequeueNoWait() == dispatch1 );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void RingMessageDispatchChannelTest::testPeek() {
+
+    RingMessageDispatchChannel channel;
+    Pointer<MessageDispatch> dispatch1( new MessageDispatch() );
+    Pointer<MessageDispatch> dispatch2( new MessageDispatch() );
+
+    CPPUNIT_ASSERT( channel.isEmpty() == true );
+    CPPUNIT_ASSERT( channel.size() == 0 );
+
+    channel.enqueueFirst( dispatch1 );
+
+    CPPUNIT_ASSERT( channel.isEmpty() == false );
+    CPPUNIT_ASSERT( channel.size() == 1 );
+
+    channel.enqueueFirst( dispatch2 );
+
+    CPPUNIT_ASSERT( channel.isEmpty() == false );
+    CPPUNIT_ASSERT( channel.size() == 2 );
+
+    CPPUNIT_ASSERT( channel.peek() == NULL );
+
+    channel.start();
+
+    CPPUNIT_ASSERT( channel.peek() == dispatch2 );
+    CPPUNIT_ASSERT( channel.dequeueNoWait() == dispatch2 );
+    CPPUNIT_ASSERT( channel.peek() == dispatch1 );
+    CPPUNIT_ASSERT( channel.dequeueNoWait() == dispatch1 );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void RingMessageDispatchChannelTest::testDequeueNoWait() {
+
+    RingMessageDispatchChannel channel;
+
+    Pointer<MessageDispatch> dispatch1( new MessageDispatch() );
+    Pointer<MessageDispatch> dispatch2( new MessageDispatch() );
+    Pointer<MessageDispatch> dispatch3( new MessageDispatch() );
+
+    CPPUNIT_ASSERT( channel.isRunning() == false );
+    CPPUNIT_ASSERT( channel.dequeueNoWait() == NULL );
+
+    channel.enqueue( dispatch1 );
+    channel.enqueue( dispatch2 );
+    channel.enqueue( dispatch3 );
+
+    CPPUNIT_ASSERT( channel.dequeueNoWait() == NULL );
+    channel.start();
+    CPPUNIT_ASSERT( channel.isRunning() == true );
+
+    CPPUNIT_ASSERT( channel.isEmpty() == false );
+    CPPUNIT_ASSERT( channel.size() == 3 );
+    CPPUNIT_ASSERT( channel.dequeueNoWait() == dispatch1 );
+    CPPUNIT_ASSERT( channel.dequeueNoWait() == dispatch2 );
+    CPPUNIT_ASSERT( channel.dequeueNoWait() == dispatch3 );
+
+    CPPUNIT_ASSERT( channel.size() == 0 );
+    CPPUNIT_ASSERT( channel.isEmpty() == true );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void RingMessageDispatchChannelTest::testDequeue() {
+
+    RingMessageDispatchChannel channel;
+
+    Pointer<MessageDispatch> dispatch1( new MessageDispatch() );
+    Pointer<MessageDispatch> dispatch2( new MessageDispatch() );
+    Pointer<MessageDispatch> dispatch3( new MessageDispatch() );
+
+    channel.start();
+    CPPUNIT_ASSERT( channel.isRunning() == true );
+
+    long long timeStarted = System::currentTimeMillis();
+
+    CPPUNIT_ASSERT( channel.dequeue( 1000 ) == NULL );
+
+    CPPUNIT_ASSERT( System::currentTimeMillis() - timeStarted >= 999 );
+
+    channel.enqueue( dispatch1 );
+    channel.enqueue( dispatch2 );
+    channel.enqueue( dispatch3 );
+    CPPUNIT_ASSERT( channel.isEmpty() == false );
+    CPPUNIT_ASSERT( channel.size() == 3 );
+    CPPUNIT_ASSERT( channel.dequeue( -1 ) == dispatch1 );
+    CPPUNIT_ASSERT( channel.dequeue( 0 ) == dispatch2 );
+    CPPUNIT_ASSERT( channel.dequeue( 1000 ) == dispatch3 );
+
+    CPPUNIT_ASSERT( channel.size() == 0 );
+    CPPUNIT_ASSERT( channel.isEmpty() == true );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void RingMessageDispatchChannelTest::testRemoveAll() {
+
+    RingMessageDispatchChannel channel;
+
+    Pointer<MessageDispatch> dispatch1( new MessageDispatch() );
+    Pointer<MessageDispatch> dispatch2( new MessageDispatch() );
+    Pointer<MessageDispatch> dispatch3( new MessageDispatch() );
+
+    channel.enqueue( dispatch1 );
+    channel.enqueue( dispatch2 );
+    channel.enqueue( dispatch3 );
+
+    channel.start();
+    CPPUNIT_ASSERT( channel.isRunning() == true );
+    CPPUNIT_ASSERT( channel.isEmpty() == false );
+    CPPUNIT_ASSERT( channel.size() == 3 );
+    CPPUNIT_ASSERT( channel.removeAll().size() == 3 );
+    CPPUNIT_ASSERT( channel.size() == 0 );
+    CPPUNIT_ASSERT( channel.isEmpty() == true );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void RingMessageDispatchChannelTest::testOverflow() {
+
+    RingMessageDispatchChannel channel( 16 );
+    std::vector< Pointer<MessageDispatch> > dispatches;
+
+    for (int i = 0; i < 40; ++i) {
+        Pointer<MessageDispatch> dispatch( new MessageDispatch() );
+        dispatches.push_back( dispatch );
+        channel.enqueue( dispatch );
+    }
+
+    CPPUNIT_ASSERT_EQUAL( 40, channel.size() );
+
+    channel.start();
+
+    // Drain part of the ring so later messages could fit again, they must still
+    // be delivered after the ones that overflowed before them.
+    for (int i = 0; i < 8; ++i) {
+        CPPUNIT_ASSERT( channel.dequeueNoWait() == dispatches[i] );
+    }
+
+    for (int i = 0; i < 8; ++i) {
+        Pointer<MessageDispatch> dispatch( new MessageDispatch() );
+        dispatches.push_back( dispatch );
+        channel.enqueue( dispatch );
+    }
+
+    Pointer<MessageDispatch> first( new MessageDispatch() );
+    channel.enqueueFirst( first );
+    CPPUNIT_ASSERT( channel.peek() == first );
+    CPPUNIT_ASSERT( channel.dequeueNoWait() == first );
+
+    for (std::size_t i = 8; i < dispatches.size(); ++i) {
+        CPPUNIT_ASSERT( channel.dequeueNoWait() == dispatches[i] );
+    }
+
+    CPPUNIT_ASSERT( channel.dequeueNoWait() == NULL );
+    CPPUNIT_ASSERT( channel.isEmpty() == true );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void RingMessageDispatchChannelTest::testClear() {
+
+    RingMessageDispatchChannel channel( 16 );
+
+    for (int i = 0; i < 20; ++i) {
+        channel.enqueue( Pointer<MessageDispatch>( new MessageDispatch() ) );
+    }
+    channel.enqueueFirst( Pointer<MessageDispatch>( new MessageDispatch() ) );
+
+    CPPUNIT_ASSERT_EQUAL( 21, channel.size() );
+    channel.clear();
+    CPPUNIT_ASSERT_EQUAL( 0, channel.size() );
+    CPPUNIT_ASSERT( channel.isEmpty() == true );
+
+    Pointer<MessageDispatch> dispatch( new MessageDispatch() );
+    channel.enqueue( dispatch );
+    channel.start();
+    CPPUNIT_ASSERT( channel.dequeueNoWait() == dispatch );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    class ProducerThread : public Thread {
+    private:
+
+        RingMessageDispatchChannel* channel;
+        std::vector< Pointer<MessageDispatch> >* dispatches;
+        CountDownLatch* ready;
+
+    private:
+
+        ProducerThread(const ProducerThread&);
+        ProducerThread& operator=(const ProducerThread&);
+
+    public:
+
+        ProducerThread(RingMessageDispatchChannel* channel,
+                       std::vector< Pointer<MessageDispatch> >* dispatches,
+                       CountDownLatch* ready) :
+            Thread(), channel(channel), dispatches(dispatches), ready(ready) {
+        }
+
+        virtual ~ProducerThread() {}
+
+        virtual void run() {
+            ready->await();
+            for (std::size_t i = 0; i < dispatches->size(); ++i) {
+                channel->enqueue( (*dispatches)[i] );
+            }
+        }
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void RingMessageDispatchChannelTest::testConcurrentEnqueue() {
+
+    static const int COUNT = 5000;
+
+    RingMessageDispatchChannel channel( 64 );
+    channel.start();
+
+    std::vector< Pointer<MessageDispatch> > dispatches;
+    for (int i = 0; i < COUNT; ++i) {
+        dispatches.push_back( Pointer<MessageDispatch>( new MessageDispatch() ) );
+    }
+
+    CountDownLatch ready( 1 );
+    ProducerThread producer( &channel, &dispatches, &ready );
+    producer.start();
+    ready.countDown();
+
+    // A single producer must be seen in order, and the consumer must always be
+    // woken when it parks on an empty ring.
+    for (int i = 0; i < COUNT; ++i) {
+        Pointer<MessageDispatch> dispatch = channel.dequeue( 5000 );
+        CPPUNIT_ASSERT_MESSAGE( "Consumer was not woken", dispatch != NULL );
+        CPPUNIT_ASSERT( dispatch == dispatches[i] );
+    }
+
+    producer.join();
+    CPPUNIT_ASSERT( channel.isEmpty() == true );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void RingMessageDispatchChannelTest::testDequeueBatch() {
+
+    RingMessageDispatchChannel channel;
+
+    Pointer<MessageDispatch> dispatch1( new MessageDispatch() );
+    Pointer<MessageDispatch> dispatch2( new MessageDispatch() );
+    Pointer<MessageDispatch> dispatch3( new MessageDispatch() );
+
+    channel.enqueue( dispatch1 );
+    channel.enqueue( dispatch2 );
+    channel.enqueue( dispatch3 );
+
+    CPPUNIT_ASSERT( channel.dequeueBatch( 10, 0 ).empty() );
+
+    channel.start();
+
+    std::vector< Pointer<MessageDispatch> > batch = channel.dequeueBatch( 2, 0 );
+    CPPUNIT_ASSERT_EQUAL( (std::size_t) 2, batch.size() );
+    CPPUNIT_ASSERT( batch[0] == dispatch1 );
+    CPPUNIT_ASSERT( batch[1] == dispatch2 );
+    CPPUNIT_ASSERT( channel.size() == 1 );
+
+    batch = channel.dequeueBatch( 10, -1 );
+    CPPUNIT_ASSERT_EQUAL( (std::size_t) 1, batch.size() );
+    CPPUNIT_ASSERT( batch[0] == dispatch3 );
+    CPPUNIT_ASSERT( channel.isEmpty() == true );
+
+    long long timeStarted = System::currentTimeMillis();
+    CPPUNIT_ASSERT( channel.dequeueBatch( 10, 100 ).empty() );
+    CPPUNIT_ASSERT( System::currentTimeMillis() - timeStarted >= 99 );
+}
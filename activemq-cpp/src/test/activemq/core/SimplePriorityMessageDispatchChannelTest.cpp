@@ -22,6 +22,8 @@
 #include <decaf/lang/Pointer.h>
 #include <decaf/lang/System.h>
 
+#include <vector>
+
 using namespace activemq;
 using namespace activemq::core;
 using namespace activemq::commands;
@@ -284,3 +286,36 @@ void SimplePriorityMessageDispatchChannelTest::testRemoveAll() {
     CPPUNIT_ASSERT( channel.size() == 0 );
     CPPUNIT_ASSERT( channel.isEmpty() == true );
 }
+
+////////////////////////////////////////////////////////////////////////////////
+void SimplePriorityMessageDispatchChannelTest::testDequeueBatch() {
+
+    SimplePriorityMessageDispatchChannel channel;
+
+    Pointer<MessageDispatch> dispatch1( new MessageDispatch() );
+    Pointer<MessageDispatch> dispatch2( new MessageDispatch() );
+    Pointer<MessageDispatch> dispatch3( new MessageDispatch() );
+
+    channel.enqueue( dispatch1 );
+    channel.enqueue( dispatch2 );
+    channel.enqueue( dispatch3 );
+
+    CPPUNIT_ASSERT( channel.dequeueBatch( 10, 0 ).empty() );
+
+    channel.start();
+
+    std::vector< Pointer<MessageDispatch> > batch = channel.dequeueBatch( 2, 0 );
+    CPPUNIT_ASSERT_EQUAL( (std::size_t) 2, batch.size() );
+    CPPUNIT_ASSERT( batch[0] == dispatch1 );
+    CPPUNIT_ASSERT( batch[1] == dispatch2 );
+    CPPUNIT_ASSERT( channel.size() == 1 );
+
+    batch = channel.dequeueBatch( 10, -1 );
+    CPPUNIT_ASSERT_EQUAL( (std::size_t) 1, batch.size() );
+    CPPUNIT_ASSERT( batch[0] == dispatch3 );
+    CPPUNIT_ASSERT( channel.isEmpty() == true );
+
+    long long timeStarted = System::currentTimeMillis();
+    CPPUNIT_ASSERT( channel.dequeueBatch( 10, 100 ).empty() );
+    CPPUNIT_ASSERT( System::currentTimeMillis() - timeStarted >= 99 );
+}
@@ -19,17 +19,20 @@
 
 #include <activemq/transport/Transport.h>
 #include <activemq/wireformat/WireFormat.h>
+#include <activemq/wireformat/openwire/OpenWireFormat.h>
 #include <activemq/state/ConnectionStateTracker.h>
 #include <activemq/state/ConsumerState.h>
 #include <activemq/state/SessionState.h>
 #include <activemq/commands/ActiveMQTopic.h>
 #include <activemq/commands/Message.h>
 #include <activemq/commands/ConnectionInfo.h>
+#include <activemq/commands/ConsumerControl.h>
 #include <activemq/commands/SessionInfo.h>
 #include <activemq/commands/Message.h>
 #include <decaf/lang/Pointer.h>
 #include <decaf/lang/exceptions/UnsupportedOperationException.h>
 #include <decaf/util/LinkedList.h>
+#include <decaf/util/Properties.h>
 
 using namespace std;
 using namespace activemq;
@@ -53,9 +56,14 @@ namespace {
         LinkedList< Pointer<Command> > consumers;
         LinkedList< Pointer<Command> > messages;
         LinkedList< Pointer<Command> > messagePulls;
+        LinkedList< Pointer<Command> > consumerControls;
+        Pointer<wireformat::WireFormat> wireFormat;
 
     public:
 
+        TrackingTransport() : connections(), sessions(), producers(), consumers(), messages(),
+                              messagePulls(), consumerControls(), wireFormat() {}
+
         virtual ~TrackingTransport() {}
 
         virtual void start() {}
@@ -77,6 +85,8 @@ namespace {
                 messages.add(command);
             } else if (command->isMessagePull()) {
                 messagePulls.add(command);
+            } else if (command->isConsumerControl()) {
+                consumerControls.add(command);
             }
         }
 
@@ -94,7 +104,7 @@ namespace {
         }
 
         virtual Pointer<wireformat::WireFormat> getWireFormat() const {
-            return Pointer<wireformat::WireFormat>();
+            return wireFormat;
         }
 
         virtual void setWireFormat(const Pointer<wireformat::WireFormat> wireFormat) {
@@ -190,6 +200,39 @@ namespace {
         return conn;
     }
 
+    Pointer<wireformat::WireFormat> createWireFormat(int version) {
+        Pointer<wireformat::openwire::OpenWireFormat> wireFormat(
+            new wireformat::openwire::OpenWireFormat(decaf::util::Properties()));
+        wireFormat->setVersion(version);
+        return wireFormat;
+    }
+
+    Pointer<ConsumerInfo> addConsumer(ConnectionStateTracker& tracker, ConnectionData& conn, long long value, int prefetch) {
+
+        Pointer<ConsumerId> consumerId(new ConsumerId);
+        consumerId->setConnectionId("CONNECTION");
+        consumerId->setSessionId(12345);
+        consumerId->setValue(value);
+
+        Pointer<ConsumerInfo> consumer(new ConsumerInfo);
+        consumer->setConsumerId(consumerId);
+        consumer->setPrefetchSize(prefetch);
+        tracker.processConsumerInfo(consumer.get());
+
+        return consumer;
+    }
+
+    Pointer<ConsumerInfo> findSentConsumer(TrackingTransport& transport, const ConsumerId& id) {
+        Pointer<Iterator< Pointer<Command> > > iter(transport.consumers.iterator());
+        while (iter->hasNext()) {
+            Pointer<ConsumerInfo> info = iter->next().dynamicCast<ConsumerInfo>();
+            if (info->getConsumerId()->equals(&id)) {
+                return info;
+            }
+        }
+        return Pointer<ConsumerInfo>();
+    }
+
     void clearConnectionState(ConnectionStateTracker& tracker, ConnectionData& conn) {
         tracker.processRemoveProducer(conn.producer->getProducerId().get());
         tracker.processRemoveConsumer(conn.consumer->getConsumerId().get());
@@ -244,6 +287,38 @@ void ConnectionStateTrackerTest::testMessageCache() {
     CPPUNIT_ASSERT_EQUAL_MESSAGE("Should only be three messages", 4, transport->messages.size());
 }
 
+////////////////////////////////////////////////////////////////////////////////
+void ConnectionStateTrackerTest::testMessageCacheUsesMarshalledSize() {
+
+    Pointer<TrackingTransport> transport(new TrackingTransport);
+    ConnectionStateTracker tracker;
+    tracker.setTrackMessages(true);
+
+    ConnectionData conn = createConnectionState(tracker);
+
+    // Well under the estimated size of an empty message, only the size recorded
+    // when the message was marshaled lets more than one fit.
+    tracker.setMaxMessageCacheSize(1000);
+
+    int sequenceId = 1;
+
+    for (int i = 0; i < 100; ++i) {
+        decaf::lang::Pointer<commands::MessageId> id(new commands::MessageId());
+        id->setProducerId(conn.producer->getProducerId());
+        id->setProducerSequenceId(sequenceId++);
+        Pointer<Message> message(new Message);
+        message->setMessageId(id);
+
+        tracker.processMessage(message.get());
+        message->setMarshalledSize(100);
+        tracker.trackBack(message);
+    }
+
+    tracker.restore(transport);
+
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Should keep eleven messages", 11, transport->messages.size());
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 void ConnectionStateTrackerTest::testMessagePullCache() {
 
@@ -266,3 +341,120 @@ void ConnectionStateTrackerTest::testMessagePullCache() {
 
     CPPUNIT_ASSERT_EQUAL_MESSAGE("Should only be three message pulls", 10, transport->messagePulls.size());
 }
+
+////////////////////////////////////////////////////////////////////////////////
+void ConnectionStateTrackerTest::testRestoreConsumersPullUntilRecovered() {
+
+    Pointer<TrackingTransport> transport(new TrackingTransport);
+    transport->wireFormat = createWireFormat(6);
+    ConnectionStateTracker tracker;
+
+    // The consumer created with the connection is already a pull consumer.
+    ConnectionData conn = createConnectionState(tracker);
+    Pointer<ConsumerInfo> first = addConsumer(tracker, conn, 43, 1000);
+    Pointer<ConsumerInfo> second = addConsumer(tracker, conn, 44, 500);
+
+    tracker.transportInterrupted();
+    tracker.restore(transport);
+
+    CPPUNIT_ASSERT_EQUAL(3, transport->consumers.size());
+
+    // Consumers with a prefetch are replayed as pull consumers until recovery is complete.
+    Pointer<ConsumerInfo> sent = findSentConsumer(*transport, *first->getConsumerId());
+    CPPUNIT_ASSERT(sent != NULL);
+    CPPUNIT_ASSERT_EQUAL(0, sent->getPrefetchSize());
+
+    sent = findSentConsumer(*transport, *second->getConsumerId());
+    CPPUNIT_ASSERT(sent != NULL);
+    CPPUNIT_ASSERT_EQUAL(0, sent->getPrefetchSize());
+
+    sent = findSentConsumer(*transport, *conn.consumer->getConsumerId());
+    CPPUNIT_ASSERT(sent != NULL);
+    CPPUNIT_ASSERT_EQUAL(0, sent->getPrefetchSize());
+
+    CPPUNIT_ASSERT_EQUAL(0, transport->consumerControls.size());
+
+    // Completing recovery restores the prefetch of each consumer put in pull mode.
+    tracker.connectionInterruptProcessingComplete(transport.get(), conn.connection->getConnectionId());
+
+    CPPUNIT_ASSERT_EQUAL(2, transport->consumerControls.size());
+
+    Pointer<Iterator< Pointer<Command> > > iter(transport->consumerControls.iterator());
+    while (iter->hasNext()) {
+        Pointer<ConsumerControl> control = iter->next().dynamicCast<ConsumerControl>();
+        if (control->getConsumerId()->equals(first->getConsumerId().get())) {
+            CPPUNIT_ASSERT_EQUAL(1000, control->getPrefetch());
+        } else {
+            CPPUNIT_ASSERT(control->getConsumerId()->equals(second->getConsumerId().get()));
+            CPPUNIT_ASSERT_EQUAL(500, control->getPrefetch());
+        }
+    }
+
+    // The tracked consumers keep their prefetch for the next restore.
+    transport.reset(new TrackingTransport);
+    transport->wireFormat = createWireFormat(6);
+    tracker.restore(transport);
+
+    CPPUNIT_ASSERT_EQUAL(1000, findSentConsumer(*transport, *first->getConsumerId())->getPrefetchSize());
+    CPPUNIT_ASSERT_EQUAL(500, findSentConsumer(*transport, *second->getConsumerId())->getPrefetchSize());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ConnectionStateTrackerTest::testRestoreConsumersWithoutPull() {
+
+    ConnectionStateTracker tracker;
+    ConnectionData conn = createConnectionState(tracker);
+    Pointer<ConsumerInfo> consumer = addConsumer(tracker, conn, 43, 1000);
+
+    // A wire format too old for pull consumers replays them as they are.
+    Pointer<TrackingTransport> transport(new TrackingTransport);
+    transport->wireFormat = createWireFormat(5);
+
+    tracker.transportInterrupted();
+    tracker.restore(transport);
+
+    CPPUNIT_ASSERT_EQUAL(2, transport->consumers.size());
+    CPPUNIT_ASSERT_EQUAL(1000, findSentConsumer(*transport, *consumer->getConsumerId())->getPrefetchSize());
+
+    tracker.connectionInterruptProcessingComplete(transport.get(), conn.connection->getConnectionId());
+    CPPUNIT_ASSERT_EQUAL(0, transport->consumerControls.size());
+
+    // Nor is there anything to recover from when the connection was not interrupted.
+    transport.reset(new TrackingTransport);
+    transport->wireFormat = createWireFormat(6);
+
+    tracker.restore(transport);
+
+    CPPUNIT_ASSERT_EQUAL(2, transport->consumers.size());
+    CPPUNIT_ASSERT_EQUAL(1000, findSentConsumer(*transport, *consumer->getConsumerId())->getPrefetchSize());
+
+    tracker.connectionInterruptProcessingComplete(transport.get(), conn.connection->getConnectionId());
+    CPPUNIT_ASSERT_EQUAL(0, transport->consumerControls.size());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ConnectionStateTrackerTest::testRemoveRecoveringConsumer() {
+
+    Pointer<TrackingTransport> transport(new TrackingTransport);
+    transport->wireFormat = createWireFormat(6);
+    ConnectionStateTracker tracker;
+
+    ConnectionData conn = createConnectionState(tracker);
+    Pointer<ConsumerInfo> kept = addConsumer(tracker, conn, 43, 1000);
+    Pointer<ConsumerInfo> closed = addConsumer(tracker, conn, 44, 1000);
+
+    tracker.transportInterrupted();
+    tracker.restore(transport);
+
+    // A consumer closed while recovering is not given its prefetch back.
+    tracker.processRemoveConsumer(closed->getConsumerId().get());
+    tracker.connectionInterruptProcessingComplete(transport.get(), conn.connection->getConnectionId());
+
+    CPPUNIT_ASSERT_EQUAL(1, transport->consumerControls.size());
+    Pointer<ConsumerControl> control = transport->consumerControls.getFirst().dynamicCast<ConsumerControl>();
+    CPPUNIT_ASSERT(control->getConsumerId()->equals(kept->getConsumerId().get()));
+
+    // Removing a consumer that is not recovering is fine as well.
+    tracker.processRemoveConsumer(kept->getConsumerId().get());
+    clearConnectionState(tracker, conn);
+}
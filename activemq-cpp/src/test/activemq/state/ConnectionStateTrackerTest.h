@@ -29,7 +29,11 @@ namespace state {
         CPPUNIT_TEST_SUITE( ConnectionStateTrackerTest );
         CPPUNIT_TEST( test );
         CPPUNIT_TEST( testMessageCache );
+        CPPUNIT_TEST( testMessageCacheUsesMarshalledSize );
         CPPUNIT_TEST( testMessagePullCache );
+        CPPUNIT_TEST( testRestoreConsumersPullUntilRecovered );
+        CPPUNIT_TEST( testRestoreConsumersWithoutPull );
+        CPPUNIT_TEST( testRemoveRecoveringConsumer );
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -39,7 +43,11 @@ namespace state {
 
         void test();
         void testMessageCache();
+        void testMessageCacheUsesMarshalledSize();
         void testMessagePullCache();
+        void testRestoreConsumersPullUntilRecovered();
+        void testRestoreConsumersWithoutPull();
+        void testRemoveRecoveringConsumer();
 
     };
 
@@ -20,6 +20,10 @@
 #include <activemq/threads/CompositeTask.h>
 #include <activemq/threads/CompositeTaskRunner.h>
 #include <decaf/lang/Thread.h>
+#include <decaf/lang/Runnable.h>
+#include <decaf/util/concurrent/CountDownLatch.h>
+#include <decaf/util/concurrent/TimeUnit.h>
+#include <decaf/util/concurrent/atomic/AtomicBoolean.h>
 
 #include <iostream>
 #include <iomanip>
@@ -28,6 +32,8 @@ using namespace std;
 using namespace activemq;
 using namespace activemq::threads;
 using namespace decaf::lang;
+using namespace decaf::util::concurrent;
+using namespace decaf::util::concurrent::atomic;
 
 ////////////////////////////////////////////////////////////////////////////////
 namespace {
@@ -56,6 +62,49 @@ namespace {
         }
 
     };
+
+    class BlockingTask : public CompositeTask {
+    private:
+
+        AtomicBoolean pending;
+
+    public:
+
+        CountDownLatch started;
+        CountDownLatch release;
+
+        BlockingTask() : pending(true), started(1), release(1) {}
+
+        virtual bool isPending() const {
+            return pending.get();
+        }
+
+        virtual bool iterate() {
+            pending.set(false);
+            started.countDown();
+            release.await();
+            return false;
+        }
+    };
+
+    class RemoveTaskRunnable : public Runnable {
+    private:
+
+        CompositeTaskRunner* runner;
+        CompositeTask* task;
+
+    public:
+
+        AtomicBoolean done;
+
+        RemoveTaskRunnable(CompositeTaskRunner* runner, CompositeTask* task) :
+            Runnable(), runner(runner), task(task), done() {}
+
+        virtual void run() {
+            runner->removeTask(task);
+            done.set(true);
+        }
+    };
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -98,3 +147,34 @@ void CompositeTaskRunnerTest::testCreateButNotStarted() {
     runner->shutdown();
     runner.reset(NULL);
 }
+
+////////////////////////////////////////////////////////////////////////////////
+void CompositeTaskRunnerTest::testBlockedTaskDoesNotBlockTaskList() {
+
+    CompositeTaskRunner runner;
+
+    BlockingTask blocking;
+    runner.addTask(&blocking);
+    runner.start();
+
+    CPPUNIT_ASSERT(blocking.started.await(10, TimeUnit::SECONDS));
+
+    // With the runner stuck in the blocking task the list must still be usable.
+    CountingTask other("other", 10);
+    runner.addTask(&other);
+    runner.removeTask(&other);
+
+    // Removing the running task waits until its iterate returns.
+    RemoveTaskRunnable remover(&runner, &blocking);
+    Thread removeThread(&remover);
+    removeThread.start();
+
+    Thread::sleep(200);
+    CPPUNIT_ASSERT(!remover.done.get());
+
+    blocking.release.countDown();
+    removeThread.join(10000);
+    CPPUNIT_ASSERT(remover.done.get());
+
+    runner.shutdown();
+}
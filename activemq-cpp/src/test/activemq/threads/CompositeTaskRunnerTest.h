@@ -29,6 +29,7 @@ namespace threads {
         CPPUNIT_TEST_SUITE( CompositeTaskRunnerTest );
         CPPUNIT_TEST( test );
         CPPUNIT_TEST( testCreateButNotStarted );
+        CPPUNIT_TEST( testBlockedTaskDoesNotBlockTaskList );
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -38,6 +39,7 @@ namespace threads {
 
         void test();
         void testCreateButNotStarted();
+        void testBlockedTaskDoesNotBlockTaskList();
 
     };
 
@@ -0,0 +1,268 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "HashedWheelTimerTest.h"
+
+#include <activemq/threads/HashedWheelTimer.h>
+#include <decaf/lang/Runnable.h>
+#include <decaf/lang/Thread.h>
+#include <decaf/util/concurrent/atomic/AtomicInteger.h>
+#include <decaf/util/concurrent/atomic/AtomicBoolean.h>
+#include <decaf/lang/exceptions/NullPointerException.h>
+#include <decaf/lang/exceptions/IllegalArgumentException.h>
+#include <decaf/lang/exceptions/IllegalStateException.h>
+
+#include <vector>
+
+using namespace std;
+using namespace decaf;
+using namespace decaf::lang;
+using namespace decaf::lang::exceptions;
+using namespace decaf::util::concurrent::atomic;
+using namespace activemq;
+using namespace activemq::threads;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    class CounterTask : public Runnable {
+    private:
+
+        AtomicInteger count;
+
+    public:
+
+        CounterTask() : count() {
+        }
+
+        virtual ~CounterTask() {}
+
+        int getCount() const {
+            return count.get();
+        }
+
+        virtual void run() {
+            count.incrementAndGet();
+        }
+
+    };
+
+    class SlowTask : public Runnable {
+    public:
+
+        AtomicBoolean started;
+        AtomicBoolean finished;
+
+    public:
+
+        SlowTask() : started(), finished() {
+        }
+
+        virtual ~SlowTask() {}
+
+        virtual void run() {
+            started.set(true);
+            Thread::sleep(300);
+            finished.set(true);
+        }
+
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+HashedWheelTimerTest::HashedWheelTimerTest() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+HashedWheelTimerTest::~HashedWheelTimerTest() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void HashedWheelTimerTest::testConstructor() {
+
+    HashedWheelTimer timer("testConstructor", 10, 100);
+
+    CPPUNIT_ASSERT_EQUAL(10LL, timer.getTickDuration());
+    CPPUNIT_ASSERT_EQUAL(128, timer.getTicksPerWheel());
+    CPPUNIT_ASSERT_EQUAL(0, timer.getTaskCount());
+    CPPUNIT_ASSERT_EQUAL(false, timer.isThreadAlive());
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should have thrown an IllegalArgumentException",
+        HashedWheelTimer("invalid", 0, 100),
+        IllegalArgumentException);
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should have thrown an IllegalArgumentException",
+        HashedWheelTimer("invalid", 10, 0),
+        IllegalArgumentException);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void HashedWheelTimerTest::testScheduleInvalidArgs() {
+
+    HashedWheelTimer timer("testScheduleInvalidArgs", 10, 16);
+    Pointer<Runnable> task(new CounterTask());
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should have thrown a NullPointerException",
+        timer.schedule(Pointer<Runnable>(), 0, 10),
+        NullPointerException);
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should have thrown an IllegalArgumentException",
+        timer.schedule(task, -1, 10),
+        IllegalArgumentException);
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should have thrown an IllegalArgumentException",
+        timer.schedule(task, 0, -1),
+        IllegalArgumentException);
+
+    CPPUNIT_ASSERT_EQUAL(false, timer.isThreadAlive());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void HashedWheelTimerTest::testScheduleOnce() {
+
+    HashedWheelTimer timer("testScheduleOnce", 10, 16);
+    Pointer<CounterTask> task(new CounterTask());
+
+    timer.schedule(task, 100, 0);
+    CPPUNIT_ASSERT_EQUAL(1, timer.getTaskCount());
+    CPPUNIT_ASSERT_EQUAL(true, timer.isThreadAlive());
+
+    Thread::sleep(50);
+    CPPUNIT_ASSERT_EQUAL(0, task->getCount());
+
+    Thread::sleep(300);
+    CPPUNIT_ASSERT_EQUAL(1, task->getCount());
+    CPPUNIT_ASSERT_EQUAL(0, timer.getTaskCount());
+    CPPUNIT_ASSERT_EQUAL(1LL, timer.getExecutionCount());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void HashedWheelTimerTest::testSchedulePeriodically() {
+
+    HashedWheelTimer timer("testSchedulePeriodically", 10, 8);
+    Pointer<CounterTask> task(new CounterTask());
+
+    // The period spans more than one turn of the wheel.
+    timer.schedule(task, 0, 100);
+
+    Thread::sleep(550);
+    int count = task->getCount();
+    CPPUNIT_ASSERT_MESSAGE("Task should have run about six times", count >= 4 && count <= 7);
+    CPPUNIT_ASSERT_EQUAL(1, timer.getTaskCount());
+
+    // With a single task the thread sleeps until its bucket comes around instead
+    // of waking on every tick.
+    CPPUNIT_ASSERT(timer.getWakeupCount() < 20);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void HashedWheelTimerTest::testCancel() {
+
+    HashedWheelTimer timer("testCancel", 10, 16);
+    Pointer<CounterTask> task(new CounterTask());
+
+    timer.schedule(task, 0, 50);
+    Thread::sleep(120);
+
+    CPPUNIT_ASSERT_EQUAL(true, timer.cancel(task.get()));
+    CPPUNIT_ASSERT_EQUAL(false, timer.cancel(task.get()));
+    CPPUNIT_ASSERT_EQUAL(0, timer.getTaskCount());
+
+    int count = task->getCount();
+    CPPUNIT_ASSERT(count >= 1);
+
+    Thread::sleep(200);
+    CPPUNIT_ASSERT_EQUAL(count, task->getCount());
+
+    // A canceled task can be scheduled again.
+    timer.schedule(task, 0, 50);
+    Thread::sleep(120);
+    CPPUNIT_ASSERT(task->getCount() > count);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void HashedWheelTimerTest::testCancelWaitsForRunningTask() {
+
+    HashedWheelTimer timer("testCancelWaitsForRunningTask", 10, 16);
+    Pointer<SlowTask> task(new SlowTask());
+
+    timer.schedule(task, 0, 0);
+
+    while (!task->started.get()) {
+        Thread::sleep(5);
+    }
+
+    timer.cancel(task.get());
+    CPPUNIT_ASSERT_EQUAL(true, task->finished.get());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void HashedWheelTimerTest::testManyTasksOneThread() {
+
+    const int TASK_COUNT = 1000;
+
+    HashedWheelTimer timer("testManyTasksOneThread", 10, 64);
+    std::vector< Pointer<CounterTask> > tasks;
+
+    for (int i = 0; i < TASK_COUNT; ++i) {
+        Pointer<CounterTask> task(new CounterTask());
+        tasks.push_back(task);
+        timer.schedule(task, i % 100, 100);
+    }
+
+    CPPUNIT_ASSERT_EQUAL(TASK_COUNT, timer.getTaskCount());
+
+    Thread::sleep(350);
+
+    for (int i = 0; i < TASK_COUNT; ++i) {
+        CPPUNIT_ASSERT(tasks[i]->getCount() >= 2);
+    }
+
+    // The wakeups depend on the tick duration, not on the number of tasks.
+    CPPUNIT_ASSERT(timer.getWakeupCount() < 100);
+
+    for (int i = 0; i < TASK_COUNT; ++i) {
+        timer.cancel(tasks[i].get());
+    }
+
+    CPPUNIT_ASSERT_EQUAL(0, timer.getTaskCount());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void HashedWheelTimerTest::testShutdown() {
+
+    HashedWheelTimer timer("testShutdown", 10, 16);
+    Pointer<CounterTask> task(new CounterTask());
+
+    timer.schedule(task, 0, 20);
+    Thread::sleep(50);
+
+    timer.shutdown();
+    CPPUNIT_ASSERT_EQUAL(false, timer.isThreadAlive());
+    CPPUNIT_ASSERT_EQUAL(0, timer.getTaskCount());
+
+    int count = task->getCount();
+    Thread::sleep(100);
+    CPPUNIT_ASSERT_EQUAL(count, task->getCount());
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should have thrown an IllegalStateException",
+        timer.schedule(task, 0, 20),
+        IllegalStateException);
+}
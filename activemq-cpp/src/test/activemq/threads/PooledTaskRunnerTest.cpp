@@ -0,0 +1,359 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "PooledTaskRunnerTest.h"
+
+#include <memory>
+#include <vector>
+
+#include <activemq/threads/Task.h>
+#include <activemq/threads/PooledTaskRunner.h>
+#include <activemq/threads/WorkStealingThreadPool.h>
+
+#include <decaf/lang/Thread.h>
+#include <decaf/lang/Runnable.h>
+#include <decaf/lang/exceptions/NullPointerException.h>
+#include <decaf/util/concurrent/CountDownLatch.h>
+#include <decaf/util/concurrent/TimeUnit.h>
+#include <decaf/util/concurrent/atomic/AtomicBoolean.h>
+#include <decaf/util/concurrent/atomic/AtomicInteger.h>
+
+using namespace activemq;
+using namespace activemq::threads;
+using namespace decaf::lang;
+using namespace decaf::lang::exceptions;
+using namespace decaf::util::concurrent;
+using namespace decaf::util::concurrent::atomic;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    class SimpleCountingTask : public Task {
+    private:
+
+        AtomicInteger count;
+
+    public:
+
+        SimpleCountingTask() : count() {}
+        virtual ~SimpleCountingTask() {}
+
+        virtual bool iterate() {
+            count.incrementAndGet();
+            return false;
+        }
+
+        int getCount() const { return count.get(); }
+    };
+
+    class InfiniteCountingTask : public Task {
+    private:
+
+        AtomicInteger count;
+
+    public:
+
+        InfiniteCountingTask() : count() {}
+        virtual ~InfiniteCountingTask() {}
+
+        virtual bool iterate() {
+            count.incrementAndGet();
+            return true;
+        }
+
+        int getCount() const { return count.get(); }
+    };
+
+    class OverlapCheckingTask : public Task {
+    private:
+
+        AtomicBoolean inside;
+        AtomicInteger remaining;
+
+    public:
+
+        AtomicBoolean overlapped;
+
+        OverlapCheckingTask(int iterations) : inside(false), remaining(iterations), overlapped(false) {}
+        virtual ~OverlapCheckingTask() {}
+
+        virtual bool iterate() {
+
+            if (!inside.compareAndSet(false, true)) {
+                overlapped.set(true);
+            }
+
+            Thread::yield();
+            inside.set(false);
+
+            return remaining.decrementAndGet() > 0;
+        }
+
+        int getRemaining() const { return remaining.get(); }
+    };
+
+    class CountDownTask : public Task {
+    private:
+
+        CountDownLatch* done;
+        int iterations;
+
+    private:
+
+        CountDownTask(const CountDownTask&);
+        CountDownTask& operator=(const CountDownTask&);
+
+    public:
+
+        CountDownTask(CountDownLatch* done, int iterations) : done(done), iterations(iterations) {}
+        virtual ~CountDownTask() {}
+
+        virtual bool iterate() {
+
+            if (--iterations > 0) {
+                return true;
+            }
+
+            if (iterations == 0) {
+                done->countDown();
+            }
+
+            return false;
+        }
+    };
+
+    class SelfStoppingTask : public Task {
+    public:
+
+        TaskRunner* runner;
+        CountDownLatch stopped;
+        AtomicInteger count;
+
+        SelfStoppingTask() : runner(NULL), stopped(1), count() {}
+        virtual ~SelfStoppingTask() {}
+
+        virtual bool iterate() {
+            count.incrementAndGet();
+            runner->shutdown();
+            stopped.countDown();
+            return true;
+        }
+    };
+
+    class BlockingTask : public Task {
+    public:
+
+        CountDownLatch started;
+        CountDownLatch release;
+
+        BlockingTask() : started(1), release(1) {}
+        virtual ~BlockingTask() {}
+
+        virtual bool iterate() {
+            started.countDown();
+            release.await();
+            return true;
+        }
+    };
+
+    class PoolDeleter : public Runnable {
+    private:
+
+        WorkStealingThreadPool* pool;
+
+    private:
+
+        PoolDeleter(const PoolDeleter&);
+        PoolDeleter& operator=(const PoolDeleter&);
+
+    public:
+
+        PoolDeleter(WorkStealingThreadPool* pool) : Runnable(), pool(pool) {}
+        virtual ~PoolDeleter() {}
+
+        virtual void run() {
+            delete pool;
+        }
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void PooledTaskRunnerTest::testSimple() {
+
+    WorkStealingThreadPool pool(2);
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw a NullPointerException",
+        std::auto_ptr<TaskRunner>( new PooledTaskRunner( NULL, &pool ) ),
+        NullPointerException );
+
+    SimpleCountingTask simpleTask;
+    CPPUNIT_ASSERT( simpleTask.getCount() == 0 );
+    PooledTaskRunner simpleTaskRunner( &simpleTask, &pool );
+
+    simpleTaskRunner.start();
+    CPPUNIT_ASSERT( simpleTaskRunner.isStarted() );
+
+    simpleTaskRunner.wakeup();
+    Thread::sleep( 250 );
+    CPPUNIT_ASSERT( simpleTask.getCount() >= 1 );
+    simpleTaskRunner.wakeup();
+    Thread::sleep( 250 );
+    CPPUNIT_ASSERT( simpleTask.getCount() >= 2 );
+
+    InfiniteCountingTask infiniteTask;
+    CPPUNIT_ASSERT( infiniteTask.getCount() == 0 );
+    PooledTaskRunner infiniteTaskRunner( &infiniteTask, &pool );
+    infiniteTaskRunner.start();
+    Thread::sleep( 500 );
+    CPPUNIT_ASSERT( infiniteTask.getCount() != 0 );
+    infiniteTaskRunner.shutdown();
+    int count = infiniteTask.getCount();
+    Thread::sleep( 250 );
+    CPPUNIT_ASSERT( infiniteTask.getCount() == count );
+
+    // The busy task must not have kept the other one from running.
+    int simpleCount = simpleTask.getCount();
+    simpleTaskRunner.wakeup();
+    Thread::sleep( 250 );
+    CPPUNIT_ASSERT( simpleTask.getCount() > simpleCount );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void PooledTaskRunnerTest::testNotRunUntilStarted() {
+
+    WorkStealingThreadPool pool(1);
+
+    SimpleCountingTask task;
+    PooledTaskRunner runner( &task, &pool );
+
+    runner.wakeup();
+    Thread::sleep( 100 );
+    CPPUNIT_ASSERT( !runner.isStarted() );
+    CPPUNIT_ASSERT_EQUAL( 0, task.getCount() );
+
+    runner.start();
+    Thread::sleep( 100 );
+    CPPUNIT_ASSERT( task.getCount() >= 1 );
+
+    runner.shutdown();
+    int count = task.getCount();
+    runner.wakeup();
+    Thread::sleep( 100 );
+    CPPUNIT_ASSERT_EQUAL( count, task.getCount() );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void PooledTaskRunnerTest::testIterationsNeverOverlap() {
+
+    WorkStealingThreadPool pool(4);
+
+    OverlapCheckingTask task(20000);
+    PooledTaskRunner runner( &task, &pool );
+    runner.start();
+
+    // Wakeups from many sides while the task is running must not start a second
+    // iteration on another worker.
+    for (int i = 0; i < 20000 && task.getRemaining() > 0; ++i) {
+        runner.wakeup();
+    }
+
+    for (int i = 0; i < 100 && task.getRemaining() > 0; ++i) {
+        Thread::sleep( 50 );
+    }
+
+    runner.shutdown();
+
+    CPPUNIT_ASSERT( task.getRemaining() <= 0 );
+    CPPUNIT_ASSERT( !task.overlapped.get() );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void PooledTaskRunnerTest::testManyRunnersShareThePool() {
+
+    const int RUNNERS = 200;
+
+    WorkStealingThreadPool pool(2);
+    CountDownLatch done(RUNNERS);
+
+    std::vector<CountDownTask*> tasks;
+    std::vector<PooledTaskRunner*> runners;
+
+    for (int i = 0; i < RUNNERS; ++i) {
+        tasks.push_back(new CountDownTask(&done, 50));
+        runners.push_back(new PooledTaskRunner(tasks.back(), &pool));
+        runners.back()->start();
+    }
+
+    CPPUNIT_ASSERT( done.await(10, TimeUnit::SECONDS) );
+    CPPUNIT_ASSERT_EQUAL( 2, pool.getThreadCount() );
+
+    for (int i = 0; i < RUNNERS; ++i) {
+        delete runners[i];
+        delete tasks[i];
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void PooledTaskRunnerTest::testShutdownFromTask() {
+
+    WorkStealingThreadPool pool(1);
+
+    SelfStoppingTask task;
+    PooledTaskRunner runner( &task, &pool );
+    task.runner = &runner;
+
+    runner.start();
+
+    CPPUNIT_ASSERT( task.stopped.await(5000) );
+    Thread::sleep( 100 );
+
+    // Asked to run again but shut down from within its own iteration.
+    CPPUNIT_ASSERT_EQUAL( 1, task.count.get() );
+    runner.shutdown();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void PooledTaskRunnerTest::testShutdownAfterPoolStopped() {
+
+    WorkStealingThreadPool* pool = new WorkStealingThreadPool(1);
+
+    BlockingTask blocking;
+    PooledTaskRunner blockingRunner( &blocking, pool );
+    blockingRunner.start();
+    CPPUNIT_ASSERT( blocking.started.await(5000) );
+
+    // Queued behind the blocked worker, so it is still queued when the pool stops.
+    SimpleCountingTask queued;
+    PooledTaskRunner queuedRunner( &queued, pool );
+    queuedRunner.start();
+
+    PoolDeleter deleter(pool);
+    Thread deleteThread(&deleter);
+    deleteThread.start();
+
+    Thread::sleep( 100 );
+    blocking.release.countDown();
+    deleteThread.join();
+
+    // Neither the dropped task nor the one the pool would not queue again may leave
+    // its runner waiting forever.
+    queuedRunner.shutdown();
+    blockingRunner.shutdown();
+
+    CPPUNIT_ASSERT_EQUAL( 0, queued.getCount() );
+}
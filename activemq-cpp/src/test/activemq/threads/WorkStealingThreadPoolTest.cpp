@@ -0,0 +1,214 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "WorkStealingThreadPoolTest.h"
+
+#include <activemq/threads/Task.h>
+#include <activemq/threads/WorkStealingThreadPool.h>
+
+#include <decaf/lang/Pointer.h>
+#include <decaf/lang/Thread.h>
+#include <decaf/lang/exceptions/IllegalArgumentException.h>
+#include <decaf/lang/exceptions/NullPointerException.h>
+#include <decaf/util/StlSet.h>
+#include <decaf/util/concurrent/CountDownLatch.h>
+#include <decaf/util/concurrent/Mutex.h>
+#include <decaf/util/concurrent/TimeUnit.h>
+
+using namespace activemq;
+using namespace activemq::threads;
+using namespace decaf::lang;
+using namespace decaf::lang::exceptions;
+using namespace decaf::util;
+using namespace decaf::util::concurrent;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    class LatchTask : public Task {
+    private:
+
+        CountDownLatch* latch;
+        int iterations;
+
+    private:
+
+        LatchTask(const LatchTask&);
+        LatchTask& operator=(const LatchTask&);
+
+    public:
+
+        LatchTask(CountDownLatch* latch, int iterations) : latch(latch), iterations(iterations) {}
+        virtual ~LatchTask() {}
+
+        virtual bool iterate() {
+            latch->countDown();
+            return --iterations > 0;
+        }
+    };
+
+    class BlockingTask : public Task {
+    private:
+
+        CountDownLatch* entered;
+        CountDownLatch* release;
+
+    private:
+
+        BlockingTask(const BlockingTask&);
+        BlockingTask& operator=(const BlockingTask&);
+
+    public:
+
+        BlockingTask(CountDownLatch* entered, CountDownLatch* release) : entered(entered), release(release) {}
+        virtual ~BlockingTask() {}
+
+        virtual bool iterate() {
+            entered->countDown();
+            release->await();
+            return false;
+        }
+    };
+
+    class ThreadRecordingTask : public Task {
+    private:
+
+        Mutex* mutex;
+        StlSet<Thread*>* threads;
+        CountDownLatch* done;
+
+    private:
+
+        ThreadRecordingTask(const ThreadRecordingTask&);
+        ThreadRecordingTask& operator=(const ThreadRecordingTask&);
+
+    public:
+
+        ThreadRecordingTask(Mutex* mutex, StlSet<Thread*>* threads, CountDownLatch* done) :
+            mutex(mutex), threads(threads), done(done) {}
+        virtual ~ThreadRecordingTask() {}
+
+        virtual bool iterate() {
+            synchronized(mutex) {
+                threads->add(Thread::currentThread());
+            }
+            Thread::sleep(20);
+            done->countDown();
+            return false;
+        }
+    };
+
+    class SpawningTask : public Task {
+    private:
+
+        WorkStealingThreadPool* pool;
+        Mutex* mutex;
+        StlSet<Thread*>* threads;
+        CountDownLatch* done;
+        int count;
+
+    private:
+
+        SpawningTask(const SpawningTask&);
+        SpawningTask& operator=(const SpawningTask&);
+
+    public:
+
+        SpawningTask(WorkStealingThreadPool* pool, Mutex* mutex, StlSet<Thread*>* threads, CountDownLatch* done, int count) :
+            pool(pool), mutex(mutex), threads(threads), done(done), count(count) {}
+        virtual ~SpawningTask() {}
+
+        virtual bool iterate() {
+            // Everything queued from a worker lands on that worker's own queue.
+            for (int i = 0; i < count; ++i) {
+                pool->execute(Pointer<Task>(new ThreadRecordingTask(mutex, threads, done)));
+            }
+            return false;
+        }
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void WorkStealingThreadPoolTest::testConstructor() {
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw an IllegalArgumentException",
+        WorkStealingThreadPool(0),
+        IllegalArgumentException);
+
+    WorkStealingThreadPool pool(3);
+    CPPUNIT_ASSERT_EQUAL(3, pool.getThreadCount());
+    CPPUNIT_ASSERT(!pool.isStarted());
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw a NullPointerException",
+        pool.execute(Pointer<Task>()),
+        NullPointerException);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void WorkStealingThreadPoolTest::testExecute() {
+
+    WorkStealingThreadPool pool(2);
+    CountDownLatch latch(10);
+
+    for (int i = 0; i < 10; ++i) {
+        pool.execute(Pointer<Task>(new LatchTask(&latch, 1)));
+    }
+
+    CPPUNIT_ASSERT(pool.isStarted());
+    CPPUNIT_ASSERT(latch.await(5, TimeUnit::SECONDS));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void WorkStealingThreadPoolTest::testTaskRunAgainWhileBusy() {
+
+    WorkStealingThreadPool pool(1);
+    CountDownLatch entered(1);
+    CountDownLatch release(1);
+    CountDownLatch repeated(100);
+    CountDownLatch other(1);
+
+    // A task asking to run again goes behind the tasks already queued.
+    pool.execute(Pointer<Task>(new BlockingTask(&entered, &release)));
+    CPPUNIT_ASSERT(entered.await(5000));
+
+    pool.execute(Pointer<Task>(new LatchTask(&repeated, 100)));
+    pool.execute(Pointer<Task>(new LatchTask(&other, 1)));
+    release.countDown();
+
+    CPPUNIT_ASSERT(other.await(5000));
+    CPPUNIT_ASSERT(repeated.getCount() > 0);
+    CPPUNIT_ASSERT(repeated.await(5000));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void WorkStealingThreadPoolTest::testIdleWorkersSteal() {
+
+    WorkStealingThreadPool pool(4);
+    Mutex mutex;
+    StlSet<Thread*> threads;
+    CountDownLatch done(40);
+
+    pool.execute(Pointer<Task>(new SpawningTask(&pool, &mutex, &threads, &done, 40)));
+
+    CPPUNIT_ASSERT(done.await(10, TimeUnit::SECONDS));
+
+    synchronized(&mutex) {
+        CPPUNIT_ASSERT(threads.size() > 1);
+    }
+}
@@ -29,10 +29,14 @@
 #include <decaf/io/BufferedOutputStream.h>
 #include <decaf/io/BlockingByteArrayInputStream.h>
 #include <decaf/io/ByteArrayOutputStream.h>
+#include <decaf/io/FilterOutputStream.h>
+#include <decaf/util/concurrent/atomic/AtomicInteger.h>
 #include <decaf/lang/Thread.h>
 #include <decaf/lang/Exception.h>
 #include <decaf/util/Random.h>
 
+#include <algorithm>
+
 using namespace activemq;
 using namespace activemq::transport;
 using namespace activemq::exceptions;
@@ -394,3 +398,191 @@ void IOTransportTest::testNarrow(){
     CPPUNIT_ASSERT( narrowed == &transport );
 
 }
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    class FlushCountingOutputStream : public decaf::io::FilterOutputStream {
+    public:
+
+        decaf::util::concurrent::atomic::AtomicInteger flushes;
+
+        // When set the first flush signals entered and then blocks until gate opens.
+        decaf::util::concurrent::CountDownLatch* entered;
+        decaf::util::concurrent::CountDownLatch* gate;
+
+    private:
+
+        FlushCountingOutputStream(const FlushCountingOutputStream&);
+        FlushCountingOutputStream& operator=(const FlushCountingOutputStream&);
+
+    public:
+
+        FlushCountingOutputStream(decaf::io::OutputStream* out) :
+            FilterOutputStream(out), flushes(), entered(NULL), gate(NULL) {}
+        virtual ~FlushCountingOutputStream() {}
+
+        virtual void flush() {
+            if (flushes.incrementAndGet() == 1 && gate != NULL) {
+                entered->countDown();
+                gate->await();
+            }
+            FilterOutputStream::flush();
+        }
+    };
+
+    class BatchSender : public decaf::lang::Runnable {
+    private:
+
+        IOTransport* transport;
+        char value;
+        int count;
+
+    private:
+
+        BatchSender(const BatchSender&);
+        BatchSender& operator=(const BatchSender&);
+
+    public:
+
+        BatchSender(IOTransport* transport, char value, int count) :
+            transport(transport), value(value), count(count) {}
+        virtual ~BatchSender() {}
+
+        virtual void run() {
+            for (int i = 0; i < count; ++i) {
+                Pointer<MyCommand> cmd(new MyCommand());
+                cmd->c = value;
+                transport->oneway(cmd);
+            }
+        }
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void IOTransportTest::testWriteBatching(){
+
+    decaf::io::BlockingByteArrayInputStream is;
+    decaf::io::ByteArrayOutputStream os;
+    FlushCountingOutputStream counting( &os );
+    decaf::io::BufferedOutputStream bos( &counting );
+    decaf::io::DataInputStream input( &is );
+    decaf::io::DataOutputStream output( &bos );
+
+    Pointer<MyWireFormat> wireFormat( new MyWireFormat() );
+    MyTransportListener listener;
+    IOTransport transport;
+    transport.setInputStream( &input );
+    transport.setOutputStream( &output );
+    transport.setTransportListener( &listener );
+    transport.setWireFormat( wireFormat );
+    transport.setWriteBatchingEnabled( true );
+
+    transport.start();
+
+    // A lone sender must not be left waiting on a batch.
+    Pointer<MyCommand> cmd( new MyCommand() );
+    cmd->c = '0';
+    transport.oneway( cmd );
+    CPPUNIT_ASSERT_EQUAL( 1LL, os.size() );
+    CPPUNIT_ASSERT_EQUAL( 1, counting.flushes.get() );
+
+    const int NUM_SENDERS = 4;
+    const int NUM_COMMANDS = 250;
+
+    std::vector< Pointer<BatchSender> > senders;
+    std::vector< Pointer<decaf::lang::Thread> > threads;
+
+    for( int i = 0; i < NUM_SENDERS; ++i ) {
+        senders.push_back( Pointer<BatchSender>( new BatchSender( &transport, (char)( 'a' + i ), NUM_COMMANDS ) ) );
+        threads.push_back( Pointer<decaf::lang::Thread>( new decaf::lang::Thread( senders.back().get() ) ) );
+    }
+
+    for( int i = 0; i < NUM_SENDERS; ++i ) {
+        threads[i]->start();
+    }
+
+    for( int i = 0; i < NUM_SENDERS; ++i ) {
+        threads[i]->join();
+    }
+
+    // Everything sent has to have been flushed by the time oneway returned.
+    std::string written = os.toString();
+    CPPUNIT_ASSERT_EQUAL( (std::size_t)( 1 + NUM_SENDERS * NUM_COMMANDS ), written.size() );
+
+    for( int i = 0; i < NUM_SENDERS; ++i ) {
+        CPPUNIT_ASSERT_EQUAL( (long)NUM_COMMANDS, (long)std::count( written.begin(), written.end(), (char)( 'a' + i ) ) );
+    }
+
+    transport.close();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void IOTransportTest::testWriteBatchingJoinsWaitingSenders(){
+
+    decaf::util::concurrent::CountDownLatch entered( 1 );
+    decaf::util::concurrent::CountDownLatch gate( 1 );
+
+    decaf::io::BlockingByteArrayInputStream is;
+    decaf::io::ByteArrayOutputStream os;
+    FlushCountingOutputStream counting( &os );
+    counting.entered = &entered;
+    counting.gate = &gate;
+    decaf::io::BufferedOutputStream bos( &counting );
+    decaf::io::DataInputStream input( &is );
+    decaf::io::DataOutputStream output( &bos );
+
+    Pointer<MyWireFormat> wireFormat( new MyWireFormat() );
+    MyTransportListener listener;
+    IOTransport transport;
+    transport.setInputStream( &input );
+    transport.setOutputStream( &output );
+    transport.setTransportListener( &listener );
+    transport.setWireFormat( wireFormat );
+    transport.setWriteBatchingEnabled( true );
+    // Long enough that the flushing sender always waits for the others to append.
+    transport.setWriteBatchMaxDelay( 10 * 1000 * 1000 );
+
+    transport.start();
+
+    const int NUM_WAITING = 3;
+
+    // The first sender stalls in its flush while holding the output stream.
+    BatchSender first( &transport, 'a', 1 );
+    decaf::lang::Thread firstThread( &first );
+    firstThread.start();
+    CPPUNIT_ASSERT( entered.await( 5000 ) );
+
+    std::vector< Pointer<BatchSender> > senders;
+    std::vector< Pointer<decaf::lang::Thread> > threads;
+
+    for( int i = 0; i < NUM_WAITING; ++i ) {
+        senders.push_back( Pointer<BatchSender>( new BatchSender( &transport, (char)( 'b' + i ), 1 ) ) );
+        threads.push_back( Pointer<decaf::lang::Thread>( new decaf::lang::Thread( senders.back().get() ) ) );
+        threads.back()->start();
+    }
+
+    // Each of them is blocked on the output stream once it has started appending.
+    for( int i = 0; i < NUM_WAITING; ++i ) {
+        for( int wait = 0; threads[i]->getState() != decaf::lang::Thread::BLOCKED && wait < 500; ++wait ) {
+            decaf::lang::Thread::sleep( 10 );
+        }
+        CPPUNIT_ASSERT_EQUAL( decaf::lang::Thread::BLOCKED, threads[i]->getState() );
+    }
+
+    gate.countDown();
+
+    firstThread.join();
+    for( int i = 0; i < NUM_WAITING; ++i ) {
+        threads[i]->join();
+    }
+
+    std::string written = os.toString();
+    CPPUNIT_ASSERT_EQUAL( (std::size_t)( 1 + NUM_WAITING ), written.size() );
+
+    // The waiting senders all go out in the one flush after the stalled one.
+    CPPUNIT_ASSERT_EQUAL( 2, counting.flushes.get() );
+    CPPUNIT_ASSERT( counting.flushes.get() < (int) written.size() );
+
+    transport.close();
+}
@@ -34,6 +34,8 @@ namespace transport{
         CPPUNIT_TEST( testWrite );
         CPPUNIT_TEST( testException );
         CPPUNIT_TEST( testNarrow );
+        CPPUNIT_TEST( testWriteBatching );
+        CPPUNIT_TEST( testWriteBatchingJoinsWaitingSenders );
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -46,6 +48,8 @@ namespace transport{
         void testStartClose();
         void testStressTransportStartClose();
         void testNarrow();
+        void testWriteBatching();
+        void testWriteBatchingJoinsWaitingSenders();
 
     };
 
@@ -20,7 +20,12 @@
 #include <activemq/transport/tcp/TcpTransportFactory.h>
 #include <activemq/transport/tcp/TcpTransport.h>
 
+#include <activemq/commands/ConnectionInfo.h>
+#include <activemq/transport/DefaultTransportListener.h>
+#include <activemq/transport/IOReactor.h>
+#include <activemq/transport/IOTransport.h>
 #include <activemq/wireformat/openwire/OpenWireFormat.h>
+#include <activemq/wireformat/openwire/OpenWireFormatFactory.h>
 
 #include <decaf/lang/Pointer.h>
 #include <decaf/lang/Integer.h>
@@ -29,8 +34,14 @@
 #include <decaf/net/ServerSocket.h>
 #include <decaf/io/InputStream.h>
 #include <decaf/io/OutputStream.h>
+#include <decaf/io/ByteArrayOutputStream.h>
+#include <decaf/io/DataOutputStream.h>
+#include <decaf/lang/ArrayPointer.h>
+#include <decaf/util/concurrent/atomic/AtomicInteger.h>
 #include <decaf/util/Random.h>
 
+#include <vector>
+
 using namespace decaf;
 using namespace decaf::lang;
 using namespace decaf::net;
@@ -38,6 +49,7 @@ using namespace decaf::io;
 using namespace decaf::util;
 using namespace decaf::util::concurrent;
 using namespace activemq;
+using namespace activemq::commands;
 using namespace activemq::wireformat;
 using namespace activemq::wireformat::openwire;
 using namespace activemq::transport;
@@ -139,6 +151,45 @@ namespace {
     };
 
     TestServer* server;
+
+    class CountingListener : public DefaultTransportListener {
+    public:
+
+        CountDownLatch received;
+        atomic::AtomicInteger errors;
+        std::string lastClientId;
+
+        CountingListener(int expected) : DefaultTransportListener(), received(expected), errors(), lastClientId() {}
+
+        virtual ~CountingListener() {}
+
+        virtual void onCommand(const Pointer<Command> command) {
+            Pointer<ConnectionInfo> info = command.dynamicCast<ConnectionInfo>();
+            if (info != NULL) {
+                lastClientId = info->getClientId();
+            }
+            received.countDown();
+        }
+
+        virtual void onException(const decaf::lang::Exception& ex AMQCPP_UNUSED) {
+            errors.incrementAndGet();
+        }
+    };
+
+    class BlockingListener : public CountingListener {
+    public:
+
+        CountDownLatch release;
+
+        BlockingListener() : CountingListener(1), release(1) {}
+
+        virtual ~BlockingListener() {}
+
+        virtual void onCommand(const Pointer<Command> command) {
+            CountingListener::onCommand(command);
+            release.await();
+        }
+    };
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -192,3 +243,136 @@ void TcpTransportTest::testTransportCreateWithRadomFailures() {
         } catch (Exception& ex) {}
     }
 }
+
+////////////////////////////////////////////////////////////////////////////////
+void TcpTransportTest::testReactorReadsSplitFrames() {
+
+    ServerSocket serverSocket(0);
+    URI connectUri("tcp://localhost:" + Integer::toString(serverSocket.getLocalPort()) +
+                   "?transport.useReactor=true&transport.useInactivityMonitor=false"
+                   "&wireFormat.tightEncodingEnabled=false");
+
+    TcpTransportFactory factory;
+    Pointer<Transport> transport = factory.createComposite(connectUri);
+
+    // The broker's WireFormatInfo followed by frames small and large enough to make
+    // the read buffer grow.
+    CountingListener listener(4);
+    transport->setTransportListener(&listener);
+    transport->start();
+
+    std::auto_ptr<Socket> peer(serverSocket.accept());
+
+    IOTransport* ioTransport = dynamic_cast<IOTransport*>(transport->narrow(typeid(IOTransport)));
+    CPPUNIT_ASSERT(ioTransport != NULL);
+    CPPUNIT_ASSERT(ioTransport->isUseReactor());
+    CPPUNIT_ASSERT(IOReactor::getInstance().getSocketCount() > 0);
+
+    Properties properties;
+    properties.setProperty("wireFormat.tightEncodingEnabled", "false");
+    Pointer<OpenWireFormat> wireFormat =
+        OpenWireFormatFactory().createWireFormat(properties).dynamicCast<OpenWireFormat>();
+
+    ByteArrayOutputStream baos;
+    DataOutputStream dataOut(&baos);
+    wireFormat->marshal(wireFormat->getPreferedWireFormatInfo(), transport.get(), &dataOut);
+
+    Pointer<ConnectionInfo> small(new ConnectionInfo());
+    small->setClientId("small");
+    wireFormat->marshal(small, transport.get(), &dataOut);
+
+    Pointer<ConnectionInfo> large(new ConnectionInfo());
+    large->setClientId(std::string(50000, 'a'));
+    large->setUserName(std::string(50000, 'b'));
+    wireFormat->marshal(large, transport.get(), &dataOut);
+
+    Pointer<ConnectionInfo> last(new ConnectionInfo());
+    last->setClientId("last");
+    wireFormat->marshal(last, transport.get(), &dataOut);
+
+    std::pair<unsigned char*, int> array = baos.toByteArray();
+    ArrayPointer<unsigned char> bytes(array.first, array.second);
+
+    // Written in pieces that split the size prefixes and the frames themselves.
+    OutputStream* out = peer->getOutputStream();
+    int chunks[] = { 1, 2, 7, 100, 20000 };
+    int offset = 0;
+    for (int i = 0; offset < array.second; ++i) {
+        int length = std::min(i < 5 ? chunks[i] : 4096, array.second - offset);
+        out->write(array.first, array.second, offset, length);
+        out->flush();
+        offset += length;
+        Thread::sleep(1);
+    }
+
+    CPPUNIT_ASSERT(listener.received.await(10000));
+    CPPUNIT_ASSERT_EQUAL(0, listener.errors.get());
+    CPPUNIT_ASSERT_EQUAL(std::string("last"), listener.lastClientId);
+
+    transport->close();
+    peer->close();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void TcpTransportTest::testReactorListenerMayBlock() {
+
+    ServerSocket serverSocket(0);
+    URI connectUri("tcp://localhost:" + Integer::toString(serverSocket.getLocalPort()) +
+                   "?transport.useReactor=true&transport.useInactivityMonitor=false");
+
+    // One transport more than there are loops, so at least two share a loop thread.
+    const int count = IOReactor::getInstance().getLoopCount() + 1;
+
+    TcpTransportFactory factory;
+    BlockingListener blocked;
+    std::vector< Pointer<CountingListener> > listeners;
+    std::vector< Pointer<Transport> > transports;
+    std::vector< Pointer<Socket> > peers;
+
+    for (int i = 0; i < count; ++i) {
+        Pointer<Transport> transport = factory.createComposite(connectUri);
+        if (i == 0) {
+            transport->setTransportListener(&blocked);
+        } else {
+            listeners.push_back(Pointer<CountingListener>(new CountingListener(1)));
+            transport->setTransportListener(listeners.back().get());
+        }
+        transport->start();
+        transports.push_back(transport);
+        peers.push_back(Pointer<Socket>(serverSocket.accept()));
+    }
+
+    Properties properties;
+    Pointer<OpenWireFormat> wireFormat =
+        OpenWireFormatFactory().createWireFormat(properties).dynamicCast<OpenWireFormat>();
+
+    ByteArrayOutputStream baos;
+    DataOutputStream dataOut(&baos);
+    wireFormat->marshal(wireFormat->getPreferedWireFormatInfo(), transports[0].get(), &dataOut);
+    std::pair<unsigned char*, int> array = baos.toByteArray();
+    ArrayPointer<unsigned char> bytes(array.first, array.second);
+
+    OutputStream* out = peers[0]->getOutputStream();
+    out->write(array.first, array.second, 0, array.second);
+    out->flush();
+    CPPUNIT_ASSERT(blocked.received.await(10000));
+
+    // The first listener is still blocked, the other transports get their commands.
+    for (int i = 1; i < count; ++i) {
+        out = peers[i]->getOutputStream();
+        out->write(array.first, array.second, 0, array.second);
+        out->flush();
+    }
+
+    for (std::size_t i = 0; i < listeners.size(); ++i) {
+        CPPUNIT_ASSERT(listeners[i]->received.await(10000));
+        CPPUNIT_ASSERT_EQUAL(0, listeners[i]->errors.get());
+    }
+
+    blocked.release.countDown();
+
+    for (int i = 0; i < count; ++i) {
+        transports[i]->close();
+        peers[i]->close();
+    }
+}
@@ -30,6 +30,8 @@ namespace tcp {
 
         CPPUNIT_TEST_SUITE( TcpTransportTest );
         CPPUNIT_TEST( testTransportCreateWithRadomFailures );
+        CPPUNIT_TEST( testReactorReadsSplitFrames );
+        CPPUNIT_TEST( testReactorListenerMayBlock );
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -41,6 +43,8 @@ namespace tcp {
         virtual void tearDown();
 
         void testTransportCreateWithRadomFailures();
+        void testReactorReadsSplitFrames();
+        void testReactorListenerMayBlock();
 
     };
 
@@ -0,0 +1,217 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ByteSequenceTest.h"
+
+#include <activemq/util/ByteSequence.h>
+
+#include <decaf/lang/exceptions/IndexOutOfBoundsException.h>
+#include <decaf/lang/exceptions/NullPointerException.h>
+
+using namespace std;
+using namespace activemq;
+using namespace activemq::util;
+using namespace decaf;
+using namespace decaf::lang;
+using namespace decaf::lang::exceptions;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    std::vector<unsigned char> createBytes(int size) {
+        std::vector<unsigned char> bytes(size);
+        for (int i = 0; i < size; ++i) {
+            bytes[i] = (unsigned char) i;
+        }
+        return bytes;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+ByteSequenceTest::ByteSequenceTest() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+ByteSequenceTest::~ByteSequenceTest() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ByteSequenceTest::testConstructor() {
+
+    ByteSequence empty;
+    CPPUNIT_ASSERT(empty.isEmpty());
+    CPPUNIT_ASSERT_EQUAL(0, empty.getLength());
+    CPPUNIT_ASSERT(empty.getData() == NULL);
+    CPPUNIT_ASSERT(empty.getArray().empty());
+
+    std::vector<unsigned char> bytes = createBytes(16);
+    ByteSequence fromArray(&bytes[0], (int) bytes.size());
+    CPPUNIT_ASSERT_EQUAL(16, fromArray.getLength());
+    CPPUNIT_ASSERT(fromArray.getData() != &bytes[0]);
+    CPPUNIT_ASSERT(fromArray.getArray() == bytes);
+
+    ByteSequence fromVector(bytes);
+    CPPUNIT_ASSERT_EQUAL(16, fromVector.getLength());
+    CPPUNIT_ASSERT(fromVector.toVector() == bytes);
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw a NullPointerException",
+        ByteSequence(NULL, 4),
+        NullPointerException);
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw an IndexOutOfBoundsException",
+        ByteSequence(&bytes[0], -1),
+        IndexOutOfBoundsException);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ByteSequenceTest::testAdopt() {
+
+    std::vector<unsigned char> bytes = createBytes(32);
+    const unsigned char* data = &bytes[0];
+
+    ByteSequence sequence = ByteSequence::adopt(bytes);
+
+    CPPUNIT_ASSERT(bytes.empty());
+    CPPUNIT_ASSERT_EQUAL(32, sequence.getLength());
+    CPPUNIT_ASSERT(sequence.getData() == data);
+    CPPUNIT_ASSERT(sequence.isWhole());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ByteSequenceTest::testCopyShares() {
+
+    std::vector<unsigned char> bytes = createBytes(64);
+    ByteSequence sequence = ByteSequence::adopt(bytes);
+    ByteSequence copy = sequence;
+
+    CPPUNIT_ASSERT(copy.isSharedWith(sequence));
+    CPPUNIT_ASSERT(copy.getData() == sequence.getData());
+
+    ByteSequence assigned;
+    assigned = copy;
+    CPPUNIT_ASSERT(assigned.isSharedWith(sequence));
+    CPPUNIT_ASSERT(!ByteSequence(createBytes(64)).isSharedWith(sequence));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ByteSequenceTest::testSlice() {
+
+    ByteSequence sequence(createBytes(100));
+
+    ByteSequence tail = sequence.slice(10);
+    CPPUNIT_ASSERT_EQUAL(90, tail.getLength());
+    CPPUNIT_ASSERT_EQUAL(10, tail.getOffset());
+    CPPUNIT_ASSERT_EQUAL((unsigned char) 10, tail.get(0));
+    CPPUNIT_ASSERT(tail.getData() == sequence.getData() + 10);
+    CPPUNIT_ASSERT(tail.isSharedWith(sequence));
+    CPPUNIT_ASSERT(!tail.isWhole());
+
+    ByteSequence middle = tail.slice(5, 20);
+    CPPUNIT_ASSERT_EQUAL(20, middle.getLength());
+    CPPUNIT_ASSERT_EQUAL(15, middle.getOffset());
+    CPPUNIT_ASSERT_EQUAL((unsigned char) 34, middle.get(19));
+    CPPUNIT_ASSERT(middle.isSharedWith(sequence));
+
+    ByteSequence whole = sequence.slice(0, 100);
+    CPPUNIT_ASSERT(whole.isWhole());
+    CPPUNIT_ASSERT(whole.isSharedWith(sequence));
+
+    ByteSequence empty = sequence.slice(100);
+    CPPUNIT_ASSERT(empty.isEmpty());
+    CPPUNIT_ASSERT(!empty.isSharedWith(sequence));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ByteSequenceTest::testSliceOutOfBounds() {
+
+    ByteSequence sequence(createBytes(10));
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw an IndexOutOfBoundsException",
+        sequence.slice(11),
+        IndexOutOfBoundsException);
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw an IndexOutOfBoundsException",
+        sequence.slice(-1),
+        IndexOutOfBoundsException);
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw an IndexOutOfBoundsException",
+        sequence.slice(5, 6),
+        IndexOutOfBoundsException);
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw an IndexOutOfBoundsException",
+        sequence.get(10),
+        IndexOutOfBoundsException);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ByteSequenceTest::testTrim() {
+
+    ByteSequence sequence(createBytes(50));
+
+    ByteSequence trimmed = sequence.trim();
+    CPPUNIT_ASSERT(trimmed.isSharedWith(sequence));
+
+    ByteSequence slice = sequence.slice(10, 10);
+    trimmed = slice.trim();
+    CPPUNIT_ASSERT(!trimmed.isSharedWith(sequence));
+    CPPUNIT_ASSERT(trimmed.isWhole());
+    CPPUNIT_ASSERT(trimmed.equals(slice));
+    CPPUNIT_ASSERT_EQUAL(10, (int) trimmed.getArray().size());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ByteSequenceTest::testDetach() {
+
+    ByteSequence sequence(createBytes(20));
+    ByteSequence copy = sequence;
+
+    std::vector<unsigned char>& bytes = copy.detach();
+    CPPUNIT_ASSERT(!copy.isSharedWith(sequence));
+
+    bytes[0] = 0xFF;
+    bytes.push_back(0x01);
+    CPPUNIT_ASSERT_EQUAL(21, copy.getLength());
+    CPPUNIT_ASSERT_EQUAL((unsigned char) 0xFF, copy.get(0));
+    CPPUNIT_ASSERT_EQUAL(20, sequence.getLength());
+    CPPUNIT_ASSERT_EQUAL((unsigned char) 0, sequence.get(0));
+
+    // No longer shared so a second detach hands back the same storage.
+    const unsigned char* data = copy.getData();
+    copy.detach();
+    CPPUNIT_ASSERT(copy.getData() == data);
+
+    ByteSequence empty;
+    empty.detach().push_back(0x02);
+    CPPUNIT_ASSERT_EQUAL(1, empty.getLength());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ByteSequenceTest::testEquals() {
+
+    ByteSequence sequence(createBytes(30));
+
+    CPPUNIT_ASSERT(sequence.equals(ByteSequence(createBytes(30))));
+    CPPUNIT_ASSERT(!sequence.equals(ByteSequence(createBytes(29))));
+    CPPUNIT_ASSERT(sequence.slice(0, 10) == ByteSequence(createBytes(10)));
+    CPPUNIT_ASSERT(ByteSequence() == sequence.slice(30));
+}
@@ -0,0 +1,195 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "CompressionContextPoolTest.h"
+
+#include <activemq/util/CompressionContextPool.h>
+
+#include <decaf/io/ByteArrayInputStream.h>
+#include <decaf/io/ByteArrayOutputStream.h>
+#include <decaf/lang/Integer.h>
+#include <decaf/util/zip/DataFormatException.h>
+#include <decaf/util/zip/DeflaterOutputStream.h>
+#include <decaf/util/zip/InflaterInputStream.h>
+
+using namespace std;
+using namespace activemq;
+using namespace activemq::util;
+using namespace decaf::io;
+using namespace decaf::util::zip;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    std::vector<unsigned char> createData(int size) {
+        std::vector<unsigned char> data(size);
+        for (int i = 0; i < size; ++i) {
+            data[i] = (unsigned char) ((i % 61) + (i / 977));
+        }
+        return data;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CompressionContextPoolTest::testRoundTrip() {
+
+    CompressionContextPool pool;
+    std::vector<unsigned char> data = createData(200000);
+
+    std::vector<unsigned char> deflated;
+    pool.deflate(&data[0], (int) data.size(), -1, deflated);
+    CPPUNIT_ASSERT(!deflated.empty());
+    CPPUNIT_ASSERT(deflated.size() < data.size());
+
+    std::vector<unsigned char> inflated;
+    pool.inflate(&deflated[0], (int) deflated.size(), inflated);
+    CPPUNIT_ASSERT(data == inflated);
+
+    // Output grown from nothing must come out the same as into a reserved vector.
+    std::vector<unsigned char> reserved;
+    reserved.reserve(data.size());
+    pool.inflate(&deflated[0], (int) deflated.size(), reserved);
+    CPPUNIT_ASSERT(data == reserved);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CompressionContextPoolTest::testReuseAcrossLevels() {
+
+    CompressionContextPool pool(1);
+    std::vector<unsigned char> data = createData(50000);
+
+    // The same context is handed out every time, its level and input must be reset.
+    for (int level = -1; level <= 9; ++level) {
+
+        std::vector<unsigned char> deflated;
+        pool.deflate(&data[0], (int) data.size(), level, deflated);
+
+        std::vector<unsigned char> inflated;
+        pool.inflate(&deflated[0], (int) deflated.size(), inflated);
+        CPPUNIT_ASSERT_MESSAGE("Failed at level " + decaf::lang::Integer::toString(level), data == inflated);
+    }
+
+    std::vector<unsigned char> none = createData(1);
+    std::vector<unsigned char> deflated;
+    pool.deflate(&none[0], 1, 9, deflated);
+
+    std::vector<unsigned char> inflated;
+    pool.inflate(&deflated[0], (int) deflated.size(), inflated);
+    CPPUNIT_ASSERT(none == inflated);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CompressionContextPoolTest::testOutputIsAppended() {
+
+    CompressionContextPool pool;
+    std::vector<unsigned char> data = createData(1000);
+
+    std::vector<unsigned char> deflated(4, 0xAA);
+    pool.deflate(&data[0], (int) data.size(), 6, deflated);
+    CPPUNIT_ASSERT(deflated.size() > 4);
+    CPPUNIT_ASSERT_EQUAL((unsigned char) 0xAA, deflated[3]);
+
+    std::vector<unsigned char> inflated(2, 0x55);
+    pool.inflate(&deflated[4], (int) deflated.size() - 4, inflated);
+    CPPUNIT_ASSERT_EQUAL(data.size() + 2, inflated.size());
+    CPPUNIT_ASSERT_EQUAL((unsigned char) 0x55, inflated[1]);
+    CPPUNIT_ASSERT(std::equal(data.begin(), data.end(), inflated.begin() + 2));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CompressionContextPoolTest::testStreamCompatibility() {
+
+    CompressionContextPool pool;
+    std::vector<unsigned char> data = createData(30000);
+
+    // What the streams write the pool must read.
+    ByteArrayOutputStream bytesOut;
+    DeflaterOutputStream deflaterOut(&bytesOut);
+    deflaterOut.write(&data[0], (int) data.size());
+    deflaterOut.close();
+
+    std::pair<unsigned char*, int> array = bytesOut.toByteArray();
+    std::vector<unsigned char> streamed(array.first, array.first + array.second);
+    delete[] array.first;
+
+    std::vector<unsigned char> inflated;
+    pool.inflate(&streamed[0], (int) streamed.size(), inflated);
+    CPPUNIT_ASSERT(data == inflated);
+
+    // And what the pool writes the streams must read.
+    std::vector<unsigned char> deflated;
+    pool.deflate(&data[0], (int) data.size(), -1, deflated);
+
+    ByteArrayInputStream bytesIn(deflated);
+    InflaterInputStream inflaterIn(&bytesIn);
+    std::vector<unsigned char> read(data.size());
+    int total = 0;
+    while (total < (int) read.size()) {
+        int count = inflaterIn.read(&read[0], (int) read.size(), total, (int) read.size() - total);
+        CPPUNIT_ASSERT(count > 0);
+        total += count;
+    }
+
+    CPPUNIT_ASSERT(data == read);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CompressionContextPoolTest::testNoIdleContexts() {
+
+    CompressionContextPool pool(0);
+    CPPUNIT_ASSERT_EQUAL(0, pool.getMaxIdle());
+
+    std::vector<unsigned char> data = createData(5000);
+
+    for (int i = 0; i < 3; ++i) {
+        std::vector<unsigned char> deflated;
+        pool.deflate(&data[0], (int) data.size(), -1, deflated);
+
+        std::vector<unsigned char> inflated;
+        pool.inflate(&deflated[0], (int) deflated.size(), inflated);
+        CPPUNIT_ASSERT(data == inflated);
+    }
+
+    CPPUNIT_ASSERT_EQUAL(CompressionContextPool::DEFAULT_MAX_IDLE, CompressionContextPool().getMaxIdle());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void CompressionContextPoolTest::testCorruptData() {
+
+    CompressionContextPool pool(1);
+    std::vector<unsigned char> data = createData(5000);
+
+    std::vector<unsigned char> deflated;
+    pool.deflate(&data[0], (int) data.size(), -1, deflated);
+
+    std::vector<unsigned char> out;
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should Throw a DataFormatException",
+        pool.inflate(&deflated[0], (int) deflated.size() / 2, out),
+        DataFormatException);
+
+    std::vector<unsigned char> garbage(64, 0x7F);
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should Throw a DataFormatException",
+        pool.inflate(&garbage[0], (int) garbage.size(), out),
+        DataFormatException);
+
+    // A context that failed must not be handed out again in a bad state.
+    std::vector<unsigned char> inflated;
+    pool.inflate(&deflated[0], (int) deflated.size(), inflated);
+    CPPUNIT_ASSERT(data == inflated);
+}
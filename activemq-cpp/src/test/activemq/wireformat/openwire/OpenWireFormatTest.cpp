@@ -20,6 +20,18 @@
 #include <decaf/util/Properties.h>
 #include <activemq/wireformat/openwire/OpenWireFormatFactory.h>
 #include <activemq/wireformat/openwire/OpenWireFormat.h>
+#include <activemq/wireformat/openwire/utils/BooleanStream.h>
+#include <activemq/commands/ProducerInfo.h>
+#include <activemq/commands/ActiveMQQueue.h>
+#include <activemq/commands/ConnectionInfo.h>
+#include <activemq/transport/mock/MockTransport.h>
+#include <decaf/io/ByteArrayOutputStream.h>
+#include <decaf/io/ByteArrayInputStream.h>
+#include <decaf/io/DataOutputStream.h>
+#include <decaf/io/DataInputStream.h>
+#include <decaf/lang/ArrayPointer.h>
+
+#include <cstring>
 
 #include <activemq/core/ActiveMQConnectionMetaData.h>
 
@@ -27,12 +39,32 @@ using namespace std;
 using namespace activemq;
 using namespace activemq::util;
 using namespace activemq::core;
+using namespace activemq::commands;
+using namespace activemq::transport;
+using namespace activemq::transport::mock;
 using namespace decaf::io;
 using namespace decaf::lang;
 using namespace decaf::util;
 using namespace activemq::exceptions;
 using namespace activemq::wireformat;
 using namespace activemq::wireformat::openwire;
+using namespace activemq::wireformat::openwire::utils;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    Pointer<ProducerInfo> createProducerInfo() {
+        Pointer<ProducerId> producerId(new ProducerId());
+        producerId->setConnectionId("ID:test-connection:1");
+        producerId->setSessionId(1);
+        producerId->setValue(1);
+
+        Pointer<ProducerInfo> info(new ProducerInfo());
+        info->setProducerId(producerId);
+        info->setDestination(Pointer<ActiveMQDestination>(new ActiveMQQueue("TEST.QUEUE")));
+        return info;
+    }
+}
 
 ////////////////////////////////////////////////////////////////////////////////
 void OpenWireFormatTest::testProviderInfoInWireFormat() {
@@ -50,3 +82,273 @@ void OpenWireFormatTest::testProviderInfoInWireFormat() {
             myWireFormat->getPreferedWireFormatInfo()->getProperties().getString("ProviderVersion"));
     CPPUNIT_ASSERT(!myWireFormat->getPreferedWireFormatInfo()->getProperties().getString("PlatformDetails").empty());
 }
+
+////////////////////////////////////////////////////////////////////////////////
+void OpenWireFormatTest::testTightMarshalWithCache() {
+
+    Properties properties;
+    OpenWireFormat sender(properties);
+    OpenWireFormat receiver(properties);
+    sender.setCacheEnabled(true);
+    receiver.setCacheEnabled(true);
+
+    Pointer<ProducerInfo> info = createProducerInfo();
+
+    ByteArrayOutputStream baos;
+    DataOutputStream dataOut(&baos);
+    int sizes[2];
+
+    for (int i = 0; i < 2; ++i) {
+        int before = (int) baos.size();
+        BooleanStream bs;
+        sender.tightMarshalNestedObject1(info.get(), &bs);
+        bs.marshal(&dataOut);
+        sender.tightMarshalNestedObject2(info.get(), &dataOut, &bs);
+        sizes[i] = (int) baos.size() - before;
+    }
+
+    // Second time around only the cache indices are written.
+    CPPUNIT_ASSERT(sizes[1] < sizes[0]);
+    CPPUNIT_ASSERT_EQUAL(2LL, sender.getMarshalCache().getMarshalHits());
+    CPPUNIT_ASSERT_EQUAL(2LL, sender.getMarshalCache().getMarshalMisses());
+
+    std::pair<unsigned char*, int> array = baos.toByteArray();
+    ByteArrayInputStream bais(array.first, array.second, true);
+    DataInputStream dataIn(&bais);
+
+    for (int i = 0; i < 2; ++i) {
+        BooleanStream bs;
+        bs.unmarshal(&dataIn);
+        Pointer<ProducerInfo> result(dynamic_cast<ProducerInfo*>(receiver.tightUnmarshalNestedObject(&dataIn, &bs)));
+        CPPUNIT_ASSERT(result != NULL);
+        CPPUNIT_ASSERT(info->getProducerId()->equals(result->getProducerId().get()));
+        CPPUNIT_ASSERT(info->getDestination()->equals(result->getDestination().get()));
+    }
+
+    CPPUNIT_ASSERT_EQUAL(2LL, receiver.getMarshalCache().getUnmarshalHits());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void OpenWireFormatTest::testLooseMarshalWithCache() {
+
+    Properties properties;
+    OpenWireFormat sender(properties);
+    OpenWireFormat receiver(properties);
+    sender.setCacheEnabled(true);
+    receiver.setCacheEnabled(true);
+
+    Pointer<ProducerInfo> info = createProducerInfo();
+
+    ByteArrayOutputStream baos;
+    DataOutputStream dataOut(&baos);
+    int sizes[2];
+
+    for (int i = 0; i < 2; ++i) {
+        int before = (int) baos.size();
+        sender.looseMarshalNestedObject(info.get(), &dataOut);
+        sizes[i] = (int) baos.size() - before;
+    }
+
+    CPPUNIT_ASSERT(sizes[1] < sizes[0]);
+
+    std::pair<unsigned char*, int> array = baos.toByteArray();
+    ByteArrayInputStream bais(array.first, array.second, true);
+    DataInputStream dataIn(&bais);
+
+    for (int i = 0; i < 2; ++i) {
+        Pointer<ProducerInfo> result(dynamic_cast<ProducerInfo*>(receiver.looseUnmarshalNestedObject(&dataIn)));
+        CPPUNIT_ASSERT(result != NULL);
+        CPPUNIT_ASSERT(info->getProducerId()->equals(result->getProducerId().get()));
+        CPPUNIT_ASSERT(info->getDestination()->equals(result->getDestination().get()));
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void OpenWireFormatTest::testLooseMarshalSizePrefix() {
+
+    Properties properties;
+    Pointer<OpenWireFormat> wireFormat(new OpenWireFormat(properties));
+    MockTransport transport(wireFormat, Pointer<ResponseBuilder>());
+
+    CPPUNIT_ASSERT(!wireFormat->isTightEncodingEnabled());
+    CPPUNIT_ASSERT(!wireFormat->isSizePrefixDisabled());
+
+    // Large enough to force the scratch buffer to grow past what it retains, followed
+    // by smaller frames written after it has been released.  Strings are limited to
+    // 64k so the size is split over two of them.
+    Pointer<ConnectionInfo> large(new ConnectionInfo());
+    large->setClientId(std::string(50000, 'a'));
+    large->setUserName(std::string(50000, 'b'));
+    Pointer<ConnectionInfo> small(new ConnectionInfo());
+    small->setClientId("small");
+
+    ByteArrayOutputStream baos;
+    DataOutputStream dataOut(&baos);
+
+    wireFormat->marshal(large, &transport, &dataOut);
+    wireFormat->marshal(small, &transport, &dataOut);
+    wireFormat->marshal(createProducerInfo(), &transport, &dataOut);
+
+    std::pair<unsigned char*, int> array = baos.toByteArray();
+    ByteArrayInputStream bais(array.first, array.second, true);
+    DataInputStream dataIn(&bais);
+
+    // Each frame's size prefix must match the bytes that follow it.
+    int total = 0;
+    for (int i = 0; i < 3; ++i) {
+        int size = dataIn.readInt();
+        CPPUNIT_ASSERT(size > 0);
+        dataIn.skip(size);
+        total += size + 4;
+    }
+    CPPUNIT_ASSERT_EQUAL(array.second, total);
+
+    bais.reset();
+
+    Pointer<ConnectionInfo> result = wireFormat->unmarshal(&transport, &dataIn).dynamicCast<ConnectionInfo>();
+    CPPUNIT_ASSERT_EQUAL(large->getClientId(), result->getClientId());
+    CPPUNIT_ASSERT_EQUAL(large->getUserName(), result->getUserName());
+    result = wireFormat->unmarshal(&transport, &dataIn).dynamicCast<ConnectionInfo>();
+    CPPUNIT_ASSERT_EQUAL(small->getClientId(), result->getClientId());
+    Pointer<ProducerInfo> info = wireFormat->unmarshal(&transport, &dataIn).dynamicCast<ProducerInfo>();
+    CPPUNIT_ASSERT(createProducerInfo()->getProducerId()->equals(info->getProducerId().get()));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void OpenWireFormatTest::testTightMarshalPlanWithCache() {
+
+    Properties properties;
+    Pointer<OpenWireFormat> sender(new OpenWireFormat(properties));
+    Pointer<OpenWireFormat> receiver(new OpenWireFormat(properties));
+    MockTransport transport(sender, Pointer<ResponseBuilder>());
+
+    sender->setTightEncodingEnabled(true);
+    sender->setCacheEnabled(true);
+    receiver->setTightEncodingEnabled(true);
+    receiver->setCacheEnabled(true);
+
+    ByteArrayOutputStream baos;
+    DataOutputStream dataOut(&baos);
+
+    // The reused boolean stream and planned cache indices must not carry
+    // anything over from one command to the next.
+    for (int i = 0; i < 3; ++i) {
+        sender->marshal(createProducerInfo(), &transport, &dataOut);
+        Pointer<ConnectionInfo> info(new ConnectionInfo());
+        info->setClientId("client");
+        sender->marshal(info, &transport, &dataOut);
+    }
+
+    std::pair<unsigned char*, int> array = baos.toByteArray();
+    ByteArrayInputStream bais(array.first, array.second, true);
+    DataInputStream dataIn(&bais);
+
+    for (int i = 0; i < 3; ++i) {
+        Pointer<ProducerInfo> producer = receiver->unmarshal(&transport, &dataIn).dynamicCast<ProducerInfo>();
+        CPPUNIT_ASSERT(createProducerInfo()->getProducerId()->equals(producer->getProducerId().get()));
+        CPPUNIT_ASSERT(createProducerInfo()->getDestination()->equals(producer->getDestination().get()));
+        Pointer<ConnectionInfo> connection = receiver->unmarshal(&transport, &dataIn).dynamicCast<ConnectionInfo>();
+        CPPUNIT_ASSERT_EQUAL(std::string("client"), connection->getClientId());
+    }
+
+    CPPUNIT_ASSERT(sender->getMarshalCache().getMarshalHits() > 0);
+    CPPUNIT_ASSERT_EQUAL(sender->getMarshalCache().getMarshalHits(), receiver->getMarshalCache().getUnmarshalHits());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void OpenWireFormatTest::testGetFrameLength() {
+
+    Properties properties;
+    Pointer<OpenWireFormat> wireFormat(new OpenWireFormat(properties));
+    MockTransport transport(wireFormat, Pointer<ResponseBuilder>());
+
+    ByteArrayOutputStream baos;
+    DataOutputStream dataOut(&baos);
+
+    wireFormat->marshal(createProducerInfo(), &transport, &dataOut);
+    int first = baos.size();
+    wireFormat->marshal(createProducerInfo(), &transport, &dataOut);
+
+    std::pair<unsigned char*, int> array = baos.toByteArray();
+    ArrayPointer<unsigned char> bytes(array.first, array.second);
+
+    // Too short to hold the size, then long enough to measure but not the whole frame.
+    CPPUNIT_ASSERT_EQUAL(0, wireFormat->getFrameLength(NULL, 0));
+    CPPUNIT_ASSERT_EQUAL(0, wireFormat->getFrameLength(array.first, 3));
+    CPPUNIT_ASSERT_EQUAL(first, wireFormat->getFrameLength(array.first, 4));
+    CPPUNIT_ASSERT_EQUAL(first, wireFormat->getFrameLength(array.first, array.second));
+    CPPUNIT_ASSERT_EQUAL(array.second - first,
+                         wireFormat->getFrameLength(array.first + first, array.second - first));
+
+    unsigned char invalid[] = { 0x80, 0x00, 0x00, 0x01 };
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw an IOException for a negative frame size",
+        wireFormat->getFrameLength(invalid, 4),
+        decaf::io::IOException);
+
+    wireFormat->setSizePrefixDisabled(true);
+    CPPUNIT_ASSERT_EQUAL(-1, wireFormat->getFrameLength(array.first, array.second));
+    CPPUNIT_ASSERT(!wireFormat->hasFrameLength());
+
+    // Before negotiation the frames are still prefixed, but a preferred format without
+    // the prefix means the negotiated one will not have it either.
+    OpenWireFormatFactory factory;
+    Properties prefixed;
+    CPPUNIT_ASSERT(factory.createWireFormat(prefixed)->hasFrameLength());
+
+    Properties unprefixed;
+    unprefixed.setProperty("wireFormat.sizePrefixDisabled", "true");
+    Pointer<WireFormat> unprefixedFormat = factory.createWireFormat(unprefixed);
+    CPPUNIT_ASSERT_EQUAL(0, unprefixedFormat->getFrameLength(NULL, 0));
+    CPPUNIT_ASSERT(!unprefixedFormat->hasFrameLength());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void OpenWireFormatTest::testTightMarshalPlanWithoutCache() {
+
+    Properties properties;
+    Pointer<OpenWireFormat> wireFormat(new OpenWireFormat(properties));
+    MockTransport transport(wireFormat, Pointer<ResponseBuilder>());
+
+    wireFormat->setTightEncodingEnabled(true);
+    wireFormat->setCacheEnabled(false);
+
+    // The planned marshallers of one command must not be replayed for the next, so
+    // marshal commands with different nested objects in turn.
+    ByteArrayOutputStream first;
+    DataOutputStream firstOut(&first);
+    wireFormat->marshal(createProducerInfo(), &transport, &firstOut);
+
+    ByteArrayOutputStream baos;
+    DataOutputStream dataOut(&baos);
+
+    for (int i = 0; i < 3; ++i) {
+        Pointer<ConnectionInfo> info(new ConnectionInfo());
+        info->setClientId("client");
+        info->setConnectionId(Pointer<ConnectionId>(new ConnectionId(createProducerInfo()->getProducerId().get())));
+        wireFormat->marshal(info, &transport, &dataOut);
+        wireFormat->marshal(createProducerInfo(), &transport, &dataOut);
+    }
+
+    std::pair<unsigned char*, int> array = baos.toByteArray();
+    ByteArrayInputStream bais(array.first, array.second, true);
+    DataInputStream dataIn(&bais);
+
+    for (int i = 0; i < 3; ++i) {
+        Pointer<ConnectionInfo> connection = wireFormat->unmarshal(&transport, &dataIn).dynamicCast<ConnectionInfo>();
+        CPPUNIT_ASSERT_EQUAL(std::string("client"), connection->getClientId());
+        CPPUNIT_ASSERT_EQUAL(std::string("ID:test-connection:1"), connection->getConnectionId()->getValue());
+        Pointer<ProducerInfo> producer = wireFormat->unmarshal(&transport, &dataIn).dynamicCast<ProducerInfo>();
+        CPPUNIT_ASSERT(createProducerInfo()->getProducerId()->equals(producer->getProducerId().get()));
+        CPPUNIT_ASSERT(createProducerInfo()->getDestination()->equals(producer->getDestination().get()));
+    }
+
+    // Replaying the plan writes the same bytes as a command marshaled on its own.
+    ByteArrayOutputStream again;
+    DataOutputStream againOut(&again);
+    wireFormat->marshal(createProducerInfo(), &transport, &againOut);
+    CPPUNIT_ASSERT_EQUAL(first.size(), again.size());
+    ArrayPointer<unsigned char> expected(first.toByteArray().first, (int) first.size());
+    ArrayPointer<unsigned char> actual(again.toByteArray().first, (int) again.size());
+    CPPUNIT_ASSERT_EQUAL(0, std::memcmp(expected.get(), actual.get(), (size_t) first.size()));
+}
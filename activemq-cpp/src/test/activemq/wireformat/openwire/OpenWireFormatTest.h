@@ -29,6 +29,12 @@ namespace openwire {
 
         CPPUNIT_TEST_SUITE( OpenWireFormatTest );
         CPPUNIT_TEST( testProviderInfoInWireFormat );
+        CPPUNIT_TEST( testTightMarshalWithCache );
+        CPPUNIT_TEST( testLooseMarshalWithCache );
+        CPPUNIT_TEST( testLooseMarshalSizePrefix );
+        CPPUNIT_TEST( testTightMarshalPlanWithCache );
+        CPPUNIT_TEST( testTightMarshalPlanWithoutCache );
+        CPPUNIT_TEST( testGetFrameLength );
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -37,6 +43,12 @@ namespace openwire {
         virtual ~OpenWireFormatTest() {}
 
         virtual void testProviderInfoInWireFormat();
+        virtual void testTightMarshalWithCache();
+        virtual void testLooseMarshalWithCache();
+        virtual void testLooseMarshalSizePrefix();
+        virtual void testTightMarshalPlanWithCache();
+        virtual void testTightMarshalPlanWithoutCache();
+        virtual void testGetFrameLength();
 
     };
 
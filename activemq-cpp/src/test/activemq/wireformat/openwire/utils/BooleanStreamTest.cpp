@@ -99,3 +99,44 @@ void BooleanStreamTest::test2(){
 
     delete [] array.first;
 }
+
+////////////////////////////////////////////////////////////////////////////////
+void BooleanStreamTest::testReset(){
+
+    BooleanStream b1Stream;
+
+    io::ByteArrayOutputStream baoStream;
+    io::DataOutputStream daoStream( &baoStream );
+
+    for( int i = 0; i < 20; i++ ) {
+        b1Stream.writeBoolean( true );
+    }
+
+    b1Stream.marshal( &daoStream );
+    CPPUNIT_ASSERT_EQUAL( 4, b1Stream.marshalledSize() );
+
+    // Nothing from the first pass should leak into the second one.
+    b1Stream.reset();
+    CPPUNIT_ASSERT_EQUAL( 1, b1Stream.marshalledSize() );
+
+    for( int i = 0; i < 10; i++ ) {
+        b1Stream.writeBoolean( false );
+    }
+
+    baoStream.reset();
+    b1Stream.marshal( &daoStream );
+    CPPUNIT_ASSERT_EQUAL( 3, b1Stream.marshalledSize() );
+
+    BooleanStream b2Stream;
+    std::pair<const unsigned char*, int> array = baoStream.toByteArray();
+    decaf::io::ByteArrayInputStream baiStream( array.first, array.second );
+    io::DataInputStream daiStream( &baiStream );
+
+    b2Stream.unmarshal( &daiStream );
+
+    for( int i = 0; i < 10; i++ ) {
+        CPPUNIT_ASSERT( b2Stream.readBoolean() == false );
+    }
+
+    delete [] array.first;
+}
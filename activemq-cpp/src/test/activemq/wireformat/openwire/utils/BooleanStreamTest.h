@@ -31,6 +31,7 @@ namespace utils{
         CPPUNIT_TEST_SUITE( BooleanStreamTest );
         CPPUNIT_TEST( test );
         CPPUNIT_TEST( test2 );
+        CPPUNIT_TEST( testReset );
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -40,6 +41,7 @@ namespace utils{
 
         void test();
         void test2();
+        void testReset();
     };
 
 }}}}
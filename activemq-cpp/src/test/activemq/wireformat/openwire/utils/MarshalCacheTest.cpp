@@ -0,0 +1,232 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MarshalCacheTest.h"
+
+#include <activemq/wireformat/openwire/utils/MarshalCache.h>
+#include <activemq/commands/ProducerId.h>
+#include <activemq/commands/ActiveMQQueue.h>
+#include <activemq/commands/ActiveMQTopic.h>
+#include <activemq/commands/ActiveMQTempQueue.h>
+#include <activemq/commands/BrokerId.h>
+#include <activemq/commands/ConnectionId.h>
+#include <activemq/commands/ConsumerId.h>
+#include <activemq/commands/LocalTransactionId.h>
+#include <activemq/commands/SessionId.h>
+#include <decaf/io/IOException.h>
+#include <decaf/lang/Pointer.h>
+
+using namespace activemq;
+using namespace activemq::commands;
+using namespace activemq::wireformat;
+using namespace activemq::wireformat::openwire;
+using namespace activemq::wireformat::openwire::utils;
+using namespace decaf::io;
+using namespace decaf::lang;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    ProducerId createProducerId(long long value) {
+        ProducerId id;
+        id.setConnectionId("ID:test-connection:1");
+        id.setSessionId(1);
+        id.setValue(value);
+        return id;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MarshalCacheTest::testCacheSizeLimits() {
+
+    MarshalCache cache(1024);
+    CPPUNIT_ASSERT_EQUAL(1024, cache.getCacheSize());
+
+    cache.setCacheSize(1);
+    CPPUNIT_ASSERT_EQUAL(MarshalCache::MIN_CACHE_SIZE, cache.getCacheSize());
+
+    cache.setCacheSize(MarshalCache::MAX_CACHE_SIZE + 100);
+    CPPUNIT_ASSERT_EQUAL(MarshalCache::MAX_CACHE_SIZE, cache.getCacheSize());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MarshalCacheTest::testMarshalLookupByValue() {
+
+    MarshalCache cache(64);
+
+    ProducerId id1 = createProducerId(1);
+    ProducerId copy = createProducerId(1);
+    ProducerId id2 = createProducerId(2);
+
+    CPPUNIT_ASSERT_EQUAL((short) -1, cache.getMarshalCacheIndex(&id1));
+    short index = cache.addToMarshalCache(&id1);
+    CPPUNIT_ASSERT(index >= 0);
+
+    // A distinct instance with the same value finds the same entry.
+    CPPUNIT_ASSERT_EQUAL(index, cache.getMarshalCacheIndex(&copy));
+    CPPUNIT_ASSERT_EQUAL(index, cache.peekMarshalCacheIndex(&copy));
+    CPPUNIT_ASSERT_EQUAL((short) -1, cache.getMarshalCacheIndex(&id2));
+
+    // Destinations of different types with the same name are distinct entries.
+    ActiveMQQueue queue("TEST");
+    ActiveMQTopic topic("TEST");
+    short queueIndex = cache.addToMarshalCache(&queue);
+    CPPUNIT_ASSERT_EQUAL((short) -1, cache.getMarshalCacheIndex(&topic));
+    CPPUNIT_ASSERT_EQUAL(queueIndex, cache.getMarshalCacheIndex(&queue));
+
+    CPPUNIT_ASSERT_EQUAL(2LL, cache.getMarshalHits());
+    CPPUNIT_ASSERT_EQUAL(3LL, cache.getMarshalMisses());
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.4, cache.getMarshalHitRatio(), 0.0001);
+
+    cache.clear();
+    CPPUNIT_ASSERT_EQUAL((short) -1, cache.peekMarshalCacheIndex(&id1));
+
+    // An object held by a Pointer is kept by reference instead of copied.
+    Pointer<DataStructure> shared(createProducerId(3).cloneDataStructure());
+    CPPUNIT_ASSERT(cache.addToMarshalCache(shared.get()) >= 0);
+    CPPUNIT_ASSERT_EQUAL(2, shared->getReferenceCount());
+
+    cache.clear();
+    CPPUNIT_ASSERT_EQUAL(1, shared->getReferenceCount());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MarshalCacheTest::testMarshalLookupOfCacheableTypes() {
+
+    MarshalCache cache(64);
+
+    ConsumerId consumerId;
+    consumerId.setConnectionId("ID:test-connection:1");
+    consumerId.setSessionId(1);
+    consumerId.setValue(1);
+
+    SessionId sessionId;
+    sessionId.setConnectionId("ID:test-connection:1");
+    sessionId.setValue(1);
+
+    ConnectionId connectionId;
+    connectionId.setValue("ID:test-connection:1");
+
+    BrokerId brokerId;
+    brokerId.setValue("ID:test-broker:1");
+
+    LocalTransactionId transactionId;
+    transactionId.setConnectionId(Pointer<ConnectionId>(connectionId.cloneDataStructure()));
+    transactionId.setValue(1);
+
+    ActiveMQTempQueue tempQueue("ID:test-connection:1:1");
+
+    const DataStructure* objects[] = {
+        &consumerId, &sessionId, &connectionId, &brokerId, &transactionId, &tempQueue
+    };
+    const int count = (int) (sizeof(objects) / sizeof(objects[0]));
+
+    short indices[count];
+    for (int i = 0; i < count; ++i) {
+        indices[i] = cache.addToMarshalCache(objects[i]);
+    }
+
+    // Each type is keyed by its own hash code, so a copy finds the same entry.
+    for (int i = 0; i < count; ++i) {
+        Pointer<DataStructure> copy(objects[i]->cloneDataStructure());
+        CPPUNIT_ASSERT_EQUAL(indices[i], cache.getMarshalCacheIndex(copy.get()));
+    }
+
+    CPPUNIT_ASSERT_EQUAL((long long) count, cache.getMarshalHits());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MarshalCacheTest::testLRUEviction() {
+
+    MarshalCache cache(MarshalCache::MIN_CACHE_SIZE);
+    const int size = cache.getCacheSize();
+
+    for (int i = 0; i < size; ++i) {
+        ProducerId id = createProducerId(i);
+        CPPUNIT_ASSERT_EQUAL((short) i, cache.addToMarshalCache(&id));
+    }
+
+    // Touch the eldest so the second entry becomes the eviction candidate.
+    ProducerId first = createProducerId(0);
+    CPPUNIT_ASSERT_EQUAL((short) 0, cache.getMarshalCacheIndex(&first));
+
+    ProducerId next = createProducerId(size);
+    CPPUNIT_ASSERT_EQUAL((short) 1, cache.addToMarshalCache(&next));
+    CPPUNIT_ASSERT_EQUAL(1LL, cache.getMarshalEvictions());
+
+    ProducerId evicted = createProducerId(1);
+    CPPUNIT_ASSERT_EQUAL((short) -1, cache.peekMarshalCacheIndex(&evicted));
+    CPPUNIT_ASSERT_EQUAL((short) 0, cache.peekMarshalCacheIndex(&first));
+    CPPUNIT_ASSERT_EQUAL((short) 1, cache.peekMarshalCacheIndex(&next));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MarshalCacheTest::testNullNotCached() {
+
+    MarshalCache cache(64);
+
+    CPPUNIT_ASSERT_EQUAL((short) -1, cache.getMarshalCacheIndex(NULL));
+    CPPUNIT_ASSERT_EQUAL((short) -1, cache.addToMarshalCache(NULL));
+    CPPUNIT_ASSERT_EQUAL(0LL, cache.getMarshalMisses());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MarshalCacheTest::testUnmarshalCache() {
+
+    MarshalCache cache(64);
+
+    Pointer<DataStructure> id(createProducerId(42).cloneDataStructure());
+
+    // The remote end may use indices beyond our own marshal table size.
+    cache.setInUnmarshalCache(1000, id);
+    cache.setInUnmarshalCache(-1, id);
+
+    // Hits hand out the cached instance itself, the count in it is shared.
+    Pointer<DataStructure> cached(cache.getFromUnmarshalCache(1000));
+    CPPUNIT_ASSERT(cached.get() == id.get());
+    CPPUNIT_ASSERT_EQUAL(3, id->getReferenceCount());
+
+    Pointer<ProducerId> producerId(dynamic_cast<ProducerId*>(cache.getFromUnmarshalCache(1000).release()));
+    CPPUNIT_ASSERT(producerId.get() == id.get());
+    CPPUNIT_ASSERT_EQUAL(4, id->getReferenceCount());
+
+    CPPUNIT_ASSERT(cache.getFromUnmarshalCache(5) == NULL);
+
+    CPPUNIT_ASSERT_EQUAL(3LL, cache.getUnmarshalHits());
+    CPPUNIT_ASSERT_EQUAL(2LL, cache.getUnmarshalMisses());
+
+    cache.clear();
+    CPPUNIT_ASSERT_EQUAL(3, id->getReferenceCount());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void MarshalCacheTest::testUnmarshalInvalidIndex() {
+
+    MarshalCache cache(64);
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw an IOException",
+        cache.getFromUnmarshalCache(-5),
+        IOException );
+
+    Pointer<DataStructure> id(createProducerId(1).cloneDataStructure());
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw an IOException",
+        cache.setInUnmarshalCache((short) MarshalCache::MAX_CACHE_SIZE, id),
+        IOException );
+}
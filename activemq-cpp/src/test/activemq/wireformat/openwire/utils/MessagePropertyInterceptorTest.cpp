@@ -37,10 +37,9 @@ using namespace activemq::commands;
 ////////////////////////////////////////////////////////////////////////////////
 void MessagePropertyInterceptorTest::test() {
 
-    PrimitiveMap properties;
     Message message;
 
-    MessagePropertyInterceptor interceptor( &message, &properties );
+    MessagePropertyInterceptor interceptor( &message );
 
     CPPUNIT_ASSERT( message.getGroupID() == "" );
     CPPUNIT_ASSERT( message.getGroupSequence() == 0 );
@@ -0,0 +1,284 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "StompFrameDecoderTest.h"
+
+#include <activemq/wireformat/stomp/StompFrame.h>
+#include <activemq/wireformat/stomp/StompFrameDecoder.h>
+
+#include <decaf/io/ByteArrayInputStream.h>
+#include <decaf/io/DataInputStream.h>
+#include <decaf/io/EOFException.h>
+#include <decaf/io/IOException.h>
+
+using namespace std;
+using namespace activemq;
+using namespace activemq::wireformat;
+using namespace activemq::wireformat::stomp;
+using namespace decaf;
+using namespace decaf::io;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    // Hands out at most a few bytes per read, the way a socket delivers a frame that
+    // arrives in several segments.
+    class ChunkedInputStream : public ByteArrayInputStream {
+    private:
+
+        int chunkSize;
+
+    public:
+
+        ChunkedInputStream(const std::string& data, int chunkSize) :
+            ByteArrayInputStream((const unsigned char*) data.c_str(), (int) data.size()), chunkSize(chunkSize) {
+        }
+
+        virtual ~ChunkedInputStream() {}
+
+    protected:
+
+        virtual int doReadArrayBounded(unsigned char* buffer, int size, int offset, int length) {
+            return ByteArrayInputStream::doReadArrayBounded(
+                buffer, size, offset, length < chunkSize ? length : chunkSize);
+        }
+    };
+
+    std::string bodyOf(StompFrame& frame) {
+        const std::vector<unsigned char>& body = frame.getBody();
+        return body.empty() ? std::string() : std::string((const char*) &body[0], body.size());
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+StompFrameDecoderTest::StompFrameDecoderTest() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+StompFrameDecoderTest::~StompFrameDecoderTest() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void StompFrameDecoderTest::testDecodeFrame() {
+
+    std::string data("\n\nMESSAGE\ndestination:/queue/test\nmessage-id:ID:1\n\nHello World");
+    data.append(1, '\0');
+    data.append("\n");
+
+    ByteArrayInputStream bytes((const unsigned char*) data.c_str(), (int) data.size());
+    DataInputStream in(&bytes);
+
+    StompFrameDecoder decoder;
+    StompFrame frame;
+    decoder.decode(&in, frame);
+
+    CPPUNIT_ASSERT_EQUAL(std::string("MESSAGE"), frame.getCommand());
+    CPPUNIT_ASSERT_EQUAL(std::string("/queue/test"), frame.getProperty("destination"));
+    CPPUNIT_ASSERT_EQUAL(std::string("ID:1"), frame.getProperty("message-id"));
+    CPPUNIT_ASSERT_EQUAL(2, (int) frame.getProperties().size());
+
+    // Without a content-length the body keeps its terminating null.
+    CPPUNIT_ASSERT_EQUAL(std::string("Hello World", 11) + '\0', bodyOf(frame));
+
+    // The newline after the frame stays buffered for the next decode.
+    CPPUNIT_ASSERT_EQUAL((std::size_t) 1, decoder.getBufferedSize());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void StompFrameDecoderTest::testDecodeSeveralFrames() {
+
+    std::string data;
+    for (int i = 0; i < 3; ++i) {
+        data.append("MESSAGE\ndestination:/queue/test\n\nBody");
+        data.append(1, (char) ('0' + i));
+        data.append(1, '\0');
+        data.append("\n\n");
+    }
+
+    ByteArrayInputStream bytes((const unsigned char*) data.c_str(), (int) data.size());
+    DataInputStream in(&bytes);
+
+    StompFrameDecoder decoder;
+
+    for (int i = 0; i < 3; ++i) {
+        StompFrame frame;
+        decoder.decode(&in, frame);
+
+        CPPUNIT_ASSERT_EQUAL(std::string("MESSAGE"), frame.getCommand());
+        CPPUNIT_ASSERT_EQUAL(std::string("/queue/test"), frame.getProperty("destination"));
+
+        std::string expected("Body");
+        expected.append(1, (char) ('0' + i));
+        expected.append(1, '\0');
+        CPPUNIT_ASSERT_EQUAL(expected, bodyOf(frame));
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void StompFrameDecoderTest::testDecodeContentLength() {
+
+    std::string payload("AB\0CD", 5);
+
+    std::string data("MESSAGE\ncontent-length:5\n\n");
+    data.append(payload);
+    data.append(1, '\0');
+    data.append("\nRECEIPT\nreceipt-id:1\n\n");
+    data.append(1, '\0');
+
+    ByteArrayInputStream bytes((const unsigned char*) data.c_str(), (int) data.size());
+    DataInputStream in(&bytes);
+
+    StompFrameDecoder decoder;
+
+    StompFrame message;
+    decoder.decode(&in, message);
+    CPPUNIT_ASSERT_EQUAL(std::string("MESSAGE"), message.getCommand());
+    CPPUNIT_ASSERT_EQUAL(payload, bodyOf(message));
+
+    StompFrame receipt;
+    decoder.decode(&in, receipt);
+    CPPUNIT_ASSERT_EQUAL(std::string("RECEIPT"), receipt.getCommand());
+    CPPUNIT_ASSERT_EQUAL(std::string("1"), receipt.getProperty("receipt-id"));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void StompFrameDecoderTest::testDecodeContentLengthLargerThanBuffer() {
+
+    std::string payload;
+    for (int i = 0; i < 1000; ++i) {
+        payload.append(1, (char) (i % 256));
+    }
+
+    std::string data("MESSAGE\ncontent-length:1000\n\n");
+    data.append(payload);
+    data.append(1, '\0');
+    data.append("\n");
+
+    ByteArrayInputStream bytes((const unsigned char*) data.c_str(), (int) data.size());
+    DataInputStream in(&bytes);
+
+    StompFrameDecoder decoder(16);
+    StompFrame frame;
+    decoder.decode(&in, frame);
+
+    CPPUNIT_ASSERT_EQUAL(std::string("MESSAGE"), frame.getCommand());
+    CPPUNIT_ASSERT_EQUAL(payload, bodyOf(frame));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void StompFrameDecoderTest::testDecodeNoTrailingNull() {
+
+    std::string data("MESSAGE\ncontent-length:2\n\nABC\n");
+
+    ByteArrayInputStream bytes((const unsigned char*) data.c_str(), (int) data.size());
+    DataInputStream in(&bytes);
+
+    StompFrameDecoder decoder;
+    StompFrame frame;
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw an IOException when the body is not null terminated",
+        decoder.decode(&in, frame),
+        IOException);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void StompFrameDecoderTest::testDecodeFirstHeaderWins() {
+
+    std::string data("MESSAGE\nfoo:first\nfoo:second\nignored line\nbar:a:b\n\n");
+    data.append(1, '\0');
+
+    ByteArrayInputStream bytes((const unsigned char*) data.c_str(), (int) data.size());
+    DataInputStream in(&bytes);
+
+    StompFrameDecoder decoder;
+    StompFrame frame;
+    decoder.decode(&in, frame);
+
+    CPPUNIT_ASSERT_EQUAL(std::string("first"), frame.getProperty("foo"));
+    CPPUNIT_ASSERT_EQUAL(std::string("a:b"), frame.getProperty("bar"));
+    CPPUNIT_ASSERT_EQUAL(2, (int) frame.getProperties().size());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void StompFrameDecoderTest::testDecodeSplitReads() {
+
+    std::string data("\nCONNECTED\nsession:ID:12345\nheart-beat:0,0\n\n");
+    data.append(1, '\0');
+    data.append("\n\n\nMESSAGE\ncontent-length:11\ndestination:/topic/a\n\nHello World");
+    data.append(1, '\0');
+    data.append("\n");
+
+    ChunkedInputStream chunks(data, 3);
+    DataInputStream in(&chunks);
+
+    StompFrameDecoder decoder(4);
+
+    StompFrame connected;
+    decoder.decode(&in, connected);
+    CPPUNIT_ASSERT_EQUAL(std::string("CONNECTED"), connected.getCommand());
+    CPPUNIT_ASSERT_EQUAL(std::string("ID:12345"), connected.getProperty("session"));
+    CPPUNIT_ASSERT_EQUAL(std::string("0,0"), connected.getProperty("heart-beat"));
+    CPPUNIT_ASSERT_EQUAL(std::string(1, '\0'), bodyOf(connected));
+
+    StompFrame message;
+    decoder.decode(&in, message);
+    CPPUNIT_ASSERT_EQUAL(std::string("MESSAGE"), message.getCommand());
+    CPPUNIT_ASSERT_EQUAL(std::string("/topic/a"), message.getProperty("destination"));
+    CPPUNIT_ASSERT_EQUAL(std::string("Hello World"), bodyOf(message));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void StompFrameDecoderTest::testDecodeMatchesFromStream() {
+
+    std::string data(" \t ERROR\r\nmessage:oops\r\n\nstack trace");
+    data.append(1, '\0');
+    data.append("\n");
+
+    ByteArrayInputStream bytes1((const unsigned char*) data.c_str(), (int) data.size());
+    DataInputStream in1(&bytes1);
+    StompFrame expected;
+    expected.fromStream(&in1);
+
+    ByteArrayInputStream bytes2((const unsigned char*) data.c_str(), (int) data.size());
+    DataInputStream in2(&bytes2);
+    StompFrameDecoder decoder;
+    StompFrame actual;
+    decoder.decode(&in2, actual);
+
+    CPPUNIT_ASSERT_EQUAL(expected.getCommand(), actual.getCommand());
+    CPPUNIT_ASSERT_EQUAL(expected.getProperty("message"), actual.getProperty("message"));
+    CPPUNIT_ASSERT_EQUAL(expected.getProperties().size(), actual.getProperties().size());
+    CPPUNIT_ASSERT_EQUAL(bodyOf(expected), bodyOf(actual));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void StompFrameDecoderTest::testDecodeEOF() {
+
+    std::string data("MESSAGE\ndestination:/queue/test\n\nunterminated");
+
+    ByteArrayInputStream bytes((const unsigned char*) data.c_str(), (int) data.size());
+    DataInputStream in(&bytes);
+
+    StompFrameDecoder decoder;
+    StompFrame frame;
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw an EOFException when the stream ends inside a frame",
+        decoder.decode(&in, frame),
+        EOFException);
+}
@@ -0,0 +1,61 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIVEMQ_WIREFORMAT_STOMP_STOMPFRAMEDECODERTEST_H_
+#define _ACTIVEMQ_WIREFORMAT_STOMP_STOMPFRAMEDECODERTEST_H_
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+namespace activemq {
+namespace wireformat {
+namespace stomp {
+
+    class StompFrameDecoderTest : public CppUnit::TestFixture {
+
+        CPPUNIT_TEST_SUITE( StompFrameDecoderTest );
+        CPPUNIT_TEST( testDecodeFrame );
+        CPPUNIT_TEST( testDecodeSeveralFrames );
+        CPPUNIT_TEST( testDecodeContentLength );
+        CPPUNIT_TEST( testDecodeContentLengthLargerThanBuffer );
+        CPPUNIT_TEST( testDecodeNoTrailingNull );
+        CPPUNIT_TEST( testDecodeFirstHeaderWins );
+        CPPUNIT_TEST( testDecodeSplitReads );
+        CPPUNIT_TEST( testDecodeMatchesFromStream );
+        CPPUNIT_TEST( testDecodeEOF );
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+
+        StompFrameDecoderTest();
+        virtual ~StompFrameDecoderTest();
+
+        void testDecodeFrame();
+        void testDecodeSeveralFrames();
+        void testDecodeContentLength();
+        void testDecodeContentLengthLargerThanBuffer();
+        void testDecodeNoTrailingNull();
+        void testDecodeFirstHeaderWins();
+        void testDecodeSplitReads();
+        void testDecodeMatchesFromStream();
+        void testDecodeEOF();
+
+    };
+
+}}}
+
+#endif /* _ACTIVEMQ_WIREFORMAT_STOMP_STOMPFRAMEDECODERTEST_H_ */
@@ -0,0 +1,207 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The ASF licenses this file to You under the Apache License, Version 2.0
+ * (the "License"); you may not use this file except in compliance with
+ * the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "SocketPollerTest.h"
+
+#include <decaf/internal/net/SocketPoller.h>
+#include <decaf/io/IOException.h>
+#include <decaf/io/OutputStream.h>
+#include <decaf/lang/System.h>
+#include <decaf/lang/Thread.h>
+#include <decaf/net/ServerSocket.h>
+#include <decaf/net/Socket.h>
+
+#include <memory>
+#include <vector>
+
+using namespace std;
+using namespace decaf;
+using namespace decaf::io;
+using namespace decaf::lang;
+using namespace decaf::net;
+using namespace decaf::internal::net;
+
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    class Connection {
+    private:
+
+        Connection(const Connection&);
+        Connection& operator=(const Connection&);
+
+    public:
+
+        ServerSocket server;
+        std::auto_ptr<Socket> client;
+        std::auto_ptr<Socket> peer;
+
+        Connection() : server(0), client(), peer() {
+            client.reset(new Socket("localhost", server.getLocalPort()));
+            peer.reset(server.accept());
+        }
+
+        ~Connection() {
+            try {
+                client->close();
+                peer->close();
+                server.close();
+            } catch (...) {
+            }
+        }
+
+        void send(unsigned char value) {
+            peer->getOutputStream()->write(value);
+            peer->getOutputStream()->flush();
+        }
+    };
+
+    class Waker : public Runnable {
+    private:
+
+        SocketPoller* poller;
+
+    private:
+
+        Waker(const Waker&);
+        Waker& operator=(const Waker&);
+
+    public:
+
+        Waker(SocketPoller* poller) : Runnable(), poller(poller) {}
+
+        virtual ~Waker() {}
+
+        virtual void run() {
+            Thread::sleep(100);
+            poller->wakeup();
+        }
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+SocketPollerTest::SocketPollerTest() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+SocketPollerTest::~SocketPollerTest() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void SocketPollerTest::testPollReturnsReadableSocket() {
+
+    Connection first;
+    Connection second;
+    int firstTag = 1;
+    int secondTag = 2;
+
+    SocketPoller poller(4);
+    poller.add(first.client.get(), &firstTag);
+    poller.add(second.client.get(), &secondTag);
+    CPPUNIT_ASSERT_EQUAL(2, poller.size());
+
+    second.send(42);
+
+    std::vector<void*> ready;
+    CPPUNIT_ASSERT_EQUAL(1, poller.poll(ready, 5000));
+    CPPUNIT_ASSERT_EQUAL(1, (int) ready.size());
+    CPPUNIT_ASSERT(ready[0] == &secondTag);
+
+    // Still readable until the data has been read.
+    CPPUNIT_ASSERT_EQUAL(1, poller.poll(ready, 5000));
+    CPPUNIT_ASSERT_EQUAL(42, second.client->getInputStream()->read());
+
+    first.send(7);
+    CPPUNIT_ASSERT_EQUAL(1, poller.poll(ready, 5000));
+    CPPUNIT_ASSERT(ready[0] == &firstTag);
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw an IOException when the Socket is already registered",
+        poller.add(first.client.get(), &firstTag),
+        IOException);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void SocketPollerTest::testPollTimeout() {
+
+    Connection connection;
+    SocketPoller poller(4);
+    poller.add(connection.client.get(), NULL);
+
+    std::vector<void*> ready;
+    long long start = System::currentTimeMillis();
+    CPPUNIT_ASSERT_EQUAL(0, poller.poll(ready, 100));
+    CPPUNIT_ASSERT(ready.empty());
+    CPPUNIT_ASSERT(System::currentTimeMillis() - start >= 90);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void SocketPollerTest::testRemove() {
+
+    Connection connection;
+    int tag = 1;
+
+    SocketPoller poller(4);
+    poller.add(connection.client.get(), &tag);
+    connection.send(1);
+
+    CPPUNIT_ASSERT(poller.remove(connection.client.get()));
+    CPPUNIT_ASSERT(!poller.remove(connection.client.get()));
+    CPPUNIT_ASSERT_EQUAL(0, poller.size());
+
+    std::vector<void*> ready;
+    CPPUNIT_ASSERT_EQUAL(0, poller.poll(ready, 50));
+
+    // Can be added again once removed.
+    poller.add(connection.client.get(), &tag);
+    CPPUNIT_ASSERT_EQUAL(1, poller.poll(ready, 5000));
+    CPPUNIT_ASSERT(ready[0] == &tag);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void SocketPollerTest::testWakeup() {
+
+    Connection connection;
+    SocketPoller poller(4);
+    poller.add(connection.client.get(), NULL);
+
+    Waker waker(&poller);
+    Thread thread(&waker);
+    thread.start();
+
+    std::vector<void*> ready;
+    CPPUNIT_ASSERT_EQUAL(0, poller.poll(ready, -1));
+    thread.join();
+
+    // A wakeup with no one polling is kept for the next poll.
+    poller.wakeup();
+    CPPUNIT_ASSERT_EQUAL(0, poller.poll(ready, -1));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void SocketPollerTest::testAddUnconnectedSocket() {
+
+    Socket socket;
+    SocketPoller poller(4);
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should throw an IOException when the Socket is not connected",
+        poller.add(&socket, NULL),
+        IOException);
+
+    CPPUNIT_ASSERT_EQUAL(0, poller.size());
+}
@@ -22,6 +22,7 @@
 #include <decaf/lang/Runnable.h>
 #include <decaf/lang/exceptions/ClassCastException.h>
 #include <decaf/util/concurrent/CountDownLatch.h>
+#include <decaf/util/concurrent/atomic/AtomicRefCounted.h>
 
 #include <map>
 #include <string>
@@ -32,6 +33,7 @@ using namespace decaf;
 using namespace decaf::lang;
 using namespace decaf::lang::exceptions;
 using namespace decaf::util::concurrent;
+using namespace decaf::util::concurrent::atomic;
 
 ////////////////////////////////////////////////////////////////////////////////
 class TestClassBase {
@@ -101,6 +103,28 @@ public:
     }
 };
 
+////////////////////////////////////////////////////////////////////////////////
+class CountedBase : public AtomicRefCounted {
+public:
+
+    int* destroyed;
+
+    CountedBase(int* destroyed) : AtomicRefCounted(), destroyed(destroyed) {}
+
+    virtual ~CountedBase() {
+        (*destroyed)++;
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+class CountedDerived : public CountedBase {
+public:
+
+    CountedDerived(int* destroyed) : CountedBase(destroyed) {}
+
+    virtual ~CountedDerived() {}
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 struct X {
     Pointer<X> next;
@@ -554,3 +578,101 @@ void PointerTest::testThreadSafety() {
         thread[i]->join();
     }
 }
+
+////////////////////////////////////////////////////////////////////////////////
+void PointerTest::testIntrusiveCount() {
+
+    int destroyed = 0;
+    CountedBase* counted = new CountedBase(&destroyed);
+    CPPUNIT_ASSERT_EQUAL(0, counted->getReferenceCount());
+
+    {
+        Pointer<CountedBase> pointer(counted);
+        CPPUNIT_ASSERT_EQUAL(1, counted->getReferenceCount());
+
+        Pointer<CountedBase> copy(pointer);
+        CPPUNIT_ASSERT_EQUAL(2, counted->getReferenceCount());
+
+        Pointer<CountedBase> assigned;
+        assigned = copy;
+        CPPUNIT_ASSERT_EQUAL(3, counted->getReferenceCount());
+
+        copy.reset(NULL);
+        CPPUNIT_ASSERT_EQUAL(2, counted->getReferenceCount());
+
+        // Copying the object does not copy its count.
+        CountedBase other(*counted);
+        CPPUNIT_ASSERT_EQUAL(0, other.getReferenceCount());
+    }
+
+    // Both the copy and the counted object are gone.
+    CPPUNIT_ASSERT_EQUAL(2, destroyed);
+
+    // Wrapping the same object again after its Pointers are gone starts a new count.
+    counted = new CountedBase(&destroyed);
+    Pointer<CountedBase> first(counted);
+    first.reset(NULL);
+    CPPUNIT_ASSERT_EQUAL(3, destroyed);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void PointerTest::testIntrusiveCast() {
+
+    int destroyed = 0;
+    CountedDerived* counted = new CountedDerived(&destroyed);
+
+    {
+        Pointer<CountedBase> base(counted);
+        Pointer<CountedDerived> derived = base.dynamicCast<CountedDerived>();
+        CPPUNIT_ASSERT(derived.get() == counted);
+        CPPUNIT_ASSERT_EQUAL(2, counted->getReferenceCount());
+
+        Pointer<CountedBase> upcast(derived);
+        CPPUNIT_ASSERT_EQUAL(3, counted->getReferenceCount());
+
+        base.reset(NULL);
+        derived.reset(NULL);
+        CPPUNIT_ASSERT_EQUAL(0, destroyed);
+        CPPUNIT_ASSERT_EQUAL(1, counted->getReferenceCount());
+    }
+
+    CPPUNIT_ASSERT_EQUAL(1, destroyed);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void PointerTest::testRelease() {
+
+    int destroyed = 0;
+    CountedBase* counted = new CountedBase(&destroyed);
+
+    {
+        Pointer<CountedBase> pointer(counted);
+        Pointer<CountedBase> copy(pointer);
+
+        CPPUNIT_ASSERT(pointer.release() == counted);
+        CPPUNIT_ASSERT(pointer.get() == NULL);
+        CPPUNIT_ASSERT_EQUAL(1, counted->getReferenceCount());
+
+        CPPUNIT_ASSERT(copy.release() == counted);
+        CPPUNIT_ASSERT_EQUAL(0, counted->getReferenceCount());
+    }
+
+    CPPUNIT_ASSERT_EQUAL(0, destroyed);
+    delete counted;
+    CPPUNIT_ASSERT_EQUAL(1, destroyed);
+
+    // An object on the stack may be lent to a Pointer as long as it is released.
+    {
+        CountedBase onStack(&destroyed);
+        Pointer<CountedBase> borrowed(&onStack);
+        borrowed.release();
+        CPPUNIT_ASSERT_EQUAL(0, onStack.getReferenceCount());
+    }
+
+    CPPUNIT_ASSERT_EQUAL(2, destroyed);
+
+    TestClassA* plain = new TestClassA();
+    Pointer<TestClassA> owner(plain);
+    CPPUNIT_ASSERT(owner.release() == plain);
+    delete plain;
+}
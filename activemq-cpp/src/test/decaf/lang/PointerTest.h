@@ -37,6 +37,9 @@ namespace lang {
         CPPUNIT_TEST( testReturnByValue );
         CPPUNIT_TEST( testDynamicCast );
         CPPUNIT_TEST( testThreadSafety );
+        CPPUNIT_TEST( testIntrusiveCount );
+        CPPUNIT_TEST( testIntrusiveCast );
+        CPPUNIT_TEST( testRelease );
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -54,6 +57,9 @@ namespace lang {
         void testReturnByValue();
         void testDynamicCast();
         void testThreadSafety();
+        void testIntrusiveCount();
+        void testIntrusiveCast();
+        void testRelease();
 
     };
 
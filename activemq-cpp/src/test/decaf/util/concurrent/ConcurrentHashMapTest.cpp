@@ -17,11 +17,81 @@
 
 #include "ConcurrentHashMapTest.h"
 
+#include <decaf/util/concurrent/ConcurrentHashMap.h>
+#include <decaf/util/HashMap.h>
+#include <decaf/util/StlMap.h>
+#include <decaf/lang/Thread.h>
+#include <decaf/lang/Runnable.h>
+#include <decaf/lang/Pointer.h>
+#include <decaf/lang/exceptions/IllegalArgumentException.h>
+#include <decaf/lang/exceptions/IllegalStateException.h>
+
+#include <string>
+#include <vector>
+
 using namespace std;
 using namespace decaf;
+using namespace decaf::lang;
+using namespace decaf::lang::exceptions;
 using namespace decaf::util;
 using namespace decaf::util::concurrent;
 
+////////////////////////////////////////////////////////////////////////////////
+namespace {
+
+    const int MAP_SIZE = 1000;
+
+    typedef ConcurrentHashMap<int, int> IntMap;
+
+    void populate(ConcurrentHashMap<int, int>& map, int count) {
+        for (int i = 0; i < count; ++i) {
+            map.put(i, i * 10);
+        }
+    }
+
+    class MapWriter : public Runnable {
+    private:
+
+        ConcurrentHashMap<int, int>* map;
+        int base;
+        int count;
+
+    public:
+
+        bool failed;
+
+    private:
+
+        MapWriter(const MapWriter&);
+        MapWriter& operator=(const MapWriter&);
+
+    public:
+
+        MapWriter(ConcurrentHashMap<int, int>* map, int base, int count) :
+            map(map), base(base), count(count), failed(false) {
+        }
+
+        virtual ~MapWriter() {}
+
+        virtual void run() {
+            for (int i = base; i < base + count; ++i) {
+                map->put(i, i);
+            }
+
+            // Remove every other key again, and read back the rest.
+            for (int i = base; i < base + count; i += 2) {
+                map->remove(i);
+            }
+
+            for (int i = base + 1; i < base + count; i += 2) {
+                if (!map->containsKey(i) || map->get(i) != i) {
+                    failed = true;
+                }
+            }
+        }
+    };
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 ConcurrentHashMapTest::ConcurrentHashMapTest() {
 }
@@ -33,4 +103,296 @@ ConcurrentHashMapTest::~ConcurrentHashMapTest() {
 ////////////////////////////////////////////////////////////////////////////////
 void ConcurrentHashMapTest::testConstructor() {
 
+    ConcurrentHashMap<int, std::string> map;
+    CPPUNIT_ASSERT(map.isEmpty());
+    CPPUNIT_ASSERT_EQUAL(0, map.size());
+    CPPUNIT_ASSERT_EQUAL(16, map.getSegmentCount());
+
+    ConcurrentHashMap<int, std::string> map2(100, 5);
+    CPPUNIT_ASSERT(map2.isEmpty());
+    CPPUNIT_ASSERT_EQUAL(8, map2.getSegmentCount());
+
+    ConcurrentHashMap<int, std::string> map3(0, 1);
+    CPPUNIT_ASSERT_EQUAL(1, map3.getSegmentCount());
+    map3.put(1, "one");
+    CPPUNIT_ASSERT_EQUAL(std::string("one"), map3.get(1));
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should have thrown an IllegalArgumentException",
+        IntMap(-1),
+        IllegalArgumentException);
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should have thrown an IllegalArgumentException",
+        IntMap(16, 0),
+        IllegalArgumentException);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ConcurrentHashMapTest::testConstructorMap() {
+
+    HashMap<int, int> source;
+    for (int i = 0; i < MAP_SIZE; ++i) {
+        source.put(i, i + 1);
+    }
+
+    ConcurrentHashMap<int, int> map(source);
+    CPPUNIT_ASSERT_EQUAL(MAP_SIZE, map.size());
+    for (int i = 0; i < MAP_SIZE; ++i) {
+        CPPUNIT_ASSERT_EQUAL(i + 1, map.get(i));
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ConcurrentHashMapTest::testPutGetRemove() {
+
+    ConcurrentHashMap<std::string, int> map;
+
+    CPPUNIT_ASSERT(!map.put("one", 1));
+    CPPUNIT_ASSERT(!map.put("two", 2));
+    CPPUNIT_ASSERT(map.put("one", 11));
+
+    int oldValue = 0;
+    CPPUNIT_ASSERT(map.put("two", 22, oldValue));
+    CPPUNIT_ASSERT_EQUAL(2, oldValue);
+
+    CPPUNIT_ASSERT_EQUAL(11, map.get("one"));
+    CPPUNIT_ASSERT_EQUAL(22, map.get("two"));
+    CPPUNIT_ASSERT(map.containsKey("one"));
+    CPPUNIT_ASSERT(!map.containsKey("three"));
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should have thrown a NoSuchElementException",
+        map.get("three"),
+        NoSuchElementException);
+
+    int value = -1;
+    CPPUNIT_ASSERT(map.get("two", value));
+    CPPUNIT_ASSERT_EQUAL(22, value);
+    CPPUNIT_ASSERT(!map.get("three", value));
+    CPPUNIT_ASSERT_EQUAL(22, value);
+
+    CPPUNIT_ASSERT_EQUAL(11, map.remove("one"));
+    CPPUNIT_ASSERT(!map.containsKey("one"));
+    CPPUNIT_ASSERT_EQUAL(1, map.size());
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should have thrown a NoSuchElementException",
+        map.remove("one"),
+        NoSuchElementException);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ConcurrentHashMapTest::testClearAndSize() {
+
+    ConcurrentHashMap<int, int> map;
+    populate(map, MAP_SIZE);
+
+    CPPUNIT_ASSERT_EQUAL(MAP_SIZE, map.size());
+    CPPUNIT_ASSERT(!map.isEmpty());
+
+    map.clear();
+    CPPUNIT_ASSERT_EQUAL(0, map.size());
+    CPPUNIT_ASSERT(map.isEmpty());
+    CPPUNIT_ASSERT(!map.containsKey(1));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ConcurrentHashMapTest::testContainsValue() {
+
+    ConcurrentHashMap<int, int> map;
+    populate(map, MAP_SIZE);
+
+    CPPUNIT_ASSERT(map.containsValue(0));
+    CPPUNIT_ASSERT(map.containsValue((MAP_SIZE - 1) * 10));
+    CPPUNIT_ASSERT(!map.containsValue(5));
+    CPPUNIT_ASSERT(map.values().contains(100));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ConcurrentHashMapTest::testPutIfAbsent() {
+
+    ConcurrentHashMap<int, int> map;
+
+    CPPUNIT_ASSERT(map.putIfAbsent(1, 10));
+    CPPUNIT_ASSERT(!map.putIfAbsent(1, 20));
+    CPPUNIT_ASSERT_EQUAL(10, map.get(1));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ConcurrentHashMapTest::testConditionalRemove() {
+
+    ConcurrentHashMap<int, int> map;
+    populate(map, 10);
+
+    CPPUNIT_ASSERT(!map.remove(1, 11));
+    CPPUNIT_ASSERT(map.containsKey(1));
+    CPPUNIT_ASSERT(map.remove(1, 10));
+    CPPUNIT_ASSERT(!map.containsKey(1));
+    CPPUNIT_ASSERT(!map.remove(1, 10));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ConcurrentHashMapTest::testReplace() {
+
+    ConcurrentHashMap<int, int> map;
+    populate(map, 10);
+
+    CPPUNIT_ASSERT(!map.replace(1, 11, 12));
+    CPPUNIT_ASSERT_EQUAL(10, map.get(1));
+    CPPUNIT_ASSERT(map.replace(1, 10, 12));
+    CPPUNIT_ASSERT_EQUAL(12, map.get(1));
+
+    CPPUNIT_ASSERT_EQUAL(12, map.replace(1, 13));
+    CPPUNIT_ASSERT_EQUAL(13, map.get(1));
+
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should have thrown a NoSuchElementException",
+        map.replace(100, 1),
+        NoSuchElementException);
+    CPPUNIT_ASSERT(!map.containsKey(100));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ConcurrentHashMapTest::testEquals() {
+
+    ConcurrentHashMap<int, int> map;
+    populate(map, 100);
+
+    StlMap<int, int> other;
+    for (int i = 0; i < 100; ++i) {
+        other.put(i, i * 10);
+    }
+
+    CPPUNIT_ASSERT(map.equals(other));
+
+    other.put(5, 5);
+    CPPUNIT_ASSERT(!map.equals(other));
+
+    other.put(5, 50);
+    other.put(100, 1000);
+    CPPUNIT_ASSERT(!map.equals(other));
+
+    ConcurrentHashMap<int, int> copy;
+    copy.copy(other);
+    CPPUNIT_ASSERT(copy.equals(other));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ConcurrentHashMapTest::testKeySetIterator() {
+
+    ConcurrentHashMap<int, int> map;
+    populate(map, MAP_SIZE);
+
+    std::vector<bool> seen(MAP_SIZE, false);
+
+    Pointer< Iterator<int> > iter(map.keySet().iterator());
+    while (iter->hasNext()) {
+        int key = iter->next();
+        CPPUNIT_ASSERT(!seen[key]);
+        seen[key] = true;
+
+        // Changes made while iterating don't disturb the iterator.
+        map.remove(key);
+        map.put(key + MAP_SIZE, 0);
+    }
+
+    for (int i = 0; i < MAP_SIZE; ++i) {
+        CPPUNIT_ASSERT(seen[i]);
+    }
+
+    CPPUNIT_ASSERT_EQUAL(MAP_SIZE, map.size());
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should have thrown a NoSuchElementException",
+        iter->next(),
+        NoSuchElementException);
+
+    iter.reset(map.keySet().iterator());
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should have thrown an IllegalStateException",
+        iter->remove(),
+        IllegalStateException);
+
+    while (iter->hasNext()) {
+        iter->next();
+        iter->remove();
+    }
+
+    CPPUNIT_ASSERT(map.isEmpty());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ConcurrentHashMapTest::testEntrySetAndValues() {
+
+    ConcurrentHashMap<int, int> map;
+    populate(map, 100);
+
+    int count = 0;
+    Pointer< Iterator< MapEntry<int, int> > > entries(map.entrySet().iterator());
+    while (entries->hasNext()) {
+        MapEntry<int, int> entry = entries->next();
+        CPPUNIT_ASSERT_EQUAL(entry.getKey() * 10, entry.getValue());
+        count++;
+    }
+    CPPUNIT_ASSERT_EQUAL(100, count);
+
+    CPPUNIT_ASSERT(map.entrySet().contains(MapEntry<int, int>(5, 50)));
+    CPPUNIT_ASSERT(!map.entrySet().contains(MapEntry<int, int>(5, 51)));
+    CPPUNIT_ASSERT(map.entrySet().remove(MapEntry<int, int>(5, 50)));
+    CPPUNIT_ASSERT(!map.containsKey(5));
+
+    long long sum = 0;
+    Pointer< Iterator<int> > values(map.values().iterator());
+    while (values->hasNext()) {
+        sum += values->next();
+    }
+    CPPUNIT_ASSERT_EQUAL(49500LL - 50LL, sum);
+
+    CPPUNIT_ASSERT(map.keySet().remove(6));
+    CPPUNIT_ASSERT(!map.keySet().remove(6));
+    CPPUNIT_ASSERT_EQUAL(98, map.keySet().size());
+
+    const ConcurrentHashMap<int, int>& constMap = map;
+    Pointer< Iterator<int> > constKeys(constMap.keySet().iterator());
+    CPPUNIT_ASSERT(constKeys->hasNext());
+    constKeys->next();
+    CPPUNIT_ASSERT_THROW_MESSAGE(
+        "Should have thrown an UnsupportedOperationException",
+        constKeys->remove(),
+        UnsupportedOperationException);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ConcurrentHashMapTest::testConcurrentUpdates() {
+
+    const int NUM_THREADS = 8;
+    const int KEYS_PER_THREAD = 2000;
+
+    ConcurrentHashMap<int, int> map;
+
+    std::vector< Pointer<MapWriter> > writers;
+    std::vector< Pointer<Thread> > threads;
+
+    for (int i = 0; i < NUM_THREADS; ++i) {
+        writers.push_back(Pointer<MapWriter>(new MapWriter(&map, i * KEYS_PER_THREAD, KEYS_PER_THREAD)));
+        threads.push_back(Pointer<Thread>(new Thread(writers[i].get())));
+    }
+
+    for (int i = 0; i < NUM_THREADS; ++i) {
+        threads[i]->start();
+    }
+
+    for (int i = 0; i < NUM_THREADS; ++i) {
+        threads[i]->join();
+    }
+
+    for (int i = 0; i < NUM_THREADS; ++i) {
+        CPPUNIT_ASSERT(!writers[i]->failed);
+    }
+
+    CPPUNIT_ASSERT_EQUAL(NUM_THREADS * KEYS_PER_THREAD / 2, map.size());
+
+    for (int i = 0; i < NUM_THREADS * KEYS_PER_THREAD; ++i) {
+        CPPUNIT_ASSERT_EQUAL(i % 2 == 1, map.containsKey(i));
+    }
 }
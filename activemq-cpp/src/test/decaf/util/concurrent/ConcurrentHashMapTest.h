@@ -29,6 +29,17 @@ namespace concurrent {
 
         CPPUNIT_TEST_SUITE( ConcurrentHashMapTest );
         CPPUNIT_TEST( testConstructor );
+        CPPUNIT_TEST( testConstructorMap );
+        CPPUNIT_TEST( testPutGetRemove );
+        CPPUNIT_TEST( testClearAndSize );
+        CPPUNIT_TEST( testContainsValue );
+        CPPUNIT_TEST( testPutIfAbsent );
+        CPPUNIT_TEST( testConditionalRemove );
+        CPPUNIT_TEST( testReplace );
+        CPPUNIT_TEST( testEquals );
+        CPPUNIT_TEST( testKeySetIterator );
+        CPPUNIT_TEST( testEntrySetAndValues );
+        CPPUNIT_TEST( testConcurrentUpdates );
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -37,6 +48,18 @@ namespace concurrent {
         virtual ~ConcurrentHashMapTest();
 
         void testConstructor();
+        void testConstructorMap();
+        void testPutGetRemove();
+        void testClearAndSize();
+        void testContainsValue();
+        void testPutIfAbsent();
+        void testConditionalRemove();
+        void testReplace();
+        void testEquals();
+        void testKeySetIterator();
+        void testEntrySetAndValues();
+        void testConcurrentUpdates();
+
     };
 
 }}}
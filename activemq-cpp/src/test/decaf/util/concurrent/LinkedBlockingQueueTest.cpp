@@ -716,6 +716,53 @@ void LinkedBlockingQueueTest::testWeaklyConsistentIteration () {
     CPPUNIT_ASSERT_EQUAL(0, q.size());
 }
 
+///////////////////////////////////////////////////////////////////////////////
+void LinkedBlockingQueueTest::testIteratorOutlivesRemovedNodes() {
+
+    LinkedBlockingQueue<int> q;
+    q.add(1);
+    q.add(2);
+    q.add(3);
+    q.add(4);
+
+    Pointer< Iterator<int> > iter(q.iterator());
+    Pointer< Iterator<int> > other(q.iterator());
+    CPPUNIT_ASSERT_EQUAL(1, iter->next());
+
+    // The nodes under both iterators leave the queue while they are on them.
+    CPPUNIT_ASSERT_EQUAL(1, q.take());
+    CPPUNIT_ASSERT_EQUAL(2, q.take());
+    CPPUNIT_ASSERT(q.remove(3));
+
+    CPPUNIT_ASSERT_EQUAL(2, iter->next());
+    CPPUNIT_ASSERT_EQUAL(4, iter->next());
+    CPPUNIT_ASSERT(!iter->hasNext());
+
+    CPPUNIT_ASSERT_EQUAL(1, other->next());
+    q.clear();
+    CPPUNIT_ASSERT_EQUAL(4, other->next());
+    CPPUNIT_ASSERT(!other->hasNext());
+
+    iter.reset(NULL);
+    other.reset(NULL);
+
+    for (int i = 0; i < SIZE; ++i) {
+        q.add(i);
+    }
+
+    iter.reset(q.iterator());
+    LinkedList<int> sink;
+    CPPUNIT_ASSERT_EQUAL(SIZE, q.drainTo(sink));
+    CPPUNIT_ASSERT_EQUAL(0, q.size());
+    CPPUNIT_ASSERT_EQUAL(0, iter->next());
+    CPPUNIT_ASSERT(!iter->hasNext());
+    iter.reset(NULL);
+
+    q.add(42);
+    CPPUNIT_ASSERT_EQUAL(42, q.take());
+    CPPUNIT_ASSERT(q.isEmpty());
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 namespace {
 
@@ -78,6 +78,7 @@ namespace concurrent {
 //        CPPUNIT_TEST( testTimedPollWithOffer );
 //        CPPUNIT_TEST( testOfferInExecutor );
         CPPUNIT_TEST( testPollInExecutor );
+        CPPUNIT_TEST( testIteratorOutlivesRemovedNodes );
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -127,6 +128,7 @@ namespace concurrent {
         void testIteratorRemove();
         void testIteratorOrdering();
         void testWeaklyConsistentIteration();
+        void testIteratorOutlivesRemovedNodes();
         void testConcurrentPut();
         void testConcurrentTake();
         void testConcurrentPutAndTake();
@@ -18,6 +18,8 @@
 // All CPP Unit tests are registered in here so we can disable them and
 // enable them easily in one place.
 
+#include <activemq/commands/MessageIdTest.h>
+CPPUNIT_TEST_SUITE_REGISTRATION( activemq::commands::MessageIdTest );
 #include <activemq/commands/BrokerInfoTest.h>
 CPPUNIT_TEST_SUITE_REGISTRATION( activemq::commands::BrokerInfoTest );
 #include <activemq/commands/BrokerIdTest.h>
@@ -54,6 +56,8 @@ CPPUNIT_TEST_SUITE_REGISTRATION( activemq::wireformat::openwire::marshal::Primit
 CPPUNIT_TEST_SUITE_REGISTRATION( activemq::wireformat::openwire::utils::BooleanStreamTest );
 #include <activemq/wireformat/openwire/utils/HexTableTest.h>
 CPPUNIT_TEST_SUITE_REGISTRATION( activemq::wireformat::openwire::utils::HexTableTest );
+#include <activemq/wireformat/openwire/utils/MarshalCacheTest.h>
+CPPUNIT_TEST_SUITE_REGISTRATION( activemq::wireformat::openwire::utils::MarshalCacheTest );
 #include <activemq/wireformat/openwire/utils/MessagePropertyInterceptorTest.h>
 CPPUNIT_TEST_SUITE_REGISTRATION( activemq::wireformat::openwire::utils::MessagePropertyInterceptorTest );
 
@@ -62,6 +66,8 @@ CPPUNIT_TEST_SUITE_REGISTRATION( activemq::wireformat::openwire::OpenWireFormatT
 
 #include <activemq/wireformat/stomp/StompHelperTest.h>
 CPPUNIT_TEST_SUITE_REGISTRATION( activemq::wireformat::stomp::StompHelperTest );
+#include <activemq/wireformat/stomp/StompFrameDecoderTest.h>
+CPPUNIT_TEST_SUITE_REGISTRATION( activemq::wireformat::stomp::StompFrameDecoderTest );
 #include <activemq/wireformat/stomp/StompWireFormatTest.h>
 CPPUNIT_TEST_SUITE_REGISTRATION( activemq::wireformat::stomp::StompWireFormatTest );
 #include <activemq/wireformat/stomp/StompWireFormatFactoryTest.h>
@@ -86,12 +92,18 @@ CPPUNIT_TEST_SUITE_REGISTRATION( activemq::core::ActiveMQConnectionTest );
 CPPUNIT_TEST_SUITE_REGISTRATION( activemq::core::ActiveMQSessionTest );
 #include <activemq/core/FifoMessageDispatchChannelTest.h>
 CPPUNIT_TEST_SUITE_REGISTRATION( activemq::core::FifoMessageDispatchChannelTest );
+#include <activemq/core/RingMessageDispatchChannelTest.h>
+CPPUNIT_TEST_SUITE_REGISTRATION( activemq::core::RingMessageDispatchChannelTest );
 #include <activemq/core/SimplePriorityMessageDispatchChannelTest.h>
 CPPUNIT_TEST_SUITE_REGISTRATION( activemq::core::SimplePriorityMessageDispatchChannelTest );
 #include <activemq/core/ActiveMQMessageAuditTest.h>
 CPPUNIT_TEST_SUITE_REGISTRATION( activemq::core::ActiveMQMessageAuditTest );
 #include <activemq/core/ConnectionAuditTest.h>
 CPPUNIT_TEST_SUITE_REGISTRATION( activemq::core::ConnectionAuditTest );
+#include <activemq/core/DeliveredMessageListTest.h>
+CPPUNIT_TEST_SUITE_REGISTRATION( activemq::core::DeliveredMessageListTest );
+#include <activemq/core/PendingCreationTest.h>
+CPPUNIT_TEST_SUITE_REGISTRATION( activemq::core::PendingCreationTest );
 
 #include <activemq/state/ConnectionStateTrackerTest.h>
 CPPUNIT_TEST_SUITE_REGISTRATION( activemq::state::ConnectionStateTrackerTest );
@@ -133,6 +145,10 @@ CPPUNIT_TEST_SUITE_REGISTRATION( activemq::exceptions::ActiveMQExceptionTest );
 CPPUNIT_TEST_SUITE_REGISTRATION( activemq::util::AdvisorySupportTest );
 #include <activemq/util/ActiveMQMessageTransformationTest.h>
 CPPUNIT_TEST_SUITE_REGISTRATION( activemq::util::ActiveMQMessageTransformationTest );
+#include <activemq/util/ByteSequenceTest.h>
+CPPUNIT_TEST_SUITE_REGISTRATION( activemq::util::ByteSequenceTest );
+#include <activemq/util/CompressionContextPoolTest.h>
+CPPUNIT_TEST_SUITE_REGISTRATION( activemq::util::CompressionContextPoolTest );
 #include <activemq/util/IdGeneratorTest.h>
 CPPUNIT_TEST_SUITE_REGISTRATION( activemq::util::IdGeneratorTest );
 #include <activemq/util/LongSequenceGeneratorTest.h>
@@ -158,6 +174,12 @@ CPPUNIT_TEST_SUITE_REGISTRATION( activemq::threads::SchedulerTest );
 CPPUNIT_TEST_SUITE_REGISTRATION( activemq::threads::DedicatedTaskRunnerTest );
 #include <activemq/threads/CompositeTaskRunnerTest.h>
 CPPUNIT_TEST_SUITE_REGISTRATION( activemq::threads::CompositeTaskRunnerTest );
+#include <activemq/threads/HashedWheelTimerTest.h>
+CPPUNIT_TEST_SUITE_REGISTRATION( activemq::threads::HashedWheelTimerTest );
+#include <activemq/threads/PooledTaskRunnerTest.h>
+CPPUNIT_TEST_SUITE_REGISTRATION( activemq::threads::PooledTaskRunnerTest );
+#include <activemq/threads/WorkStealingThreadPoolTest.h>
+CPPUNIT_TEST_SUITE_REGISTRATION( activemq::threads::WorkStealingThreadPoolTest );
 
 #include <activemq/wireformat/WireFormatRegistryTest.h>
 CPPUNIT_TEST_SUITE_REGISTRATION( activemq::wireformat::WireFormatRegistryTest );
@@ -187,6 +209,8 @@ CPPUNIT_TEST_SUITE_REGISTRATION( decaf::internal::nio::IntArrayBufferTest );
 #include <decaf/internal/nio/ShortArrayBufferTest.h>
 CPPUNIT_TEST_SUITE_REGISTRATION( decaf::internal::nio::ShortArrayBufferTest );
 
+#include <decaf/internal/net/SocketPollerTest.h>
+CPPUNIT_TEST_SUITE_REGISTRATION( decaf::internal::net::SocketPollerTest );
 #include <decaf/internal/net/URIEncoderDecoderTest.h>
 CPPUNIT_TEST_SUITE_REGISTRATION( decaf::internal::net::URIEncoderDecoderTest );
 #include <decaf/internal/net/URIHelperTest.h>